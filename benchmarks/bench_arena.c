@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "bench_common.h"
+#include "utils.h"
+
+/* Measures arena fill/reset cycles: the per-request pattern where a warm
+ * arena is bumped full of small objects and then arena_reset() for the next
+ * request. bench_query_result_alloc compares cold allocation strategies;
+ * this covers the steady state where blocks are already sized and recycled. */
+
+#define BENCH_ARENA_CYCLES 2000u
+#define BENCH_ARENA_ALLOCS_PER_CYCLE 512u
+
+/* Runs one allocation-size case; returns 0 on success, 1 on failure. */
+static int bench_case(const char *name, uint32_t alloc_sz) {
+  Arena ar = {0};
+  if (arena_init(&ar, NULL, NULL) != OK) {
+    fprintf(stderr, "benchmark: arena_init failed\n");
+    return 1;
+  }
+
+  // Warm cycle so reset converges on one right-sized block before timing.
+  for (uint32_t i = 0; i < BENCH_ARENA_ALLOCS_PER_CYCLE; i++) {
+    if (!arena_alloc(&ar, alloc_sz)) {
+      fprintf(stderr, "benchmark: warmup alloc failed for %s\n", name);
+      arena_clean(&ar);
+      return 1;
+    }
+  }
+  arena_reset(&ar);
+
+  uint64_t checksum = 0;
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t c = 0; c < BENCH_ARENA_CYCLES; c++) {
+    for (uint32_t i = 0; i < BENCH_ARENA_ALLOCS_PER_CYCLE; i++) {
+      char *p = (char *)arena_alloc(&ar, alloc_sz);
+      if (!p) {
+        fprintf(stderr, "benchmark: alloc failed for %s\n", name);
+        arena_clean(&ar);
+        return 1;
+      }
+      p[0] = (char)i;
+      checksum += (uint8_t)p[0];
+    }
+    arena_reset(&ar);
+  }
+  uint64_t t1 = bench_now_ns();
+  bench_perf_end();
+  bench_guard_sink ^= checksum;
+
+  bench_report("arena", name,
+               (uint64_t)BENCH_ARENA_CYCLES * BENCH_ARENA_ALLOCS_PER_CYCLE,
+               t1 - t0);
+  arena_clean(&ar);
+  return 0;
+}
+
+int main(void) {
+  int rc = 0;
+  rc |= bench_case("cycle_alloc_16b", 16);
+  rc |= bench_case("cycle_alloc_64b", 64);
+  rc |= bench_case("cycle_alloc_256b", 256);
+  return rc;
+}
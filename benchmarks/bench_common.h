@@ -0,0 +1,152 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Shared helpers for benchmarks/. Every benchmark reports one machine-
+ * readable line per case:
+ *
+ *   BENCH bench=<file> case=<case> ops=<N> ns_op=<avg>
+ *
+ * so runs from different builds can be diffed or plotted directly.
+ *
+ * On Linux, bench_perf_begin()/bench_perf_end() around the timed region
+ * additionally read hardware counters via perf_event_open (cycles,
+ * instructions, LLC misses, branch misses) and bench_report() appends them
+ * per op:
+ *
+ *   ... ns_op=<avg> cycles_op=<c> insns_op=<i> llc_miss_op=<m> br_miss_op=<b>
+ *
+ * Counters the kernel or PMU refuses to open (containers, VMs without a
+ * cache PMU, perf_event_paranoid) are silently omitted; wall-clock timing
+ * is never affected. */
+
+// Defeats dead-code elimination of benchmarked work.
+static volatile uint64_t bench_guard_sink;
+
+/* Returns current monotonic time in nanoseconds; exits on clock failure. */
+static inline uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    fprintf(stderr, "benchmark: clock_gettime failed\n");
+    exit(1);
+  }
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#if defined(__linux__)
+
+/* One hardware event: fd is -2 before the first open attempt, -1 when the
+ * kernel refused it, >= 0 when live. 'value' holds the multiplex-scaled
+ * count for the most recent measured region (-1.0 when the read failed). */
+typedef struct BenchPerfEvent {
+  const char *field;
+  uint32_t type;
+  uint64_t config;
+  int fd;
+  double value;
+} BenchPerfEvent;
+
+static BenchPerfEvent bench_perf_events[] = {
+    {"cycles_op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -2, -1.0},
+    {"insns_op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -2, -1.0},
+    {"llc_miss_op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -2, -1.0},
+    {"br_miss_op", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -2, -1.0},
+};
+#define BENCH_PERF_EVENT_N \
+  (sizeof(bench_perf_events) / sizeof(bench_perf_events[0]))
+
+// Set once bench_perf_end() captured a region; cleared by bench_report().
+static int bench_perf_sampled;
+
+// _POSIX_C_SOURCE hides the syscall() prototype; declare the glibc
+// signature locally instead of forcing _GNU_SOURCE on every benchmark.
+extern long syscall(long number, ...);
+
+/* Starts the hardware counters for one measured region; call it right
+ * before taking the region's start timestamp. The first call opens the
+ * events (user-space only, inheriting into threads spawned later). */
+static inline void bench_perf_begin(void) {
+  for (size_t i = 0; i < BENCH_PERF_EVENT_N; i++) {
+    BenchPerfEvent *ev = &bench_perf_events[i];
+    if (ev->fd == -2) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = ev->type;
+      attr.config = ev->config;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.inherit = 1;
+      // time_enabled/time_running let us scale out PMU multiplexing.
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      ev->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    if (ev->fd >= 0) {
+      ioctl(ev->fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(ev->fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+/* Stops the counters and snapshots their region totals; call it right
+ * after taking the region's end timestamp. */
+static inline void bench_perf_end(void) {
+  for (size_t i = 0; i < BENCH_PERF_EVENT_N; i++) {
+    BenchPerfEvent *ev = &bench_perf_events[i];
+    if (ev->fd < 0)
+      continue;
+    ioctl(ev->fd, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t buf[3] = {0, 0, 0}; // {count, time_enabled, time_running}
+    if (read(ev->fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf) && buf[2] > 0) {
+      ev->value = (double)buf[0] * ((double)buf[1] / (double)buf[2]);
+    } else {
+      ev->value = -1.0;
+    }
+  }
+  bench_perf_sampled = 1;
+}
+
+#else
+
+static inline void bench_perf_begin(void) {}
+static inline void bench_perf_end(void) {}
+
+#endif // __linux__
+
+/* Prints the machine-readable result line for one case, including per-op
+ * hardware counters when a bench_perf region was sampled since the last
+ * report. */
+static inline void bench_report(const char *bench, const char *name,
+                                uint64_t ops, uint64_t total_ns) {
+  printf("BENCH bench=%s case=%s ops=%llu ns_op=%.2f", bench, name,
+         (unsigned long long)ops,
+         ops ? (double)total_ns / (double)ops : 0.0);
+#if defined(__linux__)
+  if (bench_perf_sampled && ops) {
+    for (size_t i = 0; i < BENCH_PERF_EVENT_N; i++) {
+      const BenchPerfEvent *ev = &bench_perf_events[i];
+      if (ev->fd >= 0 && ev->value >= 0.0)
+        printf(" %s=%.2f", ev->field, ev->value / (double)ops);
+    }
+  }
+  bench_perf_sampled = 0;
+#endif
+  printf("\n");
+  fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+#include "bufio.h"
+#include "frame_codec.h"
+#include "stdio_byte_channel.h"
+#include "string_op.h"
+#include "utils.h"
+
+/* Measures frame_write_len()/frame_read_len() round trips over a local
+ * socketpair: one op writes one length-prefixed frame and reads it back
+ * through the kernel buffer, the same path broker<->client frames take.
+ * Each frame is drained before the next write, so the socket buffer never
+ * fills and the loop stays single-threaded. */
+
+#define BENCH_FRAME_OPS 20000u
+
+/* Runs one payload-size case; returns 0 on success, 1 on failure. */
+static int bench_case(const char *name, uint32_t payload_len) {
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+    perror("benchmark: socketpair");
+    return 1;
+  }
+
+  // One buffered channel wearing both ends: writes land on sv[0], reads
+  // drain what the kernel moved to sv[1].
+  BufChannel bc;
+  if (bufch_init(&bc, stdio_bytechannel_wrap_fd(sv[1], sv[0])) != OK) {
+    fprintf(stderr, "benchmark: channel init failed\n");
+    close(sv[0]);
+    close(sv[1]);
+    return 1;
+  }
+
+  char *payload = (char *)xmalloc(payload_len);
+  for (uint32_t i = 0; i < payload_len; i++)
+    payload[i] = (char)('a' + (i % 26u));
+
+  StrBuf in;
+  sb_init(&in);
+  uint64_t checksum = 0;
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_FRAME_OPS; i++) {
+    if (frame_write_len(&bc, payload, payload_len) != OK ||
+        frame_read_len(&bc, &in) != OK || in.len != payload_len) {
+      fprintf(stderr, "benchmark: frame round trip failed for %s\n", name);
+      sb_clean(&in);
+      free(payload);
+      bufch_clean(&bc);
+      return 1;
+    }
+    checksum += (uint8_t)in.data[0];
+    sb_reset(&in);
+  }
+  uint64_t t1 = bench_now_ns();
+  bench_perf_end();
+  bench_guard_sink ^= checksum;
+
+  bench_report("frame_codec", name, BENCH_FRAME_OPS, t1 - t0);
+  sb_clean(&in);
+  free(payload);
+  bufch_clean(&bc); // the fd wrapper is non-owning; close both ends ourselves
+  close(sv[0]);
+  close(sv[1]);
+  return 0;
+}
+
+int main(void) {
+  int rc = 0;
+  rc |= bench_case("roundtrip_64b", 64);
+  rc |= bench_case("roundtrip_4kib", 4096);
+  rc |= bench_case("roundtrip_48kib", 48 * 1024);
+  return rc;
+}
@@ -0,0 +1,100 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+#include "hash_table.h"
+#include "utils.h"
+
+/* Measures HashTable churn with short string keys (the shape of connection
+ * names, column refs, and cache keys): inserts into a growing table,
+ * hit/miss lookups, and overwrites of existing keys. */
+
+#define BENCH_HT_KEYS 100000u
+#define BENCH_HT_KEY_LEN 24u
+
+/* Fills 'keys' with BENCH_HT_KEYS distinct fixed-length keys. */
+static char *bench_make_keys(void) {
+  char *keys = (char *)xmalloc((size_t)BENCH_HT_KEYS * BENCH_HT_KEY_LEN);
+  for (uint32_t i = 0; i < BENCH_HT_KEYS; i++) {
+    snprintf(keys + (size_t)i * BENCH_HT_KEY_LEN, BENCH_HT_KEY_LEN,
+             "schema.table_%05u.col", i);
+  }
+  return keys;
+}
+
+int main(void) {
+  char *keys = bench_make_keys();
+  static int value; // any stable non-NULL pointer works as a value
+
+  HashTable *ht = ht_create();
+  if (!ht) {
+    fprintf(stderr, "benchmark: ht_create failed\n");
+    free(keys);
+    return 1;
+  }
+
+  // Fresh inserts, growth/rehash included.
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_HT_KEYS; i++) {
+    if (ht_put(ht, keys + (size_t)i * BENCH_HT_KEY_LEN, BENCH_HT_KEY_LEN,
+               &value) != OK) {
+      fprintf(stderr, "benchmark: ht_put failed\n");
+      ht_destroy(ht);
+      free(keys);
+      return 1;
+    }
+  }
+  uint64_t t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("hash_table", "put_fresh", BENCH_HT_KEYS, t1 - t0);
+
+  // Lookups that hit.
+  uint64_t checksum = 0;
+  bench_perf_begin();
+  t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_HT_KEYS; i++) {
+    const void *v =
+        ht_get(ht, keys + (size_t)i * BENCH_HT_KEY_LEN, BENCH_HT_KEY_LEN);
+    checksum += (v != NULL);
+  }
+  t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("hash_table", "get_hit", BENCH_HT_KEYS, t1 - t0);
+
+  // Lookups that miss (same shape, disjoint suffix space).
+  bench_perf_begin();
+  t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_HT_KEYS; i++) {
+    char miss[BENCH_HT_KEY_LEN];
+    memcpy(miss, keys + (size_t)i * BENCH_HT_KEY_LEN, BENCH_HT_KEY_LEN);
+    miss[0] = 'x';
+    checksum += (ht_get(ht, miss, BENCH_HT_KEY_LEN) != NULL);
+  }
+  t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("hash_table", "get_miss", BENCH_HT_KEYS, t1 - t0);
+
+  // Overwrites of live keys (steady-state cache updates).
+  bench_perf_begin();
+  t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_HT_KEYS; i++) {
+    if (ht_put(ht, keys + (size_t)i * BENCH_HT_KEY_LEN, BENCH_HT_KEY_LEN,
+               &value) != OK) {
+      fprintf(stderr, "benchmark: ht_put overwrite failed\n");
+      ht_destroy(ht);
+      free(keys);
+      return 1;
+    }
+  }
+  t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("hash_table", "put_overwrite", BENCH_HT_KEYS, t1 - t0);
+
+  bench_guard_sink ^= checksum;
+  ht_destroy(ht);
+  free(keys);
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+#include "json_codec.h"
+#include "query_result.h"
+#include "utils.h"
+
+/* Measures qr_to_jsonrpc() over synthetic results: a narrow shape (few
+ * columns, many rows, the common OLTP reply) and a wide one (many columns,
+ * fewer rows, reporting-style). One op = one full serialization. */
+
+#define BENCH_SERIALIZE_OPS 200u
+
+/* Builds one QR_OK result of ncols x nrows with 'cell_len'-byte text cells.
+ * Returns NULL on allocation/build failure. */
+static QueryResult *bench_make_result(uint32_t ncols, uint32_t nrows,
+                                      uint32_t cell_len) {
+  QueryResult *qr = qr_create_ok(NULL, ncols, nrows, 0, 0);
+  if (!qr)
+    return NULL;
+  QueryResultBuilder qb = {0};
+  if (qb_init(&qb, qr, NULL) != OK) {
+    qr_destroy(qr);
+    return NULL;
+  }
+
+  char cell[256];
+  if (cell_len >= sizeof(cell))
+    cell_len = sizeof(cell) - 1;
+  for (uint32_t i = 0; i < cell_len; i++)
+    cell[i] = (char)('a' + (i % 26u));
+  cell[cell_len] = '\0';
+
+  for (uint32_t c = 0; c < ncols; c++) {
+    char name[32];
+    snprintf(name, sizeof(name), "col%u", c);
+    if (qb_set_col(&qb, c, name, "text", 0) != OK) {
+      qr_destroy(qr);
+      return NULL;
+    }
+  }
+  for (uint32_t r = 0; r < nrows; r++) {
+    for (uint32_t c = 0; c < ncols; c++) {
+      if (qb_set_cell(&qb, r, c, cell, cell_len) != YES) {
+        qr_destroy(qr);
+        return NULL;
+      }
+    }
+  }
+  return qr;
+}
+
+/* Runs one serialization case and reports ns per qr_to_jsonrpc() call.
+ * Returns 0 on success, 1 on failure. */
+static int bench_case(const char *name, uint32_t ncols, uint32_t nrows,
+                      uint32_t cell_len) {
+  QueryResult *qr = bench_make_result(ncols, nrows, cell_len);
+  if (!qr) {
+    fprintf(stderr, "benchmark: failed to build %s result\n", name);
+    return 1;
+  }
+
+  uint64_t checksum = 0;
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_SERIALIZE_OPS; i++) {
+    char *json = NULL;
+    size_t json_len = 0;
+    if (qr_to_jsonrpc(qr, &json, &json_len) != OK) {
+      fprintf(stderr, "benchmark: serialization failed for %s\n", name);
+      qr_destroy(qr);
+      return 1;
+    }
+    checksum += (uint8_t)json[0] + json_len;
+    free(json);
+  }
+  uint64_t t1 = bench_now_ns();
+  bench_perf_end();
+  bench_guard_sink ^= checksum;
+
+  bench_report("json_codec", name, BENCH_SERIALIZE_OPS, t1 - t0);
+  qr_destroy(qr);
+  return 0;
+}
+
+int main(void) {
+  int rc = 0;
+  rc |= bench_case("narrow_4x1000", 4, 1000, 16);
+  rc |= bench_case("wide_64x100", 64, 100, 16);
+  rc |= bench_case("narrow_big_cells_4x500", 4, 500, 200);
+  return rc;
+}
@@ -0,0 +1,387 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_common.h"
+#include "broker.h"
+#include "bufio.h"
+#include "conn_catalog.h"
+#include "conn_manager.h"
+#include "file_io.h"
+#include "frame_codec.h"
+#include "handshake_codec.h"
+#include "latency_hist.h"
+#include "mock_backend.h"
+#include "private_dir.h"
+#include "secret_store.h"
+#include "stdio_byte_channel.h"
+#include "string_op.h"
+#include "utils.h"
+
+/* End-to-end replay benchmark: spins up a real Broker over a mock DbBackend
+ * (via connm_create_with_factory), handshakes through the unix socket like a
+ * real client, then replays JSON-RPC frames and times each full round trip.
+ * This covers the event loop, frame codec, JSON parsing, dispatch, connection
+ * checkout, validation, and response serialization together, so regressions
+ * that hide between the per-module benchmarks show up here.
+ *
+ * Default mode replays a synthetic mix of 'stats' and 'run_sql_query' calls.
+ * With an argument, each line of the given file is replayed verbatim as one
+ * JSON-RPC request frame (one response awaited per line), so captured MCP
+ * traces can be driven through the loop. */
+
+#define BENCH_REPLAY_OPS 4000u
+#define BENCH_REPLAY_LINE_MAX 4096u
+
+/* ---------------------------- mock secret store -------------------------- */
+
+static AdbxTriStatus bench_ss_get(SecretStore *store, const SecretRefInfo *ref,
+                                  StrBuf *out) {
+  (void)store;
+  (void)ref;
+  if (!out)
+    return ERR;
+  return sb_append_bytes(out, "bench", 6) == OK ? YES : ERR;
+}
+
+static AdbxStatus bench_ss_set(SecretStore *store, const SecretRefInfo *ref,
+                               const char *secret) {
+  (void)store;
+  (void)ref;
+  (void)secret;
+  return OK;
+}
+
+static AdbxStatus bench_ss_delete(SecretStore *store,
+                                  const SecretRefInfo *ref) {
+  (void)store;
+  (void)ref;
+  return OK;
+}
+
+static AdbxStatus bench_ss_wipe_namespace(SecretStore *store,
+                                          const char *cred_namespace) {
+  (void)store;
+  (void)cred_namespace;
+  return OK;
+}
+
+static AdbxStatus bench_ss_wipe_all(SecretStore *store) {
+  (void)store;
+  return OK;
+}
+
+static void bench_ss_destroy(SecretStore *store) { free(store); }
+
+static const SecretStoreVTable BENCH_SS_VT = {
+    .get = bench_ss_get,
+    .set = bench_ss_set,
+    .delete = bench_ss_delete,
+    .wipe_namespace = bench_ss_wipe_namespace,
+    .wipe_all = bench_ss_wipe_all,
+    .destroy = bench_ss_destroy,
+};
+
+static SecretStore *bench_secret_store(void) {
+  SecretStore *s = (SecretStore *)xcalloc(1, sizeof(*s));
+  s->vt = &BENCH_SS_VT;
+  return s;
+}
+
+/* -------------------------------- fixture -------------------------------- */
+
+static const char BENCH_CONFIG_JSON[] =
+    "{\n"
+    "  \"version\": \"1.0\",\n"
+    "  \"credentialNamespace\": \"BenchReplay\",\n"
+    "  \"safetyPolicy\": {\n"
+    "    \"readOnly\": \"yes\",\n"
+    "    \"statementTimeoutMs\": 5000,\n"
+    "    \"maxRowReturned\": 200,\n"
+    "    \"maxPayloadKiloBytes\": 64\n"
+    "  },\n"
+    "  \"databases\": [\n"
+    "    {\n"
+    "      \"type\": \"postgres\",\n"
+    "      \"connectionName\": \"BenchDb\",\n"
+    "      \"host\": \"127.0.0.1\",\n"
+    "      \"port\": 5432,\n"
+    "      \"username\": \"bench\",\n"
+    "      \"database\": \"bench\"\n"
+    "    }\n"
+    "  ]\n"
+    "}\n";
+
+/* Builds a catalog from the embedded config through the real parser.
+ * Returns a caller-owned catalog, NULL on failure. */
+static ConnCatalog *bench_make_catalog(void) {
+  char path[] = "/tmp/bench_replay_cfg_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("benchmark: mkstemp");
+    return NULL;
+  }
+  size_t len = sizeof(BENCH_CONFIG_JSON) - 1u;
+  if (write(fd, BENCH_CONFIG_JSON, len) != (ssize_t)len) {
+    perror("benchmark: config write");
+    close(fd);
+    unlink(path);
+    return NULL;
+  }
+
+  char *err = NULL;
+  ConnCatalog *cat = catalog_load_from_fd(fd, &err);
+  close(fd);
+  unlink(path);
+  if (!cat) {
+    fprintf(stderr, "benchmark: catalog load failed: %s\n",
+            err ? err : "unknown");
+    free(err);
+  }
+  return cat;
+}
+
+static void *broker_run_thread(void *arg) {
+  broker_run((Broker *)arg);
+  return NULL;
+}
+
+/* Connects to the broker socket and completes the handshake over 'out_bc'.
+ * Returns the connected fd (owned by caller), -1 on failure. */
+static int bench_connect_hs(const PrivDir *pd, BufChannel *out_bc) {
+  uint8_t secret[SECRET_TOKEN_LEN];
+  if (fileio_read_exact(pd->token_path, SECRET_TOKEN_LEN, secret) != OK) {
+    fprintf(stderr, "benchmark: failed to read broker secret token\n");
+    return -1;
+  }
+
+  int cfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (cfd < 0) {
+    perror("benchmark: socket");
+    return -1;
+  }
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, pd->sock_path, sizeof(addr.sun_path) - 1);
+  if (connect(cfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    perror("benchmark: connect");
+    close(cfd);
+    return -1;
+  }
+
+  if (bufch_init(out_bc, stdio_bytechannel_wrap_fd(cfd, cfd)) != OK) {
+    fprintf(stderr, "benchmark: channel init failed\n");
+    close(cfd);
+    return -1;
+  }
+
+  handshake_req_t req;
+  memset(&req, 0, sizeof(req));
+  req.magic = HANDSHAKE_MAGIC;
+  req.version = HANDSHAKE_VERSION;
+  memcpy(req.secret_token, secret, SECRET_TOKEN_LEN);
+  uint8_t wire[HANDSHAKE_REQ_WIRE_SIZE];
+  if (handshake_req_encode(&req, wire) != OK ||
+      frame_write_len(out_bc, (const char *)wire, sizeof(wire)) != OK) {
+    fprintf(stderr, "benchmark: handshake send failed\n");
+    bufch_clean(out_bc);
+    close(cfd);
+    return -1;
+  }
+
+  StrBuf resp_buf;
+  sb_init(&resp_buf);
+  handshake_resp_t resp = {0};
+  if (frame_read_len(out_bc, &resp_buf) != OK ||
+      handshake_resp_decode(&resp, (const uint8_t *)resp_buf.data,
+                            resp_buf.len) != OK ||
+      resp.status != HS_OK) {
+    fprintf(stderr, "benchmark: handshake rejected\n");
+    sb_clean(&resp_buf);
+    bufch_clean(out_bc);
+    close(cfd);
+    return -1;
+  }
+  sb_clean(&resp_buf);
+  return cfd;
+}
+
+/* --------------------------------- replay -------------------------------- */
+
+/* Sends one request frame, awaits its response, and records the round trip.
+ * Returns OK on success, ERR on I/O failure. */
+static AdbxStatus bench_roundtrip(BufChannel *bc, const char *req, size_t len,
+                                  StrBuf *resp, LatencyHist *hist) {
+  uint64_t t0 = now_us_monotonic();
+  if (frame_write_len(bc, req, len) != OK || frame_read_len(bc, resp) != OK)
+    return ERR;
+  lhist_record(hist, now_us_monotonic() - t0);
+  bench_guard_sink ^= (uint8_t)resp->data[0];
+  sb_reset(resp);
+  return OK;
+}
+
+/* Replays the default synthetic mix: alternating 'stats' and 'run_sql_query'
+ * calls. Returns total replayed ops, 0 on failure. */
+static uint64_t bench_replay_synthetic(BufChannel *bc, StrBuf *resp,
+                                       LatencyHist *hist) {
+  char req[512];
+  for (uint32_t i = 0; i < BENCH_REPLAY_OPS; i++) {
+    int len;
+    if (i % 2u == 0) {
+      len = snprintf(req, sizeof(req),
+                     "{\"jsonrpc\":\"2.0\",\"id\":%u,\"method\":\"tools/call\","
+                     "\"params\":{\"name\":\"stats\",\"arguments\":{}}}",
+                     i + 1u);
+    } else {
+      len = snprintf(
+          req, sizeof(req),
+          "{\"jsonrpc\":\"2.0\",\"id\":%u,\"method\":\"tools/call\","
+          "\"params\":{\"name\":\"run_sql_query\",\"arguments\":{"
+          "\"connectionName\":\"BenchDb\",\"query\":\"SELECT id, name FROM "
+          "bench_t WHERE id < %u\"}}}",
+          i + 1u, i);
+    }
+    if (len <= 0 || (size_t)len >= sizeof(req))
+      return 0;
+    if (bench_roundtrip(bc, req, (size_t)len, resp, hist) != OK) {
+      fprintf(stderr, "benchmark: round trip %u failed\n", i);
+      return 0;
+    }
+  }
+  return BENCH_REPLAY_OPS;
+}
+
+/* Replays one JSON-RPC request per line of 'path', awaiting one response
+ * each. Returns total replayed ops, 0 on failure or empty file. */
+static uint64_t bench_replay_file(const char *path, BufChannel *bc,
+                                  StrBuf *resp, LatencyHist *hist) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror("benchmark: corpus open");
+    return 0;
+  }
+
+  char line[BENCH_REPLAY_LINE_MAX];
+  uint64_t ops = 0;
+  while (fgets(line, sizeof(line), f)) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+      len--;
+    if (len == 0)
+      continue;
+    if (bench_roundtrip(bc, line, len, resp, hist) != OK) {
+      fprintf(stderr, "benchmark: round trip failed at corpus line %llu\n",
+              (unsigned long long)(ops + 1u));
+      fclose(f);
+      return 0;
+    }
+    ops++;
+  }
+  fclose(f);
+  return ops;
+}
+
+int main(int argc, char **argv) {
+  const char *corpus = argc > 1 ? argv[1] : NULL;
+
+  const char *tmpl = "/tmp/bench_replay_XXXXXX";
+  char tmpdir[64];
+  strcpy(tmpdir, tmpl);
+  if (!mkdtemp(tmpdir)) {
+    perror("benchmark: mkdtemp");
+    return 1;
+  }
+  PrivDir *pd = privdir_resolve(tmpdir, NULL);
+  if (!pd) {
+    fprintf(stderr, "benchmark: privdir_resolve failed\n");
+    return 1;
+  }
+
+  ConnCatalog *cat = bench_make_catalog();
+  if (!cat)
+    return 1;
+  // Synthetic execution with no artificial latency: round trips measure the
+  // broker loop, not a pretend database.
+  MockBackendConfig mock_cfg = {
+      .min_latency_us = 0,
+      .max_latency_us = 0,
+      .ncols = 4,
+      .nrows = 10,
+      .cell_len = 16,
+  };
+  mock_backend_configure(&mock_cfg);
+  ConnManager *cm =
+      connm_create_with_factory(cat, bench_secret_store(), mock_backend_create);
+  if (!cm) {
+    fprintf(stderr, "benchmark: connm create failed\n");
+    return 1;
+  }
+  Broker *b = broker_create(pd, cm);
+  if (!b) {
+    fprintf(stderr, "benchmark: broker create failed\n");
+    return 1;
+  }
+
+  pthread_t tid;
+  if (pthread_create(&tid, NULL, broker_run_thread, b) != 0) {
+    fprintf(stderr, "benchmark: broker thread start failed\n");
+    return 1;
+  }
+
+  BufChannel bc;
+  int cfd = bench_connect_hs(pd, &bc);
+  if (cfd < 0)
+    return 1;
+
+  StrBuf resp;
+  sb_init(&resp);
+  LatencyHist hist;
+  lhist_init(&hist);
+
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  uint64_t ops = corpus ? bench_replay_file(corpus, &bc, &resp, &hist)
+                        : bench_replay_synthetic(&bc, &resp, &hist);
+  uint64_t total_ns = bench_now_ns() - t0;
+  bench_perf_end();
+  int rc = ops == 0;
+
+  const char *case_name = corpus ? "corpus" : "mixed";
+  if (ops > 0) {
+    bench_report("replay", case_name, ops, total_ns);
+    printf("REPLAY case=%s rps=%.0f p50_us=%llu p90_us=%llu p99_us=%llu "
+           "max_us=%llu\n",
+           case_name, (double)ops * 1e9 / (double)total_ns,
+           (unsigned long long)lhist_value_at_percentile(&hist, 50),
+           (unsigned long long)lhist_value_at_percentile(&hist, 90),
+           (unsigned long long)lhist_value_at_percentile(&hist, 99),
+           (unsigned long long)lhist_max(&hist));
+    fflush(stdout);
+  }
+
+  sb_clean(&resp);
+  bufch_clean(&bc); // non-owning fd wrapper; close the socket ourselves
+  close(cfd);
+
+  pthread_cancel(tid);
+  pthread_join(tid, NULL);
+  broker_destroy(b);
+  privdir_clean(pd);
+  // Best effort: remove the app dir and temp root the broker created.
+  char app_dir[96];
+  snprintf(app_dir, sizeof(app_dir), "%s/%s", tmpdir, PRIVDIR_APP_DIRNAME);
+  rmdir(app_dir);
+  rmdir(tmpdir);
+  return rc;
+}
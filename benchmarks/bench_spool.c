@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_common.h"
+#include "spool.h"
+#include "utils.h"
+
+/* Measures StringPool interning: the hit path (a small vocabulary of
+ * schema/table/column names interned over and over, the broker's steady
+ * state) and the fresh path (every string new to the pool). */
+
+#define BENCH_SPOOL_OPS 200000u
+#define BENCH_SPOOL_VOCAB 64u
+#define BENCH_SPOOL_NAME_LEN 24u
+
+/* Fills 'n' distinct fixed-length names starting at ordinal 'base'. */
+static char *bench_make_names(uint32_t base, uint32_t n) {
+  char *names = (char *)xmalloc((size_t)n * BENCH_SPOOL_NAME_LEN);
+  for (uint32_t i = 0; i < n; i++) {
+    snprintf(names + (size_t)i * BENCH_SPOOL_NAME_LEN, BENCH_SPOOL_NAME_LEN,
+             "public.tbl_%06u.col", base + i);
+  }
+  return names;
+}
+
+int main(void) {
+  StringPool sp;
+  if (spool_init(&sp) != OK) {
+    fprintf(stderr, "benchmark: spool_init failed\n");
+    return 1;
+  }
+
+  // Hit path: a warm vocabulary where every spool_addn resolves to an
+  // already-interned pointer.
+  char *vocab = bench_make_names(0, BENCH_SPOOL_VOCAB);
+  for (uint32_t i = 0; i < BENCH_SPOOL_VOCAB; i++) {
+    if (!spool_addn(&sp, vocab + (size_t)i * BENCH_SPOOL_NAME_LEN,
+                    BENCH_SPOOL_NAME_LEN - 1u)) {
+      fprintf(stderr, "benchmark: vocab intern failed\n");
+      spool_clean(&sp);
+      free(vocab);
+      return 1;
+    }
+  }
+  uint64_t checksum = 0;
+  bench_perf_begin();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_SPOOL_OPS; i++) {
+    const char *s =
+        spool_addn(&sp, vocab + (size_t)(i % BENCH_SPOOL_VOCAB) *
+                            BENCH_SPOOL_NAME_LEN,
+                   BENCH_SPOOL_NAME_LEN - 1u);
+    checksum += (uint8_t)s[0];
+  }
+  uint64_t t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("spool", "addn_hit", BENCH_SPOOL_OPS, t0 < t1 ? t1 - t0 : 0);
+  free(vocab);
+  spool_clean(&sp);
+
+  // Fresh path: every name is new, so each op pays hash insert + arena copy.
+  uint32_t fresh_ops = BENCH_SPOOL_OPS / 4u;
+  char *fresh = bench_make_names(BENCH_SPOOL_VOCAB, fresh_ops);
+  if (spool_init(&sp) != OK) {
+    fprintf(stderr, "benchmark: spool re-init failed\n");
+    free(fresh);
+    return 1;
+  }
+  bench_perf_begin();
+  t0 = bench_now_ns();
+  for (uint32_t i = 0; i < fresh_ops; i++) {
+    const char *s = spool_addn(&sp, fresh + (size_t)i * BENCH_SPOOL_NAME_LEN,
+                               BENCH_SPOOL_NAME_LEN - 1u);
+    if (!s) {
+      fprintf(stderr, "benchmark: fresh intern failed\n");
+      spool_clean(&sp);
+      free(fresh);
+      return 1;
+    }
+    checksum += (uint8_t)s[0];
+  }
+  t1 = bench_now_ns();
+  bench_perf_end();
+  bench_report("spool", "addn_fresh", fresh_ops, t1 - t0);
+
+  bench_guard_sink ^= checksum;
+  spool_clean(&sp);
+  free(fresh);
+  return 0;
+}
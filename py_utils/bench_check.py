@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Compares one benchmark run against the checked-in baseline and fails on
+regression. Used by `make bench-check`.
+
+Input is a file of the BENCH lines every benchmark binary prints:
+
+  BENCH bench=<file> case=<case> ops=<N> ns_op=<avg> [counter_op=<v> ...]
+
+The baseline is JSON: {"tolerance_pct": <default>, "cases": {"<bench>/<case>":
+<ns_op>, ...}}. A case regresses when its ns_op exceeds the baseline by more
+than the tolerance (CLI --tolerance overrides the file's default) AND by more
+than --min-delta-ns, so single-digit-nanosecond cases cannot fail the gate on
+scheduler jitter alone. Cases the baseline does not know are reported as new
+but do not fail the run; baseline cases missing from the results fail it, so
+a benchmark cannot silently vanish.
+
+Usage:
+  py_utils/bench_check.py build/bench_results.txt
+  py_utils/bench_check.py build/bench_results.txt --tolerance 5
+  py_utils/bench_check.py build/bench_results.txt --update   # re-baseline
+"""
+import argparse
+import json
+import os
+import re
+import sys
+
+DEFAULT_BASELINE = os.path.join(
+    os.path.abspath(os.path.join(os.path.dirname(__file__), "..")),
+    "benchmarks",
+    "bench_baseline.json",
+)
+DEFAULT_TOLERANCE_PCT = 10.0
+DEFAULT_MIN_DELTA_NS = 5.0
+
+BENCH_LINE = re.compile(
+    r"^BENCH\s+bench=(?P<bench>\S+)\s+case=(?P<case>\S+)"
+    r"\s+ops=\d+\s+ns_op=(?P<ns_op>[0-9.]+)"
+)
+
+
+def parse_results(path):
+    """Returns {"<bench>/<case>": ns_op} from one results file."""
+    cases = {}
+    with open(path, "r", encoding="utf-8") as fh:
+        for line in fh:
+            m = BENCH_LINE.match(line.strip())
+            if not m:
+                continue
+            key = "%s/%s" % (m.group("bench"), m.group("case"))
+            if key in cases:
+                sys.stderr.write("error: duplicate case %s in %s\n" % (key, path))
+                sys.exit(2)
+            cases[key] = float(m.group("ns_op"))
+    if not cases:
+        sys.stderr.write("error: no BENCH lines found in %s\n" % path)
+        sys.exit(2)
+    return cases
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("results", help="file holding the run's BENCH lines")
+    ap.add_argument("--baseline", default=DEFAULT_BASELINE)
+    ap.add_argument(
+        "--tolerance",
+        type=float,
+        default=None,
+        help="allowed ns_op growth in percent (default: baseline file value)",
+    )
+    ap.add_argument(
+        "--min-delta-ns",
+        type=float,
+        default=DEFAULT_MIN_DELTA_NS,
+        help="absolute ns_op growth a regression must also exceed",
+    )
+    ap.add_argument(
+        "--update",
+        action="store_true",
+        help="rewrite the baseline from this run instead of comparing",
+    )
+    args = ap.parse_args()
+
+    cases = parse_results(args.results)
+
+    if args.update:
+        tolerance = args.tolerance if args.tolerance is not None else DEFAULT_TOLERANCE_PCT
+        if os.path.exists(args.baseline):
+            with open(args.baseline, "r", encoding="utf-8") as fh:
+                old = json.load(fh)
+            if args.tolerance is None:
+                tolerance = old.get("tolerance_pct", DEFAULT_TOLERANCE_PCT)
+        with open(args.baseline, "w", encoding="utf-8") as fh:
+            json.dump(
+                {"tolerance_pct": tolerance, "cases": dict(sorted(cases.items()))},
+                fh,
+                indent=2,
+            )
+            fh.write("\n")
+        print("baseline updated: %s (%d cases)" % (args.baseline, len(cases)))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        sys.stderr.write(
+            "error: baseline %s not found; run with --update to create it\n"
+            % args.baseline
+        )
+        return 2
+    with open(args.baseline, "r", encoding="utf-8") as fh:
+        baseline = json.load(fh)
+    base_cases = baseline.get("cases", {})
+    tolerance = args.tolerance
+    if tolerance is None:
+        tolerance = baseline.get("tolerance_pct", DEFAULT_TOLERANCE_PCT)
+
+    regressions = []
+    missing = []
+    for key, base_ns in sorted(base_cases.items()):
+        if key not in cases:
+            missing.append(key)
+            continue
+        ns = cases[key]
+        delta_pct = (ns - base_ns) / base_ns * 100.0 if base_ns > 0 else 0.0
+        status = "ok"
+        if delta_pct > tolerance and (ns - base_ns) > args.min_delta_ns:
+            status = "REGRESSION"
+            regressions.append(key)
+        print(
+            "%-11s %-48s %10.1f -> %10.1f ns_op  (%+6.1f%%)"
+            % (status, key, base_ns, ns, delta_pct)
+        )
+    for key in sorted(set(cases) - set(base_cases)):
+        print("%-11s %-48s %23.1f ns_op  (no baseline)" % ("new", key, cases[key]))
+
+    for key in missing:
+        sys.stderr.write("error: baseline case %s missing from results\n" % key)
+    if regressions:
+        sys.stderr.write(
+            "FAIL: %d case(s) regressed past %.1f%% tolerance\n"
+            % (len(regressions), tolerance)
+        )
+    if regressions or missing:
+        return 1
+    print("bench-check OK: %d cases within %.1f%% tolerance" % (len(base_cases), tolerance))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,9 +1,17 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "arena.h"
+#include "perf_counters.h"
 #include "utils.h"
 
 /*------------------------------------ helpers ------------------------------*/
@@ -22,17 +30,186 @@ typedef struct ArenaBlock {
   struct ArenaBlock *next;
   uint32_t used;
   uint32_t cap;
+  uint8_t is_mapped; // 1 when the block came from mmap, not malloc
   _Alignas(sizeof(uintptr_t)) uint8_t data[];
 } ArenaBlock;
 
+/*-------------------------------- block pool -------------------------------*/
+
+/* Every request cycle creates and destroys several arenas (query IR, result
+ * text, validator plan), all drawing blocks from the same doubling size
+ * progression. Recycling freed blocks through a process-wide pool makes
+ * steady-state request handling allocation-free at the block level.
+ *
+ * Blocks are bucketed by the power-of-two floor of their capacity. A request
+ * for 'cap' bytes draws from the bucket of the power-of-two ceiling of 'cap',
+ * so every pooled block in that bucket is guaranteed to fit it. Each bucket
+ * holds at most ARENA_POOL_PER_BUCKET blocks; anything past that, or outside
+ * the pooled size range, goes straight to free().
+ *
+ * Pooled blocks keep their bytes as-is: callers holding secrets must
+ * arena_zero_mem() before clean/destroy, which is already the contract. */
+#define ARENA_POOL_MIN_SHIFT 10u // blocks under 1 KiB are freed eagerly
+#define ARENA_POOL_MAX_SHIFT 20u // blocks over 1 MiB are freed eagerly
+#define ARENA_POOL_BUCKETS (ARENA_POOL_MAX_SHIFT - ARENA_POOL_MIN_SHIFT + 1u)
+#define ARENA_POOL_PER_BUCKET 32u
+
+static pthread_mutex_t arena_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static ArenaBlock *arena_pool[ARENA_POOL_BUCKETS];
+static uint32_t arena_pool_len[ARENA_POOL_BUCKETS];
+
+/*------------------------------- mapped blocks -----------------------------*/
+
+/* Blocks at or above this size come from mmap instead of malloc. The kernel
+ * can then back them with transparent huge pages (fewer TLB misses while a
+ * multi-MB result arena is filled and serialized), and releasing them is a
+ * munmap that hands the pages straight back, so RSS decays right after a
+ * result burst instead of lingering in the malloc heap. The pool never sees
+ * them — it caps at 1 MiB — so a released mapped block always unmaps. */
+#define ARENA_MMAP_THRESHOLD (2u * 1024u * 1024u)
+
+#ifdef __linux__
+
+/* Bytes mapped for a block of capacity 'cap': header plus payload, rounded
+ * up to whole pages. */
+static size_t arena_block_map_len(uint32_t cap) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t need = sizeof(ArenaBlock) + (size_t)cap;
+  return (need + page - 1u) & ~(page - 1u);
+}
+
+/* Maps a block of capacity 'cap', or returns NULL so the caller falls back
+ * to malloc — mapping is an optimization, never a requirement. */
+static ArenaBlock *arena_block_map(uint32_t cap) {
+  size_t len = arena_block_map_len(cap);
+  void *p =
+      mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+           0);
+  if (p == MAP_FAILED)
+    return NULL;
+#ifdef MADV_HUGEPAGE
+  // Advisory: huge pages when THP is enabled, silently nothing otherwise.
+  (void)madvise(p, len, MADV_HUGEPAGE);
+#endif
+  ArenaBlock *b = p;
+  b->next = NULL;
+  b->used = 0;
+  b->cap = cap;
+  b->is_mapped = 1;
+  return b;
+}
+
+static void arena_block_unmap(ArenaBlock *b) {
+  (void)munmap(b, arena_block_map_len(b->cap));
+}
+
+/* Tells the kernel the payload pages of a retained mapped block are
+ * discardable: the reservation stays warm for the next fill, but physical
+ * pages can be reclaimed under pressure. Only whole pages past the block
+ * header qualify; the header page itself stays live. */
+static void arena_block_discard_pages(ArenaBlock *b) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  uintptr_t start = ((uintptr_t)b->data + page - 1u) & ~((uintptr_t)page - 1u);
+  uintptr_t end = (uintptr_t)b + arena_block_map_len(b->cap);
+  if (end <= start)
+    return;
+#ifdef MADV_FREE
+  // MADV_FREE is lazy (pages cost nothing unless pressure hits); fall back
+  // to the eager DONTNEED on kernels that predate it.
+  if (madvise((void *)start, end - start, MADV_FREE) == 0)
+    return;
+#endif
+  (void)madvise((void *)start, end - start, MADV_DONTNEED);
+}
+
+#endif /* __linux__ */
+
+/* Returns the largest s with (1u << s) <= x. 'x' must be non-zero. */
+static inline uint32_t arena_log2_floor_u32(uint32_t x) {
+  uint32_t s = 0;
+  while (x >>= 1)
+    s++;
+  return s;
+}
+
+/* Returns the smallest s with (1u << s) >= x. 'x' must be non-zero. */
+static inline uint32_t arena_log2_ceil_u32(uint32_t x) {
+  uint32_t s = arena_log2_floor_u32(x);
+  return arena_is_power_of_two_u32(x) ? s : s + 1u;
+}
+
+/* Pops a pooled block that fits at least 'cap' bytes, or NULL. */
+static ArenaBlock *arena_pool_acquire(uint32_t cap) {
+  if (cap == 0)
+    return NULL;
+  uint32_t shift = arena_log2_ceil_u32(cap);
+  if (shift < ARENA_POOL_MIN_SHIFT || shift > ARENA_POOL_MAX_SHIFT)
+    return NULL;
+  uint32_t idx = shift - ARENA_POOL_MIN_SHIFT;
+
+  pthread_mutex_lock(&arena_pool_lock);
+  ArenaBlock *b = arena_pool[idx];
+  if (b) {
+    arena_pool[idx] = b->next;
+    arena_pool_len[idx]--;
+  }
+  pthread_mutex_unlock(&arena_pool_lock);
+
+  if (b) {
+    b->next = NULL;
+    b->used = 0;
+  }
+  return b;
+}
+
+/* Returns 'b' to the pool, or frees it when its bucket is full or its size
+ * is outside the pooled range. */
+static void arena_pool_release(ArenaBlock *b) {
+#ifdef __linux__
+  if (b->is_mapped) {
+    arena_block_unmap(b);
+    return;
+  }
+#endif
+  uint32_t shift = (b->cap == 0) ? 0 : arena_log2_floor_u32(b->cap);
+  if (shift < ARENA_POOL_MIN_SHIFT || shift > ARENA_POOL_MAX_SHIFT) {
+    free(b);
+    return;
+  }
+  uint32_t idx = shift - ARENA_POOL_MIN_SHIFT;
+
+  pthread_mutex_lock(&arena_pool_lock);
+  if (arena_pool_len[idx] >= ARENA_POOL_PER_BUCKET) {
+    pthread_mutex_unlock(&arena_pool_lock);
+    free(b);
+    return;
+  }
+  b->next = arena_pool[idx];
+  arena_pool[idx] = b;
+  arena_pool_len[idx]++;
+  pthread_mutex_unlock(&arena_pool_lock);
+}
+
 /*---------------------------------------------------------------------------*/
 
-/* Allocates a new block with capacity 'cap'. */
+/* Allocates a new block with capacity 'cap', recycling a pooled block that
+ * fits when one is available. A recycled block may be larger than 'cap'. */
 static ArenaBlock *arena_block_create(uint32_t cap) {
-  ArenaBlock *b = xmalloc(sizeof(*b) + cap);
+  ArenaBlock *b = arena_pool_acquire(cap);
+  if (b)
+    return b;
+#ifdef __linux__
+  if (cap >= ARENA_MMAP_THRESHOLD) {
+    b = arena_block_map(cap);
+    if (b)
+      return b;
+  }
+#endif
+  b = xmalloc(sizeof(*b) + cap);
   b->next = NULL;
   b->used = 0;
   b->cap = cap;
+  b->is_mapped = 0;
   return b;
 }
 
@@ -61,6 +238,8 @@ AdbxStatus arena_init(Arena *ar, uint32_t *size_p, uint32_t *cap_p) {
   ar->used = 0;
   ar->cap = cap;
   ar->block_sz = size;
+  ar->peak_used = 0;
+  ar->n_blocks = 1;
 
   return OK;
 }
@@ -90,9 +269,9 @@ void arena_destroy(Arena *ar) {
   free(ar);
 }
 
-/* Frees all blocks owned by the arena but keeps the arena object.
+/* Releases all blocks owned by the arena but keeps the arena object.
  * Ownership: caller retains 'ar' for reuse.
- * Side effects: frees memory.
+ * Side effects: returns blocks to the process-wide pool (or frees them).
  * Returns void. */
 void arena_clean(Arena *ar) {
   if (!ar)
@@ -100,7 +279,7 @@ void arena_clean(Arena *ar) {
   ArenaBlock *b = ar->head;
   while (b) {
     ArenaBlock *next = b->next;
-    free(b);
+    arena_pool_release(b);
     b = next;
   }
   ar->head = NULL;
@@ -108,6 +287,41 @@ void arena_clean(Arena *ar) {
   ar->used = 0;
   ar->cap = 0;
   ar->block_sz = 0;
+  ar->peak_used = 0;
+  ar->n_blocks = 0;
+}
+
+/* Empties the arena for reuse, retaining the largest (tail) block.
+ * Ownership: caller retains 'ar'; released blocks go to the block pool.
+ * Side effects: drops all blocks but the tail; keeps cap and peak stats.
+ * Returns void (no-op on NULL or cleaned arenas). */
+void arena_reset(Arena *ar) {
+  if (!ar || !ar->head)
+    return;
+
+  ArenaBlock *keep = ar->tail;
+  ArenaBlock *b = ar->head;
+  while (b != keep) {
+    ArenaBlock *next = b->next;
+    arena_pool_release(b);
+    b = next;
+  }
+  keep->next = NULL;
+  keep->used = 0;
+#ifdef __linux__
+  // A retained mapped block can span tens of MB after a large result. Its
+  // contents are dead once reset, so hint the pages discardable and let RSS
+  // decay while the block stays warm for the next fill.
+  if (keep->is_mapped)
+    arena_block_discard_pages(keep);
+#endif
+  ar->head = keep;
+  ar->tail = keep;
+  ar->used = 0;
+  // Future growth doubles past the retained block; peak_used keeps the
+  // sizing signal so the next fill converges instead of starting cold.
+  ar->block_sz = keep->cap;
+  ar->n_blocks = 1;
 }
 
 void arena_zero_mem(Arena *ar) {
@@ -125,7 +339,7 @@ AdbxTriStatus arena_is_zeroed(const Arena *ar) {
   if (!ar)
     return ERR;
   if (ar->head || ar->tail || ar->used != 0 || ar->cap != 0 ||
-      ar->block_sz != 0) {
+      ar->block_sz != 0 || ar->peak_used != 0 || ar->n_blocks != 0) {
     return NO;
   }
   return YES;
@@ -151,7 +365,9 @@ AdbxTriStatus arena_is_ok(const Arena *ar) {
   const ArenaBlock *b = ar->head;
   const ArenaBlock *last = NULL;
   uint64_t used_sum = 0;
+  uint32_t n_blocks = 0;
   while (b) {
+    n_blocks++;
     if (b->cap == 0)
       return NO;
     if (b->used > b->cap)
@@ -169,6 +385,10 @@ AdbxTriStatus arena_is_ok(const Arena *ar) {
     return NO;
   if (used_sum != ar->used)
     return NO;
+  if (n_blocks != ar->n_blocks)
+    return NO;
+  if (ar->peak_used < ar->used)
+    return NO;
 
   return YES;
 }
@@ -220,6 +440,7 @@ AdbxStatus arena_ensure(Arena *ar, uint32_t extra) {
   ar->tail->next = nb;
   ar->tail = nb;
   ar->block_sz = new_sz;
+  ar->n_blocks++;
   return OK;
 }
 
@@ -248,6 +469,9 @@ static inline uint8_t *arena_reserve(Arena *ar, uint32_t len) {
 
   ar->tail->used += entry_sz;
   ar->used += entry_sz;
+  if (ar->used > ar->peak_used)
+    ar->peak_used = ar->used;
+  PERF_COUNT_N(PERF_ARENA_BYTES, entry_sz);
   return payload;
 }
 
@@ -298,17 +522,64 @@ uint32_t arena_get_used(Arena *ar) {
   return ar->used;
 }
 
+uint32_t arena_get_peak_used(const Arena *ar) {
+  if (!ar)
+    return 0u;
+  return ar->peak_used;
+}
+
+uint32_t arena_get_block_count(const Arena *ar) {
+  if (!ar)
+    return 0u;
+  return ar->n_blocks;
+}
+
+/* Points an empty vector at its inline slots. Returns 1 when 'v' can take
+ * the next push without growing afterwards, 0 when it still must grow. */
+static int ptrvec_ensure_inline(PtrVec *v) {
+  if (v->cap == 0) {
+    v->items = v->inline_items;
+    v->cap = PTRVEC_INLINE_CAP;
+  }
+  return v->len < v->cap;
+}
+
 AdbxStatus ptrvec_push(PtrVec *v, void *ptr) {
   if (!v)
     return ERR;
-  if (v->len + 1 > v->cap) {
-    uint32_t new_cap = v->cap ? v->cap * 2u : 8u;
+  if (!ptrvec_ensure_inline(v)) {
+    uint32_t new_cap = v->cap * 2u;
+    void **new_items;
+    if (v->on_heap) {
+      new_items = (void **)xrealloc(v->items, new_cap * sizeof(*new_items));
+    } else {
+      // Inline (or arena) storage cannot be realloc'd; copy out to heap.
+      new_items = (void **)xmalloc(new_cap * sizeof(*new_items));
+      memcpy(new_items, v->items, v->len * sizeof(*new_items));
+    }
+    v->items = new_items;
+    v->cap = new_cap;
+    v->on_heap = 1;
+  }
+  v->items[v->len++] = ptr;
+  return OK;
+}
+
+AdbxStatus ptrvec_push_arena(PtrVec *v, Arena *a, void *ptr) {
+  if (!v || !a)
+    return ERR;
+  if (!ptrvec_ensure_inline(v)) {
+    uint32_t new_cap = v->cap * 2u;
     void **new_items =
-        (void **)xrealloc(v->items, new_cap * sizeof(*new_items));
+        (void **)arena_alloc(a, (uint32_t)(new_cap * sizeof(*new_items)));
     if (!new_items)
       return ERR;
+    memcpy(new_items, v->items, v->len * sizeof(*new_items));
+    if (v->on_heap)
+      free(v->items);
     v->items = new_items;
     v->cap = new_cap;
+    v->on_heap = 0;
   }
   v->items[v->len++] = ptr;
   return OK;
@@ -327,8 +598,10 @@ void **ptrvec_flatten(PtrVec *v, Arena *a) {
 void ptrvec_clean(PtrVec *v) {
   if (!v)
     return;
-  free(v->items);
+  if (v->on_heap)
+    free(v->items);
   v->items = NULL;
   v->len = 0;
   v->cap = 0;
+  v->on_heap = 0;
 }
@@ -7,7 +7,9 @@
 /* A bump allocator that stores data in a chain of non-moving blocks.
  * Allocations are pointer-sized aligned (sizeof(uintptr_t)) with zero
  * padding between entries. The structure grows by doubling blocks, but
- * never past its cap.
+ * never past its cap. Blocks of 2 MiB and up are mmap-backed on Linux
+ * (huge-page friendly, unmapped outright on release); smaller ones come
+ * from malloc via a process-wide recycling pool.
  *
  * Layout of how an object is stored:
  * +--------------+-----------+
@@ -29,18 +31,32 @@ typedef struct {
   uint32_t used;           // total bytes used across blocks
   uint32_t cap;            // hard bytes-cap for total used
   uint32_t block_sz;       // size of the next block to allocate
+  uint32_t peak_used;      // high-water mark of 'used'; survives arena_reset()
+  uint32_t n_blocks;       // blocks currently in the chain
 } Arena;
 
+// Slots available in a PtrVec before it spills to heap/arena storage.
+#define PTRVEC_INLINE_CAP 8u
+
 /* A small pointer vector used to collect elements before flattening them
  * into a Arena-owned array.
  *
- * Ownership: PtrVec owns its heap buffer; flattened arrays are arena-owned.
+ * The first PTRVEC_INLINE_CAP pushes store into the struct itself, so a
+ * zero-initialized stack vector collecting a typical clause list never
+ * touches the heap. Because 'items' then points into the struct, a non-empty
+ * vector must stay at a fixed address (stack locals passed by pointer are
+ * fine; do not memcpy/copy the struct while in use).
+ *
+ * Ownership: PtrVec owns its heap buffer when it spilled to one; inline and
+ * arena-backed storage is not freed by ptrvec_clean().
  * Side effects: ptrvec_push may allocate or reallocate the heap buffer.
  * Error semantics: functions return OK/ERR, or NULL on allocation failure. */
 typedef struct {
-  void **items;
+  void **items; // inline_items, an owned heap buffer, or arena storage
   uint32_t len;
   uint32_t cap;
+  uint8_t on_heap; // 1 when 'items' is a heap allocation owned by the vec
+  void *inline_items[PTRVEC_INLINE_CAP];
 } PtrVec;
 
 /* Allocates and returns a Arena. The first block is 1 KiB when size_p
@@ -55,9 +71,22 @@ AdbxStatus arena_init(Arena *ar, uint32_t *size_p, uint32_t *cap_p);
 /* Frees the memory used by 'ar' and its data. */
 void arena_destroy(Arena *ar);
 
-/* Frees the memory used by 'ar' but not the arena itself. */
+/* Releases the memory used by 'ar' but not the arena itself. Blocks are
+ * recycled through a process-wide pool with their bytes intact; call
+ * arena_zero_mem() first when 'ar' held data that should not be leaked. */
 void arena_clean(Arena *ar);
 
+/* Empties 'ar' for reuse while retaining warm storage: keeps the largest
+ * block in the chain (the tail, since blocks double along it) and returns the
+ * rest to the block pool. The high-water mark survives, so repeated
+ * fill/reset cycles converge to one block sized for the observed workload
+ * instead of re-walking the doubling ladder every cycle.
+ * Retained bytes are dead after reset: mmap-backed blocks get their pages
+ * hinted discardable (reads may return zeros later), malloc-backed blocks
+ * keep their bytes as-is — call arena_zero_mem() first when 'ar' held data
+ * that should not be leaked. No-op on NULL or cleaned arenas. */
+void arena_reset(Arena *ar);
+
 /* Best-effort to set all the bytes of 'ar' to zero. Use this before
  * clean/destroy if 'ar' holds data that should not be leaked. */
 void arena_zero_mem(Arena *ar);
@@ -93,12 +122,27 @@ void *arena_add_nul(Arena *ar, void *start_v, uint32_t len);
 /* Returns the number of bytes used by the data inside 'ar'. */
 uint32_t arena_get_used(Arena *ar);
 
+/* Returns the high-water mark of used bytes since init (survives
+ * arena_reset), useful for sizing initial blocks from observed workloads. */
+uint32_t arena_get_peak_used(const Arena *ar);
+
+/* Returns the number of blocks currently chained in 'ar'. */
+uint32_t arena_get_block_count(const Arena *ar);
+
 /* Appends a pointer to a temporary vector.
  * Ownership: vector owns the heap buffer for items.
  * Side effects: may realloc on heap.
  * Returns OK/ERR. */
 AdbxStatus ptrvec_push(PtrVec *v, void *ptr);
 
+/* Same as ptrvec_push() but grows inside 'a', the arena the vector will be
+ * flattened into, so collection makes no transient heap allocation at all.
+ * Outgrown chunks stay dead in the arena until it is released; use this for
+ * vectors flattened into short-lived parse arenas, not long-lived ones.
+ * Do not mix with ptrvec_push() on the same vector.
+ * Returns OK/ERR. */
+AdbxStatus ptrvec_push_arena(PtrVec *v, Arena *a, void *ptr);
+
 /* Copies a temporary vector into the arena and returns the new array.
  * Ownership: returned array is owned by the arena.
  * Side effects: allocates arena memory.
@@ -0,0 +1,168 @@
+#include "async_log.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// Ring capacity in entries; must stay a power of two for the index mask.
+#define ALOG_RING_CAP 1024u
+
+/* One ring slot (bounded-queue scheme by D. Vyukov): 'seq' tickets the slot
+ * between producers and the consumer, so publication needs no lock. The raw
+ * timestamp is captured on the producer and formatted on the drain thread. */
+typedef struct AlogEntry {
+  _Atomic uint64_t seq;
+  struct timespec ts; // CLOCK_REALTIME at enqueue
+  uint16_t len;
+  char msg[ALOG_MSG_MAX];
+} AlogEntry;
+
+static struct {
+  AlogEntry ring[ALOG_RING_CAP];
+  _Atomic uint64_t head;    // next ticket producers claim
+  uint64_t tail;            // consumer-only cursor
+  _Atomic uint64_t dropped; // messages lost to ring overflow
+  _Atomic int running;      // drain thread keeps consuming while set
+  FILE *sink;
+  pthread_t drain;
+  int started; // guarded by start/stop being management-path only
+} alog;
+
+/* Claims one slot and publishes the formatted message; counts a drop when
+ * the ring is full instead of blocking the caller. */
+static void alog_enqueue(const char *fmt, va_list ap) {
+  uint64_t pos = atomic_load_explicit(&alog.head, memory_order_relaxed);
+  AlogEntry *e;
+  for (;;) {
+    e = &alog.ring[pos & (ALOG_RING_CAP - 1u)];
+    uint64_t seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+    int64_t dif = (int64_t)seq - (int64_t)pos;
+    if (dif == 0) {
+      if (atomic_compare_exchange_weak_explicit(&alog.head, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+      // CAS updated 'pos' to the current head; retry from there.
+    } else if (dif < 0) {
+      // The consumer has not freed this slot yet: the ring is full.
+      atomic_fetch_add_explicit(&alog.dropped, 1, memory_order_relaxed);
+      return;
+    } else {
+      pos = atomic_load_explicit(&alog.head, memory_order_relaxed);
+    }
+  }
+
+  clock_gettime(CLOCK_REALTIME, &e->ts);
+  int n = vsnprintf(e->msg, sizeof(e->msg), fmt, ap);
+  if (n < 0)
+    n = 0;
+  if ((size_t)n >= sizeof(e->msg))
+    n = sizeof(e->msg) - 1;
+  e->len = (uint16_t)n;
+  atomic_store_explicit(&e->seq, pos + 1, memory_order_release);
+}
+
+/* Writes every published entry to the sink; returns the number drained. */
+static uint64_t alog_drain_ready(void) {
+  uint64_t drained = 0;
+  for (;;) {
+    AlogEntry *e = &alog.ring[alog.tail & (ALOG_RING_CAP - 1u)];
+    uint64_t seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+    if (seq != alog.tail + 1)
+      break; // next slot not published yet
+
+    struct tm tm_utc;
+    char tstamp[32] = "";
+    time_t secs = e->ts.tv_sec;
+    if (gmtime_r(&secs, &tm_utc))
+      (void)strftime(tstamp, sizeof(tstamp), "%Y-%m-%dT%H:%M:%S", &tm_utc);
+    fprintf(alog.sink, "%s.%03ldZ %.*s\n", tstamp, e->ts.tv_nsec / 1000000L,
+            (int)e->len, e->msg);
+
+    // Free the slot for the producer one lap ahead.
+    atomic_store_explicit(&e->seq, alog.tail + ALOG_RING_CAP,
+                          memory_order_release);
+    alog.tail++;
+    drained++;
+  }
+  return drained;
+}
+
+/* Emits one line accounting for messages lost since the last report. */
+static void alog_report_drops(uint64_t *last_reported) {
+  uint64_t total = atomic_load_explicit(&alog.dropped, memory_order_relaxed);
+  if (total > *last_reported) {
+    fprintf(alog.sink, "async_log: dropped %llu messages on ring overflow\n",
+            (unsigned long long)(total - *last_reported));
+    *last_reported = total;
+  }
+}
+
+static void *alog_drain_main(void *arg) {
+  (void)arg;
+  uint64_t reported = 0;
+  const struct timespec idle = {.tv_sec = 0, .tv_nsec = 5 * 1000 * 1000};
+
+  while (atomic_load_explicit(&alog.running, memory_order_acquire)) {
+    uint64_t drained = alog_drain_ready();
+    alog_report_drops(&reported);
+    if (drained > 0)
+      fflush(alog.sink);
+    else
+      nanosleep(&idle, NULL);
+  }
+
+  // Shutdown: flush whatever was published before running went to 0.
+  alog_drain_ready();
+  alog_report_drops(&reported);
+  fflush(alog.sink);
+  return NULL;
+}
+
+AdbxStatus alog_start(FILE *sink) {
+  if (alog.started)
+    return OK;
+
+  memset(&alog, 0, sizeof(alog));
+  for (uint64_t i = 0; i < ALOG_RING_CAP; i++)
+    atomic_store_explicit(&alog.ring[i].seq, i, memory_order_relaxed);
+  alog.sink = sink ? sink : stderr;
+
+  atomic_store_explicit(&alog.running, 1, memory_order_release);
+  if (pthread_create(&alog.drain, NULL, alog_drain_main, NULL) != 0) {
+    atomic_store_explicit(&alog.running, 0, memory_order_release);
+    return ERR;
+  }
+  alog.started = 1;
+  return OK;
+}
+
+void alog_stop(void) {
+  if (!alog.started)
+    return;
+  // Producers racing this store fall back to synchronous stderr; entries
+  // already published are flushed by the drain thread on its way out.
+  atomic_store_explicit(&alog.running, 0, memory_order_release);
+  pthread_join(alog.drain, NULL);
+  alog.started = 0;
+}
+
+void alog_write(const char *fmt, ...) {
+  if (!fmt)
+    return;
+  va_list ap;
+  va_start(ap, fmt);
+  if (atomic_load_explicit(&alog.running, memory_order_acquire)) {
+    alog_enqueue(fmt, ap);
+  } else {
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+  }
+  va_end(ap);
+}
+
+uint64_t alog_dropped(void) {
+  return atomic_load_explicit(&alog.dropped, memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stdio.h>
+
+#include "utils.h"
+
+// Longest formatted message retained per entry; longer messages truncate.
+#define ALOG_MSG_MAX 240u
+
+/* Process-wide asynchronous logger: hot paths format one line into a
+ * fixed-size lock-free ring and return without touching the sink, so a slow
+ * stderr consumer (journald backpressure, a piped collector) never stalls
+ * the event loop. A drain thread timestamps and writes entries in order;
+ * when the ring is full new messages are dropped and counted instead of
+ * blocking, and the drop total is reported on the next drain pass.
+ *
+ * Before alog_start() (and after alog_stop()) alog_write() degrades to one
+ * synchronous stderr line, so call sites behave in tests and one-shot tools
+ * without any setup. */
+
+/* Starts the drain thread writing to 'sink' (NULL = stderr).
+ * Side effects: spawns one thread; idempotent while already started.
+ * Error semantics: returns OK on success (or already started), ERR when the
+ * thread cannot be spawned (call sites then keep the synchronous fallback).
+ */
+AdbxStatus alog_start(FILE *sink);
+
+/* Stops the drain thread after flushing every queued entry (and a final
+ * drop report when messages were lost).
+ * Side effects: joins the drain thread; later alog_write() calls fall back
+ * to synchronous stderr and alog_start() may be called again.
+ * Error semantics: none; a no-op when not started.
+ */
+void alog_stop(void);
+
+/* Formats one log line and queues it for the drain thread (or writes it
+ * synchronously to stderr when the logger is not running).
+ * Side effects: one clock read plus the ring write; never blocks on the
+ * sink. When the ring is full the message is dropped and counted.
+ * Error semantics: none (fail-soft; oversized messages are truncated).
+ */
+void alog_write(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/* Returns the number of messages dropped on ring overflow since start. */
+uint64_t alog_dropped(void);
+
+#endif
@@ -2,22 +2,41 @@
 
 #include "broker.h"
 #include "arena.h"
+#include "async_log.h"
+#include "exec_pool.h"
 #include "frame_codec.h"
 #include "handshake_codec.h"
+#include "hash_table.h"
 #include "json_codec.h"
+#include "latency_hist.h"
 #include "log.h"
 #include "packed_array.h"
+#include "perf_counters.h"
+#include "plan_cache.h"
+#include "qr_wire.h"
 #include "query_result.h"
+#include "result_cache.h"
+#include "result_spill.h"
+#include "schema_cache.h"
 #include "sensitive_tok.h"
+#include "spool.h"
 #include "stdio_byte_channel.h"
+#include "token_snapshot.h"
+#include "uring_byte_channel.h"
 #include "string_op.h"
 #include "utils.h"
 #include "validator.h"
 
+#include <arpa/inet.h>
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,21 +67,251 @@
 #define ABSOLUTE_TTL (8 * 60 * 60) // 8 hours
 #define IDLE_TTL (20 * 60)         // 20 minutes
 
+// Wake-up period of the event loop while at least one session holds a partial
+// request frame, so stalled frames are dropped near their deadline.
+#define PARTIAL_FRAME_TICK_MS 200
+
+// Compile-time bound on connections whose handshake frame is still arriving;
+// the runtime cap defaults lower and is tunable with
+// ADBX_MAX_PENDING_HANDSHAKES (clamped to this bound). Accepts past the cap
+// get an immediate HS_ERR_FULL frame and a close, so a connection storm can
+// never queue unbounded handshake state.
+#define BROKER_PENDING_HS_MAX 64u
+#define BROKER_PENDING_HS_DEFAULT 32u
+// Raw handshake request frame: u32 length prefix + fixed-size payload.
+#define BROKER_HS_FRAME_LEN (4u + HANDSHAKE_REQ_WIRE_SIZE)
+
+// Default number of query-execution worker threads; override with the
+// ADBX_EXEC_WORKERS environment variable (clamped by the pool).
+#define EXEC_POOL_DEFAULT_WORKERS 4
+
+// Token-store compaction defaults; override with ADBX_TOKEN_IDLE_TTL_SEC and
+// ADBX_TOKEN_MEM_BUDGET_KB (0 disables the corresponding trigger).
+#define TOKEN_COMPACT_IDLE_TTL_SECS 600u
+#define TOKEN_COMPACT_MEM_BUDGET_KB 1024u
+
+// Rows served per fetch_cursor_page when the request names no 'maxRows' and
+// the connection policy leaves its row cap unset.
+#define CURSOR_FETCH_DEFAULT_ROWS 200u
+
+/* One session waiting on another session's identical in-flight query. */
+typedef struct BrokerFlightWaiter {
+  uint64_t serial; // follower session activation serial
+  McpId id;        // owned copy of the follower's request id
+  uint8_t columnar;
+  struct BrokerFlightWaiter *next;
+} BrokerFlightWaiter;
+
+/* Single-flight entry: one executing query that identical concurrent
+ * requests attach to instead of re-executing. Keyed like the plan cache on
+ * an exact byte blob (connection name + executed SQL), resolved when the
+ * leader's completion is popped: every waiter receives a qr_clone() of the
+ * leader's result. Entries only exist while the leader job is in flight.
+ */
+typedef struct BrokerFlight {
+  uint64_t hash;  // ht_hash_bytes(key, key_len)
+  char *key;      // owned blob: conn_name \0 sql \0
+  size_t key_len;
+  uint64_t leader_serial; // session whose job actually executes
+  BrokerFlightWaiter *waiters;
+  struct BrokerFlight *next;
+} BrokerFlight;
+
+static void broker_flight_free(BrokerFlight *f);
+struct BrokerFanout;
+static void broker_fanout_free(struct BrokerFanout *f);
+static void broker_session_serve_buffered(Broker *b, uint32_t idx);
+
+// Upper bound of connections one fan-out request may target.
+#define FANOUT_MAX_CONNS 8u
+
+/* One per-connection slot of a fan-out request. 'res' is owned and filled
+ * either straight away (checkout/validation failure) or when the worker
+ * completion for this connection lands. */
+typedef struct BrokerFanoutEntry {
+  char conn[CONN_NAME_MAX_LEN + 1];
+  QueryResult *res;
+} BrokerFanoutEntry;
+
+/* Aggregation ticket for one run_sql_query_fanout request: the same query
+ * submitted to several connections at once. Sub-jobs share the session
+ * serial; each completion stashes its result here and the last one merges
+ * every entry into the single reply the session gets. */
+typedef struct BrokerFanout {
+  uint64_t serial; // owning session serial (one fan-out per busy session)
+  McpId id;        // owned copy of the request id for the merged reply
+  uint8_t columnar;
+  uint32_t n_entries;
+  uint32_t n_pending; // sub-jobs still executing on workers
+  BrokerFanoutEntry entries[FANOUT_MAX_CONNS];
+  struct BrokerFanout *next;
+} BrokerFanout;
+
+/* One idle-session expiry deadline queued in the broker's min-heap. Entries
+ * are identified by resume token and lazily invalidated: a token that no
+ * longer matches an idle session is simply discarded when popped. */
+typedef struct IdleExpiryEntry {
+  time_t deadline; // first instant broker_session_is_expired() returns YES
+  uint8_t token[RESUME_TOKEN_LEN];
+} IdleExpiryEntry;
+
+/* A session can re-idle while its previous (stale) entry still sits in the
+ * heap, so give the heap headroom over the idle-array cap. */
+#define IDLE_EXPIRY_HEAP_CAP (MAX_IDLE_SESSIONS * 2u)
+
+/* Per-stage latency histograms behind the 'stats' tool. Every stage is
+ * recorded on the broker thread (execution time arrives via the completion
+ * queue as QueryResult.exec_ms), so no locking is needed. */
+typedef struct BrokerStageStats {
+  LatencyHist handle;    // whole broker_handle_request() dispatch
+  LatencyHist connect;   // pooled-connection checkout in run_sql_query
+  LatencyHist validate;  // validate_query() on plan-cache misses
+  LatencyHist execute;   // worker-side execution (from exec_ms)
+  LatencyHist serialize; // JSON-RPC encode + response frame write
+} BrokerStageStats;
+
+/* One accepted connection whose handshake frame is still arriving. The fd is
+ * nonblocking and polled like a session; bytes accumulate here until the
+ * frame completes, so a slow or stalled client never blocks the event loop
+ * the way the old inline SO_RCVTIMEO handshake read could. */
+typedef struct BrokerPendingHs {
+  int fd;               // owned until the handshake completes or drops
+  uint32_t got;         // bytes consumed so far (header + payload)
+  uint32_t need;        // declared payload length once the header arrived
+  uint8_t bad_len;      // 1 => wrong declared length; drain, then reject
+  uint64_t deadline_ms; // drop the connection once now passes this
+  uint8_t buf[BROKER_HS_FRAME_LEN];
+} BrokerPendingHs;
+
+/* One readiness report produced by broker_wait_events(). 'is_err' flags
+ * hangup/error conditions without readable data left. */
+typedef struct BrokerIoEvent {
+  int fd;
+  int is_err;
+} BrokerIoEvent;
+
+// Every pollable fd the loop can own at once: sessions, mid-handshake
+// connections, the listen socket, and the exec-pool completion fd.
+#define BROKER_WAIT_SLOTS (MAX_CLIENTS + BROKER_PENDING_HS_MAX + 2u)
+
 struct Broker {
   int listen_fd;            // file descriptor of the socket used to
                             // accept incoming connection requets
+#ifdef __linux__
+  int ep_fd; // owned epoll instance used by the event loop
+#endif
+  ExecPool *exec_pool;         // owned worker pool for query execution
+  PlanCache *plan_cache;       // owned cache of validated query plans
+  ResultCache *result_cache;   // owned cache of serialized responses (only
+                               // profiles with resultCacheTtlSeconds use it)
+  SchemaCache *schema_cache;   // owned per-connection schema snapshots
+                               // backing the describe tool
+
+  // All-plaintext column plan borrowed (via plan_override) by describe
+  // catalog-fetch jobs: broker-minted catalog SQL never tokenizes output,
+  // so every such job shares this one frozen plan.
+  ValidatorPlan describe_plan;
+  uint64_t next_session_serial; // monotonically increasing activation counter
+
+  // Validated jobs parked because every pooled connection for their target
+  // profile was checked out (FIFO via job->next; dispatched on checkin).
+  ExecPoolJob *parked_head;
+  ExecPoolJob *parked_tail;
+
+  // In-flight single-flight entries (small unordered list; one per unique
+  // executing query that at least one session leads).
+  BrokerFlight *flights;
+
+  // Pending fan-out tickets (small unordered list; at most one per busy
+  // session, unlinked when the merged reply is delivered).
+  BrokerFanout *fanouts;
   ConnManager *cm;          // owned
   PrivDirBrokerRuntime *rt; // owned private-dir runtime for socket/token paths
+  char *reload_config_path; // owned; non-NULL enables SIGHUP catalog reload
+
+  // Owned pool of catalog column identifiers ("table.col" and
+  // "schema.table.col", matching the validator's canonical format). Seeded
+  // once at creation and frozen, so per-session token stores layer their
+  // col-ref pools over it and worker threads read it without locking.
+  StringPool *shared_col_refs;
 
   uint8_t secret_token[SECRET_TOKEN_LEN];
 
   PackedArray *active_sessions; // polled for I/O, max MAX_CLIENTS
   PackedArray *idle_sessions;   // not polled, max MAX_IDLE_SESSIONS
 
+  // Min-heap of idle-session expiry deadlines, so each loop iteration reaps
+  // only sessions whose deadline actually passed (a heap-head peek) instead
+  // of walking the idle array with per-entry clock math.
+  IdleExpiryEntry idle_expiry[IDLE_EXPIRY_HEAP_CAP];
+  uint32_t idle_expiry_len;
+
   uint32_t idle_ttl_secs;
   uint32_t abs_ttl_secs;
+
+  uint32_t tok_idle_ttl_secs;    // 0 = never compact token stores by idleness
+  uint32_t tok_mem_budget_bytes; // 0 = no per-session token memory budget
+
+  // Persisted token-store snapshots (opt-in via ADBX_PERSIST_TOKENS):
+  // written on clean shutdown, loaded once at startup, consumed lazily as
+  // snapshot-resumed sessions touch their connections.
+  TokSnap *tok_snap; // owned; NULL when disabled or no snapshot existed
+  uint8_t persist_tokens;
+
+  // Opt-in (ADBX_URING): accepted sessions get an io_uring channel that
+  // batches their response-frame writes into one syscall per flush; falls
+  // back per session when the kernel refuses a ring.
+  uint8_t use_uring;
+
+  // Owned reusable jsmn token workspace. All request JSON is parsed on the
+  // broker thread, so one workspace serves every session with zero
+  // steady-state tokenizer allocations.
+  JsonTokWs req_tok_ws;
+
+  // Connections freed by cursor closes outside the completion loop. Their
+  // parked waiters are dispatched at the end of the event-loop iteration,
+  // once no caller borrows session pointers (dispatching can drop or move
+  // sessions). One slot per client suffices: each session holds at most one
+  // cursor.
+  char deferred_conns[MAX_CLIENTS][CONN_NAME_MAX_LEN + 1];
+  uint32_t n_deferred_conns;
+
+  // Connections mid-handshake (unordered; swap-removed). pending_hs_cap is
+  // the admission limit resolved at creation.
+  BrokerPendingHs pending_hs[BROKER_PENDING_HS_MAX];
+  uint32_t pending_hs_len;
+  uint32_t pending_hs_cap;
+
+  // Scratch buffers for broker_wait_events(). Broker-resident rather than
+  // event-loop locals: at BROKER_WAIT_SLOTS entries they would dominate the
+  // loop's stack frame, and only the owner thread waits.
+  BrokerIoEvent io_evs[BROKER_WAIT_SLOTS];
+#ifdef __linux__
+  struct epoll_event wait_kevs[BROKER_WAIT_SLOTS];
+#else
+  struct pollfd wait_pfds[BROKER_WAIT_SLOTS];
+#endif
+
+  // Per-stage latency histograms served by the 'stats' tool.
+  BrokerStageStats stats;
 };
 
+/* Server-side cursor state owned by one active session. The cursor pins one
+ * pooled connection (fetches reuse it without a checkout) until the cursor
+ * is closed: explicitly, on drain/error, or when the session leaves the
+ * active array. Cursors do not survive idling — resuming a session never
+ * resurrects one.
+ */
+typedef struct SessionCursor {
+  char handle_hex[EXEC_CURSOR_HANDLE_HEX_LEN + 1]; // opaque client handle
+  char name[EXEC_CURSOR_NAME_BUFSZ]; // backend-side cursor name
+  DbBackend *db;         // exclusively pinned pooled connection
+  char *conn_name;       // owned; for checkin and error messages
+  ValidateQueryOut vout; // owned; the retained plan drives fetch tokenization
+  DbTokenStore *store;   // borrowed session store for token minting
+  uint32_t max_page_rows; // policy row cap captured at open; 0 = uncapped
+} SessionCursor;
+
 /* This entity stores the usefull data to communicate with each Client. */
 typedef struct BrokerMcpSession {
   BufChannel bc;
@@ -70,9 +319,54 @@ typedef struct BrokerMcpSession {
   uint8_t resume_token[RESUME_TOKEN_LEN]; // can be used to resume the session
   uint32_t generation;                    // session-wide token generation
   Arena arena;            // stores per-session token value bytes
-  PackedArray *db_stores; // owned array of DbTokenStore*
+  PackedArray *db_stores; // owned DbTokenStore* slots addressed by
+                          // ConnProfile.catalog_idx; NULL until the session
+                          // first touches that connection
   time_t created_at;      // for absolute TTL
   time_t last_active;     // for idle TTL
+  time_t tokens_last_used; // last query that touched a token store;
+                           // 0 when no token data exists yet
+  time_t frame_started_at; // first time a partial request frame was seen;
+                           // 0 when no frame is pending
+  uint64_t serial; // unique per activation; routes worker completions back
+  uint8_t busy;    // 1 while one request executes on a worker thread
+  uint8_t defunct; // 1 when the peer vanished while a job was in flight
+  uint8_t read_muted; // 1 = read events off (a pipelined frame is parked
+                      // behind the in-flight job until its completion)
+  McpId inflight_id;  // owned copy of the request id a worker is executing
+  DbBackend *inflight_db; // borrowed; connection running inflight_id (NULL
+                          // while the job is parked or nothing runs)
+  ResultSpill *spill; // owned overflow rows of the last successful query;
+                      // served by fetch_result_page, replaced per query
+  SessionCursor *cursor; // owned open server-side cursor, NULL when none
+  uint8_t replied_inline; // 1 when a tool handler already wrote the response
+                          // frame itself (result-cache replay); consumed by
+                          // broker_handle_request()
+  uint8_t wire_binary; // 1 when the peer advertised binary-result transcoding
+                       // at handshake; per connection, re-negotiated on every
+                       // (re)connect rather than carried through idle
+
+  // Borrowed persisted-session record (broker-owned TokSnap) driving lazy
+  // per-connection token restore after a broker restart; NULL otherwise.
+  const TokSnapSession *restore_src;
+
+  // Slow-request log bookkeeping for the request in flight (see
+  // broker_slow_log()). req_slow_log_ms is the profile threshold snapshot;
+  // 0 means the request never logs (profile opt-out or profile-less tool).
+  uint64_t req_start_us;
+  uint32_t req_connect_us;
+  uint32_t req_validate_us;
+  uint32_t req_slow_log_ms;
+  char req_conn[CONN_NAME_MAX_LEN + 1];
+
+  // Reset-and-reuse request scratch (see broker_scratch_vout()): validator
+  // output and key buffer survive across requests so the steady-state path
+  // re-arms them with pointer resets instead of alloc/free cycles.
+  // scratch_vout_live drops to 0 when a job takes ownership of the plan
+  // storage; the next borrow re-initializes it.
+  ValidateQueryOut scratch_vout;
+  uint8_t scratch_vout_live;
+  StrBuf scratch_key;
 } BrokerMcpSession;
 
 /* Resolves a positive TTL override from environment in test builds.
@@ -104,6 +398,45 @@ static uint32_t broker_ttl_from_env_or_default(const char *name,
 #endif
 }
 
+/* Resolves one unsigned tuning knob from the environment.
+ * Unlike broker_ttl_from_env_or_default(), this is not test-gated and 0 is a
+ * valid value (callers use it to disable the corresponding feature).
+ * Side effects: reads environment variables.
+ * Returns the parsed value, or 'fallback' on missing/invalid input.
+ */
+static uint32_t broker_u32_from_env(const char *name, uint32_t fallback) {
+  const char *raw = getenv(name);
+  if (!raw || raw[0] == '\0')
+    return fallback;
+
+  char *end = NULL;
+  errno = 0;
+  unsigned long long parsed = strtoull(raw, &end, 10);
+  if (errno != 0 || end == raw || *end != '\0' || parsed > UINT32_MAX)
+    return fallback;
+  return (uint32_t)parsed;
+}
+
+/* Resolves the worker-pool size from the environment.
+ * Side effects: reads the ADBX_EXEC_WORKERS environment variable.
+ * Returns the parsed value in [1..EXEC_POOL_MAX_WORKERS], or the default on
+ * missing/invalid input.
+ */
+static uint32_t broker_exec_workers_from_env(void) {
+  const char *raw = getenv("ADBX_EXEC_WORKERS");
+  if (!raw || raw[0] == '\0')
+    return EXEC_POOL_DEFAULT_WORKERS;
+
+  char *end = NULL;
+  errno = 0;
+  unsigned long long parsed = strtoull(raw, &end, 10);
+  if (errno != 0 || end == raw || *end != '\0')
+    return EXEC_POOL_DEFAULT_WORKERS;
+  if (parsed == 0 || parsed > EXEC_POOL_MAX_WORKERS)
+    return EXEC_POOL_DEFAULT_WORKERS;
+  return (uint32_t)parsed;
+}
+
 /* Closes '*fd' when it is valid and sets it to -1.
  * It borrows 'fd' and does not allocate memory.
  * Side effects: closes a kernel file descriptor.
@@ -176,35 +509,6 @@ static AdbxStatus broker_write_handshake_resp(BrokerMcpSession *sess,
   return frame_write_len(&sess->bc, wire, (uint32_t)sizeof(wire));
 }
 
-/* Reads one framed handshake request and decodes it into 'out_req'.
- * It borrows 'sess' and 'out_req'; temporary frame storage is freed before
- * return.
- * Side effects: reads one frame from sess->bc and consumes it.
- * Returns OK on exact-size, well-formed handshake payload; ERR on framing
- * failure, timeout, malformed size, or invalid input.
- */
-static AdbxStatus broker_read_handshake_req(BrokerMcpSession *sess,
-                                            handshake_req_t *out_req) {
-  if (!sess || !out_req)
-    return ERR;
-
-  StrBuf payload;
-  sb_init(&payload);
-  AdbxStatus rc = frame_read_len(&sess->bc, &payload);
-  if (rc != OK) {
-    sb_clean(&payload);
-    return ERR;
-  }
-
-  if (handshake_req_decode(out_req, (const uint8_t *)payload.data,
-                           payload.len) != OK) {
-    sb_clean(&payload);
-    return ERR;
-  }
-  sb_clean(&payload);
-  return OK;
-}
-
 /* Sets the receive timeout on a socket file descriptor.
  * It borrows 'fd'; ownership is unchanged.
  * Side effects: updates SO_RCVTIMEO kernel state for the socket.
@@ -282,12 +586,17 @@ static ssize_t broker_find_idle_by_token(const PackedArray *idle,
 
   size_t n = parr_len(idle);
   for (size_t i = 0; i < n; i++) {
-    const BrokerMcpSession *sess =
-        (const BrokerMcpSession *)parr_cat(idle, (uint32_t)i);
-    if (!sess)
-      continue;
-    AdbxTriStatus eq =
-        bytes_equal_ct(token, sess->resume_token, RESUME_TOKEN_LEN);
+    /* Prefer the dense key column: candidate tokens sit back-to-back instead
+     * of one per session struct. */
+    const uint8_t *candidate = (const uint8_t *)parr_key_cat(idle, (uint32_t)i);
+    if (!candidate) {
+      const BrokerMcpSession *sess =
+          (const BrokerMcpSession *)parr_cat(idle, (uint32_t)i);
+      if (!sess)
+        continue;
+      candidate = sess->resume_token;
+    }
+    AdbxTriStatus eq = bytes_equal_ct(token, candidate, RESUME_TOKEN_LEN);
     if (eq == YES) {
       return (ssize_t)i;
     }
@@ -296,17 +605,157 @@ static ssize_t broker_find_idle_by_token(const PackedArray *idle,
   return -1;
 }
 
+/* Returns the first instant at which 'sess' fails
+ * broker_session_is_expired(): one second past the nearer of the idle and
+ * absolute TTL deadlines (the check compares with a strict '>'). */
+static time_t broker_idle_deadline(const BrokerMcpSession *sess,
+                                   uint32_t idle_ttl_secs,
+                                   uint32_t abs_ttl_secs) {
+  time_t abs_dl = sess->created_at + (time_t)abs_ttl_secs;
+  time_t idle_dl = sess->last_active + (time_t)idle_ttl_secs;
+  return (abs_dl < idle_dl ? abs_dl : idle_dl) + 1;
+}
+
+/* Queues one expiry deadline on the min-heap. Fail-soft when the heap is
+ * full: the session is still reaped by cap-pressure eviction or refused at
+ * resume time, it just loses proactive expiry. */
+static void broker_idle_heap_push(Broker *b, time_t deadline,
+                                  const uint8_t *token) {
+  if (!b || !token || b->idle_expiry_len >= IDLE_EXPIRY_HEAP_CAP)
+    return;
+  uint32_t i = b->idle_expiry_len++;
+  while (i > 0) {
+    uint32_t parent = (i - 1) / 2;
+    if (b->idle_expiry[parent].deadline <= deadline)
+      break;
+    b->idle_expiry[i] = b->idle_expiry[parent];
+    i = parent;
+  }
+  b->idle_expiry[i].deadline = deadline;
+  memcpy(b->idle_expiry[i].token, token, RESUME_TOKEN_LEN);
+}
+
+/* Pops the earliest deadline into '*out'. Returns YES, or NO on an empty
+ * heap. */
+static AdbxTriStatus broker_idle_heap_pop(Broker *b, IdleExpiryEntry *out) {
+  if (!b || !out || b->idle_expiry_len == 0)
+    return NO;
+  *out = b->idle_expiry[0];
+  IdleExpiryEntry last = b->idle_expiry[--b->idle_expiry_len];
+  uint32_t i = 0;
+  for (;;) {
+    uint32_t kid = i * 2 + 1;
+    if (kid >= b->idle_expiry_len)
+      break;
+    if (kid + 1 < b->idle_expiry_len &&
+        b->idle_expiry[kid + 1].deadline < b->idle_expiry[kid].deadline)
+      kid++;
+    if (last.deadline <= b->idle_expiry[kid].deadline)
+      break;
+    b->idle_expiry[i] = b->idle_expiry[kid];
+    i = kid;
+  }
+  if (b->idle_expiry_len > 0)
+    b->idle_expiry[i] = last;
+  return YES;
+}
+
+/* Reaps every idle session whose deadline passed. When nothing expired this
+ * is a single heap-head peek, regardless of how many sessions sit idle. */
+static void broker_expire_idle_sessions(Broker *b) {
+  if (!b)
+    return;
+  time_t now = time(NULL);
+  while (b->idle_expiry_len > 0 && b->idle_expiry[0].deadline <= now) {
+    IdleExpiryEntry e;
+    if (broker_idle_heap_pop(b, &e) != YES)
+      break;
+    ssize_t idx = broker_find_idle_by_token(b->idle_sessions, e.token);
+    if (idx < 0)
+      continue; // stale: the session resumed or was evicted meanwhile
+    BrokerMcpSession *sess =
+        (BrokerMcpSession *)parr_at(b->idle_sessions, (uint32_t)idx);
+    if (broker_session_is_expired(sess, now, b->idle_ttl_secs,
+                                  b->abs_ttl_secs) == NO) {
+      // The recorded deadline ran ahead of the session's actual TTL state;
+      // queue the authoritative one (strictly in the future, so no spin).
+      broker_idle_heap_push(
+          b, broker_idle_deadline(sess, b->idle_ttl_secs, b->abs_ttl_secs),
+          e.token);
+      continue;
+    }
+    TLOG("INFO - reaping expired idle session");
+    parr_drop_swap(b->idle_sessions, (uint32_t)idx);
+  }
+}
+
 /* --------------------------------- Sessions ------------------------------ */
 
+/* Queues 'conn_name' so its parked waiters are dispatched at the end of the
+ * current event-loop iteration. Dispatching inline is unsafe from request
+ * handling or array-cleanup contexts: it can drop or swap sessions under a
+ * caller that still borrows a session pointer.
+ */
+static void broker_defer_waiter_dispatch(Broker *b, const char *conn_name) {
+  if (!b || !conn_name || conn_name[0] == '\0')
+    return;
+  for (uint32_t i = 0; i < b->n_deferred_conns; i++) {
+    if (strcmp(b->deferred_conns[i], conn_name) == 0)
+      return; // already queued this iteration
+  }
+  if (b->n_deferred_conns >= ARRLEN(b->deferred_conns))
+    return; // cannot happen (one cursor per client); fail-soft regardless
+  snprintf(b->deferred_conns[b->n_deferred_conns],
+           sizeof(b->deferred_conns[0]), "%s", conn_name);
+  b->n_deferred_conns++;
+}
+
+/* Rolls the backend cursor back and returns its pinned connection to the
+ * pool; parked waiters are dispatched at the next safe point.
+ */
+static void broker_cursor_conn_release(Broker *b, const char *conn_name,
+                                       DbBackend *db, const char *cursor_name) {
+  if (db) {
+    db_cursor_close(db, cursor_name);
+    if (conn_name && b && b->cm)
+      connm_checkin(b->cm, conn_name, db);
+  }
+  broker_defer_waiter_dispatch(b, conn_name);
+}
+
+/* Closes and frees the session's open cursor, if any. Must not run while the
+ * cursor's connection is borrowed by an in-flight worker job (busy sessions
+ * stay pinned, so the completion loop is the only caller under load).
+ */
+static void broker_session_cursor_close(Broker *b, BrokerMcpSession *sess) {
+  if (!sess || !sess->cursor)
+    return;
+  SessionCursor *cur = sess->cursor;
+  sess->cursor = NULL;
+  broker_cursor_conn_release(b, cur->conn_name, cur->db, cur->name);
+  vq_out_clean(&cur->vout);
+  free(cur->conn_name);
+  free(cur);
+}
+
 /* Releases BrokerMcpSession-owned dynamic members (excluding fd/channel).
  */
 static void session_owned_clean(BrokerMcpSession *s) {
   if (!s)
     return;
+  mcp_id_clean(&s->inflight_id);
+  s->inflight_db = NULL;
+  rspill_destroy(s->spill);
+  s->spill = NULL;
   parr_destroy(s->db_stores);
   s->db_stores = NULL;
   arena_clean(&s->arena);
   s->arena = (Arena){0};
+  if (s->scratch_vout_live) {
+    vq_out_clean(&s->scratch_vout);
+    s->scratch_vout_live = 0;
+  }
+  sb_clean(&s->scratch_key);
 }
 
 /* Cleanup callback for active session slots.
@@ -315,10 +764,12 @@ static void session_owned_clean(BrokerMcpSession *s) {
  * Error semantics: none (void cleanup callback).
  */
 static void active_sessions_cleanup(void *obj, void *ctx) {
-  (void)ctx;
   BrokerMcpSession *s = (BrokerMcpSession *)obj;
   if (!s)
     return;
+  // ctx is the owning Broker; the cursor (if any) must give its pinned
+  // connection back to the pool before the session-owned state goes away.
+  broker_session_cursor_close((Broker *)ctx, s);
   bufch_clean(&s->bc);
   s->fd = -1;
   session_owned_clean(s);
@@ -335,6 +786,30 @@ static void idle_sessions_cleanup(void *obj, void *ctx) {
   session_owned_clean(s);
 }
 
+/* Borrows the session's reusable validator output, re-arming it for the next
+ * request. In steady state the returned ValidateQueryOut keeps its converged
+ * column capacity and arena block across requests, so a borrow is a handful
+ * of pointer resets; it only pays vq_out_init() on first use and again after
+ * a submitted job took ownership of the plan storage (scratch_vout_live == 0).
+ * The caller must NOT vq_out_clean() the result: storage stays with the
+ * session, except when a job move succeeds, in which case the caller clears
+ * scratch_vout_live.
+ * Error semantics: returns NULL on allocation/reset failure.
+ */
+static ValidateQueryOut *broker_scratch_vout(BrokerMcpSession *sess) {
+  if (!sess)
+    return NULL;
+  if (!sess->scratch_vout_live) {
+    if (vq_out_init(&sess->scratch_vout) != OK)
+      return NULL;
+    sess->scratch_vout_live = 1;
+    return &sess->scratch_vout;
+  }
+  if (vq_out_reset(&sess->scratch_vout) != OK)
+    return NULL;
+  return &sess->scratch_vout;
+}
+
 /* Moves ownership of a pending live session into the active session array.
  * It transfers pending->bc and pending->fd to "active"-owned storage on
  * success; pending keeps ownership on failure.
@@ -372,13 +847,15 @@ static uint32_t sessions_add_from_pending(PackedArray *active,
 }
 
 /* Moves one active session to idle-session storage.
- * It borrows 'active'/'idle'; session ownership stays in PackedArray
- * containers and no heap allocation escapes.
- * Side effects: tears down live I/O channel, mutates both arrays, may reap one
- * existing idle session, and refreshes last_active timestamp.
+ * It borrows 'b'; session ownership stays in PackedArray containers and no
+ * heap allocation escapes.
+ * Side effects: tears down live I/O channel, mutates both session arrays,
+ * may reap one existing idle session, refreshes last_active, and queues the
+ * session's expiry deadline on the idle min-heap.
  */
-static void session_move_to_idle(PackedArray *active, PackedArray *idle,
-                                 uint32_t active_idx) {
+static void session_move_to_idle(Broker *b, uint32_t active_idx) {
+  PackedArray *active = b->active_sessions;
+  PackedArray *idle = b->idle_sessions;
   BrokerMcpSession *src = parr_at(active, active_idx);
   if (!src)
     return;
@@ -390,12 +867,16 @@ static void session_move_to_idle(PackedArray *active, PackedArray *idle,
   Arena arena = src->arena;
   PackedArray *db_stores = src->db_stores;
   time_t created = src->created_at;
+  time_t tokens_used = src->tokens_last_used;
+  ResultSpill *spill = src->spill;
+  const TokSnapSession *restore_src = src->restore_src;
 
   /* Tear down the live connection. */
   bufch_clean(&src->bc);
   src->fd = -1;
   src->arena = (Arena){0};
   src->db_stores = NULL;
+  src->spill = NULL;
 
   /* Remove from active (cleanup callback is safe — bufch_clean is
    * idempotent). */
@@ -416,11 +897,251 @@ static void session_move_to_idle(PackedArray *active, PackedArray *idle,
   memset(dst, 0, sizeof(*dst));
   dst->fd = -1;
   memcpy(dst->resume_token, token, RESUME_TOKEN_LEN);
+  /* Mirror the token into the dense key column the resume scan walks. */
+  void *key = parr_key_at(idle, idx);
+  if (key)
+    memcpy(key, token, RESUME_TOKEN_LEN);
   dst->generation = generation;
   dst->arena = arena;
   dst->db_stores = db_stores;
   dst->created_at = created;
   dst->last_active = time(NULL);
+  dst->tokens_last_used = tokens_used;
+  dst->spill = spill;
+  dst->restore_src = restore_src;
+
+  if (b->idle_ttl_secs > 0 && b->abs_ttl_secs > 0)
+    broker_idle_heap_push(
+        b, broker_idle_deadline(dst, b->idle_ttl_secs, b->abs_ttl_secs),
+        dst->resume_token);
+}
+
+/* ---------------------------- I/O multiplexing --------------------------- */
+
+/* Marks 'fd' non-blocking so the accept loop can drain the backlog without
+ * stalling. It borrows 'fd'.
+ * Returns OK on success, ERR on invalid input or fcntl failure.
+ */
+static AdbxStatus broker_set_nonblock(int fd) {
+  if (fd < 0)
+    return ERR;
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0)
+    return ERR;
+  if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+    return ERR;
+  return OK;
+}
+
+/* Restores blocking mode on 'fd' once its handshake frame has fully arrived;
+ * session I/O relies on blocking reads bounded by SO_RCVTIMEO. It borrows
+ * 'fd'. Returns OK on success, ERR on invalid input or fcntl failure.
+ */
+static AdbxStatus broker_set_block(int fd) {
+  if (fd < 0)
+    return ERR;
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags < 0)
+    return ERR;
+  if (fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) != 0)
+    return ERR;
+  return OK;
+}
+
+#ifdef __linux__
+
+/* Creates the owned epoll instance and registers the listen socket.
+ * Side effects: allocates one kernel epoll fd stored in b->ep_fd.
+ * Returns OK on success, ERR on invalid input or syscall failure.
+ */
+static AdbxStatus broker_poller_init(Broker *b) {
+  if (!b || b->listen_fd < 0)
+    return ERR;
+
+  b->ep_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (b->ep_fd < 0)
+    return ERR;
+
+  struct epoll_event ev = {0};
+  ev.events = EPOLLIN;
+  ev.data.fd = b->listen_fd;
+  if (epoll_ctl(b->ep_fd, EPOLL_CTL_ADD, b->listen_fd, &ev) != 0) {
+    safe_close_fd(&b->ep_fd);
+    return ERR;
+  }
+  return OK;
+}
+
+/* Releases the owned epoll instance, if any. */
+static void broker_poller_clean(Broker *b) {
+  if (!b)
+    return;
+  safe_close_fd(&b->ep_fd);
+}
+
+/* Registers one session fd for readability events.
+ * Deregistration is implicit: closing the fd removes it from the epoll set.
+ * Returns OK on success, ERR on invalid input or epoll_ctl failure.
+ */
+static AdbxStatus broker_poller_add(Broker *b, int fd) {
+  if (!b || b->ep_fd < 0 || fd < 0)
+    return ERR;
+
+  struct epoll_event ev = {0};
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  return (epoll_ctl(b->ep_fd, EPOLL_CTL_ADD, fd, &ev) == 0) ? OK : ERR;
+}
+
+/* Removes one fd from the epoll set without closing it (a mid-handshake fd
+ * is re-registered by the session path once the handshake succeeds).
+ * Returns OK on success, ERR on invalid input or epoll_ctl failure.
+ */
+static AdbxStatus broker_poller_del(Broker *b, int fd) {
+  if (!b || b->ep_fd < 0 || fd < 0)
+    return ERR;
+  return (epoll_ctl(b->ep_fd, EPOLL_CTL_DEL, fd, NULL) == 0) ? OK : ERR;
+}
+
+/* Enables or disables readability reports for one registered fd. Busy
+ * sessions are disarmed so buffered-but-unserved bytes do not spin the loop.
+ * Returns OK on success, ERR on invalid input or epoll_ctl failure.
+ */
+static AdbxStatus broker_poller_set_armed(Broker *b, int fd, int armed) {
+  if (!b || b->ep_fd < 0 || fd < 0)
+    return ERR;
+
+  struct epoll_event ev = {0};
+  ev.events = armed ? EPOLLIN : 0;
+  ev.data.fd = fd;
+  return (epoll_ctl(b->ep_fd, EPOLL_CTL_MOD, fd, &ev) == 0) ? OK : ERR;
+}
+
+/* Waits for I/O readiness on the listen socket and all registered sessions.
+ * It borrows 'evs' storage of 'cap' entries.
+ * Returns number of events written to 'evs' (0 on timeout/EINTR), -1 on fatal
+ * wait failure.
+ */
+static int broker_wait_events(Broker *b, BrokerIoEvent *evs, size_t cap,
+                              int timeout_ms) {
+  struct epoll_event *kevs = b->wait_kevs;
+  size_t want = (cap < BROKER_WAIT_SLOTS) ? cap : BROKER_WAIT_SLOTS;
+
+  int rc = epoll_wait(b->ep_fd, kevs, (int)want, timeout_ms);
+  if (rc < 0)
+    return (errno == EINTR) ? 0 : -1;
+
+  for (int i = 0; i < rc; i++) {
+    evs[i].fd = kevs[i].data.fd;
+    evs[i].is_err = ((kevs[i].events & (EPOLLHUP | EPOLLERR)) != 0) &&
+                    ((kevs[i].events & EPOLLIN) == 0);
+  }
+  return rc;
+}
+
+#else /* !__linux__: portable poll() fallback */
+
+static AdbxStatus broker_poller_init(Broker *b) {
+  return (b && b->listen_fd >= 0) ? OK : ERR;
+}
+
+static void broker_poller_clean(Broker *b) { (void)b; }
+
+static AdbxStatus broker_poller_add(Broker *b, int fd) {
+  // The poll fallback rebuilds its fd set from active_sessions every wait.
+  return (b && fd >= 0) ? OK : ERR;
+}
+
+static AdbxStatus broker_poller_set_armed(Broker *b, int fd, int armed) {
+  // The poll fallback skips busy sessions when it rebuilds its fd set.
+  (void)armed;
+  return (b && fd >= 0) ? OK : ERR;
+}
+
+static AdbxStatus broker_poller_del(Broker *b, int fd) {
+  // The poll fallback rebuilds its fd set every wait.
+  return (b && fd >= 0) ? OK : ERR;
+}
+
+static int broker_wait_events(Broker *b, BrokerIoEvent *evs, size_t cap,
+                              int timeout_ms) {
+  struct pollfd *pfds = b->wait_pfds;
+
+  size_t nsessions = parr_len(b->active_sessions);
+  size_t nfds = 2 + nsessions + b->pending_hs_len;
+  memset(pfds, 0, nfds * sizeof(*pfds));
+
+  pfds[0].fd = b->listen_fd;
+  pfds[0].events = POLLIN;
+  pfds[1].fd = b->exec_pool ? exec_pool_done_fd(b->exec_pool) : -1;
+  pfds[1].events = POLLIN;
+  for (size_t i = 0; i < nsessions; i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_cat(b->active_sessions, (uint32_t)i);
+    // negative fds are ignored by poll; muted sessions are not polled (busy
+    // ones stay polled so cancellation notifications are seen)
+    pfds[2 + i].fd = (sess && !sess->read_muted) ? sess->fd : -1;
+    pfds[2 + i].events = POLLIN;
+  }
+  for (uint32_t i = 0; i < b->pending_hs_len; i++) {
+    pfds[2 + nsessions + i].fd = b->pending_hs[i].fd;
+    pfds[2 + nsessions + i].events = POLLIN;
+  }
+
+  int rc = poll(pfds, nfds, timeout_ms);
+  if (rc < 0)
+    return (errno == EINTR) ? 0 : -1;
+
+  int out = 0;
+  for (size_t i = 0; i < nfds && out < (int)cap; i++) {
+    if (pfds[i].revents == 0)
+      continue;
+    evs[out].fd = pfds[i].fd;
+    evs[out].is_err =
+        ((pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) &&
+        ((pfds[i].revents & POLLIN) == 0);
+    out++;
+  }
+  return out;
+}
+
+#endif /* __linux__ */
+
+/* Finds the active session that owns 'fd'.
+ * Returns index [0..len) when found, -1 otherwise (e.g. the session was
+ * dropped earlier in the same event batch).
+ */
+static ssize_t broker_find_active_by_fd(const PackedArray *active, int fd) {
+  if (!active || fd < 0)
+    return -1;
+
+  size_t n = parr_len(active);
+  for (size_t i = 0; i < n; i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_cat(active, (uint32_t)i);
+    if (sess && sess->fd == fd)
+      return (ssize_t)i;
+  }
+  return -1;
+}
+
+/* Finds the active session with activation serial 'serial'.
+ * Returns index [0..len) when found, -1 when the session is gone (dropped or
+ * moved to idle while its job was in flight).
+ */
+static ssize_t broker_find_active_by_serial(const PackedArray *active,
+                                            uint64_t serial) {
+  if (!active || serial == 0)
+    return -1;
+
+  size_t n = parr_len(active);
+  for (size_t i = 0; i < n; i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_cat(active, (uint32_t)i);
+    if (sess && sess->serial == serial)
+      return (ssize_t)i;
+  }
+  return -1;
 }
 
 /* --------------------------------- Broker ------------------------------- */
@@ -492,6 +1213,85 @@ err_restore: {
   return -1;
 }
 
+/* Interns one catalog column rule identifier into the shared pool.
+ * It borrows 'pool', 'id' and the rule parts; 'id' is reused as scratch.
+ * Side effects: may append one interned string to 'pool'.
+ * Error semantics: best-effort; interning failures are ignored (the pool is
+ * an optimization, misses just fall back to per-store interning).
+ */
+static void broker_seed_col_ref(StringPool *pool, StrBuf *id,
+                                const char *schema, const char *table,
+                                const char *col) {
+  sb_reset(id);
+  if (schema) {
+    if (sb_append_bytes(id, schema, strlen(schema)) != OK ||
+        sb_append_bytes(id, ".", 1) != OK)
+      return;
+  }
+  if (sb_append_bytes(id, table, strlen(table)) != OK ||
+      sb_append_bytes(id, ".", 1) != OK ||
+      sb_append_bytes(id, col, strlen(col)) != OK)
+    return;
+  (void)spool_addn(pool, id->data, id->len);
+}
+
+/* Seeds the broker-owned shared identifier pool from every profile's column
+ * policy, in the validator's canonical "table.col"/"schema.table.col" format.
+ * It borrows 'b' and reads profiles through the ConnManager.
+ * Side effects: allocates and populates b->shared_col_refs; the pool is
+ * frozen afterwards (nothing writes to it past this function).
+ * Error semantics: best-effort; on failure the broker runs without a shared
+ * pool and per-session stores intern everything themselves.
+ */
+static void broker_seed_shared_col_refs(Broker *b) {
+  size_t n = connm_list_profiles(b->cm, NULL, 0);
+  if (n == 0)
+    return;
+
+  StringPool *pool = spool_create();
+  if (!pool)
+    return;
+
+  const ConnProfile **profiles = xmalloc(n * sizeof(*profiles));
+  n = connm_list_profiles(b->cm, profiles, n);
+
+  StrBuf id;
+  sb_init(&id);
+  for (size_t i = 0; i < n; i++) {
+    const ColumnPolicy *cp = &profiles[i]->col_policy;
+    for (size_t r = 0; r < cp->n_rules; r++) {
+      const ColumnRule *rule = &cp->rules[r];
+      if (!rule->table || !rule->col)
+        continue;
+      broker_seed_col_ref(pool, &id, NULL, rule->table, rule->col);
+      for (size_t s = 0; s < rule->n_schemas; s++)
+        broker_seed_col_ref(pool, &id, rule->schemas[s], rule->table,
+                            rule->col);
+    }
+  }
+  sb_clean(&id);
+  free(profiles);
+
+  b->shared_col_refs = pool;
+}
+
+/* Builds the frozen all-plaintext plan describe catalog-fetch jobs borrow.
+ * It mutates 'b->describe_plan'; storage is released by broker_destroy().
+ * Returns OK on success, ERR on allocation failure. */
+static AdbxStatus broker_init_describe_plan(Broker *b) {
+  b->describe_plan.cols = parr_create(sizeof(ValidatorColPlan));
+  if (!b->describe_plan.cols)
+    return ERR;
+  b->describe_plan.limit_value = -1;
+  for (uint32_t i = 0; i < SCHEMA_SNAPSHOT_NCOLS; i++) {
+    void *slot = NULL;
+    if (parr_emplace(b->describe_plan.cols, &slot) == UINT32_MAX)
+      return ERR;
+    memset(slot, 0, sizeof(ValidatorColPlan)); // VCOL_OUT_PLAINTEXT
+  }
+  return OK;
+}
+
 /* Creates and initializes a Broker instance.
  * Takes ownership of 'cm' only on success and internally acquires a private-dir
  * runtime rooted at 'pd'.
@@ -506,6 +1306,9 @@ Broker *broker_create(const PrivDir *pd, ConnManager *cm) {
   Broker *b = (Broker *)xcalloc(1, sizeof(Broker));
 
   b->listen_fd = -1;
+#ifdef __linux__
+  b->ep_fd = -1;
+#endif
   b->cm = NULL;
   b->rt = privdir_broker_runtime_open(pd, b->secret_token);
   if (!b->rt) {
@@ -518,10 +1321,43 @@ Broker *broker_create(const PrivDir *pd, ConnManager *cm) {
   b->abs_ttl_secs = broker_ttl_from_env_or_default("ADBX_TEST_ABS_TTL_SEC",
                                                    (uint32_t)ABSOLUTE_TTL);
 
-  b->active_sessions = parr_create(sizeof(BrokerMcpSession));
-  parr_set_cleanup(b->active_sessions, active_sessions_cleanup, NULL);
-
-  b->idle_sessions = parr_create(sizeof(BrokerMcpSession));
+  b->tok_idle_ttl_secs = broker_u32_from_env("ADBX_TOKEN_IDLE_TTL_SEC",
+                                             TOKEN_COMPACT_IDLE_TTL_SECS);
+  uint32_t budget_kb = broker_u32_from_env("ADBX_TOKEN_MEM_BUDGET_KB",
+                                           TOKEN_COMPACT_MEM_BUDGET_KB);
+  b->tok_mem_budget_bytes =
+      (budget_kb > UINT32_MAX / 1024u) ? UINT32_MAX : budget_kb * 1024u;
+
+  // Opt-in: persist resumable sessions' token stores on clean shutdown so a
+  // broker upgrade does not strand the tok_ handles agents saved (see
+  // token_snapshot.h). Off by default because it writes plaintext sensitive
+  // values (0600, owner-validated) into the private app dir.
+  b->persist_tokens =
+      (broker_u32_from_env("ADBX_PERSIST_TOKENS", 0) != 0) ? 1 : 0;
+  if (b->persist_tokens)
+    b->tok_snap = toksnap_load(b->rt->app_fd);
+
+  // Opt-in: io_uring-backed session channels (see uring_byte_channel.h).
+  b->use_uring = (broker_u32_from_env("ADBX_URING", 0) != 0) ? 1 : 0;
+
+  b->pending_hs_cap = broker_u32_from_env("ADBX_MAX_PENDING_HANDSHAKES",
+                                          BROKER_PENDING_HS_DEFAULT);
+  if (b->pending_hs_cap == 0)
+    b->pending_hs_cap = BROKER_PENDING_HS_DEFAULT;
+  if (b->pending_hs_cap > BROKER_PENDING_HS_MAX)
+    b->pending_hs_cap = BROKER_PENDING_HS_MAX;
+
+  b->active_sessions = parr_create_custom(
+      sizeof(BrokerMcpSession), PARR_CACHELINE_BYTES, 0, STRBUF_MAX_BYTES);
+  // ctx = b: dropping an active slot must release any cursor-pinned
+  // connection back into the pool (b->cm is set before any session exists).
+  parr_set_cleanup(b->active_sessions, active_sessions_cleanup, b);
+
+  /* The idle array carries a dense resume-token column so the resume lookup
+   * scans RESUME_TOKEN_LEN-byte keys instead of whole session structs. */
+  b->idle_sessions =
+      parr_create_custom(sizeof(BrokerMcpSession), PARR_CACHELINE_BYTES,
+                         RESUME_TOKEN_LEN, STRBUF_MAX_BYTES);
   parr_set_cleanup(b->idle_sessions, idle_sessions_cleanup, NULL);
 
   b->listen_fd = make_listen_socket(b->rt->run_fd, PRIVDIR_SOCK_FILENAME);
@@ -530,7 +1366,40 @@ Broker *broker_create(const PrivDir *pd, ConnManager *cm) {
     return NULL;
   }
 
+  if (broker_set_nonblock(b->listen_fd) != OK ||
+      broker_poller_init(b) != OK) {
+    broker_destroy(b);
+    return NULL;
+  }
+
+  b->exec_pool = exec_pool_create(broker_exec_workers_from_env());
+  if (!b->exec_pool ||
+      broker_poller_add(b, exec_pool_done_fd(b->exec_pool)) != OK) {
+    broker_destroy(b);
+    return NULL;
+  }
+
+  b->plan_cache = plan_cache_create(PLAN_CACHE_CAPACITY);
+  if (!b->plan_cache) {
+    broker_destroy(b);
+    return NULL;
+  }
+
+  b->result_cache = result_cache_create(RESULT_CACHE_CAPACITY);
+  if (!b->result_cache) {
+    broker_destroy(b);
+    return NULL;
+  }
+
+  b->schema_cache = schema_cache_create(
+      broker_u32_from_env("ADBX_SCHEMA_TTL_MS", SCHEMA_CACHE_DEFAULT_TTL_MS));
+  if (!b->schema_cache || broker_init_describe_plan(b) != OK) {
+    broker_destroy(b);
+    return NULL;
+  }
+
   b->cm = cm;
+  broker_seed_shared_col_refs(b);
   return b;
 }
 
@@ -541,27 +1410,90 @@ Broker *broker_create(const PrivDir *pd, ConnManager *cm) {
  * artifacts.
  * Error semantics: none (void destructor; safe on NULL).
  */
+static void broker_persist_token_stores(Broker *b);
+
 void broker_destroy(Broker *b) {
   if (!b)
     return;
 
-  parr_destroy(b->active_sessions);
-  b->active_sessions = NULL;
+  // Join workers first: in-flight jobs borrow session token stores and
+  // ConnManager backends that are torn down below.
+  exec_pool_destroy(b->exec_pool);
+  b->exec_pool = NULL;
 
-  parr_destroy(b->idle_sessions);
-  b->idle_sessions = NULL;
+  while (b->parked_head) {
+    ExecPoolJob *job = b->parked_head;
+    b->parked_head = job->next;
+    exec_pool_job_destroy(job);
+  }
+  b->parked_tail = NULL;
 
-  if (b->listen_fd >= 0) {
-    safe_close_fd(&b->listen_fd);
-    b->listen_fd = -1;
+  while (b->flights) {
+    BrokerFlight *f = b->flights;
+    b->flights = f->next;
+    broker_flight_free(f);
   }
 
-  privdir_broker_runtime_clean(b->rt);
-  b->rt = NULL;
+  while (b->fanouts) {
+    BrokerFanout *f = b->fanouts;
+    b->fanouts = f->next;
+    broker_fanout_free(f);
+  }
 
-  connm_destroy(b->cm);
-  free(b);
-}
+  // Workers are joined and nothing borrows the stores anymore: persist
+  // resumable token state before the session arrays are torn down.
+  if (b->persist_tokens)
+    broker_persist_token_stores(b);
+
+  plan_cache_destroy(b->plan_cache);
+  b->plan_cache = NULL;
+
+  result_cache_destroy(b->result_cache);
+  b->result_cache = NULL;
+
+  schema_cache_destroy(b->schema_cache);
+  b->schema_cache = NULL;
+
+  parr_destroy(b->describe_plan.cols);
+  b->describe_plan.cols = NULL;
+
+  parr_destroy(b->active_sessions);
+  b->active_sessions = NULL;
+
+  parr_destroy(b->idle_sessions);
+  b->idle_sessions = NULL;
+
+  // After the session arrays: snapshot-resumed sessions borrow restore_src
+  // records out of this object.
+  toksnap_destroy(b->tok_snap);
+  b->tok_snap = NULL;
+
+  // After the session arrays: their token stores layer pools over this one.
+  spool_destroy(b->shared_col_refs);
+  b->shared_col_refs = NULL;
+
+  jstokws_clean(&b->req_tok_ws);
+
+  for (uint32_t i = 0; i < b->pending_hs_len; i++)
+    safe_close_fd(&b->pending_hs[i].fd);
+  b->pending_hs_len = 0;
+
+  broker_poller_clean(b);
+
+  if (b->listen_fd >= 0) {
+    safe_close_fd(&b->listen_fd);
+    b->listen_fd = -1;
+  }
+
+  privdir_broker_runtime_clean(b->rt);
+  b->rt = NULL;
+
+  free(b->reload_config_path);
+  b->reload_config_path = NULL;
+
+  connm_destroy(b->cm);
+  free(b);
+}
 
 /*-------------------------------- Tools Call -------------------------------*/
 
@@ -579,72 +1511,778 @@ static void broker_db_store_cleanup(void *obj, void *ctx) {
   *slot = NULL;
 }
 
-/* Finds one DbTokenStore by exact connection name.
- * It borrows 'stores' and 'connection_name'; no allocations.
+/* Finds one DbTokenStore by its connection's catalog index.
+ * It borrows 'db_stores'; no allocations, no name compares.
  * Side effects: none.
- * Error semantics: returns mutable store pointer on match, NULL otherwise.
+ * Error semantics: returns mutable store pointer when the session already has
+ * one for that connection, NULL otherwise (including never-touched slots).
  */
-static DbTokenStore *broker_find_store(PackedArray *stores,
-                                       const char *connection_name) {
-  if (!stores || !connection_name)
+static DbTokenStore *broker_find_store(const PackedArray *db_stores,
+                                       uint32_t catalog_idx) {
+  if (!db_stores)
     return NULL;
-
-  size_t n = parr_len(stores);
-  for (size_t i = 0; i < n; i++) {
-    DbTokenStore **slot = (DbTokenStore **)parr_at(stores, (uint32_t)i);
-    if (!slot || !*slot)
-      continue;
-    AdbxTriStatus eq = stok_store_matches_conn_name(*slot, connection_name);
-    if (eq == YES)
-      return *slot;
-  }
-  return NULL;
+  DbTokenStore *const *slot =
+      (DbTokenStore *const *)parr_cat(db_stores, catalog_idx);
+  return slot ? *slot : NULL;
 }
 
 /* Resolves per-session store for the selected connection, lazily creating it.
- * It borrows 'sess' and 'profile' and returns a borrowed pointer in
- * '*out_store'.
- * Side effects: may append one DbTokenStore to an already-initialized session.
+ * It borrows 'sess', 'profile' and the optional frozen 'shared_col_refs'
+ * pool, and returns a borrowed pointer in '*out_store'.
+ * Side effects: may append one DbTokenStore to an already-initialized session
+ * and index it by connection name.
  * Error semantics: returns OK on success, ERR on invalid input or allocation
  * failure.
  */
-static AdbxStatus broker_get_or_init_store(BrokerMcpSession *sess,
+static AdbxStatus broker_get_or_init_store(Broker *b, BrokerMcpSession *sess,
                                            const ConnProfile *profile,
+                                           const StringPool *shared_col_refs,
                                            DbTokenStore **out_store) {
   if (out_store)
     *out_store = NULL;
-  if (!sess || !profile || !profile->connection_name || !out_store)
+  if (!b || !sess || !profile || !profile->connection_name || !out_store)
     return ERR;
+
+  // Replica groups share one store, bound to the group leader, so a token
+  // minted through one member resolves when a later request routes to
+  // another (replicas serve the same data).
+  if (profile->group_leader_idx != profile->catalog_idx) {
+    const ConnProfile *leader =
+        connm_profile_by_idx(b->cm, profile->group_leader_idx);
+    if (leader)
+      profile = leader;
+  }
   if (!sess->db_stores || sess->arena.head == NULL || sess->arena.tail == NULL)
     return ERR;
 
   assert(sess->arena.cap > 0);
   assert(sess->arena.block_sz > 0);
 
+  // Any query routed through a store counts as recent token activity for
+  // the compaction TTL, whether it mints new tokens or resolves old ones.
+  sess->tokens_last_used = time(NULL);
+
   DbTokenStore *found =
-      broker_find_store(sess->db_stores, profile->connection_name);
+      broker_find_store(sess->db_stores, profile->catalog_idx);
   if (found) {
     *out_store = found;
     return OK;
   }
 
-  DbTokenStore **slot = NULL;
-  uint32_t idx = parr_emplace(sess->db_stores, (void **)&slot);
-  if (idx == UINT32_MAX || !slot)
-    return ERR;
-  *slot = NULL;
+  // Grow the flat map with empty slots up to this connection's index.
+  // Sessions usually touch one or two connections and the catalog is capped,
+  // so sparse slots cost one pointer each. Slots are never drop_swap'd:
+  // positions must stay stable for index addressing.
+  while (parr_len(sess->db_stores) <= profile->catalog_idx) {
+    DbTokenStore **slot = NULL;
+    if (parr_emplace(sess->db_stores, (void **)&slot) == UINT32_MAX || !slot)
+      return ERR;
+    *slot = NULL;
+  }
 
-  DbTokenStore *store = stok_store_create(profile, &sess->arena);
-  if (!store) {
-    parr_drop_swap(sess->db_stores, idx);
+  DbTokenStore *store =
+      stok_store_create_with_shared(profile, &sess->arena, shared_col_refs);
+  if (!store)
     return ERR;
+  DbTokenStore **slot =
+      (DbTokenStore **)parr_at(sess->db_stores, profile->catalog_idx);
+  assert(slot);
+  *slot = store;
+
+  // First touch after a broker restart: replay this connection's persisted
+  // tokens so pre-restart handles keep resolving. Best-effort — a partial
+  // replay leaves the replayed handles valid and the rest erroring as stale.
+  if (sess->restore_src &&
+      toksnap_restore_store(sess->restore_src, profile->connection_name,
+                            sess->generation, store) != OK) {
+    TLOG("WARN - persisted token restore failed for connection '%s'",
+         profile->connection_name);
   }
 
-  *slot = store;
   *out_store = store;
   return OK;
 }
 
+/* Writes one session's resumable token state into 'w': every non-empty live
+ * store plus any persisted store the session never re-materialized since the
+ * previous restart (its lazy restore must survive another clean restart).
+ * Sessions with nothing to persist are skipped entirely.
+ * Side effects: appends to the writer; a failed append poisons it.
+ */
+static void broker_persist_session(Broker *b, TokSnapWriter *w,
+                                   const BrokerMcpSession *sess) {
+  uint32_t n_live = sess->db_stores ? parr_len(sess->db_stores) : 0;
+  uint32_t n_stores = 0;
+
+  for (uint32_t i = 0; i < n_live; i++) {
+    DbTokenStore *st = broker_find_store(sess->db_stores, i);
+    if (st && stok_store_len(st) > 0 && connm_profile_by_idx(b->cm, i))
+      n_stores++;
+  }
+
+  const TokSnapSession *rec = sess->restore_src;
+  uint32_t n_pending = 0;
+  if (rec) {
+    for (uint32_t r = 0; r < rec->n_stores; r++) {
+      int materialized = 0;
+      for (uint32_t i = 0; i < n_live && !materialized; i++) {
+        DbTokenStore *st = broker_find_store(sess->db_stores, i);
+        if (st && stok_store_matches_conn_name(
+                      st, rec->stores[r].connection_name) == YES)
+          materialized = 1;
+      }
+      if (!materialized)
+        n_pending++;
+    }
+  }
+
+  if (n_stores + n_pending == 0)
+    return;
+
+  if (toksnap_writer_session(w, sess->resume_token, sess->generation,
+                             (int64_t)sess->created_at,
+                             (int64_t)sess->last_active,
+                             (int64_t)sess->tokens_last_used,
+                             n_stores + n_pending) != OK)
+    return;
+
+  for (uint32_t i = 0; i < n_live; i++) {
+    DbTokenStore *st = broker_find_store(sess->db_stores, i);
+    if (!st || stok_store_len(st) == 0)
+      continue;
+    const ConnProfile *profile = connm_profile_by_idx(b->cm, i);
+    if (!profile)
+      continue;
+    if (toksnap_writer_store(w, profile->connection_name, st) != OK)
+      return;
+  }
+
+  if (!rec)
+    return;
+  for (uint32_t r = 0; r < rec->n_stores; r++) {
+    int materialized = 0;
+    for (uint32_t i = 0; i < n_live && !materialized; i++) {
+      DbTokenStore *st = broker_find_store(sess->db_stores, i);
+      if (st && stok_store_matches_conn_name(
+                    st, rec->stores[r].connection_name) == YES)
+        materialized = 1;
+    }
+    if (!materialized &&
+        toksnap_writer_store_rec(w, &rec->stores[r]) != OK)
+      return;
+  }
+}
+
+/* Serializes every resumable session's token stores into the private app dir
+ * (see token_snapshot.h). Active sessions count too: their clients hold
+ * resume tokens and reconnect after the restart.
+ * Side effects: one atomic file write (or stale-snapshot unlink); failures
+ * only log — shutdown proceeds either way.
+ */
+static void broker_persist_token_stores(Broker *b) {
+  TokSnapWriter w;
+  toksnap_writer_init(&w);
+
+  for (uint32_t i = 0; i < parr_len(b->active_sessions); i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_at(b->active_sessions, i);
+    if (sess)
+      broker_persist_session(b, &w, sess);
+  }
+  for (uint32_t i = 0; i < parr_len(b->idle_sessions); i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_at(b->idle_sessions, i);
+    if (sess)
+      broker_persist_session(b, &w, sess);
+  }
+
+  if (toksnap_writer_commit(&w, b->rt->app_fd) != OK)
+    TLOG("WARN - failed to persist token-store snapshot");
+}
+
+/* Compacts one session's token state when it is over budget or idle too long.
+ * Token values live in the session arena, so individual tokens cannot be
+ * freed; compaction works at generation granularity instead: bump the
+ * session generation (outstanding handles then fail the existing staleness
+ * check with a "run a fresh query" error), empty every store, and reset the
+ * arena. Must only run on the broker thread while 'sess' has no in-flight
+ * job (workers borrow the stores and arena).
+ * Side effects: may wipe token stores, zero + reset the session arena, and
+ * bump sess->generation.
+ * Error semantics: best-effort; failures leave stores empty and are logged.
+ */
+static void broker_session_maybe_compact_tokens(Broker *b,
+                                                BrokerMcpSession *sess) {
+  if (!b || !sess || sess->busy || !sess->db_stores)
+    return;
+  if (parr_len(sess->db_stores) == 0 || sess->tokens_last_used == 0)
+    return;
+
+  time_t now = time(NULL);
+  int over_budget = b->tok_mem_budget_bytes > 0 &&
+                    arena_get_used(&sess->arena) > b->tok_mem_budget_bytes;
+  int idle_too_long = b->tok_idle_ttl_secs > 0 && now > sess->tokens_last_used &&
+                      (now - sess->tokens_last_used) >
+                          (time_t)b->tok_idle_ttl_secs;
+  if (!over_budget && !idle_too_long)
+    return;
+
+  TLOG("INFO - compacting session tokens (used=%u budget=%u idle=%s)",
+       arena_get_used(&sess->arena), b->tok_mem_budget_bytes,
+       idle_too_long ? "yes" : "no");
+
+  sess->generation++;
+  for (uint32_t i = 0; i < parr_len(sess->db_stores); i++) {
+    DbTokenStore **slot = (DbTokenStore **)parr_at(sess->db_stores, i);
+    if (slot && *slot && stok_store_clear(*slot) != OK)
+      TLOG("ERROR - token store clear failed during compaction");
+  }
+  // Token values may be sensitive plaintext: scrub before recycling blocks.
+  arena_zero_mem(&sess->arena);
+  arena_reset(&sess->arena);
+  sess->tokens_last_used = 0;
+}
+
+/* Deep-copies one request id into 'dst'.
+ * Ownership: caller must mcp_id_clean() 'dst' on success.
+ * Returns OK on success, ERR on invalid input or allocation failure.
+ */
+static AdbxStatus broker_copy_mcp_id(McpId *dst, const McpId *src) {
+  if (!dst || !src)
+    return ERR;
+  if (src->kind == MCP_ID_STR)
+    return mcp_id_init_str_copy(dst, src->str);
+  mcp_id_init_u32(dst, src->u32);
+  return OK;
+}
+
+/* Parses the optional "priority" tool argument ("fast", "normal", "heavy").
+ * It borrows 'jg' and writes the declared class to '*out' (NORMAL when the
+ * argument is absent). The profile cap is applied later, once the profile is
+ * known, via safety_policy_clamp_priority().
+ * Returns YES/NO like the underlying getter, ERR on a non-string or unknown
+ * value.
+ */
+static AdbxTriStatus broker_parse_priority(const JsonGetter *jg,
+                                           SafetyPriority *out) {
+  *out = SAFETY_PRIO_NORMAL;
+  JsonStrSpan sp = {0};
+  AdbxTriStatus rc = jsget_string_span(jg, "params.arguments.priority", &sp);
+  if (rc != YES)
+    return rc;
+  if (sp.len == 4 && strncmp(sp.ptr, "fast", 4) == 0)
+    *out = SAFETY_PRIO_FAST;
+  else if (sp.len == 6 && strncmp(sp.ptr, "normal", 6) == 0)
+    *out = SAFETY_PRIO_NORMAL;
+  else if (sp.len == 5 && strncmp(sp.ptr, "heavy", 5) == 0)
+    *out = SAFETY_PRIO_HEAVY;
+  else
+    return ERR;
+  return YES;
+}
+
+/* Packages one validated request into an ExecPoolJob and queues it.
+ * 'cache_ttl_ms' is recorded on the job so the completion handler may retain
+ * the serialized response in the result cache (0 = never cached).
+ * Ownership: on OK takes '*sql'/'*conn_name' (set to NULL) and moves 'vout'
+ * into the job; on ERR the caller keeps ownership of all inputs.
+ * Side effects: marks the session busy so no further frames are served until
+ * the completion is popped.
+ * Returns OK when the job is queued, ERR otherwise.
+ */
+static AdbxStatus broker_submit_exec_job(Broker *b, BrokerMcpSession *sess,
+                                         const McpId *id, const ConnView *cv,
+                                         char **sql, char **conn_name,
+                                         ValidateQueryOut *vout,
+                                         DbTokenStore *store,
+                                         const DbExecParam *params,
+                                         uint32_t nparams, uint8_t bound,
+                                         uint8_t columnar, uint8_t priority,
+                                         uint64_t cache_ttl_ms) {
+  if (!b || !b->exec_pool || !sess || !id || !cv || !sql || !*sql ||
+      !conn_name || !*conn_name || !vout || !store)
+    return ERR;
+  if (nparams > MAX_TOKEN_PARAMS || (nparams > 0 && !params))
+    return ERR;
+
+  ExecPoolJob *job = exec_pool_job_create();
+  if (broker_copy_mcp_id(&job->id, id) != OK) {
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  job->session_serial = sess->serial;
+  job->db = cv->db;
+  job->sql = *sql;
+  job->conn_name = *conn_name;
+  job->vout = *vout; // moved: the plan must outlive the worker execution
+  job->store = store;
+  job->generation = sess->generation;
+  job->bound = bound;
+  job->columnar = columnar;
+  job->priority = priority;
+  job->spill_dirfd = b->rt ? b->rt->run_fd : -1;
+  job->arena_size_hint = connm_result_arena_hint(b->cm, job->conn_name);
+  job->cache_ttl_ms = cache_ttl_ms;
+  job->nparams = nparams;
+  for (uint32_t i = 0; i < nparams; i++)
+    job->params[i] = params[i];
+
+  if (exec_pool_submit(b->exec_pool, job) != OK) {
+    // Give ownership back to the caller before releasing the husk.
+    job->sql = NULL;
+    job->conn_name = NULL;
+    memset(&job->vout, 0, sizeof(job->vout));
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  *sql = NULL;
+  *conn_name = NULL;
+  memset(vout, 0, sizeof(*vout)); // job owns the plan storage now
+  sess->busy = 1;
+  // Remember what runs so a cancellation notification can abort it.
+  mcp_id_clean(&sess->inflight_id);
+  (void)broker_copy_mcp_id(&sess->inflight_id, id);
+  sess->inflight_db = cv->db;
+  return OK;
+}
+
+/* Packages one validated open_sql_cursor request and queues it. The job
+ * carries the checked-out connection plus the minted cursor name/handle; the
+ * completion handler installs the SessionCursor on success.
+ * Ownership: like broker_submit_exec_job — on OK takes '*sql'/'*conn_name'
+ * (set to NULL) and moves 'vout' into the job; on ERR the caller keeps
+ * ownership of all inputs.
+ * Side effects: marks the session busy.
+ * Returns OK when the job is queued, ERR otherwise.
+ */
+static AdbxStatus broker_submit_cursor_open_job(
+    Broker *b, BrokerMcpSession *sess, const McpId *id, const ConnView *cv,
+    char **sql, char **conn_name, ValidateQueryOut *vout, DbTokenStore *store,
+    const char *cursor_name, const char *handle_hex, uint32_t max_page_rows) {
+  if (!b || !b->exec_pool || !sess || !id || !cv || !cv->db || !sql || !*sql ||
+      !conn_name || !*conn_name || !vout || !store || !cursor_name ||
+      !handle_hex)
+    return ERR;
+
+  ExecPoolJob *job = exec_pool_job_create();
+  if (broker_copy_mcp_id(&job->id, id) != OK) {
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  job->session_serial = sess->serial;
+  job->db = cv->db;
+  job->sql = *sql;
+  job->conn_name = *conn_name;
+  job->vout = *vout; // moved: the plan must outlive the worker execution
+  job->store = store;
+  job->generation = sess->generation;
+  job->cursor_op = EXEC_CURSOR_OPEN;
+  snprintf(job->cursor_name, sizeof(job->cursor_name), "%s", cursor_name);
+  snprintf(job->cursor_handle, sizeof(job->cursor_handle), "%s", handle_hex);
+  // Stash the policy row cap here; it becomes the cursor's page clamp when
+  // the completion installs the SessionCursor. Cursor pages never spill, so
+  // spill_dirfd stays disabled.
+  job->cursor_nrows = max_page_rows;
+
+  if (exec_pool_submit(b->exec_pool, job) != OK) {
+    // Give ownership back to the caller before releasing the husk.
+    job->sql = NULL;
+    job->conn_name = NULL;
+    memset(&job->vout, 0, sizeof(job->vout));
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  *sql = NULL;
+  *conn_name = NULL;
+  memset(vout, 0, sizeof(*vout)); // job owns the plan storage now
+  sess->busy = 1;
+  mcp_id_clean(&sess->inflight_id);
+  (void)broker_copy_mcp_id(&sess->inflight_id, id);
+  sess->inflight_db = cv->db;
+  return OK;
+}
+
+/* Packages a validated request like broker_submit_exec_job, but parks it until
+ * a pooled connection for '*conn_name' frees up; the session serial is
+ * registered as a waiter cookie with ConnManager so checkins can redeem it.
+ * Ownership: on OK the job owns '*sql', '*conn_name' (both NULLed) and 'vout'
+ * is moved; on ERR (full wait queue) the caller keeps ownership of all inputs.
+ * Side effects: marks the session busy; it stays parked until dispatched.
+ * Returns OK when the job is parked, ERR otherwise.
+ */
+static AdbxStatus broker_park_exec_job(Broker *b, BrokerMcpSession *sess,
+                                       const McpId *id, char **sql,
+                                       char **conn_name, ValidateQueryOut *vout,
+                                       DbTokenStore *store,
+                                       const DbExecParam *params,
+                                       uint32_t nparams, uint8_t bound,
+                                       uint8_t columnar, uint8_t priority,
+                                       uint64_t cache_ttl_ms) {
+  if (!b || !sess || !id || !sql || !*sql || !conn_name || !*conn_name ||
+      !vout || !store || nparams > MAX_TOKEN_PARAMS)
+    return ERR;
+
+  if (connm_wait(b->cm, *conn_name, sess->serial) != OK)
+    return ERR;
+
+  ExecPoolJob *job = exec_pool_job_create();
+  if (!job || broker_copy_mcp_id(&job->id, id) != OK) {
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  job->session_serial = sess->serial;
+  job->db = NULL; // filled when a pooled connection is checked out for it
+  job->sql = *sql;
+  job->conn_name = *conn_name;
+  job->vout = *vout; // moved: the plan must outlive the worker execution
+  job->store = store;
+  job->generation = sess->generation;
+  job->bound = bound;
+  job->columnar = columnar;
+  job->priority = priority;
+  job->spill_dirfd = b->rt ? b->rt->run_fd : -1;
+  job->arena_size_hint = connm_result_arena_hint(b->cm, job->conn_name);
+  job->cache_ttl_ms = cache_ttl_ms;
+  job->nparams = nparams;
+  for (uint32_t i = 0; i < nparams; i++)
+    job->params[i] = params[i];
+
+  job->next = NULL;
+  if (b->parked_tail) {
+    b->parked_tail->next = job;
+  } else {
+    b->parked_head = job;
+  }
+  b->parked_tail = job;
+
+  *sql = NULL;
+  *conn_name = NULL;
+  memset(vout, 0, sizeof(*vout)); // job owns the plan storage now
+  sess->busy = 1;
+  // Parked jobs hold no connection yet, so only the id is tracked; the
+  // dispatcher fills inflight_db when the job reaches a worker.
+  mcp_id_clean(&sess->inflight_id);
+  (void)broker_copy_mcp_id(&sess->inflight_id, id);
+  sess->inflight_db = NULL;
+  return OK;
+}
+
+/* Unlinks and returns the parked job owned by session 'serial', or NULL. */
+static ExecPoolJob *broker_take_parked_by_serial(Broker *b, uint64_t serial) {
+  ExecPoolJob *prev = NULL;
+  for (ExecPoolJob *job = b->parked_head; job; prev = job, job = job->next) {
+    if (job->session_serial != serial)
+      continue;
+    if (prev) {
+      prev->next = job->next;
+    } else {
+      b->parked_head = job->next;
+    }
+    if (b->parked_tail == job)
+      b->parked_tail = prev;
+    job->next = NULL;
+    return job;
+  }
+  return NULL;
+}
+
+/* ------------------------------ Single-flight ---------------------------- */
+
+/* Returns 1 when the plan tokenizes at least one output column. Tokenized
+ * results are session-bound (tokens resolve only against the minting
+ * session's store), so they must never fan out to other sessions. */
+static int broker_plan_has_token_out(const ValidatorPlan *plan) {
+  if (!plan || !plan->cols)
+    return 0;
+  for (uint32_t i = 0; i < parr_len(plan->cols); i++) {
+    const ValidatorColPlan *col =
+        (const ValidatorColPlan *)parr_cat(plan->cols, i);
+    if (col && col->kind == VCOL_OUT_TOKEN)
+      return 1;
+  }
+  return 0;
+}
+
+/* Builds the exact-match single-flight key into 'kb' (connection name and
+ * executed SQL, NUL-separated, like the plan-cache key). Bound parameters
+ * never reach this layer: the tokens tool is excluded from single-flight
+ * outright, so the key needs no param fingerprint.
+ */
+static AdbxStatus broker_flight_key(StrBuf *kb, const char *conn_name,
+                                    const char *sql) {
+  if (!kb || !conn_name || !sql)
+    return ERR;
+  if (sb_append_bytes(kb, conn_name, strlen(conn_name) + 1) != OK)
+    return ERR;
+  return sb_append_bytes(kb, sql, strlen(sql) + 1);
+}
+
+/* Returns the flight matching (hash, key bytes) or NULL. Full key bytes are
+ * verified so hash collisions can never join unrelated queries. */
+static BrokerFlight *broker_flight_find(Broker *b, uint64_t hash,
+                                        const char *key, size_t key_len) {
+  for (BrokerFlight *f = b->flights; f; f = f->next) {
+    if (f->hash == hash && f->key_len == key_len &&
+        memcmp(f->key, key, key_len) == 0)
+      return f;
+  }
+  return NULL;
+}
+
+/* Registers one new flight led by session 'leader_serial'. Takes the key
+ * bytes out of 'kb' conceptually by copying them (kb stays caller-owned).
+ * Error semantics: fail-soft for the caller — ERR just means no dedup. */
+static AdbxStatus broker_flight_create(Broker *b, uint64_t hash,
+                                       const StrBuf *kb,
+                                       uint64_t leader_serial) {
+  if (!b || !kb || kb->len == 0)
+    return ERR;
+  BrokerFlight *f = xcalloc(1, sizeof(*f));
+  f->hash = hash;
+  f->key = xmalloc(kb->len);
+  memcpy(f->key, kb->data, kb->len);
+  f->key_len = kb->len;
+  f->leader_serial = leader_serial;
+  f->next = b->flights;
+  b->flights = f;
+  return OK;
+}
+
+/* Attaches 'sess' as a follower of flight 'f': the session goes busy exactly
+ * as if its own job were queued, and the leader's completion answers it.
+ * Returns OK on success, ERR when the waiter could not be recorded. */
+static AdbxStatus broker_flight_attach(BrokerFlight *f, BrokerMcpSession *sess,
+                                       const McpId *id, uint8_t columnar) {
+  if (!f || !sess || !id)
+    return ERR;
+  BrokerFlightWaiter *w = xcalloc(1, sizeof(*w));
+  if (broker_copy_mcp_id(&w->id, id) != OK) {
+    free(w);
+    return ERR;
+  }
+  w->serial = sess->serial;
+  w->columnar = columnar;
+  w->next = f->waiters;
+  f->waiters = w;
+
+  sess->busy = 1;
+  mcp_id_clean(&sess->inflight_id);
+  (void)broker_copy_mcp_id(&sess->inflight_id, id);
+  sess->inflight_db = NULL; // nothing of this session's runs on a worker
+  return OK;
+}
+
+/* Frees one detached flight and any waiters still recorded on it. */
+static void broker_flight_free(BrokerFlight *f) {
+  if (!f)
+    return;
+  BrokerFlightWaiter *w = f->waiters;
+  while (w) {
+    BrokerFlightWaiter *next = w->next;
+    mcp_id_clean(&w->id);
+    free(w);
+    w = next;
+  }
+  free(f->key);
+  free(f);
+}
+
+static void broker_finish_deferred(Broker *b, uint32_t idx,
+                                   QueryResult *q_res);
+
+/* Resolves the flight led by 'leader_serial', if any: every waiter receives
+ * a clone of 'res' stamped with its own request id ('res' NULL or a failed
+ * clone degrade to a scheduling error). Must run before the leader's own
+ * broker_finish_deferred(): delivering can drop or swap sessions, so the
+ * caller must re-resolve any session index it still needs afterwards.
+ */
+static void broker_flight_resolve(Broker *b, uint64_t leader_serial,
+                                  const QueryResult *res) {
+  BrokerFlight **link = &b->flights;
+  BrokerFlight *f = NULL;
+  for (; *link; link = &(*link)->next) {
+    if ((*link)->leader_serial == leader_serial) {
+      f = *link;
+      *link = f->next; // detach before delivering (delivery re-enters arrays)
+      break;
+    }
+  }
+  if (!f)
+    return;
+
+  for (BrokerFlightWaiter *w = f->waiters; w; w = w->next) {
+    QueryResult *copy = res ? qr_clone(res, &w->id) : NULL;
+    if (!copy)
+      copy = qr_create_tool_err(
+          &w->id, "Internal error while sharing the deduplicated query "
+                  "result; retry the query.");
+    if (copy)
+      copy->columnar = w->columnar;
+
+    ssize_t widx = broker_find_active_by_serial(b->active_sessions, w->serial);
+    if (widx >= 0)
+      broker_finish_deferred(b, (uint32_t)widx, copy);
+    else
+      qr_destroy(copy);
+  }
+  broker_flight_free(f);
+}
+
+/* Releases one fan-out ticket and every per-connection result it still owns.
+ * Safe on NULL. */
+static void broker_fanout_free(struct BrokerFanout *f) {
+  if (!f)
+    return;
+  for (uint32_t i = 0; i < f->n_entries; i++)
+    qr_destroy(f->entries[i].res);
+  mcp_id_clean(&f->id);
+  free(f);
+}
+
+/* Returns the pending fan-out ticket owned by session 'serial', or NULL. */
+static BrokerFanout *broker_fanout_find(Broker *b, uint64_t serial) {
+  for (BrokerFanout *f = b->fanouts; f; f = f->next) {
+    if (f->serial == serial)
+      return f;
+  }
+  return NULL;
+}
+
+/* Returns 1 when 'r' is a successful result whose column names match 'base'
+ * position by position, 0 otherwise. Types may differ across backends (e.g.
+ * int4 vs int8 between server versions); names decide comparability. */
+static int broker_fanout_shape_matches(const QueryResult *base,
+                                       const QueryResult *r) {
+  if (!base || !r || r->ncols != base->ncols)
+    return 0;
+  for (uint32_t c = 0; c < base->ncols; c++) {
+    const QRColumn *bc = qr_get_col(base, c);
+    const QRColumn *rc = qr_get_col(r, c);
+    const char *bn = (bc && bc->name) ? bc->name : "";
+    const char *rn = (rc && rc->name) ? rc->name : "";
+    if (strcmp(bn, rn) != 0)
+      return 0;
+  }
+  return 1;
+}
+
+/* Merges every entry of one settled fan-out ticket into the single reply the
+ * session receives: a leading "connection" column, the data columns of the
+ * first successful entry, and a trailing "error" column. Rows of entries
+ * whose column names match the first successful one are appended verbatim;
+ * every other entry (failed, or differently shaped) contributes one row with
+ * NULL data cells and its message in "error". All cells serialize escaped,
+ * so token strings minted by different connections pass through unchanged.
+ * It borrows 'f' (entry results stay owned by the ticket).
+ * Error semantics: fail-soft; returns a tool error result when the merge
+ * itself cannot be built, NULL only on catastrophic allocation failure.
+ */
+static QueryResult *broker_fanout_merge(const BrokerFanout *f) {
+  const QueryResult *base = NULL;
+  const char *base_conn = NULL;
+  for (uint32_t i = 0; i < f->n_entries; i++) {
+    const QueryResult *r = f->entries[i].res;
+    if (r && r->status == QR_OK) {
+      base = r;
+      base_conn = f->entries[i].conn;
+      break;
+    }
+  }
+
+  uint32_t base_ncols = base ? base->ncols : 0;
+  uint32_t ncols = base_ncols + 2;
+  uint64_t nrows64 = 0;
+  uint64_t exec_ms = 0;
+  uint8_t truncated = 0;
+  int shape_ok[FANOUT_MAX_CONNS] = {0};
+  for (uint32_t i = 0; i < f->n_entries; i++) {
+    const QueryResult *r = f->entries[i].res;
+    if (r && r->status == QR_OK) {
+      if (r->exec_ms > exec_ms)
+        exec_ms = r->exec_ms;
+      if (broker_fanout_shape_matches(base, r)) {
+        shape_ok[i] = 1;
+        nrows64 += r->nrows;
+        // Fan-out replies are not pageable; spilled overflow is dropped, so
+        // surface it as truncation.
+        truncated |= (r->result_truncated || r->spilled_rows > 0) ? 1 : 0;
+        continue;
+      }
+    }
+    nrows64 += 1; // one explanatory row for this connection
+  }
+  if (nrows64 > UINT32_MAX)
+    return qr_create_tool_err(&f->id,
+                              "Internal error while merging fan-out results.");
+
+  QueryResult *m = qr_create_ok(&f->id, ncols, (uint32_t)nrows64, truncated, 0);
+  QueryResultBuilder qb = {0};
+  if (!m || qb_init(&qb, m, NULL) != OK)
+    goto fail;
+  if (qb_set_col(&qb, 0, "connection", "text", 0) != OK)
+    goto fail;
+  for (uint32_t c = 0; c < base_ncols; c++) {
+    const QRColumn *col = qr_get_col(base, c);
+    if (qb_set_col(&qb, c + 1, col ? col->name : NULL,
+                   col ? col->type : NULL, col ? col->pg_oid : 0) != OK)
+      goto fail;
+  }
+  if (qb_set_col(&qb, ncols - 1, "error", "text", 0) != OK)
+    goto fail;
+
+  uint32_t row = 0;
+  for (uint32_t i = 0; i < f->n_entries; i++) {
+    const BrokerFanoutEntry *e = &f->entries[i];
+    const QueryResult *r = e->res;
+    if (shape_ok[i]) {
+      for (uint32_t sr = 0; sr < r->nrows; sr++, row++) {
+        if (qb_set_cell(&qb, row, 0, e->conn, strlen(e->conn)) != YES)
+          goto fail;
+        for (uint32_t c = 0; c < base_ncols; c++) {
+          const char *cell = qr_get_cell(r, sr, c);
+          if (qb_set_cell(&qb, row, c + 1, cell,
+                          cell ? strlen(cell) : 0) != YES)
+            goto fail;
+        }
+        // "error" stays SQL NULL for delivered rows.
+      }
+      continue;
+    }
+
+    char mismatch[CONN_NAME_MAX_LEN + 96];
+    const char *msg;
+    if (r && r->status == QR_OK) {
+      snprintf(mismatch, sizeof(mismatch),
+               "Result columns differ from connectionName '%s'; rerun per "
+               "connection.",
+               base_conn ? base_conn : "?");
+      msg = mismatch;
+    } else {
+      msg = (r && r->err_msg) ? r->err_msg : "Internal error.";
+    }
+    if (qb_set_cell(&qb, row, 0, e->conn, strlen(e->conn)) != YES)
+      goto fail;
+    // Data cells stay SQL NULL (qr_create_ok defaults).
+    if (qb_set_cell(&qb, row, ncols - 1, msg, strlen(msg)) != YES)
+      goto fail;
+    row++;
+  }
+
+  m->exec_ms = exec_ms; // slowest connection: what the caller waited for
+  m->columnar = f->columnar;
+  return m;
+
+fail:
+  qr_destroy(m);
+  return qr_create_tool_err(&f->id,
+                            "Internal error while merging fan-out results.");
+}
+
 /* Borrowed context used by run_sql tool handlers.
  * It bundles request-scoped entities so handlers keep narrow signatures.
  */
@@ -655,6 +2293,73 @@ typedef struct BrokerRunSQLArgs {
   McpId *id;
 } BrokerRunSQLArgs;
 
+/* Rewrites '*query' with an injected LIMIT when the validated plan shows no
+ * LIMIT clause (or a literal one above the profile's row cap), so truncated
+ * queries stop making the database compute and ship rows the broker discards.
+ * The injected cap is max_rows + 1: the backend still sees one surplus row
+ * and flags result_truncated exactly as before.
+ * Ownership: on rewrite the previous '*query' is freed and replaced with a
+ * newly allocated string; otherwise '*query' is left untouched.
+ * Side effects: may allocate; logs the rewrite.
+ * Error semantics: none; invalid input and unlimited policies are no-ops.
+ */
+static void broker_push_down_limit(char **query, const ValidatorPlan *plan,
+                                   const SafetyPolicy *policy) {
+  if (!query || !*query || !plan || !policy)
+    return;
+  uint32_t max_rows = policy->max_rows;
+  if (max_rows == 0 || max_rows >= UINT32_MAX - 1u)
+    return; // unlimited (or too large to add the surplus row)
+
+  uint64_t cap = (uint64_t)max_rows + 1u;
+  if (plan->limit_value >= 0 && (uint64_t)plan->limit_value <= cap)
+    return; // the query's own LIMIT is already within the cap
+
+  // The validator guarantees a single statement, so trailing semicolons and
+  // whitespace are decoration we can drop before appending.
+  size_t len = strlen(*query);
+  while (len > 0) {
+    char c = (*query)[len - 1];
+    if (c == ';' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      len--;
+      continue;
+    }
+    break;
+  }
+  if (len == 0)
+    return;
+
+  char *capped = NULL;
+  if (plan->limit_value < 0) {
+    // No LIMIT clause: appending one is always valid for a single SELECT.
+    size_t cap_len = len + 64u;
+    capped = xmalloc(cap_len);
+    int n = snprintf(capped, cap_len, "%.*s LIMIT %llu", (int)len, *query,
+                     (unsigned long long)cap);
+    if (n < 0 || (size_t)n >= cap_len) {
+      free(capped);
+      return;
+    }
+  } else {
+    // Oversized literal LIMIT: wrap instead of appending a second clause.
+    // The subquery keeps output columns index-aligned with the plan.
+    size_t cap_len = len + 96u;
+    capped = xmalloc(cap_len);
+    int n = snprintf(capped, cap_len,
+                     "SELECT * FROM ( %.*s ) AS adbx_capped LIMIT %llu",
+                     (int)len, *query, (unsigned long long)cap);
+    if (n < 0 || (size_t)n >= cap_len) {
+      free(capped);
+      return;
+    }
+  }
+
+  TLOG("INFO - pushed row cap %u into query as LIMIT %llu", max_rows,
+       (unsigned long long)cap);
+  free(*query);
+  *query = capped;
+}
+
 /* Executes validated run_sql_query arguments and builds a QueryResult.
  * It borrows 'args' and allocates temporary strings and may allocate
  * '*out_query'; caller owns/destroys '*out_query'. Side effects: acquires/uses
@@ -679,11 +2384,14 @@ static void broker_run_sql_query(const BrokerRunSQLArgs *args,
 
   char *conn_name = NULL;
   char *query = NULL;
+  ConnView cv = {0}; // cv.db != NULL <=> we hold a checked-out connection
   if (jsget_string_decode_alloc(jg, "params.arguments.connectionName",
                                 &conn_name) != YES ||
       jsget_string_decode_alloc(jg, "params.arguments.query", &query) != YES) {
     free(conn_name);
+    conn_name = NULL;
     free(query);
+    query = NULL;
     *out_query =
         qr_create_err(id, QRERR_INPARAM,
                       "Invalid run_sql_query arguments: expected string fields "
@@ -691,23 +2399,59 @@ static void broker_run_sql_query(const BrokerRunSQLArgs *args,
     goto free_n_return;
   }
 
+  // Optional per-request output shape: "columnar":true switches the result
+  // from row-major "rows" arrays to one contiguous array per column.
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query arguments: optional "
+                               "field 'columnar' must be a boolean.");
+    goto free_n_return;
+  }
+
+  // Optional per-request priority class; capped against the profile policy
+  // once the checkout below resolves it.
+  SafetyPriority req_prio = SAFETY_PRIO_NORMAL;
+  if (broker_parse_priority(jg, &req_prio) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query arguments: optional "
+                               "field 'priority' must be \"fast\", "
+                               "\"normal\", or \"heavy\".");
+    goto free_n_return;
+  }
+
   TLOG("INFO - preparing for running %s", query);
-  ConnView cv = {0};
-  AdbxTriStatus rc = connm_get_connection(b->cm, conn_name, &cv);
-  if (rc == NO) {
+  uint64_t t_conn = now_us_monotonic();
+  ConnCheckoutStatus rc = connm_checkout(b->cm, conn_name, &cv);
+  uint64_t connect_us = now_us_monotonic() - t_conn;
+  lhist_record(&b->stats.connect, connect_us);
+  sess->req_connect_us =
+      connect_us > UINT32_MAX ? UINT32_MAX : (uint32_t)connect_us;
+  if (rc == CONN_CHECKOUT_UNKNOWN) {
     *out_query = qr_create_err(id, QRERR_RESOURCE,
                                "Unknown connectionName '%s'.", conn_name);
     goto free_n_return;
   }
-  if (rc != YES || !cv.db || !cv.profile) {
+  if (rc == CONN_CHECKOUT_ERR || !cv.profile ||
+      (rc == CONN_CHECKOUT_OK && !cv.db)) {
     TLOG("ERROR - unable to connect to %s", conn_name);
     *out_query = qr_create_tool_err(
         id, "Unable to connect to connectionName '%s'.", conn_name);
     goto free_n_return;
   }
+  // On CONN_CHECKOUT_BUSY cv.db is NULL; validation still proceeds and the
+  // job is parked until a pooled connection frees up.
+
+  // Arm the slow-request log for this request now that the profile is known.
+  sess->req_slow_log_ms = cv.profile->safe_policy.slow_log_ms;
+  snprintf(sess->req_conn, sizeof(sess->req_conn), "%s", conn_name);
+
+  // Profiles without a configured heavy leash run such requests as NORMAL.
+  SafetyPriority prio =
+      safety_policy_clamp_priority(&cv.profile->safe_policy, req_prio);
 
   DbTokenStore *store = NULL;
-  if (broker_get_or_init_store(sess, cv.profile, &store) != OK || !store) {
+  if (broker_get_or_init_store(b, sess, cv.profile, b->shared_col_refs, &store) != OK || !store) {
     TLOG("ERROR - failed to initialize session token store for %s", conn_name);
     *out_query = qr_create_tool_err(
         id, "Internal error while preparing sensitive token storage for '%s'.",
@@ -715,55 +2459,118 @@ static void broker_run_sql_query(const BrokerRunSQLArgs *args,
     goto free_n_return;
   }
 
-  ValidateQueryOut vout = {0};
-  if (vq_out_init(&vout) != OK) {
+  // Session-owned scratch: storage stays with the session across requests,
+  // so no vq_out_clean() on the error paths below.
+  ValidateQueryOut *vout = broker_scratch_vout(sess);
+  if (!vout) {
     *out_query = qr_create_tool_err(
         id, "Internal error while preparing run_sql_query validation.");
     goto free_n_return;
   }
   ValidatorRequest vreq = {
-      .db = cv.db,
+      .db = connm_parser_backend(b->cm, conn_name),
       .profile = cv.profile,
       .sql = query,
       .params = NULL,
       .nparams = 0,
   };
-  if (validate_query(&vreq, &vout) != OK) {
-    const char *err_desc = sb_to_cstr(&vout.err.msg);
-    if (err_desc[0] == '\0') {
-      err_desc = "Unknown error while validating the query. Please make sure "
-                 "the query is valid and formatted correctly.";
+  // A cache hit reuses the retained plan and skips parse + validation.
+  if (plan_cache_get(b->plan_cache, conn_name, query, NULL, 0, vout) != YES) {
+    uint64_t t_val = now_us_monotonic();
+    AdbxStatus vq_rc = validate_query(&vreq, vout);
+    uint64_t validate_us = now_us_monotonic() - t_val;
+    lhist_record(&b->stats.validate, validate_us);
+    sess->req_validate_us =
+        validate_us > UINT32_MAX ? UINT32_MAX : (uint32_t)validate_us;
+    if (vq_rc != OK) {
+      const char *err_desc = sb_to_cstr(&vout->err.msg);
+      if (err_desc[0] == '\0') {
+        err_desc = "Unknown error while validating the query. Please make sure "
+                   "the query is valid and formatted correctly.";
+      }
+      *out_query =
+          qr_create_tool_err(id, "Query validation failed: %s", err_desc);
+      goto free_n_return;
     }
-    *out_query =
-        qr_create_tool_err(id, "Query validation failed: %s", err_desc);
-    vq_out_clean(&vout);
-    goto free_n_return;
+    plan_cache_put(b->plan_cache, conn_name, query, NULL, 0, vout);
   }
 
-  QueryResultBuildPolicy qb_policy = {
-      .plan = &vout.plan,
-      .store = store,
-      .generation = sess->generation,
-  };
+  // Push the row cap into the executed SQL (the plan cache stays keyed on
+  // the original text).
+  broker_push_down_limit(&query, &vout->plan, &cv.profile->safe_policy);
+
+  // Opt-in result cache: profiles with resultCacheTtlSeconds replay the
+  // serialized reply of an identical recent query, skipping execution and
+  // serialization entirely. Keyed on the post-cap SQL so it and single-flight
+  // agree on "identical". Tokenized output stays out: tokens only resolve in
+  // the minting session's store.
+  int tokenized_out = broker_plan_has_token_out(&vout->plan);
+  uint64_t cache_ttl_ms =
+      tokenized_out ? 0
+                    : (uint64_t)cv.profile->safe_policy.result_cache_ttl_secs *
+                          1000u;
+  if (cache_ttl_ms > 0) {
+    const char *hit = NULL;
+    size_t hit_len = 0;
+    if (result_cache_get(b->result_cache, conn_name, query,
+                         (uint8_t)columnar01, &hit, &hit_len) == YES) {
+      TLOG("INFO - replaying run_sql_query from the result cache for %s",
+           conn_name);
+      if (jsonrpc_result_frame(&sess->bc, id, hit, hit_len) == OK)
+        sess->replied_inline = 1;
+      // On write failure *out_query stays NULL with the session not busy,
+      // which drops the client (the channel may hold a partial frame).
+      *out_query = NULL;
+      goto free_n_return;
+    }
+  }
 
-  if (db_exec(cv.db, query, &qb_policy, out_query) != OK) {
-    vq_out_clean(&vout);
-    TLOG("ERROR - error while communicating with %s", conn_name);
-    *out_query = qr_create_tool_err(
-        id, "Database execution failed on connectionName '%s'.", conn_name);
-    goto free_n_return;
+  // Single-flight: when another session already executes these exact bytes
+  // on this connection, attach to that flight instead of re-executing; the
+  // leader's completion fans a clone out to every follower.
+  uint64_t fl_hash = 0;
+  StrBuf *fl_key = &sess->scratch_key; // reused across requests; no sb_clean
+  sb_reset(fl_key);
+  int fl_on = !tokenized_out &&
+              broker_flight_key(fl_key, conn_name, query) == OK;
+  if (fl_on) {
+    fl_hash = ht_hash_bytes(fl_key->data, fl_key->len);
+    BrokerFlight *f = broker_flight_find(b, fl_hash, fl_key->data, fl_key->len);
+    if (f && broker_flight_attach(f, sess, id, (uint8_t)columnar01) == OK) {
+      TLOG("INFO - joined the in-flight identical query on %s", conn_name);
+      *out_query = NULL; // the leader's completion answers this session
+      goto free_n_return;
+    }
   }
-  // db_exec leaves the id zeroed; stamp it with the request id
-  if (qr_set_id(*out_query, id) != OK) {
-    qr_destroy(*out_query);
-    vq_out_clean(&vout);
-    *out_query = NULL;
+
+  // Hand the validated request to a worker (or park it until a pooled
+  // connection frees up); the session response is written when the completion
+  // is popped off the done queue.
+  AdbxStatus qrc =
+      cv.db ? broker_submit_exec_job(b, sess, id, &cv, &query, &conn_name,
+                                     vout, store, NULL, 0, 0,
+                                     (uint8_t)columnar01, (uint8_t)prio,
+                                     cache_ttl_ms)
+            : broker_park_exec_job(b, sess, id, &query, &conn_name, vout,
+                                   store, NULL, 0, 0, (uint8_t)columnar01,
+                                   (uint8_t)prio, cache_ttl_ms);
+  if (qrc != OK) {
+    TLOG("ERROR - failed to queue execution for %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Internal error while scheduling query execution for '%s'.",
+        conn_name);
     goto free_n_return;
   }
-  connm_mark_used(b->cm, conn_name);
-  vq_out_clean(&vout);
+  // The job took ownership of the plan storage; the next borrow re-inits.
+  sess->scratch_vout_live = 0;
+  if (fl_on)
+    (void)broker_flight_create(b, fl_hash, fl_key, sess->serial);
+  cv.db = NULL; // the job's completion path checks the connection back in
+  *out_query = NULL; // deferred: a worker will produce the result
 
 free_n_return:
+  if (cv.db)
+    connm_checkin(b->cm, cv.profile->connection_name, cv.db);
   free(conn_name);
   free(query);
 }
@@ -804,21 +2611,55 @@ static void broker_run_sql_query_tokens(const BrokerRunSQLArgs *args,
     return;
   }
 
-  ConnView cv = {0};
-  AdbxTriStatus rc = connm_get_connection(b->cm, conn_name, &cv);
-  if (rc == NO) {
-    *out_query = qr_create_err(id, QRERR_RESOURCE,
-                               "Unknown connectionName '%s'.", conn_name);
-    goto free_n_return;
+  // Optional per-request output shape, same contract as run_sql_query.
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query_tokens arguments: "
+                               "optional field 'columnar' must be a boolean.");
+    free(conn_name);
+    free(query);
+    return;
   }
-  if (rc != YES || !cv.db || !cv.profile) {
-    *out_query = qr_create_tool_err(
-        id, "Unable to connect to connectionName '%s'.", conn_name);
-    goto free_n_return;
+
+  // Optional per-request priority class, same contract as run_sql_query.
+  SafetyPriority req_prio = SAFETY_PRIO_NORMAL;
+  if (broker_parse_priority(jg, &req_prio) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query_tokens arguments: "
+                               "optional field 'priority' must be \"fast\", "
+                               "\"normal\", or \"heavy\".");
+    free(conn_name);
+    free(query);
+    return;
+  }
+
+  ConnView cv = {0}; // cv.db != NULL <=> we hold a checked-out connection
+  ConnCheckoutStatus rc = connm_checkout(b->cm, conn_name, &cv);
+  if (rc == CONN_CHECKOUT_UNKNOWN) {
+    *out_query = qr_create_err(id, QRERR_RESOURCE,
+                               "Unknown connectionName '%s'.", conn_name);
+    goto free_n_return;
+  }
+  if (rc == CONN_CHECKOUT_ERR || !cv.profile ||
+      (rc == CONN_CHECKOUT_OK && !cv.db)) {
+    *out_query = qr_create_tool_err(
+        id, "Unable to connect to connectionName '%s'.", conn_name);
+    goto free_n_return;
   }
+  // On CONN_CHECKOUT_BUSY cv.db is NULL; validation still proceeds and the
+  // job is parked until a pooled connection frees up.
+
+  // Arm the slow-request log for this request now that the profile is known.
+  sess->req_slow_log_ms = cv.profile->safe_policy.slow_log_ms;
+  snprintf(sess->req_conn, sizeof(sess->req_conn), "%s", conn_name);
+
+  // Profiles without a configured heavy leash run such requests as NORMAL.
+  SafetyPriority prio =
+      safety_policy_clamp_priority(&cv.profile->safe_policy, req_prio);
 
   DbTokenStore *store = NULL;
-  if (broker_get_or_init_store(sess, cv.profile, &store) != OK || !store) {
+  if (broker_get_or_init_store(b, sess, cv.profile, b->shared_col_refs, &store) != OK || !store) {
     *out_query = qr_create_tool_err(
         id, "Internal error while preparing sensitive token storage for '%s'.",
         conn_name);
@@ -846,9 +2687,12 @@ static void broker_run_sql_query_tokens(const BrokerRunSQLArgs *args,
   SensitiveTok vparams[MAX_TOKEN_PARAMS];
   memset(vparams, 0, sizeof(vparams));
   uint32_t nparams = 0;
+  char *toks[MAX_TOKEN_PARAMS] = {0};
+  uint32_t ntoks = 0;
 
-  // loop over all the parameters of the request, validate them and retrieve
-  // the SensitiveTok associated to them
+  // Decode every parameter string first, then resolve the whole batch against
+  // the session store in one pass (format, connection binding, and generation
+  // are validated together by stok_store_resolve_params()).
   JsonStrSpan sp = {0};
   for (;;) {
     AdbxTriStatus nrc = jsget_array_strings_next(jg, &it, &sp);
@@ -859,7 +2703,7 @@ static void broker_run_sql_query_tokens(const BrokerRunSQLArgs *args,
           id, QRERR_INPARAM,
           "Invalid token parameter at index %d: expected a JSON string.",
           it.idx);
-      goto free_n_return;
+      goto free_params;
     }
 
     char *tok = NULL;
@@ -870,94 +2714,106 @@ static void broker_run_sql_query_tokens(const BrokerRunSQLArgs *args,
           "Invalid token parameter at index %d: malformed JSON string value.",
           it.idx - 1);
       free(tok);
-      goto free_n_return;
-    }
-
-    ParsedTokView parsed = {0};
-    if (stok_parse_view_inplace(tok, &parsed) != OK) {
-      *out_query = qr_create_tool_err(id,
-                                      "Invalid token format '%s'. Expected "
-                                      "tok_<connection>_<generation>_<index>.",
-                                      tok);
-      free(tok);
-      goto free_n_return;
-    }
-
-    if (strcmp(parsed.connection_name, conn_name) != 0) {
-      *out_query = qr_create_tool_err(
-          id,
-          "Token connection mismatch: token is bound to '%s' but "
-          "request connectionName is '%s'.",
-          parsed.connection_name, conn_name);
-      free(tok);
-      goto free_n_return;
-    }
-    if (parsed.generation != sess->generation) {
-      *out_query = qr_create_tool_err(
-          id,
-          "Stale token generation: token=%u current=%u. Run a fresh "
-          "sensitive query first.",
-          parsed.generation, sess->generation);
-      free(tok);
-      goto free_n_return;
-    }
-
-    const SensitiveTok *bound = stok_store_get(store, parsed.index);
-    if (!bound) {
-      *out_query = qr_create_tool_err(
-          id, "Unknown token index %u for this session.", parsed.index);
-      free(tok);
-      goto free_n_return;
+      goto free_params;
     }
-
-    if (nparams >= MAX_TOKEN_PARAMS) {
+    if (ntoks >= MAX_TOKEN_PARAMS) {
+      // it.count was range-checked above; guard against iterator drift.
       *out_query = qr_create_tool_err(
           id, "Token parameters exceed maximum supported entries (%u).",
           MAX_TOKEN_PARAMS);
       free(tok);
-      goto free_n_return;
+      goto free_params;
     }
-    vparams[nparams++] = *bound;
+    toks[ntoks++] = tok;
+  }
+
+  uint32_t bad_idx = 0;
+  ParsedTokView bad = {0};
+  StokResolveStatus rrc = stok_store_resolve_params(
+      store, sess->generation, toks, ntoks, vparams, &bad_idx, &bad);
+  switch (rrc) {
+  case STOK_RESOLVE_OK:
+    nparams = ntoks;
+    break;
+  case STOK_RESOLVE_BAD_FORMAT:
+    *out_query = qr_create_tool_err(id,
+                                    "Invalid token format '%s'. Expected a "
+                                    "fixed-width tok_ handle as returned by a "
+                                    "sensitive query.",
+                                    toks[bad_idx]);
+    goto free_params;
+  case STOK_RESOLVE_WRONG_CONN:
+    *out_query = qr_create_tool_err(
+        id,
+        "Token connection mismatch: token is not bound to "
+        "request connectionName '%s'.",
+        conn_name);
+    goto free_params;
+  case STOK_RESOLVE_STALE_GEN:
+    *out_query = qr_create_tool_err(
+        id,
+        "Stale token generation: token=%u current=%u. Run a fresh "
+        "sensitive query first.",
+        bad.generation, sess->generation);
+    goto free_params;
+  case STOK_RESOLVE_UNKNOWN_INDEX:
+    *out_query = qr_create_tool_err(
+        id, "Unknown token index %u for this session.", bad.index);
+    goto free_params;
+  default:
+    *out_query = qr_create_tool_err(
+        id, "Internal error while resolving token parameters.");
+    goto free_params;
+  }
 
-    free(tok);
+  // The resolved SensitiveTok entries borrow store/arena storage, not the
+  // decoded token strings, so those can go now.
+  for (uint32_t i = 0; i < ntoks; i++) {
+    free(toks[i]);
+    toks[i] = NULL;
   }
+  ntoks = 0;
 
-  // Validate the query
-  ValidateQueryOut vout = {0};
-  if (vq_out_init(&vout) != OK) {
+  // Validate the query into the session-owned scratch output (storage stays
+  // with the session; no vq_out_clean() on the error paths below).
+  ValidateQueryOut *vout = broker_scratch_vout(sess);
+  if (!vout) {
     *out_query = qr_create_tool_err(
         id, "Internal error while preparing run_sql_query_tokens validation.");
     goto free_n_return;
   }
   ValidatorRequest vreq = {
-      .db = cv.db,
+      .db = connm_parser_backend(b->cm, conn_name),
       .profile = cv.profile,
       .sql = query,
       .params = vparams,
       .nparams = nparams,
   };
-  if (validate_query(&vreq, &vout) != OK) {
-    const char *err_desc = sb_to_cstr(&vout.err.msg);
-    if (err_desc[0] == '\0') {
-      err_desc = "Unknown error while validating the query. Please make sure "
-                 "the query is valid and formatted correctly.";
+  // A cache hit reuses the retained plan and skips parse + validation. The key
+  // covers the bound parameter scopes, so value-only changes still hit.
+  if (plan_cache_get(b->plan_cache, conn_name, query, vparams, nparams,
+                     vout) != YES) {
+    if (validate_query(&vreq, vout) != OK) {
+      const char *err_desc = sb_to_cstr(&vout->err.msg);
+      if (err_desc[0] == '\0') {
+        err_desc = "Unknown error while validating the query. Please make sure "
+                   "the query is valid and formatted correctly.";
+      }
+      *out_query =
+          qr_create_tool_err(id, "Query validation failed: %s", err_desc);
+      goto free_n_return;
     }
-    *out_query =
-        qr_create_tool_err(id, "Query validation failed: %s", err_desc);
-    vq_out_clean(&vout);
-    goto free_n_return;
+    plan_cache_put(b->plan_cache, conn_name, query, vparams, nparams, vout);
   }
   // From now on we assume that parameters are valid
 
-  // prepare context to allow DbBackend to create a QueryResult
-  QueryResultBuildPolicy qb_policy = {
-      .plan = &vout.plan,
-      .store = store,
-      .generation = sess->generation,
-  };
+  // Push the row cap into the executed SQL (the plan cache stays keyed on
+  // the original text).
+  broker_push_down_limit(&query, &vout->plan, &cv.profile->safe_policy);
 
   // Build the params array that will be used by the DbBackend for query
-  // execution
+  // execution. Values are borrowed from the session token store, which stays
+  // pinned while the session is busy.
   DbExecParam db_params[MAX_TOKEN_PARAMS];
   memset(db_params, 0, sizeof(db_params));
   for (uint32_t i = 0; i < nparams; i++) {
@@ -967,579 +2823,2698 @@ static void broker_run_sql_query_tokens(const BrokerRunSQLArgs *args,
     db_params[i].pg_oid = vparams[i].pg_oid;
   }
 
-  if (db_exec_bound(cv.db, query, db_params, nparams, &qb_policy, out_query) !=
-      OK) {
-    vq_out_clean(&vout);
-    TLOG("ERROR - bound execution failed while communicating with %s",
-         conn_name);
+  AdbxStatus qrc =
+      cv.db ? broker_submit_exec_job(b, sess, id, &cv, &query, &conn_name,
+                                     vout, store, db_params, nparams, 1,
+                                     (uint8_t)columnar01, (uint8_t)prio, 0)
+            : broker_park_exec_job(b, sess, id, &query, &conn_name, vout,
+                                   store, db_params, nparams, 1,
+                                   (uint8_t)columnar01, (uint8_t)prio, 0);
+  if (qrc != OK) {
+    TLOG("ERROR - failed to queue bound execution for %s", conn_name);
     *out_query = qr_create_tool_err(
-        id, "Database execution failed on connectionName '%s'.", conn_name);
-    goto free_n_return;
-  }
-  // db_exec_bound leaves the id zeroed; stamp it with the request id
-  if (qr_set_id(*out_query, id) != OK) {
-    qr_destroy(*out_query);
-    vq_out_clean(&vout);
-    *out_query = NULL;
+        id, "Internal error while scheduling query execution for '%s'.",
+        conn_name);
     goto free_n_return;
   }
-  connm_mark_used(b->cm, conn_name);
-  vq_out_clean(&vout);
-
+  // The job took ownership of the plan storage; the next borrow re-inits.
+  sess->scratch_vout_live = 0;
+  cv.db = NULL; // the job's completion path checks the connection back in
+  *out_query = NULL; // deferred: a worker will produce the result
+  goto free_n_return;
+
+free_params:
+  for (uint32_t i = 0; i < ntoks; i++)
+    free(toks[i]);
 free_n_return:
+  if (cv.db)
+    connm_checkin(b->cm, cv.profile->connection_name, cv.db);
   free(conn_name);
   free(query);
 }
 
-/* Handles one framed broker request and produces one QueryResult.
- * It borrows 'b', 'sess', and request bytes. It may allocate '*out_res'; caller
- * owns/destroys '*out_res' on success.
- * Side effects: parses untrusted JSON, dispatches tool logic, and may touch DB
- * through tool handlers.
- * Returns OK when '*out_res' is populated with either success or tool/error
- * payload; returns ERR only for catastrophic parse/allocation/internal
- * failures.
+/* One cache-missed fan-out entry awaiting validation. 'vreq' borrows the
+ * query text, profile, and parser backend; 'vout' is the borrowed per-entry
+ * output slot the plan lands in. */
+typedef struct BrokerFanoutValidation {
+  uint32_t entry_idx; // index into fan->entries and the phase arrays
+  ValidatorRequest vreq;
+  ValidateQueryOut *vout;
+  AdbxStatus rc;
+  pthread_t tid;
+  uint8_t threaded;
+} BrokerFanoutValidation;
+
+static void *broker_fanout_validate_thread(void *arg) {
+  BrokerFanoutValidation *v = (BrokerFanoutValidation *)arg;
+  v->rc = validate_query(&v->vreq, v->vout);
+  return NULL;
+}
+
+/* Validates every cache-missed fan-out entry, in parallel when there is more
+ * than one. validate_query() is pure given its output storage and the arena
+ * block pool behind it is lock-protected, so items scatter onto short-lived
+ * threads and rejoin here before anything touches the shared plan cache.
+ * Dedicated threads instead of the exec pool on purpose: every worker may be
+ * occupied by long-running statements, and validation must not queue behind
+ * them. The first item runs on the calling thread so a single miss spawns
+ * nothing; a failed pthread_create() degrades that item to inline validation.
+ * Side effects: fills each item's vout and rc.
+ * Error semantics: none here; per-item failures are read from 'rc'. */
+static void broker_fanout_validate_scatter(BrokerFanoutValidation *items,
+                                           uint32_t n) {
+  for (uint32_t i = 1; i < n; i++) {
+    items[i].threaded =
+        pthread_create(&items[i].tid, NULL, broker_fanout_validate_thread,
+                       &items[i]) == 0;
+  }
+  if (n > 0)
+    broker_fanout_validate_thread(&items[0]);
+  for (uint32_t i = 1; i < n; i++) {
+    if (items[i].threaded)
+      pthread_join(items[i].tid, NULL);
+    else
+      broker_fanout_validate_thread(&items[i]);
+  }
+}
+
+/* Handles the 'run_sql_query_fanout' tool call: the same query validated per
+ * connection profile (plan-cache misses validated in parallel, see
+ * broker_fanout_validate_scatter()) and executed across every named
+ * connection in parallel on the worker pool, so N connections cost
+ * max(latency) instead of sum(latency). Connections that cannot run right now (unknown, unreachable,
+ * pool exhausted, validation failure) never block the rest: they settle their
+ * ticket entry with an error immediately and surface it as one row of the
+ * merged reply (see broker_fanout_merge()). Fan-out never parks: waiting on
+ * one exhausted pool would serialize exactly what this tool parallelizes.
+ * It borrows 'args'; '*out_query' is set only when no sub-job was queued.
+ * Side effects: checks out up to FANOUT_MAX_CONNS pooled connections and
+ * marks the session busy while sub-jobs run.
+ * Error semantics: fail-soft; '*out_query' carries a protocol error on
+ * malformed arguments and is left NULL with the session busy otherwise.
  */
-static AdbxStatus broker_handle_request(Broker *b, BrokerMcpSession *sess,
-                                        const char *req, uint32_t req_len,
-                                        QueryResult **out_res) {
-  if (!b || !sess || !req || !out_res)
-    return ERR;
-  TLOG("INFO - handling a request of %u bytes", req_len);
-  *out_res = NULL;
+static void broker_run_sql_query_fanout(const BrokerRunSQLArgs *args,
+                                        QueryResult **out_query) {
+  assert(args != NULL);
+  assert(args->b != NULL);
+  assert(args->sess != NULL);
+  assert(args->jg != NULL);
+  assert(args->id != NULL);
+  assert(out_query != NULL);
 
-  McpId id = {0};
-  JsonGetter jg;
-  JsonTokBuf tok_buf = {0};
-  if (jsget_init(&jg, req, req_len, &tok_buf) != OK) {
-    TLOG("ERROR - invalid request JSON or token overflow (len=%u)", req_len);
-    return ERR;
+  Broker *b = args->b;
+  BrokerMcpSession *sess = args->sess;
+  JsonGetter *jg = args->jg;
+  McpId *id = args->id;
+
+  char *query = NULL;
+  if (jsget_string_decode_alloc(jg, "params.arguments.query", &query) != YES) {
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid run_sql_query_fanout arguments: expected string field "
+        "'query' and string array 'connectionNames'.");
+    return;
   }
-  AdbxTriStatus has_u32 = jsget_u32(&jg, "id", &id.u32);
-  if (has_u32 == YES) {
-    id.kind = MCP_ID_INT;
-  } else {
-    char *id_str = NULL;
-    AdbxTriStatus s_rc = jsget_string_decode_alloc(&jg, "id", &id_str);
-    if (s_rc == YES) {
-      id.kind = MCP_ID_STR;
-      id.str = id_str;
-    } else {
-      mcp_id_clean(&id);
-      return ERR;
-    }
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query_fanout arguments: "
+                               "optional field 'columnar' must be a boolean.");
+    free(query);
+    return;
   }
 
-  AdbxTriStatus vrc = jsget_simple_rpc_validation(&jg);
-  if (vrc != YES) {
-    *out_res = qr_create_err(
-        &id, QRERR_INREQ,
-        "Invalid JSON-RPC request: expected 'jsonrpc':'2.0' with valid "
-        "'id', 'method', and 'params'.");
-    goto return_res;
+  // Optional per-request priority class, same contract as run_sql_query;
+  // capped against each profile's policy as sub-jobs are submitted.
+  SafetyPriority req_prio = SAFETY_PRIO_NORMAL;
+  if (broker_parse_priority(jg, &req_prio) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid run_sql_query_fanout arguments: "
+                               "optional field 'priority' must be \"fast\", "
+                               "\"normal\", or \"heavy\".");
+    free(query);
+    return;
   }
-  // exec command
-  JsonStrSpan method_sp = {0};
-  if (jsget_string_span(&jg, "method", &method_sp) != YES) {
-    *out_res =
-        qr_create_err(&id, QRERR_INREQ, "Missing required field 'method'.");
-    goto return_res;
+
+  JsonArrIter it = {0};
+  if (jsget_array_strings_begin(jg, "params.arguments.connectionNames",
+                                &it) != YES) {
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid run_sql_query_fanout arguments: expected a "
+        "'params.arguments.connectionNames' string array.");
+    free(query);
+    return;
+  }
+  if (it.count <= 0 || (uint32_t)it.count > FANOUT_MAX_CONNS) {
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid connectionNames count %d: expected 1..%u entries.", it.count,
+        FANOUT_MAX_CONNS);
+    free(query);
+    return;
   }
 
-  if (!STREQ(method_sp.ptr, method_sp.len, "tools/call")) {
-    *out_res = qr_create_err(
-        &id, QRERR_INMETHOD,
-        "Unsupported RPC method '%.*s'; only 'tools/call' is supported.",
-        (int)method_sp.len, method_sp.ptr);
-    goto return_res;
+  BrokerFanout *fan = (BrokerFanout *)xcalloc(1, sizeof(*fan));
+  if (broker_copy_mcp_id(&fan->id, id) != OK) {
+    broker_fanout_free(fan);
+    *out_query = qr_create_tool_err(
+        id, "Internal error while preparing the fan-out request.");
+    free(query);
+    return;
   }
+  fan->serial = sess->serial;
+  fan->columnar = (uint8_t)columnar01;
 
-  JsonStrSpan name_sp = {0};
-  if (jsget_string_span(&jg, "params.name", &name_sp) != YES) {
-    *out_res = qr_create_err(&id, QRERR_INPARAM,
-                             "Tool call is missing 'params.name'.");
-    goto return_res;
+  JsonStrSpan sp = {0};
+  for (;;) {
+    AdbxTriStatus nrc = jsget_array_strings_next(jg, &it, &sp);
+    if (nrc == NO)
+      break;
+    char *name = NULL;
+    if (nrc != YES || json_span_decode_alloc(&sp, &name) != YES || !name ||
+        name[0] == '\0' || strlen(name) > CONN_NAME_MAX_LEN) {
+      *out_query = qr_create_err(
+          id, QRERR_INPARAM,
+          "Invalid connectionNames entry at index %d: expected a non-empty "
+          "string of at most %u bytes.",
+          it.idx, CONN_NAME_MAX_LEN);
+      free(name);
+      goto fail_fan;
+    }
+    for (uint32_t i = 0; i < fan->n_entries; i++) {
+      if (strcmp(fan->entries[i].conn, name) == 0) {
+        *out_query = qr_create_err(
+            id, QRERR_INPARAM,
+            "Duplicate connectionName '%s' in connectionNames.", name);
+        free(name);
+        goto fail_fan;
+      }
+    }
+    snprintf(fan->entries[fan->n_entries].conn,
+             sizeof(fan->entries[fan->n_entries].conn), "%s", name);
+    fan->n_entries++;
+    free(name);
   }
 
-  BrokerRunSQLArgs run_args = {
-      .b = b,
-      .sess = sess,
-      .jg = &jg,
-      .id = &id,
-  };
+  // Phase 1: check out connections, prepare token stores, and probe the plan
+  // cache, all on the event loop. Failures settle their entry with a tool
+  // error in place of a worker result; the merge reports them per row. Cache
+  // misses queue up for the parallel validation scatter below.
+  ConnView cvs[FANOUT_MAX_CONNS];
+  DbTokenStore *stores[FANOUT_MAX_CONNS];
+  ValidateQueryOut vouts[FANOUT_MAX_CONNS];
+  uint8_t has_plan[FANOUT_MAX_CONNS]; // 1 => vouts[i] carries a usable plan
+  BrokerFanoutValidation vitems[FANOUT_MAX_CONNS];
+  uint32_t nvitems = 0;
+  memset(cvs, 0, sizeof(cvs));
+  memset(stores, 0, sizeof(stores));
+  memset(vouts, 0, sizeof(vouts));
+  memset(has_plan, 0, sizeof(has_plan));
+  memset(vitems, 0, sizeof(vitems));
+
+  for (uint32_t i = 0; i < fan->n_entries; i++) {
+    BrokerFanoutEntry *e = &fan->entries[i];
+    ConnView *cv = &cvs[i];
+    ConnCheckoutStatus rc = connm_checkout(b->cm, e->conn, cv);
+    if (rc == CONN_CHECKOUT_UNKNOWN) {
+      e->res = qr_create_tool_err(NULL, "Unknown connectionName '%s'.",
+                                  e->conn);
+      continue;
+    }
+    if (rc == CONN_CHECKOUT_ERR || !cv->profile ||
+        (rc == CONN_CHECKOUT_OK && !cv->db)) {
+      e->res = qr_create_tool_err(
+          NULL, "Unable to connect to connectionName '%s'.", e->conn);
+      cv->db = NULL;
+      continue;
+    }
+    if (!cv->db) { // CONN_CHECKOUT_BUSY
+      e->res = qr_create_tool_err(
+          NULL,
+          "Every pooled connection for '%s' is busy; retry once in-flight "
+          "queries finish.",
+          e->conn);
+      continue;
+    }
 
-  // Call the different tools
-  if (STREQ(name_sp.ptr, name_sp.len, "run_sql_query")) {
-    broker_run_sql_query(&run_args, out_res);
-  } else if (STREQ(name_sp.ptr, name_sp.len, "run_sql_query_tokens")) {
-    broker_run_sql_query_tokens(&run_args, out_res);
+    if (broker_get_or_init_store(b, sess, cv->profile, b->shared_col_refs,
+                                 &stores[i]) != OK ||
+        !stores[i]) {
+      connm_checkin(b->cm, e->conn, cv->db);
+      cv->db = NULL;
+      e->res = qr_create_tool_err(
+          NULL,
+          "Internal error while preparing sensitive token storage for '%s'.",
+          e->conn);
+      continue;
+    }
 
-    // Unknown tools
-  } else {
-    *out_res = qr_create_err(&id, QRERR_INMETHOD, "Unknown tool '%.*s'.",
-                             (int)name_sp.len, name_sp.ptr);
+    if (vq_out_init(&vouts[i]) != OK) {
+      connm_checkin(b->cm, e->conn, cv->db);
+      cv->db = NULL;
+      e->res = qr_create_tool_err(
+          NULL, "Internal error while preparing validation for '%s'.",
+          e->conn);
+      continue;
+    }
+    // Validated once per connection profile; the plan cache collapses
+    // repeated fan-outs to one validation per dialect.
+    if (plan_cache_get(b->plan_cache, e->conn, query, NULL, 0, &vouts[i]) ==
+        YES) {
+      has_plan[i] = 1;
+      continue;
+    }
+    BrokerFanoutValidation *v = &vitems[nvitems++];
+    v->entry_idx = i;
+    v->vreq = (ValidatorRequest){
+        .db = connm_parser_backend(b->cm, e->conn),
+        .profile = cv->profile,
+        .sql = query,
+        .params = NULL,
+        .nparams = 0,
+    };
+    v->vout = &vouts[i];
+    v->rc = ERR;
   }
 
-return_res:
-  // catastrophic
-  if (!*out_res) {
-    mcp_id_clean(&id);
-    return ERR;
+  // Phase 2: validate every cache miss at once, so N misses cost the slowest
+  // parse instead of the sum of all of them.
+  broker_fanout_validate_scatter(vitems, nvitems);
+
+  // Back on the event loop: settle failures and publish fresh plans.
+  for (uint32_t vi = 0; vi < nvitems; vi++) {
+    BrokerFanoutValidation *v = &vitems[vi];
+    uint32_t i = v->entry_idx;
+    BrokerFanoutEntry *e = &fan->entries[i];
+    if (v->rc != OK) {
+      const char *err_desc = sb_to_cstr(&vouts[i].err.msg);
+      if (err_desc[0] == '\0')
+        err_desc = "unknown validation error";
+      e->res = qr_create_tool_err(NULL, "Query validation failed: %s",
+                                  err_desc);
+      vq_out_clean(&vouts[i]);
+      connm_checkin(b->cm, e->conn, cvs[i].db);
+      cvs[i].db = NULL;
+      continue;
+    }
+    plan_cache_put(b->plan_cache, e->conn, query, NULL, 0, &vouts[i]);
+    has_plan[i] = 1;
   }
 
-  mcp_id_clean(&id);
-  return OK;
-}
+  // Phase 3: submit one exec sub-job per entry that ended up with a plan,
+  // preserving request order for the merged reply.
+  for (uint32_t i = 0; i < fan->n_entries; i++) {
+    if (!has_plan[i])
+      continue;
+    BrokerFanoutEntry *e = &fan->entries[i];
+
+    char *sql = xmalloc(strlen(query) + 1);
+    memcpy(sql, query, strlen(query) + 1);
+    broker_push_down_limit(&sql, &vouts[i].plan, &cvs[i].profile->safe_policy);
+    char *cname = xmalloc(strlen(e->conn) + 1);
+    memcpy(cname, e->conn, strlen(e->conn) + 1);
+
+    SafetyPriority prio = safety_policy_clamp_priority(
+        &cvs[i].profile->safe_policy, req_prio);
+    if (broker_submit_exec_job(b, sess, id, &cvs[i], &sql, &cname, &vouts[i],
+                               stores[i], NULL, 0, 0, (uint8_t)columnar01,
+                               (uint8_t)prio, 0) != OK) {
+      vq_out_clean(&vouts[i]);
+      free(sql);
+      free(cname);
+      connm_checkin(b->cm, e->conn, cvs[i].db);
+      e->res = qr_create_tool_err(
+          NULL, "Internal error while scheduling query execution for '%s'.",
+          e->conn);
+      continue;
+    }
+    fan->n_pending++;
+  }
+  free(query);
 
-/*------------------------------ Session Handling ---------------------------*/
+  if (fan->n_pending == 0) {
+    // Nothing reached a worker; answer inline with every per-connection
+    // error merged (the session was never marked busy).
+    *out_query = broker_fanout_merge(fan);
+    broker_fanout_free(fan);
+    return;
+  }
 
-/* Verifies that the connected Unix-socket peer has the current process UID.
- * It borrows 'cfd' and does not allocate memory.
- * Side effects: reads peer credential metadata via getsockopt/getpeereid.
- * Returns OK on UID match, ERR on mismatch or syscall failure.
- */
-static AdbxStatus verify_peer_uid(int cfd) {
-  uid_t expected_uid = getuid();
-#ifdef __linux__
-  struct ucred cred;
-  socklen_t len = sizeof(cred);
-  if (getsockopt(cfd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
-    return ERR;
-  return (cred.uid == expected_uid) ? OK : ERR;
-#else /* macOS / BSDs */
-  uid_t euid;
-  gid_t egid;
-  if (getpeereid(cfd, &euid, &egid) < 0)
-    return ERR;
-  return (euid == expected_uid) ? OK : ERR;
-#endif
+  // Several statements run at once; a cancellation notification cannot aim
+  // at all of them, so none is targeted.
+  sess->inflight_db = NULL;
+  fan->next = b->fanouts;
+  b->fanouts = fan;
+  *out_query = NULL; // the last sub-job completion delivers the merged reply
+  return;
+
+fail_fan:
+  broker_fanout_free(fan);
+  free(query);
 }
 
-/* Initializes token-state containers for one broker session.
- * It borrows and mutates 'sess'; ownership of created members stays in the
- * session and is later released by session cleanup callbacks.
- * Side effects: allocate/init the per-session Arena and db_stores array.
- * Error semantics: returns OK when state is ready, ERR on invalid input,
- * inconsistent partial state, or allocation failure.
+/* Serves one page of the session's spilled overflow rows.
+ * The page is read back from the session-owned spill file synchronously on
+ * the broker thread; the database is never touched again.
+ * It borrows 'args' and allocates '*out_query'; caller owns the result.
+ * Side effects: reads the spill file.
+ * Error semantics: fail-soft; '*out_query' carries a protocol or tool error
+ * on invalid arguments, a missing spill, or an out-of-range offset.
  */
-static AdbxStatus broker_session_token_state_init(BrokerMcpSession *sess) {
-  if (!sess)
-    return ERR;
-
-  // session should be empty/zeroed during initialization
-  assert(arena_is_zeroed(&sess->arena) == YES);
-  assert(!sess->db_stores);
-
-  uint32_t cap = SESSION_TOKEN_ARENA_CAP_BYTES;
-  if (arena_init(&sess->arena, NULL, &cap) != OK)
-    return ERR;
+static void broker_fetch_result_page(BrokerRunSQLArgs *args,
+                                     QueryResult **out_query) {
+  BrokerMcpSession *sess = args->sess;
+  const JsonGetter *jg = args->jg;
+  McpId *id = args->id;
 
-  sess->db_stores = parr_create(sizeof(DbTokenStore *));
-  if (!sess->db_stores) {
-    arena_clean(&sess->arena);
-    return ERR;
+  uint32_t offset = 0;
+  if (jsget_u32(jg, "params.arguments.offset", &offset) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid fetch_result_page arguments: optional "
+                               "field 'offset' must be a uint32.");
+    return;
+  }
+  uint32_t max_rows = 0;
+  if (jsget_u32(jg, "params.arguments.maxRows", &max_rows) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid fetch_result_page arguments: optional "
+                               "field 'maxRows' must be a uint32.");
+    return;
+  }
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid fetch_result_page arguments: optional "
+                               "field 'columnar' must be a boolean.");
+    return;
   }
-  parr_set_cleanup(sess->db_stores, broker_db_store_cleanup, NULL);
 
-  return OK;
+  if (!sess->spill) {
+    *out_query = qr_create_tool_err(
+        id, "No spilled result is available for this session. Only queries "
+            "that overflow the payload cap leave rows to page.");
+    return;
+  }
+
+  uint64_t total = rspill_nrows(sess->spill);
+  if ((uint64_t)offset >= total) {
+    *out_query = qr_create_tool_err(
+        id, "Spilled row offset %u is out of range: %llu rows are available.",
+        offset, (unsigned long long)total);
+    return;
+  }
+
+  QueryResult *page = rspill_fetch_page(sess->spill, id, offset, max_rows);
+  if (!page) {
+    *out_query = qr_create_tool_err(
+        id, "Internal error while reading the spilled result page.");
+    return;
+  }
+  page->columnar = (uint8_t)columnar01;
+  *out_query = page;
+}
+
+/* Handles the 'open_sql_cursor' tool call: validates the query like
+ * run_sql_query, then declares a server-side cursor over it on a dedicated
+ * pooled connection. The reply (produced by the worker) carries one opaque
+ * 'cursorHandle' that fetch_cursor_page/close_cursor must echo back, so
+ * fetching page N+1 costs one FETCH round-trip instead of a re-plan and
+ * re-scan. The row-cap LIMIT push-down is skipped: the cursor pages instead.
+ * It borrows 'args'; ownership and error semantics match
+ * broker_run_sql_query.
+ */
+static void broker_open_sql_cursor(const BrokerRunSQLArgs *args,
+                                   QueryResult **out_query) {
+  assert(args != NULL);
+  assert(args->b != NULL);
+  assert(args->sess != NULL);
+  assert(args->jg != NULL);
+  assert(args->id != NULL);
+  assert(out_query != NULL);
+
+  Broker *b = args->b;
+  BrokerMcpSession *sess = args->sess;
+  JsonGetter *jg = args->jg;
+  McpId *id = args->id;
+
+  char *conn_name = NULL;
+  char *query = NULL;
+  ConnView cv = {0}; // cv.db != NULL <=> we hold a checked-out connection
+  if (jsget_string_decode_alloc(jg, "params.arguments.connectionName",
+                                &conn_name) != YES ||
+      jsget_string_decode_alloc(jg, "params.arguments.query", &query) != YES) {
+    free(conn_name);
+    conn_name = NULL;
+    free(query);
+    query = NULL;
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid open_sql_cursor arguments: expected string fields "
+        "'connectionName' and 'query'.");
+    goto free_n_return;
+  }
+
+  TLOG("INFO - preparing a server-side cursor for %s", query);
+  ConnCheckoutStatus rc = connm_checkout(b->cm, conn_name, &cv);
+  if (rc == CONN_CHECKOUT_UNKNOWN) {
+    *out_query = qr_create_err(id, QRERR_RESOURCE,
+                               "Unknown connectionName '%s'.", conn_name);
+    goto free_n_return;
+  }
+  if (rc == CONN_CHECKOUT_ERR || !cv.profile ||
+      (rc == CONN_CHECKOUT_OK && !cv.db)) {
+    TLOG("ERROR - unable to connect to %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Unable to connect to connectionName '%s'.", conn_name);
+    goto free_n_return;
+  }
+  if (!cv.db) {
+    // Unlike run_sql_query this does not park: a cursor pins its connection
+    // for an open-ended time, so queueing behind a full pool would only
+    // trade one starvation for another. The caller retries.
+    *out_query = qr_create_tool_err(
+        id,
+        "Every pooled connection for '%s' is busy; open_sql_cursor needs a "
+        "dedicated connection. Retry once in-flight queries finish.",
+        conn_name);
+    goto free_n_return;
+  }
+
+  DbTokenStore *store = NULL;
+  if (broker_get_or_init_store(b, sess, cv.profile, b->shared_col_refs, &store) !=
+          OK ||
+      !store) {
+    TLOG("ERROR - failed to initialize session token store for %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Internal error while preparing sensitive token storage for '%s'.",
+        conn_name);
+    goto free_n_return;
+  }
+
+  // Session-owned scratch: storage stays with the session across requests,
+  // so no vq_out_clean() on the error paths below.
+  ValidateQueryOut *vout = broker_scratch_vout(sess);
+  if (!vout) {
+    *out_query = qr_create_tool_err(
+        id, "Internal error while preparing open_sql_cursor validation.");
+    goto free_n_return;
+  }
+  ValidatorRequest vreq = {
+      .db = connm_parser_backend(b->cm, conn_name),
+      .profile = cv.profile,
+      .sql = query,
+      .params = NULL,
+      .nparams = 0,
+  };
+  // A cache hit reuses the retained plan and skips parse + validation.
+  if (plan_cache_get(b->plan_cache, conn_name, query, NULL, 0, vout) != YES) {
+    if (validate_query(&vreq, vout) != OK) {
+      const char *err_desc = sb_to_cstr(&vout->err.msg);
+      if (err_desc[0] == '\0') {
+        err_desc = "Unknown error while validating the query. Please make sure "
+                   "the query is valid and formatted correctly.";
+      }
+      *out_query =
+          qr_create_tool_err(id, "Query validation failed: %s", err_desc);
+      goto free_n_return;
+    }
+    plan_cache_put(b->plan_cache, conn_name, query, NULL, 0, vout);
+  }
+
+  // A session holds at most one cursor; replacing it releases the old pinned
+  // connection (waiters are dispatched at the end of the iteration).
+  broker_session_cursor_close(b, sess);
+
+  char cursor_name[EXEC_CURSOR_NAME_BUFSZ];
+  snprintf(cursor_name, sizeof(cursor_name), "adbx_cur_%llu",
+           (unsigned long long)sess->serial);
+  char handle_hex[EXEC_CURSOR_HANDLE_HEX_LEN + 1];
+  if (fill_random_hex(handle_hex, EXEC_CURSOR_HANDLE_HEX_LEN) != OK) {
+    *out_query = qr_create_tool_err(
+        id, "Internal error while minting the cursor handle.");
+    goto free_n_return;
+  }
+  handle_hex[EXEC_CURSOR_HANDLE_HEX_LEN] = '\0';
+
+  if (broker_submit_cursor_open_job(b, sess, id, &cv, &query, &conn_name,
+                                    vout, store, cursor_name, handle_hex,
+                                    cv.profile->safe_policy.max_rows) != OK) {
+    TLOG("ERROR - failed to queue cursor open for %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Internal error while scheduling the cursor open for '%s'.",
+        conn_name);
+    goto free_n_return;
+  }
+  // The job took ownership of the plan storage; the next borrow re-inits.
+  sess->scratch_vout_live = 0;
+  cv.db = NULL;      // the completion path settles the connection's fate
+  *out_query = NULL; // deferred: a worker will produce the result
+
+free_n_return:
+  if (cv.db)
+    connm_checkin(b->cm, cv.profile->connection_name, cv.db);
+  free(conn_name);
+  free(query);
+}
+
+/* Returns the session cursor matching the request's 'cursorHandle' argument,
+ * or NULL after writing a protocol/tool error to '*out_query'. The handle is
+ * compared in constant time like resume tokens are.
+ */
+static SessionCursor *broker_cursor_from_handle(BrokerMcpSession *sess,
+                                                JsonGetter *jg, McpId *id,
+                                                const char *tool,
+                                                QueryResult **out_query) {
+  char *handle = NULL;
+  if (jsget_string_decode_alloc(jg, "params.arguments.cursorHandle",
+                                &handle) != YES) {
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid %s arguments: expected string field 'cursorHandle'.", tool);
+    free(handle);
+    return NULL;
+  }
+
+  SessionCursor *cur = sess->cursor;
+  int match = cur && strlen(handle) == EXEC_CURSOR_HANDLE_HEX_LEN &&
+              bytes_equal_ct((const uint8_t *)handle,
+                             (const uint8_t *)cur->handle_hex,
+                             EXEC_CURSOR_HANDLE_HEX_LEN) == YES;
+  free(handle);
+  if (!match) {
+    *out_query = qr_create_tool_err(
+        id, cur ? "Unknown cursor handle."
+                : "No cursor is open for this session. Open one with "
+                  "open_sql_cursor first.");
+    return NULL;
+  }
+  return cur;
+}
+
+/* Handles the 'fetch_cursor_page' tool call: pulls the next page from the
+ * session's open cursor on a worker thread. A page whose reply carries
+ * 'resultTruncated':1 means more rows remain; otherwise the cursor drained
+ * (or failed) and was closed.
+ * It borrows 'args'; '*out_query' stays NULL when the fetch was queued.
+ */
+static void broker_fetch_cursor_page(const BrokerRunSQLArgs *args,
+                                     QueryResult **out_query) {
+  Broker *b = args->b;
+  BrokerMcpSession *sess = args->sess;
+  JsonGetter *jg = args->jg;
+  McpId *id = args->id;
+
+  uint32_t max_rows = 0;
+  if (jsget_u32(jg, "params.arguments.maxRows", &max_rows) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid fetch_cursor_page arguments: optional "
+                               "field 'maxRows' must be a uint32.");
+    return;
+  }
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid fetch_cursor_page arguments: optional "
+                               "field 'columnar' must be a boolean.");
+    return;
+  }
+
+  SessionCursor *cur =
+      broker_cursor_from_handle(sess, jg, id, "fetch_cursor_page", out_query);
+  if (!cur)
+    return;
+
+  // Clamp to the policy cap captured at open so the backend never truncates
+  // a page (truncation would read as end-of-cursor).
+  if (max_rows == 0)
+    max_rows = cur->max_page_rows ? cur->max_page_rows
+                                  : CURSOR_FETCH_DEFAULT_ROWS;
+  else if (cur->max_page_rows > 0 && max_rows > cur->max_page_rows)
+    max_rows = cur->max_page_rows;
+
+  ExecPoolJob *job = exec_pool_job_create();
+  if (!job || broker_copy_mcp_id(&job->id, id) != OK)
+    goto fail;
+
+  job->session_serial = sess->serial;
+  job->db = cur->db; // borrowed from the cursor; never checked in by the job
+  size_t cn_len = strlen(cur->conn_name);
+  job->conn_name = xmalloc(cn_len + 1);
+  memcpy(job->conn_name, cur->conn_name, cn_len + 1);
+  job->cursor_op = EXEC_CURSOR_FETCH;
+  snprintf(job->cursor_name, sizeof(job->cursor_name), "%s", cur->name);
+  job->cursor_nrows = max_rows;
+  job->plan_override = &cur->vout.plan;
+  job->store = cur->store;
+  job->generation = sess->generation;
+  job->columnar = (uint8_t)columnar01;
+
+  if (exec_pool_submit(b->exec_pool, job) != OK)
+    goto fail;
+
+  sess->busy = 1;
+  mcp_id_clean(&sess->inflight_id);
+  (void)broker_copy_mcp_id(&sess->inflight_id, id);
+  sess->inflight_db = cur->db;
+  *out_query = NULL; // deferred: a worker will produce the page
+  return;
+
+fail:
+  exec_pool_job_destroy(job);
+  *out_query = qr_create_tool_err(
+      id, "Internal error while scheduling the cursor fetch.");
+}
+
+/* Handles the 'close_cursor' tool call: releases the cursor and its pinned
+ * connection synchronously on the broker thread (one ROLLBACK round-trip).
+ */
+static void broker_close_cursor(const BrokerRunSQLArgs *args,
+                                QueryResult **out_query) {
+  SessionCursor *cur = broker_cursor_from_handle(
+      args->sess, args->jg, args->id, "close_cursor", out_query);
+  if (!cur)
+    return;
+
+  broker_session_cursor_close(args->b, args->sess);
+  *out_query = qr_create_msg(args->id, "Cursor closed.");
+}
+
+/* Serializes one retained schema snapshot into a QueryResult mirroring the
+ * catalog query's shape (table_schema, table_name, column_name, data_type).
+ * It borrows 'snap'; the caller owns the returned result.
+ * Returns NULL on allocation/build failure. */
+static QueryResult *broker_snapshot_to_qr(const McpId *id,
+                                          const SchemaSnapshot *snap) {
+  QueryResult *res =
+      qr_create_ok(id, SCHEMA_SNAPSHOT_NCOLS, snap->nrows, 0, 0);
+  QueryResultBuilder qb = {0};
+  if (!res || qb_init(&qb, res, NULL) != OK ||
+      qb_set_col(&qb, 0, "table_schema", "text", 0) != OK ||
+      qb_set_col(&qb, 1, "table_name", "text", 0) != OK ||
+      qb_set_col(&qb, 2, "column_name", "text", 0) != OK ||
+      qb_set_col(&qb, 3, "data_type", "text", 0) != OK)
+    goto fail;
+
+  for (uint32_t r = 0; r < snap->nrows; r++) {
+    QRCellSpan cells[SCHEMA_SNAPSHOT_NCOLS] = {
+        {snap->schemas[r], strlen(snap->schemas[r])},
+        {snap->tables[r], strlen(snap->tables[r])},
+        {snap->columns[r], strlen(snap->columns[r])},
+        {snap->types[r], strlen(snap->types[r])},
+    };
+    if (qb_set_row(&qb, r, cells, SCHEMA_SNAPSHOT_NCOLS) != YES)
+      goto fail;
+  }
+  return res;
+
+fail:
+  qr_destroy(res);
+  return NULL;
+}
+
+/* Packages one catalog-snapshot fetch (SCHEMA_CATALOG_SQL on the checked-out
+ * connection) and queues it. 'sess' may be NULL for a background refresh:
+ * the sentinel serial 0 matches no session, so the completion only feeds the
+ * schema cache and is otherwise discarded.
+ * Ownership: on OK the job owns the checked-out connection's fate (its
+ * completion checks it back in); on ERR the caller still holds it.
+ * Side effects: marks 'sess' busy when present.
+ * Returns OK when the job is queued, ERR otherwise.
+ */
+static AdbxStatus broker_submit_describe_job(Broker *b,
+                                             BrokerMcpSession *sess,
+                                             const McpId *id,
+                                             const ConnView *cv,
+                                             const char *conn_name,
+                                             uint8_t columnar) {
+  if (!b || !b->exec_pool || !cv || !cv->db || !conn_name)
+    return ERR;
+
+  ExecPoolJob *job = exec_pool_job_create();
+  if (!job)
+    return ERR;
+  if (id && broker_copy_mcp_id(&job->id, id) != OK) {
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  size_t sql_len = strlen(SCHEMA_CATALOG_SQL);
+  job->sql = xmalloc(sql_len + 1);
+  memcpy(job->sql, SCHEMA_CATALOG_SQL, sql_len + 1);
+  size_t cn_len = strlen(conn_name);
+  job->conn_name = xmalloc(cn_len + 1);
+  memcpy(job->conn_name, conn_name, cn_len + 1);
+
+  job->session_serial = sess ? sess->serial : 0;
+  job->db = cv->db;
+  job->describe = 1;
+  job->plan_override = &b->describe_plan; // all plaintext; no token store
+  job->columnar = columnar;
+  job->arena_size_hint = connm_result_arena_hint(b->cm, job->conn_name);
+
+  if (exec_pool_submit(b->exec_pool, job) != OK) {
+    exec_pool_job_destroy(job);
+    return ERR;
+  }
+
+  if (sess) {
+    sess->busy = 1;
+    mcp_id_clean(&sess->inflight_id);
+    (void)broker_copy_mcp_id(&sess->inflight_id, id);
+    sess->inflight_db = cv->db;
+  }
+  return OK;
+}
+
+/* Launches one background snapshot re-fetch for 'conn_name' after a stale
+ * describe hit, so agents keep getting instant answers while the snapshot
+ * catches up with catalog changes.
+ * Error semantics: fail-soft and returns void; a busy pool or submit failure
+ * leaves the stale snapshot serving and the holdoff window lets a later
+ * describe retry.
+ */
+static void broker_refresh_schema_snapshot(Broker *b, const char *conn_name) {
+  if (schema_cache_mark_refresh(b->schema_cache, conn_name) != YES)
+    return;
+
+  ConnView cv = {0};
+  ConnCheckoutStatus rc = connm_checkout(b->cm, conn_name, &cv);
+  if (rc != CONN_CHECKOUT_OK || !cv.db) {
+    if (cv.db)
+      connm_checkin(b->cm, conn_name, cv.db);
+    return;
+  }
+
+  TLOG("INFO - refreshing the schema snapshot for %s", conn_name);
+  if (broker_submit_describe_job(b, NULL, NULL, &cv, conn_name, 0) != OK)
+    connm_checkin(b->cm, conn_name, cv.db);
+}
+
+/* Handles the 'describe' tool call: answers with the connection's schema as
+ * (table_schema, table_name, column_name, data_type) rows. Warm calls are
+ * served from the broker's snapshot in microseconds; a cold or forced call
+ * fetches the batched catalog query on a worker and retains the result.
+ * It borrows 'args'; '*out_query' stays NULL when the fetch was queued.
+ */
+static void broker_describe(const BrokerRunSQLArgs *args,
+                            QueryResult **out_query) {
+  Broker *b = args->b;
+  BrokerMcpSession *sess = args->sess;
+  JsonGetter *jg = args->jg;
+  McpId *id = args->id;
+
+  char *conn_name = NULL;
+  ConnView cv = {0}; // cv.db != NULL <=> we hold a checked-out connection
+  if (jsget_string_decode_alloc(jg, "params.arguments.connectionName",
+                                &conn_name) != YES) {
+    free(conn_name);
+    conn_name = NULL;
+    *out_query = qr_create_err(
+        id, QRERR_INPARAM,
+        "Invalid describe arguments: expected string field 'connectionName'.");
+    goto free_n_return;
+  }
+  // "refresh":true bypasses the snapshot and forces a catalog re-fetch.
+  int refresh01 = 0;
+  if (jsget_bool01(jg, "params.arguments.refresh", &refresh01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid describe arguments: optional field "
+                               "'refresh' must be a boolean.");
+    goto free_n_return;
+  }
+  int columnar01 = 0;
+  if (jsget_bool01(jg, "params.arguments.columnar", &columnar01) == ERR) {
+    *out_query = qr_create_err(id, QRERR_INPARAM,
+                               "Invalid describe arguments: optional field "
+                               "'columnar' must be a boolean.");
+    goto free_n_return;
+  }
+
+  // Fast path: serve the retained snapshot from memory. A stale hit still
+  // answers instantly and kicks one background re-fetch (stale-while-
+  // revalidate), so catalog latency never lands on an agent's turn.
+  const SchemaSnapshot *snap = NULL;
+  int stale01 = 0;
+  if (!refresh01 &&
+      schema_cache_get(b->schema_cache, conn_name, &snap, &stale01) == YES) {
+    QueryResult *res = broker_snapshot_to_qr(id, snap);
+    if (res) {
+      res->columnar = (uint8_t)columnar01;
+      *out_query = res;
+      if (stale01)
+        broker_refresh_schema_snapshot(b, conn_name);
+      goto free_n_return;
+    }
+    // Serialization failed; fall through and fetch from the catalog.
+  }
+
+  ConnCheckoutStatus rc = connm_checkout(b->cm, conn_name, &cv);
+  if (rc == CONN_CHECKOUT_UNKNOWN) {
+    *out_query = qr_create_err(id, QRERR_RESOURCE,
+                               "Unknown connectionName '%s'.", conn_name);
+    goto free_n_return;
+  }
+  if (rc == CONN_CHECKOUT_ERR || !cv.profile ||
+      (rc == CONN_CHECKOUT_OK && !cv.db)) {
+    TLOG("ERROR - unable to connect to %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Unable to connect to connectionName '%s'.", conn_name);
+    goto free_n_return;
+  }
+  if (!cv.db) {
+    // Like open_sql_cursor, a cold describe does not park behind a full
+    // pool; warm calls never get here and the caller simply retries.
+    *out_query = qr_create_tool_err(
+        id,
+        "Every pooled connection for '%s' is busy; retry once in-flight "
+        "queries finish.",
+        conn_name);
+    goto free_n_return;
+  }
+
+  if (broker_submit_describe_job(b, sess, id, &cv, conn_name,
+                                 (uint8_t)columnar01) != OK) {
+    TLOG("ERROR - failed to queue the catalog fetch for %s", conn_name);
+    *out_query = qr_create_tool_err(
+        id, "Internal error while scheduling the schema fetch for '%s'.",
+        conn_name);
+    goto free_n_return;
+  }
+  cv.db = NULL;      // the job's completion path checks the connection back in
+  *out_query = NULL; // deferred: a worker will produce the snapshot
+
+free_n_return:
+  if (cv.db)
+    connm_checkin(b->cm, cv.profile->connection_name, cv.db);
+  free(conn_name);
+}
+
+/* Appends one "name: count/mean/p50/p90/p99/max" line for a stage histogram.
+ * It borrows both inputs and grows 'sb'.
+ * Returns OK on success, ERR on format/append failure. */
+static AdbxStatus broker_stats_append_stage(StrBuf *sb, const char *name,
+                                            const LatencyHist *h) {
+  uint64_t cnt = lhist_count(h);
+  char line[192];
+  int n = snprintf(line, sizeof(line),
+                   "%s: count=%llu mean_us=%llu p50_us=%llu p90_us=%llu "
+                   "p99_us=%llu max_us=%llu\n",
+                   name, (unsigned long long)cnt,
+                   (unsigned long long)(cnt ? h->sum / cnt : 0),
+                   (unsigned long long)lhist_value_at_percentile(h, 50),
+                   (unsigned long long)lhist_value_at_percentile(h, 90),
+                   (unsigned long long)lhist_value_at_percentile(h, 99),
+                   (unsigned long long)lhist_max(h));
+  if (n < 0 || (size_t)n >= sizeof(line))
+    return ERR;
+  return sb_append_bytes(sb, line, (size_t)n);
+}
+
+/* Handles the 'stats' tool call: reports the broker's per-stage latency
+ * histograms (count, mean, p50/p90/p99, max; all in microseconds) as one
+ * text message, so stage-level tail latency is observable in production
+ * without attaching a profiler.
+ * It borrows 'args' and reads histograms only from the broker thread.
+ * Error semantics: fail-soft helper; writes '*out_query' with a tool error on
+ * formatting failures.
+ */
+static void broker_stats(const BrokerRunSQLArgs *args,
+                         QueryResult **out_query) {
+  assert(args != NULL);
+  assert(args->b != NULL);
+  assert(args->id != NULL);
+  assert(out_query != NULL);
+
+  const BrokerStageStats *st = &args->b->stats;
+  StrBuf sb;
+  sb_init(&sb);
+  if (broker_stats_append_stage(&sb, "handle", &st->handle) != OK ||
+      broker_stats_append_stage(&sb, "connect", &st->connect) != OK ||
+      broker_stats_append_stage(&sb, "validate", &st->validate) != OK ||
+      broker_stats_append_stage(&sb, "execute", &st->execute) != OK ||
+      broker_stats_append_stage(&sb, "serialize", &st->serialize) != OK) {
+    sb_clean(&sb);
+    *out_query =
+        qr_create_tool_err(args->id, "Internal error while formatting stats.");
+    return;
+  }
+
+#ifdef ADBX_PERF_COUNTERS
+  // Broker-wide counters ride along with the histograms; builds with
+  // ADBX_PERF_COUNTERS=0 simply omit this section.
+  for (uint32_t c = 0; c < (uint32_t)PERF_COUNTER_N; c++) {
+    char line[96];
+    int n = snprintf(line, sizeof(line), "counter %s=%llu\n",
+                     perf_counter_name((PerfCounterId)c),
+                     (unsigned long long)perf_total((PerfCounterId)c));
+    if (n < 0 || (size_t)n >= sizeof(line) ||
+        sb_append_bytes(&sb, line, (size_t)n) != OK) {
+      sb_clean(&sb);
+      *out_query = qr_create_tool_err(args->id,
+                                      "Internal error while formatting stats.");
+      return;
+    }
+  }
+#endif
+
+  *out_query = qr_create_msg(args->id, sb_to_cstr(&sb));
+  sb_clean(&sb);
+}
+
+/* Handles one framed broker request and produces one QueryResult.
+ * It borrows 'b', 'sess', and request bytes. It may allocate '*out_res'; caller
+ * owns/destroys '*out_res' on success.
+ * Side effects: parses untrusted JSON, dispatches tool logic, and may touch DB
+ * through tool handlers.
+ * Returns OK when '*out_res' is populated with either success or tool/error
+ * payload, or when '*out_res' is NULL because the request was queued on the
+ * worker pool (the session is marked busy); returns ERR only for catastrophic
+ * parse/allocation/internal failures.
+ */
+static AdbxStatus broker_handle_request(Broker *b, BrokerMcpSession *sess,
+                                        const char *req, uint32_t req_len,
+                                        QueryResult **out_res) {
+  if (!b || !sess || !req || !out_res)
+    return ERR;
+  TLOG("INFO - handling a request of %u bytes", req_len);
+  *out_res = NULL;
+  // Dispatch latency for the 'stats' tool; catastrophic early returns (the
+  // client gets dropped) stay unrecorded.
+  uint64_t t_handle = now_us_monotonic();
+
+  // Fresh slow-log window; tool handlers that resolve a profile fill in the
+  // threshold and stage timings.
+  sess->req_start_us = t_handle;
+  sess->req_connect_us = 0;
+  sess->req_validate_us = 0;
+  sess->req_slow_log_ms = 0;
+  sess->req_conn[0] = '\0';
+
+  // Safe here: the session has no in-flight job while a new request is
+  // being parsed, so no worker borrows its stores or arena.
+  broker_session_maybe_compact_tokens(b, sess);
+
+  // Host payloads are untrusted bytes; one vectorized scan rejects malformed
+  // UTF-8 before the tokenizer walks the buffer. Result cells coming back
+  // from the database are trusted and never re-validated.
+  if (json_utf8_validate(req, req_len) != OK) {
+    TLOG("ERROR - request payload is not valid UTF-8 (len=%u)", req_len);
+    return ERR;
+  }
+
+  McpId id = {0};
+  JsonGetter jg;
+  if (jsget_init_ws(&jg, req, req_len, &b->req_tok_ws) != OK) {
+    TLOG("ERROR - invalid request JSON or token overflow (len=%u)", req_len);
+    return ERR;
+  }
+  AdbxTriStatus has_u32 = jsget_u32(&jg, "id", &id.u32);
+  if (has_u32 == YES) {
+    id.kind = MCP_ID_INT;
+  } else {
+    char *id_str = NULL;
+    AdbxTriStatus s_rc = jsget_string_decode_alloc(&jg, "id", &id_str);
+    if (s_rc == YES) {
+      id.kind = MCP_ID_STR;
+      id.str = id_str;
+    } else {
+      mcp_id_clean(&id);
+      return ERR;
+    }
+  }
+
+  AdbxTriStatus vrc = jsget_simple_rpc_validation(&jg);
+  if (vrc != YES) {
+    *out_res = qr_create_err(
+        &id, QRERR_INREQ,
+        "Invalid JSON-RPC request: expected 'jsonrpc':'2.0' with valid "
+        "'id', 'method', and 'params'.");
+    goto return_res;
+  }
+  // exec command
+  JsonStrSpan method_sp = {0};
+  if (jsget_string_span(&jg, "method", &method_sp) != YES) {
+    *out_res =
+        qr_create_err(&id, QRERR_INREQ, "Missing required field 'method'.");
+    goto return_res;
+  }
+
+  if (!STREQ(method_sp.ptr, method_sp.len, "tools/call")) {
+    *out_res = qr_create_err(
+        &id, QRERR_INMETHOD,
+        "Unsupported RPC method '%.*s'; only 'tools/call' is supported.",
+        (int)method_sp.len, method_sp.ptr);
+    goto return_res;
+  }
+
+  JsonStrSpan name_sp = {0};
+  if (jsget_string_span(&jg, "params.name", &name_sp) != YES) {
+    *out_res = qr_create_err(&id, QRERR_INPARAM,
+                             "Tool call is missing 'params.name'.");
+    goto return_res;
+  }
+
+  BrokerRunSQLArgs run_args = {
+      .b = b,
+      .sess = sess,
+      .jg = &jg,
+      .id = &id,
+  };
+
+  // Call the different tools
+  if (STREQ(name_sp.ptr, name_sp.len, "run_sql_query")) {
+    broker_run_sql_query(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "run_sql_query_tokens")) {
+    broker_run_sql_query_tokens(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "run_sql_query_fanout")) {
+    broker_run_sql_query_fanout(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "fetch_result_page")) {
+    broker_fetch_result_page(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "open_sql_cursor")) {
+    broker_open_sql_cursor(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "fetch_cursor_page")) {
+    broker_fetch_cursor_page(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "close_cursor")) {
+    broker_close_cursor(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "describe")) {
+    broker_describe(&run_args, out_res);
+  } else if (STREQ(name_sp.ptr, name_sp.len, "stats")) {
+    broker_stats(&run_args, out_res);
+
+    // Unknown tools
+  } else {
+    *out_res = qr_create_err(&id, QRERR_INMETHOD, "Unknown tool '%.*s'.",
+                             (int)name_sp.len, name_sp.ptr);
+  }
+
+return_res:
+  // NULL result without a queued job is catastrophic, unless the handler
+  // already wrote the response frame itself (result-cache replay).
+  if (!*out_res && !sess->busy && !sess->replied_inline) {
+    mcp_id_clean(&id);
+    return ERR;
+  }
+  sess->replied_inline = 0;
+
+  lhist_record(&b->stats.handle, now_us_monotonic() - t_handle);
+  mcp_id_clean(&id);
+  return OK;
+}
+
+/*------------------------------ Session Handling ---------------------------*/
+
+/* Verifies that the connected Unix-socket peer has the current process UID.
+ * It borrows 'cfd' and does not allocate memory.
+ * Side effects: reads peer credential metadata via getsockopt/getpeereid.
+ * Returns OK on UID match, ERR on mismatch or syscall failure.
+ */
+static AdbxStatus verify_peer_uid(int cfd) {
+  uid_t expected_uid = getuid();
+#ifdef __linux__
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+  if (getsockopt(cfd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+    return ERR;
+  return (cred.uid == expected_uid) ? OK : ERR;
+#else /* macOS / BSDs */
+  uid_t euid;
+  gid_t egid;
+  if (getpeereid(cfd, &euid, &egid) < 0)
+    return ERR;
+  return (euid == expected_uid) ? OK : ERR;
+#endif
+}
+
+/* Initializes token-state containers for one broker session.
+ * It borrows and mutates 'sess'; ownership of created members stays in the
+ * session and is later released by session cleanup callbacks.
+ * Side effects: allocate/init the per-session Arena and the db_stores slot
+ * array addressed by catalog index.
+ * Error semantics: returns OK when state is ready, ERR on invalid input,
+ * inconsistent partial state, or allocation failure.
+ */
+static AdbxStatus broker_session_token_state_init(BrokerMcpSession *sess) {
+  if (!sess)
+    return ERR;
+
+  // session should be empty/zeroed during initialization
+  assert(arena_is_zeroed(&sess->arena) == YES);
+  assert(!sess->db_stores);
+
+  uint32_t cap = SESSION_TOKEN_ARENA_CAP_BYTES;
+  if (arena_init(&sess->arena, NULL, &cap) != OK)
+    return ERR;
+
+  sess->db_stores = parr_create(sizeof(DbTokenStore *));
+  if (!sess->db_stores) {
+    arena_clean(&sess->arena);
+    return ERR;
+  }
+  parr_set_cleanup(sess->db_stores, broker_db_store_cleanup, NULL);
+
+  return OK;
+}
+
+/* Checks whether 'sess' has correctly initialized the token-store containers
+ * and is ready to store/retrieve tokens. */
+inline static AdbxTriStatus
+broker_session_token_state_ok(BrokerMcpSession *sess) {
+  if (!sess)
+    return ERR;
+  if (!sess->db_stores || arena_is_ok(&sess->arena) != YES)
+    return NO;
+  return YES;
+}
+
+/* Finds one persisted session by resume token after a broker restart.
+ * It borrows 'b' and 'token' and compares in constant time, scanning the
+ * whole snapshot so timing does not leak the hit position.
+ * Returns a borrowed record or NULL (also when no snapshot is loaded).
+ */
+static const TokSnapSession *
+broker_snap_find_session(const Broker *b,
+                         const uint8_t token[RESUME_TOKEN_LEN]) {
+  if (!b->tok_snap)
+    return NULL;
+  const TokSnapSession *found = NULL;
+  for (uint32_t i = 0; i < toksnap_n_sessions(b->tok_snap); i++) {
+    const TokSnapSession *rec = toksnap_session_at(b->tok_snap, i);
+    if (rec && bytes_equal_ct(token, rec->resume_token, RESUME_TOKEN_LEN) ==
+                   YES)
+      found = rec;
+  }
+  return found;
+}
+
+/* Resumes one session from a persisted snapshot record: the idle array was
+ * emptied by a broker restart, so the session is rebuilt as a fresh one that
+ * carries the persisted generation/timestamps and lazily restores its token
+ * stores on first use (see broker_get_or_init_store()).
+ * Side effects: mints a fresh resume token, moves 'pending' into the active
+ * array, and initializes token-state containers.
+ * Error semantics: returns HS_OK on success, else the handshake status to
+ * send; '*out_active_idx' is set whenever the session entered the active
+ * array (the caller's failure path drops it).
+ */
+static handshake_status broker_resume_from_snapshot(
+    Broker *b, BrokerMcpSession *pending, const TokSnapSession *rec,
+    time_t now, uint8_t out_token[RESUME_TOKEN_LEN], uint32_t *out_active_idx,
+    BrokerMcpSession **out_active_sess) {
+  // Same TTL rules an idle session would face, against persisted timestamps.
+  if ((b->idle_ttl_secs > 0 && rec->last_active > 0 &&
+       now > (time_t)rec->last_active + (time_t)b->idle_ttl_secs) ||
+      (b->abs_ttl_secs > 0 && rec->created_at > 0 &&
+       now > (time_t)rec->created_at + (time_t)b->abs_ttl_secs)) {
+    return HS_ERR_TOKEN_EXPIRED;
+  }
+
+  if (MAX_CLIENTS > 0 && parr_len(b->active_sessions) >= MAX_CLIENTS)
+    return HS_ERR_FULL;
+  if (fill_random(out_token, RESUME_TOKEN_LEN) != OK)
+    return HS_ERR_INTERNAL;
+
+  uint32_t idx =
+      sessions_add_from_pending(b->active_sessions, pending, out_active_sess);
+  if (idx == UINT32_MAX || !*out_active_sess)
+    return HS_ERR_INTERNAL;
+  *out_active_idx = idx;
+
+  BrokerMcpSession *sess = *out_active_sess;
+  memcpy(sess->resume_token, out_token, RESUME_TOKEN_LEN);
+  sess->generation = rec->generation;
+  if (broker_session_token_state_init(sess) != OK)
+    return HS_ERR_INTERNAL;
+  sess->created_at = (time_t)rec->created_at;
+  sess->last_active = now;
+  sess->tokens_last_used = (time_t)rec->tokens_last_used;
+  sess->restore_src = rec;
+  return HS_OK;
 }
 
-/* Checks whether 'sess' has correctly initialized the token-store containers
- * and is ready to store/retrieve tokens. */
-inline static AdbxTriStatus
-broker_session_token_state_ok(BrokerMcpSession *sess) {
-  if (!sess)
+/* Completes the broker-side handshake for one connection whose request frame
+ * already arrived through the pending-handshake state machine.
+ * Takes ownership of 'cfd'. On success ownership moves into active_sessions;
+ * on failure the fd/channel are closed before return. It borrows 'req_in'.
+ * Side effects: writes the handshake response frame, mutates active/idle
+ * session arrays, may reap idle sessions, and updates per-session
+ * timestamps/tokens.
+ * Returns OK only when handshake succeeds and session is active; ERR otherwise.
+ */
+static AdbxStatus broker_finish_handshake(Broker *b, int cfd,
+                                          const handshake_req_t *req_in) {
+  if (!b || cfd < 0 || !req_in) {
+    safe_close_fd(&cfd);
+    return ERR;
+  }
+
+  // The fd was nonblocking while the handshake frame streamed in; session
+  // I/O uses blocking reads bounded by SO_RCVTIMEO, so restore it first.
+  if (broker_set_block(cfd) != OK) {
+    safe_close_fd(&cfd);
+    return ERR;
+  }
+
+  handshake_req_t req = *req_in;
+  handshake_status status = HS_ERR_INTERNAL;
+  uint8_t out_token[RESUME_TOKEN_LEN] = {0};
+  BrokerMcpSession pending = {0};
+  BrokerMcpSession *active_sess = NULL;
+  uint32_t active_idx = UINT32_MAX;
+
+  // The BufChannel owns the ByteChannel, which owns the fd. Sessions prefer
+  // the batching io_uring channel when enabled and the kernel grants a ring;
+  // otherwise (and per session) they fall back to the plain fd channel.
+  ByteChannel *uring_ch = b->use_uring ? uring_bytechannel_open_fd(cfd) : NULL;
+  if (uring_ch) {
+    if (bufch_init(&pending.bc, uring_ch) != OK) {
+      bytech_destroy(uring_ch); // closes cfd: the channel owns it
+      return ERR;
+    }
+  } else if (bufch_stdio_openfd_init(&pending.bc, cfd, cfd) != OK) {
+    return ERR;
+  }
+  pending.fd = cfd;
+  // BufChannel takes ownership of the file descriptor and is responsible for
+  // closing it
+  cfd = -1;
+
+  if (req.magic != HANDSHAKE_MAGIC) {
+    status = HS_ERR_BAD_MAGIC;
+    goto send_n_close;
+  }
+  if (req.version != HANDSHAKE_VERSION) {
+    status = HS_ERR_BAD_VERSION;
+    goto send_n_close;
+  }
+
+  AdbxTriStatus secret_rc =
+      bytes_equal_ct(req.secret_token, b->secret_token, SECRET_TOKEN_LEN);
+  if (secret_rc != YES) {
+    status = HS_ERR_TOKEN_UNKNOWN;
+    goto send_n_close;
+  }
+
+  time_t now = time(NULL);
+  if (now == (time_t)-1) {
+    status = HS_ERR_INTERNAL;
+    goto send_n_close;
+  }
+
+  // wants to resume a sessions
+  if (req.flags & HANDSHAKE_FLAG_RESUME) {
+    ssize_t idle_idx =
+        broker_find_idle_by_token(b->idle_sessions, req.resume_token);
+    if (idle_idx < 0) {
+      // A broker restart emptied the idle array; a persisted snapshot may
+      // still know this token (see token_snapshot.h).
+      const TokSnapSession *rec =
+          broker_snap_find_session(b, req.resume_token);
+      if (!rec) {
+        status = HS_ERR_TOKEN_UNKNOWN;
+        goto send_n_close;
+      }
+      status = broker_resume_from_snapshot(b, &pending, rec, now, out_token,
+                                           &active_idx, &active_sess);
+      goto send_n_close;
+    }
+
+    BrokerMcpSession *idle_sess =
+        (BrokerMcpSession *)parr_at(b->idle_sessions, (uint32_t)idle_idx);
+    if (!idle_sess) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+
+    time_t resume_created_at = idle_sess->created_at;
+    AdbxTriStatus exp = broker_session_is_expired(
+        idle_sess, now, b->idle_ttl_secs, b->abs_ttl_secs);
+    if (exp == YES) {
+      parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
+      status = HS_ERR_TOKEN_EXPIRED;
+      goto send_n_close;
+    }
+    if (exp != NO) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+
+    if (MAX_CLIENTS > 0 && parr_len(b->active_sessions) >= MAX_CLIENTS) {
+      status = HS_ERR_FULL;
+      goto send_n_close;
+    }
+
+    // Normalize token-state before ownership transfer to keep idle slot valid
+    // if any later step fails.
+    assert(broker_session_token_state_ok(idle_sess) == YES);
+    if (broker_session_token_state_ok(idle_sess) != YES) {
+      status = HS_ERR_INTERNAL;
+      parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
+      TLOG("ERROR - found one half-initialized idle session.");
+      goto send_n_close;
+    }
+
+    // we rotate new token on successful resume
+    if (fill_random(out_token, RESUME_TOKEN_LEN) != OK) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+
+    active_idx =
+        sessions_add_from_pending(b->active_sessions, &pending, &active_sess);
+    if (active_idx == UINT32_MAX || !active_sess) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+    memcpy(active_sess->resume_token, out_token, RESUME_TOKEN_LEN);
+    active_sess->generation = idle_sess->generation;
+    active_sess->arena = idle_sess->arena;
+    active_sess->db_stores = idle_sess->db_stores;
+    active_sess->created_at = resume_created_at;
+    active_sess->last_active = now;
+    active_sess->tokens_last_used = idle_sess->tokens_last_used;
+    active_sess->spill = idle_sess->spill;
+    active_sess->restore_src = idle_sess->restore_src;
+
+    // idle session lost owenership of these entities
+    idle_sess->arena = (Arena){0};
+    idle_sess->db_stores = NULL;
+    idle_sess->spill = NULL;
+    idle_sess->restore_src = NULL;
+
+    // Remove stale idle record.
+    parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
+    status = HS_OK;
+  } else {
+    // New session
+    if (MAX_CLIENTS > 0 && parr_len(b->active_sessions) >= MAX_CLIENTS) {
+      status = HS_ERR_FULL;
+      goto send_n_close;
+    }
+
+    if (parr_len(b->idle_sessions) >= MAX_IDLE_SESSIONS &&
+        broker_reap_one_idle_session(b->idle_sessions) != OK) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+
+    if (fill_random(out_token, RESUME_TOKEN_LEN) != OK) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+
+    active_idx =
+        sessions_add_from_pending(b->active_sessions, &pending, &active_sess);
+    if (active_idx == UINT32_MAX || !active_sess) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+    memcpy(active_sess->resume_token, out_token, RESUME_TOKEN_LEN);
+    active_sess->generation = 0;
+    if (broker_session_token_state_init(active_sess) != OK) {
+      status = HS_ERR_INTERNAL;
+      goto send_n_close;
+    }
+    active_sess->created_at = now;
+    active_sess->last_active = now;
+    status = HS_OK;
+  }
+
+send_n_close: {
+  BrokerMcpSession *resp_sess =
+      (active_idx != UINT32_MAX && active_sess) ? active_sess : &pending;
+  const uint8_t *resp_token = (status == HS_OK) ? out_token : NULL;
+  if (broker_write_handshake_resp(resp_sess, status, resp_token,
+                                  b->idle_ttl_secs, b->abs_ttl_secs) != OK) {
+    // close whichever session object owns the channel at this point
+    if (active_idx != UINT32_MAX) {
+      parr_drop_swap(b->active_sessions, active_idx);
+    } else {
+      bufch_clean(&pending.bc);
+      pending.fd = -1;
+    }
     return ERR;
-  if (!sess->db_stores || arena_is_ok(&sess->arena) != YES)
-    return NO;
-  return YES;
+  }
 }
 
-/* Performs broker-side handshake.
- * Takes ownership of 'cfd'. On success ownership moves into active_sessions;
- * on failure the fd/channel are closed before return.
- * Side effects: reads/writes handshake frames, mutates active/idle session
- * arrays, may reap idle sessions, and updates per-session timestamps/tokens.
- * Returns OK only when handshake succeeds and session is active; ERR otherwise.
- */
-static AdbxStatus broker_do_handshake(Broker *b, int cfd) {
-  if (!b || cfd < 0) {
-    safe_close_fd(&cfd);
+  if (status != HS_OK) {
+    if (active_idx != UINT32_MAX) {
+      parr_drop_swap(b->active_sessions, active_idx);
+    } else {
+      bufch_clean(&pending.bc);
+      pending.fd = -1;
+    }
     return ERR;
   }
 
-  if (verify_peer_uid(cfd) != OK) {
-    TLOG("INFO - rejected client fd=%d: peer UID mismatch", cfd);
-    safe_close_fd(&cfd);
+  // Keep bounded read timeouts after handshake too, so malformed/truncated
+  // request frames cannot stall broker_run() indefinitely.
+  if (broker_set_rcv_timeout_sec(active_sess->fd, REQUEST_READ_TIMEOUT_SEC) !=
+      OK) {
+    parr_drop_swap(b->active_sessions, active_idx);
     return ERR;
   }
 
-  handshake_status status = HS_ERR_INTERNAL;
-  uint8_t out_token[RESUME_TOKEN_LEN] = {0};
-  BrokerMcpSession pending = {0};
-  BrokerMcpSession *active_sess = NULL;
-  uint32_t active_idx = UINT32_MAX;
-
-  // The BufChannel owns the ByteChannel, which owns the fd.
-  if (bufch_stdio_openfd_init(&pending.bc, cfd, cfd) != OK) {
+  if (broker_poller_add(b, active_sess->fd) != OK) {
+    parr_drop_swap(b->active_sessions, active_idx);
     return ERR;
   }
-  pending.fd = cfd;
-  // BufChannel takes ownership of the file descriptor and is responsible for
-  // closing it
-  cfd = -1;
 
-  if (broker_set_rcv_timeout_sec(pending.fd, HANDSHAKE_READ_TIMEOUT_SEC) !=
-      OK) {
-    status = HS_ERR_INTERNAL;
-    goto send_n_close;
+  active_sess->serial = ++b->next_session_serial;
+  active_sess->wire_binary =
+      (req.flags & HANDSHAKE_FLAG_BINARY_RESULTS) ? 1 : 0;
+
+  TLOG("INFO - accepted MCP client fd=%d", active_sess->fd);
+
+  // Clients may pipeline their first request frame right behind the
+  // handshake request (zero-round-trip resume). The handshake read can pull
+  // those bytes into the session buffer, where the poller never sees them,
+  // so serve whatever is already complete before returning to the loop.
+  size_t buffered = 0;
+  if (bufch_peek(&active_sess->bc, &buffered) != NULL && buffered > 0)
+    broker_session_serve_buffered(b, active_idx);
+
+  return OK;
+}
+
+/* ---------------------------- handshake admission ------------------------ */
+
+/* Writes one handshake response straight to a raw fd, bypassing channel
+ * setup — the cheap-rejection path for connections the broker will not
+ * admit. Best-effort: the frame fits a fresh socket's send buffer, and a
+ * short write just means the peer sees a dropped connection instead.
+ */
+static void broker_reject_handshake_raw(const Broker *b, int fd,
+                                        handshake_status status) {
+  handshake_resp_t resp = {0};
+  resp.magic = HANDSHAKE_MAGIC;
+  resp.version = HANDSHAKE_VERSION;
+  resp.status = status;
+  resp.idle_ttl_secs = b->idle_ttl_secs;
+  resp.abs_ttl_secs = b->abs_ttl_secs;
+
+  uint8_t wire[4u + HANDSHAKE_RESP_WIRE_SIZE];
+  uint32_t hdr = htonl(HANDSHAKE_RESP_WIRE_SIZE);
+  memcpy(wire, &hdr, sizeof(hdr));
+  if (handshake_resp_encode(&resp, wire + 4u) != OK)
+    return;
+
+  // MSG_NOSIGNAL: a hung-up peer must fail the write, not raise SIGPIPE.
+  ssize_t wr;
+  do {
+    wr = send(fd, wire, sizeof(wire), MSG_NOSIGNAL);
+  } while (wr < 0 && errno == EINTR);
+}
+
+/* Finds the pending handshake that owns 'fd'.
+ * Returns index [0..len) when found, -1 otherwise.
+ */
+static ssize_t broker_find_pending_hs(const Broker *b, int fd) {
+  for (uint32_t i = 0; i < b->pending_hs_len; i++) {
+    if (b->pending_hs[i].fd == fd)
+      return (ssize_t)i;
+  }
+  return -1;
+}
+
+/* Unregisters and forgets pending slot 'idx', returning the still-open fd
+ * to the caller. */
+static int broker_pending_hs_remove(Broker *b, uint32_t idx) {
+  int fd = b->pending_hs[idx].fd;
+  (void)broker_poller_del(b, fd);
+  b->pending_hs_len--;
+  if (idx != b->pending_hs_len)
+    b->pending_hs[idx] = b->pending_hs[b->pending_hs_len];
+  return fd;
+}
+
+/* Drops one mid-handshake connection after sending one raw 'status' frame
+ * (best-effort: a hung-up peer simply never reads it). */
+static void broker_pending_hs_drop(Broker *b, uint32_t idx,
+                                   handshake_status status) {
+  int fd = broker_pending_hs_remove(b, idx);
+  broker_reject_handshake_raw(b, fd, status);
+  safe_close_fd(&fd);
+}
+
+/* Advances one pending handshake: drains whatever bytes arrived and, once
+ * the frame is complete, hands the fd to broker_finish_handshake(). Partial
+ * frames return to the poller; EOF, errors, and malformed frames drop the
+ * connection.
+ * Side effects: may remove the pending slot (swap-remove: later indexes in
+ * the same event batch stay valid because lookups go through the fd).
+ */
+static void broker_pending_hs_on_readable(Broker *b, uint32_t idx,
+                                          int is_err) {
+  BrokerPendingHs *ph = &b->pending_hs[idx];
+  if (is_err) {
+    broker_pending_hs_drop(b, idx, HS_ERR_REQ);
+    return;
+  }
+
+  for (;;) {
+    uint8_t sink[256];
+    uint8_t *dst;
+    uint32_t want;
+    if (ph->got < 4u) {
+      dst = ph->buf + ph->got;
+      want = 4u - ph->got;
+    } else if (ph->got - 4u >= ph->need) {
+      break; // frame complete (or declared empty)
+    } else if (ph->bad_len) {
+      // Wrong declared length: absorb the payload the peer is mid-write on
+      // before rejecting, exactly as the old frame_read_len() path did, so
+      // the peer never takes EPIPE on bytes it already committed to.
+      uint32_t left = ph->need - (ph->got - 4u);
+      dst = sink;
+      want = (left < sizeof(sink)) ? left : (uint32_t)sizeof(sink);
+    } else {
+      dst = ph->buf + ph->got;
+      want = BROKER_HS_FRAME_LEN - ph->got;
+    }
+
+    ssize_t rd = read(ph->fd, dst, want);
+    if (rd > 0) {
+      ph->got += (uint32_t)rd;
+      if (ph->got >= 4u && ph->got - (uint32_t)rd < 4u) {
+        uint32_t netlen = 0;
+        memcpy(&netlen, ph->buf, sizeof(netlen));
+        uint32_t declared = ntohl(netlen);
+        if (declared > STRBUF_MAX_BYTES) {
+          // Too large to ever drain; reject straight away (the peer cannot
+          // have committed a meaningful payload behind such a header).
+          broker_pending_hs_drop(b, idx, HS_ERR_REQ);
+          return;
+        }
+        ph->need = declared;
+        ph->bad_len = (declared != HANDSHAKE_REQ_WIRE_SIZE);
+      }
+      continue;
+    }
+    if (rd < 0 && errno == EINTR)
+      continue;
+    if (rd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return; // frame still arriving; the poller calls back
+    // EOF or hard error: frame can never complete. Reject like a malformed
+    // request; the write is moot when the peer is fully gone, but a peer
+    // that only shut down its write side still reads the status.
+    broker_pending_hs_drop(b, idx, HS_ERR_REQ);
+    return;
+  }
+
+  if (ph->bad_len) {
+    broker_pending_hs_drop(b, idx, HS_ERR_REQ);
+    return;
   }
 
   handshake_req_t req = {0};
-  if (broker_read_handshake_req(&pending, &req) != OK) {
-    status = HS_ERR_REQ;
-    goto send_n_close;
+  if (handshake_req_decode(&req, ph->buf + 4u, HANDSHAKE_REQ_WIRE_SIZE) != OK) {
+    broker_pending_hs_drop(b, idx, HS_ERR_REQ);
+    return;
   }
 
-  if (req.magic != HANDSHAKE_MAGIC) {
-    status = HS_ERR_BAD_MAGIC;
-    goto send_n_close;
+  // Frame complete. Leave the pending table first: the session path
+  // re-registers the fd with the poller when the handshake succeeds.
+  int cfd = broker_pending_hs_remove(b, idx);
+  if (broker_finish_handshake(b, cfd, &req) != OK)
+    TLOG("INFO - rejected client fd=%d during handshake", cfd);
+}
+
+/* Accepts every connection the backlog holds and admits each into the
+ * pending-handshake table, rejecting cheaply past the cap. Handshake bytes
+ * are consumed off the accept path, so a burst of connects (host fleet
+ * redeploy) costs the loop one accept and one read attempt per peer instead
+ * of a sequence of timed blocking handshakes.
+ */
+static void broker_accept_burst(Broker *b) {
+  for (;;) {
+#ifdef __linux__
+    int cfd = accept4(b->listen_fd, NULL, NULL, SOCK_NONBLOCK);
+#else
+    int cfd = accept(b->listen_fd, NULL, NULL);
+#endif
+    if (cfd < 0) {
+      if (errno == EINTR)
+        continue;
+      // EAGAIN/EWOULDBLOCK or accept error; keep running
+      break;
+    }
+#ifndef __linux__
+    if (broker_set_nonblock(cfd) != OK) {
+      safe_close_fd(&cfd);
+      continue;
+    }
+#endif
+
+    if (verify_peer_uid(cfd) != OK) {
+      TLOG("INFO - rejected client fd=%d: peer UID mismatch", cfd);
+      safe_close_fd(&cfd);
+      continue;
+    }
+
+    if (b->pending_hs_len >= b->pending_hs_cap) {
+      TLOG("INFO - rejected client fd=%d: pending-handshake cap reached", cfd);
+      broker_reject_handshake_raw(b, cfd, HS_ERR_FULL);
+      safe_close_fd(&cfd);
+      continue;
+    }
+
+    BrokerPendingHs *ph = &b->pending_hs[b->pending_hs_len];
+    memset(ph, 0, sizeof(*ph));
+    ph->fd = cfd;
+    ph->deadline_ms =
+        now_ms_monotonic() + (uint64_t)HANDSHAKE_READ_TIMEOUT_SEC * 1000u;
+    if (broker_poller_add(b, cfd) != OK) {
+      safe_close_fd(&cfd);
+      continue;
+    }
+    b->pending_hs_len++;
+
+    // Clients send the request right behind connect(); try to finish the
+    // handshake now instead of paying one extra poll round-trip.
+    broker_pending_hs_on_readable(b, b->pending_hs_len - 1u, 0);
   }
-  if (req.version != HANDSHAKE_VERSION) {
-    status = HS_ERR_BAD_VERSION;
-    goto send_n_close;
+}
+
+/* Drops pending handshakes whose deadline passed — the nonblocking analogue
+ * of the old SO_RCVTIMEO handshake read timeout. */
+static void broker_drop_stalled_handshakes(Broker *b) {
+  if (b->pending_hs_len == 0)
+    return;
+  uint64_t now = now_ms_monotonic();
+  for (uint32_t i = b->pending_hs_len; i-- > 0;) {
+    if (now >= b->pending_hs[i].deadline_ms) {
+      TLOG("INFO - dropped client fd=%d: handshake timed out",
+           b->pending_hs[i].fd);
+      broker_pending_hs_drop(b, i, HS_ERR_REQ);
+    }
   }
+}
 
-  AdbxTriStatus secret_rc =
-      bytes_equal_ct(req.secret_token, b->secret_token, SECRET_TOKEN_LEN);
-  if (secret_rc != YES) {
-    status = HS_ERR_TOKEN_UNKNOWN;
-    goto send_n_close;
+/* Serializes one QueryResult as JSON-RPC and writes one length-prefixed frame.
+ * Rows stream straight into the client channel, so large resultsets never
+ * materialize a second full copy of the response.
+ * It borrows 'sess' and 'q_res'.
+ * Side effects: writes to the client channel.
+ * Returns OK on successful encode/write, ERR on invalid input or write failure.
+ */
+/* Emits one structured slow-request log line when the request that just
+ * completed on 'sess' exceeded its profile's slowLogMs threshold.
+ * It borrows all inputs; the line goes through the async logger so the cost
+ * on the broker thread is one enqueue.
+ * Side effects: none beyond the log write.
+ * Error semantics: none (requests without an armed threshold never log).
+ */
+static void broker_slow_log(const BrokerMcpSession *sess,
+                            const QueryResult *q_res) {
+  if (!sess || sess->req_slow_log_ms == 0)
+    return;
+  uint64_t total_us = now_us_monotonic() - sess->req_start_us;
+  if (total_us < (uint64_t)sess->req_slow_log_ms * 1000u)
+    return;
+
+  // Row/byte fields live in the QR_OK arm of the result union.
+  int ok = q_res && q_res->status == QR_OK;
+  alog_write("Broker: SLOW conn=%s total_ms=%llu connect_us=%u "
+             "validate_us=%u exec_ms=%llu rows=%u spilled_rows=%llu "
+             "bytes=%llu truncated=%u status=%d",
+             sess->req_conn, (unsigned long long)(total_us / 1000u),
+             sess->req_connect_us, sess->req_validate_us,
+             (unsigned long long)(q_res ? q_res->exec_ms : 0),
+             ok ? q_res->nrows : 0,
+             (unsigned long long)(ok ? q_res->spilled_rows : 0),
+             (unsigned long long)(ok ? q_res->used_query_bytes : 0),
+             ok ? q_res->result_truncated : 0, q_res ? (int)q_res->status : -1);
+}
+
+/* Returns 1 when 'q_res' should take the binary hop: errors are tiny, and OK
+ * results qualify while a cheap upper bound on their encoded size stays under
+ * the chunk threshold. Larger results keep the chunked JSON path so the MCP
+ * server's raw relay (and the stdout splice) still applies to them. */
+static int broker_q_res_fits_binary(const QueryResult *q_res) {
+  if (q_res->status != QR_OK)
+    return 1;
+  uint64_t bound = q_res->used_query_bytes + 4096u +
+                   (uint64_t)q_res->nrows * (uint64_t)q_res->ncols * 4u;
+  return bound <= FRAME_CHUNK_THRESHOLD_BYTES;
+}
+
+static AdbxStatus broker_write_q_res(Broker *b, BrokerMcpSession *sess,
+                                     const QueryResult *q_res) {
+  if (!b || !q_res || !sess)
+    return ERR;
+
+  uint64_t t0 = now_us_monotonic();
+  AdbxStatus rc;
+  if (sess->wire_binary && broker_q_res_fits_binary(q_res)) {
+    // Negotiated binary hop: raw cell bytes, no JSON escaping here; the MCP
+    // server transcodes just before stdout (see qr_wire.h).
+    StrBuf bin;
+    sb_init(&bin);
+    if (qr_wire_encode(q_res, &bin) == OK && bin.len <= UINT32_MAX) {
+      rc = frame_write_len(&sess->bc, bin.data, (uint32_t)bin.len);
+    } else {
+      rc = qr_to_jsonrpc_frame(q_res, &sess->bc);
+    }
+    sb_clean(&bin);
+  } else {
+    rc = qr_to_jsonrpc_frame(q_res, &sess->bc);
+  }
+  lhist_record(&b->stats.serialize, now_us_monotonic() - t0);
+  if (rc == OK)
+    broker_slow_log(sess, q_res);
+  // Feed the observed metadata-arena size back into the per-connection
+  // estimate so the next result on this profile pre-sizes its arena.
+  if (q_res->status == QR_OK && sess->req_conn[0] != '\0')
+    connm_note_result_arena(b->cm, sess->req_conn,
+                            arena_get_peak_used(&q_res->text_arena));
+  return rc;
+}
+
+/* Serves every complete request frame already buffered for one session.
+ * It borrows 'b' and the session at 'idx'; the session may be dropped, moved
+ * to idle storage, or left busy (with read events disarmed) before return.
+ * Side effects: handles tool requests, may queue worker jobs, and writes
+ * response frames.
+ * Error semantics: none (fail-soft; misbehaving sessions are removed).
+ */
+/* Mutes read events for one session so a level-triggered poller does not
+ * spin on bytes that cannot be served yet (e.g. a pipelined request queued
+ * behind the in-flight job). broker_finish_deferred() re-arms. */
+static void broker_session_mute_reads(Broker *b, BrokerMcpSession *sess) {
+  if (!sess || sess->read_muted)
+    return;
+  sess->read_muted = 1;
+  (void)broker_poller_set_armed(b, sess->fd, 0);
+}
+
+/* Returns YES when 'req' is an MCP cancellation notification
+ * ("notifications/cancelled"; no response is ever produced for it), NO for
+ * anything else including unparseable frames.
+ * On YES, '*out_target' holds the id named by params.requestId (an owned
+ * copy when string-backed, zeroed when the field is missing or malformed);
+ * the caller must mcp_id_clean() it. */
+static AdbxTriStatus broker_req_is_cancel(Broker *b, const char *req,
+                                          uint32_t req_len,
+                                          McpId *out_target) {
+  if (!b || !req || !out_target)
+    return NO;
+  memset(out_target, 0, sizeof(*out_target));
+
+  JsonGetter jg;
+  if (jsget_init_ws(&jg, req, req_len, &b->req_tok_ws) != OK)
+    return NO;
+
+  JsonStrSpan method_sp = {0};
+  if (jsget_string_span(&jg, "method", &method_sp) != YES)
+    return NO;
+  if (!STREQ(method_sp.ptr, method_sp.len, "notifications/cancelled"))
+    return NO;
+
+  if (jsget_u32(&jg, "params.requestId", &out_target->u32) == YES) {
+    out_target->kind = MCP_ID_INT;
+  } else {
+    char *id_str = NULL;
+    if (jsget_string_decode_alloc(&jg, "params.requestId", &id_str) == YES) {
+      out_target->kind = MCP_ID_STR;
+      out_target->str = id_str;
+    }
+    // Missing/malformed requestId still counts as a cancellation frame; the
+    // zeroed target simply matches nothing.
+  }
+  return YES;
+}
+
+/* Serves a busy session's buffered frames. While a worker runs this
+ * session's request the only frames acted on are cancellation notifications:
+ * one naming the in-flight request aborts its statement via the backend,
+ * others are dropped (parked and still-buffered requests run to completion
+ * in v1). The first non-cancellation frame mutes read events until the
+ * completion re-arms them and the normal serve path takes over. */
+static void broker_session_serve_busy(Broker *b, uint32_t idx) {
+  BrokerMcpSession *sess = parr_at(b->active_sessions, idx);
+  if (!sess || !sess->busy)
+    return;
+
+  for (;;) {
+    uint32_t declared = 0;
+    AdbxTriStatus hrc = frame_peek_len(&sess->bc, &declared);
+    if (hrc != YES)
+      break;
+    if (declared > MAX_REQ_LEN) {
+      // Framing abuse; the job pins the slot, so mute instead of dropping
+      // and let the post-completion serve pass deal with it.
+      broker_session_mute_reads(b, sess);
+      return;
+    }
+
+    const uint8_t *req = NULL;
+    uint32_t req_len = 0;
+    if (frame_view_len(&sess->bc, &req, &req_len) != YES)
+      break;
+
+    McpId target = {0};
+    if (broker_req_is_cancel(b, (const char *)req, req_len, &target) != YES) {
+      broker_session_mute_reads(b, sess);
+      return;
+    }
+
+    sess->last_active = time(NULL);
+    if (sess->inflight_db && mcp_id_equal(&sess->inflight_id, &target) == YES) {
+      TLOG("INFO - cancelling in-flight request on client notification");
+      db_cancel_inflight(sess->inflight_db);
+    }
+    mcp_id_clean(&target);
+    frame_consume_len(&sess->bc, req_len);
+  }
+
+  if (bufch_is_eof(&sess->bc) == YES) {
+    // Peer vanished mid-job: keep the slot (and its token store) pinned
+    // until the completion retires it, and stop watching the dead fd.
+    sess->defunct = 1;
+    broker_session_mute_reads(b, sess);
+  }
+}
+
+static void broker_session_serve_buffered(Broker *b, uint32_t idx) {
+  BrokerMcpSession *sess = parr_at(b->active_sessions, idx);
+  if (!sess || sess->busy)
+    return;
+
+  // Drain every frame that is already complete in the buffer.
+  for (;;) {
+    uint32_t declared = 0;
+    AdbxTriStatus hrc = frame_peek_len(&sess->bc, &declared);
+    if (hrc == ERR) {
+      parr_drop_swap(b->active_sessions, idx);
+      return;
+    }
+    if (hrc == YES && declared > MAX_REQ_LEN) {
+      // framing abuse -> drop client before buffering the payload
+      TLOG("ERROR - drop client: oversized frame declared=%u", declared);
+      parr_drop_swap(b->active_sessions, idx);
+      return;
+    }
+
+    // Borrowed zero-copy view into the session read buffer; nothing below
+    // fills this channel, so the bytes stay put until they are consumed.
+    const uint8_t *req = NULL;
+    uint32_t req_len = 0;
+    AdbxTriStatus rrc = (hrc == YES) ? frame_view_len(&sess->bc, &req, &req_len)
+                                     : NO;
+    if (rrc == ERR) {
+      TLOG("ERROR - drop client: malformed request frame");
+      parr_drop_swap(b->active_sessions, idx);
+      return;
+    }
+    if (rrc == NO) {
+      // Track when a partial frame started so stalled senders are bounded by
+      // REQUEST_READ_TIMEOUT_SEC instead of pinning a session slot forever.
+      size_t avail = 0;
+      (void)bufch_peek(&sess->bc, &avail);
+      if (avail > 0) {
+        if (sess->frame_started_at == 0)
+          sess->frame_started_at = time(NULL);
+      } else {
+        sess->frame_started_at = 0;
+      }
+      break;
+    }
+
+    sess->frame_started_at = 0;
+    sess->last_active = time(NULL);
+    TLOG("INFO - received request len=%u", req_len);
+
+    McpId cancel_target = {0};
+    if (broker_req_is_cancel(b, (const char *)req, req_len, &cancel_target) ==
+        YES) {
+      // Late cancellation (nothing in flight anymore): there is nothing to
+      // abort and a notification never gets a reply; drop the frame.
+      mcp_id_clean(&cancel_target);
+      frame_consume_len(&sess->bc, req_len);
+      continue;
+    }
+
+    QueryResult *q_res = NULL;
+    uint64_t t0 = now_ms_monotonic();
+    if (broker_handle_request(b, sess, (const char *)req, req_len, &q_res) !=
+        OK) {
+      // Something bad happend, drop client
+      alog_write("Broker: request handling failed");
+      parr_drop_swap(b->active_sessions, idx);
+      return;
+    }
+
+    if (!q_res) {
+      frame_consume_len(&sess->bc, req_len);
+      if (!sess->busy)
+        continue; // answered inline from the result cache; keep serving
+      // Deferred to a worker: stop serving this session until the completion
+      // is handled. The fd stays armed so a cancellation notification can
+      // still reach the running statement; any other frame mutes reads. The
+      // job owns copies of whatever it needs, so the frame can be retired.
+      break;
+    }
+
+    if (q_res->exec_ms == 0) {
+      uint64_t t1 = now_ms_monotonic();
+      q_res->exec_ms = (t1 >= t0) ? (t1 - t0) : 0;
+    }
+    if (broker_write_q_res(b, sess, q_res) != OK) {
+      alog_write("Broker: failed to write response");
+      TLOG("ERROR - drop client: failed to write response");
+      qr_destroy(q_res);
+      parr_drop_swap(b->active_sessions, idx);
+      return;
+    }
+
+    frame_consume_len(&sess->bc, req_len);
+    qr_destroy(q_res);
+  }
+
+  // Peer closed its write side.
+  if (bufch_is_eof(&sess->bc) == YES) {
+    if (sess->busy) {
+      // Keep the slot (and its token store) pinned until the job completes.
+      sess->defunct = 1;
+    } else {
+      session_move_to_idle(b, idx);
+    }
+  }
+}
+
+/* Pulls readable bytes for one active session and serves buffered frames.
+ * It borrows 'b' and the session at 'idx'; see
+ * broker_session_serve_buffered() for removal semantics.
+ * Side effects: reads once from the session socket.
+ * Error semantics: none (fail-soft; read failures drop the session).
+ */
+static void broker_session_on_readable(Broker *b, uint32_t idx) {
+  BrokerMcpSession *sess = parr_at(b->active_sessions, idx);
+  if (!sess)
+    return;
+
+  // Single read per readiness report: on a level-triggered poller the fd stays
+  // reported while the kernel holds more bytes, so we never block here even
+  // though the fd itself is blocking.
+  if (bufch_fill_some(&sess->bc) == ERR) {
+    if (sess->busy) {
+      // The in-flight job pins the slot; retire it after the completion.
+      TLOG("ERROR - read failure on busy session fd=%d", sess->fd);
+      sess->defunct = 1;
+      broker_session_mute_reads(b, sess);
+      return;
+    }
+    TLOG("ERROR - drop client fd=%d: read failure", sess->fd);
+    parr_drop_swap(b->active_sessions, idx);
+    return;
+  }
+
+  if (sess->busy) {
+    broker_session_serve_busy(b, idx);
+    return;
+  }
+  broker_session_serve_buffered(b, idx);
+}
+
+/* Delivers 'q_res' (owned; consumed) to the busy session at 'idx' after its
+ * deferred job finished, then resumes or retires the session.
+ * Side effects: writes one response frame, re-arms read events, and may drop
+ * or idle the session (e.g. when the peer hung up while the job ran).
+ * Error semantics: none (fail-soft; undeliverable sessions are removed).
+ */
+static void broker_finish_deferred(Broker *b, uint32_t idx,
+                                   QueryResult *q_res) {
+  BrokerMcpSession *sess = parr_at(b->active_sessions, idx);
+  if (!sess) {
+    qr_destroy(q_res);
+    return;
+  }
+  sess->busy = 0;
+  // The connection goes back to the pool now; forget it before anything can
+  // aim a stale cancellation at its next owner.
+  sess->inflight_db = NULL;
+  mcp_id_clean(&sess->inflight_id);
+
+  if (q_res)
+    lhist_record(&b->stats.execute, q_res->exec_ms * 1000u);
+  int write_ok = (q_res && broker_write_q_res(b, sess, q_res) == OK);
+  qr_destroy(q_res);
+  if (!write_ok) {
+    TLOG("ERROR - drop client fd=%d: failed to write deferred response",
+         sess->fd);
+    parr_drop_swap(b->active_sessions, idx);
+    return;
+  }
+
+  if (sess->defunct) {
+    // Peer hung up while the job was running; the response is flushed (best
+    // effort), so the session can finally go resumable.
+    session_move_to_idle(b, idx);
+    return;
+  }
+
+  sess->last_active = time(NULL);
+  sess->read_muted = 0;
+  if (broker_poller_set_armed(b, sess->fd, 1) != OK) {
+    parr_drop_swap(b->active_sessions, idx);
+    return;
   }
+  // Serve any frames that queued up while the session was busy.
+  broker_session_serve_buffered(b, idx);
+}
 
-  time_t now = time(NULL);
-  if (now == (time_t)-1) {
-    status = HS_ERR_INTERNAL;
-    goto send_n_close;
+/* Fails one parked job that could not be dispatched, answering its session
+ * with a scheduling error. Takes ownership of 'job'. */
+static void broker_fail_parked_job(Broker *b, ExecPoolJob *job) {
+  uint64_t serial = job->session_serial;
+  QueryResult *q_res = qr_create_tool_err(
+      &job->id, "Internal error while scheduling query execution for '%s'.",
+      job->conn_name ? job->conn_name : "?");
+  exec_pool_job_destroy(job);
+
+  // The job never ran, so its single-flight followers fail with it.
+  broker_flight_resolve(b, serial, q_res);
+
+  ssize_t idx = broker_find_active_by_serial(b->active_sessions, serial);
+  if (idx < 0) {
+    qr_destroy(q_res);
+    return;
   }
+  broker_finish_deferred(b, (uint32_t)idx, q_res);
+}
 
-  // wants to resume a sessions
-  if (req.flags & HANDSHAKE_FLAG_RESUME) {
-    ssize_t idle_idx =
-        broker_find_idle_by_token(b->idle_sessions, req.resume_token);
-    if (idle_idx < 0) {
-      status = HS_ERR_TOKEN_UNKNOWN;
-      goto send_n_close;
-    }
+/* Dispatches parked jobs waiting on 'conn_name' while free pooled slots
+ * remain: each redeemed waiter checks out one connection and goes to the
+ * worker pool.
+ * Error semantics: none (fail-soft; undeliverable jobs answer their session
+ * with a scheduling error and vanished waiters free the slot for the next).
+ */
+static void broker_dispatch_waiters(Broker *b, const char *conn_name) {
+  if (!conn_name)
+    return;
 
-    BrokerMcpSession *idle_sess =
-        (BrokerMcpSession *)parr_at(b->idle_sessions, (uint32_t)idle_idx);
-    if (!idle_sess) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
-    }
+  uint64_t cookie;
+  while ((cookie = connm_pop_waiter(b->cm, conn_name)) != 0) {
+    ExecPoolJob *job = broker_take_parked_by_serial(b, cookie);
+    if (!job)
+      continue; // stale cookie; the slot stays free for the next waiter
 
-    time_t resume_created_at = idle_sess->created_at;
-    AdbxTriStatus exp = broker_session_is_expired(
-        idle_sess, now, b->idle_ttl_secs, b->abs_ttl_secs);
-    if (exp == YES) {
-      parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
-      status = HS_ERR_TOKEN_EXPIRED;
-      goto send_n_close;
+    ConnView cv = {0};
+    if (connm_checkout(b->cm, conn_name, &cv) != CONN_CHECKOUT_OK || !cv.db) {
+      broker_fail_parked_job(b, job);
+      continue;
     }
-    if (exp != NO) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
+    job->db = cv.db;
+    // Track the connection for cancellation before the worker can race us.
+    ssize_t sidx = broker_find_active_by_serial(b->active_sessions, cookie);
+    BrokerMcpSession *sess =
+        (sidx >= 0) ? parr_at(b->active_sessions, (uint32_t)sidx) : NULL;
+    if (sess)
+      sess->inflight_db = cv.db;
+    if (exec_pool_submit(b->exec_pool, job) != OK) {
+      job->db = NULL;
+      if (sess)
+        sess->inflight_db = NULL;
+      connm_checkin(b->cm, conn_name, cv.db);
+      broker_fail_parked_job(b, job);
     }
+  }
+}
 
-    if (MAX_CLIENTS > 0 && parr_len(b->active_sessions) >= MAX_CLIENTS) {
-      status = HS_ERR_FULL;
-      goto send_n_close;
-    }
+/* Dispatches the waiters of every connection queued by
+ * broker_defer_waiter_dispatch(). Must only run from the event loop with no
+ * borrowed session pointers (dispatching can drop or move sessions).
+ */
+static void broker_run_deferred_dispatch(Broker *b) {
+  // dispatch can close further cursors and re-queue; swap the batch out first
+  while (b->n_deferred_conns > 0) {
+    char conn[CONN_NAME_MAX_LEN + 1];
+    b->n_deferred_conns--;
+    snprintf(conn, sizeof(conn), "%s",
+             b->deferred_conns[b->n_deferred_conns]);
+    broker_dispatch_waiters(b, conn);
+  }
+}
 
-    // Normalize token-state before ownership transfer to keep idle slot valid
-    // if any later step fails.
-    assert(broker_session_token_state_ok(idle_sess) == YES);
-    if (broker_session_token_state_ok(idle_sess) != YES) {
-      status = HS_ERR_INTERNAL;
-      parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
-      TLOG("ERROR - found one half-initialized idle session.");
-      goto send_n_close;
+/* Delivers one finished cursor job (open or fetch) to its session. Unlike
+ * plain exec jobs, a successful open does not check the connection back in:
+ * it stays pinned behind the installed SessionCursor until the cursor closes
+ * (drain, error, explicit close, or the session leaving the active array).
+ * Ownership: takes 'job'.
+ */
+static void broker_handle_cursor_completion(Broker *b, ExecPoolJob *job) {
+  ssize_t idx =
+      broker_find_active_by_serial(b->active_sessions, job->session_serial);
+  BrokerMcpSession *sess =
+      (idx >= 0) ? parr_at(b->active_sessions, (uint32_t)idx) : NULL;
+
+  QueryResult *q_res = job->result;
+  job->result = NULL;
+  if (q_res && q_res->exec_ms == 0) {
+    uint64_t t1 = now_ms_monotonic();
+    q_res->exec_ms = (t1 >= job->submitted_ms) ? (t1 - job->submitted_ms) : 0;
+  }
+  if (q_res)
+    q_res->columnar = job->columnar;
+  int ok = (q_res && q_res->status == QR_OK);
+
+  if (job->cursor_op == EXEC_CURSOR_OPEN) {
+    if (ok && sess) {
+      // Install the cursor; the previous one was closed before submitting.
+      SessionCursor *cur = xcalloc(1, sizeof(*cur));
+      snprintf(cur->handle_hex, sizeof(cur->handle_hex), "%s",
+               job->cursor_handle);
+      snprintf(cur->name, sizeof(cur->name), "%s", job->cursor_name);
+      cur->db = job->db;
+      cur->conn_name = job->conn_name;
+      job->conn_name = NULL;
+      cur->vout = job->vout; // moved: fetches borrow the retained plan
+      memset(&job->vout, 0, sizeof(job->vout));
+      cur->store = job->store;
+      cur->max_page_rows = job->cursor_nrows;
+      sess->cursor = cur;
+    } else {
+      // Failed open (or vanished session): nothing stays pinned.
+      broker_cursor_conn_release(b, job->conn_name, job->db, job->cursor_name);
     }
+    job->db = NULL; // pinned by the cursor or already returned
+  } else {
+    // EXEC_CURSOR_FETCH: a short or truncated page means the cursor drained
+    // (or its transaction died); on a good full page more rows remain and
+    // resultTruncated advertises that to the client.
+    int drained =
+        !ok || q_res->result_truncated || q_res->nrows < job->cursor_nrows;
+    if (ok)
+      q_res->result_truncated = drained ? 0 : 1;
+    if (sess && drained)
+      broker_session_cursor_close(b, sess);
+    // When the session is gone its array cleanup already released the
+    // pinned connection; the job only ever borrowed it.
+    job->db = NULL;
+  }
 
-    // we rotate new token on successful resume
-    if (fill_random(out_token, RESUME_TOKEN_LEN) != OK) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
-    }
+  exec_pool_job_destroy(job);
+  if (sess)
+    broker_finish_deferred(b, (uint32_t)idx, q_res);
+  else
+    qr_destroy(q_res);
+}
 
-    active_idx =
-        sessions_add_from_pending(b->active_sessions, &pending, &active_sess);
-    if (active_idx == UINT32_MAX || !active_sess) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
+/* Drains every completed worker job and delivers its result to the owning
+ * session.
+ * Side effects: consumes the completion-notification pipe, checks finished
+ * connections back into the pool, dispatches parked waiters, writes response
+ * frames, and may drop or idle sessions.
+ * Error semantics: none (fail-soft; orphaned jobs are discarded).
+ */
+/* Retains the serialized response of one completed exec job in the result
+ * cache, but only when its profile opted in (job->cache_ttl_ms > 0) and the
+ * reply is self-contained: truncated or spilled results point at
+ * session-bound pagination state, and token columns only resolve in the
+ * minting session's store.
+ * It borrows all inputs.
+ * Error semantics: fail-soft; an uncacheable or unserializable result is
+ * simply not retained.
+ */
+/* Routes one completed fan-out sub-job into its ticket. The pooled
+ * connection is already checked back in by the caller. When the last pending
+ * sub-job lands, the ticket is unlinked, merged into one reply, and
+ * delivered to the owning session (which may drop or idle it).
+ * It takes ownership of 'job'.
+ */
+static void broker_handle_fanout_completion(Broker *b, BrokerFanout *fan,
+                                            ExecPoolJob *job) {
+  QueryResult *q_res = job->result;
+  job->result = NULL;
+  if (q_res && q_res->exec_ms == 0) {
+    uint64_t t1 = now_ms_monotonic();
+    q_res->exec_ms = (t1 >= job->submitted_ms) ? (t1 - job->submitted_ms) : 0;
+  }
+
+  for (uint32_t i = 0; i < fan->n_entries; i++) {
+    BrokerFanoutEntry *e = &fan->entries[i];
+    if (!e->res && job->conn_name && strcmp(e->conn, job->conn_name) == 0) {
+      e->res = q_res;
+      q_res = NULL;
+      break;
     }
-    memcpy(active_sess->resume_token, out_token, RESUME_TOKEN_LEN);
-    active_sess->generation = idle_sess->generation;
-    active_sess->arena = idle_sess->arena;
-    active_sess->db_stores = idle_sess->db_stores;
-    active_sess->created_at = resume_created_at;
-    active_sess->last_active = now;
+  }
+  qr_destroy(q_res); // unmatched completions cannot happen; stay leak-free
+  exec_pool_job_destroy(job);
 
-    // idle session lost owenership of these entities
-    idle_sess->arena = (Arena){0};
-    idle_sess->db_stores = NULL;
+  if (fan->n_pending > 0)
+    fan->n_pending--;
+  if (fan->n_pending > 0)
+    return;
 
-    // Remove stale idle record.
-    parr_drop_swap(b->idle_sessions, (uint32_t)idle_idx);
-    status = HS_OK;
-  } else {
-    // New session
-    if (MAX_CLIENTS > 0 && parr_len(b->active_sessions) >= MAX_CLIENTS) {
-      status = HS_ERR_FULL;
-      goto send_n_close;
+  for (BrokerFanout **link = &b->fanouts; *link; link = &(*link)->next) {
+    if (*link == fan) {
+      *link = fan->next;
+      break;
     }
+  }
+  QueryResult *merged = broker_fanout_merge(fan);
+  uint64_t serial = fan->serial;
+  broker_fanout_free(fan);
+
+  ssize_t idx = broker_find_active_by_serial(b->active_sessions, serial);
+  if (idx >= 0)
+    broker_finish_deferred(b, (uint32_t)idx, merged);
+  else
+    qr_destroy(merged);
+}
 
-    if (parr_len(b->idle_sessions) >= MAX_IDLE_SESSIONS &&
-        broker_reap_one_idle_session(b->idle_sessions) != OK) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
-    }
+static void broker_result_cache_put(Broker *b, const ExecPoolJob *job,
+                                    const QueryResult *q_res) {
+  if (!b || !job || job->cache_ttl_ms == 0 || !job->conn_name || !job->sql)
+    return;
+  if (!q_res || q_res->status != QR_OK)
+    return;
+  if (q_res->result_truncated || q_res->spill || q_res->spilled_rows > 0)
+    return;
+  for (uint32_t c = 0; c < q_res->ncols; c++) {
+    if (q_res->cols && q_res->cols[c].value_type == QRCOL_V_TOKEN)
+      return;
+  }
 
-    if (fill_random(out_token, RESUME_TOKEN_LEN) != OK) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
-    }
+  char *json = NULL;
+  size_t json_len = 0;
+  if (qr_to_jsonrpc_result(q_res, &json, &json_len) != OK)
+    return;
+  result_cache_put(b->result_cache, job->conn_name, job->sql, q_res->columnar,
+                   job->cache_ttl_ms, json, json_len);
+  free(json);
+}
 
-    active_idx =
-        sessions_add_from_pending(b->active_sessions, &pending, &active_sess);
-    if (active_idx == UINT32_MAX || !active_sess) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
+static void broker_handle_completions(Broker *b) {
+  // Drain the wakeup bytes first; the fd is non-blocking.
+  uint8_t sink[64];
+  while (read(exec_pool_done_fd(b->exec_pool), sink, sizeof(sink)) > 0) {
+  }
+
+  ExecPoolJob *job;
+  while ((job = exec_pool_pop_done(b->exec_pool)) != NULL) {
+    // Cursor jobs settle their pinned connection themselves.
+    if (job->cursor_op != EXEC_CURSOR_NONE) {
+      broker_handle_cursor_completion(b, job);
+      continue;
     }
-    memcpy(active_sess->resume_token, out_token, RESUME_TOKEN_LEN);
-    active_sess->generation = 0;
-    if (broker_session_token_state_init(active_sess) != OK) {
-      status = HS_ERR_INTERNAL;
-      goto send_n_close;
+
+    // Return the pooled connection first so parked waiters can claim it.
+    char freed_conn[CONN_NAME_MAX_LEN + 1] = {0};
+    if (job->db && job->conn_name) {
+      connm_checkin(b->cm, job->conn_name, job->db);
+      snprintf(freed_conn, sizeof(freed_conn), "%s", job->conn_name);
     }
-    active_sess->created_at = now;
-    active_sess->last_active = now;
-    status = HS_OK;
-  }
 
-send_n_close: {
-  BrokerMcpSession *resp_sess =
-      (active_idx != UINT32_MAX && active_sess) ? active_sess : &pending;
-  const uint8_t *resp_token = (status == HS_OK) ? out_token : NULL;
-  if (broker_write_handshake_resp(resp_sess, status, resp_token,
-                                  b->idle_ttl_secs, b->abs_ttl_secs) != OK) {
-    // close whichever session object owns the channel at this point
-    if (active_idx != UINT32_MAX) {
-      parr_drop_swap(b->active_sessions, active_idx);
+    uint64_t serial = job->session_serial;
+    BrokerFanout *fan = broker_fanout_find(b, serial);
+    ssize_t idx = fan ? -1
+                      : broker_find_active_by_serial(b->active_sessions,
+                                                     serial);
+    if (fan) {
+      // Fan-out sub-jobs aggregate into their ticket; the merged reply goes
+      // out once the last one lands.
+      broker_handle_fanout_completion(b, fan, job);
+    } else if (idx < 0) {
+      // Session is gone (should not happen while pinned, but stay safe).
+      // Background schema refreshes land here by design (sentinel serial 0):
+      // their only consumer is the cache. Followers of a departed session's
+      // flight still get their answers.
+      if (job->describe && job->result && job->result->status == QR_OK &&
+          !job->result->result_truncated)
+        (void)schema_cache_put(b->schema_cache, job->conn_name, job->result);
+      broker_flight_resolve(b, serial, job->result);
+      exec_pool_job_destroy(job);
     } else {
-      bufch_clean(&pending.bc);
-      pending.fd = -1;
+      QueryResult *q_res = job->result;
+      job->result = NULL;
+      if (q_res && q_res->exec_ms == 0) {
+        uint64_t t1 = now_ms_monotonic();
+        q_res->exec_ms =
+            (t1 >= job->submitted_ms) ? (t1 - job->submitted_ms) : 0;
+      }
+      if (q_res)
+        q_res->columnar = job->columnar; // workers never set the output shape
+      if (q_res && q_res->status == QR_OK) {
+        // Each successful query replaces the session's pageable overflow;
+        // spilled_rows stays on q_res so the reply advertises the spill.
+        BrokerMcpSession *sess = parr_at(b->active_sessions, (uint32_t)idx);
+        if (sess) {
+          rspill_destroy(sess->spill);
+          sess->spill = q_res->spill;
+          q_res->spill = NULL;
+        }
+      }
+      // Describe fetches warm the schema cache on their way out, so the
+      // next describe on this connection answers from memory.
+      if (job->describe && q_res && q_res->status == QR_OK &&
+          !q_res->result_truncated)
+        (void)schema_cache_put(b->schema_cache, job->conn_name, q_res);
+      broker_result_cache_put(b, job, q_res);
+      exec_pool_job_destroy(job);
+      // Fan the result out to single-flight followers first; delivering can
+      // swap session slots, so re-find the leader before answering it.
+      broker_flight_resolve(b, serial, q_res);
+      idx = broker_find_active_by_serial(b->active_sessions, serial);
+      if (idx >= 0)
+        broker_finish_deferred(b, (uint32_t)idx, q_res);
+      else
+        qr_destroy(q_res);
     }
+
+    if (freed_conn[0] != '\0')
+      broker_dispatch_waiters(b, freed_conn);
+  }
+}
+
+/* Returns YES when any active session holds a partial request frame, NO
+ * otherwise, ERR on invalid input. */
+static AdbxTriStatus broker_any_partial_frame(const Broker *b) {
+  if (!b)
     return ERR;
+
+  size_t n = parr_len(b->active_sessions);
+  for (size_t i = 0; i < n; i++) {
+    const BrokerMcpSession *sess =
+        (const BrokerMcpSession *)parr_cat(b->active_sessions, (uint32_t)i);
+    if (sess && sess->frame_started_at > 0)
+      return YES;
   }
+  return NO;
 }
 
-  if (status != HS_OK) {
-    if (active_idx != UINT32_MAX) {
-      parr_drop_swap(b->active_sessions, active_idx);
-    } else {
-      bufch_clean(&pending.bc);
-      pending.fd = -1;
+/* Drops active sessions whose partial request frame stalled past the request
+ * read timeout. Dropped sessions are not resumable.
+ * Side effects: may remove sessions from the active array.
+ */
+static void broker_drop_stalled_sessions(Broker *b) {
+  if (!b)
+    return;
+
+  time_t now = time(NULL);
+  size_t n = parr_len(b->active_sessions);
+  for (size_t i = 0; i < n; /* increment inside */) {
+    BrokerMcpSession *sess = parr_at(b->active_sessions, (uint32_t)i);
+    if (sess && !sess->busy && sess->frame_started_at > 0 &&
+        (now - sess->frame_started_at) > REQUEST_READ_TIMEOUT_SEC) {
+      TLOG("ERROR - drop client fd=%d: request frame stalled", sess->fd);
+      parr_drop_swap(b->active_sessions, (uint32_t)i);
+      n--;
+      continue;
     }
-    return ERR;
+    i++;
   }
+}
 
-  // Keep bounded read timeouts after handshake too, so malformed/truncated
-  // request frames cannot stall broker_run() indefinitely.
-  if (broker_set_rcv_timeout_sec(active_sess->fd, REQUEST_READ_TIMEOUT_SEC) !=
-      OK) {
-    parr_drop_swap(b->active_sessions, active_idx);
+/* Runs the broker event loop.
+ * It borrows and mutates Broker-owned session arrays and network descriptors.
+ * Side effects: blocks waiting for I/O readiness, performs handshake
+ * enforcement, and processes client tool requests for many sessions
+ * concurrently.
+ * Returns OK on clean stop (not currently reachable), ERR on fatal loop-level
+ * failure.
+ */
+/* Set by the SIGHUP handler; the event loop applies the reload at its next
+ * safe point, once no session or profile pointer is borrowed. */
+static volatile sig_atomic_t g_reload_pending = 0;
+
+static void broker_on_sighup(int sig) {
+  (void)sig;
+  g_reload_pending = 1;
+}
+
+AdbxStatus broker_enable_hot_reload(Broker *b, const char *config_path) {
+  if (!b || !config_path || config_path[0] == '\0')
     return ERR;
+  size_t len = strlen(config_path);
+  char *copy = xmalloc(len + 1);
+  memcpy(copy, config_path, len + 1);
+  free(b->reload_config_path);
+  b->reload_config_path = copy;
+  return OK;
+}
+
+/* Re-keys one session's token stores after a catalog reload. Store slots are
+ * addressed by ConnProfile.catalog_idx, which the new catalog may have
+ * reassigned, and each store borrows its connection-name string from the
+ * catalog that minted it. Stores whose connection survived move to their new
+ * index and are re-pointed at the new catalog's storage; stores for removed
+ * connections are destroyed (their handles could never execute again — the
+ * manager vetoes the reload while such a connection still runs a job).
+ * It borrows 'old_cat', which must still be alive.
+ */
+static void broker_remap_session_stores(BrokerMcpSession *sess,
+                                        const ConnCatalog *old_cat,
+                                        const ConnProfile *const *new_profiles,
+                                        size_t n_new) {
+  if (!sess || !sess->db_stores || !old_cat)
+    return;
+  uint32_t n_old = parr_len(sess->db_stores);
+  if (n_old == 0)
+    return;
+
+  PackedArray *fresh = parr_create(sizeof(DbTokenStore *));
+  if (fresh)
+    parr_set_cleanup(fresh, broker_db_store_cleanup, NULL);
+
+  for (uint32_t i = 0; i < n_old; i++) {
+    DbTokenStore **slot = (DbTokenStore **)parr_at(sess->db_stores, i);
+    if (!slot || !*slot)
+      continue;
+
+    const ConnProfile *np = NULL;
+    if ((size_t)i < old_cat->n_profiles) {
+      const char *name = old_cat->profiles[i].connection_name;
+      for (size_t j = 0; j < n_new; j++) {
+        if (strcmp(new_profiles[j]->connection_name, name) == 0) {
+          np = new_profiles[j];
+          break;
+        }
+      }
+    }
+
+    int placed = 0;
+    if (fresh && np && stok_store_rebind(*slot, np) == OK) {
+      while (parr_len(fresh) <= np->catalog_idx) {
+        DbTokenStore **ns = NULL;
+        if (parr_emplace(fresh, (void **)&ns) == UINT32_MAX || !ns)
+          break;
+        *ns = NULL;
+      }
+      DbTokenStore **dst = (DbTokenStore **)parr_at(fresh, np->catalog_idx);
+      if (dst) {
+        *dst = *slot;
+        placed = 1;
+      }
+    }
+    if (!placed)
+      stok_store_destroy(*slot);
+    *slot = NULL;
   }
 
-  TLOG("INFO - accepted MCP client fd=%d", active_sess->fd);
-  return OK;
+  if (fresh) {
+    parr_destroy(sess->db_stores);
+    sess->db_stores = fresh;
+  } else {
+    // No safe mapping without the new array; every store was dropped above.
+    parr_reset(sess->db_stores);
+  }
 }
 
-/* Serializes one QueryResult as JSON-RPC and writes one length-prefixed frame.
- * It borrows 'sess' and 'q_res'.
- * Side effects: writes to the client channel.
- * Returns OK on successful encode/write, ERR on invalid input or write failure.
+/* Applies one SIGHUP-requested catalog reload: re-parses the config through
+ * conn_catalog.c, lets ConnManager keep warm backends for unchanged profiles
+ * (see connm_apply_catalog()), re-keys every session's token stores, and
+ * drops the plan/result caches whose entries may reflect retired policies.
+ * Live sessions, their tokens, and untouched connections survive. Fail-soft:
+ * a parse failure or a busy changed profile leaves the old catalog in place;
+ * ops can fix the config or simply send SIGHUP again.
+ * Side effects: may destroy idle backends and the validation/replay caches.
  */
-static AdbxStatus broker_write_q_res(BrokerMcpSession *sess,
-                                     const QueryResult *q_res) {
-  if (!q_res || !sess)
-    return ERR;
+static void broker_reload_catalog(Broker *b) {
+  if (!b || !b->reload_config_path)
+    return;
 
-  size_t response_len;
-  char *response;
-  AdbxStatus rc;
-  if (qr_to_jsonrpc(q_res, &response, &response_len) != OK) {
-    rc = ERR;
-    goto clean_n_ret;
+  int fd = open(b->reload_config_path, O_RDONLY);
+  if (fd < 0) {
+    TLOG("ERROR - catalog reload: cannot open %s", b->reload_config_path);
+    alog_write("Broker: catalog reload failed (config unreadable)");
+    return;
   }
+  char *err = NULL;
+  ConnCatalog *fresh = catalog_load_cached(fd, b->reload_config_path, &err);
+  safe_close_fd(&fd);
+  if (!fresh) {
+    TLOG("ERROR - catalog reload rejected: %s", err ? err : "unknown error");
+    alog_write("Broker: catalog reload rejected (parse/validation failed)");
+    free(err);
+    return;
+  }
+  free(err);
 
-  if (response_len > UINT32_MAX) {
-    rc = ERR;
-    goto clean_n_ret;
+  ConnCatalog *old = NULL;
+  if (connm_apply_catalog(b->cm, fresh, &old) != OK) {
+    catalog_destroy(fresh);
+    alog_write("Broker: catalog reload deferred (changed profile busy); "
+               "send SIGHUP again once in-flight work drains");
+    return;
   }
-  rc = frame_write_len(&sess->bc, response, (uint32_t)response_len);
 
-clean_n_ret:
-  free(response);
-  return rc;
+  // Re-key every session's token stores against the new catalog before the
+  // old one (whose strings the stores borrow) goes away.
+  size_t n_new = connm_list_profiles(b->cm, NULL, 0);
+  const ConnProfile **profs = NULL;
+  if (n_new > 0) {
+    profs = (const ConnProfile **)xmalloc(n_new * sizeof(*profs));
+    n_new = connm_list_profiles(b->cm, profs, n_new);
+  }
+  for (uint32_t i = 0; i < parr_len(b->active_sessions); i++) {
+    broker_remap_session_stores(
+        (BrokerMcpSession *)parr_at(b->active_sessions, i), old, profs, n_new);
+  }
+  for (uint32_t i = 0; i < parr_len(b->idle_sessions); i++) {
+    broker_remap_session_stores(
+        (BrokerMcpSession *)parr_at(b->idle_sessions, i), old, profs, n_new);
+  }
+  free(profs);
+  catalog_destroy(old);
+
+  // Cached plans and replayable responses were produced under the retired
+  // catalog's policies; drop both caches rather than diffing entries. The
+  // shared col-ref base pool stays: layered store pools fall back to their
+  // own storage for identifiers the frozen base misses.
+  plan_cache_destroy(b->plan_cache);
+  b->plan_cache = plan_cache_create(PLAN_CACHE_CAPACITY);
+  result_cache_destroy(b->result_cache);
+  b->result_cache = result_cache_create(RESULT_CACHE_CAPACITY);
+  // Schema snapshots may describe databases the reloaded names no longer
+  // point at; drop them all and let describe re-warm lazily.
+  schema_cache_reset(b->schema_cache);
+
+  TLOG("INFO - catalog reloaded: %zu profiles", n_new);
+  alog_write("Broker: catalog reloaded");
+}
+
+#if defined(__SANITIZE_ADDRESS__)
+void __asan_handle_no_return(void);
+#endif
+
+/* Cancellation cleanup for broker_run(). pthread_cancel's forced unwind
+ * skips instrumented function epilogues, so ASan stack redzones of the
+ * unwound frames stay poisoned when the thread exits and libc's teardown
+ * reuses those addresses; wipe the thread's stack poison so shutdown via
+ * cancel (as the tests do) does not trip the sanitizer. No-op in normal
+ * builds. */
+static void broker_run_cancel_cleanup(void *arg) {
+  (void)arg;
+#if defined(__SANITIZE_ADDRESS__)
+  __asan_handle_no_return();
+#endif
+}
+
+/* Installs the SIGHUP catalog-reload handler. No SA_RESTART: the signal must
+ * interrupt the wait so the reload is applied promptly (broker_wait_events
+ * treats EINTR as zero events). */
+static void broker_install_sighup_handler(void) {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = broker_on_sighup;
+  sigemptyset(&sa.sa_mask);
+  (void)sigaction(SIGHUP, &sa, NULL);
 }
 
-/* Runs the broker event loop.
- * It borrows and mutates Broker-owned session arrays and network descriptors.
- * Side effects: blocks in poll/accept/read/write, performs handshake
- * enforcement, and processes client tool requests.
- * Returns OK on clean stop (not currently reachable), ERR on fatal loop-level
- * failure.
- */
 AdbxStatus broker_run(Broker *b) {
   if (!b)
     return ERR;
 
-  struct pollfd pfds[MAX_CLIENTS + 1];
+  if (b->reload_config_path)
+    broker_install_sighup_handler();
 
-  for (;;) {
-    // pollfd array: 1 for listen + up to max_clients active fds
-    size_t nsessions = parr_len(b->active_sessions);
-    size_t nfds = 1 + nsessions;
-
-    // we reset the memory of pfds to be defensive
-    memset(pfds, 0, nfds * sizeof(*pfds));
+  BrokerIoEvent *evs = b->io_evs;
+  AdbxStatus run_rc = OK;
 
-    // poll slot 0th = server socket
-    pfds[0].fd = b->listen_fd;
-    pfds[0].events = POLLIN;
+  // The handler runs if the owner cancels this thread mid-loop; returns must
+  // not cross the push/pop pair, so wait failures break out instead.
+  pthread_cleanup_push(broker_run_cancel_cleanup, NULL);
 
-    for (size_t i = 0; i < nsessions; i++) {
-      BrokerMcpSession *sess = parr_at(b->active_sessions, (uint32_t)i);
-      if (!sess)
-        continue;
-      pfds[1 + i].fd = sess->fd;
-      pfds[1 + i].events = POLLIN;
-      // revents is already 0 since memset above
+  for (;;) {
+    // Wake periodically only while a partial frame or a mid-handshake
+    // connection needs deadline tracking.
+    int timeout_ms = (broker_any_partial_frame(b) == YES ||
+                      b->pending_hs_len > 0)
+                         ? PARTIAL_FRAME_TICK_MS
+                         : -1;
+    int nevs = broker_wait_events(b, evs, BROKER_WAIT_SLOTS, timeout_ms);
+    if (nevs < 0) {
+      run_rc = ERR;
+      break;
     }
 
-    int rc = poll(pfds, nfds, -1);
-    if (rc < 0) {
-      if (errno == EINTR) {
+    int accept_ready = 0;
+    for (int e = 0; e < nevs; e++) {
+      if (evs[e].fd == b->listen_fd) {
+        // handled after session I/O to avoid transient HS_ERR_FULL when an
+        // active client disconnected in the same wait cycle
+        accept_ready = 1;
         continue;
       }
-      return -1;
-    }
 
-    // Handle client I/O for the sessions we polled this iteration.
-    for (size_t i = 0; i < nsessions; /* increment inside */) {
-      struct pollfd *pfd = &pfds[1 + i];
+      if (evs[e].fd == exec_pool_done_fd(b->exec_pool)) {
+        broker_handle_completions(b);
+        continue;
+      }
 
-      // we don't increament 'i' when removing a session because the array
-      // squash the next structures and fills the empty slot of the
-      // removed session
-      if (pfd->revents & (POLLHUP | POLLERR | POLLNVAL)) {
-        session_move_to_idle(b->active_sessions, b->idle_sessions, (uint32_t)i);
-        nsessions--;
+      ssize_t hs_idx = broker_find_pending_hs(b, evs[e].fd);
+      if (hs_idx >= 0) {
+        broker_pending_hs_on_readable(b, (uint32_t)hs_idx, evs[e].is_err);
         continue;
       }
 
-      if (pfd->revents & POLLIN) {
-        BrokerMcpSession *sess = parr_at(b->active_sessions, (uint32_t)i);
-
-        StrBuf req;
-        sb_init(&req);
-        QueryResult *q_res = NULL;
-        uint64_t t0 = now_ms_monotonic();
-        AdbxStatus rr = frame_read_len(&sess->bc, &req);
-        if (rr != OK || req.len > MAX_REQ_LEN) {
-          // framing error -> drop client
-          TLOG("ERROR - drop client: frame_read_len rc=%d len=%zu", rr,
-               req.len);
-          sb_clean(&req);
-          parr_drop_swap(b->active_sessions, (uint32_t)i);
-          nsessions--;
-          continue;
-        }
-        TLOG("INFO - received request len=%zu", req.len);
-
-        if (req.len > MAX_REQ_LEN) {
-          char buf[128];
-          snprintf(buf, sizeof(buf),
-                   "Request too large: received %zu bytes; maximum allowed is "
-                   "%d bytes.",
-                   req.len, MAX_REQ_LEN);
-          McpId id = {0};
-          mcp_id_init_u32(&id, 0);
-          q_res = qr_create_err(&id, QRERR_INREQ, "%s", buf);
-          goto send_q_res;
+      ssize_t idx = broker_find_active_by_fd(b->active_sessions, evs[e].fd);
+      if (idx < 0)
+        continue; // session was already removed in this event batch
+
+      if (evs[e].is_err) {
+        BrokerMcpSession *sess = parr_at(b->active_sessions, (uint32_t)idx);
+        if (sess && sess->busy) {
+          // The in-flight job pins the slot; retire it after the completion.
+          sess->defunct = 1;
+          broker_session_mute_reads(b, sess);
+        } else {
+          session_move_to_idle(b, (uint32_t)idx);
         }
+        continue;
+      }
 
-        AdbxStatus hr =
-            broker_handle_request(b, sess, req.data, req.len, &q_res);
+      broker_session_on_readable(b, (uint32_t)idx);
+    }
 
-        if (hr != OK) {
-          // Something bad happend, drop client
-          fprintf(stderr, "Broker: request handling failed\n");
-          sb_clean(&req);
-          parr_drop_swap(b->active_sessions, (uint32_t)i);
-          nsessions--;
-          continue;
-        }
+    broker_drop_stalled_sessions(b);
+    broker_drop_stalled_handshakes(b);
 
-        // Send response frame
-      send_q_res:
-        if (q_res && q_res->exec_ms == 0) {
-          uint64_t t1 = now_ms_monotonic();
-          q_res->exec_ms = (t1 >= t0) ? (t1 - t0) : 0;
-        }
-        if (broker_write_q_res(sess, q_res) != OK) {
-          fprintf(stderr, "Broker: failed to write response\n");
-          TLOG("ERROR - drop client: failed to write response");
-          sb_clean(&req);
-          qr_destroy(q_res);
-          parr_drop_swap(b->active_sessions, (uint32_t)i);
-          nsessions--;
-          continue;
-        }
+    if (accept_ready)
+      broker_accept_burst(b);
 
-        sb_clean(&req);
-        qr_destroy(q_res);
-      }
+    // Hand connections freed by cursor closes to their parked waiters now
+    // that no session pointer from this iteration is still borrowed.
+    broker_run_deferred_dispatch(b);
 
-      i++;
+    // Apply a SIGHUP-requested catalog reload at the same safe point: no
+    // session, profile, or store pointer from this iteration is borrowed.
+    if (g_reload_pending) {
+      g_reload_pending = 0;
+      broker_reload_catalog(b);
     }
 
-    // Accept one queued client after processing session events. This avoids
-    // transient HS_ERR_FULL when an active client disconnected in the same poll
-    // cycle.
-    if (pfds[0].revents & POLLIN) {
-      for (;;) {
-        int cfd = accept(b->listen_fd, NULL, NULL);
-        if (cfd < 0) {
-          if (errno == EINTR)
-            continue;
-          // accept error; keep running
-          break;
-        }
-        if (broker_do_handshake(b, cfd) != OK) {
-          TLOG("INFO - rejected client fd=%d during handshake", cfd);
-        }
-        break;
-        // TODO: For now we accept one at a time; loop accepts multiple
-        // if queued
-      }
-    }
+    // Release arenas and token stores held by idle sessions whose TTL
+    // passed; a heap-head peek when nothing expired.
+    broker_expire_idle_sessions(b);
   }
 
-  // TODO: create a signal to let Broker gracefully exit
-  /* unreachable for now. */
-  /* return 0; */
+  pthread_cleanup_pop(0);
+
+  // TODO: create a signal to let Broker gracefully exit; today only a wait
+  // failure or a cancel ends the loop.
+  return run_rc;
 }
@@ -11,9 +11,10 @@
 #include "handshake_codec.h"
 #include "private_dir.h"
 
-// TODO: we should be able to accept more than 1 McpServer with just one Broker.
-// We should make the code async, and use a real connection pool.
-#define MAX_CLIENTS 1
+// Upper bound of concurrently served MCP sessions. The broker multiplexes all
+// of them on one event loop (epoll on Linux, poll elsewhere); query execution
+// runs on a worker pool against pooled per-profile connections.
+#define MAX_CLIENTS 32
 #define MAX_IDLE_SESSIONS (MAX_CLIENTS * 2)
 
 /* The entity is responsible for connecting to databases and running the
@@ -36,4 +37,16 @@ Broker *broker_create(const PrivDir *pd, ConnManager *cm);
 /* Frees 'b' and its owned entities. */
 void broker_destroy(Broker *b);
 
+/* Arms SIGHUP-triggered catalog reloads: broker_run() installs a SIGHUP
+ * handler and, at the next safe point of the loop, re-reads 'config_path'
+ * and swaps the connection catalog in place (see connm_apply_catalog()).
+ * Live sessions, their token stores, and warm connections for unchanged
+ * profiles survive the swap; a rejected config leaves the old one running.
+ *
+ * Ownership: copies 'config_path'; the copy is freed by broker_destroy().
+ * Error semantics: returns OK on success, ERR on bad input or when called
+ * with an empty path.
+ */
+AdbxStatus broker_enable_hot_reload(Broker *b, const char *config_path);
+
 #endif
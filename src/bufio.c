@@ -8,6 +8,12 @@
 #ifndef BUFIO_READ_CHUNK
 #define BUFIO_READ_CHUNK BUFSIZ
 #endif
+// Ceiling the adaptive per-fill read size may grow to under sustained load.
+#ifndef BUFIO_READ_CHUNK_MAX
+#define BUFIO_READ_CHUNK_MAX (256u * 1024u)
+#endif
+// Consecutive short fills before the read size decays one halving step.
+#define BUFIO_QUIET_FILLS_DECAY 16u
 
 AdbxStatus bufch_init(BufChannel *bc, ByteChannel *ch) {
   if (!bc || !ch)
@@ -16,6 +22,27 @@ AdbxStatus bufch_init(BufChannel *bc, ByteChannel *ch) {
   sb_init(&bc->buf);
   bc->rpos = 0;
   bc->eof = 0;
+  bc->read_chunk = BUFIO_READ_CHUNK;
+  bc->read_floor = BUFIO_READ_CHUNK;
+  bc->high_water = 0;
+  bc->quiet_fills = 0;
+  bc->shrink_pending = 0;
+  return OK;
+}
+
+AdbxStatus bufch_init_sized(BufChannel *bc, ByteChannel *ch,
+                            size_t read_hint) {
+  if (bufch_init(bc, ch) != OK)
+    return ERR;
+  if (read_hint < BUFIO_READ_CHUNK)
+    read_hint = BUFIO_READ_CHUNK;
+  if (read_hint > BUFIO_READ_CHUNK_MAX)
+    read_hint = BUFIO_READ_CHUNK_MAX;
+  bc->read_chunk = read_hint;
+  bc->read_floor = read_hint;
+  // Channels sized up-front skip the realloc ladder on their first frame.
+  if (sb_reserve(&bc->buf, read_hint) != OK)
+    return ERR;
   return OK;
 }
 
@@ -30,12 +57,29 @@ BufChannel *bufch_create(ByteChannel *ch) {
   return bc;
 }
 
+BufChannel *bufch_create_sized(ByteChannel *ch, size_t read_hint) {
+  if (!ch)
+    return NULL;
+  BufChannel *bc = (BufChannel *)xmalloc(sizeof(*bc));
+  if (bufch_init_sized(bc, ch, read_hint) != OK) {
+    sb_clean(&bc->buf);
+    free(bc);
+    return NULL;
+  }
+  return bc;
+}
+
 void bufch_clean(BufChannel *bc) {
   if (!bc)
     return;
   sb_clean(&bc->buf);
   bc->rpos = 0;
   bc->eof = 0;
+  bc->read_chunk = 0;
+  bc->read_floor = 0;
+  bc->high_water = 0;
+  bc->quiet_fills = 0;
+  bc->shrink_pending = 0;
   if (bc->ch) {
     bytech_destroy(bc->ch);
   }
@@ -57,7 +101,7 @@ static size_t bc_avail(const BufChannel *bc) {
 }
 
 // Discard buffered consumed bytes and compact internal buffer.
-// Called automatically by some operations.
+// Called only when appending would otherwise grow the allocation.
 static void bufch_compact(BufChannel *bc) {
   if (bc->rpos == 0)
     return;
@@ -84,22 +128,66 @@ static ssize_t bufch_fill(BufChannel *bc) {
   if (bc->eof)
     return 0;
 
-  // compacting heuristic to avoid unbounded growth.
-  // If we've consumed a lot, compact before appending
-  if (bc->rpos > 0 &&
-      (bc->rpos >= (bc->buf.cap / 2) || bc->rpos >= BUFIO_READ_CHUNK)) {
+  // Offset recycling keeps live bytes in place on the hot path: a fully
+  // drained buffer restarts at offset zero for free, and the consumed prefix
+  // is reclaimed (one memmove of only the unread tail) solely when the tail
+  // room ran out. Frame-at-a-time consumers hit the free reset on nearly
+  // every fill, so sustained large-frame traffic no longer shifts megabytes.
+  if (bc->rpos >= bc->buf.len) {
+    bc->buf.len = 0;
+    bc->rpos = 0;
+    if (bc->shrink_pending) {
+      // A quiet channel fully drained: release the allocation so one big
+      // frame does not pin its peak buffer forever; it regrows on demand.
+      bc->shrink_pending = 0;
+      // The high-water mark since the decay says what quiet traffic still
+      // needs; keep the buffer when it is not actually oversized for that.
+      if (bc->buf.cap > 2 * bc->read_chunk &&
+          bc->buf.cap > 2 * bc->high_water) {
+        sb_clean(&bc->buf);
+        sb_init(&bc->buf);
+      }
+    }
+  } else if (bc->rpos > 0 && bc->buf.cap - bc->buf.len < bc->read_chunk) {
+    // Compact before sb_reserve() so a realloc never copies dead bytes.
     bufch_compact(bc);
   }
 
-  uint8_t tmp[BUFIO_READ_CHUNK];
-
   // TODO: maybe for non-blocking we should handle EAGAIN and EWOULDBLOCK
 
-  ssize_t n = bytech_read_some(bc->ch, tmp, sizeof(tmp));
+  // Read straight into the buffer tail; no bounce buffer.
+  size_t old_len = bc->buf.len;
+  char *dst = NULL;
+  if (sb_prepare_for_write(&bc->buf, bc->read_chunk, &dst) != OK)
+    return -1;
+
+  ssize_t n = bytech_read_some(bc->ch, dst, bc->read_chunk);
+  bc->buf.len = old_len + ((n > 0) ? (size_t)n : 0);
   if (n > 0) {
-    if (sb_append_bytes(&bc->buf, tmp, (size_t)n) != OK) {
-      // Treat allocation failure as error
-      return -1;
+    if (bc->buf.len > bc->high_water)
+      bc->high_water = bc->buf.len;
+    if ((size_t)n == bc->read_chunk) {
+      // A full fill means the kernel had at least this much waiting; read
+      // bigger next time so sustained traffic takes fewer syscalls.
+      if (bc->read_chunk < BUFIO_READ_CHUNK_MAX) {
+        bc->read_chunk *= 2;
+        if (bc->read_chunk > BUFIO_READ_CHUNK_MAX)
+          bc->read_chunk = BUFIO_READ_CHUNK_MAX;
+      }
+      bc->quiet_fills = 0;
+    } else if ((size_t)n < bc->read_chunk / 2 &&
+               ++bc->quiet_fills >= BUFIO_QUIET_FILLS_DECAY) {
+      // The channel went quiet: step the read size back toward the floor
+      // and queue a buffer shrink for the next full drain, when no live
+      // bytes would need copying.
+      bc->quiet_fills = 0;
+      if (bc->read_chunk > bc->read_floor) {
+        bc->read_chunk /= 2;
+        if (bc->read_chunk < bc->read_floor)
+          bc->read_chunk = bc->read_floor;
+      }
+      bc->high_water = 0;
+      bc->shrink_pending = 1;
     }
     return n;
   }
@@ -114,6 +202,24 @@ static ssize_t bufch_fill(BufChannel *bc) {
 // TODO: for non-blocking sockets, ensure is blocking and may stall other
 // clients
 
+AdbxTriStatus bufch_fill_some(BufChannel *bc) {
+  if (!bc || !bc->ch)
+    return ERR;
+
+  ssize_t n = bufch_fill(bc);
+  if (n < 0)
+    return ERR;
+  if (n == 0)
+    return NO;
+  return YES;
+}
+
+AdbxTriStatus bufch_is_eof(const BufChannel *bc) {
+  if (!bc)
+    return ERR;
+  return bc->eof ? YES : NO;
+}
+
 AdbxTriStatus bufch_ensure(BufChannel *bc, size_t need) {
   while (bc_avail(bc) < need) {
     ssize_t n = bufch_fill(bc);
@@ -136,8 +242,9 @@ const uint8_t *bufch_peek(const BufChannel *bc, size_t *out_avail) {
   return (const uint8_t *)(bc->buf.data + bc->rpos);
 }
 
-// Consume 'n' bytes from the buffer (must be <= available).
-static void bufch_consume(BufChannel *bc, size_t n) {
+void bufch_consume(BufChannel *bc, size_t n) {
+  if (!bc)
+    return;
   size_t avail = bc_avail(bc);
   if (n > avail)
     n = avail; // defensive
@@ -188,6 +295,27 @@ ssize_t bufch_read_until(BufChannel *bc, void *dst, size_t max_n) {
   return (ssize_t)take;
 }
 
+/* memchr-accelerated needle scan over 'hay'. Candidate positions come from
+ * memchr on the first needle byte and only those pay a memcmp, so delimiter
+ * hunts over large buffers skip runs of non-matching bytes at libc speed
+ * instead of walking byte-by-byte.
+ * 'last_start' is the last valid match start offset (inclusive).
+ * Returns the match offset in [0..last_start], or -1 when absent. */
+static ssize_t bufio_scan_needle(const uint8_t *hay, size_t last_start,
+                                 const uint8_t *ndl, size_t needle_len) {
+  const uint8_t *p = hay;
+  const uint8_t *end = hay + last_start;
+  while (p <= end) {
+    const uint8_t *hit = memchr(p, ndl[0], (size_t)(end - p) + 1);
+    if (!hit)
+      return -1;
+    if (needle_len == 1 || memcmp(hit + 1, ndl + 1, needle_len - 1) == 0)
+      return (ssize_t)(hit - hay);
+    p = hit + 1;
+  }
+  return -1;
+}
+
 ssize_t bufch_findn(BufChannel *bc, const void *needle, size_t needle_len,
                     size_t max_dist) {
   if (!bc || !needle || needle_len == 0)
@@ -220,14 +348,7 @@ ssize_t bufch_findn(BufChannel *bc, const void *needle, size_t needle_len,
 
   const uint8_t *hay = (const uint8_t *)(bc->buf.data + bc->rpos);
   const uint8_t *ndl = (const uint8_t *)needle;
-
-  // Simple O(n*m) scan; for small delimiters like "\r\n\r\n" this is fine
-  for (size_t i = 0; i <= limit; i++) {
-    if (hay[i] == ndl[0] && memcmp(hay + i, ndl, needle_len) == 0) {
-      return i;
-    }
-  }
-  return -1;
+  return bufio_scan_needle(hay, limit, ndl, needle_len);
 }
 
 ssize_t bufch_find_buffered(const BufChannel *bc, const void *needle,
@@ -241,14 +362,7 @@ ssize_t bufch_find_buffered(const BufChannel *bc, const void *needle,
 
   const uint8_t *hay = (const uint8_t *)(bc->buf.data + bc->rpos);
   const uint8_t *ndl = (const uint8_t *)needle;
-
-  // Simple O(n*m) scan; for small delimiters like "\r\n\r\n" this is fine
-  for (size_t i = 0; i + needle_len <= avail; i++) {
-    if (hay[i] == ndl[0] && memcmp(hay + i, ndl, needle_len) == 0) {
-      return i;
-    }
-  }
-  return -1;
+  return bufio_scan_needle(hay, avail - needle_len, ndl, needle_len);
 }
 
 /* Writers 'n' bytes starting from 'src' to the underlying channel of 'bc' but
@@ -288,6 +402,59 @@ AdbxStatus bufch_write_all(BufChannel *bc, const void *src, size_t n) {
   return OK;
 }
 
+AdbxStatus bufch_writev_all(BufChannel *bc, ByteChannelVec *vecs,
+                            size_t nvecs) {
+  if (!bc || !bc->ch)
+    return ERR;
+  if (!vecs && nvecs != 0)
+    return ERR;
+  for (size_t v = 0; v < nvecs; v++) {
+    if (!vecs[v].base && vecs[v].len != 0)
+      return ERR;
+  }
+
+  size_t i = 0;
+  if (bc->ch->vt->writev_some) {
+    // Keep one writev within what the syscall accepts; bursts this large
+    // simply take another round through the loop.
+    const size_t max_vcnt = 1024;
+
+    while (i < nvecs) {
+      if (vecs[i].len == 0) {
+        i++;
+        continue;
+      }
+      size_t vcnt = nvecs - i;
+      if (vcnt > max_vcnt)
+        vcnt = max_vcnt;
+
+      ssize_t n = bytech_writev_some(bc->ch, &vecs[i], (int)vcnt);
+      if (n <= 0)
+        return ERR;
+
+      // Consume fully written vectors, then trim the partially written one.
+      size_t written = (size_t)n;
+      while (i < nvecs && written >= vecs[i].len) {
+        written -= vecs[i].len;
+        i++;
+      }
+      if (i < nvecs && written > 0) {
+        vecs[i].base = (const unsigned char *)vecs[i].base + written;
+        vecs[i].len -= written;
+      }
+    }
+  } else {
+    for (; i < nvecs; i++) {
+      if (bufch_write_all_no_flush(bc, vecs[i].base, vecs[i].len) != OK)
+        return ERR;
+    }
+  }
+
+  if (bytech_flush(bc->ch) != OK)
+    return ERR;
+  return OK;
+}
+
 AdbxStatus bufch_write2v(BufChannel *bc, const void *h, size_t hlen,
                          const void *p, size_t plen) {
   if (!bc || !bc->ch)
@@ -24,13 +24,31 @@ typedef struct BufChannel {
   StrBuf buf;      // read buffer
   size_t rpos;     // read position within buf.data [0..buf.len]
   int eof;         // sticky EOF flag (seen 0 from read_some)
+  // Adaptive per-fill read sizing: 'read_chunk' doubles toward the ceiling
+  // while fills come back full (the kernel had more waiting) and decays one
+  // halving step toward 'read_floor' after a run of short fills, so busy
+  // data channels batch big reads while quiet control channels stay small.
+  size_t read_chunk;      // current per-fill read size
+  size_t read_floor;      // lower bound 'read_chunk' decays back to
+  size_t high_water;      // largest buffered occupancy since the last decay
+  uint32_t quiet_fills;   // consecutive short fills since the last full one
+  uint8_t shrink_pending; // release an oversized buffer at the next drain
 } BufChannel;
 
 /* Initializes a BufChannel without allocating it. */
 AdbxStatus bufch_init(BufChannel *bc, ByteChannel *ch);
 
+/* Same as bufch_init but starts (and floors) the adaptive read size at
+ * 'read_hint' bytes, clamped to the built-in bounds, and pre-reserves the
+ * read buffer. Use for channels known to carry large frames so the first
+ * big reply skips the realloc ladder and never decays below the hint. */
+AdbxStatus bufch_init_sized(BufChannel *bc, ByteChannel *ch, size_t read_hint);
+
 BufChannel *bufch_create(ByteChannel *ch);
 
+/* Allocating variant of bufch_init_sized. */
+BufChannel *bufch_create_sized(ByteChannel *ch, size_t read_hint);
+
 /* cleanup and close/destroy ByteChannel */
 void bufch_clean(BufChannel *bc);
 
@@ -41,6 +59,18 @@ void bufch_destroy(BufChannel *bc);
 // Returns YES/NO/ERR, and sets EOF state if peer closes.
 AdbxTriStatus bufch_ensure(BufChannel *bc, size_t need);
 
+/* Performs exactly one read from the underlying channel and appends the bytes
+ * to the internal buffer. Unlike bufch_ensure this never loops, so on a
+ * readable descriptor it consumes only what the kernel already has.
+ * Side effects: may compact the buffer and sets the sticky EOF flag on EOF.
+ * Returns YES when bytes were appended, NO on EOF, ERR on read error.
+ */
+AdbxTriStatus bufch_fill_some(BufChannel *bc);
+
+/* Returns YES when the sticky EOF flag is set, NO otherwise, ERR on bad input.
+ * Buffered bytes may still be available to consume after EOF. */
+AdbxTriStatus bufch_is_eof(const BufChannel *bc);
+
 // Returns a pointer to available data buffered but not read and stores its
 // length inside 'out_val'. The returned pointer is valid until next
 // ensure/read. Returns NULL if there's nothing to peek.
@@ -48,6 +78,12 @@ AdbxTriStatus bufch_ensure(BufChannel *bc, size_t need);
 // mean it's EOF, call ensure for that.
 const uint8_t *bufch_peek(const BufChannel *bc, size_t *out_avail);
 
+/* Consumes 'n' already-buffered bytes without copying them (clamped to what
+ * is available). Use together with bufch_peek() for zero-copy reads; peek
+ * views of the not-yet-consumed tail stay valid until the next ensure/fill.
+ */
+void bufch_consume(BufChannel *bc, size_t n);
+
 /* Copies exactly 'n' bytes into 'dst', consuming them.
  * Ownership: borrows 'bc'; writes into caller-owned 'dst'.
  * Side effects: may read from underlying channel and advances buffered read
@@ -66,7 +102,8 @@ AdbxStatus bufch_read_exact(BufChannel *bc, void *dst, size_t n);
 ssize_t bufch_read_until(BufChannel *bc, void *dst, size_t max_n);
 
 // Finds a byte pattern in the buffered data. Returns index (offset from current
-// read position) if found, else -1. This is not efficient for long patterns.
+// read position) if found, else -1. Scans with memchr on the first needle byte,
+// so runs without candidate bytes skip at libc speed.
 ssize_t bufch_find_buffered(const BufChannel *bc, const void *needle,
                             size_t needle_len);
 // Finds a byte pattern within a bounded window and reads as needed to decide.
@@ -81,6 +118,15 @@ AdbxStatus bufch_write_all(BufChannel *bc, const void *src, size_t n);
 AdbxStatus bufch_write2v(BufChannel *bc, const void *h, size_t hlen,
                          const void *p, size_t plen);
 
+/* Writes every byte of 'vecs' with as few writev() calls as the channel
+ * allows, falling back to sequential writes when the channel lacks vector
+ * support, and flushes once at the end.
+ * It borrows 'bc' and mutates 'vecs' in place while consuming partial writes.
+ * Error semantics: returns OK when all bytes were written, ERR on invalid
+ * input or write failure (some bytes may already be on the wire then).
+ */
+AdbxStatus bufch_writev_all(BufChannel *bc, ByteChannelVec *vecs, size_t nvecs);
+
 /*---------------------------------- Helpers --------------------------------*/
 
 #include "stdio_byte_channel.h"
@@ -125,4 +171,20 @@ static inline AdbxStatus bufch_stdio_openfd_init(BufChannel *bufch, int in_fd,
 #define bufch_stdio_wrapfd_init(bufch, in_fd, out_fd)                          \
   bufch_init(bufch, stdio_bytechannel_wrap_fd(in_fd, out_fd))
 
+/* Sized variant of bufch_stdio_openfd_init for channels known to carry
+ * large frames; same ownership guarantees on init failure.
+ */
+static inline AdbxStatus bufch_stdio_openfd_init_sized(BufChannel *bufch,
+                                                       int in_fd, int out_fd,
+                                                       size_t read_hint) {
+  ByteChannel *ch = stdio_bytechannel_open_fd(in_fd, out_fd);
+  if (!ch)
+    return ERR;
+  if (bufch_init_sized(bufch, ch, read_hint) != OK) {
+    bytech_destroy(ch);
+    return ERR;
+  }
+  return OK;
+}
+
 #endif
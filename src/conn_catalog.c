@@ -1,6 +1,8 @@
 #include "conn_catalog.h"
 #include "file_io.h"
+#include "hash_table.h"
 #include "json_codec.h"
+#include "rapidhash.h"
 #include "string_op.h"
 #include "utils.h"
 
@@ -205,6 +207,61 @@ static AdbxStatus split_func_path(char *input, char **out_schema,
   return OK;
 }
 
+/* Hashes one ColumnRule by its (table, col) strings.
+ * It borrows 'key' and does not allocate memory.
+ * Error semantics: returns 0 for invalid input.
+ */
+static uint64_t colrule_hash(const void *key, void *ctx) {
+  (void)ctx;
+  const ColumnRule *r = (const ColumnRule *)key;
+  assert(r);
+  if (!r->table || !r->col)
+    return 0;
+  uint64_t seed = ht_hash_bytes(r->table, strlen(r->table));
+  return ht_hash_bytes_withSeed(r->col, strlen(r->col), seed);
+}
+
+/* Compares two ColumnRules by exact (table, col) content.
+ * It borrows both inputs and does not allocate memory.
+ * Error semantics: returns YES when equal, NO otherwise.
+ */
+static AdbxTriStatus colrule_eq(const void *a, const void *b, void *ctx) {
+  (void)ctx;
+  const ColumnRule *ra = (const ColumnRule *)a;
+  const ColumnRule *rb = (const ColumnRule *)b;
+  assert(ra);
+  assert(rb);
+  if (!ra->table || !ra->col || !rb->table || !rb->col)
+    return NO;
+  if (strcmp(ra->table, rb->table) != 0)
+    return NO;
+  return (strcmp(ra->col, rb->col) == 0) ? YES : NO;
+}
+
+/* Builds the (table, col) hash index over an already-populated rule array.
+ * It borrows 'pol'; index entries point into pol->rules.
+ * Side effects: allocates pol->index.
+ * Error semantics: best-effort; on failure pol->index stays NULL and
+ * connp_is_col_sensitive() falls back to bsearch over the sorted rules.
+ */
+static void colpolicy_build_index(ColumnPolicy *pol) {
+  if (!pol || !pol->rules || pol->n_rules == 0)
+    return;
+
+  HashTable *ht = ht_create_custom_with_capacity(pol->n_rules, colrule_hash,
+                                                 colrule_eq, NULL);
+  if (!ht)
+    return;
+  for (size_t i = 0; i < pol->n_rules; i++) {
+    ColumnRule *r = &pol->rules[i];
+    if (ht_put_custom(ht, r, r) != OK) {
+      ht_destroy(ht);
+      return;
+    }
+  }
+  pol->index = ht;
+}
+
 /* Parses sensitiveColumns into ColumnRules.
  * Business logic is documented in connp_is_col_sensitive().
  * Ownership: stores all strings and arrays in out->col_policy.arena.
@@ -386,6 +443,7 @@ static AdbxStatus parse_sensitive_columns(const JsonGetter *jg,
 
   out->col_policy.rules = rules;
   out->col_policy.n_rules = n_rules;
+  colpolicy_build_index(&out->col_policy);
 
   for (size_t i = 0; i < tmp_len; i++) {
     free(tmp[i].schema);
@@ -594,8 +652,16 @@ static AdbxStatus parse_policy(const JsonGetter *jg, SafetyPolicy *out,
   if (!jg || !out || !path_prefix)
     return ERR;
 
-  const char *const keys[] = {"readOnly", "statementTimeoutMs",
-                              "maxRowReturned", "maxPayloadKiloBytes",
+  const char *const keys[] = {"readOnly",
+                              "statementTimeoutMs",
+                              "maxRowReturned",
+                              "maxPayloadKiloBytes",
+                              "spillMaxKiloBytes",
+                              "resultCacheTtlSeconds",
+                              "maxEstimatedCost",
+                              "slowLogMs",
+                              "heavyStatementTimeoutMs",
+                              "heavyWorkMemKiloBytes",
                               "columnPolicy"};
   JsonStrSpan unknown = {0};
   if (jsget_top_level_validation(jg, NULL, keys, ARRLEN(keys), &unknown) !=
@@ -657,6 +723,71 @@ static AdbxStatus parse_policy(const JsonGetter *jg, SafetyPolicy *out,
     out->max_payload_bytes = max_payload_kb * 1024u;
   }
 
+  uint32_t spill_kb = 0;
+  AdbxTriStatus src = jsget_u32(jg, "spillMaxKiloBytes", &spill_kb);
+  if (src == ERR) {
+    set_parse_err(err_out, "%s.spillMaxKiloBytes: expected uint32.",
+                  path_prefix);
+    return ERR;
+  }
+  if (src == YES) {
+    if (spill_kb > (UINT32_MAX / 1024u)) {
+      set_parse_err(err_out, "%s.spillMaxKiloBytes: value too large.",
+                    path_prefix);
+      return ERR;
+    }
+    out->spill_max_bytes = spill_kb * 1024u;
+  }
+
+  uint32_t cache_ttl = 0;
+  AdbxTriStatus ttl_rc = jsget_u32(jg, "resultCacheTtlSeconds", &cache_ttl);
+  if (ttl_rc == ERR) {
+    set_parse_err(err_out, "%s.resultCacheTtlSeconds: expected uint32.",
+                  path_prefix);
+    return ERR;
+  }
+  if (ttl_rc == YES)
+    out->result_cache_ttl_secs = cache_ttl;
+
+  uint32_t max_cost = 0;
+  AdbxTriStatus cost_rc = jsget_u32(jg, "maxEstimatedCost", &max_cost);
+  if (cost_rc == ERR) {
+    set_parse_err(err_out, "%s.maxEstimatedCost: expected uint32.",
+                  path_prefix);
+    return ERR;
+  }
+  if (cost_rc == YES)
+    out->max_estimated_cost = max_cost;
+
+  uint32_t slow_ms = 0;
+  AdbxTriStatus slow_rc = jsget_u32(jg, "slowLogMs", &slow_ms);
+  if (slow_rc == ERR) {
+    set_parse_err(err_out, "%s.slowLogMs: expected uint32.", path_prefix);
+    return ERR;
+  }
+  if (slow_rc == YES)
+    out->slow_log_ms = slow_ms;
+
+  uint32_t heavy_ms = 0;
+  AdbxTriStatus heavy_rc = jsget_u32(jg, "heavyStatementTimeoutMs", &heavy_ms);
+  if (heavy_rc == ERR) {
+    set_parse_err(err_out, "%s.heavyStatementTimeoutMs: expected uint32.",
+                  path_prefix);
+    return ERR;
+  }
+  if (heavy_rc == YES)
+    out->heavy_statement_timeout_ms = heavy_ms;
+
+  uint32_t heavy_wm_kb = 0;
+  AdbxTriStatus hwm_rc = jsget_u32(jg, "heavyWorkMemKiloBytes", &heavy_wm_kb);
+  if (hwm_rc == ERR) {
+    set_parse_err(err_out, "%s.heavyWorkMemKiloBytes: expected uint32.",
+                  path_prefix);
+    return ERR;
+  }
+  if (hwm_rc == YES)
+    out->heavy_work_mem_kb = heavy_wm_kb;
+
   JsonGetter col = {0};
   AdbxTriStatus crc = jsget_object(jg, "columnPolicy", &col);
   if (crc == ERR) {
@@ -725,8 +856,11 @@ static void profile_clean(ConnProfile *p) {
   free((char *)p->db_name);
   free((char *)p->user);
   free((char *)p->options);
+  free((char *)p->replica_group);
   p->secret_ref.cred_namespace = NULL;
   p->secret_ref.connection_name = NULL;
+  ht_destroy(p->col_policy.index);
+  p->col_policy.index = NULL;
   arena_clean(&p->col_policy.arena);
   arena_clean(&p->safe_funcs.arena);
 }
@@ -780,9 +914,11 @@ static AdbxStatus parse_db_entry(ConnCatalog *cat, const JsonGetter *jg,
   snprintf(db_path, sizeof(db_path), "$.databases[%zu]", db_index);
 
   const char *const keys[] = {
-      "type",          "connectionName", "host",    "port",
-      "username",      "database",       "options", "sensitiveColumns",
-      "safeFunctions", "safetyPolicy"};
+      "type",          "connectionName", "host",
+      "port",          "username",       "database",
+      "options",       "sensitiveColumns", "safeFunctions",
+      "safetyPolicy",  "poolSize",       "connectTimeoutSeconds",
+      "preconnect",    "replicaGroup"};
   JsonStrSpan unknown = {0};
   AdbxTriStatus vrc =
       jsget_top_level_validation(jg, NULL, keys, ARRLEN(keys), &unknown);
@@ -827,6 +963,61 @@ static AdbxStatus parse_db_entry(ConnCatalog *cat, const JsonGetter *jg,
     goto error;
   }
 
+  uint32_t pool_size = 0;
+  AdbxTriStatus psrc = jsget_u32(jg, "poolSize", &pool_size);
+  if (psrc == ERR) {
+    set_parse_err(err_out, "%s.poolSize: expected uint32 when present.",
+                  db_path);
+    goto error;
+  }
+  if (psrc == YES && (pool_size == 0 || pool_size > CONN_POOL_SIZE_MAX)) {
+    set_parse_err(err_out, "%s.poolSize: must be between 1 and %u.", db_path,
+                  CONN_POOL_SIZE_MAX);
+    goto error;
+  }
+  if (psrc == NO)
+    pool_size = 0; // fall back to the connection manager default
+
+  uint32_t connect_timeout_secs = 0;
+  AdbxTriStatus ctrc =
+      jsget_u32(jg, "connectTimeoutSeconds", &connect_timeout_secs);
+  if (ctrc == ERR) {
+    set_parse_err(err_out,
+                  "%s.connectTimeoutSeconds: expected uint32 when present.",
+                  db_path);
+    goto error;
+  }
+  if (ctrc == NO)
+    connect_timeout_secs = 0; // fall back to the backend default
+
+  int preconnect = 0;
+  AdbxTriStatus pcrc = jsget_bool01(jg, "preconnect", &preconnect);
+  if (pcrc == ERR) {
+    set_parse_err(err_out, "%s.preconnect: expected boolean when present.",
+                  db_path);
+    goto error;
+  }
+  if (pcrc == NO)
+    preconnect = 0; // lazy connect stays the default
+
+  char *replica_group = NULL;
+  AdbxTriStatus rgrc = jsget_string_decode_alloc(jg, "replicaGroup",
+                                                 &replica_group);
+  if (rgrc == ERR) {
+    set_parse_err(err_out, "%s.replicaGroup: expected string when present.",
+                  db_path);
+    goto error;
+  }
+  if (rgrc == YES &&
+      (replica_group[0] == '\0' ||
+       strlen(replica_group) > CONN_NAME_MAX_LEN)) {
+    set_parse_err(err_out,
+                  "%s.replicaGroup: must be a non-empty string of at most %d "
+                  "bytes.",
+                  db_path, CONN_NAME_MAX_LEN);
+    goto error;
+  }
+
   if (jsget_string_decode_alloc(jg, "username", &user) != YES) {
     set_parse_err(err_out, "%s.username: expected string.", db_path);
     goto error;
@@ -854,9 +1045,13 @@ static AdbxStatus parse_db_entry(ConnCatalog *cat, const JsonGetter *jg,
   out->kind = DB_KIND_POSTGRES;
   out->host = host;
   out->port = (uint16_t)port;
+  out->pool_size = pool_size;
+  out->connect_timeout_secs = connect_timeout_secs;
+  out->preconnect = preconnect;
   out->db_name = db_name;
   out->user = user;
   out->options = options;
+  out->replica_group = replica_group;
 
   out->safe_policy = cat->policy;
   JsonGetter db_pol = {0};
@@ -871,6 +1066,8 @@ static AdbxStatus parse_db_entry(ConnCatalog *cat, const JsonGetter *jg,
     if (parse_policy(&db_pol, &out->safe_policy, sp_path, err_out) != OK)
       goto error;
   }
+  // Overrides are in; freeze the per-request policy bits.
+  safety_policy_compile(&out->safe_policy);
 
   if (parse_sensitive_columns(jg, out, db_path, err_out) != OK)
     goto error;
@@ -889,11 +1086,50 @@ error:
   out->host = NULL;
   out->options = NULL;
   out->user = NULL;
+  out->replica_group = NULL;
   memset(&out->col_policy, 0, sizeof(out->col_policy));
   memset(&out->safe_funcs, 0, sizeof(out->safe_funcs));
   return ERR;
 }
 
+/* Stamps group_leader_idx for every profile (the first member in catalog
+ * order leads its group) and rejects a replicaGroup tag that collides with a
+ * connectionName — the tag doubles as a logical connection name, so a
+ * collision would make routing ambiguous. Runs after the JSON parse and
+ * after a snapshot restore, like the catalog_idx stamping.
+ * Error semantics: returns OK on success, ERR on a collision (with an
+ * allocated message in '*err_out' when provided).
+ */
+static AdbxStatus catalog_stamp_replica_groups(ConnCatalog *cat,
+                                               char **err_out) {
+  for (size_t i = 0; i < cat->n_profiles; i++) {
+    ConnProfile *p = &cat->profiles[i];
+    p->group_leader_idx = (uint32_t)i;
+    if (!p->replica_group)
+      continue;
+
+    for (size_t j = 0; j < cat->n_profiles; j++) {
+      if (strcasecmp(cat->profiles[j].connection_name, p->replica_group) ==
+          0) {
+        set_parse_err(err_out,
+                      "$.databases: replicaGroup \"%s\" collides with a "
+                      "connectionName.",
+                      p->replica_group);
+        return ERR;
+      }
+    }
+
+    for (size_t j = 0; j < i; j++) {
+      const char *g = cat->profiles[j].replica_group;
+      if (g && strcmp(g, p->replica_group) == 0) {
+        p->group_leader_idx = cat->profiles[j].group_leader_idx;
+        break;
+      }
+    }
+  }
+  return OK;
+}
+
 /* Parses the "databases" array and allocates ConnProfile entries inside 'cat'.
  * Ownership: writes owned profile array into '*cat'.
  * Side effects: allocates heap memory for profiles and nested arenas.
@@ -941,6 +1177,7 @@ static AdbxStatus parse_databases(const JsonGetter *jg, ConnCatalog *cat,
 
     if (parse_db_entry(cat, &entry, &profiles[idx], idx, err_out) != OK)
       goto error;
+    profiles[idx].catalog_idx = (uint32_t)idx;
 
     // connectionName must be unique
     for (size_t j = 0; j < idx; j++) {
@@ -958,6 +1195,12 @@ static AdbxStatus parse_databases(const JsonGetter *jg, ConnCatalog *cat,
 
   cat->profiles = profiles;
   cat->n_profiles = idx;
+  if (catalog_stamp_replica_groups(cat, err_out) != OK) {
+    cat->profiles = NULL;
+    cat->n_profiles = 0;
+    n = idx; // free only the entries that were fully parsed
+    goto error;
+  }
   return OK;
 
 error:
@@ -1092,9 +1335,10 @@ ConnCatalog *catalog_load_from_fd(int fd, char **err_out) {
     return NULL;
   }
 
-  StrBuf sb;
-  sb_init(&sb);
-  if (fileio_sb_read_limit_fd(fd, CONFIG_MAX_BYTES, &sb) != OK) {
+  // Map instead of copying: the parser and its jsmn token spans work
+  // straight over the mapped file bytes for the life of this call.
+  FileMap map;
+  if (fileio_map_ro_fd(fd, CONFIG_MAX_BYTES, &map) != OK) {
     char *err_msg = NULL;
     set_parse_err(&err_msg,
                   "$: failed to read config file (check path and size limit).");
@@ -1106,8 +1350,573 @@ ConnCatalog *catalog_load_from_fd(int fd, char **err_out) {
     return NULL;
   }
 
-  ConnCatalog *cat = catalog_parse_config_bytes(sb.data, sb.len, err_out);
-  sb_clean(&sb);
+  ConnCatalog *cat =
+      catalog_parse_config_bytes((const char *)map.data, map.len, err_out);
+  fileio_map_clean(&map);
+  return cat;
+}
+
+/* --------------------------- binary snapshot ------------------------------
+ * catalog_load_cached() keeps a native-endian snapshot of the validated
+ * catalog next to the config file. The header carries the config file's
+ * identity (dev/ino/size/mtime) and a rapidhash of the body, so a stale,
+ * torn, or foreign snapshot is rejected up front and the load silently falls
+ * back to the JSON parse. Warm starts then rebuild the catalog from flat
+ * bytes over a read-only mapping instead of re-running the tokenizer and
+ * validation over the whole config.
+ */
+
+#define CATSNAP_MAGIC "adbxcat1"
+#define CATSNAP_MAGIC_LEN 8u
+#define CATSNAP_FORMAT 5u
+// magic + format u32 + five u64 identity fields + body hash u64 + body len u32
+#define CATSNAP_HEADER_LEN (CATSNAP_MAGIC_LEN + 4u + 5u * 8u + 8u + 4u)
+// Length marker encoding an absent optional string.
+#define CATSNAP_NULL_STR UINT32_MAX
+
+static AdbxStatus catsnap_put_u32(StrBuf *sb, uint32_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+static AdbxStatus catsnap_put_u64(StrBuf *sb, uint64_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+/* NULL encodes as CATSNAP_NULL_STR; otherwise u32 length plus raw bytes. */
+static AdbxStatus catsnap_put_str(StrBuf *sb, const char *s) {
+  if (!s)
+    return catsnap_put_u32(sb, CATSNAP_NULL_STR);
+  size_t len = strlen(s);
+  if (len >= CATSNAP_NULL_STR)
+    return ERR;
+  if (catsnap_put_u32(sb, (uint32_t)len) != OK)
+    return ERR;
+  return sb_append_bytes(sb, s, len);
+}
+
+static AdbxStatus catsnap_put_policy(StrBuf *sb, const SafetyPolicy *p) {
+  if (catsnap_put_u32(sb, (uint32_t)p->read_only) != OK ||
+      catsnap_put_u32(sb, p->statement_timeout_ms) != OK ||
+      catsnap_put_u32(sb, p->max_rows) != OK ||
+      catsnap_put_u32(sb, p->max_payload_bytes) != OK ||
+      catsnap_put_u32(sb, p->spill_max_bytes) != OK ||
+      catsnap_put_u32(sb, p->result_cache_ttl_secs) != OK ||
+      catsnap_put_u32(sb, p->max_estimated_cost) != OK ||
+      catsnap_put_u32(sb, p->slow_log_ms) != OK ||
+      catsnap_put_u32(sb, p->heavy_statement_timeout_ms) != OK ||
+      catsnap_put_u32(sb, p->heavy_work_mem_kb) != OK ||
+      catsnap_put_u32(sb, (uint32_t)p->column_mode) != OK ||
+      catsnap_put_u32(sb, (uint32_t)p->column_strategy) != OK) {
+    return ERR;
+  }
+  return OK;
+}
+
+/* Serializes the full catalog into 'sb'.
+ * It borrows 'cat' and appends to caller-owned 'sb'.
+ * Error semantics: returns OK on success, ERR on allocation failure or an
+ * unencodable string length.
+ */
+static AdbxStatus catsnap_encode_body(const ConnCatalog *cat, StrBuf *sb) {
+  if (catsnap_put_str(sb, cat->credential_namespace) != OK ||
+      catsnap_put_policy(sb, &cat->policy) != OK ||
+      catsnap_put_u32(sb, (uint32_t)cat->n_profiles) != OK) {
+    return ERR;
+  }
+
+  for (size_t i = 0; i < cat->n_profiles; i++) {
+    const ConnProfile *p = &cat->profiles[i];
+    if (catsnap_put_str(sb, p->connection_name) != OK ||
+        catsnap_put_u32(sb, (uint32_t)p->kind) != OK ||
+        catsnap_put_str(sb, p->host) != OK ||
+        catsnap_put_u32(sb, p->port) != OK ||
+        catsnap_put_str(sb, p->db_name) != OK ||
+        catsnap_put_str(sb, p->user) != OK ||
+        catsnap_put_str(sb, p->options) != OK ||
+        catsnap_put_u32(sb, p->pool_size) != OK ||
+        catsnap_put_u32(sb, p->connect_timeout_secs) != OK ||
+        catsnap_put_u32(sb, (uint32_t)p->preconnect) != OK ||
+        catsnap_put_str(sb, p->replica_group) != OK ||
+        catsnap_put_policy(sb, &p->safe_policy) != OK) {
+      return ERR;
+    }
+
+    if (catsnap_put_u32(sb, (uint32_t)p->col_policy.n_rules) != OK)
+      return ERR;
+    for (size_t r = 0; r < p->col_policy.n_rules; r++) {
+      const ColumnRule *cr = &p->col_policy.rules[r];
+      if (catsnap_put_str(sb, cr->table) != OK ||
+          catsnap_put_str(sb, cr->col) != OK ||
+          catsnap_put_u32(sb, (uint32_t)cr->is_global) != OK ||
+          catsnap_put_u32(sb, cr->n_schemas) != OK) {
+        return ERR;
+      }
+      for (uint32_t s = 0; s < cr->n_schemas; s++) {
+        if (catsnap_put_str(sb, cr->schemas[s]) != OK)
+          return ERR;
+      }
+    }
+
+    if (catsnap_put_u32(sb, (uint32_t)p->safe_funcs.n_rules) != OK)
+      return ERR;
+    for (size_t r = 0; r < p->safe_funcs.n_rules; r++) {
+      const SafeFunctionRule *fr = &p->safe_funcs.rules[r];
+      if (catsnap_put_str(sb, fr->name) != OK ||
+          catsnap_put_u32(sb, (uint32_t)fr->is_global) != OK ||
+          catsnap_put_u32(sb, fr->n_schemas) != OK) {
+        return ERR;
+      }
+      for (uint32_t s = 0; s < fr->n_schemas; s++) {
+        if (catsnap_put_str(sb, fr->schemas[s]) != OK)
+          return ERR;
+      }
+    }
+  }
+  return OK;
+}
+
+// Bounds-checked read cursor over the mapped snapshot bytes.
+typedef struct CatSnapCur {
+  const uint8_t *p;
+  const uint8_t *end;
+} CatSnapCur;
+
+static AdbxStatus catsnap_get_bytes(CatSnapCur *c, void *dst, size_t n) {
+  if ((size_t)(c->end - c->p) < n)
+    return ERR;
+  memcpy(dst, c->p, n);
+  c->p += n;
+  return OK;
+}
+
+static AdbxStatus catsnap_get_u32(CatSnapCur *c, uint32_t *v) {
+  return catsnap_get_bytes(c, v, sizeof(*v));
+}
+
+static AdbxStatus catsnap_get_u64(CatSnapCur *c, uint64_t *v) {
+  return catsnap_get_bytes(c, v, sizeof(*v));
+}
+
+/* Reads one string span without copying. '*out' is NULL for the null marker,
+ * else borrows the snapshot bytes until the mapping is released. */
+static AdbxStatus catsnap_get_span(CatSnapCur *c, const char **out,
+                                   uint32_t *out_len) {
+  *out = NULL;
+  *out_len = 0;
+  uint32_t len = 0;
+  if (catsnap_get_u32(c, &len) != OK)
+    return ERR;
+  if (len == CATSNAP_NULL_STR)
+    return OK;
+  if ((size_t)(c->end - c->p) < len)
+    return ERR;
+  *out = (const char *)c->p;
+  *out_len = len;
+  c->p += len;
+  return OK;
+}
+
+/* Heap copy of one string span; '*out' stays NULL for the null marker so the
+ * caller decides whether an absent string is acceptable. */
+static AdbxStatus catsnap_get_str_dup(CatSnapCur *c, char **out) {
+  *out = NULL;
+  const char *s = NULL;
+  uint32_t len = 0;
+  if (catsnap_get_span(c, &s, &len) != OK)
+    return ERR;
+  if (!s)
+    return OK;
+  char *d = (char *)xmalloc((size_t)len + 1);
+  memcpy(d, s, len);
+  d[len] = '\0';
+  *out = d;
+  return OK;
+}
+
+static AdbxStatus catsnap_get_policy(CatSnapCur *c, SafetyPolicy *p) {
+  uint32_t ro = 0, mode = 0, strat = 0;
+  if (catsnap_get_u32(c, &ro) != OK ||
+      catsnap_get_u32(c, &p->statement_timeout_ms) != OK ||
+      catsnap_get_u32(c, &p->max_rows) != OK ||
+      catsnap_get_u32(c, &p->max_payload_bytes) != OK ||
+      catsnap_get_u32(c, &p->spill_max_bytes) != OK ||
+      catsnap_get_u32(c, &p->result_cache_ttl_secs) != OK ||
+      catsnap_get_u32(c, &p->max_estimated_cost) != OK ||
+      catsnap_get_u32(c, &p->slow_log_ms) != OK ||
+      catsnap_get_u32(c, &p->heavy_statement_timeout_ms) != OK ||
+      catsnap_get_u32(c, &p->heavy_work_mem_kb) != OK ||
+      catsnap_get_u32(c, &mode) != OK || catsnap_get_u32(c, &strat) != OK) {
+    return ERR;
+  }
+  p->read_only = (int)ro;
+  p->column_mode = (SafetyColumnMode)mode;
+  p->column_strategy = (SafetyColumnStrategy)strat;
+  return OK;
+}
+
+/* Reads one rule's schema list into the policy arena.
+ * Side effects: allocates the pointer array and strings in 'arena'.
+ * Error semantics: returns OK on success, ERR on truncated input, a null
+ * schema string, or arena exhaustion.
+ */
+static AdbxStatus catsnap_get_schemas(CatSnapCur *c, Arena *arena,
+                                      uint32_t n_schemas,
+                                      const char ***out_schemas) {
+  *out_schemas = NULL;
+  if (n_schemas == 0)
+    return OK;
+  // Each schema needs at least its length prefix in the stream.
+  if ((size_t)(c->end - c->p) / sizeof(uint32_t) < n_schemas)
+    return ERR;
+  const char **schemas = (const char **)arena_calloc(
+      arena, (uint32_t)(n_schemas * sizeof(*schemas)));
+  if (!schemas)
+    return ERR;
+  for (uint32_t s = 0; s < n_schemas; s++) {
+    const char *sc = NULL;
+    uint32_t slen = 0;
+    if (catsnap_get_span(c, &sc, &slen) != OK || !sc)
+      return ERR;
+    schemas[s] = (const char *)arena_add_nul(arena, (void *)sc, slen);
+    if (!schemas[s])
+      return ERR;
+  }
+  *out_schemas = schemas;
+  return OK;
+}
+
+/* Rebuilds one ColumnPolicy from snapshot bytes into its own arena, then
+ * rebuilds the (table, col) hash index over the decoded rules.
+ * Error semantics: returns OK on success, ERR on malformed input; 'pol' is
+ * left in a state profile_clean() can release either way.
+ */
+static AdbxStatus catsnap_decode_col_rules(CatSnapCur *c, ColumnPolicy *pol) {
+  uint32_t n_rules = 0;
+  if (catsnap_get_u32(c, &n_rules) != OK)
+    return ERR;
+  if (arena_init(&pol->arena, NULL, NULL) != OK)
+    return ERR;
+  if (n_rules == 0)
+    return OK;
+  // Each rule carries at least four u32 fields; bound before allocating.
+  if ((size_t)(c->end - c->p) / (4u * sizeof(uint32_t)) < n_rules)
+    return ERR;
+
+  ColumnRule *rules = (ColumnRule *)arena_calloc(
+      &pol->arena, (uint32_t)(n_rules * sizeof(*rules)));
+  if (!rules)
+    return ERR;
+  for (uint32_t i = 0; i < n_rules; i++) {
+    ColumnRule *r = &rules[i];
+    const char *table = NULL, *col = NULL;
+    uint32_t tlen = 0, clen = 0, is_global = 0, n_schemas = 0;
+    if (catsnap_get_span(c, &table, &tlen) != OK || !table ||
+        catsnap_get_span(c, &col, &clen) != OK || !col ||
+        catsnap_get_u32(c, &is_global) != OK ||
+        catsnap_get_u32(c, &n_schemas) != OK) {
+      return ERR;
+    }
+    r->table = (const char *)arena_add_nul(&pol->arena, (void *)table, tlen);
+    r->col = (const char *)arena_add_nul(&pol->arena, (void *)col, clen);
+    if (!r->table || !r->col)
+      return ERR;
+    r->is_global = (int)is_global;
+    r->n_schemas = n_schemas;
+    if (catsnap_get_schemas(c, &pol->arena, n_schemas, &r->schemas) != OK)
+      return ERR;
+  }
+  pol->rules = rules;
+  pol->n_rules = n_rules;
+  colpolicy_build_index(pol);
+  return OK;
+}
+
+/* Same as catsnap_decode_col_rules() but for the safe-function policy. */
+static AdbxStatus catsnap_decode_func_rules(CatSnapCur *c,
+                                            SafeFunctionPolicy *pol) {
+  uint32_t n_rules = 0;
+  if (catsnap_get_u32(c, &n_rules) != OK)
+    return ERR;
+  if (arena_init(&pol->arena, NULL, NULL) != OK)
+    return ERR;
+  if (n_rules == 0)
+    return OK;
+  if ((size_t)(c->end - c->p) / (3u * sizeof(uint32_t)) < n_rules)
+    return ERR;
+
+  SafeFunctionRule *rules = (SafeFunctionRule *)arena_calloc(
+      &pol->arena, (uint32_t)(n_rules * sizeof(*rules)));
+  if (!rules)
+    return ERR;
+  for (uint32_t i = 0; i < n_rules; i++) {
+    SafeFunctionRule *r = &rules[i];
+    const char *name = NULL;
+    uint32_t nlen = 0, is_global = 0, n_schemas = 0;
+    if (catsnap_get_span(c, &name, &nlen) != OK || !name ||
+        catsnap_get_u32(c, &is_global) != OK ||
+        catsnap_get_u32(c, &n_schemas) != OK) {
+      return ERR;
+    }
+    r->name = (const char *)arena_add_nul(&pol->arena, (void *)name, nlen);
+    if (!r->name)
+      return ERR;
+    r->is_global = (int)is_global;
+    r->n_schemas = n_schemas;
+    if (catsnap_get_schemas(c, &pol->arena, n_schemas, &r->schemas) != OK)
+      return ERR;
+  }
+  pol->rules = rules;
+  pol->n_rules = n_rules;
+  return OK;
+}
+
+/* Rebuilds one profile from snapshot bytes, re-applying the same bounds the
+ * JSON parser enforces so a tampered snapshot cannot smuggle values past
+ * validation. On ERR 'out' is always in a state profile_clean() can release.
+ */
+static AdbxStatus catsnap_decode_profile(CatSnapCur *c, const ConnCatalog *cat,
+                                         ConnProfile *out) {
+  uint32_t kind = 0, port = 0, preconnect = 0;
+  char *conn_name = NULL, *host = NULL, *db_name = NULL, *user = NULL,
+       *options = NULL;
+
+  if (catsnap_get_str_dup(c, &conn_name) != OK || !conn_name ||
+      strlen(conn_name) > CONN_NAME_MAX_LEN) {
+    goto error;
+  }
+  if (catsnap_get_u32(c, &kind) != OK || kind != (uint32_t)DB_KIND_POSTGRES)
+    goto error;
+  if (catsnap_get_str_dup(c, &host) != OK || !host)
+    goto error;
+  if (catsnap_get_u32(c, &port) != OK || port > UINT16_MAX)
+    goto error;
+  if (catsnap_get_str_dup(c, &db_name) != OK || !db_name)
+    goto error;
+  if (catsnap_get_str_dup(c, &user) != OK || !user)
+    goto error;
+  if (catsnap_get_str_dup(c, &options) != OK)
+    goto error;
+
+  out->connection_name = conn_name;
+  out->secret_ref.cred_namespace = cat->credential_namespace;
+  out->secret_ref.connection_name = conn_name;
+  out->kind = (DbKind)kind;
+  out->host = host;
+  out->port = (uint16_t)port;
+  out->db_name = db_name;
+  out->user = user;
+  out->options = options;
+
+  // From here 'out' owns the strings; the caller profile_clean()s on ERR.
+  if (catsnap_get_u32(c, &out->pool_size) != OK ||
+      out->pool_size > CONN_POOL_SIZE_MAX ||
+      catsnap_get_u32(c, &out->connect_timeout_secs) != OK ||
+      catsnap_get_u32(c, &preconnect) != OK || preconnect > 1u) {
+    return ERR;
+  }
+  char *replica_group = NULL;
+  if (catsnap_get_str_dup(c, &replica_group) != OK)
+    return ERR;
+  out->replica_group = replica_group;
+  if (replica_group && (replica_group[0] == '\0' ||
+                        strlen(replica_group) > CONN_NAME_MAX_LEN)) {
+    return ERR;
+  }
+  if (catsnap_get_policy(c, &out->safe_policy) != OK)
+    return ERR;
+  // Not serialized: the flags are derived from the fields just decoded.
+  safety_policy_compile(&out->safe_policy);
+  out->preconnect = (int)preconnect;
+  if (catsnap_decode_col_rules(c, &out->col_policy) != OK)
+    return ERR;
+  if (catsnap_decode_func_rules(c, &out->safe_funcs) != OK)
+    return ERR;
+  return OK;
+
+error:
+  free(conn_name);
+  free(host);
+  free(db_name);
+  free(user);
+  free(options);
+  return ERR;
+}
+
+/* Rebuilds the whole catalog from snapshot body bytes.
+ * Ownership: returns a caller-owned catalog or NULL on malformed input.
+ * Partial failures are released through catalog_destroy() before returning.
+ */
+static ConnCatalog *catsnap_decode_body(CatSnapCur *c) {
+  ConnCatalog *cat = (ConnCatalog *)xcalloc(1, sizeof(*cat));
+
+  char *ns = NULL;
+  if (catsnap_get_str_dup(c, &ns) != OK || !ns || ns[0] == '\0' ||
+      strlen(ns) > NAMESPACE_MAX_LEN) {
+    free(ns);
+    free(cat);
+    return NULL;
+  }
+  cat->credential_namespace = ns;
+
+  uint32_t n_profiles = 0;
+  if (catsnap_get_policy(c, &cat->policy) != OK ||
+      catsnap_get_u32(c, &n_profiles) != OK ||
+      n_profiles > CONFIG_MAX_CONNECTIONS) {
+    catalog_destroy(cat);
+    return NULL;
+  }
+  if (n_profiles == 0)
+    return cat;
+
+  cat->profiles =
+      (ConnProfile *)xcalloc(n_profiles, sizeof(*cat->profiles));
+  for (uint32_t i = 0; i < n_profiles; i++) {
+    if (catsnap_decode_profile(c, cat, &cat->profiles[i]) != OK) {
+      profile_clean(&cat->profiles[i]);
+      catalog_destroy(cat); // releases profiles [0, i) counted so far
+      return NULL;
+    }
+    // Not serialized: the index is positional by definition.
+    cat->profiles[i].catalog_idx = i;
+    cat->n_profiles = i + 1;
+  }
+  // Not serialized either: group leaders are positional, and the snapshot
+  // was written from a catalog that already passed the collision check.
+  if (catalog_stamp_replica_groups(cat, NULL) != OK) {
+    catalog_destroy(cat);
+    return NULL;
+  }
+  return cat;
+}
+
+/* Loads the catalog from 'snap_path' when the snapshot matches 'meta'.
+ * Error semantics: returns a caller-owned catalog on a verified hit, NULL on
+ * any miss (absent, stale, truncated, or corrupt snapshot). Never reports an
+ * error; the caller always has the JSON path to fall back to.
+ */
+static ConnCatalog *catsnap_try_load(const char *snap_path,
+                                     const FileMeta *meta) {
+  int fd = open(snap_path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  FileMap map;
+  AdbxStatus mrc = fileio_map_ro_fd(fd, CONFIG_MAX_BYTES, &map);
+  close(fd);
+  if (mrc != OK)
+    return NULL;
+
+  ConnCatalog *cat = NULL;
+  if (map.len >= CATSNAP_HEADER_LEN &&
+      memcmp(map.data, CATSNAP_MAGIC, CATSNAP_MAGIC_LEN) == 0) {
+    CatSnapCur c = {map.data + CATSNAP_MAGIC_LEN, map.data + map.len};
+    uint32_t format = 0, body_len = 0;
+    uint64_t dev = 0, ino = 0, size = 0, mts = 0, mtn = 0, hash = 0;
+    if (catsnap_get_u32(&c, &format) == OK && format == CATSNAP_FORMAT &&
+        catsnap_get_u64(&c, &dev) == OK && catsnap_get_u64(&c, &ino) == OK &&
+        catsnap_get_u64(&c, &size) == OK && catsnap_get_u64(&c, &mts) == OK &&
+        catsnap_get_u64(&c, &mtn) == OK && catsnap_get_u64(&c, &hash) == OK &&
+        catsnap_get_u32(&c, &body_len) == OK &&
+        dev == (uint64_t)meta->dev && ino == (uint64_t)meta->ino &&
+        size == (uint64_t)meta->size && mts == (uint64_t)meta->mtime_sec &&
+        mtn == (uint64_t)meta->mtime_nsec &&
+        (size_t)(c.end - c.p) == (size_t)body_len &&
+        rapidhash(c.p, body_len) == hash) {
+      cat = catsnap_decode_body(&c);
+      if (cat && c.p != c.end) { // trailing bytes: treat as corrupt
+        catalog_destroy(cat);
+        cat = NULL;
+      }
+    }
+  }
+  fileio_map_clean(&map);
+  return cat;
+}
+
+/* Serializes 'cat' and writes it atomically to 'snap_path'.
+ * Side effects: encodes into heap buffers and renames a temp file next to the
+ * config, so readers never observe a torn snapshot.
+ * Error semantics: best-effort; a snapshot that cannot be written only costs
+ * the next start its parse, so failures are swallowed.
+ */
+static void catsnap_store(const char *snap_path, const FileMeta *meta,
+                          const ConnCatalog *cat) {
+  StrBuf body;
+  sb_init(&body);
+  if (catsnap_encode_body(cat, &body) != OK) {
+    sb_clean(&body);
+    return;
+  }
+
+  StrBuf out;
+  sb_init(&out);
+  uint64_t hash = rapidhash(body.data, body.len);
+  AdbxStatus hrc = OK;
+  if (sb_append_bytes(&out, CATSNAP_MAGIC, CATSNAP_MAGIC_LEN) != OK ||
+      catsnap_put_u32(&out, CATSNAP_FORMAT) != OK ||
+      catsnap_put_u64(&out, (uint64_t)meta->dev) != OK ||
+      catsnap_put_u64(&out, (uint64_t)meta->ino) != OK ||
+      catsnap_put_u64(&out, (uint64_t)meta->size) != OK ||
+      catsnap_put_u64(&out, (uint64_t)meta->mtime_sec) != OK ||
+      catsnap_put_u64(&out, (uint64_t)meta->mtime_nsec) != OK ||
+      catsnap_put_u64(&out, hash) != OK ||
+      catsnap_put_u32(&out, (uint32_t)body.len) != OK ||
+      sb_append_bytes(&out, body.data, body.len) != OK) {
+    hrc = ERR;
+  }
+  sb_clean(&body);
+  if (hrc != OK) {
+    sb_clean(&out);
+    return;
+  }
+
+  char *dir = NULL;
+  const char *name = snap_path;
+  const char *slash = strrchr(snap_path, '/');
+  if (slash) {
+    size_t dlen = (size_t)(slash - snap_path);
+    if (dlen == 0)
+      dlen = 1; // snapshot directly under "/"
+    dir = (char *)xmalloc(dlen + 1);
+    memcpy(dir, snap_path, dlen);
+    dir[dlen] = '\0';
+    name = slash + 1;
+  }
+  int dir_fd = open(dir ? dir : ".", O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    (void)write_atomic(dir_fd, name, (const uint8_t *)out.data, out.len, NULL);
+    close(dir_fd);
+  }
+  free(dir);
+  sb_clean(&out);
+}
+
+ConnCatalog *catalog_load_cached(int fd, const char *config_path,
+                                 char **err_out) {
+  if (err_out)
+    *err_out = NULL;
+
+  char *snap_path = NULL;
+  FileMeta meta = {0};
+  struct stat st;
+  if (fd >= 0 && config_path && config_path[0] != '\0' &&
+      fstat(fd, &st) == 0 && fileio_meta_from_stat(&st, &meta) == OK) {
+    size_t plen = strlen(config_path);
+    snap_path = (char *)xmalloc(plen + sizeof(CATALOG_SNAP_SUFFIX));
+    memcpy(snap_path, config_path, plen);
+    memcpy(snap_path + plen, CATALOG_SNAP_SUFFIX,
+           sizeof(CATALOG_SNAP_SUFFIX));
+
+    ConnCatalog *cached = catsnap_try_load(snap_path, &meta);
+    if (cached) {
+      free(snap_path);
+      return cached;
+    }
+  }
+
+  ConnCatalog *cat = catalog_load_from_fd(fd, err_out);
+  if (cat && snap_path)
+    catsnap_store(snap_path, &meta, cat);
+  free(snap_path);
   return cat;
 }
 
@@ -1190,8 +1999,13 @@ AdbxTriStatus connp_is_col_sensitive(const ConnProfile *cp, const char *schema,
   key.table = table;
   key.col = column;
 
-  ColumnRule *r = (ColumnRule *)bsearch(&key, pol->rules, pol->n_rules,
-                                        sizeof(*pol->rules), colrule_cmp);
+  const ColumnRule *r;
+  if (pol->index) {
+    r = (const ColumnRule *)ht_get_custom(pol->index, &key);
+  } else {
+    r = (const ColumnRule *)bsearch(&key, pol->rules, pol->n_rules,
+                                    sizeof(*pol->rules), colrule_cmp);
+  }
   if (!r)
     return NO;
 
@@ -13,6 +13,8 @@
 /* Max bytes allowed for ConnProfile.connection_name (excluding NUL). */
 #define CONN_NAME_MAX_LEN 31u
 #define NAMESPACE_MAX_LEN 31u
+/* Upper bound for a profile's "poolSize" (pooled connections per profile). */
+#define CONN_POOL_SIZE_MAX 32u
 
 typedef enum {
   DB_KIND_POSTGRES = 1,
@@ -30,6 +32,10 @@ typedef struct ColumnRule {
 /* Groups all the ColumnRule for a ConnProfile. */
 typedef struct ColumnPolicy {
   ColumnRule *rules; // sorted by (table, col)
+  // Owned (table, col) -> ColumnRule* hash index built at catalog load so
+  // per-column sensitivity checks cost O(1); NULL when there are no rules or
+  // index creation failed (lookups then fall back to bsearch over 'rules').
+  struct HashTable *index;
   size_t n_rules;
   Arena arena; // owns all strings and arrays in ColumnPolicy
 } ColumnPolicy;
@@ -59,6 +65,11 @@ typedef struct {
   SecretRefInfo secret_ref;    // borrows catalog namespace + connection_name
   DbKind kind;
 
+  // Position of this profile in ConnCatalog.profiles, stamped at load.
+  // Small integer key for per-session state keyed by connection (token
+  // stores), so hot paths index arrays instead of comparing names.
+  uint32_t catalog_idx;
+
   const char *host; // e.g., "127.0.0.1"
   uint16_t port;    // e.g., 5432
   const char *db_name;
@@ -67,6 +78,30 @@ typedef struct {
   // Optional: extra options, TLS mode, parameters, etc.
   const char *options; // may be NULL
 
+  // Optional: pooled connections kept for this profile (0 = manager default).
+  uint32_t pool_size;
+
+  // Optional: cap in seconds on establishing one connection to this profile
+  // (0 = backend default). Bounds how long a black-holed host can stall a
+  // cold checkout.
+  uint32_t connect_timeout_secs;
+
+  // Optional: when non-zero, one pooled slot is connected asynchronously at
+  // broker startup so the first query does not pay the connection cost.
+  int preconnect;
+
+  // Optional replica-group tag. Profiles sharing one tag form a group whose
+  // tag doubles as a logical connection name: the manager routes a checkout
+  // on it to the least-loaded healthy member, so agents scale across read
+  // replicas without knowing they exist. NULL = not grouped.
+  const char *replica_group;
+
+  // catalog_idx of the group's first member (own catalog_idx when ungrouped),
+  // stamped at load like catalog_idx. Group-wide per-connection state (the
+  // session token stores) binds to the leader so a token minted through one
+  // replica still resolves when a later request routes to another.
+  uint32_t group_leader_idx;
+
   SafetyPolicy safe_policy;
   // Column sensitivity rules for this connection (may be empty).
   ColumnPolicy col_policy;
@@ -92,6 +127,20 @@ typedef struct ConnCatalog {
 // caller must free(). On success, *err_out is set to NULL.
 ConnCatalog *catalog_load_from_fd(int fd, char **err_out);
 
+/* Suffix appended to the config path for the binary snapshot file. */
+#define CATALOG_SNAP_SUFFIX ".snap"
+
+/* Same contract as catalog_load_from_fd(), but keeps a versioned binary
+ * snapshot of the validated catalog at '<config_path>.snap' so warm starts
+ * skip the JSON parse and validation entirely. The snapshot is keyed by the
+ * config file's identity (dev/ino/size/mtime) and body hash; any mismatch,
+ * corruption, or missing file silently falls back to the JSON path and
+ * rewrites the snapshot. Snapshot I/O is best-effort and never fails the
+ * load. Borrows 'fd' and 'config_path'.
+ */
+ConnCatalog *catalog_load_cached(int fd, const char *config_path,
+                                 char **err_out);
+
 /* Creates one empty in-memory state catalog for a namespace with no saved
  * entries. It allocates the catalog and one owned namespace copy.
  * Error semantics: returns a caller-owned catalog on success, NULL on invalid
@@ -3,28 +3,79 @@
 #include "log.h"
 #include "utils.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+/* Pooled slots kept per profile when the config does not set "poolSize". */
+#define CONN_POOL_SIZE_DEFAULT 4u
+/* Max parked waiter cookies per profile before connm_wait refuses. */
+#define CONN_MAX_WAITERS 64u
+/* How often the warm worker probes/reconnects when the caller passes 0. */
+#define CONN_WARM_PROBE_INTERVAL_MS (30u * 1000u)
+/* How long a member stays out of replica-group routing after a failed
+ * connect; it still serves direct checkouts (callers asked for it by name)
+ * and is retried by the group once the backoff lapses or no healthy member
+ * remains. */
+#define CONN_UNHEALTHY_BACKOFF_MS 5000u
+
+/* One pooled connection. The backend is created and connected lazily on first
+ * checkout and may be disconnected by the idle reaper while not in use. */
+typedef struct {
+  DbBackend *backend;    // owned by ConnManager (lazy)
+  uint64_t last_used_ms; // updated on checkin
+  uint8_t in_use;        // 1 while checked out (worker may be executing)
+} ConnSlot;
+
 typedef struct {
   const ConnProfile *profile; // borrowed from catalog
-  DbBackend *backend;         // owned by ConnManager (lazy)
-  uint64_t last_used_ms;      // updated after exec (or via connm_mark_used)
+  ConnSlot *slots;            // owned array of pooled connections
+  uint32_t n_slots;
+
+  DbBackend *parser_backend; // owned; never connected (lazy)
+
+  // Rolling high-water estimate of result metadata-arena bytes observed on
+  // this connection; backends use it to pre-size the next result's arena.
+  uint32_t result_arena_est;
+
+  // FIFO ring of opaque waiter cookies registered while the pool was
+  // exhausted.
+  uint64_t waiters[CONN_MAX_WAITERS];
+  uint32_t w_head;
+  uint32_t w_len;
+
+  // Monotonic deadline until which replica-group routing skips this member
+  // (stamped on a failed connect, cleared on a successful one). 0 = healthy.
+  uint64_t unhealthy_until_ms;
 } ConnEntry;
 
 struct ConnManager {
   ConnCatalog *cat;     // owned
   SecretStore *secrets; // owned
-  uint64_t ttl_ms;      // the time after which a backend that has
-                        // not been used ( and has no running queries)
+  uint64_t ttl_ms;      // the time after which a slot that has
+                        // not been used (and is not checked out)
                         // may be disconnected.
   DbBackend *(*factory)(
       DbKind kind); // backend factory (borrowed - used for tests)
 
   ConnEntry *entries; // owned
   size_t n_entries;
+
+  // Guards every field above. Without the warm worker only the broker thread
+  // calls in here; with it, slot bookkeeping is shared between two threads.
+  pthread_mutex_t lock;
+  pthread_cond_t warm_wake; // signalled to stop the warm worker early
+  pthread_t warm_thread;
+  uint64_t warm_interval_ms;
+  int warm_running; // guarded by lock
+  int warm_stop;    // guarded by lock; also stops the preconnect sweep
+
+  // One-shot startup thread connecting the profiles that opt in via the
+  // config "preconnect" flag; joined by connm_destroy().
+  pthread_t preconnect_thread;
+  int preconnect_started; // guarded by lock
 };
 
 /* Returns the ConnEntry identified by connection_name or NULL. Since for now we
@@ -43,29 +94,66 @@ static ConnEntry *find_entry(ConnManager *m, const char *connection_name) {
   return NULL;
 }
 
-/* Makes sure 'e' refers to a connected DbBackend. Creates the backend if null.
- * Connect the backend if not already connected. Returns OK/ERR. */
-static AdbxStatus ensure_connected(ConnManager *m, ConnEntry *e) {
-  if (!m || !e || !e->profile)
+/* Returns 1 when 'e' is a member of replica group 'name'. */
+static int entry_in_group(const ConnEntry *e, const char *name) {
+  return e->profile && e->profile->replica_group &&
+         strcmp(e->profile->replica_group, name) == 0;
+}
+
+/* Returns the entry named 'connection_name', or — when the name is a replica
+ * group tag instead — its leader (first member in catalog order). Used by the
+ * per-connection side channels (parser backend, arena estimate) that groups
+ * share through the leader. */
+static ConnEntry *find_entry_or_leader(ConnManager *m,
+                                       const char *connection_name) {
+  ConnEntry *e = find_entry(m, connection_name);
+  if (e)
+    return e;
+  if (!m || !connection_name)
+    return NULL;
+  for (size_t i = 0; i < m->n_entries; i++) {
+    if (entry_in_group(&m->entries[i], connection_name))
+      return &m->entries[i];
+  }
+  return NULL;
+}
+
+/* Counts the checked-out slots of 'e' (its outstanding requests). */
+static uint32_t entry_outstanding(const ConnEntry *e) {
+  uint32_t n = 0;
+  for (uint32_t s = 0; s < e->n_slots; s++)
+    n += e->slots[s].in_use ? 1u : 0u;
+  return n;
+}
+
+/* Makes sure slot 's' of 'e' refers to a connected DbBackend. Creates the
+ * backend if null. Connects the backend if not already connected.
+ * Caller must hold m->lock. The slot is reserved via in_use and the lock is
+ * dropped around the connect itself (same discipline as connm_warm_entry),
+ * so a slow handshake on one profile never serializes checkouts on the
+ * others. Returns OK/ERR. */
+static AdbxStatus ensure_connected(ConnManager *m, ConnEntry *e, ConnSlot *s) {
+  if (!m || !e || !e->profile || !s)
     return ERR;
 
   // Lazy-create backend object
-  if (!e->backend) {
+  if (!s->backend) {
     if (!m->factory)
       return ERR;
-    e->backend = m->factory(e->profile->kind);
+    s->backend = m->factory(e->profile->kind);
   }
 
   // If backend is connected, keep it
-  if (db_is_connected(e->backend) == YES) {
+  if (db_is_connected(s->backend) == YES) {
     return OK;
   }
 
-  // Fetch password if needed
+  // Fetch password if needed. Inline mode keeps short passwords on the
+  // stack, where sb_zero_clean() still scrubs them.
   StrBuf pw;
-  sb_init(&pw);
-  AdbxTriStatus s_rc = secret_store_get(m->secrets, &e->profile->secret_ref,
-                                        &pw);
+  sb_init_small(&pw);
+  AdbxTriStatus s_rc =
+      secret_store_get(m->secrets, &e->profile->secret_ref, &pw);
   if (s_rc == NO) {
     TLOG("ERROR - missing secret for %s", e->profile->connection_name);
     sb_zero_clean(&pw);
@@ -82,17 +170,28 @@ static AdbxStatus ensure_connected(ConnManager *m, ConnEntry *e) {
     return ERR;
   }
 
-  // Connect
-  AdbxStatus rc =
-      db_connect(e->backend, e->profile, &e->profile->safe_policy, pw.data);
+  // Connect with the slot reserved and the lock released: the backend caps
+  // the handshake with the profile's connect deadline, and nobody else can
+  // claim the slot meanwhile.
+  s->in_use = 1;
+  DbBackend *db = s->backend;
+  const ConnProfile *profile = e->profile;
+  pthread_mutex_unlock(&m->lock);
+  AdbxStatus rc = db_connect(db, profile, &profile->safe_policy, pw.data);
   if (rc != OK) {
-    TLOG("ERROR - db_connect failed for %s", e->profile->connection_name);
+    TLOG("ERROR - db_connect failed for %s", profile->connection_name);
   }
   sb_zero_clean(&pw);
+  pthread_mutex_lock(&m->lock);
+  s->in_use = 0;
 
-  if (rc != OK)
+  if (rc != OK) {
+    // Feed replica-group routing: skip this member until the backoff lapses.
+    e->unhealthy_until_ms = now_ms_monotonic() + CONN_UNHEALTHY_BACKOFF_MS;
     return ERR;
+  }
 
+  e->unhealthy_until_ms = 0;
   return OK;
 }
 
@@ -102,7 +201,7 @@ ConnManager *connm_create_with_factory(ConnCatalog *cat, SecretStore *secrets,
   if (!cat || !secrets)
     return NULL;
 
-  ConnManager *m = (ConnManager *)xmalloc(sizeof(*m));
+  ConnManager *m = (ConnManager *)xcalloc(1, sizeof(*m));
 
   m->cat = cat;
   m->secrets = secrets;
@@ -110,6 +209,23 @@ ConnManager *connm_create_with_factory(ConnCatalog *cat, SecretStore *secrets,
   m->ttl_ms = TTL_CONNECTIONS_MS;
   m->factory = factory ? factory : db_backend_create;
 
+  // The warm worker waits on a monotonic deadline so wall-clock jumps cannot
+  // stall or rush the probe cadence.
+  pthread_condattr_t cattr;
+  if (pthread_mutex_init(&m->lock, NULL) != 0 ||
+      pthread_condattr_init(&cattr) != 0) {
+    free(m);
+    return NULL;
+  }
+  (void)pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+  if (pthread_cond_init(&m->warm_wake, &cattr) != 0) {
+    pthread_condattr_destroy(&cattr);
+    pthread_mutex_destroy(&m->lock);
+    free(m);
+    return NULL;
+  }
+  pthread_condattr_destroy(&cattr);
+
   // Build entries from catalog list (borrowed pointers)
   size_t total = catalog_count(cat);
   if (total == 0) {
@@ -126,9 +242,13 @@ ConnManager *connm_create_with_factory(ConnCatalog *cat, SecretStore *secrets,
   m->n_entries = n;
   uint64_t t = now_ms_monotonic();
   for (size_t i = 0; i < n; i++) {
-    m->entries[i].profile = tmp[i];
-    m->entries[i].backend = NULL;
-    m->entries[i].last_used_ms = t; // treat as "recent" at startup
+    ConnEntry *e = &m->entries[i];
+    memset(e, 0, sizeof(*e));
+    e->profile = tmp[i];
+    e->n_slots = tmp[i]->pool_size ? tmp[i]->pool_size : CONN_POOL_SIZE_DEFAULT;
+    e->slots = (ConnSlot *)xcalloc(e->n_slots, sizeof(ConnSlot));
+    for (uint32_t s = 0; s < e->n_slots; s++)
+      e->slots[s].last_used_ms = t; // treat as "recent" at startup
   }
 
   free(tmp);
@@ -139,8 +259,8 @@ ConnManager *connm_create(ConnCatalog *cat, SecretStore *secrets) {
   return connm_create_with_factory(cat, secrets, NULL);
 }
 
-/* Finds connections that have been unused for more than 'm->ttl_ms' ms and
- * closes them. */
+/* Finds slots that have been unused for more than 'm->ttl_ms' ms and closes
+ * them. Checked-out slots are never touched. */
 static void connm_disconnect_idle(ConnManager *m) {
   if (!m || !m->entries || m->ttl_ms == 0)
     return;
@@ -148,13 +268,18 @@ static void connm_disconnect_idle(ConnManager *m) {
   uint64_t t = now_ms_monotonic();
   for (size_t i = 0; i < m->n_entries; i++) {
     ConnEntry *e = &m->entries[i];
-    if (!e->backend || db_is_connected(e->backend) != YES)
-      continue;
+    for (uint32_t s = 0; s < e->n_slots; s++) {
+      ConnSlot *slot = &e->slots[s];
+      if (!slot->backend || slot->in_use)
+        continue;
 
-    uint64_t age = (t >= e->last_used_ms) ? (t - e->last_used_ms) : 0;
-    if (age > m->ttl_ms) {
-      // connection has been unused for too long
-      db_disconnect(e->backend);
+      if (db_is_connected(slot->backend) == YES) {
+        uint64_t age = (t >= slot->last_used_ms) ? (t - slot->last_used_ms) : 0;
+        if (age > m->ttl_ms) {
+          // connection has been unused for too long
+          db_disconnect(slot->backend);
+        }
+      }
     }
   }
 }
@@ -163,13 +288,36 @@ void connm_destroy(ConnManager *m) {
   if (!m)
     return;
 
+  // Stop the background workers first: they may hold a reserved slot while
+  // connecting or probing, and the teardown below frees every backend
+  // unconditionally.
+  pthread_mutex_lock(&m->lock);
+  int join_warm = m->warm_running;
+  int join_preconnect = m->preconnect_started;
+  m->warm_stop = 1;
+  if (join_warm)
+    pthread_cond_signal(&m->warm_wake);
+  pthread_mutex_unlock(&m->lock);
+  if (join_warm)
+    pthread_join(m->warm_thread, NULL);
+  if (join_preconnect)
+    pthread_join(m->preconnect_thread, NULL);
+
   if (m->entries) {
     for (size_t i = 0; i < m->n_entries; i++) {
-      // out ConnEntry may not have a backend yet
-      if (m->entries[i].backend) {
-        // destroy() closes the connection too
-        db_destroy(m->entries[i].backend);
-        m->entries[i].backend = NULL;
+      ConnEntry *e = &m->entries[i];
+      for (uint32_t s = 0; s < e->n_slots; s++) {
+        // a slot may not have a backend yet
+        if (e->slots[s].backend) {
+          // destroy() closes the connection too
+          db_destroy(e->slots[s].backend);
+          e->slots[s].backend = NULL;
+        }
+      }
+      free(e->slots);
+      if (e->parser_backend) {
+        db_destroy(e->parser_backend);
+        e->parser_backend = NULL;
       }
     }
     free(m->entries);
@@ -184,13 +332,130 @@ void connm_destroy(ConnManager *m) {
     secret_store_destroy(m->secrets);
     m->secrets = NULL;
   }
+  pthread_cond_destroy(&m->warm_wake);
+  pthread_mutex_destroy(&m->lock);
   free(m);
 }
 
-AdbxTriStatus connm_get_connection(ConnManager *m, const char *connection_name,
-                                   ConnView *out) {
-  if (!m || !connection_name || !out)
-    return ERR;
+/* Returns the first slot of 'e' that is free to check out, preferring one
+ * that is already connected (cheap reuse over a fresh connect). NULL when the
+ * whole pool is checked out. */
+static ConnSlot *pick_free_slot(ConnEntry *e) {
+  ConnSlot *fallback = NULL;
+  for (uint32_t s = 0; s < e->n_slots; s++) {
+    ConnSlot *slot = &e->slots[s];
+    if (slot->in_use)
+      continue;
+    if (slot->backend && db_is_connected(slot->backend) == YES)
+      return slot;
+    if (!fallback)
+      fallback = slot;
+  }
+  return fallback;
+}
+
+/* Routes one checkout on replica group 'name' to the member with the fewest
+ * outstanding requests, failing over to the next-least-loaded member when a
+ * connect fails (the failure also benches the member for
+ * CONN_UNHEALTHY_BACKOFF_MS). When every member sits in backoff, the
+ * least-loaded one still gets a single attempt so a recovered replica is
+ * found without waiting out the backoff. Caller must hold m->lock.
+ * Returns CONN_CHECKOUT_UNKNOWN when 'name' matches no member; BUSY (with
+ * 'out->profile' set) when members exist but every slot is checked out.
+ */
+static ConnCheckoutStatus connm_checkout_group_locked(ConnManager *m,
+                                                      const char *name,
+                                                      ConnView *out) {
+  uint64_t now = now_ms_monotonic();
+  int any_member = 0;
+  int attempted = 0;
+  const ConnEntry *busiest_fallback = NULL;
+
+  // Healthy members in ascending load order, one connect attempt each. A
+  // failed attempt stamps the backoff, which doubles as the "already tried"
+  // marker for this loop.
+  for (;;) {
+    ConnEntry *best = NULL;
+    uint32_t best_load = 0;
+    for (size_t i = 0; i < m->n_entries; i++) {
+      ConnEntry *e = &m->entries[i];
+      if (!entry_in_group(e, name))
+        continue;
+      any_member = 1;
+      if (!pick_free_slot(e)) {
+        // Fully checked out counts as alive no matter the backoff stamp;
+        // remember it so exhaustion reports BUSY, not ERR.
+        if (!busiest_fallback)
+          busiest_fallback = e;
+        continue;
+      }
+      if (e->unhealthy_until_ms > now)
+        continue;
+      uint32_t load = entry_outstanding(e);
+      if (!best || load < best_load) {
+        best = e;
+        best_load = load;
+      }
+    }
+    if (!best)
+      break;
+
+    attempted = 1;
+    ConnSlot *slot = pick_free_slot(best);
+    if (ensure_connected(m, best, slot) == OK) {
+      slot->in_use = 1;
+      out->profile = best->profile;
+      out->db = slot->backend;
+      return CONN_CHECKOUT_OK;
+    }
+    // ensure_connected() drops the lock around the handshake; re-read the
+    // clock so this member's fresh backoff stamp keeps excluding it.
+    now = now_ms_monotonic();
+  }
+
+  if (!any_member)
+    return CONN_CHECKOUT_UNKNOWN;
+
+  // Every slot-bearing member is benched. Give the least-loaded one a single
+  // attempt anyway, unless a failover above already ran this pass.
+  if (!attempted) {
+    ConnEntry *best = NULL;
+    uint32_t best_load = 0;
+    for (size_t i = 0; i < m->n_entries; i++) {
+      ConnEntry *e = &m->entries[i];
+      if (!entry_in_group(e, name) || !pick_free_slot(e))
+        continue;
+      uint32_t load = entry_outstanding(e);
+      if (!best || load < best_load) {
+        best = e;
+        best_load = load;
+      }
+    }
+    if (best) {
+      ConnSlot *slot = pick_free_slot(best);
+      if (ensure_connected(m, best, slot) == OK) {
+        slot->in_use = 1;
+        out->profile = best->profile;
+        out->db = slot->backend;
+        return CONN_CHECKOUT_OK;
+      }
+      attempted = 1;
+    }
+  }
+
+  // Prefer BUSY over ERR: a parked waiter gets redeemed when a member's slot
+  // frees up, while ERR is terminal for the request.
+  if (busiest_fallback) {
+    out->profile = busiest_fallback->profile;
+    return CONN_CHECKOUT_BUSY;
+  }
+  return CONN_CHECKOUT_ERR;
+}
+
+/* connm_checkout() body; caller must hold m->lock. */
+static ConnCheckoutStatus connm_checkout_locked(ConnManager *m,
+                                                const char *connection_name,
+                                                ConnView *out) {
   out->db = NULL;
   out->profile = NULL;
 
@@ -199,29 +464,566 @@ AdbxTriStatus connm_get_connection(ConnManager *m, const char *connection_name,
 
   ConnEntry *e = find_entry(m, connection_name);
   TLOG("INFO - requested use of connection %s", connection_name);
-  if (!e)
-    return NO;
+  if (!e) {
+    // Not a profile name; it may be a replica group tag.
+    return connm_checkout_group_locked(m, connection_name, out);
+  }
+  out->profile = e->profile;
+
+  ConnSlot *slot = pick_free_slot(e);
+  if (!slot)
+    return CONN_CHECKOUT_BUSY;
+
+  if (ensure_connected(m, e, slot) != OK)
+    return CONN_CHECKOUT_ERR;
+
+  slot->in_use = 1;
+  out->db = slot->backend;
+  return CONN_CHECKOUT_OK;
+}
+
+ConnCheckoutStatus connm_checkout(ConnManager *m, const char *connection_name,
+                                  ConnView *out) {
+  if (!m || !connection_name || !out)
+    return CONN_CHECKOUT_ERR;
+  pthread_mutex_lock(&m->lock);
+  ConnCheckoutStatus rc = connm_checkout_locked(m, connection_name, out);
+  pthread_mutex_unlock(&m->lock);
+  return rc;
+}
 
-  if (ensure_connected(m, e) != OK)
+void connm_checkin(ConnManager *m, const char *connection_name, DbBackend *db) {
+  if (!m || !connection_name || !db)
+    return;
+  pthread_mutex_lock(&m->lock);
+  ConnEntry *e = find_entry(m, connection_name);
+  int done = 0;
+  if (e) {
+    for (uint32_t s = 0; s < e->n_slots; s++) {
+      ConnSlot *slot = &e->slots[s];
+      if (slot->backend == db && slot->in_use) {
+        slot->in_use = 0;
+        slot->last_used_ms = now_ms_monotonic();
+        done = 1;
+        break;
+      }
+    }
+  }
+  // Group checkouts come back under the logical name; find the member whose
+  // slot actually holds 'db'.
+  if (!done && !e) {
+    for (size_t i = 0; i < m->n_entries && !done; i++) {
+      ConnEntry *me = &m->entries[i];
+      if (!entry_in_group(me, connection_name))
+        continue;
+      for (uint32_t s = 0; s < me->n_slots; s++) {
+        ConnSlot *slot = &me->slots[s];
+        if (slot->backend == db && slot->in_use) {
+          slot->in_use = 0;
+          slot->last_used_ms = now_ms_monotonic();
+          done = 1;
+          break;
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock(&m->lock);
+}
+
+AdbxStatus connm_wait(ConnManager *m, const char *connection_name,
+                      uint64_t cookie) {
+  if (!m || !connection_name || cookie == 0)
     return ERR;
+  pthread_mutex_lock(&m->lock);
+  ConnEntry *e = find_entry(m, connection_name);
+  if (!e) {
+    // Group tag: park on the member with the shortest queue; whichever slot
+    // frees first on it redeems the cookie.
+    for (size_t i = 0; i < m->n_entries; i++) {
+      ConnEntry *me = &m->entries[i];
+      if (!entry_in_group(me, connection_name))
+        continue;
+      if (!e || me->w_len < e->w_len)
+        e = me;
+    }
+  }
+  if (!e || e->w_len >= CONN_MAX_WAITERS) {
+    pthread_mutex_unlock(&m->lock);
+    return ERR;
+  }
 
-  out->db = e->backend;
-  out->profile = e->profile;
-  return YES;
+  e->waiters[(e->w_head + e->w_len) % CONN_MAX_WAITERS] = cookie;
+  e->w_len++;
+  pthread_mutex_unlock(&m->lock);
+  return OK;
 }
 
-void connm_mark_used(ConnManager *m, const char *connection_name) {
+uint64_t connm_pop_waiter(ConnManager *m, const char *connection_name) {
   if (!m || !connection_name)
-    return;
+    return 0;
+  pthread_mutex_lock(&m->lock);
   ConnEntry *e = find_entry(m, connection_name);
-  if (!e)
+  if (!e) {
+    // Group tag: a checkin can free a slot on any member, so a waiter is
+    // redeemable whenever some member has a free slot — not only the one it
+    // happened to park on.
+    int group_has_free = 0;
+    for (size_t i = 0; i < m->n_entries; i++) {
+      ConnEntry *me = &m->entries[i];
+      if (!entry_in_group(me, connection_name))
+        continue;
+      if (pick_free_slot(me))
+        group_has_free = 1;
+      if (!e && me->w_len > 0)
+        e = me;
+    }
+    if (!e || !group_has_free) {
+      pthread_mutex_unlock(&m->lock);
+      return 0;
+    }
+
+    uint64_t cookie = e->waiters[e->w_head];
+    e->w_head = (e->w_head + 1) % CONN_MAX_WAITERS;
+    e->w_len--;
+    pthread_mutex_unlock(&m->lock);
+    return cookie;
+  }
+  if (e->w_len == 0) {
+    pthread_mutex_unlock(&m->lock);
+    return 0;
+  }
+
+  // Only hand out a cookie while a slot is actually free for it to claim;
+  // otherwise the waiter stays queued for the next checkin.
+  if (!pick_free_slot(e)) {
+    pthread_mutex_unlock(&m->lock);
+    return 0;
+  }
+
+  uint64_t cookie = e->waiters[e->w_head];
+  e->w_head = (e->w_head + 1) % CONN_MAX_WAITERS;
+  e->w_len--;
+  pthread_mutex_unlock(&m->lock);
+  return cookie;
+}
+
+uint32_t connm_result_arena_hint(ConnManager *m, const char *connection_name) {
+  if (!m || !connection_name)
+    return 0;
+  pthread_mutex_lock(&m->lock);
+  ConnEntry *e = find_entry_or_leader(m, connection_name);
+  uint32_t hint = e ? e->result_arena_est : 0;
+  pthread_mutex_unlock(&m->lock);
+  return hint;
+}
+
+void connm_note_result_arena(ConnManager *m, const char *connection_name,
+                             uint32_t used_bytes) {
+  if (!m || !connection_name)
+    return;
+  pthread_mutex_lock(&m->lock);
+  ConnEntry *e = find_entry_or_leader(m, connection_name);
+  if (e) {
+    if (used_bytes > e->result_arena_est) {
+      // New high-water mark takes effect immediately.
+      e->result_arena_est = used_bytes;
+    } else {
+      // Decay 1/8 of the gap per observation so a one-off huge result does
+      // not pin an oversized first block forever.
+      e->result_arena_est -= (e->result_arena_est - used_bytes) / 8u;
+    }
+  }
+  pthread_mutex_unlock(&m->lock);
+}
+
+DbBackend *connm_parser_backend(ConnManager *m, const char *connection_name) {
+  if (!m)
+    return NULL;
+  pthread_mutex_lock(&m->lock);
+  ConnEntry *e = find_entry_or_leader(m, connection_name);
+  if (!e) {
+    pthread_mutex_unlock(&m->lock);
+    return NULL;
+  }
+
+  if (!e->parser_backend && m->factory)
+    e->parser_backend = m->factory(e->profile->kind);
+  DbBackend *pb = e->parser_backend;
+  pthread_mutex_unlock(&m->lock);
+  return pb;
+}
+
+const ConnProfile *connm_profile_by_idx(ConnManager *m, uint32_t catalog_idx) {
+  if (!m)
+    return NULL;
+  pthread_mutex_lock(&m->lock);
+  const ConnProfile *p = NULL;
+  for (size_t i = 0; i < m->n_entries; i++) {
+    if (m->entries[i].profile &&
+        m->entries[i].profile->catalog_idx == catalog_idx) {
+      p = m->entries[i].profile;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&m->lock);
+  return p;
+}
+
+size_t connm_list_profiles(ConnManager *m, const ConnProfile **out,
+                           size_t cap_count) {
+  if (!m)
+    return 0;
+  pthread_mutex_lock(&m->lock);
+  size_t n = m->n_entries;
+  if (!out || cap_count == 0) {
+    pthread_mutex_unlock(&m->lock);
+    return n;
+  }
+  if (n > cap_count)
+    n = cap_count;
+  for (size_t i = 0; i < n; i++)
+    out[i] = m->entries[i].profile;
+  pthread_mutex_unlock(&m->lock);
+  return n;
+}
+
+void connm_prewarm(ConnManager *m) {
+  if (!m || !m->entries)
+    return;
+
+  pthread_mutex_lock(&m->lock);
+  for (size_t i = 0; i < m->n_entries; i++) {
+    ConnEntry *e = &m->entries[i];
+    if (e->n_slots == 0)
+      continue;
+    if (ensure_connected(m, e, &e->slots[0]) != OK) {
+      TLOG("ERROR - prewarm failed for %s", e->profile->connection_name);
+    }
+  }
+  pthread_mutex_unlock(&m->lock);
+}
+
+/* Warms or probes one free slot of 'e' on the warm worker thread.
+ * Caller must hold m->lock. The slot is reserved via in_use and the lock is
+ * released around the slow network work, so checkouts on other profiles (and
+ * the remaining slots of this one) keep flowing while we connect or probe.
+ */
+static void connm_warm_entry(ConnManager *m, ConnEntry *e) {
+  if (!e || !e->profile || e->n_slots == 0)
+    return;
+  ConnSlot *slot = pick_free_slot(e);
+  if (!slot)
+    return; // whole pool checked out: it is as warm as it gets
+
+  if (!slot->backend) {
+    if (!m->factory)
+      return;
+    slot->backend = m->factory(e->profile->kind);
+    if (!slot->backend)
+      return;
+  }
+  slot->in_use = 1;
+  DbBackend *db = slot->backend;
+  const ConnProfile *profile = e->profile;
+
+  if (db_is_connected(db) == YES) {
+    // Probe: is_connected does no networking, so a statement round-trip is
+    // the only portable way to notice a half-dead connection.
+    pthread_mutex_unlock(&m->lock);
+    QueryResult *qr = NULL;
+    AdbxStatus prc = db_exec(db, "SELECT 1", NULL, &qr);
+    qr_destroy(qr);
+    if (prc != OK) {
+      TLOG("ERROR - warm probe failed for %s, reconnecting",
+           profile->connection_name);
+      db_disconnect(db);
+    }
+    pthread_mutex_lock(&m->lock);
+    if (prc == OK) {
+      slot->last_used_ms = now_ms_monotonic(); // keep the idle reaper away
+      slot->in_use = 0;
+      return;
+    }
+    // Fall through and reconnect the slot right away.
+  }
+
+  // The secret store is only ever touched under the lock (checkout does the
+  // same inside ensure_connected); only the connect itself runs unlocked.
+  StrBuf pw;
+  sb_init_small(&pw);
+  if (secret_store_get(m->secrets, &profile->secret_ref, &pw) != YES) {
+    TLOG("ERROR - warm connect: no usable secret for %s",
+         profile->connection_name);
+    sb_zero_clean(&pw);
+    slot->in_use = 0;
     return;
+  }
+
+  pthread_mutex_unlock(&m->lock);
+  AdbxStatus rc = db_connect(db, profile, &profile->safe_policy, pw.data);
+  sb_zero_clean(&pw);
+  if (rc != OK)
+    TLOG("ERROR - warm connect failed for %s", profile->connection_name);
+  pthread_mutex_lock(&m->lock);
+  if (rc == OK)
+    slot->last_used_ms = now_ms_monotonic();
+  slot->in_use = 0;
+}
+
+/* Warm worker main: sweeps every profile, then sleeps for the configured
+ * interval (or until connm_destroy wakes it to stop). */
+static void *connm_warm_main(void *arg) {
+  ConnManager *m = (ConnManager *)arg;
 
-  e->last_used_ms = now_ms_monotonic();
+  pthread_mutex_lock(&m->lock);
+  while (!m->warm_stop) {
+    for (size_t i = 0; i < m->n_entries && !m->warm_stop; i++)
+      connm_warm_entry(m, &m->entries[i]);
+    if (m->warm_stop)
+      break;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += (time_t)(m->warm_interval_ms / 1000u);
+    ts.tv_nsec += (long)(m->warm_interval_ms % 1000u) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec += 1;
+      ts.tv_nsec -= 1000000000L;
+    }
+    (void)pthread_cond_timedwait(&m->warm_wake, &m->lock, &ts);
+  }
+  pthread_mutex_unlock(&m->lock);
+  return NULL;
+}
+
+/* One-shot preconnect main: connects one pooled slot for every profile whose
+ * config sets "preconnect", then exits. Reuses connm_warm_entry so slot
+ * reservation and lock discipline match the warm worker, and checkouts on
+ * other profiles keep flowing while a connect is in progress. */
+static void *connm_preconnect_main(void *arg) {
+  ConnManager *m = (ConnManager *)arg;
+
+  pthread_mutex_lock(&m->lock);
+  for (size_t i = 0; i < m->n_entries && !m->warm_stop; i++) {
+    ConnEntry *e = &m->entries[i];
+    if (e->profile && e->profile->preconnect)
+      connm_warm_entry(m, e);
+  }
+  pthread_mutex_unlock(&m->lock);
+  return NULL;
+}
+
+AdbxStatus connm_preconnect_start(ConnManager *m) {
+  if (!m)
+    return ERR;
+
+  pthread_mutex_lock(&m->lock);
+  if (m->preconnect_started) {
+    pthread_mutex_unlock(&m->lock);
+    return OK;
+  }
+
+  int wanted = 0;
+  for (size_t i = 0; i < m->n_entries; i++) {
+    const ConnProfile *p = m->entries[i].profile;
+    if (p && p->preconnect) {
+      wanted = 1;
+      break;
+    }
+  }
+  if (!wanted) {
+    pthread_mutex_unlock(&m->lock);
+    return OK; // every profile stays lazy-connected
+  }
+
+  if (pthread_create(&m->preconnect_thread, NULL, connm_preconnect_main, m) !=
+      0) {
+    pthread_mutex_unlock(&m->lock);
+    return ERR;
+  }
+  m->preconnect_started = 1;
+  pthread_mutex_unlock(&m->lock);
+  return OK;
+}
+
+AdbxStatus connm_warm_start(ConnManager *m, uint64_t probe_interval_ms) {
+  if (!m)
+    return ERR;
+  pthread_mutex_lock(&m->lock);
+  if (m->warm_running) {
+    pthread_mutex_unlock(&m->lock);
+    return OK; // already running; the original interval stays in effect
+  }
+  m->warm_interval_ms =
+      probe_interval_ms ? probe_interval_ms : CONN_WARM_PROBE_INTERVAL_MS;
+  m->warm_stop = 0;
+  if (pthread_create(&m->warm_thread, NULL, connm_warm_main, m) != 0) {
+    pthread_mutex_unlock(&m->lock);
+    return ERR;
+  }
+  m->warm_running = 1;
+  pthread_mutex_unlock(&m->lock);
+  return OK;
 }
 
 void connm_set_ttl_ms(ConnManager *m, uint64_t ttl_ms) {
   if (!m)
     return;
+  pthread_mutex_lock(&m->lock);
   m->ttl_ms = ttl_ms;
+  pthread_mutex_unlock(&m->lock);
+}
+
+/* Returns 1 when 'a' and 'b' describe the same live connection: same backend
+ * kind, endpoint, credentials identity, and pool shape. Policy and sensitive
+ * rules are deliberately excluded so metadata-only edits keep warm backends. */
+static int connm_profile_conn_equal(const ConnProfile *a,
+                                    const ConnProfile *b) {
+  if (a->kind != b->kind || a->port != b->port ||
+      a->pool_size != b->pool_size)
+    return 0;
+  // Group membership counts as identity: re-grouping moves routing and the
+  // leader-bound session state, so it takes the full teardown path.
+  const char *pairs[5][2] = {
+      {a->host, b->host},
+      {a->db_name, b->db_name},
+      {a->user, b->user},
+      {a->options, b->options},
+      {a->replica_group, b->replica_group},
+  };
+  for (size_t i = 0; i < 5; i++) {
+    const char *x = pairs[i][0] ? pairs[i][0] : "";
+    const char *y = pairs[i][1] ? pairs[i][1] : "";
+    if (strcmp(x, y) != 0)
+      return 0;
+  }
+  return 1;
+}
+
+AdbxStatus connm_apply_catalog(ConnManager *m, ConnCatalog *fresh,
+                               ConnCatalog **old_out) {
+  if (!m || !fresh || !old_out)
+    return ERR;
+  *old_out = NULL;
+
+  // Quiesce the background workers first: they iterate the entry table and
+  // hold profile pointers across unlocked connects. Reload is an ops-rare
+  // event, so joining and restarting them beats fencing every window.
+  pthread_mutex_lock(&m->lock);
+  int warm_was_running = m->warm_running;
+  uint64_t warm_interval = m->warm_interval_ms;
+  int join_preconnect = m->preconnect_started;
+  m->warm_stop = 1;
+  if (warm_was_running)
+    pthread_cond_signal(&m->warm_wake);
+  pthread_mutex_unlock(&m->lock);
+  if (warm_was_running)
+    pthread_join(m->warm_thread, NULL);
+  if (join_preconnect)
+    pthread_join(m->preconnect_thread, NULL);
+
+  pthread_mutex_lock(&m->lock);
+  m->warm_stop = 0;
+  m->warm_running = 0;
+  m->preconnect_started = 0;
+
+  size_t total = catalog_count(fresh);
+  ConnProfile **tmp = NULL;
+  if (total > 0) {
+    tmp = xmalloc(total * sizeof(*tmp));
+    total = catalog_list(fresh, tmp, total);
+  }
+
+  // Pass 1: veto. Entries whose profile vanished, changed connection
+  // identity, or changed policy must be fully idle: a checked-out slot may
+  // be executing on a worker right now and its backend cannot be destroyed
+  // under it, and parked waiter cookies on a removed name would never be
+  // redeemed.
+  for (size_t i = 0; i < m->n_entries; i++) {
+    ConnEntry *e = &m->entries[i];
+    if (!e->profile)
+      continue;
+    const ConnProfile *np = NULL;
+    for (size_t j = 0; j < total; j++) {
+      if (strcmp(tmp[j]->connection_name, e->profile->connection_name) == 0) {
+        np = tmp[j];
+        break;
+      }
+    }
+    if (np && connm_profile_conn_equal(e->profile, np) &&
+        memcmp(&e->profile->safe_policy, &np->safe_policy,
+               sizeof(SafetyPolicy)) == 0) {
+      continue; // untouched; busy slots are fine
+    }
+    int busy = e->w_len > 0;
+    for (uint32_t s = 0; !busy && s < e->n_slots; s++)
+      busy = e->slots[s].in_use;
+    if (busy) {
+      pthread_mutex_unlock(&m->lock);
+      free(tmp);
+      if (warm_was_running)
+        (void)connm_warm_start(m, warm_interval);
+      return ERR;
+    }
+  }
+
+  // Pass 2: build the new entry table in fresh-catalog order, moving live
+  // state over from matching old entries.
+  ConnEntry *entries =
+      total > 0 ? (ConnEntry *)xmalloc(total * sizeof(*entries)) : NULL;
+  uint64_t t = now_ms_monotonic();
+  for (size_t j = 0; j < total; j++) {
+    ConnEntry *ne = &entries[j];
+    ConnEntry *oe = find_entry(m, tmp[j]->connection_name);
+    if (oe && connm_profile_conn_equal(oe->profile, tmp[j])) {
+      int policy_same = memcmp(&oe->profile->safe_policy, &tmp[j]->safe_policy,
+                               sizeof(SafetyPolicy)) == 0;
+      *ne = *oe;
+      ne->profile = tmp[j];
+      memset(oe, 0, sizeof(*oe)); // moved; pass 3 skips what is gone
+      if (!policy_same) {
+        // Same endpoint, new policy: drop the (idle, see veto) backends so
+        // the next checkout reconnects with the new connect-time settings.
+        for (uint32_t s = 0; s < ne->n_slots; s++) {
+          if (ne->slots[s].backend) {
+            db_destroy(ne->slots[s].backend);
+            ne->slots[s].backend = NULL;
+          }
+          ne->slots[s].last_used_ms = t;
+        }
+      }
+    } else {
+      memset(ne, 0, sizeof(*ne));
+      ne->profile = tmp[j];
+      ne->n_slots =
+          tmp[j]->pool_size ? tmp[j]->pool_size : CONN_POOL_SIZE_DEFAULT;
+      ne->slots = (ConnSlot *)xcalloc(ne->n_slots, sizeof(ConnSlot));
+      for (uint32_t s = 0; s < ne->n_slots; s++)
+        ne->slots[s].last_used_ms = t;
+    }
+  }
+
+  // Pass 3: tear down whatever did not move (removed and replaced entries).
+  for (size_t i = 0; i < m->n_entries; i++) {
+    ConnEntry *e = &m->entries[i];
+    for (uint32_t s = 0; s < e->n_slots; s++) {
+      if (e->slots[s].backend)
+        db_destroy(e->slots[s].backend);
+    }
+    free(e->slots);
+    if (e->parser_backend)
+      db_destroy(e->parser_backend);
+  }
+  free(m->entries);
+  free(tmp);
+
+  m->entries = entries;
+  m->n_entries = total;
+  *old_out = m->cat;
+  m->cat = fresh;
+  pthread_mutex_unlock(&m->lock);
+
+  if (warm_was_running)
+    (void)connm_warm_start(m, warm_interval);
+  return OK;
 }
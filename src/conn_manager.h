@@ -11,14 +11,26 @@
 
 typedef struct ConnManager ConnManager;
 
-/* Borrowed view over a ready-to-use connection managed by ConnManager.
- * - `db` and `profile` are owned by ConnManager.
- * - Both pointers are valid only while ConnManager is alive. */
+/* Borrowed view over one pooled connection checked out from ConnManager.
+ * - `db` and `profile` are owned by ConnManager and valid only while it is
+ *   alive.
+ * - A checked-out `db` is exclusive to the holder until connm_checkin(); no
+ *   other caller (or worker thread) executes on it in the meantime.
+ * - On CONN_CHECKOUT_BUSY only `profile` is populated and `db` is NULL. */
 typedef struct ConnView {
   DbBackend *db;
   const ConnProfile *profile;
 } ConnView;
 
+/* Outcome of connm_checkout(). Mirrors the AdbxTriStatus numbering for the
+ * shared cases and adds a "pool exhausted" state. */
+typedef enum {
+  CONN_CHECKOUT_ERR = -1,    // internal error (e.g. cannot connect)
+  CONN_CHECKOUT_UNKNOWN = 0, // connection_name not found
+  CONN_CHECKOUT_OK = 1,      // slot checked out; 'out' fully populated
+  CONN_CHECKOUT_BUSY = 2,    // every pooled slot is in use; wait and retry
+} ConnCheckoutStatus;
+
 /**
  * Creates and returns a ConnManager.
  *
@@ -49,34 +61,155 @@ ConnManager *connm_create_with_factory(ConnCatalog *cat, SecretStore *secrets,
 void connm_destroy(ConnManager *m);
 
 /**
- * Get a ready-to-use connection view for `connection_name`.
- * - Performs lazy connect on first use.
- * - May reconnect if the previous connection is broken.
- * - May reap idle connections before acquiring.
+ * Checks out one pooled connection for `connection_name`.
+ * - Each profile holds up to `pool_size` slots (config "poolSize", default 4);
+ *   slots are created and connected lazily on first checkout.
+ * - May reconnect a slot whose previous connection is broken.
+ * - May reap idle slots before acquiring.
+ * - A replica group tag (config "replicaGroup") also resolves: the checkout
+ *   is routed to the member with the fewest outstanding requests, failing
+ *   over past members whose last connect failed recently. `out->profile` is
+ *   then the member actually chosen.
  *
  * Ownership:
  * - `out->db` and `out->profile` are borrowed from ConnManager.
- * - caller must not free or mutate them.
+ * - On CONN_CHECKOUT_OK the caller holds `out->db` exclusively and must return
+ *   it with connm_checkin() exactly once.
+ *
+ * Error semantics: see ConnCheckoutStatus. On CONN_CHECKOUT_BUSY `out->profile`
+ * is still populated so callers can keep validating while they wait.
+ */
+ConnCheckoutStatus connm_checkout(ConnManager *m, const char *connection_name,
+                                  ConnView *out);
+
+/**
+ * Returns a checked-out connection to the pool and stamps it as used now.
+ * `db` must be a backend previously obtained from connm_checkout() for
+ * `connection_name`; unknown pairs are ignored.
+ */
+void connm_checkin(ConnManager *m, const char *connection_name, DbBackend *db);
+
+/**
+ * Registers an opaque waiter `cookie` (non-zero) in the FIFO wait queue of
+ * `connection_name`, to be redeemed later through connm_pop_waiter().
  *
- * Error semantics:
- * - YES: found and connected, `out` populated with valid pointers.
- * - NO:  connection_name not found.
- * - ERR: internal error (e.g. cannot connect).
+ * Error semantics: returns OK when queued, ERR on unknown name, zero cookie,
+ * or a full wait queue.
+ */
+AdbxStatus connm_wait(ConnManager *m, const char *connection_name,
+                      uint64_t cookie);
+
+/**
+ * Pops the oldest waiter cookie for `connection_name`, but only while a free
+ * pooled slot exists for it to claim. Returns 0 when nobody is waiting, no
+ * slot is free, or the name is unknown.
+ */
+uint64_t connm_pop_waiter(ConnManager *m, const char *connection_name);
+
+/**
+ * Returns a never-connected backend instance for `connection_name`, suitable
+ * for connection-independent work such as query-IR building during
+ * validation. Created lazily; borrowed from ConnManager. Returns NULL on
+ * unknown name or factory failure.
+ */
+DbBackend *connm_parser_backend(ConnManager *m, const char *connection_name);
+
+/**
+ * Returns the rolling high-water estimate (bytes) of result metadata-arena
+ * usage observed for `connection_name`; 0 when the name is unknown or no
+ * result was recorded yet. Callers pass it on as an arena pre-size hint so
+ * steady-state results skip the block-doubling ladder.
+ */
+uint32_t connm_result_arena_hint(ConnManager *m, const char *connection_name);
+
+/**
+ * Feeds one observed result metadata-arena size for `connection_name` into
+ * the rolling estimate: a new high-water mark takes effect immediately,
+ * smaller observations decay the estimate gradually. Unknown names are
+ * ignored.
  */
-AdbxTriStatus connm_get_connection(ConnManager *m, const char *connection_name,
-                                   ConnView *out);
+void connm_note_result_arena(ConnManager *m, const char *connection_name,
+                             uint32_t used_bytes);
 
 /**
- * Marks a connection as "used now" (e.g., call this after exec completes,
- * regardless of success/failure).
+ * Returns the borrowed profile whose catalog_idx equals `catalog_idx`, or
+ * NULL when no such profile exists. Used to resolve a replica group's leader
+ * (ConnProfile.group_leader_idx) for group-shared per-connection state.
+ */
+const ConnProfile *connm_profile_by_idx(ConnManager *m, uint32_t catalog_idx);
+
+/**
+ * Lists the catalog profiles this manager was built from.
+ *
+ * When `out` is NULL or `cap_count` is 0, returns the total number of
+ * profiles. Otherwise writes up to `cap_count` borrowed ConnProfile pointers
+ * into `out` and returns how many were written. Pointers stay valid until
+ * connm_destroy().
+ */
+size_t connm_list_profiles(ConnManager *m, const ConnProfile **out,
+                           size_t cap_count);
+
+/**
+ * Best-effort pre-warm: connects one pooled slot per profile so the first
+ * query does not pay the connection cost. Failures are logged and skipped.
+ */
+void connm_prewarm(ConnManager *m);
+
+/**
+ * Starts the one-shot preconnect thread for profiles whose config sets
+ * "preconnect": true: each gets one pooled slot connected (and its safety
+ * policy applied) in the background so the first query after broker start
+ * does not pay the connection cost. A no-op when no profile opted in.
+ *
+ * Ownership: borrows 'm'; the thread is joined by connm_destroy().
+ * Side effects: touches the secret store for every flagged profile.
+ * Error semantics: returns OK when the thread is running, already ran, or
+ * nothing opted in; ERR on bad input or thread creation failure.
+ */
+AdbxStatus connm_preconnect_start(ConnManager *m);
+
+/**
+ * Starts the opt-in warm pool worker: a background thread that pre-connects
+ * one pooled slot per profile, then every `probe_interval_ms` (0 = default,
+ * 30s) probes it with a trivial statement and reconnects it when the probe
+ * fails. First-query latency then matches steady state and dead connections
+ * are replaced before a checkout hands them out.
+ *
+ * Ownership: borrows 'm'; the thread is joined by connm_destroy().
+ * Side effects: touches the secret store for every profile; keeps one
+ * connection per profile alive past the idle TTL.
+ * Error semantics: returns OK when the worker is (already) running, ERR on
+ * bad input or thread creation failure.
+ */
+AdbxStatus connm_warm_start(ConnManager *m, uint64_t probe_interval_ms);
+
+/**
+ * Replaces the manager's catalog with `fresh` while keeping live state for
+ * profiles whose connection identity (kind, endpoint, credentials, pool
+ * shape) did not change: their pooled backends, parser backend, and arena
+ * estimate move over untouched, so warm connections survive a config reload.
+ * Profiles with a changed safety policy keep their slots but drop idle
+ * backends, so the next checkout reconnects with the new connect-time
+ * settings applied. New profiles start lazy; removed ones are torn down.
+ *
+ * Ownership: on OK the manager owns `fresh` and `*old_out` receives the
+ * previous catalog, which the caller must catalog_destroy() once nothing
+ * borrows its strings anymore. On ERR nothing changes and the caller still
+ * owns `fresh`.
+ * Side effects: quiesces (joins) the warm and preconnect workers around the
+ * swap and restarts the warm worker afterwards if it was running.
+ * Error semantics: returns ERR on bad input or when a changed/removed
+ * profile has a slot checked out or waiters parked — retry once in-flight
+ * work on it drains; untouched profiles may stay busy throughout.
  */
-void connm_mark_used(ConnManager *m, const char *connection_name);
+AdbxStatus connm_apply_catalog(ConnManager *m, ConnCatalog *fresh,
+                               ConnCatalog **old_out);
 
 /**
  * Overrides the idle TTL (milliseconds) for reaping connections.
  *
  * Ownership: borrows 'm'.
- * Side effects: affects when connm_get_backend will disconnect idle sessions.
+ * Side effects: affects when connm_checkout will disconnect idle slots.
  * Error semantics: no return value.
  */
 void connm_set_ttl_ms(ConnManager *m, uint64_t ttl_ms);
@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -1239,6 +1240,84 @@ credm_save_state_sync_one(const ConfDir *app, const ConnCatalog *state_cat,
  *
  * Error semantics: returns OK on success, else, ERR and modifies 'out_err'.
  */
+// How many prefetch workers resolve secret-store refs concurrently.
+#define CREDM_PREFETCH_THREADS 4u
+
+typedef struct {
+  SecretStore *store;
+  const SecretRefInfo *const *refs;
+  size_t n_refs;
+  size_t next; // next unclaimed ref index; guarded by 'lock'
+  pthread_mutex_t lock;
+} CredmPrefetchCtx;
+
+/* Worker loop: claims refs one at a time and resolves each through the store
+ * into a throwaway buffer, which warms the store's session cache. */
+static void *credm_prefetch_worker(void *arg) {
+  CredmPrefetchCtx *ctx = (CredmPrefetchCtx *)arg;
+  for (;;) {
+    pthread_mutex_lock(&ctx->lock);
+    size_t i = ctx->next++;
+    pthread_mutex_unlock(&ctx->lock);
+    if (i >= ctx->n_refs)
+      return NULL;
+
+    StrBuf secret;
+    sb_init(&secret);
+    (void)secret_store_get(ctx->store, ctx->refs[i], &secret);
+    sb_zero_clean(&secret);
+  }
+}
+
+/* Resolves every ref the sync plan may probe across a small thread pool, so
+ * per-ref backend round trips (libsecret/keychain, credential-file loads)
+ * overlap instead of serializing. Reads are safe to run concurrently per the
+ * SecretStore contract; writes stay on the caller's thread. Best-effort:
+ * lookup failures are ignored here because the planner re-probes each ref
+ * through the warmed cache and reports its own errors.
+ */
+static void credm_prefetch_secrets(SecretStore *store,
+                                   const ConnCatalog *conf_cat,
+                                   const ConnCatalog *state_cat) {
+  if (!store || !conf_cat || !state_cat)
+    return;
+
+  size_t n_refs = conf_cat->n_profiles + state_cat->n_profiles;
+  if (n_refs < 2)
+    return; // nothing to overlap
+
+  const SecretRefInfo **refs =
+      (const SecretRefInfo **)xcalloc(n_refs, sizeof(*refs));
+  size_t n = 0;
+  for (size_t i = 0; i < conf_cat->n_profiles; i++)
+    refs[n++] = &conf_cat->profiles[i].secret_ref;
+  for (size_t i = 0; i < state_cat->n_profiles; i++)
+    refs[n++] = &state_cat->profiles[i].secret_ref;
+
+  CredmPrefetchCtx ctx = {
+      .store = store, .refs = refs, .n_refs = n, .next = 0};
+  if (pthread_mutex_init(&ctx.lock, NULL) != 0) {
+    free(refs);
+    return;
+  }
+
+  pthread_t tids[CREDM_PREFETCH_THREADS];
+  size_t want = (n < CREDM_PREFETCH_THREADS) ? n : CREDM_PREFETCH_THREADS;
+  size_t started = 0;
+  for (size_t i = 0; i < want; i++) {
+    if (pthread_create(&tids[started], NULL, credm_prefetch_worker, &ctx) != 0)
+      break;
+    started++;
+  }
+  if (started == 0)
+    (void)credm_prefetch_worker(&ctx); // degrade to the sequential path
+  for (size_t i = 0; i < started; i++)
+    (void)pthread_join(tids[i], NULL);
+
+  pthread_mutex_destroy(&ctx.lock);
+  free(refs);
+}
+
 static AdbxStatus
 credm_plan_sync_all(const ConnCatalog *conf_cat, const ConnCatalog *state_cat,
                     SecretStore *store, CredmSyncAction **out_actions,
@@ -1250,6 +1329,10 @@ credm_plan_sync_all(const ConnCatalog *conf_cat, const ConnCatalog *state_cat,
   *out_actions = NULL;
   *out_state_seen = NULL;
 
+  // Overlap the per-ref secret-store round trips before the sequential
+  // reconciliation below; its probes then hit the warmed session cache.
+  credm_prefetch_secrets(store, conf_cat, state_cat);
+
   size_t conf_n = conf_cat->n_profiles;
   size_t state_n = state_cat->n_profiles;
   CredmSyncAction *actions =
@@ -12,11 +12,20 @@
 typedef struct DbBackend DbBackend;
 
 // Maximum number of bound parameters accepted by token-aware execution paths.
-#define MAX_TOKEN_PARAMS 10u
+// Sized for IN-lists agents send back after correlating tokens across
+// queries; the arrays this sizes live in heap-allocated jobs and short-lived
+// handler frames, so the headroom is cheap.
+#define MAX_TOKEN_PARAMS 64u
+
+struct HashTable; // see hash_table.h
 
 typedef struct DbSafeFuncList {
   const char **names; // sorted, lowercase, unqualified names
   uint32_t count;
+  // Optional name -> name membership index over 'names' for O(1) checks in
+  // the validator's IR walk; NULL when the backend does not provide one, in
+  // which case consumers fall back to binary search over 'names'.
+  const struct HashTable *index;
 } DbSafeFuncList;
 
 /* DB-facing bind parameter used by bound execution APIs.
@@ -64,6 +73,35 @@ typedef struct DbBackendVTable {
                            const QueryResultBuildPolicy *qb_policy,
                            QueryResult **out_qr);
 
+  // Opens one named server-side read cursor over 'sql' inside a transaction
+  // that stays open until cursor_close(). One cursor per connection: the
+  // connection must stay exclusively held while the cursor lives.
+  // Optional: backends without cursor support leave all three entries NULL.
+  AdbxStatus (*cursor_open)(DbBackend *db, const char *name, const char *sql);
+
+  // Fetches up to 'nrows' rows from the open cursor 'name' and materializes
+  // them like exec(); fewer rows than requested means the cursor is drained.
+  // Returns OK if it was able to allocate a QueryResult, ERR otherwise.
+  AdbxStatus (*cursor_fetch)(DbBackend *db, const char *name, uint32_t nrows,
+                             const QueryResultBuildPolicy *qb_policy,
+                             QueryResult **out_qr);
+
+  // Closes the cursor and ends its transaction. Safe when none is open.
+  void (*cursor_close)(DbBackend *db, const char *name);
+
+  // Best-effort cancel of the statement currently executing on this
+  // connection. Must be safe to call from a different thread than the one
+  // inside exec/exec_bound; a no-op when nothing is in flight. Optional:
+  // backends may leave it NULL.
+  void (*cancel_inflight)(DbBackend *db);
+
+  // Declares the priority class of the next exec()/exec_bound() call on this
+  // connection: the backend scopes its statement_timeout/work_mem bounds to
+  // that one statement (SET LOCAL on Postgres) and reverts to NORMAL
+  // afterwards. The caller must hold the backend exclusively, as for exec().
+  // Optional: backends may leave it NULL, in which case the class is ignored.
+  void (*set_priority)(DbBackend *db, SafetyPriority prio);
+
   // Creates a QirQueryHandle starting from 'sql'. The backend owns and
   // populates the handle, and the caller must destroy it via
   // qir_handle_destroy().
@@ -128,6 +166,40 @@ static inline AdbxStatus db_exec_bound(DbBackend *db, const char *sql,
   return db->vt->exec_bound(db, sql, params, nparams, qb_policy, out_qr);
 }
 
+static inline AdbxStatus db_cursor_open(DbBackend *db, const char *name,
+                                        const char *sql) {
+  if (!db || !db->vt || !db->vt->cursor_open)
+    return ERR;
+  return db->vt->cursor_open(db, name, sql);
+}
+
+static inline AdbxStatus db_cursor_fetch(DbBackend *db, const char *name,
+                                         uint32_t nrows,
+                                         const QueryResultBuildPolicy *qb_policy,
+                                         QueryResult **out_qr) {
+  if (!db || !db->vt || !db->vt->cursor_fetch)
+    return ERR;
+  return db->vt->cursor_fetch(db, name, nrows, qb_policy, out_qr);
+}
+
+static inline void db_cursor_close(DbBackend *db, const char *name) {
+  if (!db || !db->vt || !db->vt->cursor_close)
+    return;
+  db->vt->cursor_close(db, name);
+}
+
+static inline void db_cancel_inflight(DbBackend *db) {
+  if (!db || !db->vt || !db->vt->cancel_inflight)
+    return;
+  db->vt->cancel_inflight(db);
+}
+
+static inline void db_set_priority(DbBackend *db, SafetyPriority prio) {
+  if (!db || !db->vt || !db->vt->set_priority)
+    return;
+  db->vt->set_priority(db, prio);
+}
+
 static inline AdbxStatus db_make_query_ir(DbBackend *db, const char *sql,
                                           QirQueryHandle *out) {
   if (!db || !db->vt || !db->vt->make_query_ir)
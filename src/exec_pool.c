@@ -0,0 +1,456 @@
+#define _GNU_SOURCE
+
+#include "exec_pool.h"
+#include "log.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/eventfd.h>
+#endif
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* One worker thread with its private job queue. Jobs route here by session,
+ * so a session's work runs on one worker unless a rival steals it. All queue
+ * state is guarded by the pool lock. */
+typedef struct ExecWorker {
+  pthread_t thread;
+  ExecPool *pool;
+  uint32_t idx;
+  int cpu;                 // pinned CPU, or -1 when unpinned
+  pthread_cond_t has_work; // submit signals just this worker
+  uint8_t waiting;         // 1 while blocked in cond_wait (steal candidate)
+  ExecPoolJob *queue_head; // this worker's private FIFO
+  ExecPoolJob *queue_tail;
+  uint32_t queue_len;
+} ExecWorker;
+
+struct ExecPool {
+  pthread_mutex_t lock;
+
+  /* Completion hand-off is lock-free: workers push finished jobs onto
+   * 'done_lifo' (an intrusive atomic stack, newest first) with one CAS,
+   * and the owner drains it in pop_done with one exchange, reversing into
+   * 'done_ready' to restore completion order. The submit path keeps its
+   * mutex; this path is the one that runs per completed query. */
+  _Atomic(ExecPoolJob *) done_lifo;
+  ExecPoolJob *done_ready; // owner-thread only; oldest completion first
+
+  int notify_rfd;      // non-blocking fd polled by the owner
+  int notify_wfd;      // workers signal one completion here
+  uint8_t use_eventfd; // 1 => notify fds are one eventfd (u64 writes)
+
+  ExecWorker workers[EXEC_POOL_MAX_WORKERS];
+  uint32_t nworkers;
+  uint8_t pin;       // 1 => workers are pinned to CPUs (ADBX_EXEC_PIN)
+  int shutting_down; // guarded by lock
+};
+
+ExecPoolJob *exec_pool_job_create(void) {
+  ExecPoolJob *job = (ExecPoolJob *)xcalloc(1, sizeof(ExecPoolJob));
+  job->spill_dirfd = -1; // 0 is a valid fd; stay explicit about "disabled"
+  return job;
+}
+
+void exec_pool_job_destroy(ExecPoolJob *job) {
+  if (!job)
+    return;
+  free(job->sql);
+  free(job->conn_name);
+  mcp_id_clean(&job->id);
+  vq_out_clean(&job->vout);
+  qr_destroy(job->result);
+  free(job);
+}
+
+/* Appends 'job' to one intrusive FIFO. Caller must hold the pool lock. */
+static void job_list_push(ExecPoolJob **head, ExecPoolJob **tail,
+                          ExecPoolJob *job) {
+  job->next = NULL;
+  if (*tail) {
+    (*tail)->next = job;
+  } else {
+    *head = job;
+  }
+  *tail = job;
+}
+
+/* Pops the oldest job from one intrusive FIFO, or NULL when empty. Caller
+ * must hold the pool lock. */
+static ExecPoolJob *job_list_pop(ExecPoolJob **head, ExecPoolJob **tail) {
+  ExecPoolJob *job = *head;
+  if (!job)
+    return NULL;
+  *head = job->next;
+  if (!*head)
+    *tail = NULL;
+  job->next = NULL;
+  return job;
+}
+
+/* Runs one job on the calling worker thread and fills job->result.
+ * It borrows 'job'; the backend is exclusively the job's while it runs.
+ * Error semantics: fail-soft; job->result is a tool error on execution
+ * failure and NULL only on catastrophic allocation failure.
+ */
+static void exec_pool_run_job(ExecPoolJob *job) {
+  QueryResultBuildPolicy qb_policy = {
+      .plan = job->plan_override ? job->plan_override : &job->vout.plan,
+      .store = job->store,
+      .generation = job->generation,
+      .spill_dirfd = job->spill_dirfd,
+      .arena_size_hint = job->arena_size_hint,
+  };
+
+  QueryResult *res = NULL;
+  AdbxStatus rc;
+  if (job->cursor_op == EXEC_CURSOR_OPEN) {
+    rc = db_cursor_open(job->db, job->cursor_name, job->sql);
+    if (rc == OK) {
+      // Reply with the opaque handle; the broker installs the cursor state
+      // when it pops this job.
+      res = qr_create_ok(NULL, 1, 1, 0, 0);
+      QueryResultBuilder qb = {0};
+      if (!res || qb_init(&qb, res, NULL) != OK ||
+          qb_set_col(&qb, 0, "cursorHandle", "text", 0) != OK ||
+          qb_set_cell(&qb, 0, 0, job->cursor_handle,
+                      strlen(job->cursor_handle)) != YES) {
+        qr_destroy(res);
+        res = NULL;
+      }
+    }
+  } else if (job->cursor_op == EXEC_CURSOR_FETCH) {
+    rc = db_cursor_fetch(job->db, job->cursor_name, job->cursor_nrows,
+                         &qb_policy, &res);
+  } else if (job->bound) {
+    db_set_priority(job->db, (SafetyPriority)job->priority);
+    rc = db_exec_bound(job->db, job->sql, job->params, job->nparams, &qb_policy,
+                       &res);
+  } else {
+    db_set_priority(job->db, (SafetyPriority)job->priority);
+    rc = db_exec(job->db, job->sql, &qb_policy, &res);
+  }
+
+  if (rc != OK || !res) {
+    TLOG("ERROR - worker execution failed on %s",
+         job->conn_name ? job->conn_name : "?");
+    qr_destroy(res);
+    res = qr_create_tool_err(&job->id,
+                             "Database execution failed on connectionName "
+                             "'%s'.",
+                             job->conn_name ? job->conn_name : "?");
+  } else if (qr_set_id(res, &job->id) != OK) {
+    // exec leaves the id zeroed; stamping it failed -> degrade to an error
+    qr_destroy(res);
+    res = qr_create_tool_err(&job->id, "Internal error while finalizing the "
+                                       "query result.");
+  }
+
+  job->result = res;
+}
+
+/* Pops the oldest job off the longest rival queue, or NULL when every other
+ * queue is empty. Taking the victim's oldest job preserves FIFO order for
+ * the jobs the victim keeps. Caller must hold the pool lock. */
+static ExecPoolJob *exec_pool_steal(ExecPool *p, uint32_t thief) {
+  ExecWorker *victim = NULL;
+  for (uint32_t i = 0; i < p->nworkers; i++) {
+    ExecWorker *w = &p->workers[i];
+    if (i == thief || w->queue_len == 0)
+      continue;
+    if (!victim || w->queue_len > victim->queue_len)
+      victim = w;
+  }
+  if (!victim)
+    return NULL;
+  victim->queue_len--;
+  return job_list_pop(&victim->queue_head, &victim->queue_tail);
+}
+
+/* Worker thread main: pops jobs until shutdown, executes them, and signals
+ * completion through the notify pipe. A worker prefers its own queue (the
+ * session-routed work) and steals from the most loaded rival only when its
+ * own queue is empty, so skewed per-session load spreads to idle workers. */
+static void *exec_pool_worker_main(void *arg) {
+  ExecWorker *w = (ExecWorker *)arg;
+  ExecPool *p = w->pool;
+
+  for (;;) {
+    pthread_mutex_lock(&p->lock);
+    ExecPoolJob *job = NULL;
+    for (;;) {
+      if (w->queue_len > 0) {
+        w->queue_len--;
+        job = job_list_pop(&w->queue_head, &w->queue_tail);
+      } else {
+        job = exec_pool_steal(p, w->idx);
+      }
+      if (job || p->shutting_down)
+        break;
+      w->waiting = 1;
+      pthread_cond_wait(&w->has_work, &p->lock);
+      w->waiting = 0;
+    }
+    if (!job) { // shutting down and every queue is drained
+      pthread_mutex_unlock(&p->lock);
+      return NULL;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    exec_pool_run_job(job);
+
+    // Hand the completion off with one CAS; the release pairs with the
+    // acquire exchange in pop_done, publishing job->result.
+    ExecPoolJob *head = atomic_load_explicit(&p->done_lifo, memory_order_relaxed);
+    do {
+      job->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &p->done_lifo, &head, job, memory_order_release, memory_order_relaxed));
+
+    // Best-effort wakeup; the owner also drains done jobs opportunistically.
+    uint64_t one = 1;
+    size_t wlen = p->use_eventfd ? sizeof(one) : 1u;
+    ssize_t wr;
+    do {
+      wr = write(p->notify_wfd, &one, wlen);
+    } while (wr < 0 && errno == EINTR);
+  }
+}
+
+/* Parses a numeric env knob; absent, empty, or malformed values read as 0
+ * (which means "disabled" for every pool knob). */
+static uint32_t exec_pool_env_u32(const char *name) {
+  const char *raw = getenv(name);
+  if (!raw || !*raw)
+    return 0;
+  char *end = NULL;
+  unsigned long v = strtoul(raw, &end, 10);
+  if (end == raw || *end != '\0')
+    return 0;
+  return (uint32_t)v;
+}
+
+#ifdef __linux__
+/* Pins worker 'w' to one CPU, round-robin by worker index over the CPUs the
+ * process is allowed to run on. Consecutive indexes land on consecutive
+ * allowed CPUs, which interleaves workers across NUMA nodes on multi-socket
+ * hosts. Best-effort: on any failure the worker just stays unpinned. */
+static void exec_pool_pin_worker(ExecWorker *w) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    return;
+  uint32_t ncpus = (uint32_t)CPU_COUNT(&allowed);
+  if (ncpus == 0)
+    return;
+
+  uint32_t pick = w->idx % ncpus;
+  int cpu = -1;
+  uint32_t seen = 0;
+  for (int c = 0; c < CPU_SETSIZE; c++) {
+    if (!CPU_ISSET(c, &allowed))
+      continue;
+    if (seen++ == pick) {
+      cpu = c;
+      break;
+    }
+  }
+  if (cpu < 0)
+    return;
+
+  cpu_set_t one;
+  CPU_ZERO(&one);
+  CPU_SET(cpu, &one);
+  if (pthread_setaffinity_np(w->thread, sizeof(one), &one) != 0) {
+    TLOG("WARN - failed to pin exec worker %u to cpu %d", w->idx, cpu);
+    return;
+  }
+  w->cpu = cpu;
+}
+#endif /* __linux__ */
+
+ExecPool *exec_pool_create(uint32_t nworkers) {
+  if (nworkers == 0)
+    nworkers = 1;
+  if (nworkers > EXEC_POOL_MAX_WORKERS)
+    nworkers = EXEC_POOL_MAX_WORKERS;
+
+  ExecPool *p = (ExecPool *)xcalloc(1, sizeof(*p));
+  p->notify_rfd = -1;
+  p->notify_wfd = -1;
+  p->pin = (exec_pool_env_u32("ADBX_EXEC_PIN") != 0) ? 1 : 0;
+
+#ifdef __linux__
+  // One eventfd replaces the notify pipe where available: completions
+  // coalesce into a counter instead of queueing one byte each, so the fd
+  // can never fill up and a worker can never block on the wakeup write.
+  int efd = eventfd(0, EFD_NONBLOCK);
+  if (efd >= 0) {
+    p->notify_rfd = efd;
+    p->notify_wfd = efd;
+    p->use_eventfd = 1;
+  }
+#endif
+  if (!p->use_eventfd) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      free(p);
+      return NULL;
+    }
+    p->notify_rfd = fds[0];
+    p->notify_wfd = fds[1];
+
+    // Reads must never block the event loop; writes may block only if the
+    // pipe is full, which self-heals once the owner drains it.
+    int flags = fcntl(p->notify_rfd, F_GETFL, 0);
+    if (flags < 0 || fcntl(p->notify_rfd, F_SETFL, flags | O_NONBLOCK) != 0)
+      goto err_fds;
+  }
+
+  if (pthread_mutex_init(&p->lock, NULL) != 0)
+    goto err_fds;
+
+  for (uint32_t i = 0; i < nworkers; i++) {
+    ExecWorker *w = &p->workers[i];
+    w->pool = p;
+    w->idx = i;
+    w->cpu = -1;
+    if (pthread_cond_init(&w->has_work, NULL) != 0) {
+      for (uint32_t j = 0; j < i; j++)
+        pthread_cond_destroy(&p->workers[j].has_work);
+      goto err_mutex;
+    }
+  }
+
+  for (uint32_t i = 0; i < nworkers; i++) {
+    ExecWorker *w = &p->workers[i];
+    if (pthread_create(&w->thread, NULL, exec_pool_worker_main, w) != 0) {
+      // Roll back already-started workers.
+      pthread_mutex_lock(&p->lock);
+      p->shutting_down = 1;
+      for (uint32_t j = 0; j < i; j++)
+        pthread_cond_broadcast(&p->workers[j].has_work);
+      pthread_mutex_unlock(&p->lock);
+      for (uint32_t j = 0; j < i; j++)
+        pthread_join(p->workers[j].thread, NULL);
+      for (uint32_t j = 0; j < nworkers; j++)
+        pthread_cond_destroy(&p->workers[j].has_work);
+      goto err_mutex;
+    }
+    p->nworkers++;
+#ifdef __linux__
+    if (p->pin)
+      exec_pool_pin_worker(w);
+#endif
+  }
+
+  return p;
+
+err_mutex:
+  pthread_mutex_destroy(&p->lock);
+err_fds:
+  if (p->notify_wfd != p->notify_rfd)
+    close(p->notify_wfd);
+  close(p->notify_rfd);
+  free(p);
+  return NULL;
+}
+
+int exec_pool_done_fd(const ExecPool *p) { return p ? p->notify_rfd : -1; }
+
+AdbxStatus exec_pool_submit(ExecPool *p, ExecPoolJob *job) {
+  // FETCH jobs carry a cursor name instead of SQL.
+  int needs_sql = (job && job->cursor_op != EXEC_CURSOR_FETCH);
+  if (!p || !job || !job->db || (needs_sql && !job->sql))
+    return ERR;
+
+  job->submitted_ms = now_ms_monotonic();
+
+  pthread_mutex_lock(&p->lock);
+  if (p->shutting_down) {
+    pthread_mutex_unlock(&p->lock);
+    return ERR;
+  }
+  // Stable session-to-worker routing: all of a session's jobs land on the
+  // same home worker, so the arenas and spill buffers they first-touch stay
+  // warm (and, with pinning, NUMA-local) across the session's lifetime.
+  ExecWorker *w = &p->workers[job->session_serial % p->nworkers];
+  job_list_push(&w->queue_head, &w->queue_tail, job);
+  w->queue_len++;
+  if (w->waiting) {
+    pthread_cond_signal(&w->has_work);
+  } else {
+    // The home worker is mid-query; wake one idle worker so it can steal
+    // this job instead of it waiting out the running one.
+    for (uint32_t i = 1; i <= p->nworkers; i++) {
+      ExecWorker *o = &p->workers[(w->idx + i) % p->nworkers];
+      if (o->waiting) {
+        pthread_cond_signal(&o->has_work);
+        break;
+      }
+    }
+  }
+  pthread_mutex_unlock(&p->lock);
+  return OK;
+}
+
+ExecPoolJob *exec_pool_pop_done(ExecPool *p) {
+  if (!p)
+    return NULL;
+
+  if (!p->done_ready) {
+    // Grab everything the workers have pushed so far in one exchange, then
+    // reverse the newest-first stack back into completion order.
+    ExecPoolJob *lifo =
+        atomic_exchange_explicit(&p->done_lifo, NULL, memory_order_acquire);
+    while (lifo) {
+      ExecPoolJob *next = lifo->next;
+      lifo->next = p->done_ready;
+      p->done_ready = lifo;
+      lifo = next;
+    }
+  }
+
+  ExecPoolJob *job = p->done_ready;
+  if (job) {
+    p->done_ready = job->next;
+    job->next = NULL;
+  }
+  return job;
+}
+
+void exec_pool_destroy(ExecPool *p) {
+  if (!p)
+    return;
+
+  pthread_mutex_lock(&p->lock);
+  p->shutting_down = 1;
+  for (uint32_t i = 0; i < p->nworkers; i++)
+    pthread_cond_broadcast(&p->workers[i].has_work);
+  pthread_mutex_unlock(&p->lock);
+
+  for (uint32_t i = 0; i < p->nworkers; i++)
+    pthread_join(p->workers[i].thread, NULL);
+
+  // Workers are gone; release anything still queued or unclaimed.
+  ExecPoolJob *job;
+  for (uint32_t i = 0; i < p->nworkers; i++) {
+    ExecWorker *w = &p->workers[i];
+    while ((job = job_list_pop(&w->queue_head, &w->queue_tail)) != NULL)
+      exec_pool_job_destroy(job);
+    pthread_cond_destroy(&w->has_work);
+  }
+  while ((job = exec_pool_pop_done(p)) != NULL)
+    exec_pool_job_destroy(job);
+  pthread_mutex_destroy(&p->lock);
+  if (p->notify_wfd != p->notify_rfd)
+    close(p->notify_wfd);
+  close(p->notify_rfd);
+  free(p);
+}
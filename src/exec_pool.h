@@ -0,0 +1,145 @@
+#ifndef EXEC_POOL_H
+#define EXEC_POOL_H
+
+#include <stdint.h>
+
+#include "db_backend.h"
+#include "mcp_id.h"
+#include "query_result.h"
+#include "validator.h"
+
+/* A fixed pool of worker threads that executes validated SQL requests off a
+ * queue, so long-running queries never block the broker event loop.
+ *
+ * Flow:
+ * - The event loop validates a request, packages one ExecPoolJob, and submits
+ *   it with exec_pool_submit().
+ * - A worker runs db_exec()/db_exec_bound() on the job's backend and
+ *   materializes job->result. The submitter must hold the backend exclusively
+ *   (the broker checks one out from the connection pool per job).
+ * - Completion hand-off is lock-free: the worker pushes the job onto an
+ *   intrusive MPSC stack with one CAS and signals exec_pool_done_fd() (an
+ *   eventfd where available, else a pipe); the event loop drains finished
+ *   jobs in completion order with exec_pool_pop_done().
+ *
+ * Threading: submit/pop/destroy must be called from the owner (event loop)
+ * thread; workers only touch queued jobs.
+ *
+ * Scheduling: each worker owns a private FIFO and jobs route to a home
+ * worker per session (session_serial modulo pool size), so a session's
+ * scratch state stays warm on one thread under the many-small-queries
+ * pattern. An idle worker steals the oldest job from the most loaded rival,
+ * keeping latency flat when per-session load is skewed.
+ *
+ * Placement: with ADBX_EXEC_PIN=1 each worker is additionally pinned to one
+ * CPU (round-robin over the process's allowed set, which interleaves workers
+ * across NUMA nodes on multi-socket hosts). A session's result arenas are
+ * then first-touched from its home CPU, so their pages stay node-local from
+ * execution through serialization. The default (0) leaves workers unpinned.
+ */
+typedef struct ExecPool ExecPool;
+
+/* Cursor work carried by a job instead of a plain exec. OPEN declares a
+ * server-side cursor over job->sql; FETCH pulls the next page from a cursor
+ * opened earlier on the same checked-out backend. */
+typedef enum ExecPoolCursorOp {
+  EXEC_CURSOR_NONE = 0,
+  EXEC_CURSOR_OPEN = 1,
+  EXEC_CURSOR_FETCH = 2,
+} ExecPoolCursorOp;
+
+// Backend-side cursor names are broker-minted and short ("adbx_cur_<serial>").
+#define EXEC_CURSOR_NAME_BUFSZ 32u
+// Opaque client-facing handle: hex chars, excluding the NUL.
+#define EXEC_CURSOR_HANDLE_HEX_LEN 32u
+
+/* One queued execution request.
+ * Ownership:
+ * - sql, conn_name, and id are owned by the job and released by
+ *   exec_pool_job_destroy().
+ * - vout is moved into the job (do not vq_out_clean() after submit).
+ * - db and store are borrowed; the submitter must keep them alive until the
+ *   completed job is popped (the broker does this by keeping the pooled
+ *   connection checked out and busy sessions pinned while a job is in
+ *   flight).
+ * - params[i].value may point into 'store'; same lifetime rule applies.
+ * - result is owned by the job once a worker completes it.
+ */
+typedef struct ExecPoolJob {
+  uint64_t session_serial; // opaque routing key chosen by the submitter
+
+  DbBackend *db;   // borrowed; exclusively held for the job's lifetime
+  char *sql;       // owned
+  char *conn_name; // owned; used for error messages and pool checkin
+  McpId id;        // owned copy of the request id
+
+  DbExecParam params[MAX_TOKEN_PARAMS];
+  uint32_t nparams;
+  uint8_t bound;     // 1 => db_exec_bound(), 0 => db_exec()
+  uint8_t columnar;  // 1 => serialize the QR_OK result column-major
+  uint8_t priority;  // SafetyPriority declared for this request (the broker
+                     // caps it against the profile policy); applied to the
+                     // backend right before plain exec jobs run. The zero
+                     // value is SAFETY_PRIO_NORMAL, so cursor jobs and
+                     // submitters that never set it change nothing.
+  uint8_t cursor_op; // ExecPoolCursorOp; NONE => plain exec
+  uint8_t describe;  // 1 => the job fetched a catalog snapshot; the broker
+                     // retains the QR_OK result in its schema cache before
+                     // (or instead of) replying
+  int spill_dirfd;   // borrowed dir fd for overflow spill files; <= 0
+                     // disables spilling (exec_pool_job_create sets -1)
+  uint32_t arena_size_hint; // per-connection result-arena pre-size hint
+                            // forwarded to the build policy; 0 = default
+
+  // Cursor jobs only. 'name' is the backend-side cursor name, 'handle' the
+  // opaque token echoed back by an OPEN reply. FETCH jobs carry no sql/vout
+  // and instead borrow 'plan_override' (the plan retained when the cursor
+  // opened) for tokenization; it must outlive the job like db/store do.
+  char cursor_name[EXEC_CURSOR_NAME_BUFSZ];
+  char cursor_handle[EXEC_CURSOR_HANDLE_HEX_LEN + 1];
+  uint32_t cursor_nrows; // FETCH page size requested
+  const ValidatorPlan *plan_override;
+
+  ValidateQueryOut vout; // owned; provides the build-policy plan
+  DbTokenStore *store;   // borrowed
+  uint32_t generation;
+
+  uint64_t cache_ttl_ms; // broker result-cache retention for this response;
+                         // 0 = the completion is never cached
+
+  uint64_t submitted_ms; // set by exec_pool_submit()
+  QueryResult *result;   // owned; set by the worker
+
+  struct ExecPoolJob *next; // intrusive queue link (pool internal)
+} ExecPoolJob;
+
+/* Allocates one zeroed job. Returns NULL on allocation failure. */
+ExecPoolJob *exec_pool_job_create(void);
+
+/* Releases a job and everything it still owns (including result). Safe on
+ * NULL. */
+void exec_pool_job_destroy(ExecPoolJob *job);
+
+/* Creates a pool of 'nworkers' threads (clamped to [1..EXEC_POOL_MAX_WORKERS]).
+ * Returns NULL on allocation or thread/pipe creation failure. */
+ExecPool *exec_pool_create(uint32_t nworkers);
+
+#define EXEC_POOL_MAX_WORKERS 16u
+
+/* Returns the readable completion-notification fd (non-blocking). The fd is
+ * owned by the pool; poll it for readability and then drain pop_done(). */
+int exec_pool_done_fd(const ExecPool *p);
+
+/* Queues one job for execution. Takes ownership of 'job' on success; on ERR
+ * the caller still owns it. */
+AdbxStatus exec_pool_submit(ExecPool *p, ExecPoolJob *job);
+
+/* Pops one completed job, or NULL when none is ready. Caller owns the
+ * returned job and must exec_pool_job_destroy() it. */
+ExecPoolJob *exec_pool_pop_done(ExecPool *p);
+
+/* Waits for in-flight jobs to finish, joins all workers, and frees the pool
+ * plus any unclaimed jobs. Safe on NULL. */
+void exec_pool_destroy(ExecPool *p);
+
+#endif
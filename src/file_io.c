@@ -7,6 +7,7 @@
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -147,14 +148,56 @@ AdbxStatus fileio_sb_read_limit_fd(int fd, size_t max_bytes, StrBuf *out) {
   return OK;
 }
 
-AdbxStatus fileio_read_exact(const char *path, size_t n_bytes, uint8_t *out) {
-  if (fileio_validate_common(path, n_bytes) != OK)
+AdbxStatus fileio_map_ro_fd(int fd, size_t max_bytes, FileMap *out) {
+  if (fd < 0 || !out || fileio_validate_max_bytes(max_bytes) != OK)
     return ERR;
-  if (!out && n_bytes != 0)
+
+  memset(out, 0, sizeof(*out));
+  sb_init(&out->fallback);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
     return ERR;
 
-  int fd = open(path, O_RDONLY);
-  if (fd < 0)
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    if ((uint64_t)st.st_size > (uint64_t)max_bytes)
+      return ERR;
+    size_t len = (size_t)st.st_size;
+    void *base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base != MAP_FAILED) {
+      out->map_base = base;
+      out->map_len = len;
+      out->data = (const uint8_t *)base;
+      out->len = len;
+      return OK;
+    }
+    // e.g. a filesystem without mmap support; fall through to the read path.
+  }
+
+  ssize_t nread = -1;
+  if (fileio_sb_read_fd_impl(fd, max_bytes, &out->fallback, &nread) != OK)
+    return ERR;
+  out->data = (const uint8_t *)out->fallback.data;
+  out->len = out->fallback.len;
+  return OK;
+}
+
+void fileio_map_clean(FileMap *m) {
+  if (!m)
+    return;
+  if (m->map_base)
+    munmap(m->map_base, m->map_len);
+  m->map_base = NULL;
+  m->map_len = 0;
+  sb_zero_clean(&m->fallback);
+  m->data = NULL;
+  m->len = 0;
+}
+
+AdbxStatus fileio_read_exact_fd(int fd, size_t n_bytes, uint8_t *out) {
+  if (fd < 0 || fileio_validate_max_bytes(n_bytes) != OK)
+    return ERR;
+  if (!out && n_bytes != 0)
     return ERR;
 
   AdbxStatus rc = OK;
@@ -194,6 +237,18 @@ AdbxStatus fileio_read_exact(const char *path, size_t n_bytes, uint8_t *out) {
       rc = ERR;
   }
 
+  return rc;
+}
+
+AdbxStatus fileio_read_exact(const char *path, size_t n_bytes, uint8_t *out) {
+  if (fileio_validate_common(path, n_bytes) != OK)
+    return ERR;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return ERR;
+
+  AdbxStatus rc = fileio_read_exact_fd(fd, n_bytes, out);
   if (close(fd) != 0)
     rc = ERR;
   return rc;
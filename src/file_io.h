@@ -21,6 +21,34 @@ AdbxStatus fileio_sb_read_limit(const char *path, size_t max_bytes,
 /* Same as 'fileio_sb_read_limit' but reads from an already opened 'fd'. */
 AdbxStatus fileio_sb_read_limit_fd(int fd, size_t max_bytes, StrBuf *out);
 
+/* Read-only view of a whole file, mmap-backed when possible so parsers run
+ * zero-copy over the file bytes. 'data'/'len' stay valid until
+ * fileio_map_clean(); 'data' may be NULL only for an empty file. The
+ * fallback buffer owns the bytes when a mapping could not be established
+ * (non-regular file or mmap failure). */
+typedef struct FileMap {
+  const uint8_t *data;
+  size_t len;
+  void *map_base; // munmap target when mmap-backed, else NULL
+  size_t map_len;
+  StrBuf fallback; // owns the bytes on the read fallback path
+} FileMap;
+
+/* Maps the regular file behind 'fd' read-only, falling back to a bounded
+ * read into an owned buffer when mapping is not possible.
+ * Ownership: borrows 'fd'; the view outlives a later close of it. Caller
+ * must fileio_map_clean('out') in every outcome but ERR.
+ * Side effects: fstat and mmap, or read(2) calls from the current offset on
+ * the fallback path.
+ * Error semantics: returns OK on success, ERR on invalid input, I/O failure,
+ * or when content exceeds 'max_bytes'. */
+AdbxStatus fileio_map_ro_fd(int fd, size_t max_bytes, FileMap *out);
+
+/* Releases the mapping or fallback buffer; safe on an already-clean map.
+ * Fallback bytes are zeroed before release so secret payloads leave no heap
+ * residue. */
+void fileio_map_clean(FileMap *m);
+
 /* Fast, one-shot read. Reads exactly 'n_bytes' from 'path' into 'out' and
  * fails unless file size is exactly 'n_bytes'.
  * Ownership: borrows 'path'; writes into caller-owned 'out'.
@@ -29,6 +57,10 @@ AdbxStatus fileio_sb_read_limit_fd(int fd, size_t max_bytes, StrBuf *out);
  * when file size differs from 'n_bytes'. */
 AdbxStatus fileio_read_exact(const char *path, size_t n_bytes, uint8_t *out);
 
+/* Same as 'fileio_read_exact' but reads from an already opened 'fd' starting
+ * at its current offset. Borrows 'fd' and leaves it open. */
+AdbxStatus fileio_read_exact_fd(int fd, size_t n_bytes, uint8_t *out);
+
 /* ----------------------------------- write ------------------------------- */
 typedef struct FileMeta FileMeta;
 
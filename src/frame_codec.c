@@ -1,4 +1,5 @@
 #include "frame_codec.h"
+#include "hash_table.h"
 #include "utils.h"
 
 #include <arpa/inet.h>
@@ -50,46 +51,281 @@ AdbxStatus frame_read_len(BufChannel *bc, StrBuf *out_payload) {
   return OK;
 }
 
+void frame_batch_init(FrameBatch *fb, BufChannel *bc) {
+  if (!fb)
+    return;
+  memset(fb, 0, sizeof(*fb));
+  fb->bc = bc;
+}
+
+void frame_batch_reset(FrameBatch *fb) {
+  if (!fb)
+    return;
+  fb->nvecs = 0;
+  fb->nframes = 0;
+  fb->pending_bytes = 0;
+}
+
+AdbxStatus frame_batch_flush(FrameBatch *fb) {
+  if (!fb || !fb->bc)
+    return ERR;
+  if (fb->nvecs == 0)
+    return OK;
+
+  AdbxStatus rc = bufch_writev_all(fb->bc, fb->vecs, fb->nvecs);
+  // Queued frames are spent either way; a failed sink is torn down by the
+  // caller, so retrying the same bytes is never meaningful.
+  frame_batch_reset(fb);
+  return rc;
+}
+
+AdbxStatus frame_batch_add(FrameBatch *fb, const void *payload, uint32_t n) {
+  if (!fb || !fb->bc)
+    return ERR;
+  if (!payload && n != 0)
+    return ERR;
+
+  if (fb->nframes >= FRAME_BATCH_MAX_FRAMES ||
+      fb->pending_bytes >= FRAME_BATCH_WATERMARK_BYTES) {
+    if (frame_batch_flush(fb) != OK)
+      return ERR;
+  }
+
+  fb->hdrs[fb->nframes] = htonl(n);
+  fb->vecs[fb->nvecs].base = &fb->hdrs[fb->nframes];
+  fb->vecs[fb->nvecs].len = sizeof(fb->hdrs[0]);
+  fb->nvecs++;
+  if (n > 0) {
+    fb->vecs[fb->nvecs].base = payload;
+    fb->vecs[fb->nvecs].len = (size_t)n;
+    fb->nvecs++;
+  }
+  fb->nframes++;
+  fb->pending_bytes += (size_t)n;
+  return OK;
+}
+
+// Domain-separation seed for frame checksums, so a checksum never collides
+// by construction with a hash-table key computed over the same bytes.
+#define FRAME_CHECKSUM_SEED 0x66726d63UL // "frmc"
+
+uint64_t frame_checksum_vecs(const ByteChannelVec *vecs, size_t nvecs) {
+  if (!vecs && nvecs > 0)
+    return 0;
+
+  HtHashStream st;
+  ht_hash_stream_init_withSeed(&st, FRAME_CHECKSUM_SEED);
+  for (size_t i = 0; i < nvecs; i++)
+    ht_hash_stream_update(&st, vecs[i].base, vecs[i].len);
+  return ht_hash_stream_final(&st);
+}
+
+uint64_t frame_checksum_bytes(const void *data, size_t len) {
+  if (!data && len > 0)
+    return 0;
+
+  HtHashStream st;
+  ht_hash_stream_init_withSeed(&st, FRAME_CHECKSUM_SEED);
+  ht_hash_stream_update(&st, data, len);
+  return ht_hash_stream_final(&st);
+}
+
+AdbxTriStatus frame_peek_len(const BufChannel *bc, uint32_t *out_len) {
+  if (!bc || !out_len)
+    return ERR;
+
+  size_t avail = 0;
+  const uint8_t *p = bufch_peek(bc, &avail);
+  if (!p || avail < sizeof(uint32_t))
+    return NO;
+
+  uint32_t netlong;
+  memcpy(&netlong, p, sizeof(netlong));
+  *out_len = ntohl(netlong);
+  return YES;
+}
+
+AdbxTriStatus frame_read_len_buffered(BufChannel *bc, StrBuf *out_payload) {
+  if (!bc || !out_payload)
+    return ERR;
+
+  uint32_t n = 0;
+  AdbxTriStatus prc = frame_peek_len(bc, &n);
+  if (prc != YES)
+    return prc;
+
+  if (n > STRBUF_MAX_BYTES)
+    return ERR;
+#if SIZE_MAX < UINT32_MAX
+  if (n > SIZE_MAX)
+    return ERR;
+#endif
+
+  size_t avail = 0;
+  (void)bufch_peek(bc, &avail);
+  if (avail < sizeof(uint32_t) + (size_t)n)
+    return NO;
+
+  // The full frame is buffered; these read_exact calls never touch the
+  // underlying channel.
+  uint32_t netlong;
+  if (bufch_read_exact(bc, &netlong, sizeof(netlong)) != OK)
+    return ERR;
+
+  out_payload->len = 0;
+  if (n == 0)
+    return YES;
+
+  char *dst = NULL;
+  if (sb_prepare_for_write(out_payload, (size_t)n, &dst) != OK)
+    return ERR;
+  if (bufch_read_exact(bc, (unsigned char *)dst, (size_t)n) != OK)
+    return ERR;
+  return YES;
+}
+
+AdbxTriStatus frame_view_len(const BufChannel *bc, const uint8_t **out_payload,
+                             uint32_t *out_len) {
+  if (!bc || !out_payload || !out_len)
+    return ERR;
+  *out_payload = NULL;
+  *out_len = 0;
+
+  uint32_t n = 0;
+  AdbxTriStatus prc = frame_peek_len(bc, &n);
+  if (prc != YES)
+    return prc;
+
+  if (n > STRBUF_MAX_BYTES)
+    return ERR;
+#if SIZE_MAX < UINT32_MAX
+  if (n > SIZE_MAX)
+    return ERR;
+#endif
+
+  size_t avail = 0;
+  const uint8_t *p = bufch_peek(bc, &avail);
+  if (!p || avail < sizeof(uint32_t) + (size_t)n)
+    return NO;
+
+  *out_payload = p + sizeof(uint32_t);
+  *out_len = n;
+  return YES;
+}
+
+void frame_consume_len(BufChannel *bc, uint32_t payload_len) {
+  if (!bc)
+    return;
+  bufch_consume(bc, sizeof(uint32_t) + (size_t)payload_len);
+}
+
+// Wire size of one chunk control frame payload: tag + kind + BE u32 total.
+#define FRAME_CHUNK_CTRL_LEN 6u
+
+AdbxStatus frame_write_chunk_ctrl(BufChannel *bc, uint8_t kind,
+                                  uint32_t total) {
+  if (!bc || (kind != FRAME_CHUNK_CTRL_BEGIN && kind != FRAME_CHUNK_CTRL_END))
+    return ERR;
+
+  uint8_t wire[FRAME_CHUNK_CTRL_LEN];
+  wire[0] = FRAME_CHUNK_CTRL_TAG;
+  wire[1] = kind;
+  uint32_t netlong = htonl(total);
+  memcpy(wire + 2, &netlong, sizeof(netlong));
+
+  return frame_write_len(bc, wire, (uint32_t)sizeof(wire));
+}
+
+AdbxTriStatus frame_chunk_parse_ctrl(const uint8_t *payload, uint32_t len,
+                                     uint8_t kind, uint32_t *out_total) {
+  if (!payload || len == 0 || !out_total)
+    return ERR;
+  *out_total = 0;
+
+  if (payload[0] != FRAME_CHUNK_CTRL_TAG)
+    return NO;
+  if (len != FRAME_CHUNK_CTRL_LEN || payload[1] != kind)
+    return ERR;
+
+  uint32_t netlong;
+  memcpy(&netlong, payload + 2, sizeof(netlong));
+  *out_total = ntohl(netlong);
+  return YES;
+}
+
+// Header name template shared by the writer and the parser fast path; the
+// writer always emits it with the single trailing space.
+static const char FRAME_CL_NAME[] = "Content-Length:";
+#define FRAME_CL_NAME_LEN (sizeof(FRAME_CL_NAME) - 1u)
+// Name + space + worst-case decimal length + "\r\n\r\n".
+#define FRAME_CL_HEAD_MAX (FRAME_CL_NAME_LEN + 1u + STROP_DEC_MAX + 4u)
+
+/* Renders "Content-Length: <n>\r\n\r\n" into 'out' without snprintf: the
+ * prefix comes from the template and the digits from the shared pairs-table
+ * formatter. 'out' must hold FRAME_CL_HEAD_MAX bytes. Returns the length. */
+static size_t frame_render_cl_head(char *out, size_t n) {
+  memcpy(out, FRAME_CL_NAME, FRAME_CL_NAME_LEN);
+  char *w = out + FRAME_CL_NAME_LEN;
+  *w++ = ' ';
+  w += strop_u64_to_dec(w, n);
+  memcpy(w, "\r\n\r\n", 4);
+  return (size_t)(w + 4 - out);
+}
+
 AdbxStatus frame_write_cl(BufChannel *bc, const void *payload, size_t n) {
   if (!bc)
     return ERR;
   if (!payload && n != 0)
     return ERR;
 
-  char hdr[64];
-  // since we write in ASCII digits endianness is irrelevant
-  int rc = snprintf(hdr, sizeof(hdr), "Content-Length: %zu\r\n\r\n", n);
-  if (rc < 0 || (size_t)rc >= sizeof(hdr))
+  char hdr[FRAME_CL_HEAD_MAX];
+  size_t hlen = frame_render_cl_head(hdr, n);
+  return bufch_write2v(bc, hdr, hlen, payload, n);
+}
+
+AdbxStatus frame_write_cl_head(BufChannel *bc, size_t n) {
+  if (!bc)
     return ERR;
 
-  return bufch_write2v(bc, hdr, (size_t)rc, payload, n);
+  char hdr[FRAME_CL_HEAD_MAX];
+  size_t hlen = frame_render_cl_head(hdr, n);
+  return bufch_write_all(bc, hdr, hlen);
 }
 
-/* Parses Content-Length from a header. */
+/* Parses Content-Length from a NUL-terminated header. The common host frame
+ * starts with the header name itself and takes a prefix compare plus a
+ * branch-light digit loop; anything else (extra headers first) falls back to
+ * a strstr hunt. */
 static AdbxStatus parse_content_length(const char *hdr, size_t len,
                                        size_t *out_len) {
   if (!hdr || !out_len)
     return ERR;
   *out_len = 0;
-  (void)len;
 
-  const char *needle = "Content-Length:";
-  const char *p = strstr(hdr, needle);
-  if (!p)
-    return ERR;
-  p += strlen(needle);
+  const char *p;
+  if (len >= FRAME_CL_NAME_LEN &&
+      memcmp(hdr, FRAME_CL_NAME, FRAME_CL_NAME_LEN) == 0) {
+    p = hdr + FRAME_CL_NAME_LEN;
+  } else {
+    p = strstr(hdr, FRAME_CL_NAME);
+    if (!p)
+      return ERR;
+    p += FRAME_CL_NAME_LEN;
+  }
   while (*p == ' ' || *p == '\t')
     p++;
 
-  char *endptr = NULL;
-  unsigned long long v = strtoull(p, &endptr, 10);
-  if (endptr == p)
-    return ERR;
-
-  // we can't handle these much bytes and makes no sense doing it
-  if (v > STRBUF_MAX_BYTES)
-    return ERR;
-  if (v > SIZE_MAX)
+  // The cap check inside the loop doubles as the overflow guard: the value
+  // can never exceed ten times the cap between checks.
+  uint64_t v = 0;
+  const char *d = p;
+  for (unsigned c; (c = (unsigned)(unsigned char)*d - '0') <= 9u; d++) {
+    v = v * 10u + c;
+    // we can't handle these much bytes and makes no sense doing it
+    if (v > STRBUF_MAX_BYTES)
+      return ERR;
+  }
+  if (d == p)
     return ERR;
 
   *out_len = (size_t)v;
@@ -113,17 +349,16 @@ AdbxTriStatus frame_read_cl(BufChannel *bc, StrBuf *out_payload) {
   }
   size_t hdr_len = (size_t)idx + 4;
 
-  char *hdr = xmalloc(hdr_len + 1);
-  if (bufch_read_exact(bc, hdr, hdr_len) != OK) {
-    free(hdr);
+  // The scan cap bounds the header well under this stack buffer.
+  char hdr[64];
+  if (hdr_len >= sizeof(hdr))
+    return ERR;
+  if (bufch_read_exact(bc, hdr, hdr_len) != OK)
     return ERR;
-  }
   hdr[hdr_len] = '\0';
 
   size_t payload_len = 0;
-  AdbxStatus prc = parse_content_length(hdr, hdr_len, &payload_len);
-  free(hdr);
-  if (prc != OK)
+  if (parse_content_length(hdr, hdr_len, &payload_len) != OK)
     return ERR;
 
   if (payload_len == 0)
@@ -139,3 +374,55 @@ AdbxTriStatus frame_read_cl(BufChannel *bc, StrBuf *out_payload) {
   }
   return YES;
 }
+
+AdbxTriStatus frame_read_cl_buffered(BufChannel *bc, StrBuf *out_payload) {
+  if (!bc || !out_payload)
+    return ERR;
+
+  // Same strict header cap as frame_read_cl().
+  const size_t max_hdr_scan = 52;
+
+  size_t avail = 0;
+  const uint8_t *p = bufch_peek(bc, &avail);
+  if (!p || avail < 4)
+    return NO;
+
+  ssize_t idx = bufch_find_buffered(bc, "\r\n\r\n", 4);
+  if (idx < 0) {
+    // A valid header terminator must appear within the scan cap; once more
+    // bytes than that are buffered without one, the stream is malformed.
+    return (avail >= max_hdr_scan + 4) ? ERR : NO;
+  }
+  if ((size_t)idx > max_hdr_scan)
+    return ERR;
+
+  size_t hdr_len = (size_t)idx + 4;
+  char hdr[64];
+  if (hdr_len >= sizeof(hdr))
+    return ERR;
+  memcpy(hdr, p, hdr_len);
+  hdr[hdr_len] = '\0';
+
+  size_t payload_len = 0;
+  if (parse_content_length(hdr, hdr_len, &payload_len) != OK)
+    return ERR;
+
+  if (avail < hdr_len + payload_len)
+    return NO;
+
+  // The full frame is buffered; these read_exact calls never touch the
+  // underlying channel.
+  if (bufch_read_exact(bc, hdr, hdr_len) != OK)
+    return ERR;
+
+  out_payload->len = 0;
+  if (payload_len == 0)
+    return YES;
+
+  char *dst = NULL;
+  if (sb_prepare_for_write(out_payload, payload_len, &dst) != OK)
+    return ERR;
+  if (bufch_read_exact(bc, dst, payload_len) != OK)
+    return ERR;
+  return YES;
+}
@@ -11,19 +11,147 @@
 /* Writes <n><n bytes from 'payload'> with big-endian uint32 length prefix. */
 AdbxStatus frame_write_len(BufChannel *bc, const void *payload, uint32_t n);
 
+// Pending length-prefixed frames one FrameBatch coalesces into one writev().
+#define FRAME_BATCH_MAX_FRAMES 16u
+// Accumulated payload bytes past which frame_batch_add() flushes eagerly.
+#define FRAME_BATCH_WATERMARK_BYTES (256u * 1024u)
+
+/* Accumulates length-prefixed frames and writes them with one vectored write,
+ * cutting per-burst syscalls from two per frame to roughly one per burst.
+ * Ownership: borrows the sink channel; payloads are borrowed and must stay
+ * valid and unmodified until the next flush/reset.
+ */
+typedef struct FrameBatch {
+  BufChannel *bc; // borrowed sink channel
+  uint32_t hdrs[FRAME_BATCH_MAX_FRAMES]; // big-endian length prefixes
+  ByteChannelVec vecs[2u * FRAME_BATCH_MAX_FRAMES];
+  size_t nvecs;
+  size_t nframes;
+  size_t pending_bytes; // payload bytes queued but not yet written
+} FrameBatch;
+
+/* Initializes an empty batch over the borrowed sink channel 'bc'. */
+void frame_batch_init(FrameBatch *fb, BufChannel *bc);
+
+/* Queues one length-prefixed frame for the next flush. The payload is
+ * borrowed until then. Flushes eagerly first when the batch is out of slots
+ * or past FRAME_BATCH_WATERMARK_BYTES.
+ * Returns OK on success, ERR on invalid input or eager-flush write failure
+ * (the new frame is not queued then).
+ */
+AdbxStatus frame_batch_add(FrameBatch *fb, const void *payload, uint32_t n);
+
+/* Writes every queued frame with one vectored write (end-of-burst flush).
+ * Side effects: writes to the sink channel; the batch is empty afterwards
+ * even on failure.
+ * Returns OK when all queued bytes were written (or none were queued), ERR on
+ * write failure (the channel may hold a partial frame then).
+ */
+AdbxStatus frame_batch_flush(FrameBatch *fb);
+
+/* Drops every queued frame without writing. Use when the sink channel died. */
+void frame_batch_reset(FrameBatch *fb);
+
+/* Frame integrity checksums -----------------------------------------------
+ * Optional 64-bit checksum over one frame's bytes. The sender folds the
+ * gathered pieces of its vectored write in the traversal it already makes,
+ * so checksumming (and any cache keying off the same hash) costs no extra
+ * pass over the data; the receiver verifies against its contiguous buffered
+ * copy. The two forms agree whenever the concatenated vec bytes equal the
+ * contiguous bytes. Whether a channel carries checksums at all is up to its
+ * users; the codec only computes them.
+ */
+
+/* Checksums the concatenation of 'nvecs' pieces. vecs may be NULL only if
+ * nvecs == 0; empty input is valid. */
+uint64_t frame_checksum_vecs(const ByteChannelVec *vecs, size_t nvecs);
+
+/* Checksums one contiguous byte range (the receiver-side form). */
+uint64_t frame_checksum_bytes(const void *data, size_t len);
+
 /* Reads <n><n bytes> with big-endian uint32 length prefix and stores them into
  * 'out_payload'.
  * Returns OK on success, ERR on malformed frame, overflow, or I/O error. */
 AdbxStatus frame_read_len(BufChannel *bc, StrBuf *out_payload);
 
+/* Peeks the declared payload length of the next length-prefixed frame without
+ * consuming anything and without reading from the underlying channel.
+ * Returns YES with '*out_len' set when the 4-byte header is buffered, NO when
+ * fewer than 4 bytes are buffered, ERR on invalid input. */
+AdbxTriStatus frame_peek_len(const BufChannel *bc, uint32_t *out_len);
+
+/* Consumes one complete length-prefixed frame out of already-buffered bytes.
+ * This never reads from the underlying channel; callers multiplexing many
+ * channels should bufch_fill_some() on readiness and then drain frames here.
+ * Returns YES when one full frame was copied into 'out_payload', NO when the
+ * buffered bytes do not yet hold a full frame, ERR on malformed length or
+ * allocation failure. */
+AdbxTriStatus frame_read_len_buffered(BufChannel *bc, StrBuf *out_payload);
+
+/* Returns a borrowed zero-copy view of the next complete length-prefixed
+ * frame. The view points into the channel's read buffer and stays valid only
+ * until the next fill/read on 'bc'; call frame_consume_len() with the same
+ * length once done with the bytes. Never reads from the underlying channel.
+ * Returns YES with the outputs set when a full frame is buffered, NO when the
+ * buffered bytes do not yet hold a full frame, ERR on invalid input or
+ * malformed length. */
+AdbxTriStatus frame_view_len(const BufChannel *bc, const uint8_t **out_payload,
+                             uint32_t *out_len);
+
+/* Consumes one frame previously returned by frame_view_len().
+ * 'payload_len' must be the length that view call reported. */
+void frame_consume_len(BufChannel *bc, uint32_t payload_len);
+
+/* Chunked response framing ------------------------------------------------
+ * One logical reply larger than FRAME_CHUNK_THRESHOLD_BYTES travels as a
+ * 'begin' control frame declaring the total payload size, a run of ordinary
+ * length-prefixed frames whose payloads concatenate to exactly that size,
+ * and an 'end' control frame repeating it. Control frames start with a 0x00
+ * byte, which never appears in JSON text, so receivers can tell them apart
+ * from payload chunks without extra state. The channel delivers replies in
+ * request order, so the reply a chunk run belongs to stays implicit.
+ */
+#define FRAME_CHUNK_CTRL_TAG 0x00u
+#define FRAME_CHUNK_CTRL_BEGIN 'B'
+#define FRAME_CHUNK_CTRL_END 'E'
+// Reply payload bytes past which writers switch to chunked framing.
+#define FRAME_CHUNK_THRESHOLD_BYTES (256u * 1024u)
+// Payload bytes one chunk frame aims for; the last chunk may run shorter.
+#define FRAME_CHUNK_BYTES (64u * 1024u)
+
+/* Writes one chunk control frame: <6><0x00><kind><total as BE u32>.
+ * 'kind' is FRAME_CHUNK_CTRL_BEGIN or FRAME_CHUNK_CTRL_END.
+ * Returns OK on success, ERR on invalid input or write failure. */
+AdbxStatus frame_write_chunk_ctrl(BufChannel *bc, uint8_t kind,
+                                  uint32_t total);
+
+/* Classifies one frame payload already taken off the channel.
+ * Returns YES when it is a control frame of 'kind' ('*out_total' set), NO
+ * when it is not a control frame at all, ERR on a control frame of the wrong
+ * kind or a malformed one. */
+AdbxTriStatus frame_chunk_parse_ctrl(const uint8_t *payload, uint32_t len,
+                                     uint8_t kind, uint32_t *out_total);
+
 /* Writes Content-Length framed payload:
  * "Content-Length: <n>\r\n\r\n" + payload.
  * NOTE: use this only to write things the user should see. */
 AdbxStatus frame_write_cl(BufChannel *bc, const void *payload, size_t n);
 
+/* Writes only the "Content-Length: <n>\r\n\r\n" header; the caller streams
+ * exactly 'n' payload bytes afterwards or the channel desyncs. */
+AdbxStatus frame_write_cl_head(BufChannel *bc, size_t n);
+
 /* Reads Content-Length framed payload into out_payload.
  * Returns YES on success, NO on clean EOF before header, ERR on framing error.
  */
 AdbxTriStatus frame_read_cl(BufChannel *bc, StrBuf *out_payload);
 
+/* Consumes one complete Content-Length frame out of already-buffered bytes.
+ * This never reads from the underlying channel; callers multiplexing many
+ * channels should bufch_fill_some() on readiness and then drain frames here.
+ * Returns YES when one full frame was copied into 'out_payload', NO when the
+ * buffered bytes do not yet hold a full frame, ERR on malformed header or
+ * allocation failure. */
+AdbxTriStatus frame_read_cl_buffered(BufChannel *bc, StrBuf *out_payload);
+
 #endif
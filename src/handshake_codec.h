@@ -29,6 +29,10 @@
 #define HANDSHAKE_RESP_WIRE_SIZE (4u + 2u + 2u + RESUME_TOKEN_LEN + 4u + 4u)
 
 #define HANDSHAKE_FLAG_RESUME (1u << 0)
+/* Client capability: the MCP server can transcode binary results (see
+ * qr_wire.h), so the broker may skip JSON serialization on the private hop.
+ * Brokers that predate the flag ignore it and keep sending JSON. */
+#define HANDSHAKE_FLAG_BINARY_RESULTS (1u << 1)
 
 typedef struct {
   uint32_t magic;
@@ -8,12 +8,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Slot payloads live in a flat array parallel to the control bytes; occupancy
+ * is encoded in the control byte, not here. */
 typedef struct HashSlot {
   const void *key;   // borrowed
   uint32_t key_len;  // used by byte-key mode
   uint64_t hash;     // hash of key
   const void *value; // borrowed payload pointer
-  uint8_t used;      // 1 when occupied, 0 when empty
 } HashSlot;
 
 typedef enum HtMode {
@@ -23,20 +30,44 @@ typedef enum HtMode {
 } HtMode;
 
 struct HashTable {
+  uint8_t *ctrl;   // owned; one byte per slot: HT_CTRL_EMPTY or 7-bit tag
   HashSlot *slots; // owned
-  size_t cap;      // number of slots, power of two
+  size_t cap;      // number of slots, power of two (>= one group)
   size_t len;      // occupied slots
   size_t grow_at;  // resize threshold
   HtMode mode;     // key semantics for put/get
   HtHashFn hash_fn;
   HtEqFn eq_fn;
   void *ops_ctx;
+
+  // In-flight incremental rehash: the previous arrays stay live and readable
+  // while puts drain them into the current arrays a bounded step at a time,
+  // so growth never causes one large stop-the-world migration.
+  uint8_t *old_ctrl;   // owned; NULL when no migration is in flight
+  HashSlot *old_slots; // owned
+  size_t old_cap;
+  size_t old_len;      // entries not yet migrated
+  size_t migrate_pos;  // next old slot index the migration sweep will visit
 };
 
 #define HT_MIN_CAP 16u
 #define HT_LOAD_NUM 7u
 #define HT_LOAD_DEN 10u
 
+/* Control bytes are probed one aligned group at a time. A full slot carries
+ * the top 7 bits of its hash (0x00..0x7F); empty slots hold HT_CTRL_EMPTY.
+ * There is no delete in this API, so in the current table any group
+ * containing an empty byte terminates a probe chain; only the draining old
+ * table of an incremental rehash uses tombstones. */
+#define HT_GROUP 16u
+#define HT_CTRL_EMPTY 0x80u
+/* Old-table slots whose entry already migrated. Unlike HT_CTRL_EMPTY this
+ * does not terminate a probe chain, so lookups in the draining table still
+ * find entries placed past it. Never written into the current table. */
+#define HT_CTRL_TOMB 0x81u
+/* Old slots visited per mutating operation while a migration is in flight. */
+#define HT_MIGRATE_STEP (2u * HT_GROUP)
+
 inline uint64_t ht_hash_bytes(const void *data, size_t len) {
   return rapidhash(data, len);
 }
@@ -46,6 +77,99 @@ inline uint64_t ht_hash_bytes_withSeed(const void *key, size_t len,
   return rapidhash_withSeed(key, len, seed);
 }
 
+void ht_hash_stream_init(HtHashStream *st) {
+  // Same default seed as the one-shot rapidhash() entry point.
+  ht_hash_stream_init_withSeed(st, 0);
+}
+
+void ht_hash_stream_init_withSeed(HtHashStream *st, uint64_t seed) {
+  if (!st)
+    return;
+  st->h = seed;
+  st->total = 0;
+  st->fill = 0;
+}
+
+void ht_hash_stream_update(HtHashStream *st, const void *data, size_t len) {
+  if (!st || (!data && len > 0))
+    return;
+
+  const uint8_t *p = (const uint8_t *)data;
+  st->total += len;
+
+  if (st->fill > 0) {
+    size_t take = HT_HASH_STREAM_BLOCK - st->fill;
+    if (take > len)
+      take = len;
+    memcpy(st->block + st->fill, p, take);
+    st->fill += (uint32_t)take;
+    p += take;
+    len -= take;
+    if (st->fill < HT_HASH_STREAM_BLOCK)
+      return;
+    st->h = rapidhash_withSeed(st->block, HT_HASH_STREAM_BLOCK, st->h);
+    st->fill = 0;
+  }
+
+  // Full blocks fold straight from the caller's buffer: the only copies made
+  // are the sub-block head/tail around them.
+  while (len >= HT_HASH_STREAM_BLOCK) {
+    st->h = rapidhash_withSeed(p, HT_HASH_STREAM_BLOCK, st->h);
+    p += HT_HASH_STREAM_BLOCK;
+    len -= HT_HASH_STREAM_BLOCK;
+  }
+
+  if (len > 0) {
+    memcpy(st->block, p, len);
+    st->fill = (uint32_t)len;
+  }
+}
+
+uint64_t ht_hash_stream_final(const HtHashStream *st) {
+  if (!st)
+    return 0;
+  uint64_t h = st->h;
+  if (st->fill > 0)
+    h = rapidhash_withSeed(st->block, st->fill, h);
+  // Folding the total length separates streams whose trailing partial block
+  // is empty from ones a block boundary happened to end exactly.
+  return rapidhash_withSeed(&st->total, sizeof(st->total), h);
+}
+
+/* Returns the 7-bit control tag of 'hash' (always < HT_CTRL_EMPTY). The slot
+ * index uses the low bits, so the two are nearly independent. */
+static inline uint8_t ht_tag(uint64_t hash) { return (uint8_t)(hash >> 57); }
+
+/* Returns a 16-bit mask with bit i set when group byte i equals 'tag'.
+ * Compares a whole control group at once with SSE2/NEON when available so a
+ * lookup touches one cache line of metadata instead of chasing slot structs.
+ */
+static inline uint32_t ht_group_eq_mask(const uint8_t *g, uint8_t tag) {
+#if defined(__SSE2__)
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)(const void *)g);
+  __m128i eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag));
+  return (uint32_t)_mm_movemask_epi8(eq);
+#elif defined(__ARM_NEON)
+  uint8x16_t eq = vceqq_u8(vld1q_u8(g), vdupq_n_u8(tag));
+  const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128,
+                           1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t masked = vandq_u8(eq, bits);
+  return (uint32_t)vaddv_u8(vget_low_u8(masked)) |
+         ((uint32_t)vaddv_u8(vget_high_u8(masked)) << 8);
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < HT_GROUP; i++)
+    mask |= (uint32_t)(g[i] == tag) << i;
+  return mask;
+#endif
+}
+
+/* Returns the start index of the aligned control group that probing for
+ * 'hash' begins at in a table of 'cap' slots. */
+static inline size_t ht_first_group(size_t cap, uint64_t hash) {
+  return ((size_t)hash & (cap - 1)) & ~(size_t)(HT_GROUP - 1);
+}
+
 /* Hashes a custom key using caller-provided callback.
  * It borrows 'ht' and 'key' and does not allocate memory.
  * Side effects: invokes caller callback.
@@ -100,6 +224,7 @@ static size_t ht_calc_grow_at(size_t cap) {
 static void ht_zero(HashTable *ht) {
   if (!ht)
     return;
+  ht->ctrl = NULL;
   ht->slots = NULL;
   ht->cap = 0;
   ht->len = 0;
@@ -108,16 +233,21 @@ static void ht_zero(HashTable *ht) {
   ht->hash_fn = NULL;
   ht->eq_fn = NULL;
   ht->ops_ctx = NULL;
+  ht->old_ctrl = NULL;
+  ht->old_slots = NULL;
+  ht->old_cap = 0;
+  ht->old_len = 0;
+  ht->migrate_pos = 0;
 }
 
-/* Compares a slot key with (key,key_len) using hash+length+bytes.
+/* Compares a full slot key with (key,key_len) using hash+length+bytes.
  * It borrows all pointers and does not allocate memory.
  * Side effects: none.
  * Error semantics: returns YES on match, NO on mismatch.
  */
 static AdbxTriStatus ht_slot_key_eq_bytes(const HashSlot *slot, uint64_t hash,
                                           const char *key, uint32_t key_len) {
-  if (!slot || !key || !slot->used)
+  if (!slot || !key)
     return NO;
   if (slot->hash != hash || slot->key_len != key_len)
     return NO;
@@ -126,7 +256,7 @@ static AdbxTriStatus ht_slot_key_eq_bytes(const HashSlot *slot, uint64_t hash,
   return (memcmp(slot->key, key, key_len) == 0) ? YES : NO;
 }
 
-/* Compares a slot key with a custom lookup key using callback semantics.
+/* Compares a full slot key with a custom lookup key using callback semantics.
  * It borrows 'ht', 'slot', and 'key' and does not allocate memory.
  * Side effects: invokes caller eq callback.
  * Error semantics: returns YES on match, NO on mismatch.
@@ -136,9 +266,8 @@ static AdbxTriStatus ht_slot_key_eq_custom(const HashTable *ht,
                                            const void *key) {
   assert(ht);
   assert(ht->eq_fn);
-  assert(slot->key);
   assert(slot);
-  assert(slot->used);
+  assert(slot->key);
   assert(key);
   if (slot->hash != hash)
     return NO;
@@ -146,9 +275,24 @@ static AdbxTriStatus ht_slot_key_eq_custom(const HashTable *ht,
   return ht->eq_fn(slot->key, key, ht->ops_ctx);
 }
 
-/* Inserts one slot into a table that is guaranteed to have free capacity.
+/* Fills the slot at 'idx' and stamps its control byte. Caller guarantees the
+ * slot is empty. */
+static inline void ht_fill_slot(HashTable *ht, size_t idx, const void *key,
+                                uint32_t key_len, uint64_t hash,
+                                const void *value) {
+  HashSlot *slot = &ht->slots[idx];
+  slot->key = key;
+  slot->key_len = key_len;
+  slot->hash = hash;
+  slot->value = value;
+  ht->ctrl[idx] = ht_tag(hash);
+  ht->len++;
+}
+
+/* Inserts one slot into a table that is guaranteed to have free capacity and
+ * to not already contain the key (rehash path).
  * It borrows table memory and does not allocate.
- * Side effects: mutates one slot and increments len.
+ * Side effects: mutates one slot/control byte and increments len.
  * Returns OK on success, ERR on invalid input.
  */
 static AdbxStatus ht_insert_no_grow(HashTable *ht, const void *key,
@@ -162,70 +306,129 @@ static AdbxStatus ht_insert_no_grow(HashTable *ht, const void *key,
     return ERR;
 
   size_t mask = ht->cap - 1;
-  size_t idx = (size_t)hash & mask;
-  for (size_t steps = 0; steps < ht->cap; steps++) {
-    HashSlot *slot = &ht->slots[idx];
-    if (!slot->used) {
-      slot->used = 1;
-      slot->key = key;
-      slot->key_len = key_len;
-      slot->hash = hash;
-      slot->value = value;
-      ht->len++;
+  size_t group = ht_first_group(ht->cap, hash);
+  for (size_t steps = 0; steps < ht->cap; steps += HT_GROUP) {
+    uint32_t empty = ht_group_eq_mask(&ht->ctrl[group], HT_CTRL_EMPTY);
+    if (empty != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(empty);
+      ht_fill_slot(ht, idx, key, key_len, hash, value);
       return OK;
     }
-    idx = (idx + 1) & mask;
+    group = (group + HT_GROUP) & mask;
   }
 
   return ERR;
 }
 
-/* Rehashes all existing entries into a new capacity.
- * It borrows 'ht' and replaces its owned slot buffer.
- * Side effects: allocates new slot storage and frees old slot storage.
- * Returns OK on success, ERR on invalid input or allocation failure.
+/* Starts an incremental rehash into 'new_cap': the current arrays become the
+ * draining old table and fresh empty arrays take their place.
+ * Side effects: allocates the new storage; no entries move yet.
+ * Returns OK on success, ERR on invalid input.
  */
-static AdbxStatus ht_rehash(HashTable *ht, size_t new_cap) {
+static AdbxStatus ht_rehash_start(HashTable *ht, size_t new_cap) {
   assert(ht);
   assert(ht->slots);
+  assert(!ht->old_ctrl);
   if (ht->cap == 0)
     return ERR;
   if (new_cap < HT_MIN_CAP || (new_cap & (new_cap - 1)) != 0)
     return ERR;
 
-  HashSlot *old_slots = ht->slots;
-  size_t old_cap = ht->cap;
-  size_t old_len = ht->len;
-
-  HashSlot *new_slots = (HashSlot *)xcalloc(new_cap, sizeof(*new_slots));
+  ht->old_ctrl = ht->ctrl;
+  ht->old_slots = ht->slots;
+  ht->old_cap = ht->cap;
+  ht->old_len = ht->len;
+  ht->migrate_pos = 0;
 
-  ht->slots = new_slots;
+  ht->slots = (HashSlot *)xcalloc(new_cap, sizeof(HashSlot));
+  ht->ctrl = (uint8_t *)xmalloc(new_cap);
+  memset(ht->ctrl, HT_CTRL_EMPTY, new_cap);
   ht->cap = new_cap;
   ht->len = 0;
   ht->grow_at = ht_calc_grow_at(new_cap);
   assert(ht->grow_at != 0);
+  return OK;
+}
+
+/* Migrates up to HT_MIGRATE_STEP old slots into the current table and frees
+ * the old arrays once the sweep reaches the end. No-op when no migration is
+ * in flight. Called from mutating operations only, so const lookups stay
+ * read-only. */
+static void ht_migrate_step(HashTable *ht) {
+  if (!ht->old_ctrl)
+    return;
+
+  size_t budget = HT_MIGRATE_STEP;
+  while (budget > 0 && ht->migrate_pos < ht->old_cap) {
+    size_t i = ht->migrate_pos++;
+    budget--;
+    if (ht->old_ctrl[i] >= HT_CTRL_EMPTY)
+      continue; // empty or already migrated
+    HashSlot *slot = &ht->old_slots[i];
+    (void)ht_insert_no_grow(ht, slot->key, slot->key_len, slot->hash,
+                            slot->value);
+    ht->old_ctrl[i] = HT_CTRL_TOMB;
+    ht->old_len--;
+  }
+
+  if (ht->migrate_pos >= ht->old_cap) {
+    assert(ht->old_len == 0);
+    free(ht->old_ctrl);
+    free(ht->old_slots);
+    ht->old_ctrl = NULL;
+    ht->old_slots = NULL;
+    ht->old_cap = 0;
+    ht->old_len = 0;
+    ht->migrate_pos = 0;
+  }
+}
+
+/* Looks up 'key' in the draining old table of an in-flight migration.
+ * Probing skips tombstones and stops only at a truly empty byte, so entries
+ * placed past already-migrated slots are still found.
+ * Error semantics: returns the slot on a match, NULL when absent or when no
+ * migration is in flight.
+ */
+static const HashSlot *ht_old_find(const HashTable *ht, uint64_t hash,
+                                   const void *key, uint32_t key_len) {
+  if (!ht->old_ctrl || ht->old_len == 0)
+    return NULL;
 
-  for (size_t i = 0; i < old_cap; i++) {
-    HashSlot *slot = &old_slots[i];
-    if (!slot->used)
-      continue;
-    if (ht_insert_no_grow(ht, slot->key, slot->key_len, slot->hash,
-                          slot->value) != OK) {
-      // This should not happen with a correctly-sized table.
-      free(old_slots);
-      return ERR;
+  uint8_t tag = ht_tag(hash);
+  size_t mask = ht->old_cap - 1;
+  size_t group = ht_first_group(ht->old_cap, hash);
+  for (size_t steps = 0; steps < ht->old_cap; steps += HT_GROUP) {
+    uint32_t match = ht_group_eq_mask(&ht->old_ctrl[group], tag);
+    while (match != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(match);
+      const HashSlot *slot = &ht->old_slots[idx];
+      AdbxTriStatus eq =
+          (ht->mode == HT_MODE_BYTES)
+              ? ht_slot_key_eq_bytes(slot, hash, (const char *)key, key_len)
+              : ht_slot_key_eq_custom(ht, slot, hash, key);
+      if (eq == YES)
+        return slot;
+      match &= match - 1;
     }
+    if (ht_group_eq_mask(&ht->old_ctrl[group], HT_CTRL_EMPTY) != 0)
+      return NULL;
+    group = (group + HT_GROUP) & mask;
   }
-  free(old_slots);
 
-  if (ht->len != old_len)
-    return ERR;
-  return OK;
+  return NULL;
+}
+
+/* Removes one old-table slot found via ht_old_find() so it will not be
+ * migrated again. Caller must hold a mutable table. */
+static void ht_old_remove(HashTable *ht, const HashSlot *slot) {
+  size_t idx = (size_t)(slot - ht->old_slots);
+  ht->old_ctrl[idx] = HT_CTRL_TOMB;
+  ht->old_len--;
 }
 
 /* Grows table when load factor reached.
- * It borrows 'ht' and may rehash storage.
- * Side effects: may allocate and move slots.
+ * It borrows 'ht' and may start an incremental rehash.
+ * Side effects: may allocate new storage and move a bounded batch of slots.
  * Returns OK on success, ERR on invalid input or allocation/overflow failure.
  */
 static AdbxStatus ht_ensure_room(HashTable *ht) {
@@ -234,9 +437,14 @@ static AdbxStatus ht_ensure_room(HashTable *ht) {
   assert(ht->cap != 0);
   if (ht->len < ht->grow_at)
     return OK;
+  // Never hold two draining tables. In practice the migration sweep outpaces
+  // the inserts needed to reach the next threshold by a wide margin, so this
+  // drain is almost always already complete.
+  while (ht->old_ctrl)
+    ht_migrate_step(ht);
   if (ht->cap > SIZE_MAX / 2)
     return ERR;
-  return ht_rehash(ht, ht->cap * 2);
+  return ht_rehash_start(ht, ht->cap * 2);
 }
 
 /* Initializes hash table internals with requested key mode/callbacks.
@@ -256,6 +464,10 @@ static AdbxStatus ht_init_common(HashTable *ht, size_t min_slots, HtMode mode,
 
   if (ht->slots)
     free(ht->slots);
+  if (ht->ctrl)
+    free(ht->ctrl);
+  free(ht->old_slots);
+  free(ht->old_ctrl);
   ht_zero(ht);
 
   size_t cap = ht_next_cap(min_slots);
@@ -265,7 +477,10 @@ static AdbxStatus ht_init_common(HashTable *ht, size_t min_slots, HtMode mode,
   HashSlot *slots = (HashSlot *)xcalloc(cap, sizeof(*slots));
   if (!slots)
     return ERR;
+  uint8_t *ctrl = (uint8_t *)xmalloc(cap);
+  memset(ctrl, HT_CTRL_EMPTY, cap);
 
+  ht->ctrl = ctrl;
   ht->slots = slots;
   ht->cap = cap;
   ht->len = 0;
@@ -337,7 +552,10 @@ HashTable *ht_create_custom(HtHashFn hash_fn, HtEqFn eq_fn, void *ctx) {
 void ht_clean(HashTable *ht) {
   if (!ht)
     return;
+  free(ht->ctrl);
   free(ht->slots);
+  free(ht->old_ctrl);
+  free(ht->old_slots);
   ht_zero(ht);
 }
 
@@ -351,7 +569,7 @@ void ht_destroy(HashTable *ht) {
 size_t ht_len(const HashTable *ht) {
   if (!ht)
     return 0;
-  return ht->len;
+  return ht->len + ht->old_len;
 }
 
 AdbxStatus ht_put(HashTable *ht, const char *key, uint32_t key_len,
@@ -362,26 +580,36 @@ AdbxStatus ht_put(HashTable *ht, const char *key, uint32_t key_len,
   assert(ht->cap != 0);
   if (ht_ensure_room(ht) != OK)
     return ERR;
+  ht_migrate_step(ht);
 
   uint64_t hash = ht_hash_bytes(key, key_len);
+  uint8_t tag = ht_tag(hash);
   size_t mask = ht->cap - 1;
-  size_t idx = (size_t)hash & mask;
-  for (size_t steps = 0; steps < ht->cap; steps++) {
-    HashSlot *slot = &ht->slots[idx];
-    if (!slot->used) {
-      slot->used = 1;
-      slot->key = key;
-      slot->key_len = key_len;
-      slot->hash = hash;
-      slot->value = value;
-      ht->len++;
-      return OK;
+  size_t group = ht_first_group(ht->cap, hash);
+  for (size_t steps = 0; steps < ht->cap; steps += HT_GROUP) {
+    uint32_t match = ht_group_eq_mask(&ht->ctrl[group], tag);
+    while (match != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(match);
+      HashSlot *slot = &ht->slots[idx];
+      if (ht_slot_key_eq_bytes(slot, hash, key, key_len) == YES) {
+        slot->value = value;
+        return OK;
+      }
+      match &= match - 1;
     }
-    if (ht_slot_key_eq_bytes(slot, hash, key, key_len) == YES) {
-      slot->value = value;
+    uint32_t empty = ht_group_eq_mask(&ht->ctrl[group], HT_CTRL_EMPTY);
+    if (empty != 0) {
+      // An empty byte ends the probe chain: the key is absent here. A copy
+      // may still sit in the draining old table; retire it so migration
+      // cannot resurrect the stale value later.
+      const HashSlot *old = ht_old_find(ht, hash, key, key_len);
+      if (old)
+        ht_old_remove(ht, old);
+      size_t idx = group + (size_t)__builtin_ctz(empty);
+      ht_fill_slot(ht, idx, key, key_len, hash, value);
       return OK;
     }
-    idx = (idx + 1) & mask;
+    group = (group + HT_GROUP) & mask;
   }
 
   return ERR;
@@ -394,15 +622,24 @@ const void *ht_get(const HashTable *ht, const char *key, uint32_t key_len) {
   assert(ht->cap != 0);
 
   uint64_t hash = ht_hash_bytes(key, key_len);
+  uint8_t tag = ht_tag(hash);
   size_t mask = ht->cap - 1;
-  size_t idx = (size_t)hash & mask;
-  for (size_t steps = 0; steps < ht->cap; steps++) {
-    const HashSlot *slot = &ht->slots[idx];
-    if (!slot->used)
-      return NULL;
-    if (ht_slot_key_eq_bytes(slot, hash, key, key_len) == YES)
-      return slot->value;
-    idx = (idx + 1) & mask;
+  size_t group = ht_first_group(ht->cap, hash);
+  for (size_t steps = 0; steps < ht->cap; steps += HT_GROUP) {
+    uint32_t match = ht_group_eq_mask(&ht->ctrl[group], tag);
+    while (match != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(match);
+      const HashSlot *slot = &ht->slots[idx];
+      if (ht_slot_key_eq_bytes(slot, hash, key, key_len) == YES)
+        return slot->value;
+      match &= match - 1;
+    }
+    if (ht_group_eq_mask(&ht->ctrl[group], HT_CTRL_EMPTY) != 0) {
+      // Absent here; an in-flight migration may still hold it.
+      const HashSlot *old = ht_old_find(ht, hash, key, key_len);
+      return old ? old->value : NULL;
+    }
+    group = (group + HT_GROUP) & mask;
   }
 
   return NULL;
@@ -419,25 +656,32 @@ AdbxStatus ht_put_custom(HashTable *ht, const void *key, const void *value) {
   uint64_t hash = ht_hash_custom(ht, key);
   if (hash == 0)
     return ERR;
+  ht_migrate_step(ht);
 
+  uint8_t tag = ht_tag(hash);
   size_t mask = ht->cap - 1;
-  size_t idx = (size_t)hash & mask;
-  for (size_t steps = 0; steps < ht->cap; steps++) {
-    HashSlot *slot = &ht->slots[idx];
-    if (!slot->used) {
-      slot->used = 1;
-      slot->key = key;
-      slot->key_len = 0;
-      slot->hash = hash;
-      slot->value = value;
-      ht->len++;
-      return OK;
+  size_t group = ht_first_group(ht->cap, hash);
+  for (size_t steps = 0; steps < ht->cap; steps += HT_GROUP) {
+    uint32_t match = ht_group_eq_mask(&ht->ctrl[group], tag);
+    while (match != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(match);
+      HashSlot *slot = &ht->slots[idx];
+      if (ht_slot_key_eq_custom(ht, slot, hash, key) == YES) {
+        slot->value = value;
+        return OK;
+      }
+      match &= match - 1;
     }
-    if (ht_slot_key_eq_custom(ht, slot, hash, key) == YES) {
-      slot->value = value;
+    uint32_t empty = ht_group_eq_mask(&ht->ctrl[group], HT_CTRL_EMPTY);
+    if (empty != 0) {
+      const HashSlot *old = ht_old_find(ht, hash, key, 0);
+      if (old)
+        ht_old_remove(ht, old);
+      size_t idx = group + (size_t)__builtin_ctz(empty);
+      ht_fill_slot(ht, idx, key, 0, hash, value);
       return OK;
     }
-    idx = (idx + 1) & mask;
+    group = (group + HT_GROUP) & mask;
   }
 
   return ERR;
@@ -453,15 +697,23 @@ const void *ht_get_custom(const HashTable *ht, const void *key) {
   if (hash == 0)
     return NULL;
 
+  uint8_t tag = ht_tag(hash);
   size_t mask = ht->cap - 1;
-  size_t idx = (size_t)hash & mask;
-  for (size_t steps = 0; steps < ht->cap; steps++) {
-    const HashSlot *slot = &ht->slots[idx];
-    if (!slot->used)
-      return NULL;
-    if (ht_slot_key_eq_custom(ht, slot, hash, key) == YES)
-      return slot->value;
-    idx = (idx + 1) & mask;
+  size_t group = ht_first_group(ht->cap, hash);
+  for (size_t steps = 0; steps < ht->cap; steps += HT_GROUP) {
+    uint32_t match = ht_group_eq_mask(&ht->ctrl[group], tag);
+    while (match != 0) {
+      size_t idx = group + (size_t)__builtin_ctz(match);
+      const HashSlot *slot = &ht->slots[idx];
+      if (ht_slot_key_eq_custom(ht, slot, hash, key) == YES)
+        return slot->value;
+      match &= match - 1;
+    }
+    if (ht_group_eq_mask(&ht->ctrl[group], HT_CTRL_EMPTY) != 0) {
+      const HashSlot *old = ht_old_find(ht, hash, key, 0);
+      return old ? old->value : NULL;
+    }
+    group = (group + HT_GROUP) & mask;
   }
 
   return NULL;
@@ -37,6 +37,40 @@ uint64_t ht_hash_bytes(const void *data, size_t len);
  * one hash from 2+ non contiguos values. */
 uint64_t ht_hash_bytes_withSeed(const void *key, size_t len, uint64_t seed);
 
+// Bytes one HtHashStream folds per chaining step. Fold boundaries are
+// positions in the logical stream, never in a caller's buffer, so equal byte
+// sequences hash equal however they arrive.
+#define HT_HASH_STREAM_BLOCK 256u
+
+/* Incremental hashing for data that arrives in pieces: chunked frame
+ * payloads, cache keys assembled from several non-contiguous fields. Feed
+ * any number of updates; the result depends only on the concatenated bytes,
+ * not on how they were split across calls. The value is NOT interchangeable
+ * with ht_hash_bytes() over the same bytes — pick one per keyspace.
+ * Ownership: caller-owned storage, no allocation; reuse after re-init.
+ */
+typedef struct HtHashStream {
+  uint64_t h;     // chained block state
+  uint64_t total; // bytes folded since init
+  uint32_t fill;  // bytes pending in 'block'
+  uint8_t block[HT_HASH_STREAM_BLOCK];
+} HtHashStream;
+
+/* Starts (or restarts) a stream with the default seed. */
+void ht_hash_stream_init(HtHashStream *st);
+
+/* Same with a caller-defined seed, for domain separation between keyspaces
+ * that may see the same bytes. */
+void ht_hash_stream_init_withSeed(HtHashStream *st, uint64_t seed);
+
+/* Folds 'len' more bytes into the stream. It's up to the caller to validate
+ * input; data may be NULL only if len == 0. */
+void ht_hash_stream_update(HtHashStream *st, const void *data, size_t len);
+
+/* Finishes the stream and returns the 64-bit hash. The state is unchanged;
+ * further updates continue the stream as if final was never called. */
+uint64_t ht_hash_stream_final(const HtHashStream *st);
+
 /* Allocates a caller-owned hash table with default capacity.
  * Ownership: caller owns the returned table and must call ht_destroy().
  * Side effects: allocates heap memory.
@@ -1,9 +1,20 @@
 #include "json_codec.h"
+#include "arena.h"
+#include "frame_codec.h"
+#include "hash_table.h"
+#include "perf_counters.h"
 #include "string_op.h"
 #include "utils.h"
 
+#include <arpa/inet.h>
 #include <assert.h>
 #include <ctype.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
@@ -14,6 +25,134 @@
 
 /* -------------------------------- builder ------------------------------- */
 
+/* Returns the number of leading bytes in [s, s+n) that can be copied into a
+ * JSON string verbatim, i.e. until the first quote, backslash, or control
+ * byte (including NUL). Scans 16-byte chunks with SSE2/NEON when available so
+ * wide text cells bulk-copy instead of branching per byte.
+ */
+static size_t json_clean_run_len(const char *s, size_t n) {
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('\"');
+  const __m128i bslash = _mm_set1_epi8('\\');
+  const __m128i ctl_max = _mm_set1_epi8(0x1F);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+    // unsigned c <= 0x1F <=> saturating c - 0x1F == 0
+    __m128i is_ctl = _mm_cmpeq_epi8(_mm_subs_epu8(chunk, ctl_max), zero);
+    __m128i dirty = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                 _mm_or_si128(_mm_cmpeq_epi8(chunk, bslash),
+                                              is_ctl));
+    int mask = _mm_movemask_epi8(dirty);
+    if (mask != 0)
+      return i + (size_t)__builtin_ctz((unsigned)mask);
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t quote = vdupq_n_u8('\"');
+  const uint8x16_t bslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(0x20);
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t chunk = vld1q_u8((const uint8_t *)(s + i));
+    uint8x16_t dirty = vorrq_u8(vceqq_u8(chunk, quote),
+                                vorrq_u8(vceqq_u8(chunk, bslash),
+                                         vcltq_u8(chunk, space)));
+    if (vmaxvq_u8(dirty) != 0)
+      break; // locate the exact byte with the scalar tail below
+  }
+#endif
+
+  for (; i < n; i++) {
+    unsigned char c = (unsigned char)s[i];
+    if (c == '\"' || c == '\\' || c < 0x20)
+      break;
+  }
+  return i;
+}
+
+/* Returns the number of leading pure-ASCII bytes (< 0x80) in [s, s+n).
+ * Same 16-byte chunk discipline as json_clean_run_len; the sign-bit movemask
+ * classifies a whole chunk at once, so all-ASCII payloads validate with no
+ * per-byte branches.
+ */
+static size_t json_ascii_run_len(const char *s, size_t n) {
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(const void *)(s + i));
+    int mask = _mm_movemask_epi8(chunk);
+    if (mask != 0)
+      return i + (size_t)__builtin_ctz((unsigned)mask);
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t high = vdupq_n_u8(0x80);
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t chunk = vld1q_u8((const uint8_t *)(s + i));
+    if (vmaxvq_u8(vandq_u8(chunk, high)) != 0)
+      break; // locate the exact byte with the scalar tail below
+  }
+#endif
+
+  for (; i < n; i++) {
+    if ((unsigned char)s[i] >= 0x80)
+      break;
+  }
+  return i;
+}
+
+AdbxStatus json_utf8_validate(const char *s, size_t len) {
+  if (!s)
+    return (len == 0) ? OK : ERR;
+
+  size_t i = 0;
+  while (i < len) {
+    i += json_ascii_run_len(s + i, len - i);
+    if (i >= len)
+      break;
+
+    // Multibyte lead byte; check length, continuations, and the constrained
+    // second-byte ranges that exclude overlongs, surrogates, and > U+10FFFF.
+    unsigned char c0 = (unsigned char)s[i];
+    if (c0 < 0xC2) // stray continuation or overlong C0/C1 lead
+      return ERR;
+    if (c0 <= 0xDF) {
+      if (i + 2 > len || ((unsigned char)s[i + 1] & 0xC0) != 0x80)
+        return ERR;
+      i += 2;
+    } else if (c0 <= 0xEF) {
+      if (i + 3 > len)
+        return ERR;
+      unsigned char c1 = (unsigned char)s[i + 1];
+      unsigned char c2 = (unsigned char)s[i + 2];
+      if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80)
+        return ERR;
+      if (c0 == 0xE0 && c1 < 0xA0) // overlong
+        return ERR;
+      if (c0 == 0xED && c1 > 0x9F) // UTF-16 surrogate range
+        return ERR;
+      i += 3;
+    } else if (c0 <= 0xF4) {
+      if (i + 4 > len)
+        return ERR;
+      unsigned char c1 = (unsigned char)s[i + 1];
+      unsigned char c2 = (unsigned char)s[i + 2];
+      unsigned char c3 = (unsigned char)s[i + 3];
+      if ((c1 & 0xC0) != 0x80 || (c2 & 0xC0) != 0x80 || (c3 & 0xC0) != 0x80)
+        return ERR;
+      if (c0 == 0xF0 && c1 < 0x90) // overlong
+        return ERR;
+      if (c0 == 0xF4 && c1 > 0x8F) // past U+10FFFF
+        return ERR;
+      i += 4;
+    } else {
+      return ERR; // 0xF5..0xFF never appear in UTF-8
+    }
+  }
+  return OK;
+}
+
 /*
  * Escapes 's' into JSON string content (WITHOUT surrounding quotes) and
  * appends it to 'sb'. This function takes 'len' and it'll limit the bytes
@@ -31,8 +170,23 @@ static AdbxStatus sb_append_json_escaped(StrBuf *sb, const char *s,
   if (!sb || !s)
     return ERR;
 
+  // Bound 'len' to the real string length up front so the vectorized scan
+  // never loads bytes past a terminating NUL.
+  len = strnlen(s, len);
+
   // we loop until a '\0' is encountered or until we append 'len' bytes
   for (size_t i = 0; i < len && s[i]; i++) {
+    // bulk-copy the run of bytes that need no escaping (control bytes,
+    // including NUL, terminate the run)
+    size_t run = json_clean_run_len(s + i, len - i);
+    if (run > 0) {
+      if (sb_append_bytes(sb, s + i, run) != OK)
+        return ERR;
+      i += run;
+      if (i >= len)
+        break;
+    }
+
     unsigned char c = (unsigned char)s[i];
     // append a \ before the char
     switch (c) {
@@ -142,21 +296,17 @@ static AdbxStatus json_append(StrBuf *sb, const char *fmt, ...) {
     }
     case 'u': {
       uint32_t v = va_arg(ap, uint32_t);
-      char tmp[32];
-      int n = snprintf(tmp, sizeof(tmp), "%" PRIu32, v);
-      if (n < 0)
-        goto fail;
-      if (sb_append_bytes(sb, tmp, (size_t)n) != OK)
+      char tmp[STROP_DEC_MAX];
+      size_t n = strop_u64_to_dec(tmp, v);
+      if (sb_append_bytes(sb, tmp, n) != OK)
         goto fail;
       break;
     }
     case 'U': {
       uint64_t v = va_arg(ap, uint64_t);
-      char tmp[64];
-      int n = snprintf(tmp, sizeof(tmp), "%" PRIu64, v);
-      if (n < 0)
-        goto fail;
-      if (sb_append_bytes(sb, tmp, (size_t)n) != OK)
+      char tmp[STROP_DEC_MAX];
+      size_t n = strop_u64_to_dec(tmp, v);
+      if (sb_append_bytes(sb, tmp, n) != OK)
         goto fail;
       break;
     }
@@ -169,21 +319,17 @@ static AdbxStatus json_append(StrBuf *sb, const char *fmt, ...) {
     }
     case 'd': {
       int v = va_arg(ap, int);
-      char tmp[32];
-      int n = snprintf(tmp, sizeof(tmp), "%d", v);
-      if (n < 0)
-        goto fail;
-      if (sb_append_bytes(sb, tmp, (size_t)n) != OK)
+      char tmp[STROP_DEC_MAX];
+      size_t n = strop_i64_to_dec(tmp, v);
+      if (sb_append_bytes(sb, tmp, n) != OK)
         goto fail;
       break;
     }
     case 'l': {
       long v = va_arg(ap, long);
-      char tmp[32];
-      int n = snprintf(tmp, sizeof(tmp), "%ld", v);
-      if (n < 0)
-        goto fail;
-      if (sb_append_bytes(sb, tmp, (size_t)n) != OK)
+      char tmp[STROP_DEC_MAX];
+      size_t n = strop_i64_to_dec(tmp, v);
+      if (sb_append_bytes(sb, tmp, n) != OK)
         goto fail;
       break;
     }
@@ -360,13 +506,37 @@ AdbxStatus json_rpc_begin(StrBuf *sb) {
 
 /* --------------------------- encoding objects --------------------------- */
 
-/* Builds the structured payload for a successful run_sql_query tool result.
+/* Response framing that never varies between successful replies. Emitting it
+ * as precomputed byte runs keeps the comma state machine out of the fixed
+ * skeleton: each run already carries its separators, and the substitution
+ * slots (id, exec_ms, rowcount, ...) sit between runs. Only genuinely dynamic
+ * regions — column metadata, rows/data cells — still go through json_kv_*.
+ * The emitted bytes are identical to the json_kv_* sequence they replace. */
+static const char JSONT_ENVELOPE_OPEN[] = "{\"jsonrpc\":\"2.0\",\"id\":";
+static const char JSONT_OK_HEAD[] =
+    "{\"content\":[{\"type\":\"text\",\"text\":\"Query executed "
+    "successfully.\"}],\"structuredContent\":{\"exec_ms\":";
+static const char JSONT_COLUMNS_OPEN[] = ",\"columns\":[";
+static const char JSONT_ROWS_OPEN[] = "],\"rows\":[";
+static const char JSONT_DATA_OPEN[] = "],\"data\":{";
+static const char JSONT_TAIL_ROWMAJOR[] = "],\"rowcount\":";
+static const char JSONT_TAIL_COLUMNAR[] = "},\"rowcount\":";
+static const char JSONT_TAIL_TRUNCATED[] = ",\"resultTruncated\":";
+static const char JSONT_TAIL_SPILLED[] = ",\"spilledRows\":";
+static const char JSONT_OK_CLOSE[] = "}}"; // structuredContent + result
+
+/* Appends one template segment verbatim (a plain memcpy, no comma logic). */
+#define JSONT_PUT(sb, seg) sb_append_bytes((sb), (seg), sizeof(seg) - 1)
+
+/* Emits everything of a successful CallToolResult up to and including the
+ * opening '[' of structuredContent.rows: the content array, exec_ms, and the
+ * column metadata.
  * It borrows 'sb' and 'qr' and does not allocate externally-owned memory.
- * Side effects: appends a JSON object to 'sb'.
+ * Side effects: appends a JSON fragment to 'sb'.
  * Error semantics: returns OK on success, ERR on invalid input or append
  * failures.
  */
-static AdbxStatus json_qr_ok_structured(StrBuf *sb, const QueryResult *qr) {
+static AdbxStatus json_qr_ok_head(StrBuf *sb, const QueryResult *qr) {
   // nrows*ncols should fit in addressable range of cells
   uint64_t cell_count_u64 = 0;
   safe_mul_u32(qr->nrows, qr->ncols, &cell_count_u64);
@@ -379,17 +549,15 @@ static AdbxStatus json_qr_ok_structured(StrBuf *sb, const QueryResult *qr) {
   if (cell_count_u64 > 0 && !qr->cells)
     return ERR;
 
-  if (json_obj_begin(sb) != OK)
+  // MCP CallToolResult requires content[]; the whole skeleton up to the
+  // exec_ms value is invariant, so it goes out as one precomputed run.
+  if (JSONT_PUT(sb, JSONT_OK_HEAD) != OK)
     return ERR;
-  if (json_kv_u64(sb, "exec_ms", qr->exec_ms) != OK)
+  if (json_append(sb, "%U", qr->exec_ms) != OK)
     return ERR;
 
   // columns
-  if (json_maybe_comma(sb) != OK)
-    return ERR;
-  if (json_append(sb, "\"columns\":") != OK)
-    return ERR;
-  if (json_arr_begin(sb) != OK)
+  if (JSONT_PUT(sb, JSONT_COLUMNS_OPEN) != OK)
     return ERR;
   for (uint32_t c = 0; c < qr->ncols; ++c) {
     const QRColumn *col = qr_get_col((QueryResult *)qr, c);
@@ -410,50 +578,204 @@ static AdbxStatus json_qr_ok_structured(StrBuf *sb, const QueryResult *qr) {
     if (json_obj_end(sb) != OK)
       return ERR;
   }
-  if (json_arr_end(sb) != OK)
-    return ERR;
+  // rows (row-major default) or data (columnar opt-in); the segment closes
+  // the columns array itself.
+  if (qr->columnar)
+    return JSONT_PUT(sb, JSONT_DATA_OPEN);
+  return JSONT_PUT(sb, JSONT_ROWS_OPEN);
+}
 
-  // rows
-  if (json_maybe_comma(sb) != OK)
-    return ERR;
-  if (json_append(sb, "\"rows\":") != OK)
-    return ERR;
-  if (json_arr_begin(sb) != OK)
-    return ERR;
+/* Returns 1 when every cell of 'col' is guaranteed free of escapable bytes:
+ * numeric/bool types only ever hold digits, sign/exponent characters, 't'/'f'
+ * or NaN/Infinity in Postgres text format, and tokenized columns hold
+ * machine-generated "tok_*" identifiers. Such cells can be copied between
+ * quotes verbatim. Returns 0 for anything else (escape scan required).
+ */
+static int json_qr_col_is_raw_safe(const QRColumn *col) {
+  if (!col)
+    return 0;
+  if (col->value_type == QRCOL_V_TOKEN)
+    return 1;
+  if (!col->type)
+    return 0;
 
-  for (uint32_t r = 0; r < qr->nrows; ++r) {
-    if (json_arr_begin(sb) != OK)
-      return ERR;
+  static const char *const safe_types[] = {"bool",    "float4", "float8",
+                                           "int2",    "int4",   "int8",
+                                           "numeric", "oid"};
+  for (size_t i = 0; i < ARRLEN(safe_types); i++) {
+    if (strcmp(col->type, safe_types[i]) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+/* Expands the QR_OK row loop once per cell policy. RAW_EXPR is the routing
+ * decision for column c; the uniform variants pass a constant, so the
+ * compiler drops the untaken arm and the inner loop carries only the
+ * unavoidable NULL check — the raw-vs-escape selection runs once per result
+ * instead of once per cell. 'col_plan' stays in the signature so every
+ * variant shares one function-pointer type.
+ * Each variant borrows 'sb', 'qr', and 'col_plan'. When 'leading_comma' is
+ * non-zero a ',' separator is written first; the streaming serializer needs
+ * this because its per-row scratch buffer carries no preceding context for
+ * the comma tracker.
+ * Error semantics: returns OK on success, ERR on append failures.
+ */
+#define JSON_QR_DEFINE_ROW_EMITTER(fn_name, RAW_EXPR)                          \
+  static AdbxStatus fn_name(StrBuf *sb, const QueryResult *qr, uint32_t r,     \
+                            int leading_comma, const uint8_t *col_plan) {      \
+    (void)col_plan;                                                            \
+    if (leading_comma && sb_append_bytes(sb, ",", 1) != OK)                    \
+      return ERR;                                                              \
+    if (sb_append_bytes(sb, "[", 1) != OK)                                     \
+      return ERR;                                                              \
+                                                                               \
+    for (uint32_t c = 0; c < qr->ncols; ++c) {                                 \
+      const char *cell = qr_get_cell(qr, r, c);                                \
+      if (!cell) {                                                             \
+        if (json_maybe_comma(sb) != OK)                                        \
+          return ERR;                                                          \
+        if (json_append(sb, "null") != OK)                                     \
+          return ERR;                                                          \
+      } else if (RAW_EXPR) {                                                   \
+        /* Cell bytes cannot need escaping; copy them quoted verbatim. */      \
+        if (json_maybe_comma(sb) != OK)                                        \
+          return ERR;                                                          \
+        if (sb_append_bytes(sb, "\"", 1) != OK)                                \
+          return ERR;                                                          \
+        if (sb_append_bytes(sb, cell, strlen(cell)) != OK)                     \
+          return ERR;                                                          \
+        if (sb_append_bytes(sb, "\"", 1) != OK)                                \
+          return ERR;                                                          \
+      } else {                                                                 \
+        /* quote + escaped string content + quote */                           \
+        if (json_arr_elem_str(sb, cell) != OK)                                 \
+          return ERR;                                                          \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    return json_arr_end(sb);                                                   \
+  }
+
+/* Same expansion for one '"name":[cells...]' member of the columnar "data"
+ * object; the policy folds into the per-column 'raw' flag the loop reads. */
+#define JSON_QR_DEFINE_COL_EMITTER(fn_name, RAW_EXPR)                          \
+  static AdbxStatus fn_name(StrBuf *sb, const QueryResult *qr, uint32_t c,     \
+                            int leading_comma, const uint8_t *col_plan) {      \
+    (void)col_plan;                                                            \
+    if (leading_comma && sb_append_bytes(sb, ",", 1) != OK)                    \
+      return ERR;                                                              \
+                                                                               \
+    const QRColumn *col = qr_get_col(qr, c);                                   \
+    const char *name = (col && col->name) ? col->name : "";                    \
+    if (json_append(sb, "\"%s\":[", name) != OK)                               \
+      return ERR;                                                              \
+                                                                               \
+    int raw = RAW_EXPR;                                                        \
+    for (uint32_t r = 0; r < qr->nrows; ++r) {                                 \
+      if (r > 0 && sb_append_bytes(sb, ",", 1) != OK)                          \
+        return ERR;                                                            \
+      const char *cell = qr_get_cell(qr, r, c);                                \
+      if (!cell) {                                                             \
+        if (sb_append_bytes(sb, "null", 4) != OK)                              \
+          return ERR;                                                          \
+      } else if (raw) {                                                        \
+        if (sb_append_bytes(sb, "\"", 1) != OK)                                \
+          return ERR;                                                          \
+        if (sb_append_bytes(sb, cell, strlen(cell)) != OK)                     \
+          return ERR;                                                          \
+        if (sb_append_bytes(sb, "\"", 1) != OK)                                \
+          return ERR;                                                          \
+      } else {                                                                 \
+        if (json_append(sb, "\"%s\"", cell) != OK)                             \
+          return ERR;                                                          \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    return sb_append_bytes(sb, "]", 1);                                        \
+  }
 
+// Raw: every column is escape-free (numeric/bool/tokenized results).
+JSON_QR_DEFINE_ROW_EMITTER(json_qr_row_raw, 1)
+JSON_QR_DEFINE_COL_EMITTER(json_qr_col_raw, 1)
+// Esc: no column is; every cell takes the escape scan.
+JSON_QR_DEFINE_ROW_EMITTER(json_qr_row_esc, 0)
+JSON_QR_DEFINE_COL_EMITTER(json_qr_col_esc, 0)
+// Mixed: consult the per-column plan cell by cell (the old behavior).
+JSON_QR_DEFINE_ROW_EMITTER(json_qr_row_mixed, col_plan && col_plan[c])
+JSON_QR_DEFINE_COL_EMITTER(json_qr_col_mixed, col_plan && col_plan[c])
+
+#undef JSON_QR_DEFINE_ROW_EMITTER
+#undef JSON_QR_DEFINE_COL_EMITTER
+
+/* Serialization plan for one QR_OK result: the per-column raw routing plus
+ * the emitter variant matching the result's column-type profile, selected
+ * once up front so uniform results never branch per cell.
+ * Ownership: 'cols' is owned; release with json_qr_plan_clean(). */
+typedef struct JsonQrSerPlan {
+  uint8_t *cols; // raw routing per column; NULL when the result has none
+  AdbxStatus (*row_fn)(StrBuf *, const QueryResult *, uint32_t, int,
+                       const uint8_t *);
+  AdbxStatus (*col_fn)(StrBuf *, const QueryResult *, uint32_t, int,
+                       const uint8_t *);
+} JsonQrSerPlan;
+
+/* Classifies 'qr' and fills 'plan' with the matching emitter pair.
+ * It borrows 'qr'; column storage is owned by the plan. */
+static void json_qr_plan_init(JsonQrSerPlan *plan, const QueryResult *qr) {
+  plan->cols = NULL;
+  uint32_t n_raw = 0;
+  if (qr->ncols > 0) {
+    plan->cols = (uint8_t *)xcalloc(qr->ncols, 1);
     for (uint32_t c = 0; c < qr->ncols; ++c) {
-      const char *cell = qr_get_cell(qr, r, c);
-      if (!cell) {
-        if (json_maybe_comma(sb) != OK)
-          return ERR;
-        if (json_append(sb, "null") != OK)
-          return ERR;
-      } else {
-        /* quote + escaped string content + quote */
-        if (json_arr_elem_str(sb, cell) != OK)
-          return ERR;
-      }
+      plan->cols[c] = (uint8_t)json_qr_col_is_raw_safe(qr_get_col(qr, c));
+      n_raw += plan->cols[c];
     }
+  }
 
-    if (json_arr_end(sb) != OK)
-      return ERR;
+  if (qr->ncols > 0 && n_raw == qr->ncols) {
+    plan->row_fn = json_qr_row_raw;
+    plan->col_fn = json_qr_col_raw;
+  } else if (n_raw == 0) {
+    plan->row_fn = json_qr_row_esc;
+    plan->col_fn = json_qr_col_esc;
+  } else {
+    plan->row_fn = json_qr_row_mixed;
+    plan->col_fn = json_qr_col_mixed;
   }
-  if (json_arr_end(sb) != OK)
-    return ERR;
+}
+
+static void json_qr_plan_clean(JsonQrSerPlan *plan) {
+  free(plan->cols);
+  plan->cols = NULL;
+}
 
-  // rowcount + resultTruncated
-  if (json_kv_u64(sb, "rowcount", qr->nrows) != OK)
+/* Emits everything of a successful CallToolResult after the last row: the
+ * closing ']' of rows (or '}' of columnar data), rowcount, resultTruncated,
+ * and the closing braces of structuredContent and the result object.
+ * It borrows 'sb' and 'qr'.
+ * Error semantics: returns OK on success, ERR on append failures.
+ */
+static AdbxStatus json_qr_ok_tail(StrBuf *sb, const QueryResult *qr) {
+  // The segment closes rows/data and opens the rowcount slot in one run.
+  if ((qr->columnar ? JSONT_PUT(sb, JSONT_TAIL_COLUMNAR)
+                    : JSONT_PUT(sb, JSONT_TAIL_ROWMAJOR)) != OK)
     return ERR;
-  if (json_kv_bool(sb, "resultTruncated", qr->result_truncated ? 1 : 0) != OK)
+  if (json_append(sb, "%U", (uint64_t)qr->nrows) != OK)
     return ERR;
-  if (json_obj_end(sb) != OK)
+  if (JSONT_PUT(sb, JSONT_TAIL_TRUNCATED) != OK)
     return ERR;
+  if (json_append(sb, "%b", qr->result_truncated ? 1 : 0) != OK)
+    return ERR;
+  // Overflow rows held server-side; clients page them with fetch_result_page.
+  if (qr->spilled_rows > 0) {
+    if (JSONT_PUT(sb, JSONT_TAIL_SPILLED) != OK)
+      return ERR;
+    if (json_append(sb, "%U", qr->spilled_rows) != OK)
+      return ERR;
+  }
 
-  return OK;
+  return JSONT_PUT(sb, JSONT_OK_CLOSE);
 }
 
 /* Tool success: emits a CallToolResult object with both content and
@@ -467,32 +789,27 @@ static AdbxStatus json_qr_ok(StrBuf *sb, const QueryResult *qr) {
   if (!sb || !qr)
     return ERR;
 
-  if (json_obj_begin(sb) != OK)
-    return ERR;
-  if (json_kv_arr_begin(sb, "content") != OK)
-    return ERR;
-  if (json_obj_begin(sb) != OK)
-    return ERR;
-  if (json_kv_str(sb, "type", "text") != OK)
-    return ERR;
-  // MCP CallToolResult requires content[]; keep it compact and stable.
-  if (json_kv_str(sb, "text", "Query executed successfully.") != OK)
-    return ERR;
-  if (json_obj_end(sb) != OK)
-    return ERR;
-  if (json_arr_end(sb) != OK)
-    return ERR;
-
-  if (json_maybe_comma(sb) != OK)
-    return ERR;
-  if (json_append(sb, "\"structuredContent\":") != OK)
+  if (json_qr_ok_head(sb, qr) != OK)
     return ERR;
-  if (json_qr_ok_structured(sb, qr) != OK)
-    return ERR;
-
-  if (json_obj_end(sb) != OK)
-    return ERR;
-  return OK;
+  JsonQrSerPlan plan;
+  json_qr_plan_init(&plan, qr);
+  if (qr->columnar) {
+    for (uint32_t c = 0; c < qr->ncols; ++c) {
+      if (plan.col_fn(sb, qr, c, c > 0, plan.cols) != OK) {
+        json_qr_plan_clean(&plan);
+        return ERR;
+      }
+    }
+  } else {
+    for (uint32_t r = 0; r < qr->nrows; ++r) {
+      if (plan.row_fn(sb, qr, r, r > 0, plan.cols) != OK) {
+        json_qr_plan_clean(&plan);
+        return ERR;
+      }
+    }
+  }
+  json_qr_plan_clean(&plan);
+  return json_qr_ok_tail(sb, qr);
 }
 
 /* Protocol error: {"code":<int>,"message":"..."} */
@@ -533,6 +850,18 @@ static AdbxStatus json_qr_tool_err(StrBuf *sb, const QueryResult *qr) {
   return OK;
 }
 
+/* Emits the JSON-RPC envelope opening: '{' plus the jsonrpc and id members.
+ * It borrows 'sb' and 'id'.
+ * Error semantics: returns OK on success, ERR on append failures.
+ */
+static AdbxStatus json_rpc_envelope_begin(StrBuf *sb, const McpId *id) {
+  if (JSONT_PUT(sb, JSONT_ENVELOPE_OPEN) != OK)
+    return ERR;
+  if (id->kind == MCP_ID_STR)
+    return json_append(sb, "\"%s\"", id->str ? id->str : "");
+  return json_append(sb, "%U", (uint64_t)id->u32);
+}
+
 AdbxStatus qr_to_jsonrpc(const QueryResult *qr, char **out_json,
                          size_t *out_len) {
   if (!out_json || !out_len)
@@ -546,17 +875,8 @@ AdbxStatus qr_to_jsonrpc(const QueryResult *qr, char **out_json,
   StrBuf sb;
   sb_init(&sb);
   // begin JSON-RPC envelope
-  if (json_obj_begin(&sb) != OK)
-    goto err;
-  if (json_kv_str(&sb, "jsonrpc", "2.0") != OK)
+  if (json_rpc_envelope_begin(&sb, &qr->id) != OK)
     goto err;
-  if (qr->id.kind == MCP_ID_STR) {
-    if (json_kv_str(&sb, "id", qr->id.str ? qr->id.str : "") != OK)
-      goto err;
-  } else {
-    if (json_kv_u64(&sb, "id", qr->id.u32) != OK)
-      goto err;
-  }
 
   if (qr->status == QR_ERROR) {
     if (json_maybe_comma(&sb) != OK)
@@ -584,6 +904,7 @@ AdbxStatus qr_to_jsonrpc(const QueryResult *qr, char **out_json,
     goto err;
 
   // materialize output (exact size; not NUL-terminated)
+  PERF_COUNT_N(PERF_JSON_ALLOC_BYTES, sb.len);
   char *out = xmalloc(sb.len);
   memcpy(out, sb.data, sb.len);
   *out_json = out;
@@ -599,6 +920,218 @@ err:
   return ERR;
 }
 
+AdbxStatus qr_to_jsonrpc_frame(const QueryResult *qr, BufChannel *bc) {
+  if (!qr || !bc)
+    return ERR;
+
+  // Error payloads are tiny; the one-shot serializer is fine for them.
+  if (qr->status != QR_OK) {
+    char *json = NULL;
+    size_t json_len = 0;
+    if (qr_to_jsonrpc(qr, &json, &json_len) != OK)
+      return ERR;
+    AdbxStatus wrc = json_len <= UINT32_MAX
+                         ? frame_write_len(bc, json, (uint32_t)json_len)
+                         : ERR;
+    free(json);
+    return wrc;
+  }
+
+  StrBuf head, tail, row;
+  sb_init(&head);
+  sb_init(&tail);
+  sb_init(&row);
+  AdbxStatus rc = ERR;
+  JsonQrSerPlan plan = {0};
+
+  if (json_rpc_envelope_begin(&head, &qr->id) != OK)
+    goto clean;
+  if (json_maybe_comma(&head) != OK)
+    goto clean;
+  if (json_append(&head, "\"result\":") != OK)
+    goto clean;
+  if (json_qr_ok_head(&head, qr) != OK)
+    goto clean;
+
+  if (json_qr_ok_tail(&tail, qr) != OK)
+    goto clean;
+  // close JSON-RPC envelope
+  if (json_obj_end(&tail) != OK)
+    goto clean;
+
+  // Sizing pass: row serialization is deterministic, so encoding each row
+  // once for byte counting and once for writing yields identical lengths
+  // while keeping at most one row buffered at a time.
+  // Columnar responses stream one column per chunk, row-major ones one row.
+  json_qr_plan_init(&plan, qr);
+  uint32_t nchunks = qr->columnar ? qr->ncols : qr->nrows;
+  uint64_t total = (uint64_t)head.len + (uint64_t)tail.len;
+  for (uint32_t i = 0; i < nchunks; ++i) {
+    sb_reset(&row);
+    if ((qr->columnar ? plan.col_fn(&row, qr, i, i > 0, plan.cols)
+                      : plan.row_fn(&row, qr, i, i > 0, plan.cols)) != OK)
+      goto clean;
+    total += row.len;
+  }
+  if (total > UINT32_MAX)
+    goto clean;
+
+  // Large payloads go out chunked (begin/chunks/end) so the peer can start
+  // relaying them while the tail is still being serialized.
+  if (total > FRAME_CHUNK_THRESHOLD_BYTES) {
+    if (frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_BEGIN, (uint32_t)total) !=
+        OK)
+      goto clean;
+
+    // 'row' doubles as the chunk accumulator; rows append to it until one
+    // chunk frame's worth of payload is ready.
+    uint64_t sent = 0;
+    sb_reset(&row);
+    if (sb_append_bytes(&row, head.data, head.len) != OK)
+      goto clean;
+    for (uint32_t i = 0; i < nchunks; ++i) {
+      if ((qr->columnar ? plan.col_fn(&row, qr, i, i > 0, plan.cols)
+                        : plan.row_fn(&row, qr, i, i > 0, plan.cols)) != OK)
+        goto clean;
+      if (row.len >= FRAME_CHUNK_BYTES) {
+        if (frame_write_len(bc, row.data, (uint32_t)row.len) != OK)
+          goto clean;
+        sent += row.len;
+        sb_reset(&row);
+      }
+    }
+    if (sb_append_bytes(&row, tail.data, tail.len) != OK)
+      goto clean;
+    if (row.len > 0) {
+      if (frame_write_len(bc, row.data, (uint32_t)row.len) != OK)
+        goto clean;
+      sent += row.len;
+    }
+
+    // The declared total is already on the wire; a mismatch would desync the
+    // receiver, so fail loudly instead of trusting the chunks.
+    if (sent != total)
+      goto clean;
+    if (frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_END, (uint32_t)total) !=
+        OK)
+      goto clean;
+    rc = OK;
+    goto clean;
+  }
+
+  uint32_t hdr = htonl((uint32_t)total);
+  if (bufch_write2v(bc, &hdr, sizeof(hdr), head.data, head.len) != OK)
+    goto clean;
+
+  uint64_t written = (uint64_t)head.len;
+  for (uint32_t i = 0; i < nchunks; ++i) {
+    sb_reset(&row);
+    if ((qr->columnar ? plan.col_fn(&row, qr, i, i > 0, plan.cols)
+                      : plan.row_fn(&row, qr, i, i > 0, plan.cols)) != OK)
+      goto clean;
+    if (bufch_write_all(bc, row.data, row.len) != OK)
+      goto clean;
+    written += row.len;
+  }
+  if (bufch_write_all(bc, tail.data, tail.len) != OK)
+    goto clean;
+  written += tail.len;
+
+  // The declared length is already on the wire; a mismatch would desync the
+  // channel, so fail loudly instead of trusting the frame.
+  if (written == total)
+    rc = OK;
+
+clean:
+  json_qr_plan_clean(&plan);
+  sb_clean(&head);
+  sb_clean(&tail);
+  sb_clean(&row);
+  return rc;
+}
+
+AdbxStatus qr_to_jsonrpc_result(const QueryResult *qr, char **out_json,
+                                size_t *out_len) {
+  if (!out_json || !out_len)
+    return ERR;
+  *out_json = NULL;
+  *out_len = 0;
+
+  if (!qr || qr->status != QR_OK)
+    return ERR;
+
+  StrBuf sb;
+  sb_init(&sb);
+  if (json_append(&sb, "\"result\":") != OK)
+    goto err;
+  if (json_qr_ok(&sb, qr) != OK)
+    goto err;
+  // close JSON-RPC envelope
+  if (json_obj_end(&sb) != OK)
+    goto err;
+
+  // materialize output (exact size; not NUL-terminated)
+  PERF_COUNT_N(PERF_JSON_ALLOC_BYTES, sb.len);
+  char *out = xmalloc(sb.len);
+  memcpy(out, sb.data, sb.len);
+  *out_json = out;
+  *out_len = sb.len;
+
+  sb_clean(&sb);
+  return OK;
+
+err:
+  sb_clean(&sb);
+  return ERR;
+}
+
+AdbxStatus jsonrpc_result_frame(BufChannel *bc, const McpId *id,
+                                const char *result_json, size_t result_len) {
+  if (!bc || !id || !result_json || result_len == 0)
+    return ERR;
+
+  StrBuf head;
+  sb_init(&head);
+  AdbxStatus rc = ERR;
+
+  if (json_rpc_envelope_begin(&head, id) != OK)
+    goto clean;
+  if (json_maybe_comma(&head) != OK)
+    goto clean;
+
+  uint64_t total = (uint64_t)head.len + (uint64_t)result_len;
+  if (total > UINT32_MAX)
+    goto clean;
+
+  if (total <= FRAME_CHUNK_THRESHOLD_BYTES) {
+    if (sb_append_bytes(&head, result_json, result_len) != OK)
+      goto clean;
+    rc = frame_write_len(bc, head.data, (uint32_t)head.len);
+    goto clean;
+  }
+
+  // Oversized replays use the same chunked framing as live serialization.
+  if (frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_BEGIN, (uint32_t)total) !=
+      OK)
+    goto clean;
+  if (frame_write_len(bc, head.data, (uint32_t)head.len) != OK)
+    goto clean;
+  size_t off = 0;
+  while (off < result_len) {
+    size_t n = result_len - off;
+    if (n > FRAME_CHUNK_BYTES)
+      n = FRAME_CHUNK_BYTES;
+    if (frame_write_len(bc, result_json + off, (uint32_t)n) != OK)
+      goto clean;
+    off += n;
+  }
+  rc = frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_END, (uint32_t)total);
+
+clean:
+  sb_clean(&head);
+  return rc;
+}
+
 /* --------------------------------- decode new -------------------------------
  */
 // JsonArrIter and JsonGetter are defined in json_codec.h.
@@ -843,39 +1376,173 @@ static int skip_token(const jsmntok_t *toks, int ntok, int i) {
   if (!toks || ntok <= 0 || i < 0 || i >= ntok)
     return -1;
 
-  int j = i + 1;
-  const jsmntok_t *t = &toks[i];
+  if (toks[i].type == JSMN_PRIMITIVE || toks[i].type == JSMN_STRING)
+    return i + 1;
+
+  // Tokens are stored in document order with increasing 'start', so the
+  // subtree rooted at 'i' is exactly the run of tokens starting before
+  // toks[i].end. Binary-search the first token at or past that offset
+  // instead of recursing through every descendant.
+  int end = toks[i].end;
+  int lo = i + 1;
+  int hi = ntok;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (toks[mid].start < end)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/* ------------------------------- key index ------------------------------- */
+
+// Consecutive lookups on one object before its keys are worth hashing.
+#define JSKIDX_HOT_LOOKUPS 3
+// Objects with fewer pairs than this stay on the linear scan.
+#define JSKIDX_MIN_PAIRS 4
+
+/* One hashed key: the (object token, key bytes) pair identifying an object
+ * member, or the per-object "fully indexed" marker when is_obj_marker is set.
+ * Refs are stored in per-object arrays so the table can borrow them. */
+typedef struct JsonKeyRef {
+  int obj_idx;           // token index of the owning object
+  uint8_t is_obj_marker; // 1 for the sentinel proving obj_idx is indexed
+  const char *ptr;       // key bytes inside the JSON buffer (no quotes)
+  size_t len;
+} JsonKeyRef;
+
+/* Lazily built key index for one tokenized document.
+ * Objects that keep getting queried (deep AST nodes probed for many possible
+ * keys) are hashed once — JsonKeyRef -> value-token index + 1 — so further
+ * lookups skip the O(fields) child walk. Token indexes identify objects, so
+ * one table serves every view over the document.
+ */
+struct JsonKeyIdx {
+  HashTable *ht;     // NULL until the first object gets indexed
+  PtrVec key_allocs; // owned JsonKeyRef arrays, one per indexed object
+  int hot_obj;       // object token of the current lookup streak
+  int hot_count;     // consecutive lookups on hot_obj
+};
+
+static uint64_t jskidx_hash(const void *key, void *ctx) {
+  (void)ctx;
+  const JsonKeyRef *r = (const JsonKeyRef *)key;
+  uint64_t seed =
+      ((uint64_t)(uint32_t)r->obj_idx + 1u) | ((uint64_t)r->is_obj_marker << 33);
+  return ht_hash_bytes_withSeed(r->ptr, r->len, seed);
+}
+
+static AdbxTriStatus jskidx_eq(const void *a, const void *b, void *ctx) {
+  (void)ctx;
+  const JsonKeyRef *ra = (const JsonKeyRef *)a;
+  const JsonKeyRef *rb = (const JsonKeyRef *)b;
+  if (!ra || !rb)
+    return NO;
+  if (ra->obj_idx != rb->obj_idx || ra->is_obj_marker != rb->is_obj_marker ||
+      ra->len != rb->len)
+    return NO;
+  if (ra->len > 0 && memcmp(ra->ptr, rb->ptr, ra->len) != 0)
+    return NO;
+  return YES;
+}
+
+static struct JsonKeyIdx *jskidx_create(void) {
+  struct JsonKeyIdx *kx =
+      (struct JsonKeyIdx *)xcalloc(1, sizeof(struct JsonKeyIdx));
+  kx->hot_obj = -1;
+  return kx;
+}
+
+/* Drops every indexed object so the index can serve a new parse. The struct
+ * stays reusable; only the table and the borrowed-key storage are released. */
+static void jskidx_reset(struct JsonKeyIdx *kx) {
+  if (!kx)
+    return;
+  for (uint32_t i = 0; i < kx->key_allocs.len; i++)
+    free(kx->key_allocs.items[i]);
+  ptrvec_clean(&kx->key_allocs);
+  ht_destroy(kx->ht);
+  kx->ht = NULL;
+  kx->hot_obj = -1;
+  kx->hot_count = 0;
+}
+
+static void jskidx_destroy(struct JsonKeyIdx *kx) {
+  if (!kx)
+    return;
+  jskidx_reset(kx);
+  free(kx);
+}
+
+/* Looks up one key of an already-indexed object.
+ * Returns the value token index, or -1 when the object has no such key. */
+static int jskidx_get(const struct JsonKeyIdx *kx, int obj_idx,
+                      const char *key, size_t key_len) {
+  JsonKeyRef probe = {obj_idx, 0, key, key_len};
+  const void *v = ht_get_custom(kx->ht, &probe);
+  if (!v)
+    return -1;
+  return (int)((uintptr_t)v - 1u);
+}
+
+static AdbxTriStatus jskidx_obj_is_indexed(const struct JsonKeyIdx *kx,
+                                           int obj_idx) {
+  if (!kx->ht)
+    return NO;
+  JsonKeyRef probe = {obj_idx, 1, NULL, 0};
+  return ht_get_custom(kx->ht, &probe) ? YES : NO;
+}
 
-  if (t->type == JSMN_PRIMITIVE || t->type == JSMN_STRING) {
-    return j;
+/* Hashes every key of the object at obj_idx, then plants the sentinel so
+ * future lookups trust the table for hits and misses alike.
+ * A failed build leaves partial entries behind the missing sentinel; lookups
+ * simply keep linear-scanning that object.
+ * Returns OK when the object is fully indexed, ERR otherwise. */
+static AdbxStatus jskidx_build(struct JsonKeyIdx *kx, const JsonGetter *jg,
+                               int obj_idx) {
+  if (!kx->ht) {
+    kx->ht = ht_create_custom(jskidx_hash, jskidx_eq, NULL);
+    if (!kx->ht)
+      return ERR;
   }
 
-  if (t->type == JSMN_ARRAY) {
-    // For arrays, size is number of elements
-    for (int k = 0; k < t->size; k++) {
-      j = skip_token(toks, ntok, j);
-      if (j < 0)
-        return -1;
-    }
-    return j;
+  int pairs = jg->toks[obj_idx].size;
+  JsonKeyRef *refs =
+      (JsonKeyRef *)xmalloc(((size_t)pairs + 1) * sizeof(JsonKeyRef));
+  if (ptrvec_push(&kx->key_allocs, refs) != OK) {
+    free(refs);
+    return ERR;
   }
 
-  if (t->type == JSMN_OBJECT) {
-    // For objects, size is number of key/value pairs
-    for (int k = 0; k < t->size; k++) {
-      // key
-      j = skip_token(toks, ntok, j);
-      if (j < 0)
-        return -1;
-      // value
-      j = skip_token(toks, ntok, j);
-      if (j < 0)
-        return -1;
+  int i = obj_idx + 1;
+  int n = 0;
+  for (int pair = 0; pair < pairs; pair++) {
+    if (i < 0 || i >= jg->ntok)
+      return ERR;
+    const jsmntok_t *tkey = &jg->toks[i];
+    int val_i = i + 1;
+    if (tkey->type != JSMN_STRING || val_i >= jg->ntok)
+      return ERR;
+
+    refs[n] = (JsonKeyRef){obj_idx, 0, jg->json + tkey->start,
+                           (size_t)(tkey->end - tkey->start)};
+    // First key wins on duplicates, matching the linear scan.
+    if (!ht_get_custom(kx->ht, &refs[n])) {
+      if (ht_put_custom(kx->ht, &refs[n], (void *)(uintptr_t)(val_i + 1)) !=
+          OK)
+        return ERR;
     }
-    return j;
+    n++;
+
+    i = skip_token(jg->toks, jg->ntok, val_i);
+    if (i < 0)
+      return ERR;
   }
 
-  return -1;
+  refs[n] = (JsonKeyRef){obj_idx, 1, NULL, 0};
+  return ht_put_custom(kx->ht, &refs[n], (void *)(uintptr_t)1u);
 }
 
 /*
@@ -904,6 +1571,25 @@ static int find_object_value_tok(const JsonGetter *jg, int obj_idx,
   if (jg->toks[obj_idx].type != JSMN_OBJECT)
     return -2;
 
+  struct JsonKeyIdx *kx = jg->kidx;
+  if (kx) {
+    if (jskidx_obj_is_indexed(kx, obj_idx) == YES)
+      return jskidx_get(kx, obj_idx, key, key_len);
+
+    // Track the lookup streak and hash the object once it proves hot.
+    if (obj_idx == kx->hot_obj) {
+      kx->hot_count++;
+      if (kx->hot_count >= JSKIDX_HOT_LOOKUPS &&
+          jg->toks[obj_idx].size >= JSKIDX_MIN_PAIRS &&
+          jskidx_build(kx, jg, obj_idx) == OK) {
+        return jskidx_get(kx, obj_idx, key, key_len);
+      }
+    } else {
+      kx->hot_obj = obj_idx;
+      kx->hot_count = 1;
+    }
+  }
+
   int i = obj_idx + 1;
   for (int pair = 0; pair < jg->toks[obj_idx].size; pair++) {
     if (i < 0 || i >= jg->ntok)
@@ -1041,27 +1727,9 @@ static AdbxStatus tok_parse_double(const char *json, const jsmntok_t *t,
 
   const char *p = json + t->start;
   size_t n = (size_t)(t->end - t->start);
-  if (n == 0)
-    return ERR;
-
-  // Copy into a NUL-terminated buffer for strtod.
-  char *tmp = (char *)xmalloc(n + 1);
-  if (!tmp)
-    return ERR;
-  memcpy(tmp, p, n);
-  tmp[n] = '\0';
 
-  errno = 0;
-  char *endp = NULL;
-  double v = strtod(tmp, &endp);
-  if (errno != 0 || endp != tmp + n) {
-    free(tmp);
-    return ERR;
-  }
-
-  *out_double = v;
-  free(tmp);
-  return OK;
+  // Span parser: no NUL-terminated copy, no locale, no errno round-trip.
+  return str_span_to_f64(p, n, out_double);
 }
 
 /*
@@ -1077,27 +1745,8 @@ static AdbxStatus tok_parse_long(const char *json, const jsmntok_t *t,
 
   const char *p = json + t->start;
   size_t n = (size_t)(t->end - t->start);
-  if (n == 0)
-    return ERR;
 
-  // Copy into a NUL-terminated buffer for strtoll.
-  char *tmp = (char *)xmalloc(n + 1);
-  if (!tmp)
-    return ERR;
-  memcpy(tmp, p, n);
-  tmp[n] = '\0';
-
-  errno = 0;
-  char *endp = NULL;
-  long long v = strtoll(tmp, &endp, 10);
-  if (errno != 0 || endp != tmp + n) {
-    free(tmp);
-    return ERR;
-  }
-
-  *out_long = (int64_t)v;
-  free(tmp);
-  return OK;
+  return str_span_to_i64(p, n, out_long);
 }
 
 /* Parses one JSON document into the provided 'tokens' buffer and initializes
@@ -1143,35 +1792,120 @@ AdbxStatus jsget_init(JsonGetter *jg, const char *json, size_t json_len,
                                  (uint32_t)ARRLEN(tok_buf->toks));
 }
 
-AdbxStatus jsget_create(JsonGetter *jg, const char *json, size_t json_len) {
-  if (!jg || !json || json_len == 0)
+AdbxStatus jsget_init_ws(JsonGetter *jg, const char *json, size_t json_len,
+                         JsonTokWs *ws) {
+  if (!jg || !json || json_len == 0 || !ws)
     return ERR;
 
   memset(jg, 0, sizeof(*jg));
   jg->json = json;
   jg->json_len = json_len;
+  jg->owned_toks = NULL; // the workspace owns the tokens, not the view
 
+  if (!ws->toks) {
+    ws->cap = JSON_GETTER_MAX_TOKENS;
+    ws->toks = (jsmntok_t *)xmalloc((size_t)ws->cap * sizeof(jsmntok_t));
+  }
+  if (!ws->kidx)
+    ws->kidx = jskidx_create();
+  // Token indexes and key spans from the previous parse are meaningless now.
+  jskidx_reset(ws->kidx);
+  jg->kidx = ws->kidx;
+
+  // Grow-once: resume the parse after JSMN_ERROR_NOMEM instead of starting
+  // over, and keep the enlarged buffer for the next request.
   jsmn_parser p;
   jsmn_init(&p);
 
-  // First pass: count required tokens without storing them.
-  int needed = jsmn_parse(&p, json, json_len, NULL, 0);
-  if (needed <= 0)
+  int ntok;
+  for (;;) {
+    ntok = jsmn_parse(&p, json, json_len, ws->toks, ws->cap);
+    if (ntok != JSMN_ERROR_NOMEM)
+      break;
+    if (ws->cap >= JSON_GETTER_MAX_ALLOC_TOKENS)
+      return ERR;
+    uint32_t new_cap = ws->cap * 2;
+    if (new_cap > JSON_GETTER_MAX_ALLOC_TOKENS)
+      new_cap = JSON_GETTER_MAX_ALLOC_TOKENS;
+    ws->toks =
+        (jsmntok_t *)xrealloc(ws->toks, (size_t)new_cap * sizeof(jsmntok_t));
+    ws->cap = new_cap;
+  }
+
+  // Root must be an object for all current JsonGetter callers.
+  if (ntok <= 0 || ws->toks[0].type != JSMN_OBJECT)
     return ERR;
-  if ((uint32_t)needed > JSON_GETTER_MAX_ALLOC_TOKENS)
+
+  jg->toks = ws->toks;
+  jg->ntok = ntok;
+  jg->root = 0;
+  return OK;
+}
+
+void jstokws_clean(JsonTokWs *ws) {
+  if (!ws)
+    return;
+  free(ws->toks);
+  ws->toks = NULL;
+  ws->cap = 0;
+  jskidx_destroy(ws->kidx);
+  ws->kidx = NULL;
+}
+
+AdbxStatus jsget_create(JsonGetter *jg, const char *json, size_t json_len) {
+  if (!jg || !json || json_len == 0)
     return ERR;
 
-  jg->owned_toks = (jsmntok_t *)xmalloc((size_t)needed * sizeof(jsmntok_t));
-  if (jsget_parse_into_tokens(jg, jg->owned_toks, (uint32_t)needed) != OK) {
+  memset(jg, 0, sizeof(*jg));
+  jg->json = json;
+  jg->json_len = json_len;
+
+  // Single pass: jsmn parses are resumable after JSMN_ERROR_NOMEM, so grow
+  // the token buffer geometrically and continue instead of paying a separate
+  // token-counting pass over the whole document.
+  jsmn_parser p;
+  jsmn_init(&p);
+
+  uint32_t cap = 256;
+  jg->owned_toks = (jsmntok_t *)xmalloc((size_t)cap * sizeof(jsmntok_t));
+
+  int ntok;
+  for (;;) {
+    ntok = jsmn_parse(&p, json, json_len, jg->owned_toks, cap);
+    if (ntok != JSMN_ERROR_NOMEM)
+      break;
+    if (cap >= JSON_GETTER_MAX_ALLOC_TOKENS) {
+      jsget_destroy(jg);
+      return ERR;
+    }
+    cap *= 2;
+    if (cap > JSON_GETTER_MAX_ALLOC_TOKENS)
+      cap = JSON_GETTER_MAX_ALLOC_TOKENS;
+    jg->owned_toks =
+        (jsmntok_t *)xrealloc(jg->owned_toks, (size_t)cap * sizeof(jsmntok_t));
+  }
+
+  // Root must be an object for all current JsonGetter callers.
+  if (ntok <= 0 || jg->owned_toks[0].type != JSMN_OBJECT) {
     jsget_destroy(jg);
     return ERR;
   }
+
+  jg->toks = jg->owned_toks;
+  jg->ntok = ntok;
+  jg->root = 0;
+  // Owned documents (typically deep libpg_query ASTs) get their own index.
+  jg->kidx = jskidx_create();
   return OK;
 }
 
 void jsget_destroy(JsonGetter *jg) {
   if (!jg)
     return;
+  // The index follows token ownership: child views and workspace-backed
+  // getters only borrow theirs.
+  if (jg->owned_toks)
+    jskidx_destroy(jg->kidx);
   free(jg->owned_toks);
   memset(jg, 0, sizeof(*jg));
 }
@@ -1358,6 +2092,7 @@ AdbxTriStatus jsget_object(const JsonGetter *jg, const char *key,
   out->ntok = jg->ntok;
   out->root = val_i;
   out->owned_toks = owned_toks;
+  out->kidx = jg->kidx; // shared: token indexes identify objects
   return YES;
 }
 
@@ -1468,6 +2203,7 @@ AdbxTriStatus jsget_array_objects_next(const JsonGetter *jg, JsonArrIter *it,
   out_obj->ntok = jg->ntok;
   out_obj->root = i;
   out_obj->owned_toks = owned_toks;
+  out_obj->kidx = jg->kidx; // shared: token indexes identify objects
 
   int next = skip_token(jg->toks, jg->ntok, i);
   if (next < 0)
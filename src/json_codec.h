@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "bufio.h"
 #include "query_result.h"
 #include "string_op.h"
 #include "utils.h"
@@ -24,6 +25,7 @@
  *      "rows":[[<s|null>... ]...],
  *      "rowcount":<u>,
  *      "resultTruncated":<bool>,
+ *      "spilledRows":<U>, // only when overflow rows await fetch_result_page
  *      "warnings":[<s>...] // optional
  *    }
  *  }}
@@ -33,6 +35,11 @@
  *    "isError":true
  *  }}
  *
+ * When qr->columnar is set, successful results replace "rows" with one
+ * contiguous array per column (keys repeat when column names collide; order
+ * matches "columns"):
+ *    "data":{<col name>:[<s|null>...]...}
+ *
  *  {"jsonrpc":"2.0","id":<u|s>,"error":{"code":<int>,"message":<s>}}
  *
  * Returns:
@@ -45,6 +52,43 @@
 AdbxStatus qr_to_jsonrpc(const QueryResult *qr, char **out_json,
                          size_t *out_len);
 
+/* Serializes 'qr' as JSON-RPC and writes it framed directly into 'bc',
+ * streaming QR_OK rows one at a time instead of materializing the whole
+ * response (the payload length is computed with a sizing pass first).
+ * Payloads up to FRAME_CHUNK_THRESHOLD_BYTES go out as one u32 BE
+ * length-prefixed frame; larger ones use the chunked begin/chunks/end framing
+ * from frame_codec.h so the peer can relay while serialization continues.
+ * The concatenated payload bytes always equal qr_to_jsonrpc() exactly.
+ * It borrows both inputs.
+ * Side effects: writes to the underlying channel.
+ * Returns OK on success, ERR on invalid input, encode failure, oversized
+ * payload, or write failure (the channel may hold a partial frame then).
+ */
+AdbxStatus qr_to_jsonrpc_frame(const QueryResult *qr, BufChannel *bc);
+
+/* Serializes the id-independent portion of one successful (QR_OK) reply: the
+ * '"result":{...}' member plus the envelope's closing '}'. The bytes can be
+ * replayed later under a different request id with jsonrpc_result_frame();
+ * the concatenation equals qr_to_jsonrpc() output exactly. Note that exec_ms
+ * is baked into the bytes, so replays report the original execution time.
+ * Ownership: '*out_json' is malloc'd (NOT NUL-terminated); caller frees it.
+ * Returns OK on success, ERR on invalid input (error results included) or
+ * encode failure; then *out_json is NULL and *out_len 0.
+ */
+AdbxStatus qr_to_jsonrpc_result(const QueryResult *qr, char **out_json,
+                                size_t *out_len);
+
+/* Writes one framed JSON-RPC reply built from 'id' and a previously
+ * serialized qr_to_jsonrpc_result() suffix, without touching a QueryResult.
+ * Payloads follow the same single-frame/chunked rules as
+ * qr_to_jsonrpc_frame(). It borrows all inputs.
+ * Side effects: writes to the underlying channel.
+ * Returns OK on success, ERR on invalid input, oversized payload, or write
+ * failure (the channel may hold a partial frame then).
+ */
+AdbxStatus jsonrpc_result_frame(BufChannel *bc, const McpId *id,
+                                const char *result_json, size_t result_len);
+
 /* JSON helpers for building objects/arrays with automatic comma handling. */
 AdbxStatus json_obj_begin(StrBuf *sb);
 AdbxStatus json_obj_end(StrBuf *sb);
@@ -65,6 +109,17 @@ AdbxStatus json_arr_elem_bool(StrBuf *sb, int val);
 // helper to init a json object and add "jsonrpc":"2.0"
 AdbxStatus json_rpc_begin(StrBuf *sb);
 
+/* Validates that [s, s+len) is well-formed UTF-8: no stray continuations,
+ * overlong encodings, surrogates, truncated sequences, or codepoints past
+ * U+10FFFF. Pure-ASCII runs skip 16 bytes per step via the same vectorized
+ * chunk scan as the escape scanner, so the common all-ASCII payload costs one
+ * pass with no per-byte branches. Intended for untrusted host input; result
+ * cells from the database are trusted and skip this.
+ * Ownership: borrows 's'.
+ * Error semantics: returns OK on valid input (len 0 included), ERR otherwise.
+ */
+AdbxStatus json_utf8_validate(const char *s, size_t len);
+
 #define JSON_GETTER_MAX_TOKENS 1024
 
 typedef struct JsonArrIter {
@@ -81,6 +136,24 @@ typedef struct JsonTokBuf {
   jsmntok_t toks[JSON_GETTER_MAX_TOKENS];
 } JsonTokBuf;
 
+/* Reusable token workspace for jsget_init_ws(), for callers that parse one
+ * untrusted document per request in a long-lived loop.
+ * The buffer is allocated on first use, grows geometrically when a payload
+ * needs more tokens (jsmn parses resume after JSMN_ERROR_NOMEM, capped at
+ * JSON_GETTER_MAX_ALLOC_TOKENS), and is retained across parses, so
+ * steady-state request parsing performs zero tokenizer allocations.
+ * Zero-initialize before first use; release with jstokws_clean().
+ */
+/* Lazily built key index shared by every view over one tokenized document
+ * (see json_codec.c for the layout). Opaque to callers. */
+struct JsonKeyIdx;
+
+typedef struct JsonTokWs {
+  jsmntok_t *toks; // owned; NULL until the first parse
+  uint32_t cap;    // tokens currently allocated
+  struct JsonKeyIdx *kidx; // owned key index, reset at each parse
+} JsonTokWs;
+
 typedef struct JsonGetter {
   const char *json;
   size_t json_len;
@@ -88,6 +161,10 @@ typedef struct JsonGetter {
   int ntok;
   int root;              // token index of the root object for this view
   jsmntok_t *owned_toks; // owned only when initialized via jsget_create()
+  // Key index for repeatedly queried objects; owned by the getter that owns
+  // the tokens (jsget_create) or by the workspace (jsget_init_ws), borrowed
+  // by child views. NULL disables indexing (plain linear scans).
+  struct JsonKeyIdx *kidx;
 } JsonGetter;
 
 typedef struct {
@@ -106,6 +183,21 @@ typedef struct {
 AdbxStatus jsget_init(JsonGetter *jg, const char *json, size_t json_len,
                       JsonTokBuf *tok_buf);
 
+/* Same contract as jsget_init() but tokenizes into the caller-owned reusable
+ * workspace 'ws' instead of fixed stack storage, growing it as described on
+ * JsonTokWs. The JsonGetter borrows 'ws'; the workspace must outlive the view
+ * and must not be shared by two live views.
+ * Returns OK on success, ERR on parse error, bad input, or when the document
+ * needs more than JSON_GETTER_MAX_ALLOC_TOKENS tokens.
+ */
+AdbxStatus jsget_init_ws(JsonGetter *jg, const char *json, size_t json_len,
+                         JsonTokWs *ws);
+
+/* Releases the token buffer owned by 'ws' and resets it for reuse.
+ * Safe on NULL or never-used workspaces.
+ */
+void jstokws_clean(JsonTokWs *ws);
+
 #define JSON_GETTER_MAX_ALLOC_TOKENS 10000u
 /* Initializes JsonGetter by counting tokens first, then allocating exactly the
  * required token buffer up to an internal cap.
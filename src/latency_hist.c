@@ -0,0 +1,79 @@
+#include "latency_hist.h"
+
+#include <string.h>
+
+/* Maps one value to its bucket index: values below LHIST_SUB_BUCKETS map
+ * linearly, everything else lands in (msb, linear-sub-bucket) coordinates.
+ * Values past the tracked range clamp into the last bucket. */
+static uint32_t lhist_bucket_index(uint64_t v) {
+  if (v < LHIST_SUB_BUCKETS)
+    return (uint32_t)v;
+
+  uint32_t msb = 63u - (uint32_t)__builtin_clzll(v);
+  if (msb > LHIST_MAX_MSB)
+    return LHIST_N_BUCKETS - 1u;
+
+  uint32_t shift = msb - LHIST_SUB_BITS;
+  // top is in [SUB_BUCKETS, 2*SUB_BUCKETS), so indices stay contiguous with
+  // the linear region.
+  uint32_t top = (uint32_t)(v >> shift);
+  return (msb - LHIST_SUB_BITS) * LHIST_SUB_BUCKETS + top;
+}
+
+/* Returns the largest value mapping into bucket 'idx' (inverse of
+ * lhist_bucket_index, used to report quantile upper bounds). */
+static uint64_t lhist_bucket_upper(uint32_t idx) {
+  if (idx < LHIST_SUB_BUCKETS)
+    return idx;
+
+  uint32_t q = idx >> LHIST_SUB_BITS; // 1-based power-of-two range
+  uint32_t top = LHIST_SUB_BUCKETS + (idx & (LHIST_SUB_BUCKETS - 1u));
+  uint32_t shift = q - 1u;
+  return (((uint64_t)top + 1u) << shift) - 1u;
+}
+
+void lhist_init(LatencyHist *h) {
+  if (!h)
+    return;
+  memset(h, 0, sizeof(*h));
+}
+
+void lhist_record(LatencyHist *h, uint64_t value_us) {
+  if (!h)
+    return;
+  h->counts[lhist_bucket_index(value_us)]++;
+  h->count++;
+  h->sum += value_us;
+  if (value_us > h->max)
+    h->max = value_us;
+}
+
+uint64_t lhist_count(const LatencyHist *h) { return h ? h->count : 0; }
+
+uint64_t lhist_max(const LatencyHist *h) { return h ? h->max : 0; }
+
+uint64_t lhist_value_at_percentile(const LatencyHist *h, uint32_t pct) {
+  if (!h || h->count == 0)
+    return 0;
+  if (pct > 100u)
+    pct = 100u;
+
+  // Smallest sample rank covering 'pct' percent of the recorded population.
+  uint64_t target = (h->count * pct + 99u) / 100u;
+  if (target == 0)
+    target = 1;
+
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < LHIST_N_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= target) {
+      // The clamp bucket has no meaningful upper bound; report the exact max.
+      if (i == LHIST_N_BUCKETS - 1u)
+        return h->max;
+      uint64_t upper = lhist_bucket_upper(i);
+      // The exact max tightens the highest occupied bucket's bound.
+      return (upper > h->max) ? h->max : upper;
+    }
+  }
+  return h->max;
+}
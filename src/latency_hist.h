@@ -0,0 +1,57 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#include "utils.h"
+
+// Linear sub-buckets per power-of-two range: 16 buckets keep the relative
+// quantile error under ~6% at every magnitude.
+#define LHIST_SUB_BITS 4u
+#define LHIST_SUB_BUCKETS (1u << LHIST_SUB_BITS)
+
+// Largest power-of-two range tracked; values at or above 2^40 microseconds
+// (~12 days) are clamped into the top bucket.
+#define LHIST_MAX_MSB 39u
+
+#define LHIST_N_BUCKETS                                                        \
+  ((LHIST_MAX_MSB - LHIST_SUB_BITS + 2u) * LHIST_SUB_BUCKETS)
+
+/* Fixed-size log-linear (HDR-style) histogram of microsecond durations:
+ * values map to a power-of-two range plus a linear sub-bucket inside it, so
+ * recording is a handful of bit operations with no allocation and quantiles
+ * stay accurate to one sub-bucket at every magnitude.
+ *
+ * Not thread-safe: all calls on one histogram must come from the same thread
+ * (the broker records and reads its stage histograms on the event loop). A
+ * zero-initialized struct is a valid empty histogram.
+ */
+typedef struct LatencyHist {
+  uint64_t counts[LHIST_N_BUCKETS];
+  uint64_t count; // total recorded samples
+  uint64_t sum;   // sum of recorded values (for the mean)
+  uint64_t max;   // largest recorded value, exact
+} LatencyHist;
+
+/* Resets 'h' to the empty state.
+ * Error semantics: none; NULL input is ignored. */
+void lhist_init(LatencyHist *h);
+
+/* Records one duration of 'value_us' microseconds.
+ * Side effects: updates one bucket plus the count/sum/max aggregates; values
+ * past the tracked range are clamped into the top bucket (max stays exact).
+ * Error semantics: none; NULL input is ignored. */
+void lhist_record(LatencyHist *h, uint64_t value_us);
+
+/* Returns the number of recorded samples (0 for NULL input). */
+uint64_t lhist_count(const LatencyHist *h);
+
+/* Returns the largest recorded value in microseconds (0 when empty). */
+uint64_t lhist_max(const LatencyHist *h);
+
+/* Returns an upper bound (to one sub-bucket) of the value at percentile
+ * 'pct' (0..100, clamped), in microseconds.
+ * Error semantics: returns 0 for NULL input or an empty histogram. */
+uint64_t lhist_value_at_percentile(const LatencyHist *h, uint32_t pct);
+
+#endif
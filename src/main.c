@@ -1,3 +1,4 @@
+#include "async_log.h"
 #include "broker.h"
 #include "config_dir.h"
 #include "conn_catalog.h"
@@ -90,8 +91,8 @@ int main(int argc, char **argv) {
 
     McpServer s;
     McpServerInit init = {
-        .in = stdin,
-        .out = stdout,
+        .in_fd = STDIN_FILENO,
+        .out_fd = STDOUT_FILENO,
         .privd = pd,
     };
     if (mcpser_init(&s, &init) != OK) {
@@ -102,7 +103,11 @@ int main(int argc, char **argv) {
 
     // keep init logs inside stderr
     fprintf(stderr, "LOG: server init success\n");
+    // Best effort: on failure hot paths simply keep the synchronous fallback.
+    if (alog_start(NULL) != OK)
+      fprintf(stderr, "LOG: async logger failed to start\n");
     int rc = mcpser_run(&s);
+    alog_stop();
     if (rc != OK)
       fprintf(stderr, "ERROR: %s\n", mcpser_last_error(&s));
     mcpser_clean(&s);
@@ -132,12 +137,20 @@ int main(int argc, char **argv) {
   }
 
   char *cat_err = NULL;
-  ConnCatalog *cat = catalog_load_from_fd(config.fd, &cat_err);
+  ConnCatalog *cat = catalog_load_cached(config.fd, config.path, &cat_err);
+  // Keep the resolved path past conffile_clean(): SIGHUP reloads re-read it.
+  char *config_path_copy = NULL;
+  if (config.path) {
+    size_t plen = strlen(config.path);
+    config_path_copy = xmalloc(plen + 1);
+    memcpy(config_path_copy, config.path, plen + 1);
+  }
   conffile_clean(&config);
   if (!cat) {
     fprintf(stderr, "ERROR: catalog init failed: %s\n",
             cat_err ? cat_err : "unknown error");
     free(cat_err);
+    free(config_path_copy);
     privdir_clean(pd);
     return 1;
   }
@@ -150,6 +163,7 @@ int main(int argc, char **argv) {
     fprintf(stderr, "ERROR: secret store init failed: %s\n",
             ss_err ? ss_err : "unknown error");
     free(ss_err);
+    free(config_path_copy);
     privdir_clean(pd);
     return 1;
   }
@@ -161,20 +175,53 @@ int main(int argc, char **argv) {
     catalog_destroy(cat);
     secret_store_destroy(secrets);
     fprintf(stderr, "ERROR: conn manager init failed\n");
+    free(config_path_copy);
     privdir_clean(pd);
     return 1;
   }
 
+  // Opt-in: connect one pooled slot per profile up front so the first query
+  // does not pay the connection cost. Off by default because it touches the
+  // secret store for every profile at startup.
+  const char *prewarm = getenv("ADBX_PREWARM_CONNECTIONS");
+  if (prewarm && strcmp(prewarm, "1") == 0)
+    connm_prewarm(cm);
+
+  // Opt-in: background worker that pre-connects one slot per profile and
+  // periodically probes it, so first-query latency matches steady state and
+  // dead connections are replaced before a checkout hands them out.
+  const char *warm = getenv("ADBX_WARM_POOL");
+  if (warm && strcmp(warm, "1") == 0 && connm_warm_start(cm, 0) != OK)
+    fprintf(stderr, "LOG: warm pool worker failed to start\n");
+
+  // Profiles with "preconnect": true get one slot connected in the
+  // background while the broker finishes starting, so their first query
+  // does not pay the connection cost.
+  if (connm_preconnect_start(cm) != OK)
+    fprintf(stderr, "LOG: preconnect worker failed to start\n");
+
   Broker *b = broker_create(pd, cm);
   if (!b) {
     connm_destroy(cm);
     print_broker_init_error(pd);
+    free(config_path_copy);
     privdir_clean(pd);
     return 1;
   }
 
+  // SIGHUP then re-reads the config and swaps the catalog without dropping
+  // live sessions or warm connections for unchanged profiles.
+  if (config_path_copy &&
+      broker_enable_hot_reload(b, config_path_copy) != OK)
+    fprintf(stderr, "LOG: hot catalog reload unavailable\n");
+  free(config_path_copy);
+
   fprintf(stderr, "LOG: broker init success\n");
+  // Best effort: on failure hot paths simply keep the synchronous fallback.
+  if (alog_start(NULL) != OK)
+    fprintf(stderr, "LOG: async logger failed to start\n");
   int rc = broker_run(b);
+  alog_stop();
   if (rc != OK)
     fprintf(stderr, "ERROR: broker run failed\n");
   broker_destroy(b);
@@ -34,3 +34,17 @@ void mcp_id_clean(McpId *id) {
   id->kind = MCP_ID_INT;
   id->u32 = 0;
 }
+
+/* Returns YES when both ids carry the same kind and value, NO otherwise,
+ * ERR on NULL input. */
+AdbxTriStatus mcp_id_equal(const McpId *a, const McpId *b) {
+  if (!a || !b)
+    return ERR;
+  if (a->kind != b->kind)
+    return NO;
+  if (a->kind == MCP_ID_INT)
+    return (a->u32 == b->u32) ? YES : NO;
+  if (!a->str || !b->str)
+    return (a->str == b->str) ? YES : NO;
+  return (strcmp(a->str, b->str) == 0) ? YES : NO;
+}
@@ -29,4 +29,8 @@ AdbxStatus mcp_id_init_str_copy(McpId *id, const char *s);
 /* Releases any owned memory inside 'id'. Safe to call multiple times. */
 void mcp_id_clean(McpId *id);
 
+/* Returns YES when both ids carry the same kind and value, NO otherwise,
+ * ERR on NULL input. */
+AdbxTriStatus mcp_id_equal(const McpId *a, const McpId *b);
+
 #endif
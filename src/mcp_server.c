@@ -5,16 +5,22 @@
 #include "frame_codec.h"
 #include "handshake_codec.h"
 #include "json_codec.h"
+#include "async_log.h"
+#include "perf_counters.h"
 #include "log.h"
 #include "mcp_id.h"
+#include "qr_wire.h"
 #include "resume_token.h"
 #include "utils.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -39,6 +45,12 @@ static AdbxStatus mcpser_invalidate_broker(McpServer *s) {
     return ERR;
   s->flags &= ~MCPSER_F_BROKER_READY;
   bufch_clean(&s->brok_bc);
+  s->brok_fd = -1;
+  // Any half-relayed chunked reply died with the socket; callers already
+  // treat that case as fatal before invalidating.
+  s->chunk_active = 0;
+  s->chunk_left = 0;
+  s->chunk_raw_left = 0;
   return OK;
 }
 
@@ -87,8 +99,12 @@ static AdbxStatus mcpser_connect_broker_channel(McpServer *s,
   int brok_fd = connect_unix_socket(sock_path);
   if (brok_fd < 0)
     return ERR;
-  if (bufch_stdio_openfd_init(&s->brok_bc, brok_fd, brok_fd) != OK)
+  // The broker channel carries chunked result frames; start its adaptive
+  // read size at one chunk so large replies skip the realloc ladder.
+  if (bufch_stdio_openfd_init_sized(&s->brok_bc, brok_fd, brok_fd,
+                                    FRAME_CHUNK_BYTES) != OK)
     return ERR;
+  s->brok_fd = brok_fd;
 
   return OK;
 }
@@ -110,6 +126,9 @@ static AdbxStatus mcpser_send_broker_handshake_req(
   handshake_req_t req = {0};
   req.magic = HANDSHAKE_MAGIC;
   req.version = HANDSHAKE_VERSION;
+  // This server transcodes binary results, so the broker may skip JSON
+  // serialization on the private hop (see qr_wire.h).
+  req.flags |= HANDSHAKE_FLAG_BINARY_RESULTS;
   memcpy(req.secret_token, secret_token, SECRET_TOKEN_LEN);
   if (use_resume == YES) {
     req.flags |= HANDSHAKE_FLAG_RESUME;
@@ -182,16 +201,26 @@ static const char *mcpser_hs_status_desc(handshake_status st) {
 }
 
 /* Ensures broker channel is connected and handshake-complete for this server.
- * Ownership: borrows 's'; uses borrowed private-dir paths and owned resume
- * token store contained in 's'.
+ * When 'first_req' is not NULL, its frame is pipelined on the wire right
+ * behind the handshake request so a reconnect costs one round trip instead of
+ * two; '*out_req_sent' (required then) tells the caller whether the request
+ * reached the broker this way, so it must not be queued again.
+ * Ownership: borrows 's' and optional 'first_req'; uses borrowed private-dir
+ * paths and owned resume token store contained in 's'.
  * Side effects: may read secret token from disk, open/close broker sockets,
  * perform framed handshake I/O, and update persisted resume token state.
  * Error semantics: returns OK when broker is ready (already ready or newly
  * connected), ERR on missing/invalid inputs or failed connect/handshake flow.
  */
-static AdbxStatus mcpser_connect_and_handshake_broker(McpServer *s) {
+static AdbxStatus mcpser_connect_and_handshake_broker_req(McpServer *s,
+                                                          const StrBuf *first_req,
+                                                          int *out_req_sent) {
   if (!s || !s->privd || !s->privd->sock_path)
     return ERR;
+  if (first_req && !out_req_sent)
+    return ERR;
+  if (out_req_sent)
+    *out_req_sent = NO;
 
   // Ready means we already have a connected channel that completed handshake.
   if ((s->flags & MCPSER_F_BROKER_READY) != 0 && s->brok_bc.ch != NULL)
@@ -220,6 +249,15 @@ static AdbxStatus mcpser_connect_and_handshake_broker(McpServer *s) {
     handshake_resp_t resp = {0};
     AdbxStatus rc = mcpser_send_broker_handshake_req(s, secret_token,
                                                      have_resume, resume_token);
+    if (rc == OK && first_req) {
+      // Pipeline the first request behind the handshake: both frames share
+      // one send and the broker answers handshake-resp then request-resp,
+      // so resume costs a single round trip. On handshake rejection the
+      // broker closes without reading further frames, so each retry must
+      // resend the request on its fresh socket.
+      rc = frame_write_len(&s->brok_bc, first_req->data,
+                           (uint32_t)first_req->len);
+    }
     if (rc == OK)
       rc = mcpser_read_broker_handshake_resp(s, &resp);
     if (rc != OK) {
@@ -232,7 +270,10 @@ static AdbxStatus mcpser_connect_and_handshake_broker(McpServer *s) {
         fprintf(stderr,
                 "Failed to write token file: session resume disabled\n");
       }
+      if (first_req)
+        *out_req_sent = YES;
       s->flags |= MCPSER_F_BROKER_READY;
+      PERF_COUNT(PERF_BROKER_RECONNECTS);
       return OK;
     }
 
@@ -257,6 +298,12 @@ static AdbxStatus mcpser_connect_and_handshake_broker(McpServer *s) {
   return ERR;
 }
 
+/* Same as mcpser_connect_and_handshake_broker_req() without a pipelined first
+ * request. */
+static AdbxStatus mcpser_connect_and_handshake_broker(McpServer *s) {
+  return mcpser_connect_and_handshake_broker_req(s, NULL, NULL);
+}
+
 /* Emits a JSON-RPC error explaining broker unavailability.
  * Ownership: borrows all inputs.
  * Side effects: writes one error frame to the MCP host output channel.
@@ -338,15 +385,24 @@ err:
 }
 
 AdbxStatus mcpser_init(McpServer *s, const McpServerInit *init) {
-  if (!s || !init || !init->in || !init->out || !init->privd)
+  if (!s || !init || init->in_fd < 0 || init->out_fd < 0 || !init->privd)
     return ERR;
   memset(s, 0, sizeof(*s));
   s->last_err[0] = '\0';
 
-  int in_fd = fileno(init->in);
-  int out_fd = fileno(init->out);
-  if (in_fd < 0 || out_fd < 0)
-    return ERR;
+  int in_fd = init->in_fd;
+  int out_fd = init->out_fd;
+  s->in_fd = in_fd;
+  s->out_fd = out_fd;
+  s->brok_fd = -1;
+#ifdef __linux__
+  // splice(2) needs a pipe on one side of the move. MCP hosts normally talk
+  // to the server over pipes; a redirected stdout (file, tty) keeps the
+  // buffered copy path.
+  struct stat ost;
+  if (fstat(out_fd, &ost) == 0 && S_ISFIFO(ost.st_mode))
+    s->out_is_pipe = 1;
+#endif
 
   // The McpServer doesn't own the input/output file descriptors, so it wraps
   // them as non-owning channels.
@@ -398,8 +454,7 @@ static AdbxStatus mcpser_user_initialize_handshake(McpServer *s) {
   const char *json = req.data;
 
   JsonGetter jg;
-  JsonTokBuf tok_buf = {0};
-  AdbxStatus irc = jsget_init(&jg, json, req.len, &tok_buf);
+  AdbxStatus irc = jsget_init_ws(&jg, json, req.len, &s->tok_ws);
   if (irc != OK) {
     TLOG("ERROR - handshake parse failed (invalid JSON or token overflow, "
          "len=%zu)",
@@ -530,10 +585,9 @@ static AdbxTriStatus mcpser_validate_user_req(McpServer *s, const StrBuf *req,
   *idp_out = NULL;
 
   JsonGetter jg;
-  JsonTokBuf tok_buf = {0};
-  AdbxStatus irc = jsget_init(&jg, req->data, req->len, &tok_buf);
+  AdbxStatus irc = jsget_init_ws(&jg, req->data, req->len, &s->tok_ws);
   if (irc != OK) {
-    fprintf(stderr, "McpServer: malformed input\n");
+    alog_write("McpServer: malformed input");
     TLOG("ERROR - invalid JSON in MCP input or token overflow (len=%zu)",
          req->len);
     if (mcpser_send_error(s, NULL, -32600, "Malformed JSON-RPC request",
@@ -555,7 +609,16 @@ static AdbxTriStatus mcpser_validate_user_req(McpServer *s, const StrBuf *req,
       id_out->str = id_str;
       *idp_out = id_out;
     } else if (src == NO) {
-      // Notifications have no id; ignore them for now.
+      // Notifications have no id. Cancellations are forwarded so the broker
+      // can abort the in-flight statement; they expect no reply, so the
+      // caller must not queue an id for them (*idp_out stays NULL).
+      JsonStrSpan method_sp = {0};
+      if (jsget_string_span(&jg, "method", &method_sp) == YES &&
+          STREQ(method_sp.ptr, method_sp.len, "notifications/cancelled") &&
+          req->len <= UINT32_MAX) {
+        return YES;
+      }
+      // Other notifications are ignored for now.
       return NO;
     } else {
       TLOG("ERROR - invalid id in JSON-RPC request");
@@ -570,7 +633,7 @@ static AdbxTriStatus mcpser_validate_user_req(McpServer *s, const StrBuf *req,
 
   AdbxTriStatus vrc = jsget_simple_rpc_validation(&jg);
   if (vrc != YES) {
-    fprintf(stderr, "McpServer: invalid input\n");
+    alog_write("McpServer: invalid input");
     TLOG("ERROR - invalid JSON-RPC envelope");
     if (mcpser_send_error(s, *idp_out, -32600, "Invalid JSON-RPC request.",
                           NULL) != OK) {
@@ -587,7 +650,7 @@ static AdbxTriStatus mcpser_validate_user_req(McpServer *s, const StrBuf *req,
 
   // Overflow guard before narrowing request length to uint32 for broker frame.
   if (req->len > UINT32_MAX) {
-    fprintf(stderr, "McpServer: request too large\n");
+    alog_write("McpServer: request too large");
     TLOG("ERROR - request too large: len=%zu", req->len);
     if (mcpser_send_error(s, *idp_out, -32600, "Request too large.", NULL) !=
         OK) {
@@ -605,119 +668,545 @@ static AdbxTriStatus mcpser_validate_user_req(McpServer *s, const StrBuf *req,
   return YES;
 }
 
-AdbxStatus mcpser_run(McpServer *s) {
-  // This is the flow of McpServer:
-  // handshake -> read JSON-RPC -> validate -> write to broker -> read from
-  // broker -> write to out channel
-  if (!s || !s->in_bc.ch || !s->out_bc.ch || !s->privd)
+// Upper bound on host requests forwarded to the broker while their replies
+// are still pending. Past this, the relay stops reading stdin until a reply
+// frees a slot. Must not exceed FRAME_BATCH_MAX_FRAMES: in-flight slots also
+// back the payloads of not-yet-flushed batched frames.
+#define MCPSER_MAX_INFLIGHT 16u
+
+/* FIFO correlation queue for requests already forwarded to the broker.
+ * The broker executes one session's requests in submission order and replies
+ * in that same order, so the head entry always corresponds to the next broker
+ * reply; the queued ids exist to attribute a per-request error to every
+ * in-flight request when the broker connection drops mid-pipeline. */
+typedef struct McpPendingQueue {
+  McpId ids[MCPSER_MAX_INFLIGHT]; // owned; released on pop/fail
+  size_t head;                    // index of the oldest in-flight request
+  size_t count;                   // number of queued ids
+} McpPendingQueue;
+
+/* Appends one id to the in-flight queue, taking ownership of its storage.
+ * Error semantics: returns OK on success, ERR when the queue is full. */
+static AdbxStatus pendq_push(McpPendingQueue *q, const McpId *id) {
+  if (!q || !id || q->count >= MCPSER_MAX_INFLIGHT)
     return ERR;
+  q->ids[(q->head + q->count) % MCPSER_MAX_INFLIGHT] = *id;
+  q->count++;
+  return OK;
+}
 
-  AdbxStatus hrc = mcpser_user_initialize_handshake(s);
-  if (hrc != OK)
+/* Removes the oldest in-flight id into caller-owned 'out'.
+ * Ownership: caller must mcp_id_clean() 'out'.
+ * Error semantics: returns OK on success, ERR when the queue is empty. */
+static AdbxStatus pendq_pop(McpPendingQueue *q, McpId *out) {
+  if (!q || !out || q->count == 0)
     return ERR;
-  TLOG("INFO - handshake complete, entering main loop");
+  *out = q->ids[q->head];
+  q->head = (q->head + 1) % MCPSER_MAX_INFLIGHT;
+  q->count--;
+  return OK;
+}
 
-  for (;;) {
-    // McpServer reads JSON-RPC request
-    StrBuf req;
-    sb_init(&req);
-    AdbxTriStatus rc = frame_read_cl(&s->in_bc, &req);
-    TLOG("INFO - frame_read_cl rc=%d len=%zu", rc, req.len);
-    if (rc == NO) {
-      // EOF
-      sb_clean(&req);
-      TLOG("INFO - EOF on MCP stdin.");
-      return OK;
+/* Fails every queued in-flight request with a broker-unavailable error.
+ * Side effects: writes one JSON-RPC error per queued id to the host channel
+ * and releases all queued ids (even when a write fails).
+ * Error semantics: returns OK when every error reply was written, ERR when at
+ * least one write failed. */
+static AdbxStatus pendq_fail_all(McpServer *s, McpPendingQueue *q) {
+  AdbxStatus rc = OK;
+  McpId id;
+  while (pendq_pop(q, &id) == OK) {
+    if (mcpser_send_broker_unavailable(s, &id) != OK)
+      rc = ERR;
+    mcp_id_clean(&id);
+  }
+  return rc;
+}
+
+/* Validates one host request frame and queues it for the broker.
+ * Ownership: borrows 's'; on forward success the request id moves into 'pq'
+ * and 'req' bytes are borrowed by 'fb' until its next flush.
+ * Side effects: may (re)connect the broker, queues one broker frame (which
+ * can trigger an eager batch flush), and may write JSON-RPC error replies to
+ * the host channel.
+ * Error semantics: returns OK when the frame was handled (queued, rejected
+ * with an error reply, or ignored), ERR when processing must stop.
+ */
+static AdbxStatus mcpser_relay_user_req(McpServer *s, const StrBuf *req,
+                                        McpPendingQueue *pq, FrameBatch *fb) {
+  McpId id = {0};
+  const McpId *idp = NULL;
+  AdbxTriStatus vrc = mcpser_validate_user_req(s, req, &id, &idp);
+  if (vrc == ERR)
+    return ERR;
+  if (vrc == NO)
+    return OK;
+
+  // Keep fail-closed semantics: never process requests without a live broker
+  // handshake, but keep MCP server alive and reply with explicit errors.
+  // A NULL 'idp' marks a forwarded notification: it gets no reply slot and
+  // no error attribution (there is no id to answer on).
+  // On a reconnect with nothing batched ahead, the request itself rides on
+  // the handshake exchange so resume-to-first-result costs one round trip.
+  int req_sent = NO;
+  int can_pipeline =
+      ((s->flags & MCPSER_F_BROKER_READY) == 0 && fb->nframes == 0) ? YES : NO;
+  AdbxStatus crc =
+      (can_pipeline == YES)
+          ? mcpser_connect_and_handshake_broker_req(s, req, &req_sent)
+          : mcpser_connect_and_handshake_broker(s);
+  if (crc != OK) {
+    alog_write("McpServer: broker unavailable");
+    TLOG("ERROR - broker connect+handshake failed for request");
+    AdbxStatus erc = idp ? mcpser_send_broker_unavailable(s, idp) : OK;
+    mcp_id_clean(&id);
+    if (erc != OK) {
+      mcpser_set_err(s, "failed to write error response");
+      return ERR;
     }
-    if (rc == ERR) {
-      sb_clean(&req);
-      TLOG("ERROR - frame_read_cl failed while reading MCP input");
-      mcpser_set_err(s, "failed to read input");
+    return OK;
+  }
+
+  if (req_sent != YES &&
+      frame_batch_add(fb, req->data, (uint32_t)req->len) != OK) {
+    // Only an eager flush can fail here, so the socket is what died.
+    alog_write("McpServer: broker write failed");
+    TLOG("ERROR - failed to write request batch to broker");
+    frame_batch_reset(fb);
+    (void)mcpser_invalidate_broker(s);
+    // Replies for every earlier in-flight request die with this socket.
+    AdbxStatus frc = pendq_fail_all(s, pq);
+    AdbxStatus erc = idp ? mcpser_send_broker_unavailable(s, idp) : OK;
+    mcp_id_clean(&id);
+    if (frc != OK || erc != OK) {
+      mcpser_set_err(s, "failed to write error response");
       return ERR;
     }
+    return OK;
+  }
+
+  if (idp && pendq_push(pq, &id) != OK) {
+    // The caller only relays while a slot is free, so this is internal.
+    mcp_id_clean(&id);
+    mcpser_set_err(s, "in-flight queue overflow");
+    return ERR;
+  }
+  PERF_COUNT(PERF_FRAMES_RELAYED);
+  return OK;
+}
+
+/* Relays the raw body of the in-progress payload chunk to the host.
+ * Bytes already pulled into the broker read buffer go out through the
+ * channel; on Linux, when stdout is a pipe, the remainder moves straight
+ * from the broker socket with splice(2) and never crosses userspace.
+ * Ownership: borrows 's'.
+ * Side effects: consumes broker channel/socket bytes, writes to stdout, and
+ * updates 's->chunk_left'/'s->chunk_raw_left'.
+ * Error semantics: returns OK when the only thing missing is more broker
+ * bytes ('s->chunk_raw_left' tells the caller whether to poll), ERR on
+ * broker EOF mid-chunk or a stdout write failure; both are fatal because the
+ * Content-Length header is already out ('s->last_err' is set).
+ */
+static AdbxStatus mcpser_chunk_relay_raw(McpServer *s) {
+  if (!s)
+    return ERR;
 
-    McpId id = {0};
-    const McpId *idp = NULL;
-    AdbxTriStatus vrc = mcpser_validate_user_req(s, &req, &id, &idp);
-    if (vrc == ERR) {
-      sb_clean(&req);
+  // Relay whatever the buffered channel already holds first; bytes past the
+  // chunk belong to later frames and stay buffered.
+  size_t avail = 0;
+  const uint8_t *pb = bufch_peek(&s->brok_bc, &avail);
+  if (pb && avail > 0) {
+    size_t take = avail < s->chunk_raw_left ? avail : (size_t)s->chunk_raw_left;
+    if (bufch_write_all(&s->out_bc, pb, take) != OK) {
+      alog_write("McpServer: stdout write failed");
+      TLOG("ERROR - failed to write response to stdout");
+      mcpser_set_err(s, "failed to write to stdout");
       return ERR;
     }
-    if (vrc == NO) {
-      sb_clean(&req);
+    bufch_consume(&s->brok_bc, take);
+    s->chunk_left -= (uint32_t)take;
+    s->chunk_raw_left -= (uint32_t)take;
+  }
+
+  if (s->chunk_raw_left > 0 && bufch_is_eof(&s->brok_bc) == YES) {
+    alog_write("McpServer: broker closed connection");
+    TLOG("ERROR - broker EOF mid chunked reply");
+    mcpser_set_err(s, "broker died mid chunked reply");
+    return ERR;
+  }
+
+#ifdef __linux__
+  while (s->chunk_raw_left > 0 && s->out_is_pipe && s->brok_fd >= 0) {
+    // Splice only when the socket is readable: the fd is blocking, and
+    // SPLICE_F_NONBLOCK alone does not keep splice() from waiting on it.
+    struct pollfd rd = {.fd = s->brok_fd, .events = POLLIN, .revents = 0};
+    int prc = poll(&rd, 1, 0);
+    if (prc < 0) {
+      if (errno == EINTR)
+        continue;
+      break; // the main loop's poll will surface the failure
+    }
+    if (prc == 0)
+      break; // no socket bytes yet; the main loop polls for them
+
+    ssize_t n = splice(s->brok_fd, NULL, s->out_fd, NULL,
+                       (size_t)s->chunk_raw_left,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (n > 0) {
+      s->chunk_left -= (uint32_t)n;
+      s->chunk_raw_left -= (uint32_t)n;
       continue;
     }
-
-    // Keep fail-closed semantics: never process requests without a live broker
-    // handshake, but keep MCP server alive and reply with explicit errors.
-    if (mcpser_connect_and_handshake_broker(s) != OK) {
-      fprintf(stderr, "McpServer: broker unavailable\n");
-      TLOG("ERROR - broker connect+handshake failed for request");
-      sb_clean(&req);
-      if (mcpser_send_broker_unavailable(s, idp) != OK) {
-        mcpser_set_err(s, "failed to write error response");
-        if (idp)
-          mcp_id_clean(&id);
+    if (n == 0) {
+      alog_write("McpServer: broker closed connection");
+      TLOG("ERROR - broker EOF mid chunked reply");
+      mcpser_set_err(s, "broker died mid chunked reply");
+      return ERR;
+    }
+    if (errno == EINTR)
+      continue;
+    if (errno == EAGAIN) {
+      // The socket was readable, so this is the pipe side: stdout is full.
+      // Stdout writes block everywhere else in the relay, so wait here too.
+      struct pollfd wr = {.fd = s->out_fd, .events = POLLOUT, .revents = 0};
+      if (poll(&wr, 1, -1) < 0 && errno != EINTR) {
+        alog_write("McpServer: stdout write failed");
+        TLOG("ERROR - failed to wait for stdout writability");
+        mcpser_set_err(s, "failed to write to stdout");
         return ERR;
       }
-      if (idp)
-        mcp_id_clean(&id);
       continue;
     }
+    if (errno == EINVAL || errno == ENOSYS) {
+      // splice cannot serve this fd pair after all; the buffered path above
+      // finishes the chunk across main-loop iterations.
+      s->out_is_pipe = 0;
+      break;
+    }
+    alog_write("McpServer: broker read failed");
+    TLOG("ERROR - splice from broker failed: %s", strerror(errno));
+    mcpser_set_err(s, "broker died mid chunked reply");
+    return ERR;
+  }
+#endif
+  return OK;
+}
 
-    // McpServer sends request to the broker.
-    if (frame_write_len(&s->brok_bc, req.data, (uint32_t)req.len) != OK) {
-      fprintf(stderr, "McpServer: broker write failed\n");
-      sb_clean(&req);
-      TLOG("ERROR - failed to write request to broker");
-      (void)mcpser_invalidate_broker(s);
-      if (mcpser_send_broker_unavailable(s, idp) != OK) {
-        mcpser_set_err(s, "failed to write error response");
-        if (idp)
-          mcp_id_clean(&id);
-        return ERR;
+AdbxStatus mcpser_run(McpServer *s) {
+  // This is the flow of McpServer:
+  // handshake -> pipelined relay loop. Host requests are validated and
+  // forwarded to the broker as they arrive while earlier replies are still
+  // pending, so independent tool calls overlap instead of queueing behind
+  // each broker round-trip. Broker replies come back in submission order and
+  // are forwarded to the host as soon as a full frame is buffered.
+  if (!s || !s->in_bc.ch || !s->out_bc.ch || !s->privd)
+    return ERR;
+
+  AdbxStatus hrc = mcpser_user_initialize_handshake(s);
+  if (hrc != OK)
+    return ERR;
+  TLOG("INFO - handshake complete, entering main loop");
+
+  McpPendingQueue pq = {0};
+  int stdin_eof = NO;
+
+  // Request bytes live in per-slot buffers so a whole burst can be queued in
+  // 'out_batch' (which borrows them) and hit the wire as one vectored write.
+  FrameBatch out_batch;
+  frame_batch_init(&out_batch, &s->brok_bc);
+  StrBuf req_slots[MCPSER_MAX_INFLIGHT];
+  for (size_t i = 0; i < MCPSER_MAX_INFLIGHT; i++)
+    sb_init(&req_slots[i]);
+
+  for (;;) {
+    // Drain complete host request frames already buffered while in-flight
+    // slots are free.
+    while (stdin_eof == NO && pq.count < MCPSER_MAX_INFLIGHT &&
+           out_batch.nframes < MCPSER_MAX_INFLIGHT) {
+      // Batched frames borrow slots [0, nframes), so the next read lands in
+      // slot nframes; notifications batch a frame without taking a pendq
+      // slot, so nframes (not just pq.count) must be bounded here.
+      StrBuf *req = &req_slots[out_batch.nframes];
+      AdbxTriStatus frc = frame_read_cl_buffered(&s->in_bc, req);
+      if (frc == NO)
+        break;
+      if (frc == ERR) {
+        TLOG("ERROR - malformed Content-Length frame on MCP input");
+        mcpser_set_err(s, "failed to read input");
+        goto fatal;
       }
-      if (idp)
-        mcp_id_clean(&id);
-      continue;
+      TLOG("INFO - relaying host frame len=%zu inflight=%zu", req->len,
+           pq.count);
+      if (mcpser_relay_user_req(s, req, &pq, &out_batch) != OK)
+        goto fatal;
     }
-    sb_clean(&req);
 
-    // McpServer reads broker response
-    //
-    StrBuf resp;
-    sb_init(&resp);
-    if (frame_read_len(&s->brok_bc, &resp) != OK) {
-      fprintf(stderr, "McpServer: broker read failed\n");
-      sb_clean(&resp);
-      TLOG("ERROR - failed to read response from broker");
+    // End of burst: push every queued request to the broker at once.
+    if ((s->flags & MCPSER_F_BROKER_READY) != 0 &&
+        frame_batch_flush(&out_batch) != OK) {
+      alog_write("McpServer: broker write failed");
+      TLOG("ERROR - failed to flush request batch to broker");
       (void)mcpser_invalidate_broker(s);
-      if (mcpser_send_broker_unavailable(s, idp) != OK) {
+      if (pendq_fail_all(s, &pq) != OK) {
         mcpser_set_err(s, "failed to write error response");
-        if (idp)
-          mcp_id_clean(&id);
-        return ERR;
+        goto fatal;
       }
-      if (idp)
-        mcp_id_clean(&id);
-      continue;
     }
 
-    // McpServer writes response to user
-    if (frame_write_cl(&s->out_bc, resp.data, resp.len) != OK) {
-      fprintf(stderr, "McpServer: stdout write failed\n");
-      sb_clean(&resp);
-      TLOG("ERROR - failed to write response to stdout");
-      mcpser_set_err(s, "failed to write to stdout");
-      if (idp)
-        mcp_id_clean(&id);
-      return ERR;
+    // Forward complete broker reply frames already buffered. Replies are
+    // relayed verbatim, so they go out as borrowed zero-copy views into the
+    // broker read buffer instead of bouncing through a StrBuf.
+    while (pq.count > 0 && (s->flags & MCPSER_F_BROKER_READY) != 0) {
+      if (s->chunk_active && s->chunk_raw_left == 0) {
+        // Classify the next frame from its header plus first payload byte:
+        // control frames start with 0x00 and chunk payloads are JSON text,
+        // which never does. Payload chunks then relay raw without waiting
+        // for the whole frame to buffer.
+        uint32_t flen = 0;
+        size_t cavail = 0;
+        const uint8_t *chead = bufch_peek(&s->brok_bc, &cavail);
+        if (frame_peek_len(&s->brok_bc, &flen) == YES && flen > 0 && chead &&
+            cavail > sizeof(uint32_t) &&
+            chead[sizeof(uint32_t)] != FRAME_CHUNK_CTRL_TAG) {
+          if (flen > s->chunk_left) {
+            TLOG("ERROR - chunked broker reply overruns declared length");
+            mcpser_set_err(s, "malformed chunked broker reply");
+            goto fatal;
+          }
+          bufch_consume(&s->brok_bc, sizeof(uint32_t));
+          s->chunk_raw_left = flen;
+        }
+      }
+      if (s->chunk_raw_left > 0) {
+        if (mcpser_chunk_relay_raw(s) != OK)
+          goto fatal;
+        if (s->chunk_raw_left > 0)
+          break; // rest of the chunk is not on the socket yet; poll for it
+        continue;
+      }
+
+      const uint8_t *reply = NULL;
+      uint32_t reply_len = 0;
+      AdbxTriStatus rrc = frame_view_len(&s->brok_bc, &reply, &reply_len);
+      if (rrc == NO) {
+        if (bufch_is_eof(&s->brok_bc) == YES) {
+          // The broker went away with replies still owed.
+          alog_write("McpServer: broker closed connection");
+          TLOG("ERROR - broker EOF with %zu in-flight requests", pq.count);
+          if (s->chunk_active) {
+            // Part of a Content-Length body already went to the host; the
+            // stdout framing is torn and no error reply can be written.
+            mcpser_set_err(s, "broker died mid chunked reply");
+            goto fatal;
+          }
+          (void)mcpser_invalidate_broker(s);
+          if (pendq_fail_all(s, &pq) != OK) {
+            mcpser_set_err(s, "failed to write error response");
+            goto fatal;
+          }
+        }
+        break;
+      }
+      if (rrc == ERR) {
+        alog_write("McpServer: broker read failed");
+        TLOG("ERROR - failed to read response from broker");
+        if (s->chunk_active) {
+          mcpser_set_err(s, "broker died mid chunked reply");
+          goto fatal;
+        }
+        (void)mcpser_invalidate_broker(s);
+        if (pendq_fail_all(s, &pq) != OK) {
+          mcpser_set_err(s, "failed to write error response");
+          goto fatal;
+        }
+        break;
+      }
+
+      if (s->chunk_active) {
+        // Inside a chunked reply: frames are payload chunks until the end
+        // control frame arrives.
+        uint32_t ctotal = 0;
+        AdbxTriStatus crc = frame_chunk_parse_ctrl(
+            reply, reply_len, FRAME_CHUNK_CTRL_END, &ctotal);
+        if (crc == ERR || (crc == YES && s->chunk_left != 0)) {
+          TLOG("ERROR - malformed chunked broker reply");
+          mcpser_set_err(s, "malformed chunked broker reply");
+          goto fatal;
+        }
+        if (crc == YES) {
+          McpId done_id;
+          if (pendq_pop(&pq, &done_id) != OK) {
+            TLOG("ERROR - broker reply with no in-flight request");
+            mcpser_set_err(s, "unexpected broker reply");
+            goto fatal;
+          }
+          mcp_id_clean(&done_id);
+          s->chunk_active = 0;
+          frame_consume_len(&s->brok_bc, reply_len);
+          continue;
+        }
+        if (reply_len == 0 || reply_len > s->chunk_left) {
+          TLOG("ERROR - chunked broker reply overruns declared length");
+          mcpser_set_err(s, "malformed chunked broker reply");
+          goto fatal;
+        }
+        // The Content-Length header is already out; chunk bytes relay raw.
+        if (bufch_write_all(&s->out_bc, reply, reply_len) != OK) {
+          alog_write("McpServer: stdout write failed");
+          TLOG("ERROR - failed to write response to stdout");
+          mcpser_set_err(s, "failed to write to stdout");
+          goto fatal;
+        }
+        s->chunk_left -= reply_len;
+        frame_consume_len(&s->brok_bc, reply_len);
+        continue;
+      }
+
+      uint32_t ctotal = 0;
+      AdbxTriStatus crc = frame_chunk_parse_ctrl(
+          reply, reply_len, FRAME_CHUNK_CTRL_BEGIN, &ctotal);
+      if (crc == ERR || (crc == YES && ctotal == 0)) {
+        TLOG("ERROR - malformed chunked broker reply");
+        mcpser_set_err(s, "malformed chunked broker reply");
+        goto fatal;
+      }
+      if (crc == YES) {
+        // Chunked reply: emit the host framing header now so payload chunks
+        // relay to stdout as they arrive instead of buffering the whole
+        // response first.
+        if (frame_write_cl_head(&s->out_bc, (size_t)ctotal) != OK) {
+          alog_write("McpServer: stdout write failed");
+          TLOG("ERROR - failed to write response to stdout");
+          mcpser_set_err(s, "failed to write to stdout");
+          goto fatal;
+        }
+        s->chunk_active = 1;
+        s->chunk_left = ctotal;
+        frame_consume_len(&s->brok_bc, reply_len);
+        continue;
+      }
+
+      McpId done_id;
+      if (pendq_pop(&pq, &done_id) != OK) {
+        TLOG("ERROR - broker reply with no in-flight request");
+        mcpser_set_err(s, "unexpected broker reply");
+        goto fatal;
+      }
+      mcp_id_clean(&done_id);
+
+      if (reply_len > 0 && reply[0] == QR_WIRE_MARKER) {
+        // Binary result from the negotiated private hop: the JSON the host
+        // speaks is produced here, off the broker's critical path.
+        char *json = NULL;
+        size_t json_len = 0;
+        if (qr_wire_to_jsonrpc(reply, reply_len, &json, &json_len) != OK) {
+          TLOG("ERROR - malformed binary broker reply (len=%u)", reply_len);
+          mcpser_set_err(s, "malformed binary broker reply");
+          goto fatal;
+        }
+        AdbxStatus wrc = frame_write_cl(&s->out_bc, json, json_len);
+        free(json);
+        if (wrc != OK) {
+          alog_write("McpServer: stdout write failed");
+          TLOG("ERROR - failed to write response to stdout");
+          mcpser_set_err(s, "failed to write to stdout");
+          goto fatal;
+        }
+        frame_consume_len(&s->brok_bc, reply_len);
+        continue;
+      }
+
+      // McpServer writes response to user
+      if (frame_write_cl(&s->out_bc, reply, reply_len) != OK) {
+        alog_write("McpServer: stdout write failed");
+        TLOG("ERROR - failed to write response to stdout");
+        mcpser_set_err(s, "failed to write to stdout");
+        goto fatal;
+      }
+      frame_consume_len(&s->brok_bc, reply_len);
     }
 
-    sb_clean(&resp);
-    if (idp)
-      mcp_id_clean(&id);
+    // Host closed its side and every reply went out: clean shutdown.
+    if (stdin_eof == YES && pq.count == 0) {
+      for (size_t i = 0; i < MCPSER_MAX_INFLIGHT; i++)
+        sb_clean(&req_slots[i]);
+      TLOG("INFO - EOF on MCP stdin.");
+      return OK;
+    }
+
+    // Wait for readiness on the channels that can make progress.
+    struct pollfd pfds[2];
+    int stdin_slot = -1;
+    int brok_slot = -1;
+    nfds_t nfds = 0;
+    if (stdin_eof == NO && pq.count < MCPSER_MAX_INFLIGHT &&
+        out_batch.nframes < MCPSER_MAX_INFLIGHT) {
+      stdin_slot = (int)nfds;
+      pfds[nfds].fd = s->in_fd;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      nfds++;
+    }
+    if (pq.count > 0 && (s->flags & MCPSER_F_BROKER_READY) != 0 &&
+        s->brok_fd >= 0) {
+      brok_slot = (int)nfds;
+      pfds[nfds].fd = s->brok_fd;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      nfds++;
+    }
+    if (nfds == 0) {
+      // In-flight requests without a broker channel are failed on
+      // invalidation, so this state is unreachable; bail instead of spinning.
+      TLOG("ERROR - relay loop has no pollable channel");
+      mcpser_set_err(s, "relay state inconsistent");
+      goto fatal;
+    }
+
+    int prc = poll(pfds, nfds, -1);
+    if (prc < 0) {
+      if (errno == EINTR)
+        continue;
+      TLOG("ERROR - poll failed: %s", strerror(errno));
+      mcpser_set_err(s, "failed to wait for input");
+      goto fatal;
+    }
+
+    if (stdin_slot >= 0 &&
+        (pfds[stdin_slot].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+      AdbxTriStatus fillrc = bufch_fill_some(&s->in_bc);
+      if (fillrc == NO)
+        stdin_eof = YES;
+      if (fillrc == ERR) {
+        TLOG("ERROR - read failed on MCP input");
+        mcpser_set_err(s, "failed to read input");
+        goto fatal;
+      }
+    }
+    if (brok_slot >= 0 &&
+        (pfds[brok_slot].revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+      AdbxTriStatus fillrc = bufch_fill_some(&s->brok_bc);
+      if (fillrc == ERR) {
+        alog_write("McpServer: broker read failed");
+        TLOG("ERROR - read failed on broker channel");
+        (void)mcpser_invalidate_broker(s);
+        if (pendq_fail_all(s, &pq) != OK) {
+          mcpser_set_err(s, "failed to write error response");
+          goto fatal;
+        }
+      }
+      // fillrc == NO only sets the sticky EOF flag; the reply drain above
+      // consumes any fully buffered frames before failing the pipeline.
+    }
   }
+
+fatal:
+  frame_batch_reset(&out_batch);
+  for (size_t i = 0; i < MCPSER_MAX_INFLIGHT; i++)
+    sb_clean(&req_slots[i]);
+  // Best-effort: release queued ids and tell the host their replies are lost.
+  (void)pendq_fail_all(s, &pq);
+  return ERR;
 }
 
 void mcpser_clean(McpServer *s) {
@@ -726,7 +1215,11 @@ void mcpser_clean(McpServer *s) {
   bufch_clean(&s->in_bc);
   bufch_clean(&s->brok_bc);
   bufch_clean(&s->out_bc);
+  s->in_fd = -1;
+  s->out_fd = -1;
+  s->brok_fd = -1;
   restok_clean(&s->restok);
+  jstokws_clean(&s->tok_ws);
   s->privd = NULL;
   s->flags = 0;
   s->last_err[0] = '\0';
@@ -2,16 +2,16 @@
 #define MCP_SERVER_H
 
 #include <stdint.h>
-#include <stdio.h>
 
 #include "bufio.h"
+#include "json_codec.h"
 #include "private_dir.h"
 #include "resume_token.h"
 #include "utils.h"
 
 typedef struct McpServerInit {
-  FILE *in;             /* borrowed by McpServer */
-  FILE *out;            /* borrowed by McpServer */
+  int in_fd;            /* borrowed by McpServer; not closed */
+  int out_fd;           /* borrowed by McpServer; not closed */
   const PrivDir *privd; /* borrowed */
 } McpServerInit;
 
@@ -19,9 +19,21 @@ typedef struct McpServer {
   BufChannel in_bc;   // owned wrapper; underlying stdin fd is borrowed
   BufChannel brok_bc; // owned wrapper around broker socket
   BufChannel out_bc;  // owned wrapper; underlying stdout fd is borrowed
+  int in_fd;          // borrowed stdin fd, polled for request readiness
+  int out_fd;         // borrowed stdout fd, splice target for chunked replies
+  int brok_fd; // broker socket fd (owned by brok_bc); -1 when disconnected
   const PrivDir *privd; /* borrowed runtime paths for lazy broker reconnect */
   ResumeTokenStore restok; /* owned process-scoped resume token store */
-  uint32_t flags;          /* runtime state bits (MCPSER_F_*) */
+  JsonTokWs tok_ws; /* owned reusable jsmn workspace for request parsing */
+  uint32_t flags;   /* runtime state bits (MCPSER_F_*) */
+  // Chunked broker reply being relayed to the host: payload bytes still owed
+  // after the Content-Length header went out. Meaningless unless active.
+  uint32_t chunk_left;
+  // Bytes of the current payload chunk still owed raw to the host: the frame
+  // header is already consumed, so these relay without reassembling the frame.
+  uint32_t chunk_raw_left;
+  uint8_t chunk_active; // 1 while a chunked reply relay is in progress
+  uint8_t out_is_pipe;  // 1 when stdout is a pipe, enabling the splice relay
   char last_err[256]; // last fatal error (best-effort)
 } McpServer;
 
@@ -29,9 +41,10 @@ enum {
   MCPSER_F_BROKER_READY = 1u << 0,
 };
 
-/* Initializes the McpServer from 'init'. The McpServer borrows FILE handles
- * and does not close them. Broker connectivity is best-effort at init and is
- * retried lazily during request handling.
+/* Initializes the McpServer from 'init'. The McpServer borrows the raw file
+ * descriptors and does not close them; it never layers FILE* buffering under
+ * its own BufChannel buffering. Broker connectivity is best-effort at init
+ * and is retried lazily during request handling.
  * Returns OK/ERR. */
 AdbxStatus mcpser_init(McpServer *s, const McpServerInit *init);
 
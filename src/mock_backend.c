@@ -0,0 +1,221 @@
+#include "mock_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "query_result.h"
+#include "utils.h"
+
+#define MOCK_CELL_MAX 256u
+
+static const MockBackendConfig MOCK_DEFAULT_CONFIG = {
+    .min_latency_us = 0,
+    .max_latency_us = 0,
+    .ncols = 4,
+    .nrows = 10,
+    .cell_len = 16,
+};
+
+static MockBackendConfig mock_config = {
+    .min_latency_us = 0,
+    .max_latency_us = 0,
+    .ncols = 4,
+    .nrows = 10,
+    .cell_len = 16,
+};
+
+typedef struct MockDbImpl {
+  MockBackendConfig cfg;  // snapshot taken at create time
+  DbBackend *parser;      // owned delegate for make_query_ir/safe_functions
+  unsigned int rand_seed; // per-backend stream so threads don't share state
+  int connected;
+  const char *last_error;
+} MockDbImpl;
+
+void mock_backend_configure(const MockBackendConfig *cfg) {
+  mock_config = cfg ? *cfg : MOCK_DEFAULT_CONFIG;
+}
+
+/* Draws one synthetic latency in microseconds from this backend's config. */
+static uint32_t mock_draw_latency_us(MockDbImpl *impl) {
+  uint32_t lo = impl->cfg.min_latency_us;
+  uint32_t hi = impl->cfg.max_latency_us;
+  if (hi < lo)
+    hi = lo;
+  if (hi == 0)
+    return 0;
+  if (hi == lo)
+    return lo;
+  return lo + (uint32_t)(rand_r(&impl->rand_seed) % (hi - lo + 1u));
+}
+
+static void mock_sleep_us(uint32_t us) {
+  if (us == 0)
+    return;
+  struct timespec ts = {.tv_sec = us / 1000000u,
+                        .tv_nsec = (long)(us % 1000000u) * 1000L};
+  nanosleep(&ts, NULL);
+}
+
+static AdbxStatus mock_connect(DbBackend *db, const ConnProfile *profile,
+                               const SafetyPolicy *policy, const char *pwd) {
+  (void)policy;
+  (void)pwd;
+  if (!db || !db->impl || !profile)
+    return ERR;
+  ((MockDbImpl *)db->impl)->connected = 1;
+  return OK;
+}
+
+static AdbxTriStatus mock_is_connected(DbBackend *db) {
+  if (!db || !db->impl)
+    return ERR;
+  return ((MockDbImpl *)db->impl)->connected ? YES : NO;
+}
+
+static void mock_disconnect(DbBackend *db) {
+  if (db && db->impl)
+    ((MockDbImpl *)db->impl)->connected = 0;
+}
+
+static void mock_destroy(DbBackend *db) {
+  if (!db)
+    return;
+  MockDbImpl *impl = (MockDbImpl *)db->impl;
+  if (impl) {
+    if (impl->parser)
+      impl->parser->vt->destroy(impl->parser);
+    free(impl);
+  }
+  free(db);
+}
+
+/* Materializes one result of the configured shape with deterministic text
+ * cells. Returns NULL on allocation/build failure. */
+static QueryResult *mock_build_result(const MockBackendConfig *cfg,
+                                      uint32_t arena_size_hint) {
+  QueryResult *qr =
+      qr_create_ok_sized(NULL, cfg->ncols, cfg->nrows, 0, 0, arena_size_hint);
+  if (!qr)
+    return NULL;
+  QueryResultBuilder qb = {0};
+  if (qb_init(&qb, qr, NULL) != OK) {
+    qr_destroy(qr);
+    return NULL;
+  }
+
+  char cell[MOCK_CELL_MAX];
+  uint32_t cell_len = cfg->cell_len;
+  if (cell_len >= sizeof(cell))
+    cell_len = sizeof(cell) - 1u;
+  for (uint32_t i = 0; i < cell_len; i++)
+    cell[i] = (char)('a' + (i % 26u));
+  cell[cell_len] = '\0';
+
+  for (uint32_t c = 0; c < cfg->ncols; c++) {
+    char name[32];
+    snprintf(name, sizeof(name), "col%u", c);
+    if (qb_set_col(&qb, c, name, "text", 0) != OK) {
+      qr_destroy(qr);
+      return NULL;
+    }
+  }
+  for (uint32_t r = 0; r < cfg->nrows; r++) {
+    for (uint32_t c = 0; c < cfg->ncols; c++) {
+      if (qb_set_cell(&qb, r, c, cell, cell_len) != YES) {
+        qr_destroy(qr);
+        return NULL;
+      }
+    }
+  }
+  return qr;
+}
+
+static AdbxStatus mock_exec(DbBackend *db, const char *sql,
+                            const QueryResultBuildPolicy *qb_policy,
+                            QueryResult **out_qr) {
+  (void)sql;
+  if (!db || !db->impl || !out_qr)
+    return ERR;
+  MockDbImpl *impl = (MockDbImpl *)db->impl;
+
+  mock_sleep_us(mock_draw_latency_us(impl));
+
+  // Synthetic cells carry nothing sensitive to tokenize; only the arena
+  // pre-size hint of the build policy is honored.
+  *out_qr = mock_build_result(&impl->cfg,
+                              qb_policy ? qb_policy->arena_size_hint : 0);
+  if (!*out_qr) {
+    impl->last_error = "mock backend: result allocation failed";
+    return ERR;
+  }
+  return OK;
+}
+
+static AdbxStatus mock_exec_bound(DbBackend *db, const char *sql,
+                                  const DbExecParam *params, uint32_t nparams,
+                                  const QueryResultBuildPolicy *qb_policy,
+                                  QueryResult **out_qr) {
+  (void)params;
+  (void)nparams;
+  return mock_exec(db, sql, qb_policy, out_qr);
+}
+
+static AdbxStatus mock_make_query_ir(DbBackend *db, const char *sql,
+                                     QirQueryHandle *out) {
+  if (!db || !db->impl)
+    return ERR;
+  MockDbImpl *impl = (MockDbImpl *)db->impl;
+  if (!impl->parser) {
+    impl->last_error = "mock backend: no parser delegate";
+    return ERR;
+  }
+  return impl->parser->vt->make_query_ir(impl->parser, sql, out);
+}
+
+static const DbSafeFuncList *mock_safe_functions(DbBackend *db) {
+  static const DbSafeFuncList empty = {0};
+  if (!db || !db->impl)
+    return &empty;
+  MockDbImpl *impl = (MockDbImpl *)db->impl;
+  if (!impl->parser)
+    return &empty;
+  return impl->parser->vt->safe_functions(impl->parser);
+}
+
+static const char *mock_last_error(DbBackend *db) {
+  if (!db || !db->impl)
+    return NULL;
+  return ((MockDbImpl *)db->impl)->last_error;
+}
+
+static const DbBackendVTable MOCK_VT = {
+    .connect = mock_connect,
+    .is_connected = mock_is_connected,
+    .disconnect = mock_disconnect,
+    .destroy = mock_destroy,
+    .exec = mock_exec,
+    .exec_bound = mock_exec_bound,
+    .make_query_ir = mock_make_query_ir,
+    .safe_functions = mock_safe_functions,
+    .last_error = mock_last_error,
+};
+
+DbBackend *mock_backend_create(DbKind kind) {
+  DbBackend *db = (DbBackend *)xmalloc(sizeof(*db));
+  MockDbImpl *impl = (MockDbImpl *)xcalloc(1, sizeof(*impl));
+  impl->cfg = mock_config;
+  // The delegate stays unconnected: pg_make_query_ir and safe-function
+  // lookup are local (libpg_query), so no server is contacted.
+  impl->parser = db_backend_create(kind);
+  impl->rand_seed = (unsigned int)(uintptr_t)impl ^ 0x9e3779b9u;
+  db->vt = &MOCK_VT;
+  db->impl = impl;
+  if (!impl->parser) {
+    mock_destroy(db);
+    return NULL;
+  }
+  return db;
+}
@@ -0,0 +1,47 @@
+#ifndef MOCK_BACKEND_H
+#define MOCK_BACKEND_H
+
+#include <stdint.h>
+
+#include "db_backend.h"
+
+/* Synthetic-load DbBackend for benchmarks and concurrency testing.
+ *
+ * Parsing and safe-function lookup delegate to a real (unconnected) postgres
+ * backend, so queries go through the same libpg_query IR and validator as
+ * production; only execution is synthetic: exec/exec_bound sleep a
+ * configurable latency and materialize a result of configurable shape. This
+ * lets bench_replay and worker-pool experiments stress scheduling, arenas,
+ * and serialization at high request rates without a database in the loop.
+ */
+
+typedef struct MockBackendConfig {
+  // Per-exec latency drawn uniformly from [min, max] microseconds; both zero
+  // means no artificial delay, equal values mean a fixed delay.
+  uint32_t min_latency_us;
+  uint32_t max_latency_us;
+  // Shape of the materialized result (all text cells).
+  uint32_t ncols;
+  uint32_t nrows;
+  uint32_t cell_len;
+} MockBackendConfig;
+
+/* Replaces the process-wide config used by backends created afterwards.
+ * Passing NULL restores the defaults (no latency, 4x10 result, 16-byte
+ * cells). Existing backends keep the config they were created with.
+ * Ownership: 'cfg' is borrowed and copied.
+ * Side effects: mutates process-wide state; not thread-safe against
+ * concurrent mock_backend_create() calls.
+ * Error semantics: none.
+ */
+void mock_backend_configure(const MockBackendConfig *cfg);
+
+/* Creates one mock backend; matches the connm_create_with_factory() factory
+ * signature. 'kind' selects the delegate parser backend (v1: postgres).
+ * Ownership: caller owns the returned backend and must destroy it via vt.
+ * Side effects: allocates the backend plus its owned parser delegate.
+ * Error semantics: returns NULL on allocation failure.
+ */
+DbBackend *mock_backend_create(DbKind kind);
+
+#endif
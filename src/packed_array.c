@@ -1,20 +1,24 @@
 #include "packed_array.h"
+#include "perf_counters.h"
 #include "string_op.h"
 #include "utils.h"
 
 #include <stdalign.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 struct PackedArray {
-  unsigned char *buf; /* raw storage */
-  uint32_t len;       /* live objects */
-  size_t cap;         /* capacity in objects */
-  size_t obj_sz;      /* requested object size */
-  size_t stride;      /* padded size per slot */
-  size_t alignment;   /* slot alignment */
-  size_t max_bytes;   /* hard cap on buffer size in bytes */
+  unsigned char *buf;  /* raw storage */
+  unsigned char *keys; /* dense key column, NULL when key_sz == 0 */
+  uint32_t len;        /* live objects */
+  size_t cap;          /* capacity in objects */
+  size_t obj_sz;       /* requested object size */
+  size_t stride;       /* padded size per slot */
+  size_t alignment;    /* slot alignment */
+  size_t key_sz;       /* bytes per key column entry */
+  size_t max_bytes;    /* hard cap on buffer size in bytes */
 
   parr_cleanup_fn cleanup;
   void *cleanup_ctx;
@@ -46,6 +50,19 @@ static inline const void *slot_cptr(const PackedArray *a, uint32_t idx) {
   return (const void *)(a->buf + (idx * a->stride));
 }
 
+/* Allocates 'bytes' at 'alignment' in the xmalloc "succeed or die" style.
+ * posix_memalign is used because realloc cannot preserve over-aligned
+ * addresses; callers copy live bytes and free the old buffer themselves.
+ */
+static void *parr_alloc_aligned(size_t alignment, size_t bytes) {
+  void *p = NULL;
+  if (posix_memalign(&p, alignment, bytes) != 0) {
+    fprintf(stderr, "parr_alloc_aligned. virtual memory exhausted\n");
+    abort();
+  }
+  return p;
+}
+
 /* Ensures capacity for at least 'min_cap' objects.
  * It borrows 'a' and may replace its owned buffer.
  * Side effects: may grow internal storage and update cap.
@@ -73,8 +90,26 @@ static AdbxStatus ensure_cap(PackedArray *a, size_t min_cap) {
     new_cap = min_cap;
   size_t new_bytes = new_cap * a->stride;
 
-  unsigned char *p = (unsigned char *)xrealloc(a->buf, new_bytes);
-  a->buf = p;
+  if (a->alignment > alignof(max_align_t)) {
+    /* realloc cannot keep an over-aligned address; move the live prefix. */
+    unsigned char *p =
+        (unsigned char *)parr_alloc_aligned(a->alignment, new_bytes);
+    if (a->buf) {
+      memcpy(p, a->buf, (size_t)a->len * a->stride);
+      free(a->buf);
+    }
+    a->buf = p;
+  } else {
+    a->buf = (unsigned char *)xrealloc(a->buf, new_bytes);
+  }
+
+  if (a->key_sz > 0) {
+    if (new_cap > SIZE_MAX / a->key_sz)
+      return ERR;
+    a->keys = (unsigned char *)xrealloc(a->keys, new_cap * a->key_sz);
+  }
+
+  PERF_COUNT_N(PERF_PARR_GROW_BYTES, (new_cap - a->cap) * a->stride);
   a->cap = new_cap;
   return OK;
 }
@@ -103,25 +138,33 @@ static inline AdbxTriStatus parr_idx_in_range(const PackedArray *a,
   return (idx < a->len) ? YES : NO;
 }
 
-static AdbxStatus parr_init(PackedArray *a, size_t obj_sz,
-                            size_t upper_bound) {
+static AdbxStatus parr_init(PackedArray *a, size_t obj_sz, size_t alignment,
+                            size_t key_sz, size_t upper_bound) {
   if (!a || obj_sz == 0 || upper_bound == 0)
     return ERR;
 
+  if (alignment == 0) {
+    /* A pragmatic default: support storing any normal C object safely. */
+    alignment = alignof(max_align_t);
+  }
+  if ((alignment & (alignment - 1)) != 0)
+    return ERR;
+
   a->len = 0;
   a->cap = 0;
   a->obj_sz = obj_sz;
   a->max_bytes = upper_bound;
 
-  /* A pragmatic default: support storing any normal C object safely. */
-  a->alignment = alignof(max_align_t);
+  a->alignment = alignment;
   a->stride = round_up(obj_sz, a->alignment);
   if (a->stride == 0)
     return ERR;
+  a->key_sz = key_sz;
 
   a->cleanup = NULL;
   a->cleanup_ctx = NULL;
   a->buf = NULL;
+  a->keys = NULL;
 
   size_t max_cap = a->max_bytes / a->stride;
   size_t init_cap = (max_cap < 16) ? max_cap : 16;
@@ -135,11 +178,16 @@ PackedArray *parr_create(size_t obj_sz) {
 }
 
 PackedArray *parr_create_upper_bound(size_t obj_sz, size_t upper_bound) {
+  return parr_create_custom(obj_sz, 0, 0, upper_bound);
+}
+
+PackedArray *parr_create_custom(size_t obj_sz, size_t alignment, size_t key_sz,
+                                size_t upper_bound) {
   if (obj_sz == 0)
     return NULL;
 
   PackedArray *a = xmalloc(sizeof(*a));
-  if (parr_init(a, obj_sz, upper_bound) != OK) {
+  if (parr_init(a, obj_sz, alignment, key_sz, upper_bound) != OK) {
     free(a);
     return NULL;
   }
@@ -176,6 +224,32 @@ const void *parr_cat(const PackedArray *a, uint32_t idx) {
   return slot_cptr(a, idx);
 }
 
+void *parr_key_at(PackedArray *a, uint32_t idx) {
+  if (!parr_is_usable(a) || a->key_sz == 0 || !a->keys)
+    return NULL;
+  if (!parr_idx_in_range(a, idx))
+    return NULL;
+  return (void *)(a->keys + (idx * a->key_sz));
+}
+
+const void *parr_key_cat(const PackedArray *a, uint32_t idx) {
+  if (!parr_is_usable(a) || a->key_sz == 0 || !a->keys)
+    return NULL;
+  if (!parr_idx_in_range(a, idx))
+    return NULL;
+  return (const void *)(a->keys + (idx * a->key_sz));
+}
+
+AdbxStatus parr_reserve(PackedArray *a, size_t n_more) {
+  if (!parr_is_usable(a))
+    return ERR;
+  if (n_more == 0)
+    return OK;
+  if ((size_t)a->len > SIZE_MAX - n_more)
+    return ERR;
+  return ensure_cap(a, (size_t)a->len + n_more);
+}
+
 uint32_t parr_emplace(PackedArray *a, void **out_ptr) {
   if (out_ptr)
     *out_ptr = NULL;
@@ -213,11 +287,30 @@ void parr_drop_swap(PackedArray *a, uint32_t idx) {
     void *last = slot_ptr(a, last_idx);
     /* Copy only obj_sz bytes; padding is irrelevant. */
     memcpy(victim, last, a->obj_sz);
+    if (a->keys && a->key_sz > 0) {
+      /* Keep the key column in lockstep with the objects. */
+      memcpy(a->keys + (idx * a->key_sz), a->keys + (last_idx * a->key_sz),
+             a->key_sz);
+    }
   }
 
   a->len--;
 }
 
+void parr_reset(PackedArray *a) {
+  if (!a)
+    return;
+
+  if (a->cleanup) {
+    for (size_t i = 0; i < a->len; ++i) {
+      void *obj = slot_ptr(a, i);
+      a->cleanup(obj, a->cleanup_ctx);
+    }
+  }
+
+  a->len = 0;
+}
+
 void parr_destroy(PackedArray *a) {
   if (!a)
     return;
@@ -230,5 +323,6 @@ void parr_destroy(PackedArray *a) {
   }
 
   free(a->buf);
+  free(a->keys);
   free(a);
 }
@@ -5,6 +5,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "utils.h"
+
 /* A swap-remove packed array. This module is responsible for the ownership of
  * the objects it contains.
  *
@@ -23,6 +25,10 @@ typedef struct PackedArray PackedArray;
  */
 typedef void (*parr_cleanup_fn)(void *obj, void *cleanup_ctx);
 
+/* Slot alignment for arrays scanned on the hot path: one object never
+ * straddles two cache lines (assuming the usual 64-byte line). */
+#define PARR_CACHELINE_BYTES 64u
+
 /* Creates a packed array for objects of fixed size obj_sz bytes.
  * New objects returned by parr_emplace() are uninitialized.
  *
@@ -38,6 +44,34 @@ PackedArray *parr_create(size_t obj_sz);
  */
 PackedArray *parr_create_upper_bound(size_t obj_sz, size_t upper_bound);
 
+/* Creates a packed array with explicit slot alignment and an optional dense
+ * key column.
+ *
+ * 'alignment' must be a power of two (0 means the max_align_t default).
+ * Pass PARR_CACHELINE_BYTES for arrays whose objects are scanned linearly.
+ *
+ * When key_sz > 0 the array keeps a second, densely packed column of key_sz
+ * bytes per object alongside the main storage. Scans that only test one small
+ * field (a token, a timestamp) can walk the key column via parr_key_cat()
+ * without pulling whole objects through the cache. The column moves in
+ * lockstep with the objects: parr_drop_swap() swaps both, and key bytes
+ * start uninitialized just like object bytes — the caller owns writing them
+ * via parr_key_at() after parr_emplace().
+ *
+ * Ownership: returned array (owned by caller) owns both columns.
+ * Error semantics: returns NULL on invalid sizes or non-power-of-two
+ * alignment.
+ */
+PackedArray *parr_create_custom(size_t obj_sz, size_t alignment, size_t key_sz,
+                                size_t upper_bound);
+
+/* Empties the array for reuse while keeping its storage warm: capacity and
+ * key storage stay allocated so a refill skips the growth ladder.
+ * If a cleanup callback was set, it is called for every live object first.
+ * No-op on NULL.
+ */
+void parr_reset(PackedArray *a);
+
 /* Destroyes the array and free its storage.
  * If a cleanup callback was set, it is called for every live object first.
  */
@@ -67,6 +101,23 @@ void *parr_at(PackedArray *a, uint32_t idx);
 /* Const version of parr_at(). */
 const void *parr_cat(const PackedArray *a, uint32_t idx);
 
+/* Returns a pointer to the key bytes of the object at idx (mutable).
+ * Returns NULL when the array has no key column or idx is out of range.
+ * Same stability rules as parr_at(): invalidated by growth and drop-swap.
+ */
+void *parr_key_at(PackedArray *a, uint32_t idx);
+
+/* Const version of parr_key_at(). */
+const void *parr_key_cat(const PackedArray *a, uint32_t idx);
+
+/* Ensures capacity for 'n_more' appends beyond the current length, so the
+ * parr_emplace() calls that follow never grow the buffer (and never move
+ * borrowed pointers) until the reservation is consumed.
+ * Returns OK on success, ERR on invalid input, overflow, or when the
+ * reservation would exceed the configured upper bound.
+ */
+AdbxStatus parr_reserve(PackedArray *a, size_t n_more);
+
 /* Allocates a new object slot at the end and return:
  * - the new object's index, and
  * - (optionally) a pointer to its storage via out_ptr.
@@ -0,0 +1,73 @@
+#include "perf_counters.h"
+
+#ifdef ADBX_PERF_COUNTERS
+
+#include <stdatomic.h>
+
+// Upper bound of threads that get their own padded slot; the broker runs a
+// handful of workers, so overflow threads sharing the last slot only costs
+// them cacheline contention, never lost counts.
+#define PERF_MAX_THREADS 64u
+
+/* One thread's counters, padded to cacheline granularity so neighbouring
+ * slots never false-share. Reads from the aggregating thread use the same
+ * relaxed atomics the owner writes with. */
+typedef struct PerfSlot {
+  _Alignas(64) _Atomic uint64_t v[PERF_COUNTER_N];
+} PerfSlot;
+
+static PerfSlot perf_slots[PERF_MAX_THREADS];
+static _Atomic uint32_t perf_slots_claimed;
+static _Thread_local int32_t perf_my_slot = -1;
+
+static const char *const PERF_NAMES[PERF_COUNTER_N] = {
+    [PERF_PLAN_CACHE_HIT] = "plan_cache_hit",
+    [PERF_PLAN_CACHE_MISS] = "plan_cache_miss",
+    [PERF_RESULT_CACHE_HIT] = "result_cache_hit",
+    [PERF_RESULT_CACHE_MISS] = "result_cache_miss",
+    [PERF_SCHEMA_CACHE_HIT] = "schema_cache_hit",
+    [PERF_SCHEMA_CACHE_MISS] = "schema_cache_miss",
+    [PERF_TOKENS_MINTED] = "tokens_minted",
+    [PERF_TOKENS_REUSED] = "tokens_reused",
+    [PERF_ARENA_BYTES] = "arena_bytes",
+    [PERF_SB_GROW_BYTES] = "sb_grow_bytes",
+    [PERF_PARR_GROW_BYTES] = "parr_grow_bytes",
+    [PERF_JSON_ALLOC_BYTES] = "json_alloc_bytes",
+    [PERF_FRAMES_RELAYED] = "frames_relayed",
+    [PERF_BROKER_RECONNECTS] = "broker_reconnects",
+};
+
+void perf_count(PerfCounterId id, uint64_t n) {
+  if ((uint32_t)id >= PERF_COUNTER_N)
+    return;
+  if (perf_my_slot < 0) {
+    uint32_t claimed =
+        atomic_fetch_add_explicit(&perf_slots_claimed, 1, memory_order_relaxed);
+    perf_my_slot = (claimed < PERF_MAX_THREADS)
+                       ? (int32_t)claimed
+                       : (int32_t)(PERF_MAX_THREADS - 1u);
+  }
+  atomic_fetch_add_explicit(&perf_slots[perf_my_slot].v[id], n,
+                            memory_order_relaxed);
+}
+
+uint64_t perf_total(PerfCounterId id) {
+  if ((uint32_t)id >= PERF_COUNTER_N)
+    return 0;
+  uint32_t claimed =
+      atomic_load_explicit(&perf_slots_claimed, memory_order_relaxed);
+  if (claimed > PERF_MAX_THREADS)
+    claimed = PERF_MAX_THREADS;
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < claimed; i++)
+    sum += atomic_load_explicit(&perf_slots[i].v[id], memory_order_relaxed);
+  return sum;
+}
+
+const char *perf_counter_name(PerfCounterId id) {
+  if ((uint32_t)id >= PERF_COUNTER_N || !PERF_NAMES[id])
+    return "?";
+  return PERF_NAMES[id];
+}
+
+#endif // ADBX_PERF_COUNTERS
@@ -0,0 +1,56 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/* Broker-wide performance counters: hot paths bump one per-thread padded
+ * slot (one relaxed atomic add, no shared cacheline), and readers aggregate
+ * every slot on demand. The whole subsystem compiles to nothing unless the
+ * build sets ADBX_PERF_COUNTERS (Makefile switch, default on; pass
+ * ADBX_PERF_COUNTERS=0 for minimal builds), so instrumented call sites use
+ * the PERF_COUNT macros and pay zero cost when it is off. */
+
+typedef enum PerfCounterId {
+  PERF_PLAN_CACHE_HIT = 0,
+  PERF_PLAN_CACHE_MISS,
+  PERF_RESULT_CACHE_HIT,
+  PERF_RESULT_CACHE_MISS,
+  PERF_SCHEMA_CACHE_HIT,
+  PERF_SCHEMA_CACHE_MISS,
+  PERF_TOKENS_MINTED,
+  PERF_TOKENS_REUSED, // deterministic dedupe hits returning an existing token
+  PERF_ARENA_BYTES, // bytes reserved from arenas, not call counts
+  PERF_SB_GROW_BYTES,    // StrBuf heap capacity added by growth/spill
+  PERF_PARR_GROW_BYTES,  // PackedArray buffer bytes added by growth
+  PERF_JSON_ALLOC_BYTES, // bytes malloc'd for serialized JSON-RPC replies
+  PERF_FRAMES_RELAYED,
+  PERF_BROKER_RECONNECTS,
+  PERF_COUNTER_N
+} PerfCounterId;
+
+#ifdef ADBX_PERF_COUNTERS
+
+/* Adds 'n' to counter 'id' on the calling thread's slot.
+ * Side effects: first call on a thread claims one slot for its lifetime.
+ * Error semantics: none; out-of-range ids are ignored. */
+void perf_count(PerfCounterId id, uint64_t n);
+
+/* Returns the sum of counter 'id' across every thread slot (0 for
+ * out-of-range ids). Totals are monotonic but individually relaxed, so one
+ * read is not an atomic snapshot across counters. */
+uint64_t perf_total(PerfCounterId id);
+
+/* Returns the stable short name of 'id' ("?" for out-of-range ids). */
+const char *perf_counter_name(PerfCounterId id);
+
+#define PERF_COUNT(id) perf_count((id), 1)
+#define PERF_COUNT_N(id, n) perf_count((id), (n))
+
+#else
+
+#define PERF_COUNT(id) ((void)0)
+#define PERF_COUNT_N(id, n) ((void)0)
+
+#endif // ADBX_PERF_COUNTERS
+
+#endif
@@ -0,0 +1,180 @@
+#include "plan_cache.h"
+#include "perf_counters.h"
+#include "hash_table.h"
+#include "string_op.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct PlanCacheEntry {
+  char *key;      // owned blob: conn_name \0 sql \0 (param col_ref \0)*
+  size_t key_len; // blob length in bytes
+  uint64_t hash;  // ht_hash_bytes(key, key_len)
+  ValidateQueryOut vout; // owned deep copy of one validated plan
+  uint64_t last_used;    // LRU tick; 0 = slot empty
+} PlanCacheEntry;
+
+struct PlanCache {
+  PlanCacheEntry *entries; // owned array of 'capacity' slots
+  uint32_t capacity;
+  uint64_t tick; // monotonically increasing use counter
+};
+
+/* Builds the exact-match lookup key into 'kb' (conn name, SQL text, and one
+ * col_ref per bound parameter, each NUL-separated). Plans depend on the param
+ * scopes but not on the param values, so values stay out of the key.
+ * It borrows all inputs and appends to 'kb' (caller initializes/cleans it).
+ * Error semantics: returns OK on success, ERR on invalid input or allocation
+ * failure.
+ */
+static AdbxStatus plan_cache_build_key(StrBuf *kb, const char *conn_name,
+                                       const char *sql,
+                                       const SensitiveTok *params,
+                                       uint32_t nparams) {
+  if (!kb || !conn_name || !sql || (nparams > 0 && !params))
+    return ERR;
+
+  if (sb_append_bytes(kb, conn_name, strlen(conn_name) + 1) != OK)
+    return ERR;
+  if (sb_append_bytes(kb, sql, strlen(sql) + 1) != OK)
+    return ERR;
+  for (uint32_t i = 0; i < nparams; i++) {
+    if (params[i].col_ref_len > 0 &&
+        sb_append_bytes(kb, params[i].col_ref, params[i].col_ref_len) != OK)
+      return ERR;
+    if (sb_append_bytes(kb, "", 1) != OK)
+      return ERR;
+  }
+  return OK;
+}
+
+/* Releases everything one slot owns and marks it empty. */
+static void plan_cache_entry_clear(PlanCacheEntry *e) {
+  free(e->key);
+  e->key = NULL;
+  e->key_len = 0;
+  e->hash = 0;
+  vq_out_clean(&e->vout);
+  e->last_used = 0;
+}
+
+/* Returns the slot matching (hash, key blob) or NULL. Verifies the full key
+ * bytes so hash collisions can never hand out a foreign plan. */
+static PlanCacheEntry *plan_cache_find(PlanCache *pc, uint64_t hash,
+                                       const char *key, size_t key_len) {
+  for (uint32_t i = 0; i < pc->capacity; i++) {
+    PlanCacheEntry *e = &pc->entries[i];
+    if (e->last_used == 0 || e->hash != hash || e->key_len != key_len)
+      continue;
+    if (memcmp(e->key, key, key_len) == 0)
+      return e;
+  }
+  return NULL;
+}
+
+PlanCache *plan_cache_create(uint32_t capacity) {
+  if (capacity == 0)
+    capacity = PLAN_CACHE_CAPACITY;
+
+  PlanCache *pc = (PlanCache *)xcalloc(1, sizeof(*pc));
+  pc->entries =
+      (PlanCacheEntry *)xcalloc(capacity, sizeof(*pc->entries));
+  pc->capacity = capacity;
+  return pc;
+}
+
+void plan_cache_destroy(PlanCache *pc) {
+  if (!pc)
+    return;
+  for (uint32_t i = 0; i < pc->capacity; i++) {
+    if (pc->entries[i].last_used != 0)
+      plan_cache_entry_clear(&pc->entries[i]);
+  }
+  free(pc->entries);
+  free(pc);
+}
+
+AdbxTriStatus plan_cache_get(PlanCache *pc, const char *conn_name,
+                             const char *sql, const SensitiveTok *params,
+                             uint32_t nparams, ValidateQueryOut *out) {
+  if (!pc || !conn_name || !sql || !out || !out->plan.cols)
+    return TRI_STATUS_ERR;
+
+  StrBuf kb;
+  sb_init(&kb);
+  if (plan_cache_build_key(&kb, conn_name, sql, params, nparams) != OK) {
+    sb_clean(&kb);
+    return TRI_STATUS_ERR;
+  }
+
+  uint64_t hash = ht_hash_bytes(kb.data, kb.len);
+  PlanCacheEntry *e = plan_cache_find(pc, hash, kb.data, kb.len);
+  sb_clean(&kb);
+  if (!e) {
+    PERF_COUNT(PERF_PLAN_CACHE_MISS);
+    return NO;
+  }
+
+  if (vq_out_copy_plan(out, &e->vout) != OK)
+    return TRI_STATUS_ERR;
+  e->last_used = ++pc->tick;
+  PERF_COUNT(PERF_PLAN_CACHE_HIT);
+  return YES;
+}
+
+void plan_cache_put(PlanCache *pc, const char *conn_name, const char *sql,
+                    const SensitiveTok *params, uint32_t nparams,
+                    const ValidateQueryOut *vout) {
+  if (!pc || !conn_name || !sql || !vout || !vout->plan.cols)
+    return;
+  if (vout->err.code != VERR_NONE)
+    return;
+
+  StrBuf kb;
+  sb_init(&kb);
+  if (plan_cache_build_key(&kb, conn_name, sql, params, nparams) != OK) {
+    sb_clean(&kb);
+    return;
+  }
+
+  uint64_t hash = ht_hash_bytes(kb.data, kb.len);
+  PlanCacheEntry *e = plan_cache_find(pc, hash, kb.data, kb.len);
+  if (e) {
+    // Already retained (e.g. two sessions raced through the same miss);
+    // refresh recency and keep the existing copy.
+    sb_clean(&kb);
+    e->last_used = ++pc->tick;
+    return;
+  }
+
+  // Pick an empty slot, or evict the least recently used plan.
+  PlanCacheEntry *victim = &pc->entries[0];
+  for (uint32_t i = 0; i < pc->capacity; i++) {
+    PlanCacheEntry *cand = &pc->entries[i];
+    if (cand->last_used == 0) {
+      victim = cand;
+      break;
+    }
+    if (cand->last_used < victim->last_used)
+      victim = cand;
+  }
+  if (victim->last_used != 0)
+    plan_cache_entry_clear(victim);
+
+  if (vq_out_init(&victim->vout) != OK) {
+    sb_clean(&kb);
+    return;
+  }
+  if (vq_out_copy_plan(&victim->vout, vout) != OK) {
+    vq_out_clean(&victim->vout);
+    sb_clean(&kb);
+    return;
+  }
+
+  victim->key = (char *)xmalloc(kb.len);
+  memcpy(victim->key, kb.data, kb.len);
+  victim->key_len = kb.len;
+  victim->hash = hash;
+  victim->last_used = ++pc->tick;
+  sb_clean(&kb);
+}
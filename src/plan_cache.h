@@ -0,0 +1,49 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <stdint.h>
+
+#include "sensitive_tok.h"
+#include "utils.h"
+#include "validator.h"
+
+// Fixed number of retained validation plans; oldest entry is evicted (LRU)
+// once the cache is full.
+#define PLAN_CACHE_CAPACITY 128u
+
+/* Caches successful validate_query() outputs keyed by connection name, SQL
+ * text, and the column scopes of any bound token parameters. Hits hand out a
+ * deep copy of the retained plan so cached storage is never shared with
+ * in-flight jobs. Single-threaded: all calls must come from the owning event
+ * loop. */
+typedef struct PlanCache PlanCache;
+
+/* Creates a PlanCache retaining up to 'capacity' plans (0 = default).
+ * Returns NULL on allocation failure. */
+PlanCache *plan_cache_create(uint32_t capacity);
+
+/* Frees 'pc' and every retained plan. */
+void plan_cache_destroy(PlanCache *pc);
+
+/* Looks up the retained plan for (conn_name, sql, param scopes) and, on a hit,
+ * deep-copies it into 'out'.
+ * It borrows all inputs; 'out' must be initialized with vq_out_init() and its
+ * previous plan contents are replaced on a hit.
+ * Returns YES on a hit, NO on a miss, ERR on invalid input or copy failure.
+ */
+AdbxTriStatus plan_cache_get(PlanCache *pc, const char *conn_name,
+                             const char *sql, const SensitiveTok *params,
+                             uint32_t nparams, ValidateQueryOut *out);
+
+/* Retains a deep copy of the plan in 'vout' under (conn_name, sql, param
+ * scopes), evicting the least recently used entry when full.
+ * It borrows all inputs; only successfully validated outputs
+ * (err.code == VERR_NONE) should be stored.
+ * Error semantics: fail-soft; on allocation failure the plan is simply not
+ * cached and later requests validate from scratch.
+ */
+void plan_cache_put(PlanCache *pc, const char *conn_name, const char *sql,
+                    const SensitiveTok *params, uint32_t nparams,
+                    const ValidateQueryOut *vout);
+
+#endif
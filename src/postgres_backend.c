@@ -1,7 +1,10 @@
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdalign.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,24 +15,68 @@
 #include <pg_query.h>
 
 #include "conn_catalog.h"
+#include "hash_table.h"
 #include "json_codec.h"
 #include "log.h"
 #include "postgres_backend.h"
 #include "query_result.h"
+#include "rapidhash.h"
+#include "result_spill.h"
 #include "safety_policy.h"
 #include "string_op.h"
 #include "utils.h"
 
 #define PG_QUERY_MAX_BYTES 8192
 
+/* Cap on connection establishment when the profile does not set
+ * "connectTimeoutSeconds". */
+#define PG_CONNECT_TIMEOUT_DEFAULT_SECS 10u
+
+/* Per-connection prepared statements cached for bound executions. */
+#define PG_PREP_CACHE_SIZE 32u
+
 /* ------------------------------- internals ------------------------------- */
 
+/* One cached server-side prepared statement. The SQL text is kept (not just
+ * its hash) so lookups never act on a hash collision. */
+typedef struct PgPreparedStmt {
+  char *sql;         // owned copy of the statement text; NULL when unused
+  uint64_t sql_hash; // rapidhash of 'sql'
+  uint32_t nparams;
+  uint32_t param_oids[MAX_TOKEN_PARAMS];
+  uint64_t last_used; // LRU tick from PgImpl.prep_tick
+  char name[16];      // server-side statement name bound to this slot
+  uint8_t binary_ok;  // 1 when every result column is a fixed-width type we
+                      // can request in binary format and re-render ourselves
+} PgPreparedStmt;
+
+/* Direct-mapped cache of type-OID decimal renderings (QRColumn.type carries
+ * the OID as text). Sized for the few dozen distinct types a session
+ * realistically touches. */
+#define PG_OID_TEXT_CACHE_SIZE 64u
+typedef struct PgOidText {
+  uint32_t oid;  // 0 = empty slot
+  char text[12]; // decimal rendering of 'oid', NUL-terminated
+} PgOidText;
+
 typedef struct PgImpl {
   PGconn *conn;
   SafetyPolicy policy;
   uint8_t policy_applied; // 1 if the policy has already been enforced
                           // at session level, else 0
+  uint8_t next_priority;  // SafetyPriority of the next managed exec; one-shot,
+                          // reverts to NORMAL (the zero value) once consumed
   char last_err[1024];
+
+  // LRU cache of prepared statements; valid only for the current connection
+  // (server-side statements die with the session).
+  PgPreparedStmt prep_cache[PG_PREP_CACHE_SIZE];
+  uint64_t prep_tick;
+
+  // OID -> text cache for result column metadata. A rendering is pure (the
+  // decimal form of an OID never changes), so unlike the prepared-statement
+  // cache this survives reconnects and needs no invalidation.
+  PgOidText oid_text[PG_OID_TEXT_CACHE_SIZE];
 } PgImpl;
 
 // --------------------------- QueryIR helpers (Postgres) --------------------
@@ -63,13 +110,34 @@ static char *pg_arena_transfer_lower(Arena *a, char *owned) {
   return pg_arena_transfer(a, owned);
 }
 
+/* Interns an owned identifier into the query's string pool after
+ * ASCII-lowercasing it, so equal identifiers resolve to one stable pointer
+ * and downstream comparisons (alias resolution in the validator) can be done
+ * by address. Falls back to a plain arena copy when the query carries no pool.
+ * Ownership: returns a pool- (or arena-) owned string; frees the input buffer.
+ * Side effects: frees 'owned'; may allocate pool or arena memory.
+ * Returns NULL on allocation failure or if input is NULL. */
+static char *pg_intern_lower(Arena *a, QirQuery *q, char *owned) {
+  if (!q || !q->idents)
+    return pg_arena_transfer_lower(a, owned);
+  if (!owned)
+    return NULL;
+  for (char *p = owned; *p != '\0'; ++p) {
+    *p = (char)tolower((unsigned char)*p);
+  }
+  const char *interned = spool_add(q->idents, owned);
+  free(owned);
+  return (char *)interned;
+}
+
 /* Parses an alias object and returns its name or NULL if missing.
  * We accept both a direct alias object and an {"Alias":{...}} wrapper because
  * libpg_query shape varies by version.
  * Ownership: returned string is arena-owned.
  * Side effects: allocates arena memory and frees a temporary string.
  * Returns NULL if alias is absent or invalid. */
-static char *pg_parse_alias_name(const JsonGetter *alias_obj, Arena *a) {
+static char *pg_parse_alias_name(const JsonGetter *alias_obj, Arena *a,
+                                 QirQuery *q) {
   if (!alias_obj || !a)
     return NULL;
 
@@ -82,7 +150,7 @@ static char *pg_parse_alias_name(const JsonGetter *alias_obj, Arena *a) {
   char *tmp = NULL;
   if (jsget_string_decode_alloc(src, "aliasname", &tmp) != YES)
     return NULL;
-  return pg_arena_transfer_lower(a, tmp);
+  return pg_intern_lower(a, q, tmp);
 }
 
 /* Gets a decoded string from one of two candidate keys.
@@ -104,7 +172,7 @@ static AdbxTriStatus pg_get_string_field(const JsonGetter *jg, const char *k1,
  * Ownership: returned pointer is owned by the arena.
  * Side effects: allocates arena memory.
  * Returns NULL on error. */
-static inline QirQuery *pg_qir_new_query(Arena *a) {
+static inline QirQuery *pg_qir_new_query(Arena *a, StringPool *idents) {
   if (!a)
     return NULL;
   QirQuery *q = (QirQuery *)arena_calloc(a, (uint32_t)sizeof(*q));
@@ -113,6 +181,7 @@ static inline QirQuery *pg_qir_new_query(Arena *a) {
   q->status = QIR_OK;
   q->kind = QIR_STMT_SELECT;
   q->limit_value = -1;
+  q->idents = idents; // nested scopes intern through the parent's pool
   return q;
 }
 
@@ -161,7 +230,7 @@ static QirExpr *pg_parse_colref(const JsonGetter *jg, Arena *a, QirQuery *q) {
       if (pg_get_string_field(&sub, "str", "sval", &tmp) != YES)
         return NULL;
       if (nparts < 3) {
-        parts[nparts++] = pg_arena_transfer_lower(a, tmp);
+        parts[nparts++] = pg_intern_lower(a, q, tmp);
         if (!parts[nparts - 1])
           return NULL;
       } else {
@@ -239,9 +308,8 @@ static QirExpr *pg_parse_literal(const JsonGetter *jg, Arena *a, QirQuery *q) {
     char *tmp = NULL;
     if (jsget_string_decode_alloc(&fjg, "fval", &tmp) != YES)
       return NULL;
-    char *end = NULL;
-    double f64 = strtod(tmp, &end);
-    if (!end || *end != '\0') {
+    double f64 = 0;
+    if (str_span_to_f64(tmp, strlen(tmp), &f64) != OK) {
       free(tmp);
       return NULL;
     }
@@ -300,9 +368,8 @@ static QirExpr *pg_parse_literal(const JsonGetter *jg, Arena *a, QirQuery *q) {
     char *tmp = NULL;
     if (pg_get_string_field(&fjg2, "str", "sval", &tmp) != YES)
       return NULL;
-    char *end = NULL;
-    double f64 = strtod(tmp, &end);
-    if (!end || *end != '\0') {
+    double f64 = 0;
+    if (str_span_to_f64(tmp, strlen(tmp), &f64) != OK) {
       free(tmp);
       return NULL;
     }
@@ -960,14 +1027,14 @@ static QirExpr *pg_parse_func_call(const JsonGetter *jg, Arena *a,
   if (jsget_array_objects_next(jg, &it, &elem) != NO)
     goto fail;
 
-  char *fname = pg_arena_transfer_lower(a, fname_to_tr);
+  char *fname = pg_intern_lower(a, q, fname_to_tr);
   if (!fname)
     goto fail;
   fname_to_tr = NULL; // avoid double-free
 
   char *schema;
   if (schema_to_tr) {
-    schema = pg_arena_transfer_lower(a, schema_to_tr);
+    schema = pg_intern_lower(a, q, schema_to_tr);
   } else {
     schema = arena_add_nul(a, (void *)"", 0);
   }
@@ -1265,7 +1332,7 @@ static QirExpr *pg_parse_expr(const JsonGetter *jg, Arena *a, QirQuery *q) {
       qir_set_status(q, a, QIR_UNSUPPORTED, "unsupported subquery");
       return pg_qir_new_expr(a, QIR_EXPR_UNSUPPORTED);
     }
-    QirQuery *sq = pg_qir_new_query(a);
+    QirQuery *sq = pg_qir_new_query(a, q->idents);
     if (!sq)
       return NULL;
     pg_parse_select_stmt(&seljg, a, sq);
@@ -1336,7 +1403,8 @@ static QirExpr *pg_parse_expr(const JsonGetter *jg, Arena *a, QirQuery *q) {
  * Ownership: returned node is arena-owned.
  * Side effects: none.
  * Returns NULL on allocation failure. */
-static QirFromItem *pg_parse_rangevar(const JsonGetter *jg, Arena *a) {
+static QirFromItem *pg_parse_rangevar(const JsonGetter *jg, Arena *a,
+                                       QirQuery *q) {
   QirFromItem *fi = arena_calloc(a, (uint32_t)sizeof(QirFromItem));
   if (!fi)
     return NULL;
@@ -1344,12 +1412,12 @@ static QirFromItem *pg_parse_rangevar(const JsonGetter *jg, Arena *a) {
 
   char *tmp = NULL;
   if (jsget_string_decode_alloc(jg, "relname", &tmp) == YES) {
-    fi->u.rel.name.name = pg_arena_transfer_lower(a, tmp);
+    fi->u.rel.name.name = pg_intern_lower(a, q, tmp);
   }
 
   tmp = NULL;
   if (jsget_string_decode_alloc(jg, "schemaname", &tmp) == YES) {
-    fi->u.rel.schema.name = pg_arena_transfer_lower(a, tmp);
+    fi->u.rel.schema.name = pg_intern_lower(a, q, tmp);
   } else {
     fi->u.rel.schema.name = (char *)arena_add_nul(a, (void *)"", 0);
   }
@@ -1357,7 +1425,7 @@ static QirFromItem *pg_parse_rangevar(const JsonGetter *jg, Arena *a) {
   // alias
   JsonGetter ajg = {0};
   if (jsget_object(jg, "alias", &ajg) == YES) {
-    fi->alias.name = pg_parse_alias_name(&ajg, a);
+    fi->alias.name = pg_parse_alias_name(&ajg, a, q);
   }
 
   if (!fi->alias.name)
@@ -1370,7 +1438,7 @@ static QirFromItem *pg_parse_rangevar(const JsonGetter *jg, Arena *a) {
  * Side effects: allocates arena memory.
  * Returns OK/ERR. */
 static AdbxStatus pg_parse_alias_colnames(const JsonGetter *alias_obj, Arena *a,
-                                          QirIdent **out_cols,
+                                          QirQuery *q, QirIdent **out_cols,
                                           uint32_t *out_ncols) {
   if (!alias_obj || !a || !out_cols || !out_ncols)
     return ERR;
@@ -1395,7 +1463,7 @@ static AdbxStatus pg_parse_alias_colnames(const JsonGetter *alias_obj, Arena *a,
       rc = ERR;
       break;
     }
-    char *name = pg_arena_transfer_lower(a, tmp);
+    char *name = pg_intern_lower(a, q, tmp);
     if (!name) {
       rc = ERR;
       break;
@@ -1547,7 +1615,7 @@ static AdbxStatus pg_parse_join_expr(const JsonGetter *jg, Arena *a,
     return ERR;
 
   if (jsget_object(&rjg, "RangeVar", &rjg) == YES) {
-    j->rhs = pg_parse_rangevar(&rjg, a);
+    j->rhs = pg_parse_rangevar(&rjg, a, q);
     if (j->rhs)
       pg_resolve_cte_ref(q, j->rhs);
   } else if (jsget_object(&rjg, "RangeSubselect", &rjg) == YES) {
@@ -1566,7 +1634,7 @@ static AdbxStatus pg_parse_join_expr(const JsonGetter *jg, Arena *a,
           fi->alias.name = (char *)arena_add_nul(a, (void *)"", 0);
           fi->u.values.colnames = NULL;
           fi->u.values.ncolnames = 0;
-          fi->u.subquery = pg_qir_new_query(a);
+          fi->u.subquery = pg_qir_new_query(a, q->idents);
           if (jsget_exists_nonnull(&seljg, "valuesLists") == YES) {
             fi->kind = QIR_FROM_VALUES;
           } else if (fi->u.subquery) {
@@ -1574,9 +1642,9 @@ static AdbxStatus pg_parse_join_expr(const JsonGetter *jg, Arena *a,
           }
           JsonGetter ajg = {0};
           if (jsget_object(&ssjg, "alias", &ajg) == YES) {
-            fi->alias.name = pg_parse_alias_name(&ajg, a);
+            fi->alias.name = pg_parse_alias_name(&ajg, a, q);
             if (fi->kind == QIR_FROM_VALUES) {
-              if (pg_parse_alias_colnames(&ajg, a, &fi->u.values.colnames,
+              if (pg_parse_alias_colnames(&ajg, a, q, &fi->u.values.colnames,
                                           &fi->u.values.ncolnames) != OK) {
                 qir_set_status(q, a, QIR_UNSUPPORTED, "invalid VALUES alias");
               }
@@ -1622,7 +1690,7 @@ static AdbxStatus pg_parse_from_item(const JsonGetter *jg, Arena *a,
 
   JsonGetter rvjg = {0};
   if (jsget_object(jg, "RangeVar", &rvjg) == YES) {
-    QirFromItem *fi = pg_parse_rangevar(&rvjg, a);
+    QirFromItem *fi = pg_parse_rangevar(&rvjg, a, q);
     if (!fi)
       return ERR;
     pg_resolve_cte_ref(q, fi);
@@ -1655,7 +1723,7 @@ static AdbxStatus pg_parse_from_item(const JsonGetter *jg, Arena *a,
         if (jsget_exists_nonnull(&seljg, "valuesLists") == YES) {
           fi->kind = QIR_FROM_VALUES;
         } else {
-          fi->u.subquery = pg_qir_new_query(a);
+          fi->u.subquery = pg_qir_new_query(a, q->idents);
           if (fi->u.subquery)
             pg_parse_select_stmt(&seljg, a, fi->u.subquery);
         }
@@ -1666,9 +1734,9 @@ static AdbxStatus pg_parse_from_item(const JsonGetter *jg, Arena *a,
 
     JsonGetter ajg = {0};
     if (jsget_object(&ssjg, "alias", &ajg) == YES) {
-      fi->alias.name = pg_parse_alias_name(&ajg, a);
+      fi->alias.name = pg_parse_alias_name(&ajg, a, q);
       if (fi->kind == QIR_FROM_VALUES) {
-        if (pg_parse_alias_colnames(&ajg, a, &fi->u.values.colnames,
+        if (pg_parse_alias_colnames(&ajg, a, q, &fi->u.values.colnames,
                                     &fi->u.values.ncolnames) != OK) {
           qir_set_status(q, a, QIR_UNSUPPORTED, "invalid VALUES alias");
         }
@@ -1724,7 +1792,7 @@ static AdbxStatus pg_parse_select_stmt(const JsonGetter *jg, Arena *a,
 
       char *tmp = NULL;
       if (jsget_string_decode_alloc(&rjg, "name", &tmp) == YES) {
-        si->out_alias.name = pg_arena_transfer_lower(a, tmp);
+        si->out_alias.name = pg_intern_lower(a, q, tmp);
       } else {
         si->out_alias.name = (char *)arena_add_nul(a, (void *)"", 0);
       }
@@ -1741,7 +1809,9 @@ static AdbxStatus pg_parse_select_stmt(const JsonGetter *jg, Arena *a,
       }
       si->value = expr;
 
-      if (ptrvec_push(&sels, si) != OK) {
+      // Wide target lists spill into the parse arena they are flattened
+      // into, keeping SELECT parsing free of transient heap allocations.
+      if (ptrvec_push_arena(&sels, a, si) != OK) {
         rc = ERR;
         break;
       }
@@ -1884,14 +1954,14 @@ static AdbxStatus pg_parse_select_stmt(const JsonGetter *jg, Arena *a,
 
         char *tmp = NULL;
         if (jsget_string_decode_alloc(&ctejg, "ctename", &tmp) == YES) {
-          cte->name.name = pg_arena_transfer_lower(a, tmp);
+          cte->name.name = pg_intern_lower(a, q, tmp);
         }
 
         JsonGetter cqjg = {0};
         if (jsget_object(&ctejg, "ctequery", &cqjg) == YES) {
           JsonGetter seljg = {0};
           if (jsget_object(&cqjg, "SelectStmt", &seljg) == YES) {
-            cte->query = pg_qir_new_query(a);
+            cte->query = pg_qir_new_query(a, q->idents);
             if (cte->query)
               pg_parse_select_stmt(&seljg, a, cte->query);
           }
@@ -1944,6 +2014,148 @@ static AdbxStatus pg_parse_select_stmt(const JsonGetter *jg, Arena *a,
  * Side effects: allocates arena memory.
  * Returns OK on success (including parse/unsupported), ERR on allocation
  * failure. */
+/* ---------------------- early structural rejection ----------------------- */
+
+/* Join-expression nesting cap for the pre-pass walk; deeper trees simply get
+ * no early decision. */
+#define PG_PRECHECK_MAX_JOIN_DEPTH 64
+
+/* Scans the raw SelectStmt span for an "A_Star" node key (SELECT * or
+ * alias.* expansion anywhere in the statement, nested scopes included).
+ * It borrows 'seljg' and does not allocate.
+ * Side effects: none.
+ * Error semantics: returns YES when found, NO otherwise, ERR on bad input.
+ */
+static AdbxTriStatus pg_precheck_star(const JsonGetter *seljg) {
+  if (!seljg || !seljg->json || !seljg->toks || seljg->root < 0)
+    return ERR;
+  const jsmntok_t *t = &seljg->toks[seljg->root];
+  if (t->start < 0 || t->end <= t->start)
+    return ERR;
+
+  static const char key[] = "\"A_Star\":";
+  const size_t klen = sizeof(key) - 1u;
+  const char *base = seljg->json + t->start;
+  const char *end = seljg->json + t->end;
+  if ((size_t)(end - base) < klen)
+    return NO;
+
+  for (const char *p = base; p + klen <= end; p++) {
+    if (p[0] != '"' || memcmp(p, key, klen) != 0)
+      continue;
+    // Inside a string value the quote would be escaped, so a preceding
+    // backslash means literal content, not a node key.
+    if (p > base && p[-1] == '\\')
+      continue;
+    return YES;
+  }
+  return NO;
+}
+
+/* Checks one raw from-clause item (RangeVar or JoinExpr tree) for a base
+ * relation without an alias, mirroring the validator's unconditional alias
+ * requirement. 'in_join' selects the FROM vs JOIN wording of the eventual
+ * error.
+ * Ownership: borrows 'item', allocates the item description in 'a', and
+ * marks 'q' on rejection.
+ * Error semantics: returns YES when a rejection was recorded, NO when this
+ * item yields no early decision (unknown node kinds included).
+ */
+static AdbxTriStatus pg_precheck_from_item(const JsonGetter *item, Arena *a,
+                                           QirQuery *q, int in_join,
+                                           int depth) {
+  if (!item || !a || !q)
+    return NO;
+
+  JsonGetter rv = {0};
+  if (jsget_object(item, "RangeVar", &rv) == YES) {
+    JsonGetter ajg = {0};
+    if (jsget_object(&rv, "alias", &ajg) == YES)
+      return NO; // aliased (empty alias names are caught by the full path)
+
+    // Describe the relation the way qir_from_to_str() would.
+    char *tmp = NULL;
+    const char *rel = NULL;
+    const char *schema = NULL;
+    if (jsget_string_decode_alloc(&rv, "relname", &tmp) == YES)
+      rel = pg_arena_transfer_lower(a, tmp);
+    tmp = NULL;
+    if (jsget_string_decode_alloc(&rv, "schemaname", &tmp) == YES)
+      schema = pg_arena_transfer_lower(a, tmp);
+
+    const char *table = (rel && rel[0] != '\0') ? rel : "<unknown>";
+    const char *desc = table;
+    if (schema && schema[0] != '\0') {
+      size_t n = strlen(schema) + 1u + strlen(table) + 1u;
+      char *buf = arena_alloc(a, (uint32_t)n);
+      if (buf) {
+        snprintf(buf, n, "%s.%s", schema, table);
+        desc = buf;
+      }
+    }
+
+    q->early_reject = in_join ? QIR_EREJ_NO_TABLE_ALIAS_JOIN
+                              : QIR_EREJ_NO_TABLE_ALIAS_FROM;
+    q->early_reject_detail = desc;
+    return YES;
+  }
+
+  JsonGetter je = {0};
+  if (jsget_object(item, "JoinExpr", &je) == YES) {
+    if (depth >= PG_PRECHECK_MAX_JOIN_DEPTH)
+      return NO;
+    JsonGetter sub = {0};
+    // The left spine bottoms out at the FROM item; every right arg is a
+    // JOIN item (matching how the IR flattens joins).
+    if (jsget_object(&je, "larg", &sub) == YES) {
+      AdbxTriStatus rc = pg_precheck_from_item(&sub, a, q, in_join, depth + 1);
+      if (rc != NO)
+        return rc;
+    }
+    if (jsget_object(&je, "rarg", &sub) == YES)
+      return pg_precheck_from_item(&sub, a, q, 1, depth + 1);
+    return NO;
+  }
+
+  return NO; // subselects, functions, ...: no early decision
+}
+
+/* Pre-pass over the raw SelectStmt AST that fails fast on rejection classes
+ * the validator enforces unconditionally (SELECT * and missing table
+ * aliases), before any arena-heavy IR building. Join-type policy is
+ * sensitive-mode dependent, so it stays with the full validator.
+ * Ownership: borrows 'seljg', may allocate the reject detail in 'a', and
+ * marks 'q' on rejection.
+ * Error semantics: returns YES when 'q' now carries an early rejection, NO
+ * when the full build should proceed (including on any internal failure; the
+ * pre-pass never rejects on doubt).
+ */
+static AdbxTriStatus pg_precheck_select(const JsonGetter *seljg, Arena *a,
+                                        QirQuery *q) {
+  if (!seljg || !a || !q)
+    return NO;
+
+  if (pg_precheck_star(seljg) == YES) {
+    q->early_reject = QIR_EREJ_STAR;
+    return YES;
+  }
+
+  // CTE references share the RangeVar shape but get a different item
+  // description, so queries with a WITH clause skip the alias pre-pass.
+  if (jsget_exists_nonnull(seljg, "withClause") == YES)
+    return NO;
+
+  JsonArrIter it = {0};
+  if (jsget_array_objects_begin(seljg, "fromClause", &it) != YES)
+    return NO;
+  JsonGetter item = {0};
+  while (jsget_array_objects_next(seljg, &it, &item) == YES) {
+    if (pg_precheck_from_item(&item, a, q, 0, 0) == YES)
+      return YES;
+  }
+  return NO;
+}
+
 static AdbxStatus pg_make_query_ir(DbBackend *db, const char *sql,
                                    QirQueryHandle *out) {
   (void)db;
@@ -2004,6 +2216,8 @@ static AdbxStatus pg_make_query_ir(DbBackend *db, const char *sql,
 
   JsonGetter seljg = {0};
   if (jsget_object(&stg, "SelectStmt", &seljg) == YES) {
+    if (pg_precheck_select(&seljg, &out->arena, q) == YES)
+      goto free_pg_parse_result; // rejected before building any IR
     if (pg_parse_select_stmt(&seljg, &out->arena, q) != OK) {
       qir_handle_destroy(out);
       jsget_destroy(&root);
@@ -2082,33 +2296,250 @@ static void pg_exec_command_ignore(PgImpl *p, const char *sql) {
 /* Best-effort rollback, ignore errors. */
 static void pg_rollback(PgImpl *p) { pg_exec_command(p, "ROLLBACK"); }
 
+/* Runs 'ncmds' single-statement commands through libpq pipeline mode so the
+ * whole batch rides one network flush instead of one synchronous round-trip
+ * per statement. 'optional[i]' != 0 marks a command whose failure is
+ * tolerated (the lenient SETs); pass NULL to require every command.
+ * Each command gets its own sync point (one extra protocol message, not a
+ * round-trip), so a failing optional command aborts only its own segment.
+ * Ownership: borrows everything.
+ * Side effects: executes the commands; stores errors inside 'p'.
+ * Error semantics: YES when every non-optional command succeeded, NO when
+ * pipeline mode could not be entered (the connection is untouched and the
+ * caller should fall back to serial execution), ERR on a failed non-optional
+ * command or a broken pipeline.
+ */
+static AdbxTriStatus pg_pipeline_commands(PgImpl *p, const char *const *cmds,
+                                          const uint8_t *optional,
+                                          uint32_t ncmds) {
+  if (!p || !p->conn || !cmds || ncmds == 0)
+    return ERR;
+
+  if (PQenterPipelineMode(p->conn) != 1)
+    return NO;
+
+  AdbxTriStatus rc = YES;
+
+  // Queue every command followed by its own sync marker, then let libpq flush
+  // the whole batch in one write when the first result is requested. Pipeline
+  // mode speaks the extended query protocol, so each entry must be a single
+  // statement (already this file's contract for internal batches).
+  uint32_t nsent = 0;
+  for (; nsent < ncmds; nsent++) {
+    if (PQsendQueryParams(p->conn, cmds[nsent], 0, NULL, NULL, NULL, NULL,
+                          0) != 1 ||
+        PQpipelineSync(p->conn) != 1) {
+      pg_set_err_pg(p, p->conn, "pipeline send failed");
+      rc = ERR;
+      break;
+    }
+  }
+
+  // Demultiplex one segment per queued command, in submission order: the
+  // command's result, a NULL separator, then the PGRES_PIPELINE_SYNC marker
+  // closing its segment.
+  for (uint32_t i = 0; i < nsent; i++) {
+    int seg_done = 0;
+    int seg_failed = 0;
+    while (!seg_done) {
+      PGresult *res = PQgetResult(p->conn);
+      if (!res) {
+        // NULL separates a command's results from its sync marker, but a
+        // dead connection also yields NULL forever.
+        if (PQstatus(p->conn) != CONNECTION_OK) {
+          pg_set_err_pg(p, p->conn, "pipeline drain failed");
+          return ERR;
+        }
+        continue;
+      }
+      ExecStatusType st = PQresultStatus(res);
+      if (st == PGRES_PIPELINE_SYNC) {
+        seg_done = 1;
+      } else if (st != PGRES_COMMAND_OK && st != PGRES_TUPLES_OK &&
+                 !seg_failed) {
+        seg_failed = 1;
+        if (!optional || !optional[i]) {
+          pg_set_err_pg(p, p->conn, cmds[i]);
+          rc = ERR;
+        }
+      }
+      PQclear(res);
+    }
+  }
+
+  if (PQexitPipelineMode(p->conn) != 1) {
+    pg_set_err_pg(p, p->conn, "PQexitPipelineMode failed");
+    rc = ERR;
+  }
+  return rc;
+}
+
+/* Drops every cached prepared statement. Called whenever the underlying
+ * connection is (re)established or closed, since server-side statements are
+ * session-scoped.
+ * Side effects: frees owned SQL copies; does not talk to the server.
+ */
+static void pg_prep_cache_reset(PgImpl *p) {
+  if (!p)
+    return;
+  for (uint32_t i = 0; i < PG_PREP_CACHE_SIZE; i++) {
+    free(p->prep_cache[i].sql);
+    memset(&p->prep_cache[i], 0, sizeof(p->prep_cache[i]));
+  }
+  p->prep_tick = 0;
+}
+
+/* Returns 1 when every value of 'oid' has a fixed-width binary encoding that
+ * pg_binary_cell_text() can render byte-identically to the server's own text
+ * output: bool, int2, int4, int8, and oid. Floats and timestamps are
+ * deliberately absent; their text renderings depend on server settings
+ * (extra_float_digits, DateStyle) this broker does not re-implement. */
+static int pg_oid_binary_fixed(Oid oid) {
+  return oid == 16 || oid == 20 || oid == 21 || oid == 23 || oid == 26;
+}
+
+/* Returns the server-side name of a prepared statement for 'sql', preparing
+ * and caching it on first use (LRU eviction on a full cache).
+ * Ownership: borrows all inputs; the returned name is owned by the cache and
+ * valid until the entry is evicted or the connection closes.
+ * Side effects: may run PREPARE/DEALLOCATE/Describe round-trips on the
+ * connection.
+ * Error semantics: returns NULL when the statement cannot be prepared; the
+ * caller falls back to a direct parameterized send (which surfaces the real
+ * SQL error to the agent).
+ * '*out_binary_fmt' is set to 1 when every result column of the statement is
+ * a fixed-width type, so the caller may request binary-format results. */
+static const char *pg_prep_cache_get(PgImpl *p, const char *sql,
+                                     const Oid *types, uint32_t nparams,
+                                     int *out_binary_fmt) {
+  if (out_binary_fmt)
+    *out_binary_fmt = 0;
+  if (!p || !p->conn || !sql || nparams > MAX_TOKEN_PARAMS)
+    return NULL;
+
+  uint64_t h = rapidhash(sql, strlen(sql));
+
+  PgPreparedStmt *victim = NULL;
+  for (uint32_t i = 0; i < PG_PREP_CACHE_SIZE; i++) {
+    PgPreparedStmt *e = &p->prep_cache[i];
+    if (!e->sql) {
+      if (!victim || victim->sql)
+        victim = e; // prefer an empty slot over evicting
+      continue;
+    }
+    if (e->sql_hash == h && strcmp(e->sql, sql) == 0) {
+      int types_match = (e->nparams == nparams);
+      for (uint32_t t = 0; types_match && t < nparams; t++)
+        types_match = (e->param_oids[t] == (uint32_t)types[t]);
+      if (types_match) {
+        e->last_used = ++p->prep_tick;
+        if (out_binary_fmt)
+          *out_binary_fmt = e->binary_ok;
+        return e->name;
+      }
+      // same SQL with different bind types: re-prepare under this slot
+      victim = e;
+      break;
+    }
+    if (!victim || (victim->sql && e->last_used < victim->last_used))
+      victim = e;
+  }
+
+  if (victim->sql) {
+    // Free the server-side statement before reusing the slot's name. Failure
+    // is fine: a leftover statement just makes the PREPARE below fail and we
+    // fall back to a direct send.
+    char buf[64];
+    snprintf(buf, sizeof(buf), "DEALLOCATE %s", victim->name);
+    pg_exec_command_ignore(p, buf);
+    free(victim->sql);
+    memset(victim, 0, sizeof(*victim));
+  }
+
+  snprintf(victim->name, sizeof(victim->name), "adbx_ps_%u",
+           (unsigned)(victim - p->prep_cache));
+
+  PGresult *pr = PQprepare(p->conn, victim->name, sql, (int)nparams, types);
+  int prepared = (pr && PQresultStatus(pr) == PGRES_COMMAND_OK);
+  PQclear(pr);
+  if (!prepared)
+    return NULL;
+
+  // One Describe at prepare time records whether every result column is a
+  // fixed-width type the broker can re-render from binary format, so later
+  // executions skip the server-side text conversion. Fail-soft to text.
+  uint8_t binary_ok = 0;
+  PGresult *dr = PQdescribePrepared(p->conn, victim->name);
+  if (dr && PQresultStatus(dr) == PGRES_COMMAND_OK) {
+    int nfields = PQnfields(dr);
+    binary_ok = (nfields > 0);
+    for (int f = 0; f < nfields && binary_ok; f++)
+      binary_ok = (uint8_t)pg_oid_binary_fixed(PQftype(dr, f));
+  }
+  PQclear(dr);
+
+  victim->sql = dup_or_null(sql);
+  if (!victim->sql)
+    return NULL; // statement stays server-side; slot remains free
+  victim->sql_hash = h;
+  victim->nparams = nparams;
+  for (uint32_t t = 0; t < nparams; t++)
+    victim->param_oids[t] = (uint32_t)types[t];
+  victim->last_used = ++p->prep_tick;
+  victim->binary_ok = binary_ok;
+  if (out_binary_fmt)
+    *out_binary_fmt = binary_ok;
+  return victim->name;
+}
+
 /* Executes commands so the current session of 'p' complies with 'p->policy'.
  * Must be called before running any query and the caller must checks this
  * returned one before sending any query. Stores error inside 'p'. */
 static AdbxStatus pg_apply_policy(PgImpl *p) {
   if (!p || !p->conn)
     return ERR;
-  // bad things can happen if we let the max bytes to be low like 1/2...
-  // this is a safe bound
-  // ignore failure, this is not strictly necessary
-  pg_exec_command_ignore(p, "SET application_name to \'db-explorer\'");
-
-  // safetyguards are optional, treat 0 as not set
 
-  char buf[256];
+  char ro_buf[64];
+  char timeout_buf[64];
   SafetyPolicy policy = p->policy;
 
-  snprintf(buf, sizeof(buf), "SET default_transaction_read_only = %s",
-           policy.read_only > 0 ? "on" : "off");
+  // safetyguards are optional, treat 0 as not set
+
+  snprintf(ro_buf, sizeof(ro_buf), "SET default_transaction_read_only = %s",
+           safety_policy_has(&policy, SAFETY_F_READ_ONLY) ? "on" : "off");
 
+  const char *cmds[3];
+  uint8_t optional[3];
+  uint32_t n = 0;
+  cmds[n] = "SET application_name to 'db-explorer'";
+  optional[n++] = 1; // cosmetic; ignore failure
+  cmds[n] = ro_buf;
   // Ignore failure: older versions / permissions might differ.
   // read-only will be enforced per query.
-  pg_exec_command_ignore(p, buf);
-
-  if (policy.statement_timeout_ms > 0) {
-    snprintf(buf, sizeof(buf), "SET statement_timeout = %u",
+  optional[n++] = 1;
+  if (safety_policy_has(&policy, SAFETY_F_STMT_TIMEOUT)) {
+    snprintf(timeout_buf, sizeof(timeout_buf), "SET statement_timeout = %u",
              policy.statement_timeout_ms);
-    if (pg_exec_command(p, buf) != OK)
+    cmds[n] = timeout_buf;
+    optional[n++] = 0;
+  }
+
+  // Fast path: pipeline mode applies every SET in one network flush, so a
+  // fresh connect pays one RTT here instead of three, while each SET keeps
+  // its own lenient/strict failure semantics.
+  AdbxTriStatus piped = pg_pipeline_commands(p, cmds, optional, n);
+  if (piped == YES) {
+    p->policy_applied = 1;
+    return OK;
+  }
+  if (piped == ERR)
+    return ERR; // the mandatory statement_timeout SET failed
+
+  // Slow path (pipeline mode unavailable): apply one SET at a time.
+  for (uint32_t i = 0; i < n; i++) {
+    if (optional[i])
+      pg_exec_command_ignore(p, cmds[i]);
+    else if (pg_exec_command(p, cmds[i]) != OK)
       return ERR;
   }
 
@@ -2173,30 +2604,35 @@ static AdbxStatus pg_exec_single_result(PgImpl *p, const char *sql,
   return OK;
 }
 
-/* Executes one parameterized SQL statement and returns exactly one PGresult.
- * Ownership: borrows all inputs; caller owns '*out_res' on success.
- * Side effects: sends one query over libpq and stores backend errors into 'p'.
- * Error semantics: returns OK when exactly one result is produced, ERR on bad
- * input/libpq failure/multiple results.
+/* Sends one SQL statement (optionally with bound positional params) without
+ * waiting for results.
+ * Ownership: borrows all inputs.
+ * Side effects: queues one query on the libpq connection and stores backend
+ * errors into 'p'.
+ * Error semantics: returns OK when the statement was sent, ERR on bad input
+ * or libpq failure.
  */
-static AdbxStatus pg_exec_single_result_bound(PgImpl *p, const char *sql,
-                                              const DbExecParam *params,
-                                              uint32_t nparams,
-                                              PGresult **out_res) {
+static AdbxStatus pg_send_query(PgImpl *p, const char *sql,
+                                const DbExecParam *params, uint32_t nparams) {
   assert(p);
   assert(p->conn);
   assert(sql);
-  assert(out_res);
   assert(!(nparams > 0 && !params));
 
-  if (!p || !p->conn || !sql || !out_res)
+  if (!p || !p->conn || !sql)
     return ERR;
   if ((nparams > 0 && !params) || nparams > MAX_TOKEN_PARAMS) {
     pg_set_err(p, "invalid bound execution input");
     return ERR;
   }
 
-  *out_res = NULL;
+  if (nparams == 0) {
+    if (PQsendQuery(p->conn, sql) != 1) {
+      pg_set_err_pg(p, p->conn, "PQsendQuery failed");
+      return ERR;
+    }
+    return OK;
+  }
 
   const char *param_values[MAX_TOKEN_PARAMS];
   Oid param_types[MAX_TOKEN_PARAMS];
@@ -2213,52 +2649,50 @@ static AdbxStatus pg_exec_single_result_bound(PgImpl *p, const char *sql,
     param_types[i] = (Oid)in->pg_oid;
   }
 
-  // param_values and _types may be unitialized if nparams is 0, but it's safe
-  // since PQsendQueryParams do not dereference them if nparams is 0.
-  if (PQsendQueryParams(p->conn, sql, (int)nparams, param_types, param_values,
-                        NULL, NULL, 0) != 1) {
-    pg_set_err_pg(p, p->conn, "PQsendQueryParams failed");
-    return ERR;
-  }
-
-  PGresult *first = NULL;
-  PGresult *extra = NULL;
-
-  for (;;) {
-    PGresult *res = PQgetResult(p->conn);
-    if (!res)
-      break;
-
-    if (!first) {
-      first = res;
-    } else {
-      // second result => multi-statement or multiple commands
-      extra = res;
-      // consume remaining results to keep connection usable
-      while ((res = PQgetResult(p->conn)) != NULL) {
-        PQclear(res);
-      }
-      break;
+  // Repeated bound statements skip the parse/plan round-trip through the
+  // per-connection prepared-statement cache.
+  int binary_fmt = 0;
+  const char *prep_name =
+      pg_prep_cache_get(p, sql, param_types, nparams, &binary_fmt);
+  if (prep_name) {
+    // When every result column is fixed-width, ask for binary format: the
+    // server skips its text output functions and the wire carries 2-8 bytes
+    // per cell; pg_binary_cell_text() re-renders them broker-side.
+    if (PQsendQueryPrepared(p->conn, prep_name, (int)nparams, param_values,
+                            NULL, NULL, binary_fmt) != 1) {
+      pg_set_err_pg(p, p->conn, "PQsendQueryPrepared failed");
+      return ERR;
     }
+    return OK;
   }
 
-  if (extra) {
-    pg_set_err(p, "multiple statements/results are not allowed");
-    PQclear(extra);
-    if (first)
-      PQclear(first);
-    return ERR;
-  }
-
-  if (!first) {
-    pg_set_err(p, "no result returned");
+  if (PQsendQueryParams(p->conn, sql, (int)nparams, param_types, param_values,
+                        NULL, NULL, 0) != 1) {
+    pg_set_err_pg(p, p->conn, "PQsendQueryParams failed");
     return ERR;
   }
-
-  *out_res = first;
   return OK;
 }
 
+/* Best-effort cancel of the in-flight query so a capped result stops pulling
+ * rows from the server instead of materializing them all.
+ * Side effects: sends one out-of-band cancel request; failures are ignored
+ * (the remaining rows are then drained without being copied).
+ * Thread safety: PQgetCancel/PQcancel are documented safe to run while
+ * another thread drives the same connection, so the broker thread may call
+ * this against a connection a worker is executing on.
+ */
+static void pg_cancel_inflight(PgImpl *p) {
+  if (!p || !p->conn)
+    return;
+  PGcancel *c = PQgetCancel(p->conn);
+  if (!c)
+    return;
+  char errbuf[256];
+  (void)PQcancel(c, errbuf, (int)sizeof(errbuf));
+  PQfreeCancel(c);
+}
+
 /* Verifies that the connected role is safe for read-only usage. This is a
  * one-time guardrail executed at connect time. Returns:
  * - OK: role passed the check.
@@ -2318,6 +2752,76 @@ done:
   return ok;
 }
 
+/* Optional pre-flight: asks the planner for the cost estimate of 'sql' and
+ * refuses execution when it exceeds the profile's "maxEstimatedCost" cap, so
+ * a runaway join is rejected in milliseconds instead of burning DB capacity
+ * until statement_timeout fires.
+ * Ownership: borrows everything.
+ * Side effects: runs one EXPLAIN round-trip; stores the refusal text into
+ * 'p' when the cap is exceeded.
+ * Error semantics: YES to proceed, NO when the estimate exceeds the cap.
+ * Anything that keeps the estimate unknown (EXPLAIN failure, unexpected
+ * JSON) returns ERR and the caller proceeds: the real execution surfaces the
+ * real error, and statement_timeout still bounds it.
+ */
+static AdbxTriStatus pg_cost_precheck(PgImpl *p, const char *sql) {
+  if (!p || !p->conn || !sql)
+    return ERR;
+
+  StrBuf q;
+  sb_init(&q);
+  if (sb_append_bytes(&q, "EXPLAIN (FORMAT JSON) ", 22) != OK ||
+      sb_append_bytes(&q, sql, strlen(sql)) != OK ||
+      sb_append_bytes(&q, "", 1) != OK) {
+    sb_clean(&q);
+    return ERR;
+  }
+
+  PGresult *res = NULL;
+  AdbxStatus xrc = pg_exec_single_result(p, q.data, &res);
+  sb_clean(&q);
+  if (xrc != OK)
+    return ERR;
+
+  AdbxTriStatus rc = ERR;
+  if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) >= 1 &&
+      PQnfields(res) >= 1 && !PQgetisnull(res, 0, 0)) {
+    // EXPLAIN (FORMAT JSON) yields one cell holding a top-level array; wrap
+    // it in an object so the JsonGetter (which roots at an object) can walk
+    // it.
+    StrBuf wrap;
+    sb_init(&wrap);
+    if (sb_append_bytes(&wrap, "{\"explain\":", 11) == OK &&
+        sb_append_bytes(&wrap, PQgetvalue(res, 0, 0),
+                        (size_t)PQgetlength(res, 0, 0)) == OK &&
+        sb_append_bytes(&wrap, "}", 1) == OK) {
+      JsonGetter jg = {0};
+      if (jsget_create(&jg, wrap.data, wrap.len) == OK) {
+        JsonArrIter it = {0};
+        JsonGetter top = {0};
+        double cost = 0.0;
+        if (jsget_array_objects_begin(&jg, "explain", &it) == YES &&
+            jsget_array_objects_next(&jg, &it, &top) == YES &&
+            jsget_f64(&top, "Plan.Total Cost", &cost) == YES) {
+          if (cost > (double)p->policy.max_estimated_cost) {
+            snprintf(p->last_err, sizeof(p->last_err),
+                     "query refused: estimated cost %.0f exceeds the "
+                     "profile's maxEstimatedCost of %u",
+                     cost, p->policy.max_estimated_cost);
+            rc = NO;
+          } else {
+            rc = YES;
+          }
+        }
+        jsget_destroy(&jg);
+      }
+    }
+    sb_clean(&wrap);
+  }
+  PQclear(res);
+  return rc;
+}
+
 /* --------------------------- DbBackend vtable --------------------------- */
 
 static AdbxStatus pg_connect(DbBackend *db, const ConnProfile *profile,
@@ -2332,6 +2836,7 @@ static AdbxStatus pg_connect(DbBackend *db, const ConnProfile *profile,
     PQfinish(p->conn);
     p->conn = NULL;
   }
+  pg_prep_cache_reset(p);
 
   const char *port_str = NULL;
   char portbuf[16];
@@ -2346,13 +2851,50 @@ static AdbxStatus pg_connect(DbBackend *db, const ConnProfile *profile,
                         profile->user, pwd,      profile->options,
                         NULL};
 
-  p->conn = PQconnectdbParams(keys, vals, 0);
+  p->conn = PQconnectStartParams(keys, vals, 0);
   if (!p->conn) {
-    pg_set_err(p, "PQconnectdb returned NULL");
+    pg_set_err(p, "PQconnectStartParams returned NULL");
     return ERR;
   }
 
-  if (PQstatus(p->conn) != CONNECTION_OK) {
+  // Drive the handshake with PQconnectPoll so the wait is bounded by the
+  // profile's deadline instead of the kernel's TCP timeout: a black-holed
+  // host then stalls the caller for at most 'timeout_secs'.
+  uint32_t timeout_secs = profile->connect_timeout_secs
+                              ? profile->connect_timeout_secs
+                              : PG_CONNECT_TIMEOUT_DEFAULT_SECS;
+  uint64_t deadline_ms = now_ms_monotonic() + (uint64_t)timeout_secs * 1000u;
+
+  PostgresPollingStatusType want = PGRES_POLLING_WRITING;
+  while (PQstatus(p->conn) != CONNECTION_BAD && want != PGRES_POLLING_OK) {
+    uint64_t now = now_ms_monotonic();
+    if (now >= deadline_ms) {
+      snprintf(p->last_err, sizeof(p->last_err),
+               "connection attempt timed out after %us", timeout_secs);
+      PQfinish(p->conn);
+      p->conn = NULL;
+      return ERR;
+    }
+    struct pollfd pfd = {
+        .fd = PQsocket(p->conn),
+        .events = (want == PGRES_POLLING_READING) ? POLLIN : POLLOUT};
+    int prc = poll(&pfd, 1, (int)(deadline_ms - now));
+    if (prc < 0) {
+      if (errno == EINTR)
+        continue;
+      pg_set_err(p, "poll failed while connecting");
+      PQfinish(p->conn);
+      p->conn = NULL;
+      return ERR;
+    }
+    if (prc == 0)
+      continue; // timed out; the deadline check above ends the loop
+    want = PQconnectPoll(p->conn);
+    if (want == PGRES_POLLING_FAILED)
+      break;
+  }
+
+  if (want != PGRES_POLLING_OK || PQstatus(p->conn) != CONNECTION_OK) {
     pg_set_err_pg(p, p->conn, "connection failed");
     PQfinish(p->conn);
     p->conn = NULL;
@@ -2361,7 +2903,7 @@ static AdbxStatus pg_connect(DbBackend *db, const ConnProfile *profile,
 
   /* Enforce a one-time role audit at connection time and fail closed on
    * mismatch. */
-  if (policy->read_only) {
+  if (safety_policy_has(policy, SAFETY_F_READ_ONLY)) {
     if (pg_check_safe_read_only_role(p) != OK) {
       PQfinish(p->conn);
       p->conn = NULL;
@@ -2391,6 +2933,7 @@ static void pg_disconnect(DbBackend *db) {
     PQfinish(p->conn);
     p->conn = NULL;
   }
+  pg_prep_cache_reset(p);
   p->policy_applied = 0;
 }
 
@@ -2403,22 +2946,172 @@ static void pg_destroy(DbBackend *db) {
   free(db);
 }
 
+// Two-digit lookup so integer rendering costs one table read per digit pair
+// instead of a divide and a branch per digit.
+static const char PG_DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+/* Renders 'v' in decimal into 'out' (>= 20 bytes, not NUL-terminated) and
+ * returns the digit count. */
+static uint32_t pg_u64_to_dec(uint64_t v, char *out) {
+  char tmp[20];
+  char *w = tmp + sizeof(tmp);
+  while (v >= 100) {
+    uint64_t r = v % 100;
+    v /= 100;
+    w -= 2;
+    memcpy(w, &PG_DIGIT_PAIRS[r * 2], 2);
+  }
+  if (v >= 10) {
+    w -= 2;
+    memcpy(w, &PG_DIGIT_PAIRS[v * 2], 2);
+  } else {
+    *--w = (char)('0' + v);
+  }
+  uint32_t len = (uint32_t)(tmp + sizeof(tmp) - w);
+  memcpy(out, w, len);
+  return len;
+}
+
+/* Returns the cached decimal rendering of 'oid', formatting and caching it
+ * on first touch (direct-mapped; a colliding OID simply replaces the slot).
+ * The returned pointer stays valid until another OID lands in the same slot,
+ * so callers must consume it before the next lookup. */
+static const char *pg_oid_text(PgImpl *p, Oid oid) {
+  if (oid == 0)
+    return "0"; // 0 marks an empty slot; render the unknown type inline
+  PgOidText *e = &p->oid_text[oid % PG_OID_TEXT_CACHE_SIZE];
+  if (e->oid != (uint32_t)oid) {
+    uint32_t n = pg_u64_to_dec((uint64_t)oid, e->text);
+    e->text[n] = '\0';
+    e->oid = (uint32_t)oid;
+  }
+  return e->text;
+}
+
+// Longest rendering is int8: sign plus 19 digits plus the NUL.
+#define PG_BINARY_TEXT_BUFSZ 24u
+
+/* Decodes one binary-format (network byte order) cell into the text
+ * PostgreSQL itself would have sent for that type.
+ * Ownership: borrows 'val'; writes a NUL-terminated rendering into 'out'
+ * (>= PG_BINARY_TEXT_BUFSZ bytes).
+ * Error semantics: returns the text length, or -1 when oid/len is not a
+ * supported fixed-width shape (the caller treats that as a malformed
+ * result). */
+static int pg_binary_cell_text(Oid oid, const unsigned char *val, int len,
+                               char *out) {
+  if (!val || !out)
+    return -1;
+
+  uint64_t raw = 0;
+  int64_t sv = 0;
+  switch (oid) {
+  case 16: // bool
+    if (len != 1)
+      return -1;
+    out[0] = val[0] ? 't' : 'f';
+    out[1] = '\0';
+    return 1;
+  case 21: // int2
+    if (len != 2)
+      return -1;
+    sv = (int16_t)(((uint16_t)val[0] << 8) | (uint16_t)val[1]);
+    break;
+  case 23: // int4
+    if (len != 4)
+      return -1;
+    raw = ((uint32_t)val[0] << 24) | ((uint32_t)val[1] << 16) |
+          ((uint32_t)val[2] << 8) | (uint32_t)val[3];
+    sv = (int32_t)raw;
+    break;
+  case 20: // int8
+    if (len != 8)
+      return -1;
+    for (int i = 0; i < 8; i++)
+      raw = (raw << 8) | (uint64_t)val[i];
+    sv = (int64_t)raw;
+    break;
+  case 26: { // oid; unsigned
+    if (len != 4)
+      return -1;
+    raw = ((uint32_t)val[0] << 24) | ((uint32_t)val[1] << 16) |
+          ((uint32_t)val[2] << 8) | (uint32_t)val[3];
+    uint32_t n = pg_u64_to_dec(raw, out);
+    out[n] = '\0';
+    return (int)n;
+  }
+  default:
+    return -1;
+  }
+
+  uint32_t n = 0;
+  uint64_t mag = (uint64_t)sv;
+  if (sv < 0) {
+    out[n++] = '-';
+    mag = ~(uint64_t)sv + 1; // two's complement magnitude; covers INT64_MIN
+  }
+  n += pg_u64_to_dec(mag, out + n);
+  out[n] = '\0';
+  return (int)n;
+}
+
+/* Stages and commits one PGresult row into 'spill', tokenizing sensitive
+ * cells through 'qb' on the way so plaintext never reaches the spill file.
+ * Ownership: borrows everything; may mutate qb->store when tokens are minted.
+ * Error semantics: returns YES on commit, NO when the spill byte cap is
+ * reached (the row is dropped), ERR on staging/commit failure.
+ */
+static AdbxTriStatus pg_spill_row(QueryResultBuilder *qb, ResultSpill *spill,
+                                  PGresult *res, int t, uint32_t ncols) {
+  for (uint32_t c = 0; c < ncols; c++) {
+    char *val = NULL;
+    size_t val_len = 0;
+    char binbuf[PG_BINARY_TEXT_BUFSZ];
+    if (!PQgetisnull(res, t, (int)c)) {
+      val = PQgetvalue(res, t, (int)c);
+      val_len = (size_t)PQgetlength(res, t, (int)c);
+      if (PQfformat(res, (int)c) == 1) {
+        int blen = pg_binary_cell_text(PQftype(res, (int)c),
+                                       (const unsigned char *)val,
+                                       (int)val_len, binbuf);
+        if (blen < 0)
+          return ERR;
+        val = binbuf;
+        val_len = (size_t)blen;
+      }
+    }
+    if (qb_spill_cell(qb, spill, c, val, val_len) != OK)
+      return ERR;
+  }
+  return rspill_row_commit(spill);
+}
+
 /* Executes one SQL statement (optionally with bound positional params) and
  * materializes one QueryResult.
  * Ownership: borrows db/sql/params/qb_policy; allocates '*out_qr' on success.
  * Side effects: executes SQL, enforces policy/transactions, and mutates PgImpl
  * error buffer.
+ * 'manage_txn' wraps the statement in its own BEGIN/COMMIT; cursor fetches
+ * pass 0 to run inside the transaction cursor_open() left pending. Failures
+ * and cancels always roll back, which ends that transaction (and any cursor
+ * it held) regardless of 'manage_txn'.
  * Error semantics: returns OK if a QueryResult object is produced, ERR only on
  * catastrophic allocation/input failures.
  */
 static AdbxStatus pg_exec_impl(DbBackend *db, const char *sql,
                                const DbExecParam *params, uint32_t nparams,
                                const QueryResultBuildPolicy *qb_policy,
-                               QueryResult **out_qr) {
+                               QueryResult **out_qr, int manage_txn) {
 
   const char *err_msg;
   QueryResult *qr = NULL;
   PGresult *res = NULL;
+  QRCellSpan *row_spans = NULL; // one span per column, staged for qb_set_row
+  char *row_binbufs = NULL;     // per-column text renders of binary cells
 
   // Error logging logic, if we called a function that sets the error like
   // pg_exec_command(), we use that error... else, we create the message.
@@ -2448,134 +3141,324 @@ static AdbxStatus pg_exec_impl(DbBackend *db, const char *sql,
     }
   }
 
+  // Consume the one-shot priority class. A non-NORMAL class scopes its
+  // statement_timeout (and, for HEAVY, work_mem) to this statement via
+  // SET LOCAL inside the transaction below; the session-level SETs from
+  // pg_apply_policy() are back in force the moment it ends.
+  SafetyPriority prio = (SafetyPriority)p->next_priority;
+  p->next_priority = (uint8_t)SAFETY_PRIO_NORMAL;
+  uint32_t prio_timeout_ms = 0;
+  int prio_scoped = 0;
+  if (manage_txn && prio != SAFETY_PRIO_NORMAL) {
+    prio_timeout_ms = safety_policy_priority_timeout_ms(&p->policy, prio);
+    prio_scoped = prio_timeout_ms != p->policy.statement_timeout_ms ||
+                  (prio == SAFETY_PRIO_HEAVY && p->policy.heavy_work_mem_kb > 0);
+  }
+
+  // Cost pre-flight for agent statements (cursor fetches run a plan the
+  // open already vetted; bound statements cannot be EXPLAINed without their
+  // parameter values).
+  if (manage_txn && nparams == 0 &&
+      safety_policy_has(&p->policy, SAFETY_F_COST_CHECK)) {
+    if (pg_cost_precheck(p, sql) == NO)
+      goto fail; // last_err carries the refusal text
+  }
+
   // start counting for query execution time
   uint64_t t0 = now_ms_monotonic();
 
   // start a read-only transaction for every query
-  if (p->policy.read_only) {
-    if (pg_exec_command(p, "BEGIN READ ONLY") != OK) {
-      goto fail;
+  int pipelined = 0;     // BEGIN and the statement share one network flush
+  int begin_pending = 0; // BEGIN's reply is still queued ahead of the rows
+  if (manage_txn) {
+    const char *begin_sql = safety_policy_has(&p->policy, SAFETY_F_READ_ONLY)
+                                ? "BEGIN READ ONLY"
+                                : "BEGIN";
+    // Pipeline mode lets BEGIN ride the statement's flush, saving one
+    // round-trip per request. Bound statements stay serial: the
+    // prepared-statement cache issues synchronous PREPAREs of its own, which
+    // pipeline mode forbids.
+    // Priority-scoped requests need SET LOCAL commands between BEGIN and the
+    // statement, so they keep the serial path; they are rare enough that the
+    // extra round-trips do not matter.
+    if (nparams == 0 && !prio_scoped && PQenterPipelineMode(p->conn) == 1) {
+      if (PQsendQueryParams(p->conn, begin_sql, 0, NULL, NULL, NULL, NULL,
+                            0) == 1) {
+        pipelined = 1;
+        begin_pending = 1;
+      } else {
+        // nothing was queued; drop back to the serial path
+        (void)PQexitPipelineMode(p->conn);
+      }
     }
-  } else {
-    if (pg_exec_command(p, "BEGIN") != OK) {
+    if (!pipelined && pg_exec_command(p, begin_sql) != OK)
       goto fail;
+
+    if (prio_scoped) {
+      char set_buf[64];
+      if (prio_timeout_ms != p->policy.statement_timeout_ms) {
+        snprintf(set_buf, sizeof(set_buf), "SET LOCAL statement_timeout = %u",
+                 prio_timeout_ms);
+        // Strict: a leash that silently failed to change would surprise both
+        // classes (FAST queries would run unbounded-ish, HEAVY ones would die
+        // at the tight session timeout they opted out of).
+        if (pg_exec_command(p, set_buf) != OK)
+          goto fail;
+      }
+      if (prio == SAFETY_PRIO_HEAVY && p->policy.heavy_work_mem_kb > 0) {
+        snprintf(set_buf, sizeof(set_buf), "SET LOCAL work_mem = '%ukB'",
+                 p->policy.heavy_work_mem_kb);
+        // Lenient: the server-default work_mem is a safe fallback.
+        pg_exec_command_ignore(p, set_buf);
+      }
     }
   }
 
-  if (nparams > 0) {
-    if (pg_exec_single_result_bound(p, sql, params, nparams, &res) != OK)
+  if (pipelined) {
+    // Extended protocol, single statement only -- which validation already
+    // guarantees for everything reaching this backend.
+    if (PQsendQueryParams(p->conn, sql, 0, NULL, NULL, NULL, NULL, 0) != 1 ||
+        PQpipelineSync(p->conn) != 1) {
+      pg_set_err_pg(p, p->conn, "pipeline send failed");
       goto fail;
-  } else {
-    if (pg_exec_single_result(p, sql, &res) != OK)
-      goto fail;
-  }
-
-  ExecStatusType st = PQresultStatus(res);
-
-  // if backend error, rollback and return error
-  if (st == PGRES_FATAL_ERROR || st == PGRES_BAD_RESPONSE ||
-      st == PGRES_NONFATAL_ERROR) {
-    // capture error string
-    const char *msg = PQresultErrorMessage(res);
-    if (!msg || !*msg)
-      msg = PQerrorMessage(p->conn);
-
-    pg_set_err(p, msg ? msg : "query failed");
-
+    }
+  } else if (pg_send_query(p, sql, params, nparams) != OK)
     goto fail;
-  }
 
-  // Right now, the agent can't send commands like set, delete...
-  // so the status should be PGRES_TUPLES_OK.
-  if (st == PGRES_TUPLES_OK) {
-    int ncols = PQnfields(res);
-    int ntuples = PQntuples(res);
+  // Stream rows one PGresult at a time so memory peaks at one row instead of
+  // the whole result set. If single-row mode cannot be enabled the results
+  // simply arrive fully materialized and the same loop below handles them.
+  (void)PQsetSingleRowMode(p->conn);
 
-    if (ncols < 0)
-      ncols = 0;
-    if (ntuples < 0)
-      ntuples = 0;
+  QueryResultBuilder qb = {0};
+  uint32_t row = 0;
+  int stream_done = 0; // saw the terminal PGRES_TUPLES_OK of the statement
+  int multi = 0;       // a second statement produced results
+  int caps_hit = 0;    // row/byte cap reached; drain without copying
+  int cancel_sent = 0;
+  int spilling = 0; // byte cap hit and overflow rows now go to qr->spill
 
-    uint32_t out_cols = (uint32_t)ncols;
-    uint32_t out_rows = (uint32_t)ntuples;
+  for (;;) {
+    res = PQgetResult(p->conn);
+    if (!res) {
+      if (!pipelined)
+        break;
+      // Pipeline mode separates queued statements with a NULL instead of
+      // ending the stream; re-arm single-row mode for the next statement and
+      // keep reading until the sync marker. A dead connection also yields
+      // NULL forever, so bail out on it.
+      if (PQstatus(p->conn) != CONNECTION_OK) {
+        pg_set_err_pg(p, p->conn, "connection lost mid-pipeline");
+        goto fail;
+      }
+      (void)PQsetSingleRowMode(p->conn);
+      continue;
+    }
+
+    ExecStatusType st = PQresultStatus(res);
 
-    uint8_t result_truncated = 0;
-    if (p->policy.max_rows > 0 && out_rows > p->policy.max_rows) {
-      out_rows = p->policy.max_rows;
-      result_truncated = 1;
+    if (pipelined && st == PGRES_PIPELINE_SYNC) {
+      // Everything queued in the shared flush is accounted for; leave
+      // pipeline mode so COMMIT/ROLLBACK below run over the normal protocol.
+      PQclear(res);
+      res = NULL;
+      (void)PQexitPipelineMode(p->conn);
+      break;
     }
 
-    qr = qr_create_ok(NULL, (uint32_t)ncols, out_rows, result_truncated,
-                      p->policy.max_payload_bytes);
-    if (!qr) {
-      pg_set_err(p, "qr_create_ok error");
-      goto fail;
+    if (begin_pending && st == PGRES_COMMAND_OK) {
+      // BEGIN's own reply riding ahead of the statement's rows.
+      begin_pending = 0;
+      PQclear(res);
+      res = NULL;
+      continue;
     }
-    QueryResultBuilder qb = {0};
-    if (qb_init(&qb, qr, qb_policy) != OK) {
-      pg_set_err(p, "qb_init failed");
-      goto fail;
+
+    if (cancel_sent &&
+        (st == PGRES_FATAL_ERROR || st == PGRES_NONFATAL_ERROR)) {
+      // expected "canceling statement due to user request" after our cancel
+      PQclear(res);
+      res = NULL;
+      continue;
     }
 
-    // Column metadata
-    for (uint32_t c = 0; c < out_cols; c++) {
-      const char *name = PQfname(res, c);
-      // Store empty strings if metadata missing
-      if (!name)
-        name = "";
+    if (st == PGRES_SINGLE_TUPLE || st == PGRES_TUPLES_OK) {
+      if (stream_done) {
+        // second result => multi-statement or multiple commands
+        multi = 1;
+        PQclear(res);
+        res = NULL;
+        continue;
+      }
 
-      Oid oid = PQftype(res, c);
-      char typebuf[32];
-      // materialize Oid to a textual representation
-      snprintf(typebuf, sizeof(typebuf), "%u", (unsigned)oid);
+      // First result: create the QueryResult and copy column metadata.
+      if (!qr) {
+        int ncols = PQnfields(res);
+        if (ncols < 0)
+          ncols = 0;
+
+        qr = qr_create_ok_sized(NULL, (uint32_t)ncols, 0, 0,
+                                p->policy.max_payload_bytes,
+                                qb_policy ? qb_policy->arena_size_hint : 0);
+        if (!qr) {
+          pg_set_err(p, "qr_create_ok error");
+          goto fail;
+        }
+        if (qb_init(&qb, qr, qb_policy) != OK) {
+          pg_set_err(p, "qb_init failed");
+          goto fail;
+        }
 
-      if (qb_set_col(&qb, c, name, typebuf, (uint32_t)oid) != OK) {
-        pg_set_err(p, "qb_set_col failed");
-        goto fail;
-      }
-    }
+        for (uint32_t c = 0; c < qr->ncols; c++) {
+          const char *name = PQfname(res, (int)c);
+          // Store empty strings if metadata missing
+          if (!name)
+            name = "";
 
-    // Fill cells (enforces max_query_bytes by stopping when the cap is hit).
-    int stop = 0;
-    for (uint32_t r = 0; r < out_rows; r++) {
-      for (uint32_t c = 0; c < (uint32_t)ncols; c++) {
+          Oid oid = PQftype(res, (int)c);
+          // materialize Oid to a textual representation (cached per session)
+          const char *typetext = pg_oid_text(p, oid);
 
-        char *val;
-        size_t val_len = 0;
-        if (PQgetisnull(res, r, c))
-          val = NULL;
-        else {
-          val = PQgetvalue(res, (int)r, (int)c);
-          val_len = (size_t)PQgetlength(res, (int)r, (int)c);
+          if (qb_set_col(&qb, c, name, typetext, (uint32_t)oid) != OK) {
+            pg_set_err(p, "qb_set_col failed");
+            goto fail;
+          }
         }
 
-        int src = qb_set_cell(&qb, r, c, val, val_len);
-        if (src == NO) {
+        // Scratch for whole-row batch appends: one span per column plus a
+        // text-render buffer for binary-format cells.
+        row_spans =
+            (QRCellSpan *)xmalloc((size_t)qr->ncols * sizeof(*row_spans));
+        row_binbufs =
+            (char *)xmalloc((size_t)qr->ncols * PG_BINARY_TEXT_BUFSZ);
+      }
+
+      // Append rows (one per result in single-row mode, all of them in the
+      // fallback) while the row and byte caps allow it.
+      int ntuples = PQntuples(res);
+      for (int t = 0; t < ntuples && !caps_hit; t++) {
+        if (p->policy.max_rows > 0 && row >= p->policy.max_rows) {
           qr->result_truncated = 1;
-          qr->nrows = r;
-          stop = 1;
+          caps_hit = 1;
           break;
         }
-        if (src == ERR) {
-          pg_set_err(p, "qb_set_cell failed");
+
+        if (spilling) {
+          AdbxTriStatus sp = pg_spill_row(&qb, qr->spill, res, t, qr->ncols);
+          if (sp == YES)
+            continue;
+          // spill cap reached or spill I/O failed: keep the rows already
+          // spooled and stop pulling
+          caps_hit = 1;
+          break;
+        }
+
+        if (qr_reserve_rows(qr, row + 1) != OK) {
+          pg_set_err(p, "qr_reserve_rows failed");
+          goto fail;
+        }
+
+        for (uint32_t c = 0; c < qr->ncols; c++) {
+          char *val;
+          size_t val_len = 0;
+          if (PQgetisnull(res, t, (int)c))
+            val = NULL;
+          else {
+            val = PQgetvalue(res, t, (int)c);
+            val_len = (size_t)PQgetlength(res, t, (int)c);
+            if (PQfformat(res, (int)c) == 1) {
+              // binary-format execution path: re-render the fixed-width
+              // payload into the text the rest of the pipeline expects
+              char *binbuf = row_binbufs + (size_t)c * PG_BINARY_TEXT_BUFSZ;
+              int blen = pg_binary_cell_text(PQftype(res, (int)c),
+                                             (const unsigned char *)val,
+                                             (int)val_len, binbuf);
+              if (blen < 0) {
+                pg_set_err(p, "unexpected binary result payload");
+                goto fail;
+              }
+              val = binbuf;
+              val_len = (size_t)blen;
+            }
+          }
+          row_spans[c].value = val;
+          row_spans[c].len = val_len;
+        }
+
+        // One cap check and one copy pass for the whole row.
+        AdbxTriStatus src = qb_set_row(&qb, row, row_spans, qr->ncols);
+        if (src == NO) {
+          // byte cap: the row was not stored; when the policy allows, spool
+          // the overflow to a private tempfile so a page fetch can serve it
+          // without re-executing the query
+          qr->result_truncated = 1;
+          caps_hit = 1;
+          if (safety_policy_has(&p->policy, SAFETY_F_SPILL) && qb_policy &&
+              qb_policy->spill_dirfd > 0) {
+            qr->spill = rspill_create(qb_policy->spill_dirfd,
+                                      p->policy.spill_max_bytes);
+            if (qr->spill && rspill_set_cols(qr->spill, qr) == OK &&
+                pg_spill_row(&qb, qr->spill, res, t, qr->ncols) == YES) {
+              spilling = 1;
+              caps_hit = 0;
+            }
+            // fail-soft: a spill that cannot start leaves the truncation
+          }
+        } else if (src == ERR) {
+          pg_set_err(p, "qb_set_row failed");
           goto fail;
         }
+        if (!caps_hit && !spilling) {
+          row++;
+          qr->nrows = row;
+        }
       }
-      if (stop)
-        break;
+
+      if (caps_hit && !cancel_sent) {
+        // Stop the server from producing rows nobody will copy.
+        pg_cancel_inflight(p);
+        cancel_sent = 1;
+      }
+
+      if (st == PGRES_TUPLES_OK)
+        stream_done = 1;
+      PQclear(res);
+      res = NULL;
+      continue;
     }
-  } else {
-    // Error status
-    const char *msg = PQresStatus(st);
-    pg_set_err(p, msg ? msg : "unexpected PGresult status");
+
+    // Any other status is an error for this read-only broker (the agent
+    // cannot send commands like SET or DELETE).
+    const char *msg = PQresultErrorMessage(res);
+    if (!msg || !*msg)
+      msg = PQresStatus(st);
+    pg_set_err(p, msg ? msg : "query failed");
     goto fail;
   }
 
-  PQclear(res);
-  res = NULL;
+  if (multi) {
+    pg_set_err(p, "multiple statements/results are not allowed");
+    goto fail;
+  }
+  if (!qr) {
+    pg_set_err(p, "no result returned");
+    goto fail;
+  }
+
+  if (qr->spill) {
+    qr->spilled_rows = rspill_nrows(qr->spill);
+    if (qr->spilled_rows == 0) {
+      // the spill started but never committed a row; nothing to page
+      rspill_destroy(qr->spill);
+      qr->spill = NULL;
+    }
+  }
 
-  // commit transaction
-  if (pg_exec_command(p, "COMMIT") != OK) {
+  if (cancel_sent) {
+    // The cancel left the transaction aborted; roll back and keep the
+    // truncated rows already copied.
+    pg_rollback(p);
+  } else if (manage_txn && pg_exec_command(p, "COMMIT") != OK) {
     // If commit fails, try rollback
     pg_rollback(p);
     pg_set_err(p, "COMMIT failure");
@@ -2585,6 +3468,8 @@ static AdbxStatus pg_exec_impl(DbBackend *db, const char *sql,
   uint64_t t1 = now_ms_monotonic();
   qr->exec_ms = (t1 >= t0) ? (t1 - t0) : 0;
 
+  free(row_spans);
+  free(row_binbufs);
   *out_qr = qr;
   return (*out_qr ? OK : ERR);
 
@@ -2594,12 +3479,32 @@ fail:
 
   err_msg = p->last_err;
   TLOG("ERROR - pg_exec failed: %s", err_msg ? err_msg : "unknown");
-  // rollback is safe even if we haven't executed anything
-  pg_rollback(p);
   if (res)
     PQclear(res);
+  // drain results still queued so the rollback runs on a clean connection
+  if (p->conn) {
+    PGresult *pending;
+    while ((pending = PQgetResult(p->conn)) != NULL)
+      PQclear(pending);
+    // A statement that failed mid-pipeline leaves the connection in pipeline
+    // mode with its sync marker still queued; keep draining until libpq lets
+    // us exit so the rollback below runs over the normal protocol.
+    while (PQpipelineStatus(p->conn) != PQ_PIPELINE_OFF) {
+      if (PQexitPipelineMode(p->conn) == 1)
+        break;
+      if (PQstatus(p->conn) != CONNECTION_OK)
+        break;
+      pending = PQgetResult(p->conn);
+      if (pending)
+        PQclear(pending);
+    }
+  }
+  // rollback is safe even if we haven't executed anything
+  pg_rollback(p);
   if (qr)
     qr_destroy(qr);
+  free(row_spans);
+  free(row_binbufs);
 fail_bad_input:
   // if bad input, we can't rely on the buffer for the error of PgImpl
   const char *safe_msg =
@@ -2614,14 +3519,115 @@ fail_bad_input:
 static AdbxStatus pg_exec(DbBackend *db, const char *sql,
                           const QueryResultBuildPolicy *qb_policy,
                           QueryResult **out_qr) {
-  return pg_exec_impl(db, sql, NULL, 0, qb_policy, out_qr);
+  return pg_exec_impl(db, sql, NULL, 0, qb_policy, out_qr, 1);
 }
 
 static AdbxStatus pg_exec_bound(DbBackend *db, const char *sql,
                                 const DbExecParam *params, uint32_t nparams,
                                 const QueryResultBuildPolicy *qb_policy,
                                 QueryResult **out_qr) {
-  return pg_exec_impl(db, sql, params, nparams, qb_policy, out_qr);
+  return pg_exec_impl(db, sql, params, nparams, qb_policy, out_qr, 1);
+}
+
+/* Returns 1 when 'name' only holds [A-Za-z0-9_]. Cursor names are minted by
+ * the broker, so anything else is a misuse rather than user input. */
+static int pg_cursor_name_ok(const char *name) {
+  if (!name || !*name)
+    return 0;
+  for (const char *c = name; *c; c++) {
+    int ok = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') ||
+             (*c >= '0' && *c <= '9') || *c == '_';
+    if (!ok)
+      return 0;
+  }
+  return 1;
+}
+
+/* Opens one read transaction and declares a forward-only cursor over 'sql'.
+ * The transaction stays pending until pg_cursor_close(); the connection must
+ * not run other work while the cursor lives.
+ * Ownership: borrows everything.
+ * Side effects: leaves a transaction open on success; rolls back on failure.
+ * Error semantics: returns OK/ERR, error stored inside PgImpl.
+ */
+static AdbxStatus pg_cursor_open(DbBackend *db, const char *name,
+                                 const char *sql) {
+  if (!db || !db->impl || !sql || !pg_cursor_name_ok(name))
+    return ERR;
+  PgImpl *p = (PgImpl *)db->impl;
+  if (!p->conn) {
+    pg_set_err(p, "not connected");
+    return ERR;
+  }
+  if (strlen(sql) > PG_QUERY_MAX_BYTES) {
+    pg_set_err(p, "SQL exceeds 8192 bytes (libpq query buffer limit)");
+    return ERR;
+  }
+  if (!(p->policy_applied) && pg_apply_policy(p) != OK)
+    return ERR;
+
+  const char *begin_sql = safety_policy_has(&p->policy, SAFETY_F_READ_ONLY)
+                              ? "BEGIN READ ONLY"
+                              : "BEGIN";
+
+  StrBuf decl;
+  sb_init(&decl);
+  AdbxStatus rc = ERR;
+  if (sb_append_bytes(&decl, "DECLARE ", 8) == OK &&
+      sb_append_bytes(&decl, name, strlen(name)) == OK &&
+      sb_append_bytes(&decl, " NO SCROLL CURSOR FOR ", 22) == OK &&
+      sb_append_bytes(&decl, sql, strlen(sql)) == OK &&
+      sb_append_bytes(&decl, "", 1) == OK) {
+    // BEGIN and DECLARE ride one network flush; when pipeline mode is
+    // unavailable, fall back to the two serial round-trips.
+    const char *cmds[2] = {begin_sql, decl.data};
+    AdbxTriStatus piped = pg_pipeline_commands(p, cmds, NULL, 2);
+    if (piped == YES)
+      rc = OK;
+    else if (piped == NO && pg_exec_command(p, begin_sql) == OK &&
+             pg_exec_command(p, decl.data) == OK)
+      rc = OK;
+  }
+  sb_clean(&decl);
+
+  if (rc != OK) {
+    pg_rollback(p);
+    return ERR;
+  }
+  return OK;
+}
+
+/* Pulls up to 'nrows' rows from the open cursor through the normal exec
+ * materialization path, without opening or closing a transaction. The fetch
+ * count is clamped to the row cap so the policy cannot cancel (and thereby
+ * destroy) the cursor mid-page; the byte cap still can, which surfaces as a
+ * truncated page the caller must treat as end-of-cursor.
+ */
+static AdbxStatus pg_cursor_fetch(DbBackend *db, const char *name,
+                                  uint32_t nrows,
+                                  const QueryResultBuildPolicy *qb_policy,
+                                  QueryResult **out_qr) {
+  if (!db || !db->impl || nrows == 0 || !pg_cursor_name_ok(name))
+    return ERR;
+  PgImpl *p = (PgImpl *)db->impl;
+  if (p->policy.max_rows > 0 && nrows > p->policy.max_rows)
+    nrows = p->policy.max_rows;
+
+  char fetch[96];
+  snprintf(fetch, sizeof(fetch), "FETCH FORWARD %u FROM %s", (unsigned)nrows,
+           name);
+  return pg_exec_impl(db, fetch, NULL, 0, qb_policy, out_qr, 0);
+}
+
+/* Ends the cursor's transaction; the rollback discards the cursor itself. */
+static void pg_cursor_close(DbBackend *db, const char *name) {
+  (void)name; // one cursor per connection; the rollback drops it
+  if (!db || !db->impl)
+    return;
+  PgImpl *p = (PgImpl *)db->impl;
+  if (!p->conn)
+    return;
+  pg_rollback(p);
 }
 
 // This list of functions MUST be sorted ASC.
@@ -2827,22 +3833,68 @@ static const char *PG_SAFE_FUNCS[] = {"abs",
                                       "variance",
                                       "width"};
 
+static DbSafeFuncList pg_safe_func_list = {
+    .names = PG_SAFE_FUNCS,
+    .count = (uint32_t)(sizeof(PG_SAFE_FUNCS) / sizeof(PG_SAFE_FUNCS[0])),
+    .index = NULL};
+
+/* Builds the one-time membership index over PG_SAFE_FUNCS (pthread_once).
+ * Side effects: allocates a process-lifetime HashTable (never destroyed).
+ * Error semantics: best-effort; on failure the index stays NULL and callers
+ * keep binary-searching the sorted name array.
+ */
+static void pg_safe_funcs_index_init(void) {
+  HashTable *ht = ht_create_with_capacity(pg_safe_func_list.count);
+  if (!ht)
+    return;
+  for (uint32_t i = 0; i < pg_safe_func_list.count; i++) {
+    const char *name = PG_SAFE_FUNCS[i];
+    if (ht_put(ht, name, strlen(name), name) != OK) {
+      ht_destroy(ht);
+      return;
+    }
+  }
+  pg_safe_func_list.index = ht;
+}
+
 static const DbSafeFuncList *pg_safe_functions(DbBackend *db) {
   (void)db;
-  static const DbSafeFuncList list = {
-      .names = PG_SAFE_FUNCS,
-      .count = (uint32_t)(sizeof(PG_SAFE_FUNCS) / sizeof(PG_SAFE_FUNCS[0]))};
-  return &list;
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once, pg_safe_funcs_index_init);
+  return &pg_safe_func_list;
 }
 
 /* ------------------------- constructor ------------------------- */
 
+/* VTable adapter declaring the next statement's priority class; see
+ * db_backend.h for the contract. HEAVY is clamped here too (belt and braces —
+ * the broker already caps against the profile policy), so a store of a
+ * not-configured class can never widen the leash. */
+static void pg_set_priority(DbBackend *db, SafetyPriority prio) {
+  if (!db || !db->impl)
+    return;
+  PgImpl *p = (PgImpl *)db->impl;
+  p->next_priority = (uint8_t)safety_policy_clamp_priority(&p->policy, prio);
+}
+
+/* VTable adapter for pg_cancel_inflight(); see db_backend.h for contract. */
+static void pg_cancel(DbBackend *db) {
+  if (!db || !db->impl)
+    return;
+  pg_cancel_inflight((PgImpl *)db->impl);
+}
+
 static const DbBackendVTable PG_VT = {.connect = pg_connect,
                                       .is_connected = pg_is_connected,
                                       .disconnect = pg_disconnect,
                                       .destroy = pg_destroy,
                                       .exec = pg_exec,
                                       .exec_bound = pg_exec_bound,
+                                      .cursor_open = pg_cursor_open,
+                                      .cursor_fetch = pg_cursor_fetch,
+                                      .cursor_close = pg_cursor_close,
+                                      .cancel_inflight = pg_cancel,
+                                      .set_priority = pg_set_priority,
                                       .make_query_ir = pg_make_query_ir,
                                       .safe_functions = pg_safe_functions};
 
@@ -135,10 +135,23 @@ static AdbxTriStatus procid_is_wrapper_name(const char *name) {
   return NO;
 }
 
-AdbxStatus procid_parent_identity(ProcIdentity *out) {
-  if (!out)
-    return ERR;
-
+// Process-lifetime memo of the resolved parent identity. The parent cannot
+// change for a live MCP server (reparenting only happens when it dies, at
+// which point the stored identity must keep naming the original host), so
+// the /proc walks run once and every later consumer reads the cached copy.
+// The first call happens during single-threaded server startup, so no lock
+// is needed.
+static ProcIdentity procid_memo;
+static AdbxTriStatus procid_memo_state = NO; // NO unresolved, YES ok, ERR fail
+
+/* Resolves the parent identity from OS proc interfaces (uncached).
+ * Ownership: writes into caller-owned 'out'; does not allocate.
+ * Side effects: reads '/proc/<pid>/stat' for parent (and grandparent when the
+ * parent looks like a thin launcher wrapper).
+ * Error semantics: returns OK on success, ERR on unsupported platform or parse
+ * I/O failure.
+ */
+static AdbxStatus procid_resolve_parent(ProcIdentity *out) {
 #ifdef __linux__
   pid_t parent_pid = getppid();
   if (parent_pid <= 1)
@@ -166,7 +179,30 @@ AdbxStatus procid_parent_identity(ProcIdentity *out) {
   *out = chosen;
   return OK;
 #else
+  (void)out;
   // TODO: at least, add support for mac
   return ERR;
 #endif
 }
+
+AdbxStatus procid_parent_identity(ProcIdentity *out) {
+  if (!out)
+    return ERR;
+
+  if (procid_memo_state == NO) {
+    ProcIdentity resolved = {0};
+    if (procid_resolve_parent(&resolved) == OK) {
+      procid_memo = resolved;
+      procid_memo_state = YES;
+    } else {
+      // A failed walk is cached too: consumers fail-disable on the first
+      // miss, so retrying on later calls would only hide that decision.
+      procid_memo_state = ERR;
+    }
+  }
+
+  if (procid_memo_state != YES)
+    return ERR;
+  *out = procid_memo;
+  return OK;
+}
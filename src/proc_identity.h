@@ -12,8 +12,11 @@ typedef struct ProcIdentity {
 } ProcIdentity;
 
 /* Resolves a stable identity for the MCP host process launching this server.
+ * The first outcome (success or failure) is cached for the process lifetime,
+ * so every subsystem that needs the identity shares one set of proc walks.
  * Ownership: writes into caller-owned 'out'; does not allocate.
- * Side effects: reads process metadata from OS proc interfaces.
+ * Side effects: reads process metadata from OS proc interfaces on the first
+ * call only.
  * Error semantics: returns OK on success, ERR on unsupported platform or parse
  * I/O failure.
  */
@@ -0,0 +1,330 @@
+#include "qr_wire.h"
+#include "json_codec.h"
+#include "mcp_id.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Wire layout version; bumped together with any field change below.
+#define QR_WIRE_VERSION 1u
+// Cell-length sentinel marking one cell as SQL NULL.
+#define QR_WIRE_NULL UINT32_MAX
+
+/* ------------------------------- encoding -------------------------------- */
+
+static AdbxStatus qrw_put_u8(StrBuf *sb, uint8_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+static AdbxStatus qrw_put_u32(StrBuf *sb, uint32_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+static AdbxStatus qrw_put_u64(StrBuf *sb, uint64_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+/* Appends a u32 length followed by the raw bytes; NULL encodes as length 0
+ * with no bytes (callers that need a NULL/empty distinction use QR_WIRE_NULL
+ * explicitly). */
+static AdbxStatus qrw_put_lenbytes(StrBuf *sb, const char *s, size_t n) {
+  if (n > UINT32_MAX)
+    return ERR;
+  if (qrw_put_u32(sb, (uint32_t)n) != OK)
+    return ERR;
+  if (n == 0)
+    return OK;
+  return sb_append_bytes(sb, s, n);
+}
+
+AdbxStatus qr_wire_encode(const QueryResult *qr, StrBuf *out) {
+  if (!qr || !out)
+    return ERR;
+
+  if (qrw_put_u8(out, QR_WIRE_MARKER) != OK)
+    return ERR;
+  if (qrw_put_u8(out, QR_WIRE_VERSION) != OK)
+    return ERR;
+  if (qrw_put_u8(out, (uint8_t)qr->status) != OK)
+    return ERR;
+  if (qrw_put_u8(out, qr->columnar ? 1u : 0u) != OK)
+    return ERR;
+
+  if (qr->id.kind == MCP_ID_STR) {
+    const char *ids = qr->id.str ? qr->id.str : "";
+    if (qrw_put_u8(out, 1u) != OK)
+      return ERR;
+    if (qrw_put_lenbytes(out, ids, strlen(ids)) != OK)
+      return ERR;
+  } else {
+    if (qrw_put_u8(out, 0u) != OK)
+      return ERR;
+    if (qrw_put_u32(out, qr->id.u32) != OK)
+      return ERR;
+  }
+
+  if (qrw_put_u64(out, qr->exec_ms) != OK)
+    return ERR;
+
+  if (qr->status != QR_OK) {
+    const char *msg = qr->err_msg ? qr->err_msg : "";
+    if (qrw_put_u32(out, (uint32_t)qr->err_code) != OK)
+      return ERR;
+    return qrw_put_lenbytes(out, msg, strlen(msg));
+  }
+
+  if (qrw_put_u32(out, qr->ncols) != OK)
+    return ERR;
+  for (uint32_t c = 0; c < qr->ncols; c++) {
+    const QRColumn *col = qr_get_col(qr, c);
+    const char *name = (col && col->name) ? col->name : "";
+    const char *type = (col && col->type) ? col->type : "";
+    if (qrw_put_lenbytes(out, name, strlen(name)) != OK)
+      return ERR;
+    if (qrw_put_lenbytes(out, type, strlen(type)) != OK)
+      return ERR;
+  }
+
+  if (qrw_put_u32(out, qr->nrows) != OK)
+    return ERR;
+  if (qrw_put_u8(out, qr->result_truncated ? 1u : 0u) != OK)
+    return ERR;
+  if (qrw_put_u64(out, qr->spilled_rows) != OK)
+    return ERR;
+
+  // Cells row-major: raw bytes, no escaping — that is the entire point.
+  for (uint32_t r = 0; r < qr->nrows; r++) {
+    for (uint32_t c = 0; c < qr->ncols; c++) {
+      const char *cell = qr_get_cell(qr, r, c);
+      if (!cell) {
+        if (qrw_put_u32(out, QR_WIRE_NULL) != OK)
+          return ERR;
+        continue;
+      }
+      if (qrw_put_lenbytes(out, cell, strlen(cell)) != OK)
+        return ERR;
+    }
+  }
+  return OK;
+}
+
+/* ------------------------------- decoding -------------------------------- */
+
+/* Bounds-checked read cursor over one untrusted payload. */
+typedef struct QrWireCur {
+  const uint8_t *p;
+  size_t left;
+} QrWireCur;
+
+static AdbxStatus qrw_get_u8(QrWireCur *cur, uint8_t *out) {
+  if (cur->left < sizeof(*out))
+    return ERR;
+  *out = cur->p[0];
+  cur->p += sizeof(*out);
+  cur->left -= sizeof(*out);
+  return OK;
+}
+
+static AdbxStatus qrw_get_u32(QrWireCur *cur, uint32_t *out) {
+  if (cur->left < sizeof(*out))
+    return ERR;
+  memcpy(out, cur->p, sizeof(*out));
+  cur->p += sizeof(*out);
+  cur->left -= sizeof(*out);
+  return OK;
+}
+
+static AdbxStatus qrw_get_u64(QrWireCur *cur, uint64_t *out) {
+  if (cur->left < sizeof(*out))
+    return ERR;
+  memcpy(out, cur->p, sizeof(*out));
+  cur->p += sizeof(*out);
+  cur->left -= sizeof(*out);
+  return OK;
+}
+
+/* Exposes one length-prefixed span in place (no copy). The span is not
+ * NUL-terminated. */
+static AdbxStatus qrw_get_span(QrWireCur *cur, const char **out,
+                               uint32_t *out_len) {
+  uint32_t n = 0;
+  if (qrw_get_u32(cur, &n) != OK)
+    return ERR;
+  if (n > cur->left)
+    return ERR;
+  *out = (const char *)cur->p;
+  *out_len = n;
+  cur->p += n;
+  cur->left -= n;
+  return OK;
+}
+
+/* Copies one raw span into an owned NUL-terminated string. */
+static char *qrw_span_cstr(const char *sp, uint32_t n) {
+  char *s = xmalloc((size_t)n + 1u);
+  memcpy(s, sp, n);
+  s[n] = '\0';
+  return s;
+}
+
+/* Copies one length-prefixed span into an owned NUL-terminated string. */
+static char *qrw_get_cstr(QrWireCur *cur) {
+  const char *sp = NULL;
+  uint32_t n = 0;
+  if (qrw_get_span(cur, &sp, &n) != OK)
+    return NULL;
+  return qrw_span_cstr(sp, n);
+}
+
+/* Rebuilds one QueryResult from the cursor. Returns NULL on malformed input;
+ * trailing bytes after a complete result are also malformed. */
+static QueryResult *qrw_decode(QrWireCur *cur) {
+  uint8_t marker = 0, version = 0, status8 = 0, columnar = 0, id_kind = 0;
+  if (qrw_get_u8(cur, &marker) != OK || marker != QR_WIRE_MARKER)
+    return NULL;
+  if (qrw_get_u8(cur, &version) != OK || version != QR_WIRE_VERSION)
+    return NULL;
+  if (qrw_get_u8(cur, &status8) != OK || status8 > QR_TOOL_ERROR)
+    return NULL;
+  if (qrw_get_u8(cur, &columnar) != OK || qrw_get_u8(cur, &id_kind) != OK)
+    return NULL;
+
+  McpId id = {0};
+  if (id_kind == 1u) {
+    id.kind = MCP_ID_STR;
+    id.str = qrw_get_cstr(cur);
+    if (!id.str)
+      return NULL;
+  } else if (id_kind == 0u) {
+    id.kind = MCP_ID_INT;
+    if (qrw_get_u32(cur, &id.u32) != OK)
+      return NULL;
+  } else {
+    return NULL;
+  }
+
+  QueryResult *qr = NULL;
+  uint64_t exec_ms = 0;
+  if (qrw_get_u64(cur, &exec_ms) != OK)
+    goto fail;
+
+  if ((QRStatus)status8 != QR_OK) {
+    uint32_t code = 0;
+    if (qrw_get_u32(cur, &code) != OK)
+      goto fail;
+    char *msg = qrw_get_cstr(cur);
+    if (!msg)
+      goto fail;
+    qr = ((QRStatus)status8 == QR_ERROR)
+             ? qr_create_err(&id, (QrErrorCode)(int32_t)code, "%s", msg)
+             : qr_create_tool_err(&id, "%s", msg);
+    free(msg);
+    if (!qr)
+      goto fail;
+    qr->exec_ms = exec_ms;
+    goto done;
+  }
+
+  uint32_t ncols = 0;
+  if (qrw_get_u32(cur, &ncols) != OK)
+    goto fail;
+  // Each column costs at least two length prefixes; reject counts the
+  // remaining bytes cannot possibly hold before allocating for them.
+  if ((uint64_t)ncols * 8u > cur->left)
+    goto fail;
+
+  // Column metadata spans precede the row count, so stash them first.
+  const char **meta = ncols ? xcalloc((size_t)ncols * 2u, sizeof(char *))
+                            : NULL;
+  uint32_t *meta_len = ncols ? xcalloc((size_t)ncols * 2u, sizeof(uint32_t))
+                             : NULL;
+  for (uint32_t c = 0; c < ncols; c++) {
+    if (qrw_get_span(cur, &meta[c * 2u], &meta_len[c * 2u]) != OK ||
+        qrw_get_span(cur, &meta[c * 2u + 1u], &meta_len[c * 2u + 1u]) != OK)
+      goto fail_meta;
+  }
+
+  uint32_t nrows = 0;
+  uint8_t truncated = 0;
+  uint64_t spilled = 0;
+  if (qrw_get_u32(cur, &nrows) != OK || qrw_get_u8(cur, &truncated) != OK ||
+      qrw_get_u64(cur, &spilled) != OK)
+    goto fail_meta;
+  if ((uint64_t)nrows * (uint64_t)ncols * 4u > cur->left)
+    goto fail_meta;
+
+  qr = qr_create_ok(&id, ncols, nrows, truncated, 0);
+  if (!qr)
+    goto fail_meta;
+  qr->exec_ms = exec_ms;
+  qr->columnar = columnar ? 1u : 0u;
+  qr->spilled_rows = spilled;
+
+  QueryResultBuilder qb;
+  if (qb_init(&qb, qr, NULL) != OK)
+    goto fail_meta;
+  for (uint32_t c = 0; c < ncols; c++) {
+    // Spans are not NUL-terminated; qb_set_col copies C strings.
+    char *name = qrw_span_cstr(meta[c * 2u], meta_len[c * 2u]);
+    char *type = qrw_span_cstr(meta[c * 2u + 1u], meta_len[c * 2u + 1u]);
+    AdbxStatus crc = qb_set_col(&qb, c, name, type, 0);
+    free(name);
+    free(type);
+    if (crc != OK)
+      goto fail_meta;
+  }
+  free(meta);
+  free(meta_len);
+  meta = NULL;
+  meta_len = NULL;
+
+  for (uint32_t r = 0; r < nrows; r++) {
+    for (uint32_t c = 0; c < ncols; c++) {
+      uint32_t n = 0;
+      if (qrw_get_u32(cur, &n) != OK)
+        goto fail;
+      if (n == QR_WIRE_NULL)
+        continue; // cells start as SQL NULL
+      if (n > cur->left)
+        goto fail;
+      if (qb_set_cell(&qb, r, c, (const char *)cur->p, n) != YES)
+        goto fail;
+      cur->p += n;
+      cur->left -= n;
+    }
+  }
+
+done:
+  if (cur->left != 0)
+    goto fail;
+  mcp_id_clean(&id);
+  return qr;
+
+fail_meta:
+  free(meta);
+  free(meta_len);
+fail:
+  mcp_id_clean(&id);
+  qr_destroy(qr);
+  return NULL;
+}
+
+AdbxStatus qr_wire_to_jsonrpc(const uint8_t *buf, size_t len, char **out_json,
+                              size_t *out_len) {
+  if (!out_json || !out_len)
+    return ERR;
+  *out_json = NULL;
+  *out_len = 0;
+  if (!buf || len == 0)
+    return ERR;
+
+  QrWireCur cur = {.p = buf, .left = len};
+  QueryResult *qr = qrw_decode(&cur);
+  if (!qr)
+    return ERR;
+
+  AdbxStatus rc = qr_to_jsonrpc(qr, out_json, out_len);
+  qr_destroy(qr);
+  return rc;
+}
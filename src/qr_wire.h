@@ -0,0 +1,50 @@
+#ifndef QR_WIRE_H
+#define QR_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "query_result.h"
+#include "string_op.h"
+#include "utils.h"
+
+/* Binary QueryResult encoding for the private broker -> MCP-server hop.
+ *
+ * The broker serializes results as JSON-RPC even though the MCP server mostly
+ * relays, so JSON escaping and number formatting sit on the broker's critical
+ * path. When the server advertises HANDSHAKE_FLAG_BINARY_RESULTS at
+ * handshake, the broker ships small results in this length-prefixed binary
+ * form instead — raw cell bytes, no escaping — and the server transcodes to
+ * JSON just before stdout. Both ends live in one binary, so the encoding is
+ * host-order and versioned by its leading marker byte only.
+ *
+ * The first payload byte QR_WIRE_MARKER can never open a JSON reply ('{') or
+ * a chunk control frame (0x00), so the server detects binary frames without
+ * extra state; an older broker that ignores the flag keeps sending JSON and
+ * the server relays it untouched. Results too large for one frame keep the
+ * chunked JSON path so the server's raw relay/splice keeps working.
+ */
+
+// First payload byte of every binary result; also an invalid UTF-8 lead, so
+// it cannot collide with any JSON reply.
+#define QR_WIRE_MARKER 0xB5u
+
+/* Appends the binary encoding of 'qr' (OK or error result) to 'out'.
+ * Ownership: borrows both; 'out' must be initialized.
+ * Error semantics: returns OK on success, ERR on invalid input or append
+ * failure ('out' may then hold a partial encoding; callers discard it).
+ */
+AdbxStatus qr_wire_encode(const QueryResult *qr, StrBuf *out);
+
+/* Decodes one binary result payload and serializes it as the standard
+ * JSON-RPC reply bytes, exactly as qr_to_jsonrpc() would have produced on
+ * the broker.
+ * Ownership: borrows 'buf'; on success '*out_json' is an owned buffer of
+ * '*out_len' bytes (not NUL-terminated) the caller must free.
+ * Error semantics: returns OK on success, ERR on truncated or malformed
+ * input (outputs are then NULL/0).
+ */
+AdbxStatus qr_wire_to_jsonrpc(const uint8_t *buf, size_t len, char **out_json,
+                              size_t *out_len);
+
+#endif
@@ -21,9 +21,14 @@ AdbxStatus qir_handle_init(QirQueryHandle *h) {
   uint32_t cap = 1048000u; // ~1MB
   if (arena_init(&h->arena, &size, &cap) != OK)
     return ERR;
+  if (spool_init(&h->idents) != OK) {
+    arena_clean(&h->arena);
+    return ERR;
+  }
 
   QirQuery *q = (QirQuery *)arena_calloc(&h->arena, (uint32_t)sizeof(*q));
   if (!q) {
+    spool_clean(&h->idents);
     arena_clean(&h->arena);
     return ERR;
   }
@@ -33,6 +38,7 @@ AdbxStatus qir_handle_init(QirQueryHandle *h) {
   q->status_reason = NULL;
   q->kind = QIR_STMT_SELECT;
   q->limit_value = -1;
+  q->idents = &h->idents;
   h->q = q;
   return OK;
 }
@@ -44,6 +50,7 @@ AdbxStatus qir_handle_init(QirQueryHandle *h) {
 void qir_handle_destroy(QirQueryHandle *h) {
   if (!h)
     return;
+  spool_clean(&h->idents);
   arena_clean(&h->arena);
   h->q = NULL;
 }
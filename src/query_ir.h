@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 #include "arena.h"
+#include "spool.h"
 #include "string_op.h"
 #include "utils.h"
 
@@ -32,6 +33,19 @@ typedef enum QirStmtKind {
   QIR_STMT_SELECT = 1 // only SELECT supported for now
 } QirStmtKind;
 
+// Early structural rejection decided by the backend's cheap pre-pass over
+// the raw AST, before any IR building. These cover rejection classes the
+// validator enforces unconditionally, so the backend may skip IR
+// construction entirely when one fires. QIR_EREJ_NONE means no early
+// decision was reached (the full build + validation still runs); the
+// pre-pass is best-effort and false negatives are fine.
+typedef enum QirEarlyReject {
+  QIR_EREJ_NONE = 0,
+  QIR_EREJ_STAR,                /* SELECT * or alias.* anywhere */
+  QIR_EREJ_NO_TABLE_ALIAS_FROM, /* base relation in FROM without alias */
+  QIR_EREJ_NO_TABLE_ALIAS_JOIN, /* base relation in JOIN without alias */
+} QirEarlyReject;
+
 // Used by validators/touch-extractors to distinguish top-level query scope
 // from any nested query (CTE body, subquery in FROM, scalar subquery, EXISTS,
 // etc.).
@@ -264,6 +278,13 @@ struct QirQuery {
                              // reason why the status is not QIR_OK
   QirStmtKind kind;
 
+  // Set when the backend pre-pass rejected the query before IR building;
+  // the rest of this struct is then empty and must not be walked. The
+  // validator maps this to its usual error code/message.
+  QirEarlyReject early_reject;
+  const char *early_reject_detail; // arena-owned; NULL unless the reject
+                                   // class carries an item description
+
   // Conservative feature flags (backend sets these).
   bool has_star; // SELECT * or table.*
   bool has_distinct;
@@ -302,12 +323,19 @@ struct QirQuery {
   // LIMIT
   // limit_value: -1 means missing.
   int32_t limit_value;
+
+  // Borrowed pool the backend interns identifiers through (handle-owned);
+  // equal identifiers then share one pointer, so the validator can resolve
+  // aliases by address. NULL for hand-built IR, where consumers must fall
+  // back to strcmp.
+  StringPool *idents;
 };
 
 // Handle that owns the arena backing a QueryIR.
 typedef struct QirQueryHandle {
-  Arena arena; // owns all allocations reachable from q
-  QirQuery *q;   // pointer inside arena
+  Arena arena;       // owns all allocations reachable from q
+  StringPool idents; // owns interned identifier strings referenced by q
+  QirQuery *q;       // pointer inside arena
 } QirQueryHandle;
 
 // ----------------------------
@@ -1,4 +1,5 @@
 #include "query_result.h"
+#include "result_spill.h"
 #include "sensitive_tok.h"
 #include "utils.h"
 #include "validator.h"
@@ -19,52 +20,58 @@ static inline AdbxTriStatus idx_ok_set(const QueryResult *qr, uint32_t row,
              : NO;
 }
 
-/* Returns YES if 'row' and 'col' form a valid index to read from cells. */
-static inline AdbxTriStatus idx_ok_get(const QueryResult *qr, uint32_t row,
-                                       uint32_t col) {
-  return (qr && qr->cols && qr->cells && row < qr->nrows && col < qr->ncols)
-             ? YES
-             : NO;
-}
-
-/* Picks one initial size and one hard cap for QueryResult text arena.
+/* Picks one initial size and one hard cap for QueryResult metadata arena.
+ * Cell values live in cell_text; the arena holds column names/types, the
+ * cols array, and the cells index.
  * It borrows no dynamic memory and writes caller-owned outputs.
  * Error semantics: returns OK on success, ERR on invalid output pointers.
  */
 static AdbxStatus qr_pick_text_arena_sizes(uint32_t ncols, uint32_t nrows,
-                                           uint64_t max_query_bytes,
+                                           uint32_t size_hint,
                                            uint32_t *out_init_sz,
                                            uint32_t *out_cap) {
   if (!out_init_sz || !out_cap)
     return ERR;
 
-  // Reserve some space for column metadata strings even for empty result sets.
-  uint64_t meta_est = 512u + ((uint64_t)ncols * 64u);
-
-  uint64_t cap64 = UINT32_MAX;
-  if (max_query_bytes > 0) {
-    cap64 = meta_est + max_query_bytes + 4096u;
-    if (cap64 > UINT32_MAX)
-      cap64 = UINT32_MAX;
+  // Reserve some space for column metadata strings even for empty result
+  // sets, plus the arrays bump-allocated at create time.
+  uint64_t meta_est = 512u + ((uint64_t)ncols * 64u) +
+                      ((uint64_t)ncols * sizeof(QRColumn)) +
+                      ((uint64_t)ncols * (uint64_t)nrows * sizeof(uint32_t));
+
+  uint64_t init64 = meta_est;
+  if (init64 < 1024u)
+    init64 = 1024u;
+  if (init64 > 65536u)
+    init64 = 65536u;
+  // A caller-observed high-water hint may raise the first block past the
+  // default clamp so steady-state results land in one or two blocks.
+  if ((uint64_t)size_hint > init64) {
+    init64 = size_hint;
+    if (init64 > (1u << 22))
+      init64 = (1u << 22);
   }
 
-  uint64_t init64 =
-      meta_est + ((uint64_t)nrows * (uint64_t)ncols * (uint64_t)24u);
-  if (init64 < 4096u)
-    init64 = 4096u;
-  if (init64 > 262144u)
-    init64 = 262144u;
-  if (init64 > cap64)
-    init64 = cap64;
-
-  if (cap64 == 0)
-    return ERR;
+  // Generous cap: names/types are small but not bounded per column, and
+  // qr_reserve_rows() regrows the cells index inside the arena (the old
+  // index stays behind as dead space), so leave ample doubling headroom.
+  uint64_t cap64 = meta_est + (1u << 20) + ((uint64_t)1u << 26);
+  if (cap64 > UINT32_MAX)
+    cap64 = UINT32_MAX;
 
   *out_init_sz = (uint32_t)init64;
   *out_cap = (uint32_t)cap64;
   return OK;
 }
 
+/* Estimates the initial cell_text reservation for 'nrows' x 'ncols' cells. */
+static size_t qr_pick_cell_text_hint(uint32_t ncols, uint32_t nrows) {
+  uint64_t hint = (uint64_t)nrows * (uint64_t)ncols * (uint64_t)24u;
+  if (hint > 262144u)
+    hint = 262144u;
+  return (size_t)hint;
+}
+
 /* Copies one column metadata entry into QueryResult storage.
  * It borrows inputs and mutates caller-owned 'qr'.
  * Side effects: allocates/frees column metadata strings.
@@ -93,7 +100,9 @@ static AdbxStatus qr_set_col(QueryResult *qr, uint32_t col, const char *name,
 
 /* Stores a cell value while enforcing max_query_bytes.
  * It borrows 'value' and mutates caller-owned 'qr'.
- * Side effects: allocates/frees cell strings and updates used_query_bytes.
+ * Side effects: appends to cell_text and updates used_query_bytes.
+ * Overwriting a cell leaves the previous bytes as dead space in cell_text,
+ * same as the arena-backed layout did; builders write each cell once.
  * Error semantics: returns YES on success, NO when byte cap would be exceeded,
  * ERR on invalid input/out-of-bounds/allocation failure.
  */
@@ -110,8 +119,8 @@ static AdbxTriStatus qr_set_cell(QueryResult *qr, uint32_t row, uint32_t col,
   size_t val_len = value ? v_len : 0;
 
   size_t prev_len = 0;
-  if (qr->cells[idx])
-    prev_len = strlen(qr->cells[idx]);
+  if (qr->cells[idx] != QR_CELL_NULL)
+    prev_len = strlen(qr->cell_text.data + qr->cells[idx]);
 
   if (qr->max_query_bytes > 0) {
     uint64_t next_used = qr->used_query_bytes - (uint64_t)prev_len;
@@ -120,12 +129,22 @@ static AdbxTriStatus qr_set_cell(QueryResult *qr, uint32_t row, uint32_t col,
     }
   }
 
-  char *copy =
-      value ? arena_add_nul(&qr->text_arena, (void *)value, val_len) : NULL;
-  if (value && !copy)
-    return ERR;
+  uint32_t new_off = QR_CELL_NULL;
+  if (value) {
+    // Offsets must stay below the QR_CELL_NULL sentinel.
+    if (val_len >= (size_t)UINT32_MAX - 1u ||
+        qr->cell_text.len > (size_t)UINT32_MAX - (val_len + 1u))
+      return ERR;
+    new_off = (uint32_t)qr->cell_text.len;
+    char *dst = NULL;
+    if (sb_prepare_for_write(&qr->cell_text, val_len + 1u, &dst) != OK)
+      return ERR;
+    if (val_len != 0)
+      memcpy(dst, value, val_len);
+    dst[val_len] = '\0';
+  }
 
-  qr->cells[idx] = copy;
+  qr->cells[idx] = new_off;
   qr->used_query_bytes =
       (qr->used_query_bytes - (uint64_t)prev_len) + (uint64_t)val_len;
   return YES;
@@ -154,37 +173,59 @@ AdbxStatus qr_set_id(QueryResult *qr, const McpId *id) {
 
 QueryResult *qr_create_ok(const McpId *id, uint32_t ncols, uint32_t nrows,
                           uint8_t result_truncated, uint64_t max_query_bytes) {
+  return qr_create_ok_sized(id, ncols, nrows, result_truncated,
+                            max_query_bytes, 0);
+}
+
+QueryResult *qr_create_ok_sized(const McpId *id, uint32_t ncols,
+                                uint32_t nrows, uint8_t result_truncated,
+                                uint64_t max_query_bytes,
+                                uint32_t arena_size_hint) {
   QueryResult *qr = xmalloc(sizeof(*qr));
   size_t ncells = (size_t)ncols * (size_t)nrows;
+  uint64_t cols_bytes = (uint64_t)ncols * sizeof(QRColumn);
+  uint64_t cells_bytes = (uint64_t)ncells * sizeof(uint32_t);
   uint32_t arena_init_sz = 0;
   uint32_t arena_cap = 0;
 
-  if (qr_pick_text_arena_sizes(ncols, nrows, max_query_bytes, &arena_init_sz,
+  // The arena addresses at most UINT32_MAX bytes; shapes past that fail here.
+  if (cols_bytes > UINT32_MAX || cells_bytes > UINT32_MAX ||
+      qr_pick_text_arena_sizes(ncols, nrows, arena_size_hint, &arena_init_sz,
                                &arena_cap) != OK) {
     free(qr);
     return NULL;
   }
 
-  qr->cols = (QRColumn *)xcalloc(ncols, sizeof(QRColumn));
-  qr->cells = (char **)xcalloc(ncells, sizeof(char *));
   if (arena_init(&qr->text_arena, &arena_init_sz, &arena_cap) != OK) {
-    free(qr->cells);
-    free(qr->cols);
     free(qr);
     return NULL;
   }
+  // Metadata arrays live in the arena with the column strings, so building
+  // a result is pure bump allocation and qr_destroy() releases everything
+  // in one arena_clean().
+  qr->cols = (QRColumn *)arena_calloc(&qr->text_arena, (uint32_t)cols_bytes);
+  qr->cells = (uint32_t *)arena_alloc(&qr->text_arena, (uint32_t)cells_bytes);
+  if (!qr->cols || !qr->cells) {
+    arena_clean(&qr->text_arena);
+    free(qr);
+    return NULL;
+  }
+  // 0xFF bytes make every offset QR_CELL_NULL (all cells start as SQL NULL).
+  memset(qr->cells, 0xFF, ncells * sizeof(uint32_t));
+  sb_init(&qr->cell_text);
+  (void)sb_reserve(&qr->cell_text, qr_pick_cell_text_hint(ncols, nrows));
 
   qr->id = (McpId){0};
   if (id) {
     if (qr_set_id(qr, id) != OK) {
       arena_clean(&qr->text_arena);
-      free(qr->cells);
-      free(qr->cols);
+      sb_clean(&qr->cell_text);
       free(qr);
       return NULL;
     }
   }
   qr->status = QR_OK;
+  qr->columnar = 0;
   qr->ncols = ncols;
   qr->nrows = nrows;
   qr->nrows_alloc = nrows;
@@ -192,37 +233,80 @@ QueryResult *qr_create_ok(const McpId *id, uint32_t ncols, uint32_t nrows,
   qr->result_truncated = result_truncated;
   qr->max_query_bytes = max_query_bytes;
   qr->used_query_bytes = 0;
+  qr->spill = NULL;
+  qr->spilled_rows = 0;
 
   return qr;
 }
 
-/* Formats one error message from printf-like inputs.
- * It borrows 'fmt' and 'args' and returns a newly allocated C string; caller
- * owns and frees the returned pointer.
- * Side effects: allocates heap memory.
- * Error semantics: returns an allocated empty string when formatting fails.
+AdbxStatus qr_reserve_rows(QueryResult *qr, uint32_t min_rows) {
+  if (!qr || qr->status != QR_OK || qr->ncols == 0)
+    return ERR;
+  if (min_rows <= qr->nrows_alloc)
+    return OK;
+
+  uint32_t new_alloc = qr->nrows_alloc ? qr->nrows_alloc : 16u;
+  while (new_alloc < min_rows) {
+    if (new_alloc > UINT32_MAX / 2u) {
+      new_alloc = min_rows;
+      break;
+    }
+    new_alloc *= 2u;
+  }
+
+  size_t ncells = (size_t)new_alloc * (size_t)qr->ncols;
+  if (ncells / (size_t)qr->ncols != (size_t)new_alloc)
+    return ERR;
+  uint64_t cells_bytes = (uint64_t)ncells * sizeof(uint32_t);
+  if (cells_bytes > UINT32_MAX)
+    return ERR;
+
+  // The index lives in the metadata arena, which cannot realloc in place:
+  // bump a fresh array, copy the live prefix, and leave the old one behind
+  // as dead space (doubling keeps that waste bounded by one generation).
+  uint32_t *cells =
+      (uint32_t *)arena_alloc(&qr->text_arena, (uint32_t)cells_bytes);
+  if (!cells)
+    return ERR;
+  size_t old_cells = (size_t)qr->nrows_alloc * (size_t)qr->ncols;
+  memcpy(cells, qr->cells, old_cells * sizeof(uint32_t));
+  // 0xFF bytes make every new offset QR_CELL_NULL (new cells are SQL NULL).
+  memset(&cells[old_cells], 0xFF, (ncells - old_cells) * sizeof(uint32_t));
+  qr->cells = cells;
+  qr->nrows_alloc = new_alloc;
+  return OK;
+}
+
+/* Formats the error message of 'qr' directly into its in-place storage.
+ * It borrows 'fmt' and 'args' and sets qr->err_msg to qr->err_inline when the
+ * message fits (the common case), otherwise to an owned heap string that
+ * qr_destroy() frees.
+ * Side effects: may allocate heap memory for oversized messages.
+ * Error semantics: stores an empty message when formatting fails.
  */
-static char *qr_format_err_msg(const char *fmt, va_list args) {
+static void qr_format_err_msg(QueryResult *qr, const char *fmt, va_list args) {
   const char *safe_fmt = fmt ? fmt : "";
 
-  va_list args_len;
-  va_copy(args_len, args);
-  int need = vsnprintf(NULL, 0, safe_fmt, args_len);
-  va_end(args_len);
+  // One pass formats and sizes at once; only oversized messages pay a second
+  // pass into a right-sized heap buffer.
+  va_list args_retry;
+  va_copy(args_retry, args);
+  int need = vsnprintf(qr->err_inline, sizeof(qr->err_inline), safe_fmt, args);
 
   if (need < 0) {
-    char *fallback = xmalloc(1);
-    fallback[0] = '\0';
-    return fallback;
-  }
-
-  size_t buf_len = (size_t)need + 1u;
-  char *msg = xmalloc(buf_len);
-  int written = vsnprintf(msg, buf_len, safe_fmt, args);
-  if (written < 0 || (size_t)written >= buf_len) {
-    msg[0] = '\0';
+    qr->err_inline[0] = '\0';
+    qr->err_msg = qr->err_inline;
+  } else if ((size_t)need < sizeof(qr->err_inline)) {
+    qr->err_msg = qr->err_inline;
+  } else {
+    size_t buf_len = (size_t)need + 1u;
+    char *msg = xmalloc(buf_len);
+    int written = vsnprintf(msg, buf_len, safe_fmt, args_retry);
+    if (written < 0 || (size_t)written >= buf_len)
+      msg[0] = '\0';
+    qr->err_msg = msg;
   }
-  return msg;
+  va_end(args_retry);
 }
 
 /* Shared helper for QR_ERROR and QR_TOOL_ERROR.
@@ -245,8 +329,9 @@ static QueryResult *qr_create_err_impl_v(const McpId *id, QRStatus status,
   }
   qr->status = status;
   qr->exec_ms = 0;
+  qr->columnar = 0;
   qr->err_code = code;
-  qr->err_msg = qr_format_err_msg(fmt, args);
+  qr_format_err_msg(qr, fmt, args);
 
   return qr;
 }
@@ -268,6 +353,55 @@ QueryResult *qr_create_tool_err(const McpId *id, const char *fmt, ...) {
   return qr;
 }
 
+QueryResult *qr_clone(const QueryResult *src, const McpId *id) {
+  if (!src)
+    return NULL;
+
+  if (src->status == QR_ERROR || src->status == QR_TOOL_ERROR) {
+    const char *msg = src->err_msg ? src->err_msg : "";
+    QueryResult *qr = (src->status == QR_ERROR)
+                          ? qr_create_err(id, src->err_code, "%s", msg)
+                          : qr_create_tool_err(id, "%s", msg);
+    if (qr)
+      qr->exec_ms = src->exec_ms;
+    return qr;
+  }
+
+  // The byte cap stays off: the source already fit its own cap.
+  QueryResult *qr =
+      qr_create_ok(id, src->ncols, src->nrows, src->result_truncated, 0);
+  if (!qr)
+    return NULL;
+  qr->exec_ms = src->exec_ms;
+  qr->columnar = src->columnar;
+  // spill/spilled_rows stay zero: the spill file belongs to the source's
+  // session, so a clone must not advertise pageable rows it cannot serve.
+
+  QueryResultBuilder qb = {0};
+  if (qb_init(&qb, qr, NULL) != OK)
+    goto fail;
+  for (uint32_t c = 0; c < src->ncols; c++) {
+    const QRColumn *col = qr_get_col(src, c);
+    if (!col || qb_set_col(&qb, c, col->name, col->type, col->pg_oid) != OK)
+      goto fail;
+    // Token cells are copied as-is; keep the marker so they still serialize
+    // as raw JSON strings.
+    qr->cols[c].value_type = col->value_type;
+  }
+  for (uint32_t r = 0; r < src->nrows; r++) {
+    for (uint32_t c = 0; c < src->ncols; c++) {
+      const char *val = qr_get_cell(src, r, c);
+      if (qb_set_cell(&qb, r, c, val, val ? strlen(val) : 0) != YES)
+        goto fail;
+    }
+  }
+  return qr;
+
+fail:
+  qr_destroy(qr);
+  return NULL;
+}
+
 QueryResult *qr_create_msg(const McpId *id, const char *msg) {
   QueryResult *qr = qr_create_ok(id, 1, 1, 0, 0);
   if (!qr)
@@ -289,14 +423,16 @@ void qr_destroy(QueryResult *qr) {
 
   // if it represents an error (protocol or tool)
   if (qr->status == QR_ERROR || qr->status == QR_TOOL_ERROR) {
-    free(qr->err_msg);
+    if (qr->err_msg != qr->err_inline)
+      free(qr->err_msg);
     free(qr);
     return;
   }
 
-  free(qr->cells);
-  free(qr->cols);
+  // cols and cells live inside text_arena; one clean releases them all.
+  sb_clean(&qr->cell_text);
   arena_clean(&qr->text_arena);
+  rspill_destroy(qr->spill);
   free(qr);
 }
 
@@ -388,16 +524,151 @@ AdbxTriStatus qb_set_cell(QueryResultBuilder *qb, uint32_t row, uint32_t col,
   return qr_set_cell(qb->qr, row, col, tok, (size_t)tok_len);
 }
 
-const char *qr_get_cell(const QueryResult *qr, uint32_t row, uint32_t col) {
-  if (!idx_ok_get(qr, row, col))
-    return NULL;
-  size_t idx = (size_t)row * (size_t)qr->ncols + (size_t)col;
-  return qr->cells[idx];
+AdbxTriStatus qb_set_row(QueryResultBuilder *qb, uint32_t row,
+                         const QRCellSpan *cells, uint32_t ncells) {
+  if (!qb || !qb->qr || !cells)
+    return ERR;
+  QueryResult *qr = qb->qr;
+  if (ncells != qr->ncols || !idx_ok_set(qr, row, 0))
+    return ERR;
+
+  if (qb->plan) {
+    // Randomized stores pre-claim the row's token slots in one reservation,
+    // so the per-cell mints append into pre-grown storage (and stay one
+    // reservation per row once stores are shared across workers).
+    // Deterministic stores keep the scalar path: dedupe decides per value.
+    uint32_t ntok = 0;
+    if (qb->store && stok_store_supports_batch(qb->store) == YES) {
+      for (uint32_t c = 0; c < ncells; c++) {
+        const ValidatorColPlan *vcol =
+            (const ValidatorColPlan *)parr_cat(qb->plan->cols, c);
+        if (!vcol)
+          return ERR;
+        if (vcol->kind == VCOL_OUT_TOKEN && cells[c].value)
+          ntok++;
+      }
+    }
+    SensitiveTokBatch batch = {0};
+    int batched = ntok > 0 &&
+                  stok_store_reserve_batch(qb->store, ntok, &batch) == OK;
+    for (uint32_t c = 0; c < ncells; c++) {
+      if (batched) {
+        const ValidatorColPlan *vcol =
+            (const ValidatorColPlan *)parr_cat(qb->plan->cols, c);
+        if (!vcol)
+          return ERR;
+        if (vcol->kind == VCOL_OUT_TOKEN && cells[c].value) {
+          const QRColumn *qcol = qr_get_col(qr, c);
+          if (!qcol)
+            return ERR;
+          SensitiveTokIn in = {
+              .value = cells[c].value,
+              .value_len = (uint32_t)cells[c].len,
+              .col_ref = vcol->col_id,
+              .col_ref_len = vcol->col_id_len,
+              .pg_oid = qcol->pg_oid,
+          };
+          char tok[SENSITIVE_TOK_BUFSZ];
+          int tok_len = stok_batch_fill(qb->store, &batch, qb->generation,
+                                        &in, tok);
+          if (tok_len < 0)
+            return ERR;
+          AdbxTriStatus rc = qr_set_cell(qr, row, c, tok, (size_t)tok_len);
+          if (rc != YES)
+            return rc;
+          continue;
+        }
+      }
+      AdbxTriStatus rc = qb_set_cell(qb, row, c, cells[c].value, cells[c].len);
+      if (rc != YES)
+        return rc;
+    }
+    return YES;
+  }
+
+  uint64_t row_bytes = 0; // payload bytes counted against the cap
+  uint64_t reserve = 0;   // payload plus one NUL per non-NULL cell
+  for (uint32_t c = 0; c < ncells; c++) {
+    if (!cells[c].value) {
+      if (cells[c].len != 0)
+        return ERR;
+      continue;
+    }
+    row_bytes += (uint64_t)cells[c].len;
+    reserve += (uint64_t)cells[c].len + 1u;
+  }
+
+  if (qr->max_query_bytes > 0 &&
+      qr->used_query_bytes + row_bytes > qr->max_query_bytes)
+    return NO;
+  // Offsets must stay below the QR_CELL_NULL sentinel.
+  if (reserve > (uint64_t)UINT32_MAX - 1u ||
+      (uint64_t)qr->cell_text.len > (uint64_t)UINT32_MAX - 1u - reserve)
+    return ERR;
+
+  uint32_t off = (uint32_t)qr->cell_text.len;
+  char *dst = NULL;
+  if (reserve > 0 &&
+      sb_prepare_for_write(&qr->cell_text, (size_t)reserve, &dst) != OK)
+    return ERR;
+
+  size_t base = (size_t)row * (size_t)qr->ncols;
+  for (uint32_t c = 0; c < ncells; c++) {
+    if (!cells[c].value) {
+      qr->cells[base + c] = QR_CELL_NULL;
+      continue;
+    }
+    qr->cells[base + c] = off;
+    if (cells[c].len != 0)
+      memcpy(dst, cells[c].value, cells[c].len);
+    dst[cells[c].len] = '\0';
+    dst += cells[c].len + 1u;
+    off += (uint32_t)cells[c].len + 1u;
+  }
+  qr->used_query_bytes += row_bytes;
+  return YES;
 }
 
-AdbxTriStatus qr_is_null(const QueryResult *qr, uint32_t row, uint32_t col) {
-  if (!idx_ok_get(qr, row, col))
+AdbxStatus qb_spill_cell(QueryResultBuilder *qb, ResultSpill *spill,
+                         uint32_t col, const char *value, size_t v_len) {
+  if (!qb || !qb->qr || !spill)
     return ERR;
-  size_t idx = (size_t)row * (size_t)qr->ncols + (size_t)col;
-  return (qr->cells[idx] == NULL) ? YES : NO;
+  if (!value && v_len != 0)
+    return ERR;
+
+  if (!qb->plan)
+    return rspill_cell(spill, value, v_len);
+
+  const ValidatorColPlan *vcol =
+      (const ValidatorColPlan *)parr_cat(qb->plan->cols, col);
+  if (!vcol)
+    return ERR;
+  if (vcol->kind != VCOL_OUT_TOKEN) {
+    // not sensitive
+    return rspill_cell(spill, value, v_len);
+  }
+
+  // SQL NULL stays NULL even on sensitive columns.
+  if (!value)
+    return rspill_cell(spill, NULL, 0);
+  if (!qb->store)
+    return ERR;
+
+  const QRColumn *qcol = qr_get_col(qb->qr, col);
+  if (!qcol)
+    return ERR;
+
+  SensitiveTokIn in = {
+      .value = value,
+      .value_len = (uint32_t)v_len,
+      .col_ref = vcol->col_id,
+      .col_ref_len = vcol->col_id_len,
+      .pg_oid = qcol->pg_oid,
+  };
+  char tok[SENSITIVE_TOK_BUFSZ];
+  int tok_len = stok_store_create_token(qb->store, qb->generation, &in, tok);
+  if (tok_len < 0)
+    return ERR;
+
+  return rspill_cell(spill, tok, (size_t)tok_len);
 }
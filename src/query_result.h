@@ -6,10 +6,12 @@
 
 #include "arena.h"
 #include "mcp_id.h"
+#include "string_op.h"
 #include "utils.h"
 
 typedef struct ValidatorPlan ValidatorPlan;
 typedef struct DbTokenStore DbTokenStore;
+typedef struct ResultSpill ResultSpill;
 
 typedef enum QRColValueType {
   QRCOL_V_PLAINTEXT = 0,
@@ -36,33 +38,59 @@ typedef enum {
   QRERR_RESOURCE = -30001, // resource (e.g. ConnectionName) not found
 } QrErrorCode;
 
+// Sentinel offset marking one cell as SQL NULL.
+#define QR_CELL_NULL UINT32_MAX
+
+// Inline storage for error messages. Sized to stay within the QR_OK arm of
+// the union below, so carrying it costs error results nothing; messages that
+// fit (the common case) skip the per-result heap allocation entirely.
+#define QR_ERR_MSG_INLINE 120u
+
 /* It's a materialized, DB-agnostic query result. It owns cols and cells. */
 typedef struct QueryResult {
   McpId id; // id of the request
   QRStatus status;
   uint64_t exec_ms; // execution time in ms for both OK and ERROR
+  uint8_t columnar; // 1 = serialize QR_OK rows column-major ("data" object
+                    // of per-column arrays) instead of the "rows" arrays;
+                    // negotiated per request, ignored for error results
 
   union {
     // valid if QR_OK
     struct {
       uint32_t ncols;
-      QRColumn *cols; // malloc'd array of ncols length
+      QRColumn *cols; // array of ncols length, owned by text_arena
 
       uint32_t nrows;
       uint32_t nrows_alloc;      // allocated rows for cells storage
-      char **cells;              // length (nrows_alloc * ncols). To access an
-                                 // element: cells[row*ncols + col];
+      uint32_t *cells;           // owned by text_arena; length
+                                 // (nrows_alloc * ncols) of byte
+                                 // offsets into cell_text (QR_CELL_NULL =
+                                 // SQL NULL). To access an element:
+                                 // cells[row*ncols + col];
       uint8_t result_truncated;  // 1 if output row count is lower than the
                                  // row count of the query executed
       uint64_t max_query_bytes;  // 0 = unlimited
       uint64_t used_query_bytes; // bytes stored across all non-NULL cells
-      Arena text_arena;          // owns column/cell strings for QR_OK
+      StrBuf cell_text;          // owns cell strings (NUL-terminated, laid
+                                 // out in append order) for QR_OK
+      Arena text_arena;          // owns column metadata strings plus the
+                                 // cols and cells arrays for QR_OK
+      ResultSpill *spill;        // owned overflow rows past max_query_bytes;
+                                 // NULL when nothing spilled
+      uint64_t spilled_rows;     // total rows held by the spill (serialized
+                                 // so clients know to page); 0 = no spill
     };
 
     // valid if QR_ERROR or QR_TOOL_ERROR
     struct {
-      char *err_msg;
+      char *err_msg;        // points at err_inline for short messages,
+                            // otherwise an owned heap string
       QrErrorCode err_code; // only meaningful for QR_ERROR
+      char err_inline[QR_ERR_MSG_INLINE]; // in-place message storage; valid
+                                          // because results live at a fixed
+                                          // heap address (never copied by
+                                          // value)
     };
   };
 
@@ -90,6 +118,10 @@ typedef struct QueryResultBuildPolicy {
   const ValidatorPlan *plan;
   DbTokenStore *store;
   uint32_t generation;
+  int spill_dirfd; // borrowed directory fd rooting overflow spill files;
+                   // <= 0 disables spilling
+  uint32_t arena_size_hint; // observed metadata-arena bytes for results on
+                            // this connection; 0 = default arena sizing
 } QueryResultBuildPolicy;
 
 /* Initializes one QueryResultBuilder context.
@@ -121,6 +153,36 @@ AdbxStatus qb_set_col(QueryResultBuilder *qb, uint32_t col, const char *name,
 AdbxTriStatus qb_set_cell(QueryResultBuilder *qb, uint32_t row, uint32_t col,
                           const char *value, size_t v_len);
 
+/* One cell staged for a whole-row append. */
+typedef struct QRCellSpan {
+  const char *value; // NULL = SQL NULL
+  size_t len;
+} QRCellSpan;
+
+/* Stores one whole row of 'ncells' == qb->qr->ncols cells at 'row' in one
+ * pass: a single max_query_bytes check and a single cell_text reservation
+ * cover the batch, then values are bulk-copied. Cells at 'row' must still
+ * be SQL NULL (builders write each row once). When the plan tokenizes
+ * output columns the call falls back to qb_set_cell() per cell so token
+ * minting still applies.
+ *
+ * Returns:
+ *  YES -> success
+ *  NO  -> max_query_bytes reached; no cell of this row was stored
+ *  ERR -> bad input or out-of-bounds
+ */
+AdbxTriStatus qb_set_row(QueryResultBuilder *qb, uint32_t row,
+                         const QRCellSpan *cells, uint32_t ncells);
+
+/* Stages one overflow cell into 'spill' instead of qb->qr.
+ * Applies the same tokenization as qb_set_cell() first, so sensitive values
+ * never reach the spill file in plaintext. If value is NULL, stages SQL NULL.
+ * Side effects: may update qb->store and appends to the spill's staged row.
+ * Returns OK on success, ERR on bad input or tokenization/staging failure.
+ */
+AdbxStatus qb_spill_cell(QueryResultBuilder *qb, ResultSpill *spill,
+                         uint32_t col, const char *value, size_t v_len);
+
 /* Replaces the id stored in 'qr' with a deep copy of 'id'.
  * It borrows both pointers; any previous id storage in 'qr' is released.
  * Side effects: may allocate and free memory when ids are string-backed.
@@ -135,6 +197,22 @@ AdbxStatus qr_set_id(QueryResult *qr, const McpId *id);
 QueryResult *qr_create_ok(const McpId *id, uint32_t ncols, uint32_t nrows,
                           uint8_t result_truncated, uint64_t max_query_bytes);
 
+/* Same as qr_create_ok() but pre-sizes the metadata arena's first block
+ * from 'arena_size_hint' (bytes, clamped; 0 = default sizing). Callers
+ * tracking per-connection result sizes use this so steady-state results
+ * land in one or two blocks instead of walking the doubling ladder. */
+QueryResult *qr_create_ok_sized(const McpId *id, uint32_t ncols,
+                                uint32_t nrows, uint8_t result_truncated,
+                                uint64_t max_query_bytes,
+                                uint32_t arena_size_hint);
+
+/* Grows cell storage of one QR_OK result so at least 'min_rows' rows can be
+ * written (amortized doubling). Existing cells are preserved and new ones
+ * start as SQL NULL; 'qr->nrows' is untouched. Streaming producers create the
+ * result with zero rows and call this while appending.
+ * Returns OK on success, ERR on invalid input or cell-count overflow. */
+AdbxStatus qr_reserve_rows(QueryResult *qr, uint32_t min_rows);
+
 /* Creates a QueryResult that represents a protocol error (JSON-RPC error).
  * 'fmt' uses printf-style formatting; when NULL an empty message is used.
  * If 'id' is NULL, the id field is zeroed. Returns NULL on failure. */
@@ -147,6 +225,13 @@ QueryResult *qr_create_err(const McpId *id, QrErrorCode code,
  * If 'id' is NULL, the id field is zeroed. Returns NULL on failure. */
 QueryResult *qr_create_tool_err(const McpId *id, const char *fmt, ...);
 
+/* Deep-copies 'src' (OK or error) into a fresh QueryResult stamped with 'id'.
+ * The spill is NOT cloned: the copy reports spilled_rows = 0 because the
+ * spill file stays owned by the source's session. exec_ms and columnar are
+ * carried over; callers may override columnar per consumer.
+ * Returns NULL on invalid input or allocation failure. */
+QueryResult *qr_clone(const QueryResult *src, const McpId *id);
+
 /* Creates a QueryResult with a single text column named "message" and one row.
  * If 'id' is NULL, the id field is zeroed. If msg is NULL, stores an empty
  * string. Returns NULL on failure. */
@@ -160,10 +245,25 @@ void qr_destroy(QueryResult *qr);
 const QRColumn *qr_get_col(const QueryResult *qr, uint32_t col);
 
 /* Returns pointer to cell string (owned by qr) or NULL if SQL NULL/out of
- * range. */
-const char *qr_get_cell(const QueryResult *qr, uint32_t row, uint32_t col);
+ * range. The pointer stays valid only until the next cell write, which may
+ * grow cell_text. */
+static inline const char *qr_get_cell(const QueryResult *qr, uint32_t row,
+                                      uint32_t col) {
+  if (!qr || !qr->cols || !qr->cells || row >= qr->nrows || col >= qr->ncols)
+    return NULL;
+  uint32_t off = qr->cells[(size_t)row * (size_t)qr->ncols + (size_t)col];
+  if (off == QR_CELL_NULL)
+    return NULL;
+  return qr->cell_text.data + off;
+}
 
 /* Returns YES if cell is SQL NULL, NO if non-NULL, ERR on error. */
-AdbxTriStatus qr_is_null(const QueryResult *qr, uint32_t row, uint32_t col);
+static inline AdbxTriStatus qr_is_null(const QueryResult *qr, uint32_t row,
+                                       uint32_t col) {
+  if (!qr || !qr->cols || !qr->cells || row >= qr->nrows || col >= qr->ncols)
+    return ERR;
+  uint32_t off = qr->cells[(size_t)row * (size_t)qr->ncols + (size_t)col];
+  return (off == QR_CELL_NULL) ? YES : NO;
+}
 
 #endif
@@ -0,0 +1,185 @@
+#include "result_cache.h"
+#include "perf_counters.h"
+#include "hash_table.h"
+#include "string_op.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct ResultCacheEntry {
+  char *key;      // owned blob: conn_name \0 sql \0 columnar byte
+  size_t key_len; // blob length in bytes
+  uint64_t hash;  // ht_hash_bytes(key, key_len)
+  char *json;     // owned serialized response suffix (not NUL-terminated)
+  size_t json_len;
+  uint64_t expires_at_ms; // now_ms_monotonic() deadline for this slot
+  uint64_t last_used;     // LRU tick; 0 = slot empty
+} ResultCacheEntry;
+
+struct ResultCache {
+  ResultCacheEntry *entries; // owned array of 'capacity' slots
+  uint32_t capacity;
+  uint64_t tick; // monotonically increasing use counter
+};
+
+/* Builds the exact-match lookup key into 'kb' (conn name, SQL text, and one
+ * trailing output-shape byte). The serialized bytes bake the shape in, so
+ * row-major and columnar replies of the same query live in separate slots.
+ * It borrows all inputs and appends to 'kb' (caller initializes/cleans it).
+ * Error semantics: returns OK on success, ERR on invalid input or allocation
+ * failure.
+ */
+static AdbxStatus result_cache_build_key(StrBuf *kb, const char *conn_name,
+                                         const char *sql, uint8_t columnar) {
+  if (!kb || !conn_name || !sql)
+    return ERR;
+
+  if (sb_append_bytes(kb, conn_name, strlen(conn_name) + 1) != OK)
+    return ERR;
+  if (sb_append_bytes(kb, sql, strlen(sql) + 1) != OK)
+    return ERR;
+  char shape = columnar ? 1 : 0;
+  return sb_append_bytes(kb, &shape, 1);
+}
+
+/* Releases everything one slot owns and marks it empty. */
+static void result_cache_entry_clear(ResultCacheEntry *e) {
+  free(e->key);
+  e->key = NULL;
+  e->key_len = 0;
+  e->hash = 0;
+  free(e->json);
+  e->json = NULL;
+  e->json_len = 0;
+  e->expires_at_ms = 0;
+  e->last_used = 0;
+}
+
+/* Returns the slot matching (hash, key blob) or NULL. Verifies the full key
+ * bytes so hash collisions can never hand out a foreign response. */
+static ResultCacheEntry *result_cache_find(ResultCache *rc, uint64_t hash,
+                                           const char *key, size_t key_len) {
+  for (uint32_t i = 0; i < rc->capacity; i++) {
+    ResultCacheEntry *e = &rc->entries[i];
+    if (e->last_used == 0 || e->hash != hash || e->key_len != key_len)
+      continue;
+    if (memcmp(e->key, key, key_len) == 0)
+      return e;
+  }
+  return NULL;
+}
+
+ResultCache *result_cache_create(uint32_t capacity) {
+  if (capacity == 0)
+    capacity = RESULT_CACHE_CAPACITY;
+
+  ResultCache *rc = (ResultCache *)xcalloc(1, sizeof(*rc));
+  rc->entries =
+      (ResultCacheEntry *)xcalloc(capacity, sizeof(*rc->entries));
+  rc->capacity = capacity;
+  return rc;
+}
+
+void result_cache_destroy(ResultCache *rc) {
+  if (!rc)
+    return;
+  for (uint32_t i = 0; i < rc->capacity; i++) {
+    if (rc->entries[i].last_used != 0)
+      result_cache_entry_clear(&rc->entries[i]);
+  }
+  free(rc->entries);
+  free(rc);
+}
+
+AdbxTriStatus result_cache_get(ResultCache *rc, const char *conn_name,
+                               const char *sql, uint8_t columnar,
+                               const char **out_json, size_t *out_len) {
+  if (!rc || !conn_name || !sql || !out_json || !out_len)
+    return ERR;
+  *out_json = NULL;
+  *out_len = 0;
+
+  StrBuf kb;
+  sb_init(&kb);
+  if (result_cache_build_key(&kb, conn_name, sql, columnar) != OK) {
+    sb_clean(&kb);
+    return ERR;
+  }
+
+  uint64_t hash = ht_hash_bytes(kb.data, kb.len);
+  ResultCacheEntry *e = result_cache_find(rc, hash, kb.data, kb.len);
+  sb_clean(&kb);
+  if (!e) {
+    PERF_COUNT(PERF_RESULT_CACHE_MISS);
+    return NO;
+  }
+
+  if (now_ms_monotonic() >= e->expires_at_ms) {
+    // Stale past the profile's tolerance; drop it so the slot frees up.
+    result_cache_entry_clear(e);
+    PERF_COUNT(PERF_RESULT_CACHE_MISS);
+    return NO;
+  }
+
+  e->last_used = ++rc->tick;
+  PERF_COUNT(PERF_RESULT_CACHE_HIT);
+  *out_json = e->json;
+  *out_len = e->json_len;
+  return YES;
+}
+
+void result_cache_put(ResultCache *rc, const char *conn_name, const char *sql,
+                      uint8_t columnar, uint64_t ttl_ms, const char *json,
+                      size_t json_len) {
+  if (!rc || !conn_name || !sql || !json || json_len == 0)
+    return;
+  if (ttl_ms == 0 || json_len > RESULT_CACHE_MAX_ENTRY_BYTES)
+    return;
+
+  StrBuf kb;
+  sb_init(&kb);
+  if (result_cache_build_key(&kb, conn_name, sql, columnar) != OK) {
+    sb_clean(&kb);
+    return;
+  }
+
+  uint64_t hash = ht_hash_bytes(kb.data, kb.len);
+  ResultCacheEntry *e = result_cache_find(rc, hash, kb.data, kb.len);
+  if (e) {
+    // Same key again (e.g. the previous copy just expired mid-flight):
+    // replace the payload and restart the TTL window.
+    free(e->json);
+    e->json = (char *)xmalloc(json_len);
+    memcpy(e->json, json, json_len);
+    e->json_len = json_len;
+    e->expires_at_ms = now_ms_monotonic() + ttl_ms;
+    e->last_used = ++rc->tick;
+    sb_clean(&kb);
+    return;
+  }
+
+  // Pick an empty slot, or evict the least recently used response.
+  ResultCacheEntry *victim = &rc->entries[0];
+  for (uint32_t i = 0; i < rc->capacity; i++) {
+    ResultCacheEntry *cand = &rc->entries[i];
+    if (cand->last_used == 0) {
+      victim = cand;
+      break;
+    }
+    if (cand->last_used < victim->last_used)
+      victim = cand;
+  }
+  if (victim->last_used != 0)
+    result_cache_entry_clear(victim);
+
+  victim->json = (char *)xmalloc(json_len);
+  memcpy(victim->json, json, json_len);
+  victim->json_len = json_len;
+  victim->key = (char *)xmalloc(kb.len);
+  memcpy(victim->key, kb.data, kb.len);
+  victim->key_len = kb.len;
+  victim->hash = hash;
+  victim->expires_at_ms = now_ms_monotonic() + ttl_ms;
+  victim->last_used = ++rc->tick;
+  sb_clean(&kb);
+}
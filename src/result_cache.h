@@ -0,0 +1,54 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+// Fixed number of retained responses; oldest entry is evicted (LRU) once the
+// cache is full.
+#define RESULT_CACHE_CAPACITY 64u
+
+// Largest serialized response one slot may retain; bigger responses are
+// simply not cached. Kept below FRAME_CHUNK_THRESHOLD_BYTES so replays
+// always go out as one plain frame.
+#define RESULT_CACHE_MAX_ENTRY_BYTES (128u * 1024u)
+
+/* Caches serialized run_sql_query responses keyed by connection name, the
+ * executed SQL text, and the requested output shape (row-major vs columnar).
+ * Entries expire after the TTL recorded at put time, so hits may serve data
+ * as stale as that window allows; profiles opt in per connection through the
+ * "resultCacheTtlSeconds" config key. Single-threaded: all calls must come
+ * from the owning event loop. */
+typedef struct ResultCache ResultCache;
+
+/* Creates a ResultCache retaining up to 'capacity' responses (0 = default).
+ * Returns NULL on allocation failure. */
+ResultCache *result_cache_create(uint32_t capacity);
+
+/* Frees 'rc' and every retained response. */
+void result_cache_destroy(ResultCache *rc);
+
+/* Looks up the retained response for (conn_name, sql, columnar).
+ * On a hit, '*out_json'/'*out_len' borrow the slot's bytes; they stay valid
+ * only until the next result_cache_put() or destroy. Expired entries are
+ * cleared lazily and reported as a miss.
+ * Returns YES on a fresh hit, NO on a miss, ERR on invalid input.
+ */
+AdbxTriStatus result_cache_get(ResultCache *rc, const char *conn_name,
+                               const char *sql, uint8_t columnar,
+                               const char **out_json, size_t *out_len);
+
+/* Retains a copy of 'json' under (conn_name, sql, columnar) for 'ttl_ms'
+ * milliseconds, evicting the least recently used entry when full.
+ * It borrows all inputs.
+ * Error semantics: fail-soft; a zero TTL, an oversized payload, or an
+ * allocation failure leaves the cache unchanged and later requests execute
+ * from scratch.
+ */
+void result_cache_put(ResultCache *rc, const char *conn_name, const char *sql,
+                      uint8_t columnar, uint64_t ttl_ms, const char *json,
+                      size_t json_len);
+
+#endif
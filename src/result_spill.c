@@ -0,0 +1,265 @@
+#include "result_spill.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "query_result.h"
+#include "string_op.h"
+#include "utils.h"
+
+// Cell record: u32 byte length (RSPILL_CELL_NULL = SQL NULL) + value bytes.
+// The file never leaves this process, so lengths stay in host order.
+#define RSPILL_CELL_NULL UINT32_MAX
+
+struct ResultSpill {
+  int fd;             // owned unlinked tempfile
+  uint64_t write_off; // next append offset in the file
+  uint64_t max_bytes; // staged cell byte cap; 0 = unlimited
+  uint64_t used_bytes;
+
+  uint64_t nrows;     // committed rows
+  uint64_t *row_offs; // file offset of each committed row
+  uint64_t row_offs_cap;
+
+  uint32_t ncols;
+  QRColumn *cols; // owned deep copy of the source column metadata
+
+  StrBuf rowbuf;        // one row staged before commit
+  uint64_t staged_vals; // staged cell value bytes (cap accounting)
+  uint32_t staged_cells;
+};
+
+/* Opens an unlinked tempfile inside 'dir_fd'. Returns owned fd or -1. */
+static int rspill_open_tmpfile(int dir_fd) {
+#ifdef O_TMPFILE
+  int fd = openat(dir_fd, ".", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd >= 0)
+    return fd;
+  // Fall through: the filesystem may not support O_TMPFILE.
+#endif
+  char name[64];
+  for (int attempt = 0; attempt < 16; attempt++) {
+    snprintf(name, sizeof(name), ".spill-%d-%d", (int)getpid(), attempt);
+    int fd = openat(dir_fd, name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+      if (errno == EEXIST)
+        continue;
+      return -1;
+    }
+    // Unlink immediately; the fd keeps the inode alive and private.
+    (void)unlinkat(dir_fd, name, 0);
+    return fd;
+  }
+  return -1;
+}
+
+ResultSpill *rspill_create(int dir_fd, uint64_t max_bytes) {
+  if (dir_fd < 0)
+    return NULL;
+
+  int fd = rspill_open_tmpfile(dir_fd);
+  if (fd < 0)
+    return NULL;
+
+  ResultSpill *rs = xcalloc(1, sizeof(*rs));
+  rs->fd = fd;
+  rs->max_bytes = max_bytes;
+  sb_init(&rs->rowbuf);
+  return rs;
+}
+
+AdbxStatus rspill_set_cols(ResultSpill *rs, const QueryResult *qr) {
+  if (!rs || !qr || rs->cols || qr->ncols == 0)
+    return ERR;
+
+  rs->cols = xcalloc(qr->ncols, sizeof(QRColumn));
+  rs->ncols = qr->ncols;
+  for (uint32_t c = 0; c < qr->ncols; c++) {
+    const QRColumn *src = qr_get_col(qr, c);
+    const char *name = (src && src->name) ? src->name : "";
+    const char *type = (src && src->type) ? src->type : "";
+
+    size_t name_len = strlen(name);
+    rs->cols[c].name = xmalloc(name_len + 1);
+    memcpy(rs->cols[c].name, name, name_len + 1);
+    size_t type_len = strlen(type);
+    rs->cols[c].type = xmalloc(type_len + 1);
+    memcpy(rs->cols[c].type, type, type_len + 1);
+    rs->cols[c].value_type = src ? src->value_type : QRCOL_V_PLAINTEXT;
+    rs->cols[c].pg_oid = src ? src->pg_oid : 0;
+  }
+  return OK;
+}
+
+AdbxStatus rspill_cell(ResultSpill *rs, const char *value, size_t v_len) {
+  if (!rs || !rs->cols || (!value && v_len != 0))
+    return ERR;
+  if (rs->staged_cells >= rs->ncols)
+    return ERR;
+  if (value && v_len >= (size_t)RSPILL_CELL_NULL)
+    return ERR;
+
+  uint32_t len = value ? (uint32_t)v_len : RSPILL_CELL_NULL;
+  if (sb_append_bytes(&rs->rowbuf, &len, sizeof(len)) != OK)
+    return ERR;
+  if (value && v_len > 0 && sb_append_bytes(&rs->rowbuf, value, v_len) != OK)
+    return ERR;
+
+  if (value)
+    rs->staged_vals += (uint64_t)v_len;
+  rs->staged_cells++;
+  return OK;
+}
+
+/* Drops whatever row is currently staged. */
+static void rspill_row_reset(ResultSpill *rs) {
+  sb_reset(&rs->rowbuf);
+  rs->staged_vals = 0;
+  rs->staged_cells = 0;
+}
+
+AdbxTriStatus rspill_row_commit(ResultSpill *rs) {
+  if (!rs || !rs->cols || rs->staged_cells != rs->ncols)
+    return ERR;
+
+  if (rs->max_bytes > 0 &&
+      rs->used_bytes + rs->staged_vals > rs->max_bytes) {
+    rspill_row_reset(rs);
+    return NO;
+  }
+
+  size_t off = 0;
+  while (off < rs->rowbuf.len) {
+    ssize_t n = pwrite(rs->fd, rs->rowbuf.data + off, rs->rowbuf.len - off,
+                       (off_t)(rs->write_off + off));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      rspill_row_reset(rs);
+      return ERR;
+    }
+    off += (size_t)n;
+  }
+
+  if (rs->nrows >= rs->row_offs_cap) {
+    uint64_t new_cap = rs->row_offs_cap ? rs->row_offs_cap * 2u : 64u;
+    rs->row_offs = xrealloc(rs->row_offs, new_cap * sizeof(uint64_t));
+    rs->row_offs_cap = new_cap;
+  }
+  rs->row_offs[rs->nrows++] = rs->write_off;
+  rs->write_off += rs->rowbuf.len;
+  rs->used_bytes += rs->staged_vals;
+  rspill_row_reset(rs);
+  return YES;
+}
+
+uint64_t rspill_nrows(const ResultSpill *rs) { return rs ? rs->nrows : 0; }
+
+/* Reads 'len' bytes at 'off' fully. Returns OK/ERR. */
+static AdbxStatus rspill_pread_exact(int fd, void *dst, size_t len,
+                                     uint64_t off) {
+  size_t got = 0;
+  while (got < len) {
+    ssize_t n = pread(fd, (char *)dst + got, len - got, (off_t)(off + got));
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return ERR;
+    }
+    if (n == 0)
+      return ERR; // truncated record
+    got += (size_t)n;
+  }
+  return OK;
+}
+
+QueryResult *rspill_fetch_page(const ResultSpill *rs, const McpId *id,
+                               uint64_t start_row, uint32_t max_rows) {
+  if (!rs || !rs->cols || start_row >= rs->nrows)
+    return NULL;
+  if (max_rows == 0)
+    max_rows = RSPILL_DEFAULT_PAGE_ROWS;
+
+  uint64_t left = rs->nrows - start_row;
+  uint32_t n = (left < (uint64_t)max_rows) ? (uint32_t)left : max_rows;
+
+  QueryResult *qr = qr_create_ok(id, rs->ncols, n, 0, 0);
+  if (!qr)
+    return NULL;
+  QueryResultBuilder qb;
+  if (qb_init(&qb, qr, NULL) != OK)
+    goto fail;
+  for (uint32_t c = 0; c < rs->ncols; c++) {
+    if (qb_set_col(&qb, c, rs->cols[c].name, rs->cols[c].type,
+                   rs->cols[c].pg_oid) != OK)
+      goto fail;
+    // Spilled values were tokenized before hitting disk; keep the marker so
+    // token columns still serialize as raw JSON strings.
+    qr->cols[c].value_type = rs->cols[c].value_type;
+  }
+
+  StrBuf cell;
+  sb_init(&cell);
+  for (uint32_t r = 0; r < n; r++) {
+    uint64_t off = rs->row_offs[start_row + r];
+    for (uint32_t c = 0; c < rs->ncols; c++) {
+      uint32_t len = 0;
+      if (rspill_pread_exact(rs->fd, &len, sizeof(len), off) != OK)
+        goto fail_cell;
+      off += sizeof(len);
+
+      if (len == RSPILL_CELL_NULL) {
+        if (qb_set_cell(&qb, r, c, NULL, 0) != YES)
+          goto fail_cell;
+        continue;
+      }
+
+      // empty strings skip the buffer so the cell is still non-NULL
+      const char *val = "";
+      if (len > 0) {
+        char *dst = NULL;
+        cell.len = 0;
+        if (sb_prepare_for_write(&cell, (size_t)len, &dst) != OK)
+          goto fail_cell;
+        if (rspill_pread_exact(rs->fd, dst, len, off) != OK)
+          goto fail_cell;
+        off += len;
+        val = dst;
+      }
+      if (qb_set_cell(&qb, r, c, val, (size_t)len) != YES)
+        goto fail_cell;
+    }
+  }
+  sb_clean(&cell);
+
+  qr->spilled_rows = rs->nrows;
+  qr->result_truncated = (start_row + (uint64_t)n < rs->nrows) ? 1 : 0;
+  return qr;
+
+fail_cell:
+  sb_clean(&cell);
+fail:
+  qr_destroy(qr);
+  return NULL;
+}
+
+void rspill_destroy(ResultSpill *rs) {
+  if (!rs)
+    return;
+  if (rs->fd >= 0)
+    close(rs->fd);
+  if (rs->cols) {
+    for (uint32_t c = 0; c < rs->ncols; c++) {
+      free(rs->cols[c].name);
+      free(rs->cols[c].type);
+    }
+    free(rs->cols);
+  }
+  free(rs->row_offs);
+  sb_clean(&rs->rowbuf);
+  free(rs);
+}
@@ -0,0 +1,69 @@
+#ifndef RESULT_SPILL_H
+#define RESULT_SPILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+typedef struct QueryResult QueryResult;
+typedef struct McpId McpId;
+
+// Default page size served by rspill_fetch_page() when the caller passes 0.
+#define RSPILL_DEFAULT_PAGE_ROWS 200u
+
+/* Overflow row spool for results past max_query_bytes. Rows that no longer
+ * fit in the in-memory QueryResult stream to an unlinked tempfile rooted in
+ * the broker's private run directory, and follow-up page fetches read them
+ * back without re-executing the query. The file holds host-order
+ * length-prefixed cell records (it never leaves this process); per-row file
+ * offsets stay in memory so pages seek directly.
+ */
+typedef struct ResultSpill ResultSpill;
+
+/* Creates an empty spill backed by an unlinked tempfile inside 'dir_fd'
+ * (O_TMPFILE when available, an unlinked named file otherwise).
+ * 'max_bytes' caps the staged cell bytes; 0 means unlimited.
+ * Ownership: the spill owns the file; 'dir_fd' is borrowed for the call.
+ * Returns NULL on invalid input or file creation failure.
+ */
+ResultSpill *rspill_create(int dir_fd, uint64_t max_bytes);
+
+/* Copies the column metadata of 'qr' into the spill so page fetches can
+ * rebuild results with the same columns. Must be called once, before rows.
+ * Returns OK on success, ERR on invalid input or when called twice.
+ */
+AdbxStatus rspill_set_cols(ResultSpill *rs, const QueryResult *qr);
+
+/* Stages one cell of the row being appended; NULL 'value' stores SQL NULL.
+ * Cells must arrive in column order and rspill_row_commit() seals the row.
+ * Returns OK on success, ERR on invalid input or too many cells.
+ */
+AdbxStatus rspill_cell(ResultSpill *rs, const char *value, size_t v_len);
+
+/* Writes the staged row to the file and records its offset.
+ * Returns:
+ *  YES -> row committed
+ *  NO  -> byte cap reached; the staged row is dropped and the caller must
+ *         stop appending
+ *  ERR -> invalid input, wrong cell count, or I/O failure
+ */
+AdbxTriStatus rspill_row_commit(ResultSpill *rs);
+
+/* Returns the number of committed rows (0 on NULL). */
+uint64_t rspill_nrows(const ResultSpill *rs);
+
+/* Builds a QueryResult holding up to 'max_rows' rows starting at 'start_row'
+ * (0 uses RSPILL_DEFAULT_PAGE_ROWS). The result copies column metadata from
+ * the spill, reports the total spilled row count, and sets result_truncated
+ * when rows remain past the page. If 'id' is non-NULL it is deep-copied.
+ * Ownership: caller owns and destroys the returned result.
+ * Returns NULL on invalid input, out-of-range 'start_row', or I/O failure.
+ */
+QueryResult *rspill_fetch_page(const ResultSpill *rs, const McpId *id,
+                               uint64_t start_row, uint32_t max_rows);
+
+/* Closes the backing file and frees all owned memory, 'rs' itself too. */
+void rspill_destroy(ResultSpill *rs);
+
+#endif
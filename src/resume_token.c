@@ -8,6 +8,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,6 +18,7 @@
 #define RESTOK_DIR_NAME "adbxplorer-mcp"
 
 /* Logs and marks resume persistence as disabled for this process.
+ * Once the writer thread is running, callers must hold 'store->lock'.
  * Ownership: borrows 'store' and 'reason'; no allocations.
  * Side effects: updates 'store->enabled' and writes to stderr.
  * Error semantics: none (best-effort logging).
@@ -132,6 +134,44 @@ static AdbxStatus restok_ensure_dir_policy(const char *path) {
   return restok_validate_dir_policy(path);
 }
 
+/* Validates strict directory policy on an already opened dirfd.
+ * Unlike validate_uown_dir() this never chmod-repairs: a drifted mode means
+ * another actor touched the directory and resume must fail-disable.
+ * Ownership: borrows 'fd'; does not allocate.
+ * Side effects: performs one fstat on the cached fd (no path re-walk).
+ * Error semantics: returns OK on strict match, ERR otherwise or when the
+ * directory was unlinked underneath the fd.
+ */
+static AdbxStatus restok_validate_dir_fd(int fd) {
+  if (fd < 0)
+    return ERR;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    return ERR;
+  if (!S_ISDIR(st.st_mode))
+    return ERR;
+  if (st.st_nlink == 0)
+    // the directory was removed after we opened it
+    return ERR;
+  if (st.st_uid != getuid())
+    return ERR;
+  if ((st.st_mode & 0777) != 0700)
+    return ERR;
+  return OK;
+}
+
+/* Returns the token file name relative to the storage directory.
+ * Ownership: borrows 'store'; the pointer aliases 'store->token_path'.
+ * Error semantics: returns NULL on invalid input.
+ */
+static const char *restok_token_name(const ResumeTokenStore *store) {
+  if (!store || !store->token_path)
+    return NULL;
+  const char *slash = strrchr(store->token_path, '/');
+  return slash ? slash + 1 : store->token_path;
+}
+
 /* Validates strict token-file policy: regular file, current uid, mode 0600.
  * Ownership: borrows 'st'; does not allocate.
  * Side effects: none.
@@ -149,26 +189,128 @@ static AdbxStatus restok_validate_token_stat(const struct stat *st) {
   return OK;
 }
 
-/* Deletes 'path' if present.
- * Ownership: borrows 'path'; no allocations.
- * Side effects: performs unlink syscall.
+/* Deletes 'name' inside the opened 'dir_fd' if present.
+ * Ownership: borrows 'name'; no allocations.
+ * Side effects: performs unlinkat syscall.
  * Error semantics: returns OK when absent/deleted, ERR on invalid input or
  * unlink failure.
  */
-static AdbxStatus restok_delete_path(const char *path) {
-  if (!path)
+static AdbxStatus restok_delete_at(int dir_fd, const char *name) {
+  if (dir_fd < 0 || !name)
     return ERR;
-  if (unlink(path) != 0 && errno != ENOENT)
+  if (unlinkat(dir_fd, name, 0) != 0 && errno != ENOENT)
     return ERR;
   return OK;
 }
 
+/* Validates the cached dirfd and writes 'token' with write_atomic.
+ * Runs without 'store->lock': it only touches state that stays immutable
+ * while the store is initialized (dirfd, token name).
+ * Ownership: borrows all inputs; no allocations.
+ * Side effects: one fstat plus an atomic token-file replace.
+ * Error semantics: returns OK on success, ERR with '*out_reason' naming the
+ * disable reason otherwise.
+ */
+static AdbxStatus restok_write_now(const ResumeTokenStore *store,
+                                   const uint8_t token[ADBX_RESUME_TOKEN_LEN],
+                                   const char **out_reason) {
+  const char *name = restok_token_name(store);
+  if (store->dir_fd < 0 || !name) {
+    *out_reason = "token file write failed";
+    return ERR;
+  }
+
+  if (restok_validate_dir_fd(store->dir_fd) != OK) {
+    *out_reason = "directory permissions/ownership are too open";
+    return ERR;
+  }
+
+  // write_atomic replaces the file via a fresh 0600 temp inside the cached
+  // dirfd, so no post-write permission re-check is needed.
+  AdbxTriStatus wrc =
+      write_atomic(store->dir_fd, name, token, ADBX_RESUME_TOKEN_LEN, NULL);
+  if (wrc != YES) {
+    *out_reason =
+        (wrc == NO) ? "token file write contended" : "token file write failed";
+    return ERR;
+  }
+  return OK;
+}
+
+/* Background writer loop: waits for a buffered token, writes it outside the
+ * lock, and repeats. Stores that land while a write runs overwrite the
+ * pending buffer, so a session-churn burst collapses into one disk write.
+ * The last buffered token is drained before a stop request is honored.
+ * Ownership: borrows 'arg' (the store); no allocations.
+ * Side effects: token-file writes; may disable resume on failures.
+ * Error semantics: none (failures fail-disable the store).
+ */
+static void *restok_writer_main(void *arg) {
+  ResumeTokenStore *store = arg;
+
+  pthread_mutex_lock(&store->lock);
+  for (;;) {
+    while (store->writer_stop == NO && store->pending == NO)
+      pthread_cond_wait(&store->cond, &store->lock);
+
+    if (store->pending == YES) {
+      uint8_t token[ADBX_RESUME_TOKEN_LEN];
+      memcpy(token, store->pending_token, sizeof(token));
+      store->pending = NO;
+      store->writing = YES;
+      pthread_mutex_unlock(&store->lock);
+
+      const char *reason = NULL;
+      AdbxStatus wrc = restok_write_now(store, token, &reason);
+
+      pthread_mutex_lock(&store->lock);
+      store->writing = NO;
+      if (wrc != OK) {
+        fprintf(stderr, "Failed to write token file: %s\n", strerror(errno));
+        restok_disable(store, reason);
+        store->pending = NO;
+      }
+      pthread_cond_broadcast(&store->cond);
+      continue; // a newer token may have been buffered during the write
+    }
+
+    if (store->writer_stop == YES)
+      break;
+  }
+  pthread_mutex_unlock(&store->lock);
+  return NULL;
+}
+
+/* Blocks until no token write is buffered or in flight.
+ * Caller must hold 'store->lock'; a no-op when the writer never started.
+ */
+static void restok_flush_locked(ResumeTokenStore *store) {
+  if (store->writer_started != YES)
+    return;
+  while (store->pending == YES || store->writing == YES)
+    pthread_cond_wait(&store->cond, &store->lock);
+}
+
 AdbxTriStatus restok_init(ResumeTokenStore *store) {
   if (!store)
     return ERR;
 
   memset(store, 0, sizeof(*store));
   store->enabled = NO;
+  store->dir_fd = -1;
+
+  if (pthread_mutex_init(&store->lock, NULL) != 0) {
+    fprintf(stderr, "resume_token: failed to initialize writer lock; session "
+                    "resume disabled for this instance\n");
+    return NO;
+  }
+  if (pthread_cond_init(&store->cond, NULL) != 0) {
+    pthread_mutex_destroy(&store->lock);
+    fprintf(stderr, "resume_token: failed to initialize writer lock; session "
+                    "resume disabled for this instance\n");
+    return NO;
+  }
+  store->sync_inited = YES;
 
   ProcIdentity id = {0};
   if (procid_parent_identity(&id) != OK) {
@@ -196,34 +338,68 @@ AdbxTriStatus restok_init(ResumeTokenStore *store) {
     return NO;
   }
 
+  // Validate once and keep the dirfd; later token I/O runs openat-style
+  // against it instead of re-walking and re-checking the path per operation.
+  store->dir_fd =
+      open(store->dir_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+  if (store->dir_fd < 0 || restok_validate_dir_fd(store->dir_fd) != OK) {
+    if (store->dir_fd >= 0) {
+      (void)close(store->dir_fd);
+      store->dir_fd = -1;
+    }
+    restok_disable(store, "directory policy check failed");
+    return NO;
+  }
+
   store->enabled = YES;
+
+  // Deferred token writes need the thread; without it restok_store() falls
+  // back to the synchronous write path.
+  if (pthread_create(&store->writer, NULL, restok_writer_main, store) == 0)
+    store->writer_started = YES;
+
   return YES;
 }
 
-AdbxTriStatus restok_load(ResumeTokenStore *store,
-                          uint8_t out[ADBX_RESUME_TOKEN_LEN]) {
-  if (!store || !out)
-    return ERR;
+/* Loads the persisted token into 'out'; body of restok_load().
+ * Caller must hold 'store->lock' with no token write buffered or in flight.
+ */
+static AdbxTriStatus restok_load_locked(ResumeTokenStore *store,
+                                        uint8_t out[ADBX_RESUME_TOKEN_LEN]) {
   if (store->enabled != YES)
     return NO;
-  if (!store->dir_path || !store->token_path)
+
+  const char *name = restok_token_name(store);
+  if (store->dir_fd < 0 || !name)
     return NO;
 
-  if (restok_validate_dir_policy(store->dir_path) != OK) {
+  if (restok_validate_dir_fd(store->dir_fd) != OK) {
     restok_disable(store, "directory permissions/ownership are too open");
     return NO;
   }
 
-  struct stat st;
-  if (lstat(store->token_path, &st) != 0) {
+  int fd = openat(store->dir_fd, name, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (fd < 0) {
     if (errno == ENOENT)
       // there's no token to be read
       return NO;
+    if (errno == ELOOP || errno == EMLINK) {
+      restok_disable(store, "token file permissions/ownership are too open");
+      return NO;
+    }
+    restok_disable(store, "token file metadata read failed");
+    return NO;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    (void)close(fd);
     restok_disable(store, "token file metadata read failed");
     return NO;
   }
 
   if (restok_validate_token_stat(&st) != OK) {
+    (void)close(fd);
     restok_disable(store, "token file permissions/ownership are too open");
     return NO;
   }
@@ -231,69 +407,90 @@ AdbxTriStatus restok_load(ResumeTokenStore *store,
   if (st.st_size != (off_t)ADBX_RESUME_TOKEN_LEN) {
     // Corrupted token files are treated as stale and removed immediately.
     fprintf(stderr, "Token file corrupted (size mismatch), treating as stale\n");
-    if (restok_delete_path(store->token_path) != OK) {
+    (void)close(fd);
+    if (restok_delete_at(store->dir_fd, name) != OK) {
       restok_disable(store, "failed to delete corrupted token file");
     }
     return NO;
   }
 
-  if (fileio_read_exact(store->token_path, ADBX_RESUME_TOKEN_LEN, out) != OK)
+  AdbxStatus rrc = fileio_read_exact_fd(fd, ADBX_RESUME_TOKEN_LEN, out);
+  if (close(fd) != 0)
+    rrc = ERR;
+  if (rrc != OK)
     return ERR;
   return YES;
 }
 
+AdbxTriStatus restok_load(ResumeTokenStore *store,
+                          uint8_t out[ADBX_RESUME_TOKEN_LEN]) {
+  if (!store || !out)
+    return ERR;
+  if (store->sync_inited != YES)
+    // the store never got past early init, so it is fail-disabled
+    return NO;
+
+  pthread_mutex_lock(&store->lock);
+  restok_flush_locked(store);
+  AdbxTriStatus rc = restok_load_locked(store, out);
+  pthread_mutex_unlock(&store->lock);
+  return rc;
+}
+
 AdbxStatus restok_store(ResumeTokenStore *store,
                         const uint8_t token[ADBX_RESUME_TOKEN_LEN]) {
   if (!store || !token)
     return ERR;
-  if (store->enabled != YES)
+  if (store->sync_inited != YES)
     return OK;
-  if (!store->dir_path || !store->token_path)
-    return ERR;
 
-  if (restok_ensure_dir_policy(store->dir_path) != OK) {
-    restok_disable(store, "directory permissions/ownership are too open");
-    return ERR;
+  pthread_mutex_lock(&store->lock);
+  if (store->enabled != YES) {
+    pthread_mutex_unlock(&store->lock);
+    return OK;
   }
 
-  if (fileio_write_exact(store->token_path, token, ADBX_RESUME_TOKEN_LEN,
-                         0600) != OK) {
-    fprintf(stderr, "Failed to write token file: %s\n", strerror(errno));
-    restok_disable(store, "token file write failed");
-    return ERR;
+  if (store->writer_started == YES) {
+    // Buffer-and-signal only: the disk write happens on the writer thread,
+    // so session establishment never stalls here. A token already buffered
+    // is simply replaced (only the newest one can resume this session).
+    memcpy(store->pending_token, token, ADBX_RESUME_TOKEN_LEN);
+    store->pending = YES;
+    pthread_cond_signal(&store->cond);
+    pthread_mutex_unlock(&store->lock);
+    return OK;
   }
 
-  struct stat st;
-  errno = 0;
-  int src = lstat(store->token_path, &st);
-  if (src == 0 && restok_validate_token_stat(&st) != OK) {
-    restok_disable(store, "token file permissions/ownership are too open");
-    return ERR;
-  }
-  if (src != 0 && errno != ENOENT) {
-    restok_disable(store, "token file metadata read failed");
-    return ERR;
+  // No writer thread: keep the old synchronous behavior.
+  const char *reason = NULL;
+  AdbxStatus rc = restok_write_now(store, token, &reason);
+  if (rc != OK) {
+    fprintf(stderr, "Failed to write token file: %s\n", strerror(errno));
+    restok_disable(store, reason);
   }
-
-  return OK;
+  pthread_mutex_unlock(&store->lock);
+  return rc;
 }
 
-AdbxStatus restok_delete(ResumeTokenStore *store) {
-  if (!store)
-    return ERR;
+/* Deletes the persisted token; body of restok_delete().
+ * Caller must hold 'store->lock' with no token write buffered or in flight.
+ */
+static AdbxStatus restok_delete_locked(ResumeTokenStore *store) {
   if (store->enabled != YES)
     return OK;
-  if (!store->dir_path || !store->token_path)
+
+  const char *name = restok_token_name(store);
+  if (store->dir_fd < 0 || !name)
     return ERR;
 
-  if (restok_validate_dir_policy(store->dir_path) != OK) {
+  if (restok_validate_dir_fd(store->dir_fd) != OK) {
     restok_disable(store, "directory permissions/ownership are too open");
     return ERR;
   }
 
   struct stat st;
   errno = 0;
-  int src = lstat(store->token_path, &st);
+  int src = fstatat(store->dir_fd, name, &st, AT_SYMLINK_NOFOLLOW);
   if (src == 0 && restok_validate_token_stat(&st) != OK) {
     restok_disable(store, "token file permissions/ownership are too open");
     return ERR;
@@ -303,17 +500,66 @@ AdbxStatus restok_delete(ResumeTokenStore *store) {
     return ERR;
   }
 
-  if (restok_delete_path(store->token_path) != OK) {
+  if (restok_delete_at(store->dir_fd, name) != OK) {
     restok_disable(store, "failed to delete token file");
     return ERR;
   }
   return OK;
 }
 
+AdbxStatus restok_delete(ResumeTokenStore *store) {
+  if (!store)
+    return ERR;
+  if (store->sync_inited != YES)
+    return OK;
+
+  pthread_mutex_lock(&store->lock);
+  // A buffered (not yet written) token must not resurrect the file after the
+  // unlink below, so drop it before waiting out any in-flight write.
+  store->pending = NO;
+  restok_flush_locked(store);
+  AdbxStatus rc = restok_delete_locked(store);
+  pthread_mutex_unlock(&store->lock);
+  return rc;
+}
+
+AdbxStatus restok_flush(ResumeTokenStore *store) {
+  if (!store)
+    return ERR;
+  if (store->sync_inited != YES)
+    return OK;
+
+  pthread_mutex_lock(&store->lock);
+  restok_flush_locked(store);
+  pthread_mutex_unlock(&store->lock);
+  return OK;
+}
+
 void restok_clean(ResumeTokenStore *store) {
   if (!store)
     return;
 
+  if (store->sync_inited == YES) {
+    pthread_mutex_lock(&store->lock);
+    int started = store->writer_started;
+    store->writer_stop = YES;
+    pthread_cond_broadcast(&store->cond);
+    pthread_mutex_unlock(&store->lock);
+    if (started == YES)
+      // The writer drains any buffered token before exiting.
+      pthread_join(store->writer, NULL);
+    pthread_mutex_destroy(&store->lock);
+    pthread_cond_destroy(&store->cond);
+    store->sync_inited = NO;
+    store->writer_started = NO;
+    store->writer_stop = NO;
+    store->pending = NO;
+  }
+
+  if (store->dir_fd >= 0)
+    (void)close(store->dir_fd);
+  store->dir_fd = -1;
+
   free(store->dir_path);
   free(store->token_path);
   store->dir_path = NULL;
@@ -1,23 +1,43 @@
 #ifndef RESUME_TOKEN_H
 #define RESUME_TOKEN_H
 
+#include <pthread.h>
 #include <stdint.h>
 
 #include "handshake_codec.h"
 #include "utils.h"
 
-/* All strings are owned by the struct and freed by restok_clean(). */
+/* All strings, the cached dirfd, and the deferred-writer thread are owned by
+ * the struct and released by restok_clean(). */
 typedef struct ResumeTokenStore {
   int enabled;      /* YES when persistence is active, NO when fail-disabled. */
+  int dir_fd;       /* Validated O_DIRECTORY fd for dir_path, -1 when unset.
+                       All token I/O runs openat-style against this fd so the
+                       hot path never re-walks and re-opens the path. */
   char *dir_path;   /* e.g. /run/user/1000/adbxplorer-mcp */
   char *token_path; /* e.g. /run/user/1000/adbxplorer-mcp/token-<pid>-<ts> */
+
+  /* Deferred writer: restok_store() buffers the token under 'lock' and the
+   * background thread performs the disk write, so session establishment
+   * never blocks on disk. Stores that land while a write is in flight just
+   * overwrite 'pending_token' and collapse into one later write. */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t writer;
+  int sync_inited;    /* YES once 'lock'/'cond' are initialized. */
+  int writer_started; /* YES while the writer thread is running. */
+  int writer_stop;    /* YES when restok_clean() asked the writer to exit. */
+  int pending;        /* YES when 'pending_token' awaits its disk write. */
+  int writing;        /* YES while the writer holds a copy outside 'lock'. */
+  uint8_t pending_token[ADBX_RESUME_TOKEN_LEN];
 } ResumeTokenStore;
 
 /* Initializes process-scoped resume-token persistence.
  * Ownership: writes owned paths into caller-owned 'store'. Caller must call
  * restok_clean() exactly once to free owned memory.
- * Side effects: resolves parent identity, creates/validates storage directory,
- * and can log+disable resume when policy checks fail.
+ * Side effects: resolves parent identity, creates/validates the storage
+ * directory and keeps one opened dirfd for later token I/O, and can
+ * log+disable resume when policy checks fail.
  * Error semantics: returns YES when enabled, NO when disabled fail-safe for
  * this process, ERR on invalid input.
  */
@@ -33,16 +53,28 @@ AdbxTriStatus restok_init(ResumeTokenStore *store);
 AdbxTriStatus restok_load(ResumeTokenStore *store,
                           uint8_t out[ADBX_RESUME_TOKEN_LEN]);
 
-/* Stores the provided raw token bytes for this process scope.
+/* Stores the provided raw token bytes for this process scope. The write is
+ * deferred to the background writer (restok_load/delete/flush/clean act as
+ * barriers), so this never blocks on disk; only when the writer thread could
+ * not start does it fall back to a synchronous write.
  * Ownership: borrows 'store' and 'token'; no caller-owned allocations.
- * Side effects: performs filesystem I/O; may disable resume for this process
- * on policy/write failures.
- * Error semantics: returns OK on success or no-op when disabled, ERR on invalid
- * input or write failure.
+ * Side effects: buffers the token and wakes the writer; may disable resume
+ * for this process on policy/write failures (asynchronously on the deferred
+ * path).
+ * Error semantics: returns OK when the token was accepted for persistence or
+ * as a no-op when disabled, ERR on invalid input or synchronous write failure.
  */
 AdbxStatus restok_store(ResumeTokenStore *store,
                         const uint8_t token[ADBX_RESUME_TOKEN_LEN]);
 
+/* Waits until no deferred token write is buffered or in flight.
+ * Ownership: borrows 'store'; no allocations.
+ * Side effects: may block until the writer thread drains its backlog.
+ * Error semantics: returns OK (including as a no-op when the writer never
+ * started), ERR on invalid input.
+ */
+AdbxStatus restok_flush(ResumeTokenStore *store);
+
 /* Deletes the persisted token for this process scope.
  * Ownership: borrows 'store'; no caller-owned allocations.
  * Side effects: performs filesystem I/O.
@@ -51,9 +83,11 @@ AdbxStatus restok_store(ResumeTokenStore *store,
  */
 AdbxStatus restok_delete(ResumeTokenStore *store);
 
-/* Frees any memory owned by 'store' and resets it to empty.
+/* Frees any memory owned by 'store' and resets it to empty. Any buffered
+ * token write is completed before the writer thread is retired.
  * Ownership: consumes internal owned strings but not 'store' itself.
- * Side effects: frees heap memory.
+ * Side effects: joins the writer thread, frees heap memory, and closes the
+ * cached dirfd.
  * Error semantics: none.
  */
 void restok_clean(ResumeTokenStore *store);
@@ -12,7 +12,69 @@ AdbxStatus safety_policy_init(SafetyPolicy *p, int *read_only,
   p->max_rows = max_rows ? *max_rows : 200;
   p->max_payload_bytes = max_payload_bytes ? *max_payload_bytes : 65536; // 64 kb
   p->statement_timeout_ms = statement_timeout_ms ? *statement_timeout_ms : 5000;
+  p->spill_max_bytes = 0;       // opt-in via spillMaxKiloBytes
+  p->result_cache_ttl_secs = 0; // opt-in via resultCacheTtlSeconds
+  p->max_estimated_cost = 0;    // opt-in via maxEstimatedCost
+  p->slow_log_ms = 0;           // opt-in via slowLogMs
+  p->heavy_statement_timeout_ms = 0; // opt-in via heavyStatementTimeoutMs
+  p->heavy_work_mem_kb = 0;          // opt-in via heavyWorkMemKiloBytes
   p->column_mode = SAFETY_COLMODE_PSEUDONYMIZE;
   p->column_strategy = SAFETY_COLSTRAT_RANDOMIZED;
+  return safety_policy_compile(p);
+}
+
+AdbxStatus safety_policy_compile(SafetyPolicy *p) {
+  if (!p)
+    return ERR;
+
+  uint32_t f = 0;
+  if (p->read_only)
+    f |= SAFETY_F_READ_ONLY;
+  if (p->statement_timeout_ms > 0)
+    f |= SAFETY_F_STMT_TIMEOUT;
+  if (p->max_rows > 0)
+    f |= SAFETY_F_MAX_ROWS;
+  if (p->max_payload_bytes > 0)
+    f |= SAFETY_F_PAYLOAD_CAP;
+  if (p->spill_max_bytes > 0)
+    f |= SAFETY_F_SPILL;
+  if (p->result_cache_ttl_secs > 0)
+    f |= SAFETY_F_RESULT_CACHE;
+  if (p->max_estimated_cost > 0)
+    f |= SAFETY_F_COST_CHECK;
+  if (p->slow_log_ms > 0)
+    f |= SAFETY_F_SLOW_LOG;
+  if (p->heavy_statement_timeout_ms > 0)
+    f |= SAFETY_F_HEAVY_PRIO;
+  if (p->column_strategy == SAFETY_COLSTRAT_DETERMINISTIC)
+    f |= SAFETY_F_COL_DETERMINISTIC;
+  p->flags = f;
   return OK;
 }
+
+SafetyPriority safety_policy_clamp_priority(const SafetyPolicy *p,
+                                            SafetyPriority prio) {
+  if (!p)
+    return SAFETY_PRIO_NORMAL;
+  if (prio == SAFETY_PRIO_HEAVY && !safety_policy_has(p, SAFETY_F_HEAVY_PRIO))
+    return SAFETY_PRIO_NORMAL;
+  return prio;
+}
+
+uint32_t safety_policy_priority_timeout_ms(const SafetyPolicy *p,
+                                           SafetyPriority prio) {
+  if (!p)
+    return 0;
+  switch (prio) {
+  case SAFETY_PRIO_FAST:
+    if (p->statement_timeout_ms == 0)
+      return 0;
+    return p->statement_timeout_ms >= 4u ? p->statement_timeout_ms / 4u : 1u;
+  case SAFETY_PRIO_HEAVY:
+    return p->heavy_statement_timeout_ms > 0 ? p->heavy_statement_timeout_ms
+                                             : p->statement_timeout_ms;
+  case SAFETY_PRIO_NORMAL:
+  default:
+    return p->statement_timeout_ms;
+  }
+}
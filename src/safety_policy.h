@@ -14,6 +14,33 @@ typedef enum SafetyColumnStrategy {
   SAFETY_COLSTRAT_RANDOMIZED = 2,
 } SafetyColumnStrategy;
 
+/* Derived feature bits for SafetyPolicy.flags: one "is this knob active?"
+ * answer per knob, compiled once by safety_policy_compile() so per-request
+ * policy questions are a single mask test on one word instead of spread-out
+ * field loads. Never parsed or serialized; recomputed at catalog load. */
+#define SAFETY_F_READ_ONLY (1u << 0)
+#define SAFETY_F_STMT_TIMEOUT (1u << 1)
+#define SAFETY_F_MAX_ROWS (1u << 2)
+#define SAFETY_F_PAYLOAD_CAP (1u << 3)
+#define SAFETY_F_SPILL (1u << 4)
+#define SAFETY_F_RESULT_CACHE (1u << 5)
+#define SAFETY_F_COST_CHECK (1u << 6)
+#define SAFETY_F_SLOW_LOG (1u << 7)
+#define SAFETY_F_COL_DETERMINISTIC (1u << 8)
+#define SAFETY_F_HEAVY_PRIO (1u << 9)
+
+/* Per-request priority class, declared by the tool call and capped by the
+ * profile policy. NORMAL runs with the policy bounds as-is; FAST tightens the
+ * statement timeout for cheap lookups; HEAVY is the opt-in long leash for
+ * exploration queries and exists only on profiles that configure it
+ * (heavyStatementTimeoutMs). The zero value is NORMAL so an undeclared class
+ * changes nothing. */
+typedef enum SafetyPriority {
+  SAFETY_PRIO_NORMAL = 0,
+  SAFETY_PRIO_FAST = 1,
+  SAFETY_PRIO_HEAVY = 2,
+} SafetyPriority;
+
 /*
  * DB-agnostic entity that stores safety knobs. These represent intent, each DB
  * backend decidesvhow to enforce them.
@@ -21,6 +48,8 @@ typedef enum SafetyColumnStrategy {
  * If values different from 'read_only' are 0, it means unlimited.
  */
 typedef struct SafetyPolicy {
+  uint32_t flags; // SAFETY_F_* bitset derived from the fields below; keep in
+                  // sync via safety_policy_compile() after any mutation
   int read_only; // 1 = enforce read-only
   uint32_t statement_timeout_ms;
   uint32_t max_rows; // how many rows the resulting QueryResult
@@ -30,6 +59,30 @@ typedef struct SafetyPolicy {
   uint32_t max_payload_bytes; // maximum total bytes stored across all
                               // cells of a QueryResult. 0 = unlimited.
 
+  uint32_t spill_max_bytes; // cell bytes rows past max_payload_bytes may
+                            // spool to a private tempfile for later page
+                            // fetches. 0 = spilling disabled.
+
+  uint32_t result_cache_ttl_secs; // seconds a serialized run_sql_query
+                                  // response may be replayed to identical
+                                  // requests. 0 = result caching disabled.
+
+  uint32_t max_estimated_cost; // planner cost estimate above which a query
+                               // is refused before execution. 0 = no
+                               // pre-flight check.
+
+  uint32_t slow_log_ms; // total request latency above which the broker
+                        // emits one structured slow-request log line.
+                        // 0 = slow logging disabled.
+
+  uint32_t heavy_statement_timeout_ms; // statement_timeout for HEAVY-class
+                                       // requests. 0 = the heavy class is
+                                       // disabled on this profile and such
+                                       // requests run as NORMAL.
+
+  uint32_t heavy_work_mem_kb; // per-transaction work_mem (kB) granted to
+                              // HEAVY-class requests. 0 = server default.
+
   SafetyColumnMode column_mode;         // e.g. pseudonymize
   SafetyColumnStrategy column_strategy; // deterministic/randomized
 } SafetyPolicy;
@@ -43,4 +96,35 @@ AdbxStatus safety_policy_init(SafetyPolicy *p, int *read_only,
                               uint32_t *max_payload_bytes,
                               uint32_t *statement_timeout_ms);
 
+/*
+ * Recomputes 'p->flags' from the other fields. Call once after the policy is
+ * fully assembled (catalog parse with per-db overrides applied, or snapshot
+ * restore); backends then carry the compiled bits along when they copy the
+ * policy on connect. Returns OK on success, ERR on bad input.
+ */
+AdbxStatus safety_policy_compile(SafetyPolicy *p);
+
+/* Returns nonzero when every bit in 'f' is set in the compiled flags. */
+static inline int safety_policy_has(const SafetyPolicy *p, uint32_t f) {
+  return (p->flags & f) == f;
+}
+
+/*
+ * Caps one requested priority class against what 'p' permits: HEAVY falls
+ * back to NORMAL on profiles that never configured a heavy timeout; FAST and
+ * NORMAL always pass through. Returns the effective class (NORMAL on bad
+ * input).
+ */
+SafetyPriority safety_policy_clamp_priority(const SafetyPolicy *p,
+                                            SafetyPriority prio);
+
+/*
+ * Returns the effective statement timeout (ms) for one priority class: the
+ * policy timeout as-is for NORMAL, a quarter of it (at least 1ms) for FAST,
+ * and heavy_statement_timeout_ms for HEAVY. An unlimited base timeout (0)
+ * stays unlimited for FAST — there is nothing to tighten against.
+ */
+uint32_t safety_policy_priority_timeout_ms(const SafetyPolicy *p,
+                                           SafetyPriority prio);
+
 #endif
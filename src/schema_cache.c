@@ -0,0 +1,216 @@
+#include "schema_cache.h"
+#include "arena.h"
+#include "conn_catalog.h" // CONN_NAME_MAX_LEN
+#include "perf_counters.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct SchemaCacheEntry {
+  char conn_name[CONN_NAME_MAX_LEN + 1];
+  Arena text; // owns the interned strings and the four pointer columns
+  SchemaSnapshot snap;
+  uint64_t expires_at_ms;      // now_ms_monotonic() freshness deadline
+  uint64_t refresh_claimed_ms; // when a background refresh was marked; 0 =
+                               // none in flight
+  uint64_t last_used;          // LRU tick; 0 = slot empty
+} SchemaCacheEntry;
+
+struct SchemaCache {
+  SchemaCacheEntry *entries; // owned array of SCHEMA_CACHE_CAPACITY slots
+  uint64_t ttl_ms;           // 0 = cache disabled
+  uint64_t tick;             // monotonically increasing use counter
+};
+
+// Distinct recent values the interner remembers besides the adjacent one.
+// Type names cycle through a handful of spellings, so a tiny ring catches
+// nearly every repeat without a real string table.
+#define SCHEMA_INTERN_RING 8u
+
+/* Rolling interner state for one snapshot column. */
+typedef struct SchemaIntern {
+  const char *last; // previous row's value (catalog order makes runs common)
+  const char *ring[SCHEMA_INTERN_RING]; // recent distinct values
+  uint32_t ring_len;
+  uint32_t ring_pos;
+} SchemaIntern;
+
+/* Returns an arena-owned copy of 'val', reusing the previous row's string or
+ * a recent distinct one when the bytes match. NULL on arena exhaustion. */
+static const char *schema_intern(Arena *a, SchemaIntern *in, const char *val) {
+  if (in->last && strcmp(in->last, val) == 0)
+    return in->last;
+  for (uint32_t i = 0; i < in->ring_len; i++) {
+    if (strcmp(in->ring[i], val) == 0) {
+      in->last = in->ring[i];
+      return in->ring[i];
+    }
+  }
+
+  const char *copy =
+      (const char *)arena_add_nul(a, (void *)val, (uint32_t)strlen(val));
+  if (!copy)
+    return NULL;
+  in->ring[in->ring_pos] = copy;
+  in->ring_pos = (in->ring_pos + 1u) % SCHEMA_INTERN_RING;
+  if (in->ring_len < SCHEMA_INTERN_RING)
+    in->ring_len++;
+  in->last = copy;
+  return copy;
+}
+
+/* Releases everything one slot owns and marks it empty. */
+static void schema_cache_entry_clear(SchemaCacheEntry *e) {
+  arena_clean(&e->text);
+  memset(e, 0, sizeof(*e));
+}
+
+/* Returns the slot named 'conn_name' or NULL. */
+static SchemaCacheEntry *schema_cache_find(SchemaCache *sc,
+                                           const char *conn_name) {
+  for (uint32_t i = 0; i < SCHEMA_CACHE_CAPACITY; i++) {
+    SchemaCacheEntry *e = &sc->entries[i];
+    if (e->last_used != 0 && strcmp(e->conn_name, conn_name) == 0)
+      return e;
+  }
+  return NULL;
+}
+
+SchemaCache *schema_cache_create(uint64_t ttl_ms) {
+  SchemaCache *sc = (SchemaCache *)xcalloc(1, sizeof(*sc));
+  sc->entries = (SchemaCacheEntry *)xcalloc(SCHEMA_CACHE_CAPACITY,
+                                            sizeof(*sc->entries));
+  sc->ttl_ms = ttl_ms;
+  return sc;
+}
+
+void schema_cache_destroy(SchemaCache *sc) {
+  if (!sc)
+    return;
+  for (uint32_t i = 0; i < SCHEMA_CACHE_CAPACITY; i++) {
+    if (sc->entries[i].last_used != 0)
+      schema_cache_entry_clear(&sc->entries[i]);
+  }
+  free(sc->entries);
+  free(sc);
+}
+
+AdbxTriStatus schema_cache_get(SchemaCache *sc, const char *conn_name,
+                               const SchemaSnapshot **out_snap,
+                               int *out_stale01) {
+  if (!sc || !conn_name || !out_snap || !out_stale01)
+    return ERR;
+  *out_snap = NULL;
+  *out_stale01 = 0;
+
+  SchemaCacheEntry *e =
+      sc->ttl_ms == 0 ? NULL : schema_cache_find(sc, conn_name);
+  if (!e) {
+    PERF_COUNT(PERF_SCHEMA_CACHE_MISS);
+    return NO;
+  }
+
+  e->last_used = ++sc->tick;
+  PERF_COUNT(PERF_SCHEMA_CACHE_HIT);
+  *out_snap = &e->snap;
+  *out_stale01 = now_ms_monotonic() >= e->expires_at_ms;
+  return YES;
+}
+
+AdbxStatus schema_cache_put(SchemaCache *sc, const char *conn_name,
+                            const QueryResult *catalog) {
+  if (!sc || !conn_name || !catalog)
+    return ERR;
+  if (catalog->status != QR_OK || catalog->ncols != SCHEMA_SNAPSHOT_NCOLS)
+    return ERR;
+  size_t name_len = strlen(conn_name);
+  if (name_len == 0 || name_len > CONN_NAME_MAX_LEN)
+    return ERR;
+  if (sc->ttl_ms == 0)
+    return OK; // disabled: describe always re-fetches
+
+  // Reuse the connection's slot, else an empty one, else evict the LRU.
+  SchemaCacheEntry *e = schema_cache_find(sc, conn_name);
+  if (!e) {
+    e = &sc->entries[0];
+    for (uint32_t i = 0; i < SCHEMA_CACHE_CAPACITY; i++) {
+      SchemaCacheEntry *cand = &sc->entries[i];
+      if (cand->last_used == 0) {
+        e = cand;
+        break;
+      }
+      if (cand->last_used < e->last_used)
+        e = cand;
+    }
+  }
+  if (e->last_used != 0)
+    schema_cache_entry_clear(e);
+
+  if (arena_init(&e->text, NULL, NULL) != OK)
+    return ERR;
+
+  uint32_t nrows = catalog->nrows;
+  const char **cols[SCHEMA_SNAPSHOT_NCOLS] = {0};
+  if (nrows > 0) {
+    if (nrows > UINT32_MAX / (SCHEMA_SNAPSHOT_NCOLS * sizeof(char *)))
+      goto fail;
+    for (uint32_t c = 0; c < SCHEMA_SNAPSHOT_NCOLS; c++) {
+      cols[c] = (const char **)arena_alloc(
+          &e->text, (uint32_t)(nrows * sizeof(char *)));
+      if (!cols[c])
+        goto fail;
+    }
+    SchemaIntern interns[SCHEMA_SNAPSHOT_NCOLS] = {0};
+    for (uint32_t r = 0; r < nrows; r++) {
+      for (uint32_t c = 0; c < SCHEMA_SNAPSHOT_NCOLS; c++) {
+        const char *val = qr_get_cell(catalog, r, c);
+        const char *kept =
+            schema_intern(&e->text, &interns[c], val ? val : "");
+        if (!kept)
+          goto fail;
+        cols[c][r] = kept;
+      }
+    }
+  }
+
+  memcpy(e->conn_name, conn_name, name_len + 1);
+  e->snap.nrows = nrows;
+  e->snap.schemas = cols[0];
+  e->snap.tables = cols[1];
+  e->snap.columns = cols[2];
+  e->snap.types = cols[3];
+  e->snap.fetched_ms = now_ms_monotonic();
+  e->expires_at_ms = e->snap.fetched_ms + sc->ttl_ms;
+  e->refresh_claimed_ms = 0;
+  e->last_used = ++sc->tick;
+  return OK;
+
+fail:
+  schema_cache_entry_clear(e);
+  return ERR;
+}
+
+AdbxTriStatus schema_cache_mark_refresh(SchemaCache *sc,
+                                        const char *conn_name) {
+  if (!sc || !conn_name)
+    return ERR;
+  SchemaCacheEntry *e = schema_cache_find(sc, conn_name);
+  if (!e)
+    return ERR;
+
+  uint64_t now = now_ms_monotonic();
+  if (e->refresh_claimed_ms != 0 &&
+      now < e->refresh_claimed_ms + SCHEMA_CACHE_REFRESH_HOLDOFF_MS)
+    return NO;
+  e->refresh_claimed_ms = now;
+  return YES;
+}
+
+void schema_cache_reset(SchemaCache *sc) {
+  if (!sc)
+    return;
+  for (uint32_t i = 0; i < SCHEMA_CACHE_CAPACITY; i++) {
+    if (sc->entries[i].last_used != 0)
+      schema_cache_entry_clear(&sc->entries[i]);
+  }
+}
@@ -0,0 +1,100 @@
+#ifndef SCHEMA_CACHE_H
+#define SCHEMA_CACHE_H
+
+#include <stdint.h>
+
+#include "query_result.h"
+#include "utils.h"
+
+// Fixed number of retained snapshots (one per connection name); the least
+// recently used entry is evicted once the cache is full.
+#define SCHEMA_CACHE_CAPACITY 16u
+
+// Columns every snapshot carries, in order: table_schema, table_name,
+// column_name, data_type. The catalog query below selects exactly these.
+#define SCHEMA_SNAPSHOT_NCOLS 4u
+
+// Default snapshot freshness window; the broker overrides it from
+// ADBX_SCHEMA_TTL_MS (0 = caching disabled, every describe re-fetches).
+#define SCHEMA_CACHE_DEFAULT_TTL_MS (5u * 60u * 1000u)
+
+// Once a refresh is marked in flight, further marks are refused for this
+// long, so a failed background re-fetch self-heals instead of wedging the
+// entry in a permanent "refreshing" state.
+#define SCHEMA_CACHE_REFRESH_HOLDOFF_MS 10000u
+
+/* The one batched catalog query a snapshot is built from. Ordered so rows
+ * for one table are adjacent (the interner leans on that) and agents read
+ * columns in declaration order. System schemas are excluded; what remains
+ * is still subject to the connection's database-side grants. */
+#define SCHEMA_CATALOG_SQL                                                    \
+  "SELECT table_schema, table_name, column_name, data_type "                  \
+  "FROM information_schema.columns "                                          \
+  "WHERE table_schema NOT IN ('pg_catalog', 'information_schema') "           \
+  "ORDER BY table_schema, table_name, ordinal_position"
+
+/* One immutable, interned view of a connection's schema: four parallel
+ * columns of 'nrows' strings, index-aligned with the catalog query above.
+ * Repeated values (every column of one table shares its schema and table
+ * strings; type names recur constantly) point at one shared interned copy,
+ * so a snapshot costs roughly the distinct text plus one pointer per cell.
+ * Storage is owned by the cache entry; borrowed pointers stay valid until
+ * the entry is replaced, evicted, or the cache is destroyed. */
+typedef struct SchemaSnapshot {
+  uint32_t nrows;
+  const char **schemas;
+  const char **tables;
+  const char **columns;
+  const char **types;
+  uint64_t fetched_ms; // now_ms_monotonic() when the snapshot was built
+} SchemaSnapshot;
+
+/* Caches one SchemaSnapshot per connection name so describe calls are served
+ * from broker memory instead of re-running catalog queries. Entries turn
+ * stale after the TTL but keep serving (stale-while-revalidate): the caller
+ * is told the snapshot expired and launches one background re-fetch while
+ * agents keep getting instant answers. Single-threaded: all calls must come
+ * from the owning event loop. */
+typedef struct SchemaCache SchemaCache;
+
+/* Creates a SchemaCache whose snapshots stay fresh for 'ttl_ms'.
+ * A zero TTL disables the cache: puts are dropped and gets always miss.
+ * Returns NULL on allocation failure. */
+SchemaCache *schema_cache_create(uint64_t ttl_ms);
+
+/* Frees 'sc' and every retained snapshot. Safe on NULL. */
+void schema_cache_destroy(SchemaCache *sc);
+
+/* Looks up the snapshot for 'conn_name'.
+ * On a hit '*out_snap' borrows the entry (valid until the next put/evict)
+ * and '*out_stale01' reports whether the TTL lapsed — stale snapshots are
+ * still served; the caller should trigger a background refresh.
+ * Returns YES on a hit (fresh or stale), NO on a miss, ERR on invalid input.
+ */
+AdbxTriStatus schema_cache_get(SchemaCache *sc, const char *conn_name,
+                               const SchemaSnapshot **out_snap,
+                               int *out_stale01);
+
+/* Builds and retains a snapshot for 'conn_name' from one catalog QueryResult
+ * (QR_OK with SCHEMA_SNAPSHOT_NCOLS columns; NULL cells intern as "").
+ * Replaces any previous snapshot, restarts the TTL window, and clears the
+ * entry's in-flight refresh mark; evicts the least recently used entry when
+ * the cache is full. It borrows all inputs.
+ * Returns OK on success, ERR on invalid input or a malformed result.
+ */
+AdbxStatus schema_cache_put(SchemaCache *sc, const char *conn_name,
+                            const QueryResult *catalog);
+
+/* Claims the refresh slot for 'conn_name' ahead of a background re-fetch.
+ * Returns YES when the caller should launch the refresh, NO when one is
+ * already in flight (claimed within the holdoff window), ERR on invalid
+ * input. The mark clears on the next put, or lapses after
+ * SCHEMA_CACHE_REFRESH_HOLDOFF_MS when the refresh never lands. */
+AdbxTriStatus schema_cache_mark_refresh(SchemaCache *sc,
+                                        const char *conn_name);
+
+/* Drops every retained snapshot (catalog reload: connection names may now
+ * point at different databases). Safe on NULL. */
+void schema_cache_reset(SchemaCache *sc);
+
+#endif
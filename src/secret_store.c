@@ -1,10 +1,12 @@
 #include "secret_store.h"
 
+#include "arena.h"
 #include "config_dir.h"
 #include "file_io.h"
 
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -480,6 +482,204 @@ cleanup:
   return rc;
 }
 
+/* --------------------------- session secret cache -------------------------
+ * Decorator over the selected backend that keeps unlocked credentials in
+ * memory for the lifetime of the process, so repeated lookups for the same
+ * connection (e.g. pool reconnects) do not re-run the backend's unlock and
+ * lookup work. Mutating calls drop the whole cache before reaching the
+ * backend. All cached bytes live in one arena that is zeroized before every
+ * release, so shutdown leaves no secret residue on the heap.
+ */
+
+typedef struct {
+  const char *cred_namespace; // arena-owned copy
+  const char *connection_name;
+  const char *secret; // arena-owned, NUL-terminated
+  size_t secret_len;  // bytes excluding the NUL
+} SstoreCacheEntry;
+
+typedef struct {
+  SecretStore base; // must stay first: callers only hold SecretStore*
+  SecretStore *inner;
+  SstoreCacheEntry *entries;
+  size_t n_entries;
+  size_t cap_entries;
+  Arena arena; // owns every cached string; zeroized before release
+  // Guards entries/arena so concurrent reads stay safe per the SecretStore
+  // contract. The inner backend is called with the lock released, so parallel
+  // readers still overlap their backend round trips.
+  pthread_mutex_t lock;
+} SstoreCached;
+
+/* Zeroizes and releases every cached secret, keeping the wrapper usable. */
+static void sstore_cache_drop(SstoreCached *c) {
+  arena_zero_mem(&c->arena);
+  arena_clean(&c->arena);
+  (void)arena_init(&c->arena, NULL, NULL);
+  free(c->entries);
+  c->entries = NULL;
+  c->n_entries = 0;
+  c->cap_entries = 0;
+}
+
+static SstoreCacheEntry *sstore_cache_find(SstoreCached *c,
+                                           const SecretRefInfo *ref) {
+  for (size_t i = 0; i < c->n_entries; i++) {
+    SstoreCacheEntry *e = &c->entries[i];
+    if (strcmp(e->cred_namespace, ref->cred_namespace) == 0 &&
+        strcmp(e->connection_name, ref->connection_name) == 0) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+/* Best-effort insert: on arena exhaustion the secret simply stays uncached
+ * and the next get pays the backend again. */
+static void sstore_cache_put(SstoreCached *c, const SecretRefInfo *ref,
+                             const char *secret, size_t secret_len) {
+  if (c->n_entries == c->cap_entries) {
+    size_t cap = c->cap_entries ? c->cap_entries * 2 : 8;
+    c->entries =
+        (SstoreCacheEntry *)xrealloc(c->entries, cap * sizeof(*c->entries));
+    c->cap_entries = cap;
+  }
+
+  const char *ns = (const char *)arena_add_nul(
+      &c->arena, (void *)ref->cred_namespace,
+      (uint32_t)strlen(ref->cred_namespace));
+  const char *name = (const char *)arena_add_nul(
+      &c->arena, (void *)ref->connection_name,
+      (uint32_t)strlen(ref->connection_name));
+  const char *sec =
+      (const char *)arena_add_nul(&c->arena, (void *)secret,
+                                  (uint32_t)secret_len);
+  if (!ns || !name || !sec)
+    return;
+
+  c->entries[c->n_entries++] =
+      (SstoreCacheEntry){ns, name, sec, secret_len};
+}
+
+static AdbxTriStatus sstore_cached_get(SecretStore *base,
+                                       const SecretRefInfo *ref, StrBuf *out) {
+  SstoreCached *c = (SstoreCached *)base;
+  int ref_ok = ref && ref->cred_namespace && ref->connection_name && out;
+
+  if (ref_ok) {
+    pthread_mutex_lock(&c->lock);
+    SstoreCacheEntry *e = sstore_cache_find(c, ref);
+    if (e) {
+      // Copy while holding the lock: a concurrent mutation may drop the
+      // arena the entry points into.
+      sb_zero_clean(out);
+      sb_init(out);
+      AdbxStatus arc = sb_append_bytes(out, e->secret, e->secret_len + 1);
+      pthread_mutex_unlock(&c->lock);
+      return (arc == OK) ? YES : ERR;
+    }
+    pthread_mutex_unlock(&c->lock);
+  }
+
+  // Malformed refs fall through so the backend reports its own input error.
+  AdbxTriStatus rc = secret_store_get(c->inner, ref, out);
+  if (rc == YES && ref_ok && out->data) {
+    pthread_mutex_lock(&c->lock);
+    if (!sstore_cache_find(c, ref)) // another reader may have raced us here
+      sstore_cache_put(c, ref, out->data, strlen(out->data));
+    pthread_mutex_unlock(&c->lock);
+  }
+  return rc;
+}
+
+/* Mutations drop the cache under the lock, then reach the backend with it
+ * released. Concurrent get/mutate of the same ref stays last-writer-wins;
+ * the documented single-writer discipline already rules that out. */
+static AdbxStatus sstore_cached_set(SecretStore *base, const SecretRefInfo *ref,
+                                    const char *secret) {
+  SstoreCached *c = (SstoreCached *)base;
+  pthread_mutex_lock(&c->lock);
+  sstore_cache_drop(c);
+  pthread_mutex_unlock(&c->lock);
+  return secret_store_set(c->inner, ref, secret);
+}
+
+static AdbxStatus sstore_cached_delete(SecretStore *base,
+                                       const SecretRefInfo *ref) {
+  SstoreCached *c = (SstoreCached *)base;
+  pthread_mutex_lock(&c->lock);
+  sstore_cache_drop(c);
+  pthread_mutex_unlock(&c->lock);
+  return secret_store_delete(c->inner, ref);
+}
+
+static AdbxStatus sstore_cached_wipe_namespace(SecretStore *base,
+                                               const char *cred_namespace) {
+  SstoreCached *c = (SstoreCached *)base;
+  pthread_mutex_lock(&c->lock);
+  sstore_cache_drop(c);
+  pthread_mutex_unlock(&c->lock);
+  return secret_store_wipe_namespace(c->inner, cred_namespace);
+}
+
+static AdbxStatus sstore_cached_wipe_all(SecretStore *base) {
+  SstoreCached *c = (SstoreCached *)base;
+  pthread_mutex_lock(&c->lock);
+  sstore_cache_drop(c);
+  pthread_mutex_unlock(&c->lock);
+  return secret_store_wipe_all(c->inner);
+}
+
+static void sstore_cached_destroy(SecretStore *base) {
+  if (!base)
+    return;
+  SstoreCached *c = (SstoreCached *)base;
+  arena_zero_mem(&c->arena);
+  arena_clean(&c->arena);
+  free(c->entries);
+  pthread_mutex_destroy(&c->lock);
+  secret_store_destroy(c->inner);
+  free(c);
+}
+
+static const char *sstore_cached_last_error(SecretStore *base) {
+  SstoreCached *c = (SstoreCached *)base;
+  return secret_store_last_error(c->inner);
+}
+
+static SecretStoreErrCode sstore_cached_last_error_code(SecretStore *base) {
+  SstoreCached *c = (SstoreCached *)base;
+  return secret_store_last_error_code(c->inner);
+}
+
+static const SecretStoreVTable SSTORE_CACHED_VT = {
+    .get = sstore_cached_get,
+    .set = sstore_cached_set,
+    .delete = sstore_cached_delete,
+    .wipe_namespace = sstore_cached_wipe_namespace,
+    .wipe_all = sstore_cached_wipe_all,
+    .destroy = sstore_cached_destroy,
+    .last_error = sstore_cached_last_error,
+    .last_error_code = sstore_cached_last_error_code,
+};
+
+/* Wraps 'inner' in the session cache; ownership of 'inner' transfers to the
+ * wrapper. Returns 'inner' unwrapped when the wrapper cannot be set up. */
+static SecretStore *sstore_cache_wrap(SecretStore *inner) {
+  if (!inner)
+    return NULL;
+  SstoreCached *c = (SstoreCached *)xcalloc(1, sizeof(*c));
+  if (arena_init(&c->arena, NULL, NULL) != OK ||
+      pthread_mutex_init(&c->lock, NULL) != 0) {
+    arena_clean(&c->arena);
+    free(c);
+    return inner;
+  }
+  c->base.vt = &SSTORE_CACHED_VT;
+  c->inner = inner;
+  return &c->base;
+}
+
 SecretStore *secret_store_create(char **out_err) {
 #ifdef DUMMY_SECRET_STORE_WARNING
   (void)out_err;
@@ -492,12 +692,12 @@ SecretStore *secret_store_create(char **out_err) {
     return NULL;
 
   if (store)
-    return store;
+    return sstore_cache_wrap(store);
 
   if (sstore_open_selected_kind(kind, &store, out_err) != OK)
     return NULL;
 
-  return store;
+  return sstore_cache_wrap(store);
 }
 
 void secret_store_destroy(SecretStore *store) {
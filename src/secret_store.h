@@ -63,6 +63,9 @@ struct SecretStore {
 };
 
 /* Creates one SecretStore instance using the backend selected for this machine.
+ * The returned store caches unlocked credentials in memory for its lifetime,
+ * so repeated gets for the same ref skip the backend; mutating calls drop the
+ * cache and the cached bytes are zeroized on destroy.
  * On success, caller owns the returned store and must destroy it.
  * Returns NULL when no backend can be initialized safely; if 'out_err' is not
  * NULL, it may receive one heap-allocated diagnostic string that caller must
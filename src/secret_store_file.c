@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -48,6 +49,10 @@ typedef struct {
   SecretEntryList cache;
   FileMeta cache_meta;
   int cache_loaded;
+  // Serializes every vtable operation: gets may swap 'cache' through
+  // ss_refresh_if_changed(), so the documented concurrent-read support needs
+  // one in-process lock around each call.
+  pthread_mutex_t op_lock;
   SecretStoreErrCode last_err_code;
   char last_err_msg[256];
 } FileSecretStore;
@@ -869,28 +874,28 @@ static AdbxStatus ss_load_list_from_fd(FileSecretStore *store, int file_fd,
   if (!store || file_fd < 0 || !out_list)
     return ERR;
 
-  StrBuf sb;
-  sb_init(&sb);
-
-  if (fileio_sb_read_limit_fd(file_fd, SS_FILE_MAX_BYTES, &sb) != OK) {
+  // Map instead of copying: parsing runs over the mapped file bytes and no
+  // heap copy of the whole credentials file exists to wipe afterwards.
+  FileMap map;
+  if (fileio_map_ro_fd(file_fd, SS_FILE_MAX_BYTES, &map) != OK) {
     ss_set_err(store, SSERR_CRED_FILE,
                "secret-store read failed: unable to read credentials file "
                "(size limit %u bytes).",
                (unsigned)SS_FILE_MAX_BYTES);
-    sb_clean(&sb);
     return ERR;
   }
 
-  if (sb.len == 0) {
+  if (map.len == 0) {
     ss_set_err(store, SSERR_PARSE,
                "credentials file is empty. Fix credentials.json with valid "
                "JSON: {\"version\":\"1\",\"entries\":[]}.");
-    sb_clean(&sb);
+    fileio_map_clean(&map);
     return ERR;
   }
 
-  AdbxStatus rc = ss_parse_entries_json(store, sb.data, sb.len, out_list);
-  sb_zero_clean(&sb);
+  AdbxStatus rc =
+      ss_parse_entries_json(store, (const char *)map.data, map.len, out_list);
+  fileio_map_clean(&map);
   return rc;
 }
 
@@ -1011,9 +1016,9 @@ static AdbxStatus ss_persist_and_swap(FileSecretStore *store,
  * Error semantics: returns YES when found, NO when missing, ERR on invalid
  * input, policy, I/O, parse, or allocation failures.
  */
-static AdbxTriStatus secret_store_file_get(SecretStore *base,
-                                           const SecretRefInfo *ref,
-                                           StrBuf *out) {
+static AdbxTriStatus secret_store_file_get_impl(SecretStore *base,
+                                                const SecretRefInfo *ref,
+                                                StrBuf *out) {
   if (!base)
     return ERR;
 
@@ -1060,9 +1065,9 @@ static AdbxTriStatus secret_store_file_get(SecretStore *base,
  * Error semantics: returns OK on success, ERR on invalid input, policy,
  * I/O, parse, or allocation failures.
  */
-static AdbxStatus secret_store_file_set(SecretStore *base,
-                                        const SecretRefInfo *ref,
-                                        const char *secret) {
+static AdbxStatus secret_store_file_set_impl(SecretStore *base,
+                                             const SecretRefInfo *ref,
+                                             const char *secret) {
   if (!base)
     return ERR;
 
@@ -1104,8 +1109,8 @@ static AdbxStatus secret_store_file_set(SecretStore *base,
  * Error semantics: returns OK on success, ERR on invalid input, policy,
  * I/O, parse, or allocation failures.
  */
-static AdbxStatus secret_store_file_delete(SecretStore *base,
-                                           const SecretRefInfo *ref) {
+static AdbxStatus secret_store_file_delete_impl(SecretStore *base,
+                                                const SecretRefInfo *ref) {
   if (!base)
     return ERR;
 
@@ -1147,8 +1152,9 @@ static AdbxStatus secret_store_file_delete(SecretStore *base,
  * Error semantics: returns OK on success, ERR on invalid input, policy, I/O,
  * parse, or allocation failures.
  */
-static AdbxStatus secret_store_file_wipe_namespace(SecretStore *base,
-                                                   const char *cred_namespace) {
+static AdbxStatus
+secret_store_file_wipe_namespace_impl(SecretStore *base,
+                                      const char *cred_namespace) {
   if (!base)
     return ERR;
 
@@ -1196,7 +1202,7 @@ static AdbxStatus secret_store_file_wipe_namespace(SecretStore *base,
  * Error semantics: returns OK on success, ERR on invalid input, policy,
  * I/O, or allocation failures.
  */
-static AdbxStatus secret_store_file_wipe_all(SecretStore *base) {
+static AdbxStatus secret_store_file_wipe_all_impl(SecretStore *base) {
   if (!base)
     return ERR;
 
@@ -1216,6 +1222,65 @@ static AdbxStatus secret_store_file_wipe_all(SecretStore *base) {
   return rc;
 }
 
+/* Locked vtable entry points. Every operation above reads or swaps the
+ * shared in-memory cache and error snapshot, so each call holds 'op_lock'
+ * for its full duration. */
+static AdbxTriStatus secret_store_file_get(SecretStore *base,
+                                           const SecretRefInfo *ref,
+                                           StrBuf *out) {
+  if (!base)
+    return ERR;
+  FileSecretStore *store = (FileSecretStore *)base;
+  pthread_mutex_lock(&store->op_lock);
+  AdbxTriStatus rc = secret_store_file_get_impl(base, ref, out);
+  pthread_mutex_unlock(&store->op_lock);
+  return rc;
+}
+
+static AdbxStatus secret_store_file_set(SecretStore *base,
+                                        const SecretRefInfo *ref,
+                                        const char *secret) {
+  if (!base)
+    return ERR;
+  FileSecretStore *store = (FileSecretStore *)base;
+  pthread_mutex_lock(&store->op_lock);
+  AdbxStatus rc = secret_store_file_set_impl(base, ref, secret);
+  pthread_mutex_unlock(&store->op_lock);
+  return rc;
+}
+
+static AdbxStatus secret_store_file_delete(SecretStore *base,
+                                           const SecretRefInfo *ref) {
+  if (!base)
+    return ERR;
+  FileSecretStore *store = (FileSecretStore *)base;
+  pthread_mutex_lock(&store->op_lock);
+  AdbxStatus rc = secret_store_file_delete_impl(base, ref);
+  pthread_mutex_unlock(&store->op_lock);
+  return rc;
+}
+
+static AdbxStatus secret_store_file_wipe_namespace(SecretStore *base,
+                                                   const char *cred_namespace) {
+  if (!base)
+    return ERR;
+  FileSecretStore *store = (FileSecretStore *)base;
+  pthread_mutex_lock(&store->op_lock);
+  AdbxStatus rc = secret_store_file_wipe_namespace_impl(base, cred_namespace);
+  pthread_mutex_unlock(&store->op_lock);
+  return rc;
+}
+
+static AdbxStatus secret_store_file_wipe_all(SecretStore *base) {
+  if (!base)
+    return ERR;
+  FileSecretStore *store = (FileSecretStore *)base;
+  pthread_mutex_lock(&store->op_lock);
+  AdbxStatus rc = secret_store_file_wipe_all_impl(base);
+  pthread_mutex_unlock(&store->op_lock);
+  return rc;
+}
+
 /* Destroys one file-backed secret store.
  * It consumes 'base'.
  * Side effects: zeroes in-memory cached secrets and releases owned resources.
@@ -1230,6 +1295,7 @@ static void secret_store_file_destroy(SecretStore *base) {
 
   if (store->dir_fd >= 0)
     close(store->dir_fd);
+  pthread_mutex_destroy(&store->op_lock);
   free(store);
 }
 
@@ -1278,6 +1344,10 @@ static SecretStore *secret_store_file_backend_create(void) {
   memset(&store->cache_meta, 0, sizeof(store->cache_meta));
   memset(&store->cache, 0, sizeof(store->cache));
   ss_clear_err(store);
+  if (pthread_mutex_init(&store->op_lock, NULL) != 0) {
+    free(store);
+    return NULL;
+  }
 
   // Fail close: backend creation succeeds only when storage directory is ready.
   if (ss_get_dir_fd(store) < 0) {
@@ -1,4 +1,5 @@
 #include "sensitive_tok.h"
+#include "perf_counters.h"
 
 #include <assert.h>
 #include <limits.h>
@@ -16,13 +17,20 @@
 struct DbTokenStore {
   const char *connection_name;
   uint32_t connection_name_len;
+  uint32_t conn_tag; // truncated ht_hash_bytes(connection_name); see handles
   SafetyColumnStrategy mode;
   Arena *arena;      // borrowed from BrokerMcpSession
   PackedArray *tokens; // entries are SensitiveTok
   StringPool col_ref_pool;
-  HashTable *det_index; // used only for deterministic mode
+  HashTable *det_index; // open-addressing dedupe index; deterministic mode
+                        // only (randomized mode never reuses tokens)
 };
 
+// Deterministic stores route every sensitive value through det_index, and
+// sensitive-mode sessions can accumulate tens of thousands of live tokens.
+// Presizing skips the early rehash churn while the store warms up.
+#define STOK_DET_INDEX_MIN_SLOTS 1024u
+
 /* Encodes a token index into a non-NULL pointer payload for HashTable values.
  * Why: HashTable uses NULL as "missing key", so index 0 cannot be stored as a
  * raw pointer value; +1 keeps 0 representable while preserving NULL sentinel.
@@ -124,6 +132,12 @@ static void stok_store_clean_inplace(DbTokenStore *store) {
 }
 
 DbTokenStore *stok_store_create(const ConnProfile *profile, Arena *arena) {
+  return stok_store_create_with_shared(profile, arena, NULL);
+}
+
+DbTokenStore *
+stok_store_create_with_shared(const ConnProfile *profile, Arena *arena,
+                              const struct StringPool *shared_col_refs) {
   if (!profile || !profile->connection_name || !arena)
     return NULL;
 
@@ -136,6 +150,12 @@ DbTokenStore *stok_store_create(const ConnProfile *profile, Arena *arena) {
   }
   store->connection_name = profile->connection_name;
   store->connection_name_len = (uint32_t)conn_len;
+  // Handles carry this 32-bit tag instead of the name itself; a tag collision
+  // between two configured connections has 2^-32 odds per pair, negligible
+  // for catalogs of tens of entries (and resolution still bounds-checks the
+  // index against this store's entries).
+  store->conn_tag =
+      (uint32_t)ht_hash_bytes(profile->connection_name, conn_len);
   store->mode = profile->safe_policy.column_strategy;
   store->arena = arena;
 
@@ -153,14 +173,15 @@ DbTokenStore *stok_store_create(const ConnProfile *profile, Arena *arena) {
     return NULL;
   }
 
-  if (spool_init(&store->col_ref_pool) != OK) {
+  if (spool_init_layered(&store->col_ref_pool, shared_col_refs) != OK) {
     stok_store_clean_inplace(store);
     free(store);
     return NULL;
   }
 
   if (store->mode == SAFETY_COLSTRAT_DETERMINISTIC) {
-    store->det_index = ht_create_custom(tok_hash, tok_eq, NULL);
+    store->det_index = ht_create_custom_with_capacity(STOK_DET_INDEX_MIN_SLOTS,
+                                                      tok_hash, tok_eq, NULL);
     if (!store->det_index) {
       stok_store_clean_inplace(store);
       free(store);
@@ -171,6 +192,48 @@ DbTokenStore *stok_store_create(const ConnProfile *profile, Arena *arena) {
   return store;
 }
 
+AdbxStatus stok_store_rebind(DbTokenStore *store, const ConnProfile *profile) {
+  if (!store || !profile || !profile->connection_name)
+    return ERR;
+  size_t len = strlen(profile->connection_name);
+  if (len != store->connection_name_len ||
+      memcmp(profile->connection_name, store->connection_name, len) != 0)
+    return ERR;
+  store->connection_name = profile->connection_name;
+  return OK;
+}
+
+AdbxStatus stok_store_clear(DbTokenStore *store) {
+  if (!store || !store->tokens)
+    return ERR;
+
+  while (parr_len(store->tokens) > 0)
+    parr_drop_swap(store->tokens, (uint32_t)parr_len(store->tokens) - 1u);
+
+  AdbxStatus rc = OK;
+
+  if (store->mode == SAFETY_COLSTRAT_DETERMINISTIC) {
+    // No delete API on HashTable; swap in a fresh index. Build it before
+    // destroying the old one so the store never loses its index on failure.
+    HashTable *fresh = ht_create_custom_with_capacity(STOK_DET_INDEX_MIN_SLOTS,
+                                                      tok_hash, tok_eq, NULL);
+    if (fresh) {
+      ht_destroy(store->det_index);
+      store->det_index = fresh;
+    } else {
+      rc = ERR;
+    }
+  }
+
+  // Re-init over the same shared base so catalog identifiers stay pooled.
+  const StringPool *base = store->col_ref_pool.base;
+  spool_clean(&store->col_ref_pool);
+  if (spool_init_layered(&store->col_ref_pool, base) != OK)
+    rc = ERR;
+
+  return rc;
+}
+
 void stok_store_destroy(DbTokenStore *store) {
   if (!store)
     return;
@@ -221,25 +284,64 @@ const SensitiveTok *stok_store_get(const DbTokenStore *store, uint32_t idx) {
   return (const SensitiveTok *)parr_cat(store->tokens, idx);
 }
 
-/* Formats token text into caller-owned buffer.
+// base64url alphabet (RFC 4648 section 5), unpadded: 12 raw bytes map to
+// exactly 16 handle characters.
+static const char STOK_B64URL[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/* Decodes one base64url character.
+ * It borrows nothing and does not allocate.
+ * Side effects: none.
+ * Error semantics: returns the 6-bit value, or -1 for characters outside the
+ * alphabet.
+ */
+static inline int stok_b64url_val(char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '-')
+    return 62;
+  if (c == '_')
+    return 63;
+  return -1;
+}
+
+/* Formats one fixed-width handle into caller-owned buffer.
  * It borrows all inputs and does not allocate.
- * Side effects: writes bytes to out_tok.
- * Error semantics: returns token length (without NUL) on success, -1 on bad
- * input, truncation, or formatting failure.
+ * Side effects: writes SENSITIVE_TOK_LEN bytes plus NUL to out_tok.
+ * Error semantics: returns SENSITIVE_TOK_LEN on success, -1 on bad input.
  */
 static int stok_format_token(char out_tok[SENSITIVE_TOK_BUFSZ],
-                             const char *connection_name, uint32_t generation,
+                             uint32_t conn_tag, uint32_t generation,
                              uint32_t index) {
   assert(out_tok);
-  assert(connection_name);
 
-  int n = snprintf(out_tok, SENSITIVE_TOK_BUFSZ, "%s%s_%u_%u",
-                   SENSITIVE_TOK_PREFIX, connection_name, generation, index);
-  if (n <= 0)
-    return -1;
-  if ((size_t)n >= SENSITIVE_TOK_BUFSZ)
-    return -1;
-  return n;
+  unsigned char raw[12];
+  const uint32_t words[3] = {conn_tag, generation, index};
+  for (uint32_t w = 0; w < 3; w++) {
+    raw[w * 4 + 0] = (unsigned char)(words[w] >> 24);
+    raw[w * 4 + 1] = (unsigned char)(words[w] >> 16);
+    raw[w * 4 + 2] = (unsigned char)(words[w] >> 8);
+    raw[w * 4 + 3] = (unsigned char)(words[w]);
+  }
+
+  size_t prefix_len = strlen(SENSITIVE_TOK_PREFIX);
+  memcpy(out_tok, SENSITIVE_TOK_PREFIX, prefix_len);
+  char *p = out_tok + prefix_len;
+  for (uint32_t g = 0; g < 4; g++) { // 4 groups of 3 bytes -> 4 chars each
+    uint32_t v = ((uint32_t)raw[g * 3] << 16) |
+                 ((uint32_t)raw[g * 3 + 1] << 8) | (uint32_t)raw[g * 3 + 2];
+    *p++ = STOK_B64URL[(v >> 18) & 0x3Fu];
+    *p++ = STOK_B64URL[(v >> 12) & 0x3Fu];
+    *p++ = STOK_B64URL[(v >> 6) & 0x3Fu];
+    *p++ = STOK_B64URL[v & 0x3Fu];
+  }
+  *p = '\0';
+  assert(p - out_tok == (ptrdiff_t)SENSITIVE_TOK_LEN);
+  return (int)SENSITIVE_TOK_LEN;
 }
 
 /* Appends one SensitiveTok entry to store->tokens (from borrowed input view),
@@ -315,7 +417,8 @@ int stok_store_create_token(DbTokenStore *store, uint32_t generation,
       uint32_t found_idx = 0;
       if (stok_index_decode(found_idx_ptr, &found_idx) != OK)
         return -1;
-      return stok_format_token(out_tok, store->connection_name, generation,
+      PERF_COUNT(PERF_TOKENS_REUSED);
+      return stok_format_token(out_tok, store->conn_tag, generation,
                                found_idx);
     }
 
@@ -324,8 +427,8 @@ int stok_store_create_token(DbTokenStore *store, uint32_t generation,
     if (added_idx == UINT32_MAX || !added_tok)
       return -1;
 
-    int added_len = stok_format_token(out_tok, store->connection_name,
-                                      generation, added_idx);
+    int added_len =
+        stok_format_token(out_tok, store->conn_tag, generation, added_idx);
     if (added_len < 0)
       return -1;
 
@@ -347,6 +450,7 @@ int stok_store_create_token(DbTokenStore *store, uint32_t generation,
       parr_drop_swap(store->tokens, added_idx);
       return -1;
     }
+    PERF_COUNT(PERF_TOKENS_MINTED);
     return added_len;
   }
 
@@ -358,99 +462,149 @@ int stok_store_create_token(DbTokenStore *store, uint32_t generation,
     return -1;
 
   int tok_len =
-      stok_format_token(out_tok, store->connection_name, generation, added_idx);
+      stok_format_token(out_tok, store->conn_tag, generation, added_idx);
   if (tok_len < 0) {
     parr_drop_swap(store->tokens, added_idx);
     return -1;
   }
+  PERF_COUNT(PERF_TOKENS_MINTED);
   return tok_len;
 }
 
-/* Parses one unsigned base-10 integer from [start, end) into '*out_u32'.
- * It borrows input pointers and does not allocate.
- * Side effects: writes to '*out_u32' on success.
- * Error semantics: returns OK on valid uint32 text, ERR otherwise.
- */
-static AdbxStatus parse_u32_span(const char *start, const char *end,
-                                 uint32_t *out_u32) {
-  assert(start != NULL);
-  assert(end != NULL);
-  assert(out_u32 != NULL);
-  if (start >= end)
+AdbxTriStatus stok_store_supports_batch(const DbTokenStore *store) {
+  if (!store)
     return ERR;
+  return (store->mode == SAFETY_COLSTRAT_RANDOMIZED) ? YES : NO;
+}
 
-  uint64_t acc = 0;
-  for (const char *p = start; p < end; p++) {
-    if (*p < '0' || *p > '9')
-      return ERR;
-    acc = (acc * 10u) + (uint64_t)(*p - '0');
-    if (acc > UINT32_MAX)
-      return ERR;
-  }
-  *out_u32 = (uint32_t)acc;
+AdbxStatus stok_store_reserve_batch(DbTokenStore *store, uint32_t count,
+                                    SensitiveTokBatch *out_batch) {
+  if (!store || !out_batch || count == 0)
+    return ERR;
+  if (store->mode != SAFETY_COLSTRAT_RANDOMIZED)
+    return ERR;
+  if (store->connection_name_len == 0 ||
+      store->connection_name_len > CONN_NAME_MAX_LEN)
+    return ERR;
+  assert(store->tokens);
+
+  if (parr_reserve(store->tokens, count) != OK)
+    return ERR;
+  out_batch->first_idx = (uint32_t)parr_len(store->tokens);
+  out_batch->count = count;
+  out_batch->filled = 0;
   return OK;
 }
 
-/* Finds the last underscore in the inclusive character range [start, end].
- * It borrows all pointers and does not allocate.
- * Side effects: none.
- * Error semantics: returns pointer to '_' when found, NULL otherwise.
- */
-static char *find_last_underscore(char *start, char *end) {
-  assert(start != NULL);
-  assert(end != NULL);
-  if (start > end)
-    return NULL;
+int stok_batch_fill(DbTokenStore *store, SensitiveTokBatch *batch,
+                    uint32_t generation, const SensitiveTokIn *in,
+                    char out_tok[SENSITIVE_TOK_BUFSZ]) {
+  if (!store || !batch || !in || !out_tok)
+    return -1;
+  if (batch->filled >= batch->count)
+    return -1;
+  if (!in->col_ref || in->col_ref_len == 0)
+    return -1;
+  if (!in->value && in->value_len != 0)
+    return -1;
+  if (store->mode != SAFETY_COLSTRAT_RANDOMIZED)
+    return -1;
 
-  for (char *p = end;; p--) {
-    if (*p == '_')
-      return p;
-    if (p == start)
-      break;
+  uint32_t added_idx = stok_append_entry(store, in, NULL);
+  if (added_idx == UINT32_MAX)
+    return -1;
+  // The reservation claimed this run; interleaved appends would break it.
+  assert(added_idx == batch->first_idx + batch->filled);
+
+  int tok_len =
+      stok_format_token(out_tok, store->conn_tag, generation, added_idx);
+  if (tok_len < 0) {
+    parr_drop_swap(store->tokens, added_idx);
+    return -1;
   }
-  return NULL;
+  batch->filled++;
+  PERF_COUNT(PERF_TOKENS_MINTED);
+  return tok_len;
 }
 
-AdbxStatus stok_parse_view_inplace(char *token, ParsedTokView *out) {
+AdbxStatus stok_parse_view(const char *token, ParsedTokView *out) {
   if (!token || !out)
     return ERR;
   size_t prefix_len = strlen(SENSITIVE_TOK_PREFIX);
+  // Hostile input: strncmp stops at the NUL, so strings shorter than the
+  // prefix are rejected without reading past their allocation, and the full
+  // width is only probed after the length check below bounds it.
   if (strncmp(token, SENSITIVE_TOK_PREFIX, prefix_len) != 0)
     return ERR;
-
-  size_t tok_len = strlen(token);
-  if (tok_len <= prefix_len + 3u)
-    return ERR;
-
-  char *conn_start = token + prefix_len;
-  char *str_end = token + tok_len - 1;
-
-  // Parse from right to left to allow underscores inside connection_name.
-  char *last_us = find_last_underscore(conn_start, str_end);
-  if (!last_us || last_us == str_end)
+  // Fixed width: exactly 16 handle characters after the prefix.
+  if (strlen(token) != SENSITIVE_TOK_LEN)
     return ERR;
 
-  char *prev_end = last_us - 1;
-  if (prev_end < conn_start)
-    return ERR;
-  char *mid_us = find_last_underscore(conn_start, prev_end);
-  if (!mid_us)
-    return ERR;
-  if (mid_us == conn_start)
+  const char *p = token + prefix_len;
+  unsigned char raw[12];
+  int bad = 0;
+  for (uint32_t g = 0; g < 4; g++) {
+    int a = stok_b64url_val(p[g * 4]);
+    int b = stok_b64url_val(p[g * 4 + 1]);
+    int c = stok_b64url_val(p[g * 4 + 2]);
+    int d = stok_b64url_val(p[g * 4 + 3]);
+    bad |= a | b | c | d; // any -1 drives the sign bit
+    uint32_t v = ((uint32_t)(a & 0x3F) << 18) | ((uint32_t)(b & 0x3F) << 12) |
+                 ((uint32_t)(c & 0x3F) << 6) | (uint32_t)(d & 0x3F);
+    raw[g * 3] = (unsigned char)(v >> 16);
+    raw[g * 3 + 1] = (unsigned char)(v >> 8);
+    raw[g * 3 + 2] = (unsigned char)v;
+  }
+  if (bad < 0)
     return ERR;
 
-  uint32_t generation = 0;
-  uint32_t index = 0;
-  if (parse_u32_span(mid_us + 1, last_us, &generation) != OK)
-    return ERR;
-  if (parse_u32_span(last_us + 1, str_end + 1, &index) != OK)
-    return ERR;
+  out->conn_tag = ((uint32_t)raw[0] << 24) | ((uint32_t)raw[1] << 16) |
+                  ((uint32_t)raw[2] << 8) | (uint32_t)raw[3];
+  out->generation = ((uint32_t)raw[4] << 24) | ((uint32_t)raw[5] << 16) |
+                    ((uint32_t)raw[6] << 8) | (uint32_t)raw[7];
+  out->index = ((uint32_t)raw[8] << 24) | ((uint32_t)raw[9] << 16) |
+               ((uint32_t)raw[10] << 8) | (uint32_t)raw[11];
+  return OK;
+}
 
-  *mid_us = '\0';
-  *last_us = '\0';
+int stok_store_format_token(const DbTokenStore *store, uint32_t generation,
+                            uint32_t index,
+                            char out_tok[SENSITIVE_TOK_BUFSZ]) {
+  if (!store || !out_tok)
+    return -1;
+  return stok_format_token(out_tok, store->conn_tag, generation, index);
+}
 
-  out->connection_name = conn_start;
-  out->generation = generation;
-  out->index = index;
-  return OK;
+StokResolveStatus stok_store_resolve_params(const DbTokenStore *store,
+                                            uint32_t generation,
+                                            char *const *tokens,
+                                            uint32_t ntoks, SensitiveTok *out,
+                                            uint32_t *out_bad_idx,
+                                            ParsedTokView *out_bad_view) {
+  if (out_bad_idx)
+    *out_bad_idx = 0;
+  if (!store || !tokens || !out || ntoks == 0)
+    return STOK_RESOLVE_BAD_INPUT;
+
+  for (uint32_t i = 0; i < ntoks; i++) {
+    if (out_bad_idx)
+      *out_bad_idx = i;
+
+    ParsedTokView parsed = {0};
+    if (!tokens[i] || stok_parse_view(tokens[i], &parsed) != OK)
+      return STOK_RESOLVE_BAD_FORMAT;
+    if (out_bad_view)
+      *out_bad_view = parsed;
+
+    if (parsed.conn_tag != store->conn_tag)
+      return STOK_RESOLVE_WRONG_CONN;
+    if (parsed.generation != generation)
+      return STOK_RESOLVE_STALE_GEN;
+
+    const SensitiveTok *bound = stok_store_get(store, parsed.index);
+    if (!bound)
+      return STOK_RESOLVE_UNKNOWN_INDEX;
+    out[i] = *bound;
+  }
+  return STOK_RESOLVE_OK;
 }
@@ -8,11 +8,17 @@
 #include "conn_catalog.h"
 #include "utils.h"
 typedef struct DbTokenStore DbTokenStore;
+struct StringPool; // see spool.h
 
 /* Token prefix for sensitive-value handles. */
 #define SENSITIVE_TOK_PREFIX "tok_"
-// "tok_" + 31-byte connection name + "_" + uint32 + "_" + uint32 + '\0'
-#define SENSITIVE_TOK_BUFSZ 64u
+// Fixed-width handle: "tok_" + 16 base64url chars encoding 12 big-endian
+// bytes (connection tag u32, generation u32, index u32). Handles are 20
+// bytes on the wire regardless of connection-name length and decode in
+// constant time (the old format spelled the name out and re-parsed two
+// variable-width decimal fields on every resolution).
+#define SENSITIVE_TOK_LEN 20u
+#define SENSITIVE_TOK_BUFSZ 24u
 
 /* Broker-owned token entry for sensitive values.
  * v1 stores Postgres metadata only.
@@ -26,12 +32,12 @@ typedef struct SensitiveTok {
   uint32_t pg_oid; // Postgres OID for typed bind
 } SensitiveTok;
 
-/* Borrowed parsed view over one token buffer.
- * connection_name points inside the caller-owned input string passed to
- * stok_parse_view_inplace().
+/* Decoded fields of one token handle.
+ * conn_tag is the 32-bit tag of the owning connection name (computed by the
+ * store at creation); resolution compares tags instead of name bytes.
  */
 typedef struct ParsedTokView {
-  char *connection_name;
+  uint32_t conn_tag;
   uint32_t generation;
   uint32_t index;
 } ParsedTokView;
@@ -46,6 +52,36 @@ typedef struct ParsedTokView {
  */
 DbTokenStore *stok_store_create(const ConnProfile *profile, Arena *arena);
 
+/* Same as stok_store_create() but layers the store's column-ref pool over a
+ * shared read-only StringPool (see spool_init_layered()), so identifiers
+ * already interned there cost no per-store copy. 'shared_col_refs' is
+ * borrowed, may be NULL, must outlive the store, and must stay frozen while
+ * stores use it.
+ */
+DbTokenStore *stok_store_create_with_shared(const ConnProfile *profile,
+                                            Arena *arena,
+                                            const struct StringPool *shared_col_refs);
+
+/* Re-points the store's borrowed connection-name string at 'profile' after a
+ * catalog reload replaced the catalog that minted the store. The profile must
+ * carry the exact same connection name; tokens, generation, and the minted
+ * column strategy are untouched, so outstanding handles keep resolving.
+ * Error semantics: returns OK on success, ERR on invalid input or a name
+ * mismatch (the store is left unchanged and should be destroyed instead).
+ */
+AdbxStatus stok_store_rebind(DbTokenStore *store, const ConnProfile *profile);
+
+/* Empties one store for reuse: drops every token, the deterministic index,
+ * and the store-owned interned column refs, keeping the connection binding
+ * and the shared base pool layering. Value bytes live in the borrowed
+ * session arena; the caller owns reclaiming those (and must bump the token
+ * generation so outstanding handles fail the staleness check instead of
+ * resolving against the emptied store).
+ * Returns OK on success, ERR on invalid input or allocation failure (the
+ * store stays usable and empty in the pool/index it could rebuild).
+ */
+AdbxStatus stok_store_clear(DbTokenStore *store);
+
 /* Destroys one heap-owned DbTokenStore.
  * Ownership: releases store-owned internals and invalidates 'store'.
  * Side effects: destroys token array/string pool/hash index.
@@ -100,16 +136,86 @@ int stok_store_create_token(DbTokenStore *store, uint32_t generation,
                             const SensitiveTokIn *in,
                             char out_tok[SENSITIVE_TOK_BUFSZ]);
 
-/* Parses one token in-place.
- * Expected format: tok_<connection_name>_<generation>_<index>
- *
- * On success, this function writes NUL bytes over the last two underscores so
- * that out->connection_name points to a stable C string inside 'token'.
- * The input buffer must be writable and NUL-terminated.
- *
- * Returns OK on success, ERR on invalid format/range/input (does not change
- * input token).
- */
-AdbxStatus stok_parse_view_inplace(char *token, ParsedTokView *out);
+/* One pre-claimed run of token slots; see stok_store_reserve_batch(). */
+typedef struct SensitiveTokBatch {
+  uint32_t first_idx; // index the first fill lands on
+  uint32_t count;     // reserved fills
+  uint32_t filled;    // fills consumed so far
+} SensitiveTokBatch;
+
+/* Returns YES when 'store' supports batch reservation (randomized mode: every
+ * sensitive value mints a fresh token, so slot ranges can be claimed up
+ * front), NO for deterministic stores (dedupe decides per value whether a
+ * token is minted at all), ERR on NULL input.
+ */
+AdbxTriStatus stok_store_supports_batch(const DbTokenStore *store);
+
+/* Reserves storage for 'count' upcoming stok_batch_fill() calls on one
+ * randomized store. The fills that follow append into pre-grown storage, so
+ * once stores are shared across workers the reservation is the single
+ * synchronization point for the whole run instead of one per minted cell.
+ * The caller must be the only appender until the batch is consumed; fills
+ * land on the contiguous index range starting at out_batch->first_idx.
+ * Returns OK on success, ERR on invalid input, deterministic stores, or
+ * allocation failure (no slot is claimed on ERR).
+ */
+AdbxStatus stok_store_reserve_batch(DbTokenStore *store, uint32_t count,
+                                    SensitiveTokBatch *out_batch);
+
+/* Fills the next reserved slot of 'batch' with one token entry.
+ * Same ownership and out_tok contract as stok_store_create_token(); unlike
+ * it, this never consults the dedupe index and never grows the token array.
+ * Unused reservations are harmless: they claim capacity, not live entries.
+ * Returns token byte length (without NUL) on success, -1 on invalid input,
+ * an exhausted batch, or allocation failure.
+ */
+int stok_batch_fill(DbTokenStore *store, SensitiveTokBatch *batch,
+                    uint32_t generation, const SensitiveTokIn *in,
+                    char out_tok[SENSITIVE_TOK_BUFSZ]);
+
+/* Decodes one fixed-width token handle ("tok_" + 16 base64url chars).
+ * It borrows 'token' read-only and writes the decoded fields to '*out'.
+ * Side effects: none.
+ * Returns OK on success, ERR on invalid prefix/length/characters (input is
+ * never modified).
+ */
+AdbxStatus stok_parse_view(const char *token, ParsedTokView *out);
+
+/* Formats the handle for (generation, index) under 'store's connection
+ * binding. It does not check that 'index' names a live entry, so callers can
+ * render handles for entries they are about to create.
+ * Returns token byte length (without NUL) on success, -1 on invalid input.
+ */
+int stok_store_format_token(const DbTokenStore *store, uint32_t generation,
+                            uint32_t index,
+                            char out_tok[SENSITIVE_TOK_BUFSZ]);
+
+/* Outcome of one bulk token resolution; see stok_store_resolve_params(). */
+typedef enum StokResolveStatus {
+  STOK_RESOLVE_OK = 0,
+  STOK_RESOLVE_BAD_INPUT,     /* NULL inputs or zero tokens */
+  STOK_RESOLVE_BAD_FORMAT,    /* token failed stok_parse_view() */
+  STOK_RESOLVE_WRONG_CONN,    /* token bound to another connection (tag) */
+  STOK_RESOLVE_STALE_GEN,     /* token generation != expected generation */
+  STOK_RESOLVE_UNKNOWN_INDEX, /* token index not present in the store */
+} StokResolveStatus;
+
+/* Resolves 'ntoks' parameter tokens against one store in a single pass,
+ * validating format, connection binding, and generation together.
+ * Ownership:
+ * - 'tokens' entries are caller-owned strings, read but never modified.
+ * - 'out' receives ntoks copied SensitiveTok entries on success; its borrowed
+ *   value/col_ref pointers stay owned by the store and session arena.
+ * Error semantics: stops at the first failing token, writes its position to
+ * '*out_bad_idx' and (for post-format failures) its decoded fields to
+ * '*out_bad_view', and returns the matching status; 'out' contents are
+ * unspecified on failure.
+ */
+StokResolveStatus stok_store_resolve_params(const DbTokenStore *store,
+                                            uint32_t generation,
+                                            char *const *tokens,
+                                            uint32_t ntoks, SensitiveTok *out,
+                                            uint32_t *out_bad_idx,
+                                            ParsedTokView *out_bad_view);
 
 #endif
@@ -56,12 +56,20 @@ AdbxStatus spool_init(StringPool *sp) {
   return OK;
 }
 
+AdbxStatus spool_init_layered(StringPool *sp, const StringPool *base) {
+  if (spool_init(sp) != OK)
+    return ERR;
+  sp->base = base;
+  return OK;
+}
+
 void spool_clean(StringPool *sp) {
   if (!sp)
     return;
   ht_destroy(sp->index);
   sp->index = NULL;
   arena_clean(&sp->arena);
+  sp->base = NULL;
 }
 
 void spool_destroy(StringPool *sp) {
@@ -85,6 +93,14 @@ const char *spool_addn(StringPool *sp, const char *s, size_t len) {
     return NULL;
 
   uint32_t n = (uint32_t)len;
+  // Frozen lower layers are consulted first and never written, so a hit on a
+  // shared base pool is lock-free and allocation-free, and every pool layered
+  // on the same base resolves hot content to the same pointer.
+  for (const StringPool *base = sp->base; base; base = base->base) {
+    const char *found = (const char *)ht_get(base->index, s, len);
+    if (found)
+      return found;
+  }
   const char *found = ht_get(sp->index, s, len);
   if (found)
     return found;
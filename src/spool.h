@@ -22,6 +22,7 @@
 typedef struct StringPool {
   Arena arena;           // owned storage for interned bytes
   struct HashTable *index; // owned key->interned pointer map
+  const struct StringPool *base; // borrowed read-only lower layer; may be NULL
 } StringPool;
 
 /* Allocates and initializes a heap-owned string pool.
@@ -38,6 +39,20 @@ StringPool *spool_create(void);
  */
 AdbxStatus spool_init(StringPool *sp);
 
+/* Initializes an in-place string pool layered over a read-only 'base' pool.
+ * Lookups consult 'base' (and its own base, transitively) before this pool's
+ * storage, so content already interned there is shared instead of re-copied
+ * and resolves to the same stable pointer across every pool layered on it.
+ *
+ * Contract for callers:
+ * - 'base' is borrowed and must outlive this pool.
+ * - 'base' must not be mutated while layered pools use it; a frozen base is
+ *   what makes concurrent lookups from worker threads safe without locking.
+ *
+ * Returns OK on success, ERR on invalid input or allocation failure.
+ */
+AdbxStatus spool_init_layered(StringPool *sp, const StringPool *base);
+
 /* Releases resources owned by an initialized pool, keeping the struct.
  * Ownership: caller retains the struct and may call spool_init() again.
  * Side effects: frees hash table and arena allocations.
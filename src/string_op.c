@@ -1,8 +1,11 @@
 #include "string_op.h"
+#include "perf_counters.h"
 #include "utils.h"
 
+#include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 static char *dup_n_or_null_impl(const char *s, size_t cap, int pretty) {
@@ -42,6 +45,198 @@ char *dup_or_null(const char *s) {
   return dup_n_or_null_impl(s, INT_MAX, 0);
 }
 
+/* --------------------------- decimal rendering --------------------------- */
+
+// All two-digit decimal values "00".."99" back to back; one table lookup
+// replaces two divisions and two additions per digit pair.
+static const char STROP_DEC_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+size_t strop_u64_to_dec(char *out, uint64_t v) {
+  // Render backwards into a max-width scratch, two digits per step, then
+  // copy the used suffix; the branch per loop is the only data-dependent one.
+  char tmp[STROP_DEC_MAX];
+  char *p = tmp + sizeof(tmp);
+  while (v >= 100u) {
+    uint64_t q = v / 100u;
+    unsigned r = (unsigned)(v - q * 100u);
+    p -= 2;
+    memcpy(p, STROP_DEC_PAIRS + r * 2u, 2);
+    v = q;
+  }
+  if (v >= 10u) {
+    p -= 2;
+    memcpy(p, STROP_DEC_PAIRS + (unsigned)v * 2u, 2);
+  } else {
+    *--p = (char)('0' + (unsigned)v);
+  }
+  size_t n = (size_t)(tmp + sizeof(tmp) - p);
+  memcpy(out, p, n);
+  return n;
+}
+
+size_t strop_i64_to_dec(char *out, int64_t v) {
+  if (v < 0) {
+    *out = '-';
+    // -(v + 1) + 1 sidesteps the INT64_MIN negation overflow.
+    uint64_t mag = (uint64_t)(-(v + 1)) + 1u;
+    return 1u + strop_u64_to_dec(out + 1, mag);
+  }
+  return strop_u64_to_dec(out, (uint64_t)v);
+}
+
+/* --------------------------- span number parsing ------------------------- */
+
+AdbxStatus str_span_to_i64(const char *p, size_t n, int64_t *out) {
+  if (!p || !out || n == 0)
+    return ERR;
+
+  size_t i = 0;
+  int neg = 0;
+  if (p[0] == '-' || p[0] == '+') {
+    neg = (p[0] == '-');
+    i = 1;
+  }
+  if (i == n)
+    return ERR;
+
+  uint64_t acc = 0;
+  for (; i < n; i++) {
+    unsigned d = (unsigned char)p[i] - '0';
+    if (d > 9)
+      return ERR;
+    if (acc > (UINT64_MAX - d) / 10u)
+      return ERR;
+    acc = acc * 10u + d;
+  }
+
+  if (neg) {
+    if (acc > (uint64_t)INT64_MAX + 1u)
+      return ERR;
+    *out = (acc == (uint64_t)INT64_MAX + 1u) ? INT64_MIN : -(int64_t)acc;
+    return OK;
+  }
+  if (acc > (uint64_t)INT64_MAX)
+    return ERR;
+  *out = (int64_t)acc;
+  return OK;
+}
+
+/* Delegates one already-validated decimal span to strtod for the rare inputs
+ * whose exact rounding needs arbitrary precision (mantissas past 19 digits,
+ * |decimal exponent| > 22).
+ * Ownership: borrows 'p'; may heap-allocate a copy for very long spans.
+ * Error semantics: returns OK on success, ERR on range overflow/underflow to
+ * the strtod error values.
+ */
+static AdbxStatus span_to_f64_slow(const char *p, size_t n, double *out) {
+  char stack_buf[64];
+  char *tmp = (n < sizeof(stack_buf)) ? stack_buf : xmalloc(n + 1);
+  memcpy(tmp, p, n);
+  tmp[n] = '\0';
+
+  errno = 0;
+  char *endp = NULL;
+  double v = strtod(tmp, &endp);
+  AdbxStatus rc = (errno == 0 && endp == tmp + n) ? OK : ERR;
+  if (tmp != stack_buf)
+    free(tmp);
+  if (rc == OK)
+    *out = v;
+  return rc;
+}
+
+AdbxStatus str_span_to_f64(const char *p, size_t n, double *out) {
+  if (!p || !out || n == 0)
+    return ERR;
+
+  // Exactly representable powers of ten: one multiply/divide by these is a
+  // single correctly-rounded operation (Clinger's fast path).
+  static const double pow10_exact[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  size_t i = 0;
+  int neg = 0;
+  if (p[0] == '-' || p[0] == '+') {
+    neg = (p[0] == '-');
+    i = 1;
+  }
+
+  uint64_t mant = 0;
+  int n_digits = 0;
+  int frac_digits = 0;
+  int truncated = 0;
+
+  while (i < n && (unsigned char)(p[i] - '0') <= 9u) {
+    if (n_digits < 19) {
+      mant = mant * 10u + (uint64_t)(p[i] - '0');
+      n_digits++;
+    } else {
+      truncated = 1;
+    }
+    i++;
+  }
+
+  if (i < n && p[i] == '.') {
+    i++;
+    while (i < n && (unsigned char)(p[i] - '0') <= 9u) {
+      if (n_digits < 19) {
+        mant = mant * 10u + (uint64_t)(p[i] - '0');
+        n_digits++;
+        frac_digits++;
+      } else {
+        truncated = 1;
+      }
+      i++;
+    }
+  }
+  if (n_digits == 0 && !truncated)
+    return ERR; // no digits at all (rejects "", ".", "inf", "0x..")
+
+  long exp10 = 0;
+  if (i < n && (p[i] == 'e' || p[i] == 'E')) {
+    i++;
+    int exp_neg = 0;
+    if (i < n && (p[i] == '-' || p[i] == '+')) {
+      exp_neg = (p[i] == '-');
+      i++;
+    }
+    if (i >= n)
+      return ERR;
+    while (i < n && (unsigned char)(p[i] - '0') <= 9u) {
+      // Clamp instead of overflowing; such inputs fail range checks below.
+      if (exp10 < 100000)
+        exp10 = exp10 * 10 + (p[i] - '0');
+      i++;
+    }
+    if (exp_neg)
+      exp10 = -exp10;
+  }
+
+  if (i != n)
+    return ERR; // stray bytes after the number
+
+  long e10 = exp10 - frac_digits;
+  if (!truncated && mant <= (1ull << 53) && e10 >= -22 && e10 <= 22) {
+    double d = (double)mant;
+    d = (e10 < 0) ? d / pow10_exact[-e10] : d * pow10_exact[e10];
+    *out = neg ? -d : d;
+    return OK;
+  }
+
+  return span_to_f64_slow(p, n, out);
+}
+
 /* ------------------------- small growable buffer ------------------------- */
 
 void sb_init(StrBuf *sb) {
@@ -52,10 +247,24 @@ void sb_init(StrBuf *sb) {
   sb->cap = 0;
 }
 
+void sb_init_small(StrBuf *sb) {
+  if (!sb)
+    return;
+  sb->data = sb->small;
+  sb->len = 0;
+  sb->cap = STRBUF_INLINE_CAP;
+}
+
+/* Returns 1 while 'sb' stores its bytes inline (never free/realloc those). */
+static inline int sb_is_inline(const StrBuf *sb) {
+  return sb->data == sb->small;
+}
+
 void sb_clean(StrBuf *sb) {
   if (!sb)
     return;
-  free(sb->data);
+  if (!sb_is_inline(sb))
+    free(sb->data);
   sb->data = NULL;
   sb->len = 0;
   sb->cap = 0;
@@ -98,7 +307,16 @@ AdbxStatus sb_reserve(StrBuf *sb, size_t add) {
     newcap *= 2;
   }
 
-  char *p = (char *)xrealloc(sb->data, newcap);
+  char *p;
+  if (sb_is_inline(sb)) {
+    // Spill to heap: inline bytes live in the struct and cannot be realloc'd.
+    PERF_COUNT_N(PERF_SB_GROW_BYTES, newcap);
+    p = (char *)xmalloc(newcap);
+    memcpy(p, sb->small, sb->len);
+  } else {
+    PERF_COUNT_N(PERF_SB_GROW_BYTES, newcap - sb->cap);
+    p = (char *)xrealloc(sb->data, newcap);
+  }
 
   sb->data = p;
   sb->cap = newcap;
@@ -2,6 +2,7 @@
 #define STRING_OP_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "utils.h"
 
@@ -18,11 +19,50 @@ char *dupn_or_null_pretty(const char *s, size_t cap);
  * result. */
 char *dup_or_null(const char *s);
 
+/* Parses a signed base-10 integer from a known-length span: optional sign,
+ * then digits only, and the whole span must be consumed. No locale, no errno,
+ * and overflow-checked against int64 range.
+ * Ownership: borrows 'p'; writes into caller-owned 'out'.
+ * Error semantics: returns OK on success, ERR on invalid input, stray bytes,
+ * or overflow.
+ */
+AdbxStatus str_span_to_i64(const char *p, size_t n, int64_t *out);
+
+/* Parses a decimal number ([+-]?digits[.digits][eE[+-]digits]) from a
+ * known-length span; the whole span must be consumed. Unlike strtod it never
+ * consults the locale and rejects hex/inf/nan forms. Values whose mantissa
+ * and exponent allow an exact binary conversion take a table-driven fast
+ * path; the rest fall back to one strtod call for correct rounding.
+ * Ownership: borrows 'p'; writes into caller-owned 'out'.
+ * Error semantics: returns OK on success, ERR on invalid input, stray bytes,
+ * or out-of-range magnitude.
+ */
+AdbxStatus str_span_to_f64(const char *p, size_t n, double *out);
+
+// Worst-case strop_*_to_dec output: 20 digits of UINT64_MAX plus a sign.
+#define STROP_DEC_MAX 21u
+
+/* Renders 'v' as base-10 into 'out' using a two-digit pairs table — no
+ * snprintf, no locale, two digits per division. 'out' must hold at least
+ * STROP_DEC_MAX bytes; no NUL terminator is written.
+ * Returns the number of bytes written (at least 1). */
+size_t strop_u64_to_dec(char *out, uint64_t v);
+
+/* Signed variant of strop_u64_to_dec; emits a leading '-' for negatives
+ * (INT64_MIN included). Same buffer contract, returns bytes written. */
+size_t strop_i64_to_dec(char *out, int64_t v);
+
 /* ------------------------- small growable buffer ------------------------- */
+
+// Bytes available before an sb_init_small() buffer spills to the heap.
+#define STRBUF_INLINE_CAP 32u
+
 typedef struct StrBuf {
-  char *data;
+  char *data; // heap allocation, or 'small' while in inline mode
   size_t len;
   size_t cap;
+  char small[STRBUF_INLINE_CAP]; // inline storage; used only after
+                                 // sb_init_small()
 } StrBuf;
 
 // TODO: make this configurable via compile-time flags.
@@ -35,6 +75,22 @@ typedef struct StrBuf {
  */
 void sb_init(StrBuf *sb);
 
+/* Initializes one StrBuf in inline mode: the first STRBUF_INLINE_CAP bytes
+ * live inside the struct and growing past them spills to the heap, so short
+ * payloads never touch malloc.
+ *
+ * Contract: while in inline mode 'data' points into the struct itself, so
+ * the StrBuf must stay at a fixed address (stack locals and stable heap
+ * owners are fine; do not memcpy/move the struct while it may be inline).
+ * Side effects: none beyond field writes; clean with sb_clean() as usual.
+ * Error semantics: none; NULL input is ignored.
+ */
+void sb_init_small(StrBuf *sb);
+
+/* Makes sure 'sb' has enough space for 'add' more bytes. Returns OK on success,
+ * ERR on bad input or overflow. */
+AdbxStatus sb_reserve(StrBuf *sb, size_t add);
+
 /* Adds 'n' bytes starting from 'src' to sb. Returns OK/ERR. */
 AdbxStatus sb_append_bytes(StrBuf *sb, const void *src, size_t n);
 
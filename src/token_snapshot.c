@@ -0,0 +1,444 @@
+#include "token_snapshot.h"
+
+#include "arena.h"
+#include "file_io.h"
+#include "rapidhash.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TOKSNAP_MAGIC "adbxtok1"
+#define TOKSNAP_MAGIC_LEN 8u
+#define TOKSNAP_FORMAT 1u
+// magic + format u32 + session count u32 + body hash u64 + body len u32
+#define TOKSNAP_HEADER_LEN (TOKSNAP_MAGIC_LEN + 4u + 4u + 8u + 4u)
+#define TOKSNAP_MAX_BYTES (16u * 1024u * 1024u)
+// Generous ceilings; a broker never persists more than its session arrays
+// hold, so anything past these means a foreign or corrupted file.
+#define TOKSNAP_MAX_SESSIONS 1024u
+// Length marker encoding an absent value (SQL NULL payload).
+#define TOKSNAP_NULL_STR UINT32_MAX
+
+struct TokSnap {
+  TokSnapSession *sessions;
+  uint32_t n_sessions;
+  Arena arena; // owns sessions, store/token arrays, and every string
+};
+
+/* ------------------------------- writing --------------------------------- */
+
+static AdbxStatus toksnap_put_u32(StrBuf *sb, uint32_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+static AdbxStatus toksnap_put_u64(StrBuf *sb, uint64_t v) {
+  return sb_append_bytes(sb, &v, sizeof(v));
+}
+
+/* NULL encodes as TOKSNAP_NULL_STR; otherwise u32 length plus raw bytes
+ * (values are length-delimited, never NUL-scanned, so embedded NULs in a
+ * sensitive value round-trip). */
+static AdbxStatus toksnap_put_lenbytes(StrBuf *sb, const char *s,
+                                       uint32_t len) {
+  if (!s)
+    return toksnap_put_u32(sb, TOKSNAP_NULL_STR);
+  if (len >= TOKSNAP_NULL_STR)
+    return ERR;
+  if (toksnap_put_u32(sb, len) != OK)
+    return ERR;
+  return sb_append_bytes(sb, s, len);
+}
+
+void toksnap_writer_init(TokSnapWriter *w) {
+  if (!w)
+    return;
+  sb_init(&w->body);
+  w->n_sessions = 0;
+  w->failed = 0;
+}
+
+void toksnap_writer_clean(TokSnapWriter *w) {
+  if (!w)
+    return;
+  // Buffered bytes hold plaintext sensitive values.
+  sb_zero_clean(&w->body);
+  w->n_sessions = 0;
+  w->failed = 1;
+}
+
+AdbxStatus toksnap_writer_session(TokSnapWriter *w,
+                                  const uint8_t token[RESUME_TOKEN_LEN],
+                                  uint32_t generation, int64_t created_at,
+                                  int64_t last_active,
+                                  int64_t tokens_last_used,
+                                  uint32_t n_stores) {
+  if (!w || !token || w->failed)
+    goto fail;
+
+  if (sb_append_bytes(&w->body, token, RESUME_TOKEN_LEN) != OK ||
+      toksnap_put_u32(&w->body, generation) != OK ||
+      toksnap_put_u64(&w->body, (uint64_t)created_at) != OK ||
+      toksnap_put_u64(&w->body, (uint64_t)last_active) != OK ||
+      toksnap_put_u64(&w->body, (uint64_t)tokens_last_used) != OK ||
+      toksnap_put_u32(&w->body, n_stores) != OK) {
+    goto fail;
+  }
+
+  w->n_sessions++;
+  return OK;
+
+fail:
+  if (w)
+    w->failed = 1;
+  return ERR;
+}
+
+AdbxStatus toksnap_writer_store(TokSnapWriter *w, const char *connection_name,
+                                const DbTokenStore *store) {
+  if (!w || !connection_name || !store || w->failed)
+    goto fail;
+
+  size_t n_toks = stok_store_len(store);
+  if (n_toks > UINT32_MAX)
+    goto fail;
+  if (toksnap_put_lenbytes(&w->body, connection_name,
+                           (uint32_t)strlen(connection_name)) != OK ||
+      toksnap_put_u32(&w->body, (uint32_t)n_toks) != OK) {
+    goto fail;
+  }
+
+  for (uint32_t i = 0; i < (uint32_t)n_toks; i++) {
+    const SensitiveTok *t = stok_store_get(store, i);
+    if (!t)
+      goto fail;
+    if (toksnap_put_lenbytes(&w->body, t->value, t->value_len) != OK ||
+        toksnap_put_lenbytes(&w->body, t->col_ref, t->col_ref_len) != OK ||
+        toksnap_put_u32(&w->body, t->pg_oid) != OK) {
+      goto fail;
+    }
+  }
+  return OK;
+
+fail:
+  if (w)
+    w->failed = 1;
+  return ERR;
+}
+
+AdbxStatus toksnap_writer_store_rec(TokSnapWriter *w,
+                                    const TokSnapStoreRec *rec) {
+  if (!w || !rec || !rec->connection_name || w->failed)
+    goto fail;
+
+  if (toksnap_put_lenbytes(&w->body, rec->connection_name,
+                           (uint32_t)strlen(rec->connection_name)) != OK ||
+      toksnap_put_u32(&w->body, rec->n_toks) != OK) {
+    goto fail;
+  }
+  for (uint32_t i = 0; i < rec->n_toks; i++) {
+    const TokSnapTokRec *t = &rec->toks[i];
+    if (toksnap_put_lenbytes(&w->body, t->value, t->value_len) != OK ||
+        toksnap_put_lenbytes(&w->body, t->col_ref, t->col_ref_len) != OK ||
+        toksnap_put_u32(&w->body, t->pg_oid) != OK) {
+      goto fail;
+    }
+  }
+  return OK;
+
+fail:
+  if (w)
+    w->failed = 1;
+  return ERR;
+}
+
+AdbxStatus toksnap_writer_commit(TokSnapWriter *w, int dir_fd) {
+  if (!w || dir_fd < 0) {
+    toksnap_writer_clean(w);
+    return ERR;
+  }
+  if (w->failed || w->body.len > TOKSNAP_MAX_BYTES) {
+    toksnap_writer_clean(w);
+    return ERR;
+  }
+
+  if (w->n_sessions == 0) {
+    // Nothing resumable: make sure no stale snapshot outlives this run.
+    (void)unlinkat(dir_fd, TOKSNAP_FILENAME, 0);
+    toksnap_writer_clean(w);
+    return OK;
+  }
+
+  StrBuf image;
+  sb_init(&image);
+  AdbxStatus rc = ERR;
+  if (sb_append_bytes(&image, TOKSNAP_MAGIC, TOKSNAP_MAGIC_LEN) == OK &&
+      toksnap_put_u32(&image, TOKSNAP_FORMAT) == OK &&
+      toksnap_put_u32(&image, w->n_sessions) == OK &&
+      toksnap_put_u64(&image, rapidhash(w->body.data, w->body.len)) == OK &&
+      toksnap_put_u32(&image, (uint32_t)w->body.len) == OK &&
+      sb_append_bytes(&image, w->body.data, w->body.len) == OK) {
+    rc = (write_atomic(dir_fd, TOKSNAP_FILENAME, (const uint8_t *)image.data,
+                       image.len, NULL) == YES)
+             ? OK
+             : ERR;
+  }
+
+  sb_zero_clean(&image);
+  toksnap_writer_clean(w);
+  return rc;
+}
+
+/* ------------------------------- loading --------------------------------- */
+
+// Bounds-checked read cursor over the snapshot bytes.
+typedef struct TokSnapCur {
+  const uint8_t *p;
+  const uint8_t *end;
+} TokSnapCur;
+
+static AdbxStatus toksnap_get_bytes(TokSnapCur *c, void *dst, size_t n) {
+  if ((size_t)(c->end - c->p) < n)
+    return ERR;
+  memcpy(dst, c->p, n);
+  c->p += n;
+  return OK;
+}
+
+static AdbxStatus toksnap_get_u32(TokSnapCur *c, uint32_t *v) {
+  return toksnap_get_bytes(c, v, sizeof(*v));
+}
+
+static AdbxStatus toksnap_get_u64(TokSnapCur *c, uint64_t *v) {
+  return toksnap_get_bytes(c, v, sizeof(*v));
+}
+
+/* Copies one length-delimited byte run into the snapshot arena with a
+ * trailing NUL. '*out' stays NULL for the null marker. */
+static AdbxStatus toksnap_get_lenbytes(TokSnapCur *c, Arena *arena,
+                                       const char **out, uint32_t *out_len) {
+  *out = NULL;
+  *out_len = 0;
+  uint32_t len = 0;
+  if (toksnap_get_u32(c, &len) != OK)
+    return ERR;
+  if (len == TOKSNAP_NULL_STR)
+    return OK;
+  if ((size_t)(c->end - c->p) < len)
+    return ERR;
+  const char *d = (const char *)arena_add_nul(arena, (void *)c->p, len);
+  if (!d)
+    return ERR;
+  c->p += len;
+  *out = d;
+  *out_len = len;
+  return OK;
+}
+
+static AdbxStatus toksnap_decode_store(TokSnapCur *c, Arena *arena,
+                                       TokSnapStoreRec *rec) {
+  uint32_t name_len = 0;
+  if (toksnap_get_lenbytes(c, arena, &rec->connection_name, &name_len) != OK ||
+      !rec->connection_name || name_len == 0) {
+    return ERR;
+  }
+  if (toksnap_get_u32(c, &rec->n_toks) != OK)
+    return ERR;
+  if (rec->n_toks == 0)
+    return OK;
+  // Each token needs at least its three length/oid prefixes in the stream.
+  if ((size_t)(c->end - c->p) / (3u * sizeof(uint32_t)) < rec->n_toks)
+    return ERR;
+
+  rec->toks = (TokSnapTokRec *)arena_calloc(
+      arena, (uint32_t)(rec->n_toks * sizeof(*rec->toks)));
+  if (!rec->toks)
+    return ERR;
+
+  for (uint32_t i = 0; i < rec->n_toks; i++) {
+    TokSnapTokRec *t = &rec->toks[i];
+    if (toksnap_get_lenbytes(c, arena, &t->value, &t->value_len) != OK ||
+        toksnap_get_lenbytes(c, arena, &t->col_ref, &t->col_ref_len) != OK ||
+        toksnap_get_u32(c, &t->pg_oid) != OK) {
+      return ERR;
+    }
+    if (!t->col_ref || t->col_ref_len == 0)
+      return ERR;
+    if (!t->value && t->value_len != 0)
+      return ERR;
+  }
+  return OK;
+}
+
+static AdbxStatus toksnap_decode_session(TokSnapCur *c, Arena *arena,
+                                         TokSnapSession *sess) {
+  uint64_t created = 0, active = 0, used = 0;
+  if (toksnap_get_bytes(c, sess->resume_token, RESUME_TOKEN_LEN) != OK ||
+      toksnap_get_u32(c, &sess->generation) != OK ||
+      toksnap_get_u64(c, &created) != OK ||
+      toksnap_get_u64(c, &active) != OK || toksnap_get_u64(c, &used) != OK ||
+      toksnap_get_u32(c, &sess->n_stores) != OK) {
+    return ERR;
+  }
+  sess->created_at = (int64_t)created;
+  sess->last_active = (int64_t)active;
+  sess->tokens_last_used = (int64_t)used;
+  if (sess->n_stores == 0)
+    return OK;
+  // Each store needs at least its name prefix and token count.
+  if ((size_t)(c->end - c->p) / (2u * sizeof(uint32_t)) < sess->n_stores)
+    return ERR;
+
+  sess->stores = (TokSnapStoreRec *)arena_calloc(
+      arena, (uint32_t)(sess->n_stores * sizeof(*sess->stores)));
+  if (!sess->stores)
+    return ERR;
+  for (uint32_t s = 0; s < sess->n_stores; s++) {
+    if (toksnap_decode_store(c, arena, &sess->stores[s]) != OK)
+      return ERR;
+  }
+  return OK;
+}
+
+TokSnap *toksnap_load(int dir_fd) {
+  if (dir_fd < 0)
+    return NULL;
+
+  int flags = O_RDONLY;
+#ifdef O_NOFOLLOW
+  flags |= O_NOFOLLOW;
+#endif
+  int fd = openat(dir_fd, TOKSNAP_FILENAME, flags);
+  if (fd < 0)
+    return NULL;
+
+  // Single use either way: a snapshot (valid or not) never survives the load
+  // attempt, so it cannot be replayed against a later broker generation.
+  (void)unlinkat(dir_fd, TOKSNAP_FILENAME, 0);
+
+  TokSnap *snap = NULL;
+  FileMap map = {0};
+  int mapped = 0;
+  if (validate_uown_file(fd, 0600) != OK)
+    goto done;
+  if (fileio_map_ro_fd(fd, TOKSNAP_MAX_BYTES, &map) != OK)
+    goto done;
+  mapped = 1;
+  if (map.len < TOKSNAP_HEADER_LEN)
+    goto done;
+
+  TokSnapCur c = {.p = map.data, .end = map.data + map.len};
+  char magic[TOKSNAP_MAGIC_LEN];
+  uint32_t format = 0, n_sessions = 0, body_len = 0;
+  uint64_t body_hash = 0;
+  if (toksnap_get_bytes(&c, magic, TOKSNAP_MAGIC_LEN) != OK ||
+      memcmp(magic, TOKSNAP_MAGIC, TOKSNAP_MAGIC_LEN) != 0 ||
+      toksnap_get_u32(&c, &format) != OK || format != TOKSNAP_FORMAT ||
+      toksnap_get_u32(&c, &n_sessions) != OK ||
+      toksnap_get_u64(&c, &body_hash) != OK ||
+      toksnap_get_u32(&c, &body_len) != OK) {
+    goto done;
+  }
+  if (n_sessions == 0 || n_sessions > TOKSNAP_MAX_SESSIONS)
+    goto done;
+  if ((size_t)(c.end - c.p) != body_len ||
+      rapidhash(c.p, body_len) != body_hash) {
+    goto done;
+  }
+
+  snap = (TokSnap *)xcalloc(1, sizeof(*snap));
+  if (arena_init(&snap->arena, NULL, NULL) != OK) {
+    free(snap);
+    snap = NULL;
+    goto done;
+  }
+  snap->sessions = (TokSnapSession *)arena_calloc(
+      &snap->arena, (uint32_t)(n_sessions * sizeof(*snap->sessions)));
+  if (!snap->sessions) {
+    toksnap_destroy(snap);
+    snap = NULL;
+    goto done;
+  }
+  snap->n_sessions = n_sessions;
+
+  for (uint32_t i = 0; i < n_sessions; i++) {
+    if (toksnap_decode_session(&c, &snap->arena, &snap->sessions[i]) != OK) {
+      toksnap_destroy(snap);
+      snap = NULL;
+      goto done;
+    }
+  }
+  if (c.p != c.end) {
+    toksnap_destroy(snap);
+    snap = NULL;
+  }
+
+done:
+  if (mapped)
+    fileio_map_clean(&map);
+  close(fd);
+  return snap;
+}
+
+uint32_t toksnap_n_sessions(const TokSnap *snap) {
+  return snap ? snap->n_sessions : 0;
+}
+
+const TokSnapSession *toksnap_session_at(const TokSnap *snap, uint32_t idx) {
+  if (!snap || idx >= snap->n_sessions)
+    return NULL;
+  return &snap->sessions[idx];
+}
+
+AdbxStatus toksnap_restore_store(const TokSnapSession *sess,
+                                 const char *connection_name,
+                                 uint32_t generation, DbTokenStore *store) {
+  if (!sess || !connection_name || !store)
+    return ERR;
+
+  const TokSnapStoreRec *rec = NULL;
+  for (uint32_t s = 0; s < sess->n_stores; s++) {
+    if (strcmp(sess->stores[s].connection_name, connection_name) == 0) {
+      rec = &sess->stores[s];
+      break;
+    }
+  }
+  if (!rec)
+    return OK; // this connection minted nothing before the restart
+
+  for (uint32_t i = 0; i < rec->n_toks; i++) {
+    const TokSnapTokRec *t = &rec->toks[i];
+    SensitiveTokIn in = {
+        .value = t->value,
+        .value_len = t->value_len,
+        .col_ref = t->col_ref,
+        .col_ref_len = t->col_ref_len,
+        .pg_oid = t->pg_oid,
+    };
+    char minted[SENSITIVE_TOK_BUFSZ];
+    char expected[SENSITIVE_TOK_BUFSZ];
+    if (stok_store_create_token(store, generation, &in, minted) < 0)
+      return ERR;
+    // Outstanding handles encode the pre-restart index; a replay that lands
+    // anywhere else (e.g. a store-mode change collapsed entries) would
+    // resolve them to the wrong value, so stop instead.
+    if (stok_store_format_token(store, generation, i, expected) < 0 ||
+        strcmp(minted, expected) != 0) {
+      return ERR;
+    }
+  }
+  return OK;
+}
+
+void toksnap_destroy(TokSnap *snap) {
+  if (!snap)
+    return;
+  // Decoded bytes hold plaintext sensitive values.
+  if (arena_is_zeroed(&snap->arena) == NO) {
+    arena_zero_mem(&snap->arena);
+    arena_clean(&snap->arena);
+  }
+  free(snap);
+}
@@ -0,0 +1,142 @@
+#ifndef TOKEN_SNAPSHOT_H
+#define TOKEN_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "handshake_codec.h"
+#include "sensitive_tok.h"
+#include "string_op.h"
+#include "utils.h"
+
+// File name of the token-store snapshot inside the private-dir app directory
+// (the app dir survives broker restarts; run/ and secret/ do not).
+#define TOKSNAP_FILENAME "token_stores.snap"
+
+/* Persisted token-store snapshots: on clean shutdown the broker serializes
+ * resumable sessions' token stores into one 0600 file under the private-dir
+ * app directory, and after restart a reconnecting client whose resume token
+ * matches a persisted session gets its tok_ handles back. The file follows
+ * the secret-store file model — owner-validated permission-protected bytes
+ * written atomically — and is strictly single-use: toksnap_load() unlinks it,
+ * so a snapshot can never be replayed against a later broker generation.
+ */
+
+/* One persisted token entry; string pointers borrow snapshot-owned memory
+ * that lives until toksnap_destroy(). 'value' is NULL for SQL NULL. */
+typedef struct TokSnapTokRec {
+  const char *value;
+  uint32_t value_len;
+  const char *col_ref;
+  uint32_t col_ref_len;
+  uint32_t pg_oid;
+} TokSnapTokRec;
+
+/* All tokens one session minted through one connection's store, in index
+ * order (replaying them in order reproduces the handle indices). */
+typedef struct TokSnapStoreRec {
+  const char *connection_name;
+  TokSnapTokRec *toks;
+  uint32_t n_toks;
+} TokSnapStoreRec;
+
+/* One persisted resumable session. */
+typedef struct TokSnapSession {
+  uint8_t resume_token[RESUME_TOKEN_LEN];
+  uint32_t generation;
+  int64_t created_at;
+  int64_t last_active;
+  int64_t tokens_last_used;
+  TokSnapStoreRec *stores;
+  uint32_t n_stores;
+} TokSnapSession;
+
+/* Owns all decoded sessions and their backing bytes. */
+typedef struct TokSnap TokSnap;
+
+/* Incremental snapshot writer; the broker appends sessions and stores, then
+ * commits the whole image in one atomic write. */
+typedef struct TokSnapWriter {
+  StrBuf body;
+  uint32_t n_sessions;
+  int failed; // sticky: a failed append poisons the commit
+} TokSnapWriter;
+
+/* Initializes one writer. Side effects: none beyond buffer init. */
+void toksnap_writer_init(TokSnapWriter *w);
+
+/* Appends one session header. 'n_stores' store records must follow before the
+ * next session or the commit.
+ * It borrows all inputs and copies the token bytes.
+ * Error semantics: returns OK on success, ERR on invalid input or allocation
+ * failure (the writer is poisoned and commit will fail).
+ */
+AdbxStatus toksnap_writer_session(TokSnapWriter *w,
+                                  const uint8_t token[RESUME_TOKEN_LEN],
+                                  uint32_t generation, int64_t created_at,
+                                  int64_t last_active,
+                                  int64_t tokens_last_used, uint32_t n_stores);
+
+/* Appends one store record: the connection name plus every token entry of
+ * 'store' in index order.
+ * It borrows both inputs; token values are copied into the image.
+ * Error semantics: returns OK on success, ERR on invalid input or allocation
+ * failure (the writer is poisoned).
+ */
+AdbxStatus toksnap_writer_store(TokSnapWriter *w, const char *connection_name,
+                                const DbTokenStore *store);
+
+/* Re-emits one decoded store record unchanged. Used for stores a restored
+ * session never re-materialized before the next clean shutdown: their lazy
+ * restore must survive a second restart.
+ * Error semantics: returns OK on success, ERR on invalid input or allocation
+ * failure (the writer is poisoned).
+ */
+AdbxStatus toksnap_writer_store_rec(TokSnapWriter *w,
+                                    const TokSnapStoreRec *rec);
+
+/* Atomically writes the accumulated image as TOKSNAP_FILENAME inside 'dir_fd'
+ * with 0600 perms; with zero sessions it removes any stale snapshot instead.
+ * Side effects: filesystem write/unlink; the writer buffer is zeroed and
+ * released in every outcome (plaintext values leave no heap residue).
+ * Error semantics: returns OK on success, ERR on a poisoned writer or I/O
+ * failure.
+ */
+AdbxStatus toksnap_writer_commit(TokSnapWriter *w, int dir_fd);
+
+/* Releases one writer without committing, zeroing the buffered plaintext. */
+void toksnap_writer_clean(TokSnapWriter *w);
+
+/* Loads and consumes the snapshot inside 'dir_fd': validates that the file is
+ * a user-owned 0600 regular file with an intact body hash, decodes it, and
+ * unlinks it so the snapshot cannot be resumed twice.
+ * Error semantics: returns an owned TokSnap on success, NULL when the file is
+ * missing, fails validation, or is malformed (a bad file is still unlinked —
+ * fail-soft, sessions simply start without restored tokens).
+ */
+TokSnap *toksnap_load(int dir_fd);
+
+/* Returns the number of persisted sessions; 0 on NULL input. */
+uint32_t toksnap_n_sessions(const TokSnap *snap);
+
+/* Returns the borrowed session record at 'idx', NULL when out of range. */
+const TokSnapSession *toksnap_session_at(const TokSnap *snap, uint32_t idx);
+
+/* Replays the persisted tokens of 'connection_name' into a freshly created
+ * 'store', verifying after each mint that the handle lands on its original
+ * index (so outstanding tok_ handles resolve to the same entries).
+ * It borrows all inputs; value bytes are copied into the store's arena by the
+ * mint path itself.
+ * Error semantics: returns OK when the connection has no persisted store or
+ * every token replayed onto its original index, ERR on invalid input or a
+ * mint/index failure (the store keeps the tokens replayed so far; their
+ * handles stay valid).
+ */
+AdbxStatus toksnap_restore_store(const TokSnapSession *sess,
+                                 const char *connection_name,
+                                 uint32_t generation, DbTokenStore *store);
+
+/* Destroys one snapshot, zeroing the decoded plaintext before release.
+ * Safe on NULL. */
+void toksnap_destroy(TokSnap *snap);
+
+#endif
@@ -0,0 +1,471 @@
+#define _GNU_SOURCE
+#include "uring_byte_channel.h"
+#include "utils.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Submission queue depth; queuing a write past this forces a flush first.
+#define URING_BC_SQ_ENTRIES 16u
+// Registered staging buffer. Sized for the hot path — a burst of response
+// frames — while one oversized payload just takes the sync-write fallback.
+#define URING_BC_STAGING_BYTES (64u * 1024u)
+
+typedef struct UringByteChannelImpl {
+  int fd;      // owned full-duplex socket
+  int ring_fd; // owned io_uring instance
+  int is_closed;
+
+  // Ring mappings (cq may alias sq under IORING_FEAT_SINGLE_MMAP).
+  void *sq_ptr;
+  size_t sq_map_len;
+  void *cq_ptr;
+  size_t cq_map_len;
+  struct io_uring_sqe *sqes;
+  size_t sqes_map_len;
+
+  // Cached ring geometry/pointers.
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned cq_mask;
+  struct io_uring_cqe *cqes;
+
+  // Kernel-registered write staging: queued writes copy here so caller
+  // buffers never outlive the syscall that consumes them. Linear within one
+  // flush epoch; reset once the batch completes.
+  uint8_t *staging;
+  uint32_t staging_used;
+
+  // Per queued-but-unsubmitted write: staging offset and length, in queue
+  // order (entries are IOSQE_IO_LINK-chained so the socket sees them in
+  // order).
+  struct {
+    uint32_t off;
+    uint32_t len;
+  } pending[URING_BC_SQ_ENTRIES];
+  uint32_t n_pending;
+} UringByteChannelImpl;
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit,
+                              unsigned min_complete, unsigned flags) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg,
+                                 unsigned nr_args) {
+  return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/* Claims the next free submission entry; the caller fills it and bumps the
+ * tail. Returns NULL when the submission queue is full. */
+static struct io_uring_sqe *uring_bc_get_sqe(UringByteChannelImpl *impl) {
+  unsigned head = __atomic_load_n(impl->sq_head, __ATOMIC_ACQUIRE);
+  unsigned tail = *impl->sq_tail;
+  if (tail - head >= URING_BC_SQ_ENTRIES)
+    return NULL;
+  struct io_uring_sqe *sqe = &impl->sqes[tail & impl->sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  impl->sq_array[tail & impl->sq_mask] = tail & impl->sq_mask;
+  return sqe;
+}
+
+static void uring_bc_advance_sq(UringByteChannelImpl *impl) {
+  __atomic_store_n(impl->sq_tail, *impl->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Pops one completion if available. Returns YES with '*out' filled, NO when
+ * the completion queue is empty. */
+static AdbxTriStatus uring_bc_pop_cqe(UringByteChannelImpl *impl,
+                                      struct io_uring_cqe *out) {
+  unsigned head = *impl->cq_head;
+  unsigned tail = __atomic_load_n(impl->cq_tail, __ATOMIC_ACQUIRE);
+  if (head == tail)
+    return NO;
+  *out = impl->cqes[head & impl->cq_mask];
+  __atomic_store_n(impl->cq_head, head + 1, __ATOMIC_RELEASE);
+  return YES;
+}
+
+/* Submits 'to_submit' queued entries and waits for 'min_complete'
+ * completions, retrying on EINTR. Returns OK or ERR (errno holds the cause).
+ */
+static AdbxStatus uring_bc_enter(UringByteChannelImpl *impl,
+                                 unsigned to_submit, unsigned min_complete) {
+  for (;;) {
+    int rc = sys_io_uring_enter(impl->ring_fd, to_submit, min_complete,
+                                IORING_ENTER_GETEVENTS);
+    if (rc >= 0)
+      return OK;
+    if (errno == EINTR) {
+      // Submission may have partially happened; only completions remain.
+      to_submit = 0;
+      continue;
+    }
+    return ERR;
+  }
+}
+
+/* Writes 'len' bytes from 'src' with plain write(2), looping over partial
+ * writes and EINTR. Used to recover short/canceled batch entries and for
+ * payloads larger than the staging buffer. */
+static AdbxStatus uring_bc_write_sync(int fd, const uint8_t *src, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, src, len);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return ERR;
+    }
+    src += (size_t)n;
+    len -= (size_t)n;
+  }
+  return OK;
+}
+
+/* Submits every queued write in one io_uring_enter() and reconciles the
+ * completions, finishing short or canceled entries synchronously from the
+ * staging copy. Resets the staging epoch.
+ * Error semantics: returns OK when every queued byte reached the socket,
+ * ERR otherwise (the queue and staging are reset either way).
+ */
+static AdbxStatus uring_bc_flush_impl(UringByteChannelImpl *impl) {
+  uint32_t n = impl->n_pending;
+  if (n == 0)
+    return OK;
+
+  AdbxStatus rc = OK;
+  if (uring_bc_enter(impl, n, n) != OK) {
+    // Submission itself failed: nothing reached the kernel, fall back to
+    // writing the whole epoch synchronously in order.
+    for (uint32_t i = 0; i < n && rc == OK; i++) {
+      rc = uring_bc_write_sync(impl->fd, impl->staging + impl->pending[i].off,
+                               impl->pending[i].len);
+    }
+    impl->n_pending = 0;
+    impl->staging_used = 0;
+    return rc;
+  }
+
+  for (uint32_t i = 0; i < n; i++) {
+    struct io_uring_cqe cqe;
+    if (uring_bc_pop_cqe(impl, &cqe) != YES) {
+      // Fewer completions than submissions after a min_complete wait means
+      // the ring is in a state we cannot reconcile; fail the write.
+      rc = ERR;
+      break;
+    }
+    uint32_t idx = (uint32_t)cqe.user_data;
+    if (idx >= n) {
+      rc = ERR;
+      break;
+    }
+    uint32_t want = impl->pending[idx].len;
+    if (cqe.res == (int32_t)want)
+      continue;
+    if (cqe.res < 0 && cqe.res != -ECANCELED) {
+      rc = ERR;
+      break;
+    }
+    // Short write, or a link canceled behind one: finish from staging.
+    uint32_t done = (cqe.res > 0) ? (uint32_t)cqe.res : 0u;
+    if (uring_bc_write_sync(impl->fd,
+                            impl->staging + impl->pending[idx].off + done,
+                            want - done) != OK) {
+      rc = ERR;
+      break;
+    }
+  }
+
+  impl->n_pending = 0;
+  impl->staging_used = 0;
+  return rc;
+}
+
+/* Copies 'len' bytes into staging and queues one linked WRITE_FIXED entry.
+ * No syscall happens here; flush() submits the batch.
+ * Error semantics: returns OK on success, ERR when a forced flush of a full
+ * queue/staging fails. */
+static AdbxStatus uring_bc_queue_write(UringByteChannelImpl *impl,
+                                       const uint8_t *src, uint32_t len) {
+  if (impl->n_pending >= URING_BC_SQ_ENTRIES ||
+      impl->staging_used + len > URING_BC_STAGING_BYTES) {
+    if (uring_bc_flush_impl(impl) != OK)
+      return ERR;
+  }
+
+  struct io_uring_sqe *sqe = uring_bc_get_sqe(impl);
+  if (!sqe) {
+    // Queue slots are bounded by n_pending, so this cannot happen after the
+    // flush above; treat it as a ring inconsistency.
+    return ERR;
+  }
+
+  memcpy(impl->staging + impl->staging_used, src, len);
+  sqe->opcode = IORING_OP_WRITE_FIXED;
+  sqe->fd = impl->fd;
+  sqe->addr = (uint64_t)(uintptr_t)(impl->staging + impl->staging_used);
+  sqe->len = len;
+  sqe->buf_index = 0;
+  // Chain queued writes so the socket sees them in queue order.
+  sqe->flags = IOSQE_IO_LINK;
+  sqe->user_data = impl->n_pending;
+
+  impl->pending[impl->n_pending].off = impl->staging_used;
+  impl->pending[impl->n_pending].len = len;
+  impl->n_pending++;
+  impl->staging_used += len;
+  uring_bc_advance_sq(impl);
+  return OK;
+}
+
+static ssize_t uring_read_some(ByteChannel *ch, void *buf, size_t cap) {
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (!impl || impl->is_closed || impl->fd < 0)
+    return -1;
+  if (cap == 0)
+    return 0;
+  // Reads and queued writes share one ring; submit any staged writes first so
+  // the read completion is the only one in flight.
+  if (impl->n_pending > 0 && uring_bc_flush_impl(impl) != OK)
+    return -1;
+
+  struct io_uring_sqe *sqe = uring_bc_get_sqe(impl);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = impl->fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = (uint32_t)((cap > UINT32_MAX) ? UINT32_MAX : cap);
+  sqe->user_data = UINT64_MAX; // distinguishes reads from write batches
+  uring_bc_advance_sq(impl);
+
+  if (uring_bc_enter(impl, 1, 1) != OK)
+    return -1;
+  struct io_uring_cqe cqe;
+  if (uring_bc_pop_cqe(impl, &cqe) != YES || cqe.user_data != UINT64_MAX)
+    return -1;
+  if (cqe.res < 0) {
+    errno = -cqe.res;
+    return -1;
+  }
+  return (ssize_t)cqe.res;
+}
+
+static ssize_t uring_write_some(ByteChannel *ch, const void *buf, size_t len) {
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (!impl || impl->is_closed || impl->fd < 0)
+    return -1;
+  if (len == 0)
+    return 0;
+
+  if (len > URING_BC_STAGING_BYTES) {
+    // Oversized payload: drain the batch, then write it synchronously (the
+    // caller's buffer cannot be staged, so it must not outlive this call).
+    if (uring_bc_flush_impl(impl) != OK)
+      return -1;
+    if (uring_bc_write_sync(impl->fd, (const uint8_t *)buf, len) != OK)
+      return -1;
+    return (ssize_t)len;
+  }
+
+  if (uring_bc_queue_write(impl, (const uint8_t *)buf, (uint32_t)len) != OK)
+    return -1;
+  return (ssize_t)len;
+}
+
+static ssize_t uring_writev_some(ByteChannel *ch, const ByteChannelVec *vecs,
+                                 int vcnt) {
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (!impl || impl->is_closed || impl->fd < 0)
+    return -1;
+  if (!vecs || vcnt <= 0)
+    return -1;
+
+  ssize_t total = 0;
+  for (int i = 0; i < vcnt; i++) {
+    ssize_t n = uring_write_some(ch, vecs[i].base, vecs[i].len);
+    if (n < 0)
+      return (total > 0) ? total : -1;
+    total += n;
+  }
+  return total;
+}
+
+static AdbxStatus uring_flush(ByteChannel *ch) {
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (!impl || impl->is_closed || impl->fd < 0)
+    return ERR;
+  return uring_bc_flush_impl(impl);
+}
+
+static AdbxStatus uring_shutdown_write(ByteChannel *ch) {
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (!impl || impl->is_closed || impl->fd < 0)
+    return ERR;
+  AdbxStatus rc = uring_bc_flush_impl(impl);
+  if (shutdown(impl->fd, SHUT_WR) != 0)
+    return ERR;
+  return rc;
+}
+
+static BytePollable uring_get_pollable(const ByteChannel *ch) {
+  const UringByteChannelImpl *impl = (const UringByteChannelImpl *)ch->impl;
+  return (BytePollable)(impl ? impl->fd : -1);
+}
+
+static void uring_bc_unmap(UringByteChannelImpl *impl) {
+  if (impl->sqes && impl->sqes != MAP_FAILED)
+    munmap(impl->sqes, impl->sqes_map_len);
+  if (impl->cq_ptr && impl->cq_ptr != MAP_FAILED &&
+      impl->cq_ptr != impl->sq_ptr)
+    munmap(impl->cq_ptr, impl->cq_map_len);
+  if (impl->sq_ptr && impl->sq_ptr != MAP_FAILED)
+    munmap(impl->sq_ptr, impl->sq_map_len);
+  impl->sq_ptr = NULL;
+  impl->cq_ptr = NULL;
+  impl->sqes = NULL;
+}
+
+static void uring_destroy(ByteChannel *ch) {
+  if (!ch)
+    return;
+  UringByteChannelImpl *impl = (UringByteChannelImpl *)ch->impl;
+  if (impl) {
+    if (!impl->is_closed && impl->fd >= 0)
+      (void)uring_bc_flush_impl(impl); // best effort
+    uring_bc_unmap(impl);
+    if (impl->ring_fd >= 0)
+      close(impl->ring_fd);
+    if (impl->fd >= 0)
+      close(impl->fd);
+    free(impl->staging);
+    free(impl);
+  }
+  free(ch);
+}
+
+static const ByteChannelVTable URING_BYTECH_VT = {
+    .read_some = uring_read_some,
+    .write_some = uring_write_some,
+    .writev_some = uring_writev_some,
+    .flush = uring_flush,
+    .shutdown_write = uring_shutdown_write,
+    .get_pollable = uring_get_pollable,
+    .destroy = uring_destroy,
+};
+
+/* Sets up the ring, maps its queues, and registers the staging buffer.
+ * Returns OK on success, ERR on any setup/mmap/register failure (resources
+ * acquired so far stay in 'impl' for the caller to release). */
+static AdbxStatus uring_bc_ring_init(UringByteChannelImpl *impl) {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  impl->ring_fd = sys_io_uring_setup(URING_BC_SQ_ENTRIES, &p);
+  if (impl->ring_fd < 0)
+    return ERR;
+
+  size_t sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  size_t cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (cq_sz > sq_sz)
+      sq_sz = cq_sz;
+    cq_sz = sq_sz;
+  }
+
+  impl->sq_map_len = sq_sz;
+  impl->sq_ptr = mmap(NULL, sq_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, impl->ring_fd,
+                      IORING_OFF_SQ_RING);
+  if (impl->sq_ptr == MAP_FAILED)
+    return ERR;
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    impl->cq_ptr = impl->sq_ptr;
+    impl->cq_map_len = cq_sz;
+  } else {
+    impl->cq_map_len = cq_sz;
+    impl->cq_ptr = mmap(NULL, cq_sz, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, impl->ring_fd,
+                        IORING_OFF_CQ_RING);
+    if (impl->cq_ptr == MAP_FAILED)
+      return ERR;
+  }
+
+  impl->sqes_map_len = p.sq_entries * sizeof(struct io_uring_sqe);
+  impl->sqes = mmap(NULL, impl->sqes_map_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, impl->ring_fd, IORING_OFF_SQES);
+  if (impl->sqes == MAP_FAILED)
+    return ERR;
+
+  uint8_t *sq = (uint8_t *)impl->sq_ptr;
+  uint8_t *cq = (uint8_t *)impl->cq_ptr;
+  impl->sq_head = (unsigned *)(sq + p.sq_off.head);
+  impl->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  impl->sq_mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+  impl->sq_array = (unsigned *)(sq + p.sq_off.array);
+  impl->cq_head = (unsigned *)(cq + p.cq_off.head);
+  impl->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  impl->cq_mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+  impl->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  struct iovec reg = {.iov_base = impl->staging,
+                      .iov_len = URING_BC_STAGING_BYTES};
+  if (sys_io_uring_register(impl->ring_fd, IORING_REGISTER_BUFFERS, &reg, 1) <
+      0)
+    return ERR;
+  return OK;
+}
+
+ByteChannel *uring_bytechannel_open_fd(int fd) {
+  if (fd < 0)
+    return NULL;
+
+  UringByteChannelImpl *impl =
+      (UringByteChannelImpl *)xcalloc(1, sizeof(*impl));
+  impl->fd = -1; // ownership transfers only on success
+  impl->ring_fd = -1;
+  impl->staging = (uint8_t *)xmalloc(URING_BC_STAGING_BYTES);
+
+  if (uring_bc_ring_init(impl) != OK) {
+    uring_bc_unmap(impl);
+    if (impl->ring_fd >= 0)
+      close(impl->ring_fd);
+    free(impl->staging);
+    free(impl);
+    return NULL;
+  }
+  impl->fd = fd;
+
+  ByteChannel *ch = (ByteChannel *)xmalloc(sizeof(*ch));
+  ch->vt = &URING_BYTECH_VT;
+  ch->impl = impl;
+  return ch;
+}
+
+#else /* !__linux__ */
+
+ByteChannel *uring_bytechannel_open_fd(int fd) {
+  (void)fd;
+  return NULL;
+}
+
+#endif
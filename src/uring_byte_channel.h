@@ -0,0 +1,30 @@
+#ifndef URING_BYTE_CHANNEL_H
+#define URING_BYTE_CHANNEL_H
+
+#include "byte_channel.h"
+
+/* io_uring-backed ByteChannel (Linux only).
+ *
+ * Writes are staged into a kernel-registered buffer and queued as linked
+ * submission entries without any syscall; the single io_uring_enter() in
+ * flush() submits and completes the whole batch, so a response made of many
+ * small frames costs one syscall instead of one per write. bufio's
+ * bufch_write2v()/bufch_writev_all() already flush once per frame group, so
+ * callers get the batching without changes. Reads stay one submission +
+ * completion per call (the event loop wakes per readable fd anyway).
+ *
+ * Partial or canceled write completions are recovered synchronously from the
+ * staging buffer during flush, so the all-bytes-written contract of
+ * bufch_write_all() holds.
+ */
+
+/* Creates an owning io_uring channel over one full-duplex 'fd'.
+ * Ownership: takes ownership of 'fd' only on success; bytech_destroy()
+ * closes it and releases the ring.
+ * Error semantics: returns NULL on invalid input, on non-Linux builds, or
+ * when the kernel rejects io_uring (not compiled in, seccomp, resource
+ * limits) — callers fall back to the fd-based channel.
+ */
+ByteChannel *uring_bytechannel_open_fd(int fd);
+
+#endif
@@ -46,6 +46,13 @@ uint64_t now_ms_monotonic(void) {
   return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
 }
 
+/* Returns monotonic time in us (for stage-level duration calculations). */
+uint64_t now_us_monotonic(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
 AdbxStatus fill_random(uint8_t *buf, size_t len) {
 #ifdef __linux__
   size_t done = 0;
@@ -29,6 +29,9 @@ void *xrealloc(void *ptr, size_t size);
 /* Returns monotonic time in ms (for duration calculations). */
 uint64_t now_ms_monotonic(void);
 
+/* Returns monotonic time in us (for stage-level duration calculations). */
+uint64_t now_us_monotonic(void);
+
 /* Fills 'len' bytes of 'buf' with cryptographically secure random bytes.
  * Returns OK/ERR. */
 AdbxStatus fill_random(uint8_t *buf, size_t len);
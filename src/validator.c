@@ -1,4 +1,5 @@
 #include "validator.h"
+#include "hash_table.h"
 #include "log.h"
 #include "query_ir.h"
 #include "utils.h"
@@ -110,22 +111,16 @@ static AdbxStatus set_err(ValidatorCtx *ctx, ValidatorErrCode code,
  * Error semantics: returns OK on success, ERR on invalid input or allocation
  * failure.
  */
-static AdbxStatus vq_out_reset(ValidateQueryOut *out) {
-  assert(out != NULL);
-  assert(out->plan.cols != NULL);
-
-  parr_destroy(out->plan.cols);
-  out->plan.cols = parr_create(sizeof(ValidatorColPlan));
-  if (!out->plan.cols)
+AdbxStatus vq_out_reset(ValidateQueryOut *out) {
+  if (!out || !out->plan.cols)
     return ERR;
 
-  arena_clean(&out->plan.arena);
-  if (arena_init(&out->plan.arena, NULL, NULL) != OK) {
-    parr_destroy(out->plan.cols);
-    out->plan.cols = NULL;
-    return ERR;
-  }
+  // Warm reuse: the column array keeps its capacity and the arena keeps its
+  // converged block, so a reset is a handful of pointer/length stores.
+  parr_reset(out->plan.cols);
+  arena_reset(&out->plan.arena);
 
+  out->plan.limit_value = -1;
   out->err.code = VERR_NONE;
   sb_reset(&out->err.msg);
   return OK;
@@ -260,14 +255,19 @@ static inline const QirFromItem *find_from_alias(const QirQuery *q,
   if (!q || !alias || alias[0] == '\0')
     return NULL;
 
+  // Backends intern identifiers through one pool per query handle, so equal
+  // names are usually the same pointer; the strcmp fallback keeps hand-built
+  // IR (tests) correct.
   if (q->from_root && q->from_root->alias.name &&
-      strcmp(q->from_root->alias.name, alias) == 0)
+      (q->from_root->alias.name == alias ||
+       strcmp(q->from_root->alias.name, alias) == 0))
     return q->from_root;
   for (uint32_t i = 0; i < q->njoins; i++) {
     const QirJoin *j = q->joins[i];
     if (!j || !j->rhs)
       continue;
-    if (j->rhs->alias.name && strcmp(j->rhs->alias.name, alias) == 0)
+    if (j->rhs->alias.name &&
+        (j->rhs->alias.name == alias || strcmp(j->rhs->alias.name, alias) == 0))
       return j->rhs;
   }
   return NULL;
@@ -580,11 +580,6 @@ static AdbxTriStatus validate_expr_subqueries(
   return ERR;
 }
 
-static AdbxTriStatus validate_expr_subqueries_pass_a(ValidatorCtx *ctx,
-                                                     const QirExpr *e) {
-  return validate_expr_subqueries(ctx, e, validate_query_pass_a);
-}
-
 /* Returns YES if sensitive touches are only in allowed scopes and sets
  * 'found_sensitive' to true if it saw at least one sensitive column.
  *
@@ -659,23 +654,45 @@ static AdbxTriStatus validator_is_function_safe(ValidatorCtx *ctx,
 
   if (list && list->names && list->count > 0) {
     // backend list is always global
-    char *safe_name =
-        bsearch(name, list->names, list->count, sizeof(char *), name_cpm);
-    if (safe_name)
-      return YES;
+    if (list->index) {
+      if (ht_get(list->index, name, strlen(name)))
+        return YES;
+    } else {
+      char *safe_name =
+          bsearch(name, list->names, list->count, sizeof(char *), name_cpm);
+      if (safe_name)
+        return YES;
+    }
   }
 
   return connp_is_func_safe(ctx->cp, schema, name);
 }
 
-/* Validates that all function calls in an expression tree are safe to call.
- * Returns YES/NO/ERR and sets err when returning NO/ERR. */
-static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
-                                             const QirExpr *e) {
+/* Fused Pass A expression visitor. One walk checks function safety,
+ * parameter placement, unsupported nodes, and recurses into nested
+ * subqueries; Pass A used to traverse every clause three times for these
+ * concerns, which scaled badly on deeply nested queries. 'allow_params' is
+ * nonzero only for WHERE, where validate_params_where() owns the placement
+ * rules instead.
+ * Returns YES/NO/ERR and sets err when not returning YES. */
+static AdbxTriStatus validate_expr_pass_a(ValidatorCtx *ctx, const QirExpr *e,
+                                          int allow_params) {
   if (!e)
     return YES;
 
   switch (e->kind) {
+  case QIR_EXPR_SUBQUERY:
+    return validate_query_pass_a(ctx, e->u.subquery);
+  case QIR_EXPR_PARAM:
+    if (!allow_params) {
+      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
+              "Parameters are only allowed inside WHERE.");
+      return NO;
+    }
+    return YES;
+  case QIR_EXPR_COLREF:
+  case QIR_EXPR_LITERAL:
+    return YES;
   case QIR_EXPR_FUNCALL: {
     const char *name = e->u.funcall.name.name;
     if (!name || name[0] == '\0') {
@@ -697,7 +714,7 @@ static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
     }
 
     for (uint32_t i = 0; i < e->u.funcall.nargs; i++) {
-      rc = validate_expr_functions(ctx, e->u.funcall.args[i]);
+      rc = validate_expr_pass_a(ctx, e->u.funcall.args[i], allow_params);
       if (rc != YES)
         return rc;
     }
@@ -725,24 +742,25 @@ static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
     }
 
     for (uint32_t i = 0; i < e->u.window.func.nargs; i++) {
-      rc = validate_expr_functions(ctx, e->u.window.func.args[i]);
+      rc = validate_expr_pass_a(ctx, e->u.window.func.args[i], allow_params);
       if (rc != YES)
         return rc;
     }
     for (uint32_t i = 0; i < e->u.window.n_partition_by; i++) {
-      rc = validate_expr_functions(ctx, e->u.window.partition_by[i]);
+      rc = validate_expr_pass_a(ctx, e->u.window.partition_by[i],
+                                allow_params);
       if (rc != YES)
         return rc;
     }
     for (uint32_t i = 0; i < e->u.window.n_order_by; i++) {
-      rc = validate_expr_functions(ctx, e->u.window.order_by[i]);
+      rc = validate_expr_pass_a(ctx, e->u.window.order_by[i], allow_params);
       if (rc != YES)
         return rc;
     }
     return YES;
   }
   case QIR_EXPR_CAST:
-    return validate_expr_functions(ctx, e->u.cast.expr);
+    return validate_expr_pass_a(ctx, e->u.cast.expr, allow_params);
   case QIR_EXPR_EQ:
   case QIR_EXPR_NE:
   case QIR_EXPR_GT:
@@ -753,19 +771,19 @@ static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
   case QIR_EXPR_NOT_LIKE:
   case QIR_EXPR_AND:
   case QIR_EXPR_OR: {
-    int rc = validate_expr_functions(ctx, e->u.bin.l);
+    int rc = validate_expr_pass_a(ctx, e->u.bin.l, allow_params);
     if (rc != YES)
       return rc;
-    return validate_expr_functions(ctx, e->u.bin.r);
+    return validate_expr_pass_a(ctx, e->u.bin.r, allow_params);
   }
   case QIR_EXPR_NOT:
-    return validate_expr_functions(ctx, e->u.bin.l);
+    return validate_expr_pass_a(ctx, e->u.bin.l, allow_params);
   case QIR_EXPR_IN: {
-    int rc = validate_expr_functions(ctx, e->u.in_.lhs);
+    int rc = validate_expr_pass_a(ctx, e->u.in_.lhs, allow_params);
     if (rc != YES)
       return rc;
     for (uint32_t i = 0; i < e->u.in_.nitems; i++) {
-      rc = validate_expr_functions(ctx, e->u.in_.items[i]);
+      rc = validate_expr_pass_a(ctx, e->u.in_.items[i], allow_params);
       if (rc != YES)
         return rc;
     }
@@ -773,7 +791,7 @@ static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
   }
   case QIR_EXPR_CASE: {
     if (e->u.case_.arg) {
-      int rc = validate_expr_functions(ctx, e->u.case_.arg);
+      int rc = validate_expr_pass_a(ctx, e->u.case_.arg, allow_params);
       if (rc != YES)
         return rc;
     }
@@ -784,23 +802,18 @@ static AdbxTriStatus validate_expr_functions(ValidatorCtx *ctx,
                 "Invalid query structure (NULL CASE WHEN).");
         return ERR;
       }
-      int rc = validate_expr_functions(ctx, w->when_expr);
+      int rc = validate_expr_pass_a(ctx, w->when_expr, allow_params);
       if (rc != YES)
         return rc;
-      rc = validate_expr_functions(ctx, w->then_expr);
+      rc = validate_expr_pass_a(ctx, w->then_expr, allow_params);
       if (rc != YES)
         return rc;
     }
     if (e->u.case_.else_expr) {
-      return validate_expr_functions(ctx, e->u.case_.else_expr);
+      return validate_expr_pass_a(ctx, e->u.case_.else_expr, allow_params);
     }
     return YES;
   }
-  case QIR_EXPR_SUBQUERY:
-  case QIR_EXPR_COLREF:
-  case QIR_EXPR_PARAM:
-  case QIR_EXPR_LITERAL:
-    return YES;
   case QIR_EXPR_UNSUPPORTED:
     set_err(ctx, VERR_UNSUPPORTED_QUERY, "Unsupported expression.");
     return NO;
@@ -1121,8 +1134,9 @@ static AdbxTriStatus validate_params_where(ValidatorCtx *ctx,
   return ERR;
 }
 
-/* Pass A: validates alias requirements, function safety, and validates
- * all nested queries. This pass is mode-independent and is always required. */
+/* Pass A: validates alias requirements, function safety, parameter
+ * placement, and all nested queries, traversing each clause tree once via
+ * the fused visitor. This pass is mode-independent and is always required. */
 static AdbxTriStatus validate_query_pass_a(ValidatorCtx *ctx,
                                            const QirQuery *q) {
   if (!ctx || !ctx->db || !ctx->cp || !q)
@@ -1141,86 +1155,44 @@ static AdbxTriStatus validate_query_pass_a(ValidatorCtx *ctx,
   if (rc != YES)
     return rc;
 
-  // Function allowlist enforcement across the query.
+  // One fused walk per clause covers function safety, parameter placement,
+  // unsupported nodes, and nested-subquery recursion.
   // SELECT
   for (uint32_t i = 0; i < q->nselect; i++) {
-    int rc = validate_expr_functions(ctx, q->select_items[i]->value);
-    if (rc != YES)
-      return rc;
-    if (expr_has_param(q->select_items[i]->value) == YES) {
-      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
-              "Parameters are only allowed inside WHERE.");
-      return NO;
-    }
-    rc = validate_expr_subqueries_pass_a(ctx, q->select_items[i]->value);
+    int rc = validate_expr_pass_a(ctx, q->select_items[i]->value, 0);
     if (rc != YES)
       return rc;
   }
-  // WHERE
+  // WHERE (params allowed; their placement rules get their own walk)
   if (q->where) {
-    int rc = validate_expr_functions(ctx, q->where);
+    int rc = validate_expr_pass_a(ctx, q->where, 1);
     if (rc != YES)
       return rc;
     rc = validate_params_where(ctx, q, q->where);
     if (rc != YES)
       return rc;
-    rc = validate_expr_subqueries_pass_a(ctx, q->where);
-    if (rc != YES)
-      return rc;
   }
   // GROUP BY
   for (uint32_t i = 0; i < q->n_group_by; i++) {
-    int rc = validate_expr_functions(ctx, q->group_by[i]);
-    if (rc != YES)
-      return rc;
-    if (expr_has_param(q->group_by[i]) == YES) {
-      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
-              "Parameters are only allowed inside WHERE.");
-      return NO;
-    }
-    rc = validate_expr_subqueries_pass_a(ctx, q->group_by[i]);
+    int rc = validate_expr_pass_a(ctx, q->group_by[i], 0);
     if (rc != YES)
       return rc;
   }
   // HAVING
   if (q->having) {
-    int rc = validate_expr_functions(ctx, q->having);
-    if (rc != YES)
-      return rc;
-    if (expr_has_param(q->having) == YES) {
-      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
-              "Parameters are only allowed inside WHERE.");
-      return NO;
-    }
-    rc = validate_expr_subqueries_pass_a(ctx, q->having);
+    int rc = validate_expr_pass_a(ctx, q->having, 0);
     if (rc != YES)
       return rc;
   }
   // ORDER BY
   for (uint32_t i = 0; i < q->n_order_by; i++) {
-    int rc = validate_expr_functions(ctx, q->order_by[i]);
-    if (rc != YES)
-      return rc;
-    if (expr_has_param(q->order_by[i]) == YES) {
-      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
-              "Parameters are only allowed inside WHERE.");
-      return NO;
-    }
-    rc = validate_expr_subqueries_pass_a(ctx, q->order_by[i]);
+    int rc = validate_expr_pass_a(ctx, q->order_by[i], 0);
     if (rc != YES)
       return rc;
   }
   // JOIN
   for (uint32_t i = 0; i < q->njoins; i++) {
-    int rc = validate_expr_functions(ctx, q->joins[i]->on);
-    if (rc != YES)
-      return rc;
-    if (expr_has_param(q->joins[i]->on) == YES) {
-      set_err(ctx, VERR_PARAM_OUTSIDE_WHERE,
-              "Parameters are only allowed inside WHERE.");
-      return NO;
-    }
-    rc = validate_expr_subqueries_pass_a(ctx, q->joins[i]->on);
+    int rc = validate_expr_pass_a(ctx, q->joins[i]->on, 0);
     if (rc != YES)
       return rc;
   }
@@ -1630,6 +1602,7 @@ AdbxStatus vq_out_init(ValidateQueryOut *out) {
     return ERR;
   }
 
+  out->plan.limit_value = -1;
   out->err.code = VERR_NONE;
   return OK;
 }
@@ -1644,6 +1617,38 @@ void vq_out_clean(ValidateQueryOut *out) {
   out->err.code = VERR_NONE;
 }
 
+AdbxStatus vq_out_copy_plan(ValidateQueryOut *dst, const ValidateQueryOut *src) {
+  if (!dst || !src || !dst->plan.cols || !src->plan.cols)
+    return ERR;
+  if (vq_out_reset(dst) != OK)
+    return ERR;
+
+  size_t n = parr_len(src->plan.cols);
+  for (uint32_t i = 0; i < (uint32_t)n; i++) {
+    const ValidatorColPlan *sc =
+        (const ValidatorColPlan *)parr_cat(src->plan.cols, i);
+    void *slot = NULL;
+    if (!sc || parr_emplace(dst->plan.cols, &slot) == UINT32_MAX)
+      return ERR;
+
+    ValidatorColPlan *dc = (ValidatorColPlan *)slot;
+    dc->kind = sc->kind;
+    dc->col_id = NULL;
+    dc->col_id_len = 0;
+    if (sc->col_id) {
+      char *copy =
+          arena_add_nul(&dst->plan.arena, (void *)sc->col_id, sc->col_id_len);
+      if (!copy)
+        return ERR;
+      dc->col_id = copy;
+      dc->col_id_len = sc->col_id_len;
+    }
+  }
+
+  dst->plan.limit_value = src->plan.limit_value;
+  return OK;
+}
+
 AdbxStatus validate_query(const ValidatorRequest *req, ValidateQueryOut *out) {
   if (!req || !out)
     return ERR;
@@ -1667,7 +1672,9 @@ AdbxStatus validate_query(const ValidatorRequest *req, ValidateQueryOut *out) {
       .nparams = req->nparams,
       .param_used = param_used,
   };
-  sb_init(&ctx.scratch);
+  // Scratch holds short identifier descriptions; inline mode keeps the
+  // common case off the heap (ctx is a stack local, so the address is fixed).
+  sb_init_small(&ctx.scratch);
 
   QirQueryHandle h = {0};
   if (db_make_query_ir(req->db, req->sql, &h) != OK) {
@@ -1687,6 +1694,32 @@ AdbxStatus validate_query(const ValidatorRequest *req, ValidateQueryOut *out) {
     sb_clean(&ctx.scratch);
     return ERR;
   }
+  // The backend pre-pass may reject before building any IR; map that to the
+  // same errors the full walk would produce. The IR is empty in this case.
+  if (q->early_reject != QIR_EREJ_NONE) {
+    const char *detail =
+        q->early_reject_detail ? q->early_reject_detail : "<unknown>";
+    switch (q->early_reject) {
+    case QIR_EREJ_STAR:
+      set_err(&ctx, VERR_STAR, "SELECT * is not allowed.");
+      break;
+    case QIR_EREJ_NO_TABLE_ALIAS_FROM:
+      set_err(&ctx, VERR_NO_TABLE_ALIAS, "Missing alias in FROM item: %s.",
+              detail);
+      break;
+    case QIR_EREJ_NO_TABLE_ALIAS_JOIN:
+      set_err(&ctx, VERR_NO_TABLE_ALIAS, "Missing alias in JOIN item: %s.",
+              detail);
+      break;
+    default:
+      set_err(&ctx, VERR_UNSUPPORTED_QUERY, "Invalid query.");
+      break;
+    }
+    qir_handle_destroy(&h);
+    free(param_used);
+    sb_clean(&ctx.scratch);
+    return ERR;
+  }
   if (q->has_star) {
     set_err(&ctx, VERR_STAR, "SELECT * is not allowed.");
     qir_handle_destroy(&h);
@@ -1783,6 +1816,9 @@ AdbxStatus validate_query(const ValidatorRequest *req, ValidateQueryOut *out) {
     return ERR;
   }
 
+  // Surface the top-level LIMIT so the broker can push its row cap down.
+  out->plan.limit_value = q->limit_value;
+
   qir_touch_report_destroy(tr);
   qir_handle_destroy(&h);
   free(param_used);
@@ -56,6 +56,10 @@ typedef struct ValidatorColPlan {
 typedef struct ValidatorPlan {
   PackedArray *cols; // entries are ValidatorColPlan, index-aligned with SELECT
   Arena arena;       // owns ValidatorColPlan.col_id strings
+  // Top-level LIMIT literal of the validated query; -1 = no LIMIT clause.
+  // Non-literal LIMITs never reach a plan (the parser rejects them), so the
+  // broker can use this to push its row cap down into the executed SQL.
+  int32_t limit_value;
 } ValidatorPlan;
 
 /* Output contract for validate_query().
@@ -88,6 +92,22 @@ AdbxStatus vq_out_init(ValidateQueryOut *out);
 /* Cleans one ValidateQueryOut and all memory it owns. */
 void vq_out_clean(ValidateQueryOut *out);
 
+/* Re-arms an initialized ValidateQueryOut for reuse while keeping its plan
+ * storage warm (column capacity and the arena's converged block), so
+ * steady-state callers pay pointer resets instead of alloc/free cycles.
+ * Returns OK on success, ERR on invalid/uninitialized input.
+ */
+AdbxStatus vq_out_reset(ValidateQueryOut *out);
+
+/* Deep-copies the column plan of 'src' into 'dst'.
+ * Both must be initialized with vq_out_init(); previous plan storage in 'dst'
+ * is released and col_id strings are re-owned by dst->plan.arena. The error
+ * state of 'src' is not copied.
+ * Returns OK on success, ERR on invalid input or allocation failure (on ERR
+ * 'dst' stays initialized but its plan contents are unspecified).
+ */
+AdbxStatus vq_out_copy_plan(ValidateQueryOut *dst, const ValidateQueryOut *src);
+
 /* Validates a SQL query against the global and sensitive-mode policies.
  * On success, returns OK and fills out->plan (one entry per SELECT output
  * column) and sets out->err.code=VERR_NONE.
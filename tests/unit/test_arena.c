@@ -127,6 +127,50 @@ static void test_ptrvec_flatten(void) {
   arena_destroy(ar);
 }
 
+static void test_ptrvec_inline_then_heap(void) {
+  PtrVec v = {0};
+  int vals[PTRVEC_INLINE_CAP + 4];
+
+  // The first PTRVEC_INLINE_CAP pushes stay inside the struct.
+  for (uint32_t i = 0; i < PTRVEC_INLINE_CAP; i++)
+    ASSERT_TRUE(ptrvec_push(&v, &vals[i]) == OK);
+  ASSERT_TRUE(v.items == v.inline_items);
+  ASSERT_TRUE(v.on_heap == 0);
+
+  // Growing past them spills to heap and keeps the collected pointers.
+  for (uint32_t i = PTRVEC_INLINE_CAP; i < PTRVEC_INLINE_CAP + 4; i++)
+    ASSERT_TRUE(ptrvec_push(&v, &vals[i]) == OK);
+  ASSERT_TRUE(v.items != v.inline_items);
+  ASSERT_TRUE(v.on_heap == 1);
+  for (uint32_t i = 0; i < PTRVEC_INLINE_CAP + 4; i++)
+    ASSERT_TRUE(v.items[i] == &vals[i]);
+
+  ptrvec_clean(&v);
+  ASSERT_TRUE(v.items == NULL);
+}
+
+static void test_ptrvec_arena_growth(void) {
+  Arena *ar = arena_create(NULL, NULL);
+  ASSERT_TRUE(ar != NULL);
+
+  PtrVec v = {0};
+  int vals[PTRVEC_INLINE_CAP * 3];
+  uint32_t n = (uint32_t)(sizeof(vals) / sizeof(vals[0]));
+  for (uint32_t i = 0; i < n; i++)
+    ASSERT_TRUE(ptrvec_push_arena(&v, ar, &vals[i]) == OK);
+  ASSERT_TRUE(v.on_heap == 0);
+  ASSERT_TRUE(v.items != v.inline_items);
+
+  void **arr = ptrvec_flatten(&v, ar);
+  ASSERT_TRUE(arr != NULL);
+  for (uint32_t i = 0; i < n; i++)
+    ASSERT_TRUE(arr[i] == &vals[i]);
+
+  // Nothing to free: growth lived in the arena.
+  ptrvec_clean(&v);
+  arena_destroy(ar);
+}
+
 static void test_alloc_basic(void) {
   Arena *ar = arena_create(NULL, NULL);
   ASSERT_TRUE(ar != NULL);
@@ -238,6 +282,110 @@ static void test_zero_mem(void) {
   arena_destroy(ar);
 }
 
+static void test_block_pool_recycles(void) {
+  uint32_t size = 4096u;
+  Arena *ar = arena_create(&size, NULL);
+  ASSERT_TRUE(ar != NULL);
+  void *first_block_payload = arena_alloc(ar, 8);
+  ASSERT_TRUE(first_block_payload != NULL);
+  arena_destroy(ar);
+
+  // A fresh arena asking for the same block size draws the pooled block
+  // back instead of hitting malloc, so the payload address repeats.
+  ar = arena_create(&size, NULL);
+  ASSERT_TRUE(ar != NULL);
+  void *recycled_payload = arena_alloc(ar, 8);
+  ASSERT_TRUE(recycled_payload == first_block_payload);
+
+  // Recycled blocks come back with a clean cursor and stay usable.
+  memset(recycled_payload, 0x5C, 8);
+  void *second = arena_alloc(ar, 16);
+  ASSERT_TRUE(second != NULL);
+  ASSERT_TRUE(second != recycled_payload);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+  arena_destroy(ar);
+}
+
+static void test_reset_retains_and_converges(void) {
+  uint32_t size = 64u;
+  Arena *ar = arena_create(&size, NULL);
+  ASSERT_TRUE(ar != NULL);
+
+  // Fill past the first block so the chain grows.
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(arena_alloc(ar, 100) != NULL);
+  uint32_t peak = arena_get_peak_used(ar);
+  ASSERT_TRUE(peak == arena_get_used(ar));
+  ASSERT_TRUE(arena_get_block_count(ar) > 1);
+
+  // Reset keeps one warm block and the high-water mark.
+  arena_reset(ar);
+  ASSERT_TRUE(arena_get_used(ar) == 0);
+  ASSERT_TRUE(arena_get_peak_used(ar) == peak);
+  ASSERT_TRUE(arena_get_block_count(ar) == 1);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+
+  // Refilling to the same workload converges: after one more cycle the
+  // retained block fits everything and the chain stops growing.
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(arena_alloc(ar, 100) != NULL);
+  arena_reset(ar);
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(arena_alloc(ar, 100) != NULL);
+  ASSERT_TRUE(arena_get_block_count(ar) == 1);
+  ASSERT_TRUE(arena_get_peak_used(ar) == peak);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+
+  arena_destroy(ar);
+}
+
+static void test_mapped_block_lifecycle(void) {
+  // First block lands above the mmap threshold (2 MiB): exercised as a
+  // mapped block on Linux, a plain malloc block elsewhere — behavior must
+  // be identical either way.
+  uint32_t size = 4u * 1024u * 1024u;
+  uint32_t cap = 16u * 1024u * 1024u;
+  Arena *ar = arena_create(&size, &cap);
+  ASSERT_TRUE(ar != NULL);
+
+  uint32_t len = 3u * 1024u * 1024u;
+  uint8_t *p = (uint8_t *)arena_alloc(ar, len);
+  ASSERT_TRUE(p != NULL);
+  memset(p, 0xA7, len);
+  ASSERT_TRUE(p[0] == 0xA7 && p[len - 1u] == 0xA7);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+
+  // Reset hints the retained pages discardable; the block must stay fully
+  // writable and readable afterwards.
+  arena_reset(ar);
+  ASSERT_TRUE(arena_get_used(ar) == 0);
+  ASSERT_TRUE(arena_get_block_count(ar) == 1);
+  p = (uint8_t *)arena_alloc(ar, len);
+  ASSERT_TRUE(p != NULL);
+  memset(p, 0x5C, len);
+  ASSERT_TRUE(p[0] == 0x5C && p[len - 1u] == 0x5C);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+
+  // Growth past the retained block chains a second mapped block; destroy
+  // releases (unmaps) them all.
+  ASSERT_TRUE(arena_alloc(ar, 2u * 1024u * 1024u) != NULL);
+  ASSERT_TRUE(arena_get_block_count(ar) == 2);
+  ASSERT_TRUE(arena_is_ok(ar) == YES);
+  arena_destroy(ar);
+}
+
+static void test_reset_on_cleaned_arena(void) {
+  Arena ar = {0};
+  arena_reset(&ar); // no-op on zeroed struct
+  ASSERT_TRUE(arena_is_zeroed(&ar) == YES);
+  arena_reset(NULL); // safe on NULL
+
+  ASSERT_TRUE(arena_init(&ar, NULL, NULL) == OK);
+  arena_clean(&ar);
+  arena_reset(&ar); // no-op after clean
+  ASSERT_TRUE(arena_is_zeroed(&ar) == YES);
+}
+
 int main(void) {
   test_basic_add_get();
   test_alignment_and_empty();
@@ -245,12 +393,18 @@ int main(void) {
   test_grow_blocks_and_stability();
   test_large_entry_and_cap();
   test_ptrvec_flatten();
+  test_ptrvec_inline_then_heap();
+  test_ptrvec_arena_growth();
   test_alloc_basic();
   test_alloc_zero_len();
   test_calloc_zeroes_payload();
   test_alloc_rejects_overflow_len();
   test_add_nul();
   test_zero_mem();
+  test_block_pool_recycles();
+  test_reset_retains_and_converges();
+  test_mapped_block_lifecycle();
+  test_reset_on_cleaned_arena();
   fprintf(stderr, "OK: test_arena\n");
   return 0;
 }
@@ -0,0 +1,92 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "async_log.h"
+#include "test.h"
+
+#define WRITERS 4
+#define MSGS_PER_WRITER 500
+
+static void *writer_main(void *arg) {
+  int id = (int)(long)arg;
+  for (int i = 0; i < MSGS_PER_WRITER; i++)
+    alog_write("msg writer=%d seq=%d", id, i);
+  return NULL;
+}
+
+/* Counts lines containing 'needle' in 'f' (rewinds first). */
+static uint64_t count_lines_with(FILE *f, const char *needle) {
+  rewind(f);
+  char line[512];
+  uint64_t n = 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (strstr(line, needle))
+      n++;
+  }
+  return n;
+}
+
+/* Concurrent writers: every message either reaches the sink or is counted
+ * as dropped; nothing vanishes silently. */
+static void test_concurrent_writers_accounted(void) {
+  FILE *sink = tmpfile();
+  ASSERT_TRUE(sink != NULL);
+  ASSERT_TRUE(alog_start(sink) == OK);
+  ASSERT_TRUE(alog_start(sink) == OK); // idempotent
+
+  pthread_t tids[WRITERS];
+  for (long i = 0; i < WRITERS; i++)
+    ASSERT_TRUE(pthread_create(&tids[i], NULL, writer_main, (void *)i) == 0);
+  for (int i = 0; i < WRITERS; i++)
+    pthread_join(tids[i], NULL);
+
+  uint64_t dropped = alog_dropped();
+  alog_stop();
+
+  uint64_t delivered = count_lines_with(sink, "msg writer=");
+  ASSERT_TRUE(delivered + dropped == (uint64_t)WRITERS * MSGS_PER_WRITER);
+  // The drain thread keeps consuming while writers run, so at least some
+  // messages must get through even under overflow.
+  ASSERT_TRUE(delivered > 0);
+  fclose(sink);
+}
+
+/* Delivered lines carry a drain-side timestamp prefix. */
+static void test_lines_are_timestamped(void) {
+  FILE *sink = tmpfile();
+  ASSERT_TRUE(sink != NULL);
+  ASSERT_TRUE(alog_start(sink) == OK);
+  alog_write("stamped hello %d", 42);
+  alog_stop();
+
+  rewind(sink);
+  char line[512] = "";
+  int found = 0;
+  while (fgets(line, sizeof(line), sink)) {
+    if (strstr(line, "stamped hello 42")) {
+      found = 1;
+      break;
+    }
+  }
+  ASSERT_TRUE(found);
+  // "YYYY-MM-DDTHH:MM:SS.mmmZ " prefix before the message.
+  ASSERT_TRUE(line[4] == '-' && line[10] == 'T' && line[19] == '.');
+  fclose(sink);
+}
+
+/* Without a running logger, writes degrade to synchronous stderr and never
+ * crash (covers tools and tests that skip alog_start()). */
+static void test_fallback_without_start(void) {
+  alog_write("fallback line (expected on stderr) %s", "ok");
+  ASSERT_TRUE(alog_dropped() == 0);
+}
+
+int main(void) {
+  test_concurrent_writers_accounted();
+  test_lines_are_timestamped();
+  test_fallback_without_start();
+
+  fprintf(stderr, "OK: test_async_log\n");
+  return 0;
+}
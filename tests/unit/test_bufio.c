@@ -398,6 +398,137 @@ static void test_bufch_stdio_openfd_init_closes_fd_on_init_error(void) {
   free(path);
 }
 
+static void test_bufch_interleaved_large_stream(void) {
+  // Interleaved fill/consume across many read chunks exercises the
+  // offset-recycling read path: full drains restart at offset zero and the
+  // consumed prefix is reclaimed only when the tail room runs out.
+  const size_t total = 256u * 1024u;
+  char *src = malloc(total);
+  ASSERT_TRUE(src != NULL);
+  for (size_t i = 0; i < total; i++)
+    src[i] = (char)('a' + (i % 23));
+
+  FILE *in = MEMFILE_OUT();
+  fwrite(src, 1, total, in);
+  fflush(in);
+  fseek(in, 0, SEEK_SET);
+
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  // Odd-sized consumes keep a partial tail buffered on most iterations.
+  char chunk[7001];
+  size_t off = 0;
+  while (off < total) {
+    size_t want = sizeof(chunk);
+    if (want > total - off)
+      want = total - off;
+    ASSERT_TRUE(bufch_read_exact(bc, chunk, want) == OK);
+    ASSERT_TRUE(memcmp(chunk, src + off, want) == 0);
+    off += want;
+  }
+  ASSERT_TRUE(bufch_ensure(bc, 1) == NO);
+
+  bufch_destroy(bc);
+  free(src);
+  fclose(in);
+}
+
+static void test_bufch_find_with_false_candidates(void) {
+  // Repeated first-needle bytes force the memchr skip loop through many
+  // false candidates before the real match right at the end of the window.
+  FILE *in = MEMFILE_IN("\r\rx\r\ny\r\n\rz\r\n\r\n");
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel bc;
+  ASSERT_TRUE(bufch_init(&bc, ch) == OK);
+  ASSERT_TRUE(bufch_ensure(&bc, 14) == YES);
+
+  ASSERT_TRUE(bufch_find_buffered(&bc, "\r\n\r\n", 4) == 10);
+  ASSERT_TRUE(bufch_find_buffered(&bc, "\r", 1) == 0);
+  ASSERT_TRUE(bufch_find_buffered(&bc, "z", 1) == 9);
+  ASSERT_TRUE(bufch_find_buffered(&bc, "\n\n", 2) == -1);
+  ASSERT_TRUE(bufch_findn(&bc, "\r\n\r\n", 4, 9) == -1);
+  ASSERT_TRUE(bufch_findn(&bc, "\r\n\r\n", 4, 10) == 10);
+
+  bufch_clean(&bc);
+  fclose(in);
+}
+
+static void test_bufch_adaptive_read_grows_then_decays(void) {
+  // Full fills double the per-fill read size, so draining a large stream
+  // takes far fewer read calls than at the fixed starting size; a long run
+  // of short fills then decays the size and releases the oversized buffer
+  // at the next full drain.
+  // The grow phase may buffer ahead of what it consumes, so the stream holds
+  // plenty of extra bytes for the decay phase's short fills.
+  const size_t total = 2048u * 1024u;
+  const size_t grow_phase = 512u * 1024u;
+  char *src = malloc(total);
+  ASSERT_TRUE(src != NULL);
+  for (size_t i = 0; i < total; i++)
+    src[i] = (char)('a' + (i % 23));
+
+  PartialByteChannelImpl *impl = NULL;
+  ByteChannel *ch = partial_bytechannel_create((const unsigned char *)src,
+                                               total, 0, 0, &impl);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+  ASSERT_TRUE(impl != NULL);
+  size_t start_chunk = bc->read_chunk;
+  ASSERT_TRUE(start_chunk > 0);
+
+  char sink[32u * 1024u];
+  size_t off = 0;
+  while (off < grow_phase) {
+    size_t want = sizeof(sink);
+    if (want > grow_phase - off)
+      want = grow_phase - off;
+    ASSERT_TRUE(bufch_read_exact(bc, sink, want) == OK);
+    off += want;
+  }
+  ASSERT_TRUE(bc->read_chunk > start_chunk);
+  ASSERT_TRUE((size_t)impl->read_calls < grow_phase / start_chunk);
+  size_t grown_chunk = bc->read_chunk;
+  size_t grown_cap = bc->buf.cap;
+  ASSERT_TRUE(grown_cap >= grown_chunk);
+
+  // Short fills from here: 64 bytes per read against a much larger chunk.
+  impl->read_chunk = 64;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(bufch_fill_some(bc) == YES);
+    size_t avail = 0;
+    ASSERT_TRUE(bufch_peek(bc, &avail) != NULL);
+    bufch_consume(bc, avail);
+  }
+  ASSERT_TRUE(bc->read_chunk < grown_chunk);
+  ASSERT_TRUE(bc->buf.cap < grown_cap);
+
+  bufch_destroy(bc);
+  free(src);
+}
+
+static void test_bufch_create_sized_presizes_and_floors(void) {
+  const char *msg = "hello";
+  PartialByteChannelImpl *impl = NULL;
+  ByteChannel *ch =
+      partial_bytechannel_create((const unsigned char *)msg, 5, 0, 0, &impl);
+  const size_t hint = 64u * 1024u;
+  BufChannel *bc = bufch_create_sized(ch, hint);
+  ASSERT_TRUE(bc != NULL);
+  ASSERT_TRUE(bc->read_chunk == hint);
+  ASSERT_TRUE(bc->read_floor == hint);
+  ASSERT_TRUE(bc->buf.cap >= hint);
+
+  char buf[6];
+  ASSERT_TRUE(bufch_read_exact(bc, buf, 5) == OK);
+  ASSERT_TRUE(memcmp(buf, msg, 5) == 0);
+  // One short fill must not drop the read size below the requested floor.
+  ASSERT_TRUE(bc->read_chunk >= hint);
+
+  bufch_destroy(bc);
+}
+
 int main(void) {
   test_bufch_peek_find_and_read();
   test_bufch_partial_reads();
@@ -409,6 +540,10 @@ int main(void) {
   test_bufch_read_until_greater_than_max();
   test_bufch_stdio_openp_init_closes_fd_on_init_error();
   test_bufch_stdio_openfd_init_closes_fd_on_init_error();
+  test_bufch_interleaved_large_stream();
+  test_bufch_find_with_false_candidates();
+  test_bufch_adaptive_read_grows_then_decays();
+  test_bufch_create_sized_presizes_and_floors();
 
   fprintf(stderr, "OK: test_bufio\n");
   return 0;
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "conn_catalog.h"
@@ -403,7 +404,8 @@ static void test_valid_config_maps_fields(void) {
                      "  \"safetyPolicy\": {"
                      "    \"readOnly\": \"no unsafe\","
                      "    \"statementTimeoutMs\": 1234,"
-                     "    \"maxRowReturned\": 99"
+                     "    \"maxRowReturned\": 99,"
+                     "    \"slowLogMs\": 750"
                      "  },"
                      "  \"databases\": ["
                      "    {"
@@ -429,6 +431,7 @@ static void test_valid_config_maps_fields(void) {
   ASSERT_TRUE(p->read_only == 0);
   ASSERT_TRUE(p->max_rows == 99);
   ASSERT_TRUE(p->statement_timeout_ms == 1234);
+  ASSERT_TRUE(p->slow_log_ms == 750);
 
   ConnProfile *cp = catalog_get_by_name(cat, "MyPostgres");
   ASSERT_TRUE(cp != NULL);
@@ -750,6 +753,131 @@ static void test_connp_is_sensitive(void) {
   free(path);
 }
 
+/* Ensures catalog_load_cached writes a snapshot on the cold load, serves warm
+ * loads from it without parsing the JSON, and rejects it once stale. */
+static void test_catalog_load_cached_snapshot_roundtrip(void) {
+  const char *json = "{"
+                     "  \"version\": \"1.0\","
+                     "  \"credentialNamespace\": \"TestNamespace\","
+                     "  \"safetyPolicy\": {},"
+                     "  \"databases\": ["
+                     "    {"
+                     "      \"type\": \"postgres\","
+                     "      \"connectionName\": \"MyPostgres\","
+                     "      \"host\": \"127.0.0.1\","
+                     "      \"port\": 5432,"
+                     "      \"username\": \"user\","
+                     "      \"database\": \"db\","
+                     "      \"options\": \"sslmode=disable\","
+                     "      \"poolSize\": 4,"
+                     "      \"preconnect\": true,"
+                     "      \"safeFunctions\": [\"md1\", \"private.md2\"],"
+                     "      \"sensitiveColumns\": ["
+                     "        \"users.email\","
+                     "        \"private.users.name\""
+                     "      ]"
+                     "    }"
+                     "  ]"
+                     "}";
+
+  char *path = write_tmp_config(json);
+  size_t plen = strlen(path);
+  char *snap = (char *)malloc(plen + sizeof(CATALOG_SNAP_SUFFIX));
+  ASSERT_TRUE(snap != NULL);
+  memcpy(snap, path, plen);
+  memcpy(snap + plen, CATALOG_SNAP_SUFFIX, sizeof(CATALOG_SNAP_SUFFIX));
+
+  int fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+  struct stat st;
+  ASSERT_TRUE(fstat(fd, &st) == 0);
+  char *err = NULL;
+  ConnCatalog *cat = catalog_load_cached(fd, path, &err);
+  close(fd);
+  ASSERT_TRUE(cat != NULL);
+  ASSERT_TRUE(access(snap, F_OK) == 0);
+  catalog_destroy(cat);
+  free(err);
+
+  // Replace the config with same-length garbage and restore its mtime: a
+  // warm load can only succeed if it never touches the JSON bytes.
+  fd = open(path, O_WRONLY | O_TRUNC);
+  ASSERT_TRUE(fd >= 0);
+  size_t glen = (size_t)st.st_size;
+  char *garbage = (char *)malloc(glen);
+  ASSERT_TRUE(garbage != NULL);
+  memset(garbage, 'x', glen);
+  ASSERT_TRUE(write(fd, garbage, glen) == (ssize_t)glen);
+  free(garbage);
+  struct timespec times[2] = {st.st_atim, st.st_mtim};
+  ASSERT_TRUE(futimens(fd, times) == 0);
+  close(fd);
+
+  fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+  err = NULL;
+  cat = catalog_load_cached(fd, path, &err);
+  close(fd);
+  ASSERT_TRUE(cat != NULL);
+  ASSERT_TRUE(strcmp(cat->credential_namespace, "TestNamespace") == 0);
+  ASSERT_TRUE(catalog_count(cat) == 1);
+  ConnProfile *cp = catalog_get_by_name(cat, "MyPostgres");
+  ASSERT_TRUE(cp != NULL);
+  ASSERT_TRUE(strcmp(cp->host, "127.0.0.1") == 0);
+  ASSERT_TRUE(cp->port == 5432);
+  ASSERT_TRUE(cp->pool_size == 4);
+  ASSERT_TRUE(cp->preconnect == 1);
+  ASSERT_TRUE(cp->options && strcmp(cp->options, "sslmode=disable") == 0);
+  ASSERT_TRUE(strcmp(cp->secret_ref.cred_namespace, "TestNamespace") == 0);
+  ASSERT_TRUE(connp_is_col_sensitive(cp, "", "users", "email") == YES);
+  ASSERT_TRUE(connp_is_col_sensitive(cp, "private", "users", "name") == YES);
+  ASSERT_TRUE(connp_is_col_sensitive(cp, "public", "users", "name") == NO);
+  ASSERT_TRUE(connp_is_col_sensitive(cp, "", "users", "age") == NO);
+  ASSERT_TRUE(connp_is_func_safe(cp, "", "md1") == YES);
+  ASSERT_TRUE(connp_is_func_safe(cp, "private", "md2") == YES);
+  ASSERT_TRUE(connp_is_func_safe(cp, "", "unknown") == NO);
+  catalog_destroy(cat);
+  free(err);
+
+  // Rewriting the config (new size/mtime) makes the snapshot stale; the
+  // garbage content must then fail like any other bad JSON.
+  fd = open(path, O_WRONLY | O_TRUNC);
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(write(fd, "not json", 8) == 8);
+  close(fd);
+  fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+  err = NULL;
+  cat = catalog_load_cached(fd, path, &err);
+  close(fd);
+  ASSERT_TRUE(cat == NULL);
+  free(err);
+
+  // A corrupt snapshot must fall back to the JSON parse and be rewritten.
+  fd = open(path, O_WRONLY | O_TRUNC);
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(write(fd, json, strlen(json)) == (ssize_t)strlen(json));
+  close(fd);
+  fd = open(snap, O_WRONLY | O_TRUNC);
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(write(fd, "bogus", 5) == 5);
+  close(fd);
+  fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+  err = NULL;
+  cat = catalog_load_cached(fd, path, &err);
+  close(fd);
+  ASSERT_TRUE(cat != NULL);
+  ASSERT_TRUE(catalog_count(cat) == 1);
+  catalog_destroy(cat);
+  free(err);
+
+  unlink(snap);
+  unlink(path);
+  free(snap);
+  free(path);
+}
+
 int main(void) {
   test_missing_policy_defaults();
   test_missing_credential_namespace_fails();
@@ -770,6 +898,7 @@ int main(void) {
   test_safe_functions_malformed_fails();
   test_column_policy_randomized_fails();
   test_connp_is_sensitive();
+  test_catalog_load_cached_snapshot_roundtrip();
   fprintf(stderr, "OK: test_conn_catalog\n");
   return 0;
 }
@@ -79,9 +79,10 @@ static SecretStore *fake_secret_store_create(void) {
 
 /* ------------------------------ helpers -------------------------------- */
 
-/* Builds a tiny catalog with one profile, to validate ConnManager behavior
- * without relying on a real DB. */
-static ConnCatalog *make_catalog(void) {
+/* Builds a tiny catalog with one profile holding 'pool_size' pooled slots
+ * (0 = manager default), to validate ConnManager behavior without relying on
+ * a real DB. */
+static ConnCatalog *make_catalog(uint32_t pool_size) {
   ConnCatalog *cat = (ConnCatalog *)xcalloc(1, sizeof(*cat));
   cat->credential_namespace = dup_or_null("TestNamespace");
   cat->n_profiles = 1;
@@ -97,6 +98,40 @@ static ConnCatalog *make_catalog(void) {
   p->db_name = dup_or_null("testdb");
   p->user = dup_or_null("user");
   p->options = NULL;
+  p->pool_size = pool_size;
+
+  int read_only = 1;
+  uint32_t max_rows = 10;
+  safety_policy_init(&cat->policy, &read_only, &max_rows, NULL, NULL);
+  return cat;
+}
+
+/* Builds a catalog with two replica profiles ("r1", "r2") sharing the group
+ * tag "grp", each holding 'pool_size' slots, with catalog_idx and the group
+ * leader stamped the way catalog loading would. */
+static ConnCatalog *make_group_catalog(uint32_t pool_size) {
+  ConnCatalog *cat = (ConnCatalog *)xcalloc(1, sizeof(*cat));
+  cat->credential_namespace = dup_or_null("TestNamespace");
+  cat->n_profiles = 2;
+  cat->profiles = (ConnProfile *)xcalloc(2, sizeof(ConnProfile));
+
+  const char *names[2] = {"r1", "r2"};
+  for (uint32_t i = 0; i < 2; i++) {
+    ConnProfile *p = &cat->profiles[i];
+    p->connection_name = dup_or_null(names[i]);
+    p->secret_ref.cred_namespace = cat->credential_namespace;
+    p->secret_ref.connection_name = p->connection_name;
+    p->kind = DB_KIND_POSTGRES;
+    p->host = dup_or_null("localhost");
+    p->port = 5432;
+    p->db_name = dup_or_null("testdb");
+    p->user = dup_or_null("user");
+    p->options = NULL;
+    p->pool_size = pool_size;
+    p->replica_group = dup_or_null("grp");
+    p->catalog_idx = i;
+    p->group_leader_idx = 0;
+  }
 
   int read_only = 1;
   uint32_t max_rows = 10;
@@ -108,53 +143,286 @@ static void reset_counters(void) { fake_backend_reset_counters(); }
 
 /* ------------------------------- tests --------------------------------- */
 
-/* Verifies lazy connection, reuse, and reaping behavior using a fake backend.
- */
+/* Verifies lazy connection, checked-in reuse, and reaping behavior using a
+ * fake backend. */
 static void test_conn_manager_lifecycle(void) {
   reset_counters();
 
-  ConnCatalog *cat = make_catalog();
+  ConnCatalog *cat = make_catalog(1);
   SecretStore *ss = fake_secret_store_create();
   ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
   ASSERT_TRUE(m != NULL);
 
   ConnView c1 = {0};
-  int rc = connm_get_connection(m, "db1", &c1);
-  ASSERT_TRUE(rc == YES);
+  ConnCheckoutStatus rc = connm_checkout(m, "db1", &c1);
+  ASSERT_TRUE(rc == CONN_CHECKOUT_OK);
   DbBackend *b1 = c1.db;
   ASSERT_TRUE(b1 != NULL);
   ASSERT_TRUE(c1.profile != NULL);
   ASSERT_TRUE(fake_backend_connect_calls() == 1);
 
+  // A checked-in slot is reused without reconnecting.
+  connm_checkin(m, "db1", b1);
   ConnView c2 = {0};
-  rc = connm_get_connection(m, "db1", &c2);
-  ASSERT_TRUE(rc == YES);
-  DbBackend *b2 = c2.db;
-  ASSERT_TRUE(b2 != NULL);
-  ASSERT_TRUE(b1 == b2);
+  rc = connm_checkout(m, "db1", &c2);
+  ASSERT_TRUE(rc == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(c2.db == b1);
   ASSERT_TRUE(fake_backend_connect_calls() == 1);
 
   connm_set_ttl_ms(m, 1);
-  connm_mark_used(m, "db1");
+  connm_checkin(m, "db1", b1);
   struct timespec ts;
   ts.tv_sec = 0;
   ts.tv_nsec = 2 * 1000 * 1000; // 2ms
   nanosleep(&ts, NULL);
 
   ConnView c3 = {0};
-  rc = connm_get_connection(m, "db1", &c3);
-  ASSERT_TRUE(rc == YES);
-  DbBackend *b3 = c3.db;
-  ASSERT_TRUE(b3 == b1);
+  rc = connm_checkout(m, "db1", &c3);
+  ASSERT_TRUE(rc == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(c3.db == b1);
   ASSERT_TRUE(fake_backend_disconnect_calls() == 1);
   ASSERT_TRUE(fake_backend_connect_calls() == 2);
+  connm_checkin(m, "db1", c3.db);
+
+  connm_destroy(m);
+  ASSERT_TRUE(fake_backend_destroy_calls() == 1);
+}
+
+/* Verifies pool exhaustion, the FIFO waiter queue, and the parser backend on
+ * a two-slot pool. */
+static void test_conn_manager_pool_and_waiters(void) {
+  reset_counters();
+
+  ConnCatalog *cat = make_catalog(2);
+  SecretStore *ss = fake_secret_store_create();
+  ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  ConnView unknown = {0};
+  ASSERT_TRUE(connm_checkout(m, "nope", &unknown) == CONN_CHECKOUT_UNKNOWN);
+
+  // Two concurrent checkouts get two distinct connections.
+  ConnView c1 = {0};
+  ConnView c2 = {0};
+  ASSERT_TRUE(connm_checkout(m, "db1", &c1) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(connm_checkout(m, "db1", &c2) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(c1.db != NULL && c2.db != NULL && c1.db != c2.db);
+  ASSERT_TRUE(fake_backend_connect_calls() == 2);
+
+  // Exhausted pool: BUSY, but the profile stays available for validation.
+  ConnView c3 = {0};
+  ASSERT_TRUE(connm_checkout(m, "db1", &c3) == CONN_CHECKOUT_BUSY);
+  ASSERT_TRUE(c3.db == NULL);
+  ASSERT_TRUE(c3.profile != NULL);
+
+  // Waiters are redeemed FIFO, and only while a slot is actually free.
+  ASSERT_TRUE(connm_wait(m, "db1", 7) == OK);
+  ASSERT_TRUE(connm_wait(m, "db1", 8) == OK);
+  ASSERT_TRUE(connm_pop_waiter(m, "db1") == 0); // no free slot yet
+
+  connm_checkin(m, "db1", c1.db);
+  ASSERT_TRUE(connm_pop_waiter(m, "db1") == 7);
+  ConnView c4 = {0};
+  ASSERT_TRUE(connm_checkout(m, "db1", &c4) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(c4.db == c1.db);
+  ASSERT_TRUE(connm_pop_waiter(m, "db1") == 0); // 8 keeps waiting
+
+  connm_checkin(m, "db1", c2.db);
+  ASSERT_TRUE(connm_pop_waiter(m, "db1") == 8);
+  ASSERT_TRUE(connm_pop_waiter(m, "db1") == 0); // queue drained
+
+  // The parser backend is stable, lazily created, and never connected.
+  DbBackend *pb = connm_parser_backend(m, "db1");
+  ASSERT_TRUE(pb != NULL);
+  ASSERT_TRUE(pb == connm_parser_backend(m, "db1"));
+  ASSERT_TRUE(pb != c1.db && pb != c2.db);
+  ASSERT_TRUE(fake_backend_connect_calls() == 2);
+
+  connm_checkin(m, "db1", c4.db);
+  connm_destroy(m);
+  // Two pooled slots plus the parser backend.
+  ASSERT_TRUE(fake_backend_destroy_calls() == 3);
+}
+
+/* Verifies the opt-in warm worker pre-connects in the background and that
+ * destroy joins it cleanly while it may be mid-pass. */
+static void test_conn_manager_warm_start(void) {
+  reset_counters();
+
+  ConnCatalog *cat = make_catalog(1);
+  SecretStore *ss = fake_secret_store_create();
+  ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  ASSERT_TRUE(connm_warm_start(m, 5) == OK);
+  ASSERT_TRUE(connm_warm_start(m, 5) == OK); // idempotent
+
+  // The worker connects the slot without anyone checking it out; poll with a
+  // generous deadline since the connect happens on the background thread.
+  struct timespec ts = {.tv_sec = 0, .tv_nsec = 5 * 1000 * 1000};
+  int connected = 0;
+  for (int i = 0; i < 400 && !connected; i++) {
+    connected = fake_backend_connect_calls() >= 1;
+    if (!connected)
+      nanosleep(&ts, NULL);
+  }
+  ASSERT_TRUE(connected);
 
+  // Destroy stops and joins the worker before tearing the backends down.
   connm_destroy(m);
   ASSERT_TRUE(fake_backend_destroy_calls() == 1);
 }
 
+/* Verifies the one-shot preconnect thread connects flagged profiles in the
+ * background and stays a no-op when nothing opted in. */
+static void test_conn_manager_preconnect_start(void) {
+  reset_counters();
+
+  // No profile opted in: start must succeed without connecting anything.
+  ConnCatalog *lazy_cat = make_catalog(1);
+  SecretStore *lazy_ss = fake_secret_store_create();
+  ConnManager *lazy = connm_create_with_factory(lazy_cat, lazy_ss,
+                                                fake_backend_create);
+  ASSERT_TRUE(lazy != NULL);
+  ASSERT_TRUE(connm_preconnect_start(lazy) == OK);
+  connm_destroy(lazy);
+  ASSERT_TRUE(fake_backend_connect_calls() == 0);
+
+  ConnCatalog *cat = make_catalog(1);
+  cat->profiles[0].preconnect = 1;
+  SecretStore *ss = fake_secret_store_create();
+  ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  ASSERT_TRUE(connm_preconnect_start(m) == OK);
+  ASSERT_TRUE(connm_preconnect_start(m) == OK); // idempotent
+
+  // The thread connects the slot without anyone checking it out; poll with a
+  // generous deadline since the connect happens in the background.
+  struct timespec ts = {.tv_sec = 0, .tv_nsec = 5 * 1000 * 1000};
+  int connected = 0;
+  for (int i = 0; i < 400 && !connected; i++) {
+    connected = fake_backend_connect_calls() >= 1;
+    if (!connected)
+      nanosleep(&ts, NULL);
+  }
+  ASSERT_TRUE(connected);
+
+  connm_destroy(m);
+}
+
+/* Verifies the rolling result-arena estimate: instant rise to a high-water
+ * mark, gradual decay on smaller observations, unknown names ignored. */
+static void test_conn_manager_result_arena_hint(void) {
+  reset_counters();
+
+  ConnCatalog *cat = make_catalog(1);
+  SecretStore *ss = fake_secret_store_create();
+  ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  ASSERT_TRUE(connm_result_arena_hint(m, "db1") == 0);
+  ASSERT_TRUE(connm_result_arena_hint(m, "nope") == 0);
+  ASSERT_TRUE(connm_result_arena_hint(NULL, "db1") == 0);
+
+  connm_note_result_arena(m, "db1", 4096);
+  ASSERT_TRUE(connm_result_arena_hint(m, "db1") == 4096);
+
+  // A bigger result raises the estimate immediately.
+  connm_note_result_arena(m, "db1", 65536);
+  ASSERT_TRUE(connm_result_arena_hint(m, "db1") == 65536);
+
+  // Smaller observations only decay it gradually (1/8 of the gap).
+  connm_note_result_arena(m, "db1", 0);
+  ASSERT_TRUE(connm_result_arena_hint(m, "db1") == 65536 - 65536 / 8);
+
+  // Unknown names are ignored without touching known entries.
+  connm_note_result_arena(m, "nope", 1);
+  ASSERT_TRUE(connm_result_arena_hint(m, "nope") == 0);
+
+  connm_destroy(m);
+}
+
+/* Verifies replica-group routing: least-outstanding member selection,
+ * checkin under the logical name, failover past a member whose connect
+ * fails, and group-level waiter parking. */
+static void test_conn_manager_replica_groups(void) {
+  reset_counters();
+
+  ConnCatalog *cat = make_group_catalog(1);
+  SecretStore *ss = fake_secret_store_create();
+  ConnManager *m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  // Both members idle: the first one wins the tie.
+  ConnView c1 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &c1) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(c1.db != NULL && c1.profile != NULL);
+  ASSERT_TRUE(strcmp(c1.profile->connection_name, "r1") == 0);
+
+  // With r1 outstanding, the group routes to r2.
+  ConnView c2 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &c2) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(strcmp(c2.profile->connection_name, "r2") == 0);
+
+  // Every slot checked out: BUSY with a member profile, and a parked waiter
+  // is redeemed once a checkin frees a slot.
+  ConnView c3 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &c3) == CONN_CHECKOUT_BUSY);
+  ASSERT_TRUE(c3.profile != NULL);
+  ASSERT_TRUE(connm_wait(m, "grp", 77) == OK);
+  ASSERT_TRUE(connm_pop_waiter(m, "grp") == 0); // nothing free yet
+  connm_checkin(m, "grp", c2.db);               // logical-name checkin
+  ASSERT_TRUE(connm_pop_waiter(m, "grp") == 77);
+
+  // The shared side channels resolve through the group too.
+  ASSERT_TRUE(connm_parser_backend(m, "grp") != NULL);
+  connm_note_result_arena(m, "grp", 4096);
+  ASSERT_TRUE(connm_result_arena_hint(m, "grp") == 4096);
+  ASSERT_TRUE(connm_result_arena_hint(m, "r1") == 4096);
+
+  connm_checkin(m, "grp", c1.db);
+  connm_destroy(m);
+
+  // Failover: r2's secret is wrong, so its connects fail and the group keeps
+  // serving from r1.
+  reset_counters();
+  cat = make_group_catalog(1);
+  cat->profiles[1].secret_ref.connection_name = "r2-wrong";
+  ss = fake_secret_store_create();
+  m = connm_create_with_factory(cat, ss, fake_backend_create);
+  ASSERT_TRUE(m != NULL);
+
+  ConnView f1 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &f1) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(strcmp(f1.profile->connection_name, "r1") == 0);
+  // r1 is outstanding, so r2 is tried first and fails over... to nothing
+  // free: the checked-out r1 makes this BUSY, not ERR.
+  ConnView f2 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &f2) == CONN_CHECKOUT_BUSY);
+  // Once r1 frees up, routing skips the benched r2 without a reconnect.
+  connm_checkin(m, "grp", f1.db);
+  ConnView f3 = {0};
+  ASSERT_TRUE(connm_checkout(m, "grp", &f3) == CONN_CHECKOUT_OK);
+  ASSERT_TRUE(strcmp(f3.profile->connection_name, "r1") == 0);
+  connm_checkin(m, "r1", f3.db); // member-name checkin still works
+
+  // The member names keep resolving directly.
+  ConnView d1 = {0};
+  ASSERT_TRUE(connm_checkout(m, "r1", &d1) == CONN_CHECKOUT_OK);
+  connm_checkin(m, "r1", d1.db);
+  ASSERT_TRUE(connm_checkout(m, "nope", &d1) == CONN_CHECKOUT_UNKNOWN);
+
+  connm_destroy(m);
+}
+
 int main(void) {
   test_conn_manager_lifecycle();
+  test_conn_manager_pool_and_waiters();
+  test_conn_manager_warm_start();
+  test_conn_manager_preconnect_start();
+  test_conn_manager_result_arena_hint();
+  test_conn_manager_replica_groups();
   fprintf(stderr, "OK: test_conn_manager\n");
   return 0;
 }
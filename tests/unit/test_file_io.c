@@ -272,6 +272,65 @@ static void test_sb_read_limit_fd_bad_input(void) {
 
 /* Verifies fileio_read_exact reads all bytes when file size matches exactly.
  */
+static void test_map_ro_fd_regular_file(void) {
+  const char *msg = "mapped bytes";
+  char *path = write_tmp_file((const uint8_t *)msg, 12);
+  int fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+
+  FileMap map;
+  ASSERT_TRUE(fileio_map_ro_fd(fd, 64, &map) == OK);
+  ASSERT_TRUE(map.map_base != NULL); // regular files take the mmap path
+  ASSERT_TRUE(map.len == 12);
+  ASSERT_TRUE(memcmp(map.data, msg, 12) == 0);
+
+  // The view must outlive a close of the borrowed fd.
+  ASSERT_TRUE(close(fd) == 0);
+  ASSERT_TRUE(memcmp(map.data, msg, 12) == 0);
+  fileio_map_clean(&map);
+
+  ASSERT_TRUE(unlink(path) == 0);
+  free(path);
+}
+
+static void test_map_ro_fd_empty_and_over_limit(void) {
+  char *path = write_tmp_file(NULL, 0);
+  int fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+
+  FileMap map;
+  ASSERT_TRUE(fileio_map_ro_fd(fd, 64, &map) == OK);
+  ASSERT_TRUE(map.len == 0);
+  fileio_map_clean(&map);
+  close(fd);
+  ASSERT_TRUE(unlink(path) == 0);
+  free(path);
+
+  const uint8_t big[8] = {0};
+  path = write_tmp_file(big, sizeof(big));
+  fd = open(path, O_RDONLY);
+  ASSERT_TRUE(fd >= 0);
+  ASSERT_TRUE(fileio_map_ro_fd(fd, sizeof(big) - 1, &map) == ERR);
+  close(fd);
+  ASSERT_TRUE(unlink(path) == 0);
+  free(path);
+}
+
+static void test_map_ro_fd_pipe_falls_back_to_read(void) {
+  int pfd[2];
+  ASSERT_TRUE(pipe(pfd) == 0);
+  ASSERT_TRUE(write(pfd[1], "abc", 3) == 3);
+  ASSERT_TRUE(close(pfd[1]) == 0);
+
+  FileMap map;
+  ASSERT_TRUE(fileio_map_ro_fd(pfd[0], 64, &map) == OK);
+  ASSERT_TRUE(map.map_base == NULL); // pipes cannot map; owned buffer instead
+  ASSERT_TRUE(map.len == 3);
+  ASSERT_TRUE(memcmp(map.data, "abc", 3) == 0);
+  fileio_map_clean(&map);
+  close(pfd[0]);
+}
+
 static void test_read_exact_raw_ok(void) {
   const uint8_t payload[] = {'r', 'a', 'w', '1'};
   char *path = write_tmp_file(payload, sizeof(payload));
@@ -910,6 +969,9 @@ int main(void) {
   test_sb_read_limit_fd_ok();
   test_sb_read_limit_fd_over_limit_fails();
   test_sb_read_limit_fd_bad_input();
+  test_map_ro_fd_regular_file();
+  test_map_ro_fd_empty_and_over_limit();
+  test_map_ro_fd_pipe_falls_back_to_read();
   test_read_exact_raw_ok();
   test_read_exact_raw_short_file_fails();
   test_read_exact_raw_long_file_fails();
@@ -120,12 +120,315 @@ static void test_frame_read_cl(void) {
   fclose(in);
 }
 
+static void test_frame_read_cl_header_variants(void) {
+  // Headers off the writer's exact shape still parse: no space after the
+  // colon, tab padding, and another header before Content-Length all take
+  // the fallback hunt; a digit-less value is malformed.
+  const char *raws[] = {
+      "Content-Length:5\r\n\r\nhello",
+      "Content-Length:\t 5\r\n\r\nhello",
+      "Content-Type: x\r\nContent-Length: 5\r\n\r\nhello",
+  };
+  for (size_t i = 0; i < ARRLEN(raws); i++) {
+    FILE *in = MEMFILE_IN(raws[i]);
+    ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+    BufChannel *bc = bufch_create(ch);
+    ASSERT_TRUE(bc != NULL);
+
+    StrBuf payload;
+    sb_init(&payload);
+    ASSERT_TRUE(frame_read_cl(bc, &payload) == YES);
+    ASSERT_TRUE(payload.len == 5);
+    ASSERT_TRUE(memcmp(payload.data, "hello", 5) == 0);
+
+    sb_clean(&payload);
+    bufch_destroy(bc);
+    fclose(in);
+  }
+
+  FILE *in = MEMFILE_IN("Content-Length: x\r\n\r\nhello");
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+  StrBuf payload;
+  sb_init(&payload);
+  ASSERT_TRUE(frame_read_cl(bc, &payload) == ERR);
+  sb_clean(&payload);
+  bufch_destroy(bc);
+  fclose(in);
+}
+
+static void test_frame_read_cl_buffered(void) {
+  const char *raw = "Content-Length: 5\r\n\r\nhelloContent-Length: 2\r\n\r\nok";
+  FILE *in = MEMFILE_OUT();
+  fwrite(raw, 1, strlen(raw), in);
+  fflush(in);
+  fseek(in, 0, SEEK_SET);
+
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  StrBuf payload;
+  sb_init(&payload);
+
+  // Nothing buffered yet: must report NO without touching the channel.
+  ASSERT_TRUE(frame_read_cl_buffered(bc, &payload) == NO);
+
+  ASSERT_TRUE(bufch_fill_some(bc) == YES);
+  ASSERT_TRUE(frame_read_cl_buffered(bc, &payload) == YES);
+  ASSERT_TRUE(payload.len == 5);
+  ASSERT_TRUE(memcmp(payload.data, "hello", 5) == 0);
+
+  // The second frame was buffered by the same fill and drains back-to-back.
+  ASSERT_TRUE(frame_read_cl_buffered(bc, &payload) == YES);
+  ASSERT_TRUE(payload.len == 2);
+  ASSERT_TRUE(memcmp(payload.data, "ok", 2) == 0);
+
+  ASSERT_TRUE(frame_read_cl_buffered(bc, &payload) == NO);
+
+  sb_clean(&payload);
+  bufch_destroy(bc);
+  fclose(in);
+}
+
+static void test_frame_read_cl_buffered_partial(void) {
+  const char *head = "Content-Length: 8\r\n\r\nfour";
+  FILE *in = MEMFILE_OUT();
+  fwrite(head, 1, strlen(head), in);
+  fflush(in);
+  fseek(in, 0, SEEK_SET);
+
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  StrBuf payload;
+  sb_init(&payload);
+
+  // Header plus a short payload is not a full frame yet.
+  ASSERT_TRUE(bufch_fill_some(bc) == YES);
+  ASSERT_TRUE(frame_read_cl_buffered(bc, &payload) == NO);
+
+  sb_clean(&payload);
+  bufch_destroy(bc);
+  fclose(in);
+}
+
+static void test_frame_view_len_zero_copy(void) {
+  unsigned char buf[4 + 5 + 4 + 2];
+  write_be_u32(buf, 5);
+  memcpy(buf + 4, "hello", 5);
+  write_be_u32(buf + 9, 2);
+  memcpy(buf + 13, "ok", 2);
+
+  FILE *in = MEMFILE_OUT();
+  fwrite(buf, 1, sizeof(buf), in);
+  fflush(in);
+  fseek(in, 0, SEEK_SET);
+
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(fileno(in), -1);
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  const uint8_t *payload = NULL;
+  uint32_t plen = 0;
+
+  // Nothing buffered yet: must report NO without touching the channel.
+  ASSERT_TRUE(frame_view_len(bc, &payload, &plen) == NO);
+
+  ASSERT_TRUE(bufch_fill_some(bc) == YES);
+  ASSERT_TRUE(frame_view_len(bc, &payload, &plen) == YES);
+  ASSERT_TRUE(plen == 5);
+  ASSERT_TRUE(memcmp(payload, "hello", 5) == 0);
+
+  // The view borrows the read buffer: until consumed, it stays current.
+  size_t avail = 0;
+  const uint8_t *peek = bufch_peek(bc, &avail);
+  ASSERT_TRUE(payload == peek + 4);
+
+  frame_consume_len(bc, plen);
+  ASSERT_TRUE(frame_view_len(bc, &payload, &plen) == YES);
+  ASSERT_TRUE(plen == 2);
+  ASSERT_TRUE(memcmp(payload, "ok", 2) == 0);
+  frame_consume_len(bc, plen);
+
+  ASSERT_TRUE(frame_view_len(bc, &payload, &plen) == NO);
+
+  bufch_destroy(bc);
+  fclose(in);
+}
+
+static void test_frame_batch_coalesces_frames(void) {
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  FrameBatch fb;
+  frame_batch_init(&fb, bc);
+
+  // Flushing an empty batch writes nothing.
+  ASSERT_TRUE(frame_batch_flush(&fb) == OK);
+
+  ASSERT_TRUE(frame_batch_add(&fb, "hello", 5) == OK);
+  ASSERT_TRUE(frame_batch_add(&fb, NULL, 0) == OK);
+  ASSERT_TRUE(frame_batch_add(&fb, "ok", 2) == OK);
+  ASSERT_TRUE(fb.nframes == 3);
+  ASSERT_TRUE(fb.pending_bytes == 7);
+
+  ASSERT_TRUE(frame_batch_flush(&fb) == OK);
+  ASSERT_TRUE(fb.nframes == 0 && fb.nvecs == 0 && fb.pending_bytes == 0);
+  bufch_destroy(bc);
+
+  // Expect the same bytes three frame_write_len() calls would emit.
+  unsigned char want[4 + 5 + 4 + 4 + 2];
+  write_be_u32(want, 5);
+  memcpy(want + 4, "hello", 5);
+  write_be_u32(want + 9, 0);
+  write_be_u32(want + 13, 2);
+  memcpy(want + 17, "ok", 2);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  ASSERT_TRUE(memcmp(raw, want, sizeof(want)) == 0);
+
+  free(raw);
+  fclose(out);
+}
+
+static void test_frame_batch_eager_flush_on_full(void) {
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  FrameBatch fb;
+  frame_batch_init(&fb, bc);
+
+  for (size_t i = 0; i < FRAME_BATCH_MAX_FRAMES; i++)
+    ASSERT_TRUE(frame_batch_add(&fb, "x", 1) == OK);
+  ASSERT_TRUE(fb.nframes == FRAME_BATCH_MAX_FRAMES);
+
+  // Out of slots: the next add flushes the queued frames first.
+  ASSERT_TRUE(frame_batch_add(&fb, "y", 1) == OK);
+  ASSERT_TRUE(fb.nframes == 1);
+
+  ASSERT_TRUE(frame_batch_flush(&fb) == OK);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  ASSERT_TRUE(memcmp(raw + 4, "x", 1) == 0);
+  ASSERT_TRUE(memcmp(raw + 5 * FRAME_BATCH_MAX_FRAMES + 4, "y", 1) == 0);
+
+  free(raw);
+  fclose(out);
+}
+
+static void test_frame_chunk_ctrl_roundtrip(void) {
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  ASSERT_TRUE(frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_BEGIN, 300000u) ==
+              OK);
+  ASSERT_TRUE(frame_write_chunk_ctrl(bc, FRAME_CHUNK_CTRL_END, 300000u) == OK);
+  // Only the two defined kinds are writable.
+  ASSERT_TRUE(frame_write_chunk_ctrl(bc, 'X', 1) == ERR);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  // <4-byte len=6><0x00><'B'><BE total>, then the same with 'E'.
+  ASSERT_TRUE((unsigned char)raw[3] == 6);
+  const uint8_t *begin = (const uint8_t *)raw + 4;
+  const uint8_t *end = (const uint8_t *)raw + 4 + 6 + 4;
+
+  uint32_t total = 0;
+  ASSERT_TRUE(frame_chunk_parse_ctrl(begin, 6, FRAME_CHUNK_CTRL_BEGIN,
+                                     &total) == YES);
+  ASSERT_TRUE(total == 300000u);
+  total = 0;
+  ASSERT_TRUE(frame_chunk_parse_ctrl(end, 6, FRAME_CHUNK_CTRL_END, &total) ==
+              YES);
+  ASSERT_TRUE(total == 300000u);
+
+  // Kind mismatch and truncated control frames are malformed, not payload.
+  ASSERT_TRUE(frame_chunk_parse_ctrl(begin, 6, FRAME_CHUNK_CTRL_END, &total) ==
+              ERR);
+  ASSERT_TRUE(frame_chunk_parse_ctrl(begin, 5, FRAME_CHUNK_CTRL_BEGIN,
+                                     &total) == ERR);
+  // Anything not starting with the 0x00 tag is an ordinary payload frame.
+  ASSERT_TRUE(frame_chunk_parse_ctrl((const uint8_t *)"{\"a\":1}", 7,
+                                     FRAME_CHUNK_CTRL_BEGIN, &total) == NO);
+
+  free(raw);
+  fclose(out);
+}
+
+static void test_frame_write_cl_head(void) {
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+
+  ASSERT_TRUE(frame_write_cl_head(bc, 12345) == OK);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  const char *expected = "Content-Length: 12345\r\n\r\n";
+  ASSERT_TRUE(strncmp(raw, expected, strlen(expected)) == 0);
+
+  free(raw);
+  fclose(out);
+}
+
+static void test_frame_checksum_vecs_match_contiguous(void) {
+  unsigned char data[1000];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (unsigned char)(i * 37u + 11u);
+
+  uint64_t whole = frame_checksum_bytes(data, sizeof(data));
+
+  // The gathered pieces of a vectored write checksum to the same value the
+  // receiver computes over its contiguous copy.
+  ByteChannelVec vecs[4] = {
+      {.base = data, .len = 4},
+      {.base = data + 4, .len = 300},
+      {.base = data + 304, .len = 0},
+      {.base = data + 304, .len = sizeof(data) - 304},
+  };
+  ASSERT_TRUE(frame_checksum_vecs(vecs, 4) == whole);
+
+  // A corrupted byte is detected.
+  data[500] ^= 0x01u;
+  ASSERT_TRUE(frame_checksum_bytes(data, sizeof(data)) != whole);
+  data[500] ^= 0x01u;
+
+  // Empty frames checksum consistently; invalid input returns 0.
+  ASSERT_TRUE(frame_checksum_vecs(NULL, 0) == frame_checksum_bytes(data, 0));
+  ASSERT_TRUE(frame_checksum_vecs(NULL, 1) == 0);
+  ASSERT_TRUE(frame_checksum_bytes(NULL, 1) == 0);
+}
+
 int main(void) {
   test_frame_write_len();
   test_frame_read_len();
   test_frame_read_len_too_large();
   test_frame_write_cl();
   test_frame_read_cl();
+  test_frame_read_cl_header_variants();
+  test_frame_read_cl_buffered();
+  test_frame_read_cl_buffered_partial();
+  test_frame_view_len_zero_copy();
+  test_frame_batch_coalesces_frames();
+  test_frame_batch_eager_flush_on_full();
+  test_frame_chunk_ctrl_roundtrip();
+  test_frame_write_cl_head();
+  test_frame_checksum_vecs_match_contiguous();
 
   fprintf(stderr, "OK: test_frame_codec\n");
   return 0;
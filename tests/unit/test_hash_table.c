@@ -188,6 +188,41 @@ static void test_rehash_keeps_entries(void) {
   ht_destroy(ht);
 }
 
+/* Crosses the growth threshold of a larger table so the incremental rehash
+ * is still mid-drain, then checks lookups, updates, and ht_len while entries
+ * live in both the current and the draining table. */
+static void test_incremental_rehash_split_state(void) {
+  HashTable *ht = ht_create();
+  ASSERT_TRUE(ht != NULL);
+
+  // 45 inserts push a default table through 16 -> 32 -> 64 -> 128 slots; the
+  // last growth leaves part of the 64-slot table waiting for migration.
+  enum { N = 45 };
+  char keys[N][16];
+  int vals[N];
+  int vals2[N];
+  for (int i = 0; i < N; i++) {
+    snprintf(keys[i], sizeof(keys[i]), "s%d", i);
+    vals[i] = i;
+    vals2[i] = i + 1000;
+    ASSERT_TRUE(ht_put_cstr(ht, keys[i], &vals[i]) == OK);
+  }
+  ASSERT_TRUE(ht_len(ht) == N);
+
+  // Every key resolves no matter which side of the migration it sits on.
+  for (int i = 0; i < N; i++)
+    ASSERT_TRUE(ht_get_cstr(ht, keys[i]) == &vals[i]);
+
+  // Updates must retire any not-yet-migrated copy instead of duplicating it.
+  for (int i = 0; i < N; i++)
+    ASSERT_TRUE(ht_put_cstr(ht, keys[i], &vals2[i]) == OK);
+  ASSERT_TRUE(ht_len(ht) == N);
+  for (int i = 0; i < N; i++)
+    ASSERT_TRUE(ht_get_cstr(ht, keys[i]) == &vals2[i]);
+
+  ht_destroy(ht);
+}
+
 static void test_linear_probe_collision(void) {
   HashTable *ht = ht_create_with_capacity(8);
   ASSERT_TRUE(ht != NULL);
@@ -342,13 +377,79 @@ static void test_invalid_inputs(void) {
   ht_destroy(hb);
 }
 
+static void test_hash_stream_chunking_independent(void) {
+  // A buffer long enough to cross several fold boundaries.
+  uint8_t data[3u * HT_HASH_STREAM_BLOCK + 17u];
+  for (size_t i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 131u + 7u);
+
+  HtHashStream one;
+  ht_hash_stream_init(&one);
+  ht_hash_stream_update(&one, data, sizeof(data));
+  uint64_t h_whole = ht_hash_stream_final(&one);
+
+  // Same bytes, fed one at a time.
+  HtHashStream bytewise;
+  ht_hash_stream_init(&bytewise);
+  for (size_t i = 0; i < sizeof(data); i++)
+    ht_hash_stream_update(&bytewise, data + i, 1);
+  ASSERT_TRUE(ht_hash_stream_final(&bytewise) == h_whole);
+
+  // Same bytes, uneven pieces straddling the fold boundary.
+  HtHashStream pieces;
+  ht_hash_stream_init(&pieces);
+  ht_hash_stream_update(&pieces, data, 200);
+  ht_hash_stream_update(&pieces, data + 200, HT_HASH_STREAM_BLOCK);
+  ht_hash_stream_update(&pieces, data + 200 + HT_HASH_STREAM_BLOCK,
+                        sizeof(data) - 200 - HT_HASH_STREAM_BLOCK);
+  ASSERT_TRUE(ht_hash_stream_final(&pieces) == h_whole);
+
+  // One changed byte changes the hash.
+  data[HT_HASH_STREAM_BLOCK] ^= 0x40u;
+  HtHashStream changed;
+  ht_hash_stream_init(&changed);
+  ht_hash_stream_update(&changed, data, sizeof(data));
+  ASSERT_TRUE(ht_hash_stream_final(&changed) != h_whole);
+}
+
+static void test_hash_stream_seed_and_edge_cases(void) {
+  // Empty stream is valid and deterministic.
+  HtHashStream empty1, empty2;
+  ht_hash_stream_init(&empty1);
+  ht_hash_stream_init(&empty2);
+  ASSERT_TRUE(ht_hash_stream_final(&empty1) == ht_hash_stream_final(&empty2));
+
+  // Different seeds separate identical bytes.
+  const char *msg = "same bytes";
+  HtHashStream sa, sb;
+  ht_hash_stream_init_withSeed(&sa, 1);
+  ht_hash_stream_init_withSeed(&sb, 2);
+  ht_hash_stream_update(&sa, msg, strlen(msg));
+  ht_hash_stream_update(&sb, msg, strlen(msg));
+  ASSERT_TRUE(ht_hash_stream_final(&sa) != ht_hash_stream_final(&sb));
+
+  // NULL data with len 0 is a no-op, not a crash; final is repeatable and
+  // the stream continues afterwards.
+  HtHashStream st;
+  ht_hash_stream_init(&st);
+  ht_hash_stream_update(&st, NULL, 0);
+  ht_hash_stream_update(&st, "ab", 2);
+  uint64_t mid = ht_hash_stream_final(&st);
+  ASSERT_TRUE(ht_hash_stream_final(&st) == mid);
+  ht_hash_stream_update(&st, "c", 1);
+  ASSERT_TRUE(ht_hash_stream_final(&st) != mid);
+}
+
 int main(void) {
   test_hash_bytes_edge_cases();
   test_hash_bytes_with_seed_edge_cases();
+  test_hash_stream_chunking_independent();
+  test_hash_stream_seed_and_edge_cases();
   test_basic_put_get();
   test_byte_keys_binary_and_empty();
   test_update_existing_key();
   test_rehash_keeps_entries();
+  test_incremental_rehash_split_state();
   test_linear_probe_collision();
   test_clean_and_reinit();
   test_custom_basic_lookup();
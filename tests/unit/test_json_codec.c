@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "frame_codec.h"
 #include "json_codec.h"
 #include "query_result.h"
 #include "test.h"
@@ -204,6 +205,38 @@ static void test_json_escapes_strings(void) {
   ENCODE_JSONRPC(&id, 1, 1, 5, 0, 0, col_names, col_types, cells, expected);
 }
 
+static void test_json_numeric_fast_path_matches_escaped(void) {
+  /* Numeric/bool columns take the raw quoted copy; the text column next to
+   * them must still go through the escape scan. */
+  const char *col_names[] = {"n", "ok", "big", "note"};
+  const char *col_types[] = {"numeric", "bool", "int8", "text"};
+
+  const char *cells[] = {"-12.75", "t",    "9007199254740993", "a\"b",
+                         "NaN",    "f",    NULL,               "c\\d"};
+
+  const char *expected = "{\"jsonrpc\":\"2.0\",\"id\":3,\"result\":{"
+                         "\"content\":[{\"type\":\"text\",\"text\":\"Query "
+                         "executed successfully.\"}],"
+                         "\"structuredContent\":{"
+                         "\"exec_ms\":1,"
+                         "\"columns\":["
+                         "{\"name\":\"n\",\"type\":\"numeric\"},"
+                         "{\"name\":\"ok\",\"type\":\"bool\"},"
+                         "{\"name\":\"big\",\"type\":\"int8\"},"
+                         "{\"name\":\"note\",\"type\":\"text\"}"
+                         "],"
+                         "\"rows\":["
+                         "[\"-12.75\",\"t\",\"9007199254740993\",\"a\\\"b\"],"
+                         "[\"NaN\",\"f\",null,\"c\\\\d\"]"
+                         "],"
+                         "\"rowcount\":2,"
+                         "\"resultTruncated\":false"
+                         "}}}";
+
+  McpId id = id_u32(3);
+  ENCODE_JSONRPC(&id, 4, 2, 1, 0, 0, col_names, col_types, cells, expected);
+}
+
 static void test_json_empty_result(void) {
   /* 0 cols, 0 rows */
   const char *expected = "{\"jsonrpc\":\"2.0\",\"id\":42,\"result\":{"
@@ -350,6 +383,333 @@ static void test_json_builder_nested(void) {
   sb_clean(&sb);
 }
 
+static void test_json_escapes_long_runs(void) {
+  // Clean runs longer than one 16-byte scan chunk, with escapes landing on
+  // and around chunk boundaries.
+  char run_a[41], run_b[21], run_c[17];
+  memset(run_a, 'a', sizeof(run_a) - 1);
+  run_a[sizeof(run_a) - 1] = '\0';
+  memset(run_b, 'b', sizeof(run_b) - 1);
+  run_b[sizeof(run_b) - 1] = '\0';
+  memset(run_c, 'c', sizeof(run_c) - 1);
+  run_c[sizeof(run_c) - 1] = '\0';
+
+  char in[128], exp[160];
+  snprintf(in, sizeof(in), "%s\"%s\n%s", run_a, run_b, run_c);
+  snprintf(exp, sizeof(exp), "\"%s\\\"%s\\n%s\"", run_a, run_b, run_c);
+
+  StrBuf sb;
+  sb_init(&sb);
+  ASSERT_TRUE(json_arr_elem_str(&sb, in) == OK);
+  assert_bytes_eq(sb.data, sb.len, exp, __FILE__, __LINE__);
+  sb_clean(&sb);
+
+  // A control byte in the middle of a long run still becomes \u00XX.
+  snprintf(in, sizeof(in), "%s\x01%s", run_b, run_b);
+  snprintf(exp, sizeof(exp), "\"%s\\u0001%s\"", run_b, run_b);
+  ASSERT_TRUE(json_arr_elem_str(&sb, in) == OK);
+  assert_bytes_eq(sb.data, sb.len, exp, __FILE__, __LINE__);
+  sb_clean(&sb);
+
+  // Fully clean strings are copied verbatim.
+  snprintf(exp, sizeof(exp), "\"%s\"", run_a);
+  ASSERT_TRUE(json_arr_elem_str(&sb, run_a) == OK);
+  assert_bytes_eq(sb.data, sb.len, exp, __FILE__, __LINE__);
+  sb_clean(&sb);
+}
+
+/* Streams 'qr' through qr_to_jsonrpc_frame and checks the frame bytes are
+ * exactly a u32 BE length prefix plus the qr_to_jsonrpc() payload. */
+static void assert_frame_matches_oneshot(const QueryResult *qr,
+                                         const char *file, int line) {
+  char *json = NULL;
+  size_t json_len = 0;
+  ASSERT_TRUE_AT(qr_to_jsonrpc(qr, &json, &json_len) == OK, file, line);
+
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE_AT(bc != NULL, file, line);
+  ASSERT_TRUE_AT(qr_to_jsonrpc_frame(qr, bc) == OK, file, line);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE_AT(raw != NULL, file, line);
+  uint32_t declared = ((uint32_t)(unsigned char)raw[0] << 24) |
+                      ((uint32_t)(unsigned char)raw[1] << 16) |
+                      ((uint32_t)(unsigned char)raw[2] << 8) |
+                      (uint32_t)(unsigned char)raw[3];
+  ASSERT_TRUE_AT(declared == json_len, file, line);
+  ASSERT_TRUE_AT(memcmp(raw + 4, json, json_len) == 0, file, line);
+
+  free(raw);
+  free(json);
+  fclose(out);
+}
+
+static void test_json_stream_frame_matches_oneshot(void) {
+  McpId id = id_u32(9);
+  QueryResult *qr = qr_create_ok(&id, 2, 3, 1, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  qr->exec_ms = 5;
+
+  ASSERT_TRUE(set_col_plain(&qb, 0, "id", "int4") == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 1, "note", "text") == OK);
+  // Mix plain values, SQL NULLs, and escapes across rows.
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 0, "1") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 1, "say \"hi\"\n") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 0, "2") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 1, NULL) == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 2, 0, NULL) == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 2, 1, "plain") == YES);
+
+  assert_frame_matches_oneshot(qr, __FILE__, __LINE__);
+  qr_destroy(qr);
+
+  // Zero-row results take the same streaming path.
+  McpId id2 = id_u32(10);
+  qr = qr_create_ok(&id2, 1, 0, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 0, "n", "int4") == OK);
+  assert_frame_matches_oneshot(qr, __FILE__, __LINE__);
+  qr_destroy(qr);
+
+  // Non-OK results go through the one-shot fallback.
+  McpId id3 = id_u32(11);
+  qr = qr_create_tool_err(&id3, "boom");
+  ASSERT_TRUE(qr != NULL);
+  assert_frame_matches_oneshot(qr, __FILE__, __LINE__);
+  qr_destroy(qr);
+}
+
+static void test_json_chunked_frame_reassembles(void) {
+  // A payload past FRAME_CHUNK_THRESHOLD_BYTES goes out as begin control
+  // frame + payload chunks + end control frame; the concatenated chunks must
+  // byte-match the one-shot serializer.
+  enum { NROWS = 2600, CELL_LEN = 120 };
+  char cell[CELL_LEN + 1];
+  memset(cell, 'x', CELL_LEN);
+  cell[CELL_LEN] = '\0';
+
+  McpId id = id_u32(21);
+  QueryResult *qr = qr_create_ok(&id, 1, NROWS, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  qr->exec_ms = 8;
+  ASSERT_TRUE(set_col_plain(&qb, 0, "t", "text") == OK);
+  for (uint32_t r = 0; r < NROWS; ++r)
+    ASSERT_TRUE(set_cell_plain(&qb, r, 0, cell) == YES);
+
+  char *json = NULL;
+  size_t json_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &json, &json_len) == OK);
+  ASSERT_TRUE(json_len > FRAME_CHUNK_THRESHOLD_BYTES);
+
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+  ASSERT_TRUE(qr_to_jsonrpc_frame(qr, bc) == OK);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  long raw_len = ftell(out);
+  ASSERT_TRUE(raw_len > 0);
+
+  // Walk the frames: begin, chunks, end.
+  size_t off = 0;
+  size_t nframe = 0;
+  size_t body_off = 0;
+  uint32_t total = 0;
+  int saw_end = 0;
+  char *body = (char *)xmalloc(json_len);
+  while (off + 4 <= (size_t)raw_len) {
+    uint32_t n = ((uint32_t)(unsigned char)raw[off] << 24) |
+                 ((uint32_t)(unsigned char)raw[off + 1] << 16) |
+                 ((uint32_t)(unsigned char)raw[off + 2] << 8) |
+                 (uint32_t)(unsigned char)raw[off + 3];
+    const uint8_t *payload = (const uint8_t *)raw + off + 4;
+    ASSERT_TRUE(off + 4 + n <= (size_t)raw_len);
+
+    if (nframe == 0) {
+      ASSERT_TRUE(frame_chunk_parse_ctrl(payload, n, FRAME_CHUNK_CTRL_BEGIN,
+                                         &total) == YES);
+      ASSERT_TRUE(total == json_len);
+    } else if (frame_chunk_parse_ctrl(payload, n, FRAME_CHUNK_CTRL_END,
+                                      &total) == YES) {
+      ASSERT_TRUE(total == json_len);
+      saw_end = 1;
+    } else {
+      ASSERT_TRUE(!saw_end);
+      ASSERT_TRUE(n > 0 && body_off + n <= json_len);
+      memcpy(body + body_off, payload, n);
+      body_off += n;
+    }
+    off += 4 + (size_t)n;
+    nframe++;
+  }
+  ASSERT_TRUE(off == (size_t)raw_len);
+  ASSERT_TRUE(saw_end);
+  ASSERT_TRUE(nframe > 3); // begin + several chunks + end
+  ASSERT_TRUE(body_off == json_len);
+  ASSERT_TRUE(memcmp(body, json, json_len) == 0);
+
+  free(body);
+  free(raw);
+  free(json);
+  fclose(out);
+  qr_destroy(qr);
+}
+
+static void test_json_result_replay(void) {
+  // qr_to_jsonrpc_result() strips the envelope head; replaying the bytes
+  // under another id must byte-match the one-shot serializer for that id.
+  McpId id = id_u32(7);
+  QueryResult *qr = qr_create_ok(&id, 1, 1, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  qr->exec_ms = 3;
+  ASSERT_TRUE(set_col_plain(&qb, 0, "n", "int4") == OK);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 0, "1") == YES);
+
+  char *suffix = NULL;
+  size_t suffix_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc_result(qr, &suffix, &suffix_len) == OK);
+
+  // The full serialization is exactly the envelope head plus the suffix.
+  char *full = NULL;
+  size_t full_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &full, &full_len) == OK);
+  const char *head = "{\"jsonrpc\":\"2.0\",\"id\":7,";
+  size_t head_len = strlen(head);
+  ASSERT_TRUE(full_len == head_len + suffix_len);
+  ASSERT_TRUE(memcmp(full, head, head_len) == 0);
+  ASSERT_TRUE(memcmp(full + head_len, suffix, suffix_len) == 0);
+  free(full);
+
+  // Replay the suffix under a different id; the framed payload must match a
+  // live serialization with that id stamped.
+  McpId id2 = id_u32(42);
+  ASSERT_TRUE(qr_set_id(qr, &id2) == OK);
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &full, &full_len) == OK);
+
+  FILE *out = MEMFILE_OUT();
+  ByteChannel *ch = stdio_bytechannel_wrap_fd(-1, fileno(out));
+  BufChannel *bc = bufch_create(ch);
+  ASSERT_TRUE(bc != NULL);
+  ASSERT_TRUE(jsonrpc_result_frame(bc, &id2, suffix, suffix_len) == OK);
+  bufch_destroy(bc);
+
+  char *raw = read_all(out);
+  ASSERT_TRUE(raw != NULL);
+  long raw_len = ftell(out);
+  ASSERT_TRUE(raw_len == (long)(4 + full_len));
+  uint32_t declared = ((uint32_t)(unsigned char)raw[0] << 24) |
+                      ((uint32_t)(unsigned char)raw[1] << 16) |
+                      ((uint32_t)(unsigned char)raw[2] << 8) |
+                      (uint32_t)(unsigned char)raw[3];
+  ASSERT_TRUE(declared == full_len);
+  ASSERT_TRUE(memcmp(raw + 4, full, full_len) == 0);
+
+  free(raw);
+  free(full);
+  free(suffix);
+  fclose(out);
+  qr_destroy(qr);
+
+  // Error results have no replayable "result" member.
+  McpId id3 = id_u32(1);
+  QueryResult *err = qr_create_tool_err(&id3, "boom");
+  ASSERT_TRUE(err != NULL);
+  ASSERT_TRUE(qr_to_jsonrpc_result(err, &suffix, &suffix_len) == ERR);
+  ASSERT_TRUE(suffix == NULL && suffix_len == 0);
+  qr_destroy(err);
+}
+
+static void test_json_columnar_output(void) {
+  /* columnar=1 replaces "rows" with a "data" object holding one contiguous
+   * array per column; raw-safe and escaped cells keep the row-major bytes. */
+  McpId id = id_u32(13);
+  QueryResult *qr = qr_create_ok(&id, 3, 2, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  qr->exec_ms = 4;
+  qr->columnar = 1;
+
+  ASSERT_TRUE(set_col_plain(&qb, 0, "id", "int4") == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 1, "note", "text") == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 2, "ok", "bool") == OK);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 0, "1") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 1, "a\"b") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 2, "t") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 0, "2") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 1, NULL) == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 2, "f") == YES);
+
+  const char *expected = "{\"jsonrpc\":\"2.0\",\"id\":13,\"result\":{"
+                         "\"content\":[{\"type\":\"text\",\"text\":\"Query "
+                         "executed successfully.\"}],"
+                         "\"structuredContent\":{"
+                         "\"exec_ms\":4,"
+                         "\"columns\":["
+                         "{\"name\":\"id\",\"type\":\"int4\"},"
+                         "{\"name\":\"note\",\"type\":\"text\"},"
+                         "{\"name\":\"ok\",\"type\":\"bool\"}"
+                         "],"
+                         "\"data\":{"
+                         "\"id\":[\"1\",\"2\"],"
+                         "\"note\":[\"a\\\"b\",null],"
+                         "\"ok\":[\"t\",\"f\"]"
+                         "},"
+                         "\"rowcount\":2,"
+                         "\"resultTruncated\":false"
+                         "}}}";
+
+  char *json = NULL;
+  size_t json_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &json, &json_len) == OK);
+  assert_bytes_eq(json, json_len, expected, __FILE__, __LINE__);
+
+  // The streaming frame path must produce the same columnar bytes.
+  assert_frame_matches_oneshot(qr, __FILE__, __LINE__);
+
+  free(json);
+  qr_destroy(qr);
+
+  // Zero columns collapse to an empty "data" object.
+  McpId id2 = id_u32(14);
+  qr = qr_create_ok(&id2, 0, 0, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  qr->exec_ms = 1;
+  qr->columnar = 1;
+
+  const char *expected_empty = "{\"jsonrpc\":\"2.0\",\"id\":14,\"result\":{"
+                               "\"content\":[{\"type\":\"text\",\"text\":"
+                               "\"Query executed successfully.\"}],"
+                               "\"structuredContent\":{"
+                               "\"exec_ms\":1,"
+                               "\"columns\":[],"
+                               "\"data\":{},"
+                               "\"rowcount\":0,"
+                               "\"resultTruncated\":false"
+                               "}}}";
+
+  json = NULL;
+  json_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &json, &json_len) == OK);
+  assert_bytes_eq(json, json_len, expected_empty, __FILE__, __LINE__);
+
+  free(json);
+  qr_destroy(qr);
+}
+
 static void test_jsget_simple_rpc_validation(void) {
   const char *ok =
       "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"exec\",\"params\":{}}";
@@ -410,6 +770,85 @@ static void test_jsget_create_inplace_object_view_keeps_ownership(void) {
   jsget_destroy(&jg);
 }
 
+static void test_jsget_init_ws_reuse_and_growth(void) {
+  JsonTokWs ws = {0};
+  JsonGetter jg = {0};
+  uint32_t v = 0;
+
+  const char *small = "{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"x\"}";
+  ASSERT_TRUE(jsget_init_ws(&jg, small, strlen(small), &ws) == OK);
+  ASSERT_TRUE(jsget_u32(&jg, "id", &v) == YES);
+  ASSERT_TRUE(v == 7);
+  ASSERT_TRUE(ws.cap == JSON_GETTER_MAX_TOKENS);
+  jsmntok_t *first_buf = ws.toks;
+
+  // A payload past the fixed-buffer cap grows the workspace and parses fine.
+  StrBuf big;
+  sb_init(&big);
+  ASSERT_TRUE(sb_append_bytes(&big, "{\"arr\":[0", 9) == OK);
+  for (int i = 1; i < 2000; i++)
+    ASSERT_TRUE(sb_append_bytes(&big, ",1", 2) == OK);
+  ASSERT_TRUE(sb_append_bytes(&big, "],\"id\":9}", 9) == OK);
+
+  ASSERT_TRUE(jsget_init_ws(&jg, big.data, big.len, &ws) == OK);
+  ASSERT_TRUE(jsget_u32(&jg, "id", &v) == YES);
+  ASSERT_TRUE(v == 9);
+  ASSERT_TRUE(ws.cap > JSON_GETTER_MAX_TOKENS);
+
+  // The grown buffer is retained: a steady-state reparse allocates nothing.
+  jsmntok_t *grown_buf = ws.toks;
+  uint32_t grown_cap = ws.cap;
+  ASSERT_TRUE(jsget_init_ws(&jg, small, strlen(small), &ws) == OK);
+  ASSERT_TRUE(ws.toks == grown_buf);
+  ASSERT_TRUE(ws.cap == grown_cap);
+
+  // Views never own workspace tokens; destroy must be a no-op.
+  jsget_destroy(&jg);
+  ASSERT_TRUE(ws.toks == grown_buf);
+
+  sb_clean(&big);
+  jstokws_clean(&ws);
+  ASSERT_TRUE(ws.toks == NULL && ws.cap == 0);
+  (void)first_buf;
+}
+
+static void test_jsget_hot_object_key_index(void) {
+  // Enough pairs to qualify for indexing; repeated lookups make it hot.
+  const char *json = "{\"alpha\":1,\"beta\":2,\"gamma\":3,\"delta\":4,"
+                     "\"epsilon\":{\"x\":7},\"zeta\":\"z\"}";
+  JsonGetter jg = {0};
+  ASSERT_TRUE(jsget_create(&jg, json, strlen(json)) == OK);
+
+  uint32_t v = 0;
+  for (int round = 0; round < 10; round++) {
+    // Same answers before and after the index kicks in.
+    ASSERT_TRUE(jsget_u32(&jg, "alpha", &v) == YES && v == 1);
+    ASSERT_TRUE(jsget_u32(&jg, "delta", &v) == YES && v == 4);
+    ASSERT_TRUE(jsget_u32(&jg, "epsilon.x", &v) == YES && v == 7);
+    ASSERT_TRUE(jsget_u32(&jg, "missing", &v) == NO);
+
+    JsonStrSpan sp = {0};
+    ASSERT_TRUE(jsget_string_span(&jg, "zeta", &sp) == YES);
+    ASSERT_TRUE(sp.len == 1 && sp.ptr[0] == 'z');
+  }
+  jsget_destroy(&jg);
+
+  // Workspace parses reset the shared index between documents.
+  JsonTokWs ws = {0};
+  const char *first = "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5}";
+  ASSERT_TRUE(jsget_init_ws(&jg, first, strlen(first), &ws) == OK);
+  for (int i = 0; i < 10; i++)
+    ASSERT_TRUE(jsget_u32(&jg, "e", &v) == YES && v == 5);
+
+  const char *second = "{\"e\":9,\"f\":8,\"g\":7,\"h\":6,\"i\":5}";
+  ASSERT_TRUE(jsget_init_ws(&jg, second, strlen(second), &ws) == OK);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(jsget_u32(&jg, "e", &v) == YES && v == 9);
+    ASSERT_TRUE(jsget_u32(&jg, "a", &v) == NO);
+  }
+  jstokws_clean(&ws);
+}
+
 static void test_jsget_paths(void) {
   const char *json =
       "{\"a\":\"x\",\"b\":{\"c\":\"hello\",\"d\":{\"e\":\"z\"}}}";
@@ -627,10 +1066,45 @@ static void test_jsget_exists_nonnull(void) {
   ASSERT_TRUE(jsget_exists_nonnull(&jg, "a") == YES);
 }
 
+static void test_json_utf8_validate(void) {
+  // ASCII fast path, long enough to cross several 16-byte chunks.
+  const char *ascii = "The quick brown fox jumps over the lazy dog 0123456789";
+  ASSERT_TRUE(json_utf8_validate(ascii, strlen(ascii)) == OK);
+  ASSERT_TRUE(json_utf8_validate("", 0) == OK);
+  ASSERT_TRUE(json_utf8_validate(NULL, 0) == OK);
+  ASSERT_TRUE(json_utf8_validate(NULL, 1) == ERR);
+
+  // Valid 2/3/4-byte sequences mixed with ASCII.
+  const char *mixed = "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 ok";
+  ASSERT_TRUE(json_utf8_validate(mixed, strlen(mixed)) == OK);
+  // Boundary codepoints: U+07FF, U+FFFF, U+10FFFF.
+  ASSERT_TRUE(json_utf8_validate("\xDF\xBF", 2) == OK);
+  ASSERT_TRUE(json_utf8_validate("\xEF\xBF\xBF", 3) == OK);
+  ASSERT_TRUE(json_utf8_validate("\xF4\x8F\xBF\xBF", 4) == OK);
+
+  // Stray continuation and bad lead bytes.
+  ASSERT_TRUE(json_utf8_validate("\x80", 1) == ERR);
+  ASSERT_TRUE(json_utf8_validate("\xFF", 1) == ERR);
+  ASSERT_TRUE(json_utf8_validate("\xF5\x80\x80\x80", 4) == ERR);
+  // Truncated sequences, including mid-buffer.
+  ASSERT_TRUE(json_utf8_validate("\xC3", 1) == ERR);
+  ASSERT_TRUE(json_utf8_validate("abc\xE2\x82", 5) == ERR);
+  // Overlong encodings.
+  ASSERT_TRUE(json_utf8_validate("\xC0\xAF", 2) == ERR);
+  ASSERT_TRUE(json_utf8_validate("\xE0\x9F\xBF", 3) == ERR);
+  ASSERT_TRUE(json_utf8_validate("\xF0\x8F\xBF\xBF", 4) == ERR);
+  // UTF-16 surrogates and past U+10FFFF.
+  ASSERT_TRUE(json_utf8_validate("\xED\xA0\x80", 3) == ERR);
+  ASSERT_TRUE(json_utf8_validate("\xF4\x90\x80\x80", 4) == ERR);
+  // A continuation byte that is not one (second byte ASCII).
+  ASSERT_TRUE(json_utf8_validate("\xC3(", 2) == ERR);
+}
+
 int main(void) {
   test_json_basic_rows_and_nulls();
   test_json_null_qrcolumn_safe_defaults();
   test_json_escapes_strings();
+  test_json_numeric_fast_path_matches_escaped();
   test_json_empty_result();
   test_json_error_result();
   test_json_tool_error_result();
@@ -638,9 +1112,16 @@ int main(void) {
   test_json_builder_object();
   test_json_builder_array();
   test_json_builder_nested();
+  test_json_escapes_long_runs();
+  test_json_stream_frame_matches_oneshot();
+  test_json_chunked_frame_reassembles();
+  test_json_result_replay();
+  test_json_columnar_output();
   test_jsget_simple_rpc_validation();
   test_jsget_create_and_destroy();
   test_jsget_create_inplace_object_view_keeps_ownership();
+  test_jsget_init_ws_reuse_and_growth();
+  test_jsget_hot_object_key_index();
   test_jsget_paths();
   test_jsget_object_view();
   test_jsget_object_inplace();
@@ -653,6 +1134,7 @@ int main(void) {
   test_jsget_array_objects();
   test_jsget_top_level_validation();
   test_jsget_exists_nonnull();
+  test_json_utf8_validate();
 
   fprintf(stderr, "OK: test_json\n");
   return (0);
@@ -0,0 +1,80 @@
+#include <stdio.h>
+
+#include "latency_hist.h"
+#include "test.h"
+
+static void test_empty_hist(void) {
+  LatencyHist h;
+  lhist_init(&h);
+
+  ASSERT_TRUE(lhist_count(&h) == 0);
+  ASSERT_TRUE(lhist_max(&h) == 0);
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 50) == 0);
+
+  // NULL inputs are ignored / report empty.
+  lhist_init(NULL);
+  lhist_record(NULL, 1);
+  ASSERT_TRUE(lhist_count(NULL) == 0);
+  ASSERT_TRUE(lhist_value_at_percentile(NULL, 99) == 0);
+}
+
+static void test_small_values_are_exact(void) {
+  LatencyHist h;
+  lhist_init(&h);
+
+  // Values below the sub-bucket count map to their own bucket.
+  for (uint64_t v = 0; v < LHIST_SUB_BUCKETS; v++)
+    lhist_record(&h, v);
+
+  ASSERT_TRUE(lhist_count(&h) == LHIST_SUB_BUCKETS);
+  ASSERT_TRUE(lhist_max(&h) == LHIST_SUB_BUCKETS - 1);
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 100) == LHIST_SUB_BUCKETS - 1);
+  // 16 samples: the p50 rank is the 8th sample, value 7.
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 50) == 7);
+}
+
+static void test_percentiles_bounded_error(void) {
+  LatencyHist h;
+  lhist_init(&h);
+
+  // 99 fast samples and one slow outlier: p50 stays near the fast cluster
+  // and p99/p100 reflect the tail. Quantiles are upper bounds accurate to
+  // one sub-bucket (~6% relative error).
+  for (int i = 0; i < 99; i++)
+    lhist_record(&h, 100);
+  lhist_record(&h, 250000);
+
+  ASSERT_TRUE(lhist_count(&h) == 100);
+  uint64_t p50 = lhist_value_at_percentile(&h, 50);
+  ASSERT_TRUE(p50 >= 100 && p50 <= 107);
+  uint64_t p99 = lhist_value_at_percentile(&h, 99);
+  ASSERT_TRUE(p99 >= 100 && p99 <= 107);
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 100) == 250000);
+  ASSERT_TRUE(lhist_max(&h) == 250000);
+  ASSERT_TRUE(h.sum == 99u * 100u + 250000u);
+}
+
+static void test_huge_values_clamp(void) {
+  LatencyHist h;
+  lhist_init(&h);
+
+  // Past the tracked range everything lands in the top bucket, but the exact
+  // max still tightens the reported bound.
+  lhist_record(&h, UINT64_MAX);
+  ASSERT_TRUE(lhist_count(&h) == 1);
+  ASSERT_TRUE(lhist_max(&h) == UINT64_MAX);
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 99) == UINT64_MAX);
+
+  // Out-of-range percentiles clamp to 100.
+  ASSERT_TRUE(lhist_value_at_percentile(&h, 101) == UINT64_MAX);
+}
+
+int main(void) {
+  test_empty_hist();
+  test_small_values_are_exact();
+  test_percentiles_bounded_error();
+  test_huge_values_clamp();
+
+  fprintf(stderr, "OK: test_latency_hist\n");
+  return 0;
+}
@@ -337,8 +337,8 @@ static void test_handshake_new_session_persists_token(void) {
   FILE *out = MEMFILE_OUT();
   McpServer server = {0};
   McpServerInit init = {
-      .in = in,
-      .out = out,
+      .in_fd = fileno(in),
+      .out_fd = fileno(out),
       .privd = pd,
   };
   int init_rc = mcpser_init(&server, &init);
@@ -410,8 +410,8 @@ static void test_handshake_retry_after_unknown_resume(void) {
   FILE *out = MEMFILE_OUT();
   McpServer server = {0};
   McpServerInit init = {
-      .in = in,
-      .out = out,
+      .in_fd = fileno(in),
+      .out_fd = fileno(out),
       .privd = pd,
   };
   int init_rc = mcpser_init(&server, &init);
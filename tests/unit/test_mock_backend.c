@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "mock_backend.h"
+#include "query_result.h"
+#include "test.h"
+#include "utils.h"
+
+static void test_create_connect_destroy(void) {
+  mock_backend_configure(NULL); // defaults
+
+  DbBackend *db = mock_backend_create(DB_KIND_POSTGRES);
+  ASSERT_TRUE(db != NULL);
+
+  ASSERT_TRUE(db_is_connected(db) == NO);
+  ASSERT_TRUE(db->vt->connect(db, NULL, NULL, NULL) == ERR); // bad input tol.
+
+  ConnProfile profile = {.connection_name = "mock"};
+  ASSERT_TRUE(db->vt->connect(db, &profile, NULL, "pwd") == OK);
+  ASSERT_TRUE(db_is_connected(db) == YES);
+
+  db->vt->disconnect(db);
+  ASSERT_TRUE(db_is_connected(db) == NO);
+
+  db->vt->destroy(db);
+}
+
+static void test_exec_materializes_configured_shape(void) {
+  MockBackendConfig cfg = {
+      .min_latency_us = 0,
+      .max_latency_us = 0,
+      .ncols = 3,
+      .nrows = 7,
+      .cell_len = 5,
+  };
+  mock_backend_configure(&cfg);
+
+  DbBackend *db = mock_backend_create(DB_KIND_POSTGRES);
+  ASSERT_TRUE(db != NULL);
+
+  QueryResult *qr = NULL;
+  ASSERT_TRUE(db->vt->exec(db, "SELECT 1", NULL, &qr) == OK);
+  ASSERT_TRUE(qr != NULL);
+  ASSERT_TRUE(qr->ncols == 3);
+  ASSERT_TRUE(qr->nrows == 7);
+
+  const char *cell = qr_get_cell(qr, 6, 2);
+  ASSERT_TRUE(cell != NULL);
+  ASSERT_TRUE(strcmp(cell, "abcde") == 0);
+
+  qr_destroy(qr);
+  db->vt->destroy(db);
+  mock_backend_configure(NULL);
+}
+
+static void test_config_snapshot_at_create(void) {
+  MockBackendConfig cfg = {.ncols = 1, .nrows = 1, .cell_len = 2};
+  mock_backend_configure(&cfg);
+  DbBackend *db = mock_backend_create(DB_KIND_POSTGRES);
+  ASSERT_TRUE(db != NULL);
+
+  // Reconfiguring afterwards must not affect an existing backend.
+  mock_backend_configure(NULL);
+
+  QueryResult *qr = NULL;
+  ASSERT_TRUE(db->vt->exec(db, "SELECT 1", NULL, &qr) == OK);
+  ASSERT_TRUE(qr->ncols == 1);
+  ASSERT_TRUE(qr->nrows == 1);
+
+  qr_destroy(qr);
+  db->vt->destroy(db);
+}
+
+static void test_parser_delegate_present(void) {
+  mock_backend_configure(NULL);
+  DbBackend *db = mock_backend_create(DB_KIND_POSTGRES);
+  ASSERT_TRUE(db != NULL);
+
+  // The safe-function list comes from the delegate parser backend, not a
+  // stub, so concurrency benchmarks validate like production.
+  ASSERT_TRUE(db->vt->safe_functions(db) != NULL);
+
+  db->vt->destroy(db);
+}
+
+int main(void) {
+  test_create_connect_destroy();
+  test_exec_materializes_configured_shape();
+  test_config_snapshot_at_create();
+  test_parser_delegate_present();
+
+  fprintf(stderr, "OK: test_mock_backend\n");
+  return 0;
+}
@@ -206,6 +206,62 @@ static void test_upper_bound_non_power_of_two_capacity(void) {
   parr_destroy(a);
 }
 
+static void test_custom_alignment(void) {
+  // Invalid alignment is rejected up front.
+  ASSERT_TRUE(parr_create_custom(sizeof(Item), 3, 0, STRBUF_MAX_BYTES) ==
+              NULL);
+
+  PackedArray *a = parr_create_custom(sizeof(Item), PARR_CACHELINE_BYTES, 0,
+                                      STRBUF_MAX_BYTES);
+  ASSERT_TRUE(a != NULL);
+
+  // Every slot starts on its own cache line, across growth.
+  void *p = NULL;
+  for (int i = 0; i < 40; i++) {
+    ASSERT_TRUE(parr_emplace(a, &p) != UINT32_MAX);
+    ASSERT_TRUE(((uintptr_t)p % PARR_CACHELINE_BYTES) == 0);
+  }
+  for (uint32_t i = 0; i < 40; i++)
+    ASSERT_TRUE(((uintptr_t)parr_at(a, i) % PARR_CACHELINE_BYTES) == 0);
+
+  // No key column was requested.
+  ASSERT_TRUE(parr_key_at(a, 0) == NULL);
+
+  parr_destroy(a);
+}
+
+static void test_key_column_lockstep(void) {
+  PackedArray *a =
+      parr_create_custom(sizeof(Item), 0, sizeof(uint32_t), STRBUF_MAX_BYTES);
+  ASSERT_TRUE(a != NULL);
+
+  Item *p = NULL;
+  for (uint32_t i = 0; i < 20; i++) {
+    uint32_t idx = parr_emplace(a, (void **)&p);
+    ASSERT_TRUE(idx == i);
+    p->id = (int)(i + 100);
+    uint32_t *key = (uint32_t *)parr_key_at(a, idx);
+    ASSERT_TRUE(key != NULL);
+    *key = i + 100;
+  }
+
+  // Out-of-range keys are rejected like out-of-range objects.
+  ASSERT_TRUE(parr_key_at(a, 20) == NULL);
+  ASSERT_TRUE(parr_key_cat(a, 20) == NULL);
+
+  // Swap-remove moves the key together with its object.
+  parr_drop_swap(a, 3);
+  ASSERT_TRUE(parr_len(a) == 19);
+  for (uint32_t i = 0; i < 19; i++) {
+    const Item *it = (const Item *)parr_cat(a, i);
+    const uint32_t *key = (const uint32_t *)parr_key_cat(a, i);
+    ASSERT_TRUE(it != NULL && key != NULL);
+    ASSERT_TRUE((uint32_t)it->id == *key);
+  }
+
+  parr_destroy(a);
+}
+
 int main(void) {
   test_basic_emplace_and_at();
   test_invalid_inputs();
@@ -216,6 +272,8 @@ int main(void) {
   test_emplace_failure();
   test_upper_bound();
   test_upper_bound_non_power_of_two_capacity();
+  test_custom_alignment();
+  test_key_column_lockstep();
 
   fprintf(stderr, "OK: test_packed_array\n");
   return 0;
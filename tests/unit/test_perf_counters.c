@@ -0,0 +1,72 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "perf_counters.h"
+#include "test.h"
+
+#ifdef ADBX_PERF_COUNTERS
+
+#define WRITERS 4
+#define BUMPS_PER_WRITER 1000
+
+static void *bumper_main(void *arg) {
+  (void)arg;
+  for (int i = 0; i < BUMPS_PER_WRITER; i++) {
+    PERF_COUNT(PERF_FRAMES_RELAYED);
+    PERF_COUNT_N(PERF_ARENA_BYTES, 64);
+  }
+  return NULL;
+}
+
+/* Per-thread slots must aggregate to the exact total on read. */
+static void test_concurrent_bumps_aggregate(void) {
+  uint64_t frames0 = perf_total(PERF_FRAMES_RELAYED);
+  uint64_t bytes0 = perf_total(PERF_ARENA_BYTES);
+
+  pthread_t tids[WRITERS];
+  for (int i = 0; i < WRITERS; i++)
+    ASSERT_TRUE(pthread_create(&tids[i], NULL, bumper_main, NULL) == 0);
+  for (int i = 0; i < WRITERS; i++)
+    pthread_join(tids[i], NULL);
+
+  ASSERT_TRUE(perf_total(PERF_FRAMES_RELAYED) - frames0 ==
+              (uint64_t)WRITERS * BUMPS_PER_WRITER);
+  ASSERT_TRUE(perf_total(PERF_ARENA_BYTES) - bytes0 ==
+              (uint64_t)WRITERS * BUMPS_PER_WRITER * 64u);
+}
+
+static void test_names_and_bounds(void) {
+  ASSERT_STREQ(perf_counter_name(PERF_PLAN_CACHE_HIT), "plan_cache_hit");
+  ASSERT_STREQ(perf_counter_name(PERF_SB_GROW_BYTES), "sb_grow_bytes");
+  ASSERT_STREQ(perf_counter_name(PERF_TOKENS_REUSED), "tokens_reused");
+  ASSERT_STREQ(perf_counter_name(PERF_JSON_ALLOC_BYTES), "json_alloc_bytes");
+  ASSERT_STREQ(perf_counter_name(PERF_BROKER_RECONNECTS),
+               "broker_reconnects");
+  ASSERT_STREQ(perf_counter_name((PerfCounterId)PERF_COUNTER_N), "?");
+
+  // Out-of-range ids are ignored on write and read as zero.
+  perf_count((PerfCounterId)PERF_COUNTER_N, 5);
+  ASSERT_TRUE(perf_total((PerfCounterId)PERF_COUNTER_N) == 0);
+}
+
+int main(void) {
+  test_concurrent_bumps_aggregate();
+  test_names_and_bounds();
+
+  fprintf(stderr, "OK: test_perf_counters\n");
+  return 0;
+}
+
+#else
+
+/* Minimal builds compile the subsystem to nothing; the macros must still be
+ * valid statements. */
+int main(void) {
+  PERF_COUNT(PERF_FRAMES_RELAYED);
+  PERF_COUNT_N(PERF_ARENA_BYTES, 64);
+  fprintf(stderr, "OK: test_perf_counters (compiled out)\n");
+  return 0;
+}
+
+#endif
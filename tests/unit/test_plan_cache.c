@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "plan_cache.h"
+#include "test.h"
+#include "utils.h"
+
+/* Fills 'out' with one fabricated plan: a plaintext column followed by a
+ * token column whose col_id is 'col_id'. Keeps these tests independent from
+ * the SQL parser. */
+static void build_fake_vout(ValidateQueryOut *out, const char *col_id) {
+  ASSERT_TRUE(vq_out_init(out) == OK);
+
+  void *slot = NULL;
+  ASSERT_TRUE(parr_emplace(out->plan.cols, &slot) != UINT32_MAX);
+  ValidatorColPlan *plain = (ValidatorColPlan *)slot;
+  plain->kind = VCOL_OUT_PLAINTEXT;
+  plain->col_id = NULL;
+  plain->col_id_len = 0;
+
+  ASSERT_TRUE(parr_emplace(out->plan.cols, &slot) != UINT32_MAX);
+  ValidatorColPlan *tok = (ValidatorColPlan *)slot;
+  tok->kind = VCOL_OUT_TOKEN;
+  tok->col_id_len = (uint32_t)strlen(col_id);
+  tok->col_id =
+      arena_add_nul(&out->plan.arena, (void *)col_id, tok->col_id_len);
+  ASSERT_TRUE(tok->col_id != NULL);
+}
+
+static void test_plan_cache_hit_is_deep_copy(void) {
+  PlanCache *pc = plan_cache_create(0);
+  ASSERT_TRUE(pc != NULL);
+
+  ValidateQueryOut src;
+  build_fake_vout(&src, "public.users.email");
+
+  ValidateQueryOut got;
+  ASSERT_TRUE(vq_out_init(&got) == OK);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT 1", NULL, 0, &got) == NO);
+
+  plan_cache_put(pc, "db1", "SELECT 1", NULL, 0, &src);
+  // The cache must keep its own copy, not borrow the caller's storage.
+  vq_out_clean(&src);
+
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT 1", NULL, 0, &got) == YES);
+  ASSERT_TRUE(parr_len(got.plan.cols) == 2);
+  const ValidatorColPlan *c0 =
+      (const ValidatorColPlan *)parr_cat(got.plan.cols, 0);
+  const ValidatorColPlan *c1 =
+      (const ValidatorColPlan *)parr_cat(got.plan.cols, 1);
+  ASSERT_TRUE(c0->kind == VCOL_OUT_PLAINTEXT && c0->col_id == NULL);
+  ASSERT_TRUE(c1->kind == VCOL_OUT_TOKEN);
+  ASSERT_STREQ(c1->col_id, "public.users.email");
+  ASSERT_TRUE(c1->col_id_len == strlen("public.users.email"));
+
+  // Different connection or SQL text must miss.
+  ASSERT_TRUE(plan_cache_get(pc, "db2", "SELECT 1", NULL, 0, &got) == NO);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT 2", NULL, 0, &got) == NO);
+
+  vq_out_clean(&got);
+  plan_cache_destroy(pc);
+}
+
+static void test_plan_cache_keys_on_param_scopes(void) {
+  PlanCache *pc = plan_cache_create(0);
+  ASSERT_TRUE(pc != NULL);
+
+  ValidateQueryOut src;
+  build_fake_vout(&src, "public.users.ssn");
+
+  SensitiveTok p_ssn = {0};
+  p_ssn.value = "secret";
+  p_ssn.value_len = 6;
+  p_ssn.col_ref = "public.users.ssn";
+  p_ssn.col_ref_len = (uint32_t)strlen(p_ssn.col_ref);
+
+  const char *sql = "SELECT u.name FROM users u WHERE u.ssn = $1";
+  plan_cache_put(pc, "db1", sql, &p_ssn, 1, &src);
+
+  ValidateQueryOut got;
+  ASSERT_TRUE(vq_out_init(&got) == OK);
+
+  // Same scope with a different bound value still hits.
+  SensitiveTok p_other_val = p_ssn;
+  p_other_val.value = "other";
+  p_other_val.value_len = 5;
+  ASSERT_TRUE(plan_cache_get(pc, "db1", sql, &p_other_val, 1, &got) == YES);
+
+  // A different scope or param count must revalidate.
+  SensitiveTok p_email = p_ssn;
+  p_email.col_ref = "public.users.email";
+  p_email.col_ref_len = (uint32_t)strlen(p_email.col_ref);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", sql, &p_email, 1, &got) == NO);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", sql, NULL, 0, &got) == NO);
+
+  // Failed validations are never retained.
+  src.err.code = VERR_PARSE_FAIL;
+  plan_cache_put(pc, "db1", "SELECT broken", NULL, 0, &src);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT broken", NULL, 0, &got) == NO);
+
+  vq_out_clean(&got);
+  vq_out_clean(&src);
+  plan_cache_destroy(pc);
+}
+
+static void test_plan_cache_evicts_lru(void) {
+  PlanCache *pc = plan_cache_create(2);
+  ASSERT_TRUE(pc != NULL);
+
+  ValidateQueryOut src;
+  build_fake_vout(&src, "public.t.c");
+
+  plan_cache_put(pc, "db1", "SELECT a", NULL, 0, &src);
+  plan_cache_put(pc, "db1", "SELECT b", NULL, 0, &src);
+
+  ValidateQueryOut got;
+  ASSERT_TRUE(vq_out_init(&got) == OK);
+
+  // Touch "SELECT a" so "SELECT b" becomes the LRU victim.
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT a", NULL, 0, &got) == YES);
+  plan_cache_put(pc, "db1", "SELECT c", NULL, 0, &src);
+
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT a", NULL, 0, &got) == YES);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT b", NULL, 0, &got) == NO);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT c", NULL, 0, &got) == YES);
+
+  // Re-putting an already retained key refreshes it instead of duplicating.
+  plan_cache_put(pc, "db1", "SELECT c", NULL, 0, &src);
+  ASSERT_TRUE(plan_cache_get(pc, "db1", "SELECT a", NULL, 0, &got) == YES);
+
+  vq_out_clean(&got);
+  vq_out_clean(&src);
+  plan_cache_destroy(pc);
+}
+
+int main(void) {
+  test_plan_cache_hit_is_deep_copy();
+  test_plan_cache_keys_on_param_scopes();
+  test_plan_cache_evicts_lru();
+  fprintf(stderr, "OK: test_plan_cache\n");
+  return 0;
+}
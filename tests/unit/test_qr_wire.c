@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_codec.h"
+#include "mcp_id.h"
+#include "qr_wire.h"
+#include "query_result.h"
+#include "test.h"
+
+static McpId id_u32(uint32_t v) {
+  McpId id = {0};
+  mcp_id_init_u32(&id, v);
+  return id;
+}
+
+/* Encodes 'qr', transcodes the binary payload back to JSON-RPC, and asserts
+ * the bytes equal what qr_to_jsonrpc() produces directly — the parity the
+ * broker/server hop relies on. */
+static void assert_wire_roundtrip(const QueryResult *qr) {
+  char *direct = NULL;
+  size_t direct_len = 0;
+  ASSERT_TRUE(qr_to_jsonrpc(qr, &direct, &direct_len) == OK);
+
+  StrBuf bin;
+  sb_init(&bin);
+  ASSERT_TRUE(qr_wire_encode(qr, &bin) == OK);
+  ASSERT_TRUE(bin.len > 0 && (uint8_t)bin.data[0] == QR_WIRE_MARKER);
+
+  char *via_wire = NULL;
+  size_t via_len = 0;
+  ASSERT_TRUE(qr_wire_to_jsonrpc((const uint8_t *)bin.data, bin.len, &via_wire,
+                                 &via_len) == OK);
+  ASSERT_TRUE(via_len == direct_len);
+  ASSERT_TRUE(memcmp(via_wire, direct, direct_len) == 0);
+
+  free(direct);
+  free(via_wire);
+  sb_clean(&bin);
+}
+
+static void test_qr_wire_ok_result(void) {
+  McpId id = id_u32(42);
+  QueryResult *qr = qr_create_ok(&id, 2, 3, 1, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 0, "id", "int4", 23) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 1, "note", "text", 25) == OK);
+  ASSERT_TRUE(qb_set_cell(&qb, 0, 0, "1", 1) == YES);
+  // Escapable bytes ride the wire raw; only the transcode escapes them.
+  ASSERT_TRUE(qb_set_cell(&qb, 0, 1, "he said \"hi\"\n", 13) == YES);
+  ASSERT_TRUE(qb_set_cell(&qb, 1, 0, "2", 1) == YES);
+  ASSERT_TRUE(qb_set_cell(&qb, 1, 1, NULL, 0) == YES); // SQL NULL
+  ASSERT_TRUE(qb_set_cell(&qb, 2, 0, "3", 1) == YES);
+  ASSERT_TRUE(qb_set_cell(&qb, 2, 1, "caf\xC3\xA9", 5) == YES);
+  qr->exec_ms = 17;
+  qr->spilled_rows = 5;
+
+  assert_wire_roundtrip(qr);
+
+  // Columnar serialization negotiates per request; parity must hold too.
+  qr->columnar = 1;
+  assert_wire_roundtrip(qr);
+
+  qr_destroy(qr);
+}
+
+static void test_qr_wire_string_id_and_empty(void) {
+  McpId id = {0};
+  ASSERT_TRUE(mcp_id_init_str_copy(&id, "req-abc") == OK);
+  QueryResult *qr = qr_create_ok(&id, 1, 0, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 0, "n", "int8", 20) == OK);
+
+  assert_wire_roundtrip(qr);
+
+  qr_destroy(qr);
+  mcp_id_clean(&id);
+}
+
+static void test_qr_wire_error_results(void) {
+  McpId id = id_u32(9);
+  QueryResult *err =
+      qr_create_err(&id, QRERR_INPARAM, "bad param: %s", "limit");
+  ASSERT_TRUE(err != NULL);
+  err->exec_ms = 3;
+  assert_wire_roundtrip(err);
+  qr_destroy(err);
+
+  QueryResult *terr = qr_create_tool_err(&id, "query failed: \"%s\"", "boom");
+  ASSERT_TRUE(terr != NULL);
+  assert_wire_roundtrip(terr);
+  qr_destroy(terr);
+}
+
+static void test_qr_wire_rejects_malformed(void) {
+  McpId id = id_u32(1);
+  QueryResult *qr = qr_create_ok(&id, 1, 1, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 0, "v", "text", 25) == OK);
+  ASSERT_TRUE(qb_set_cell(&qb, 0, 0, "x", 1) == YES);
+
+  StrBuf bin;
+  sb_init(&bin);
+  ASSERT_TRUE(qr_wire_encode(qr, &bin) == OK);
+
+  char *json = NULL;
+  size_t json_len = 0;
+  // Truncations at every boundary must fail cleanly, never crash.
+  for (size_t cut = 0; cut < bin.len; cut++) {
+    ASSERT_TRUE(qr_wire_to_jsonrpc((const uint8_t *)bin.data, cut, &json,
+                                   &json_len) == ERR);
+    ASSERT_TRUE(json == NULL && json_len == 0);
+  }
+  // Trailing garbage after a complete result is malformed too.
+  ASSERT_TRUE(sb_append_bytes(&bin, "x", 1) == OK);
+  ASSERT_TRUE(qr_wire_to_jsonrpc((const uint8_t *)bin.data, bin.len, &json,
+                                 &json_len) == ERR);
+  // A JSON payload never decodes as binary.
+  ASSERT_TRUE(qr_wire_to_jsonrpc((const uint8_t *)"{\"a\":1}", 7, &json,
+                                 &json_len) == ERR);
+
+  sb_clean(&bin);
+  qr_destroy(qr);
+}
+
+int main(void) {
+  test_qr_wire_ok_result();
+  test_qr_wire_string_id_and_empty();
+  test_qr_wire_error_results();
+  test_qr_wire_rejects_malformed();
+  fprintf(stderr, "OK: test_qr_wire\n");
+  return 0;
+}
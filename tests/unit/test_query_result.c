@@ -90,6 +90,39 @@ static void test_max_query_bytes_cap(void) {
   qr_destroy(qr);
 }
 
+/* Streaming producers create a zero-row result and grow it while appending. */
+static void test_reserve_rows_grows_incrementally(void) {
+  McpId id = id_u32(2);
+  QueryResult *qr = qr_create_ok(&id, 2, 0, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 0, "id", "int4") == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 1, "name", "text") == OK);
+
+  // No storage yet: writing row 0 must fail until it is reserved.
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 0, "1") == ERR);
+
+  for (uint32_t r = 0; r < 100; r++) {
+    ASSERT_TRUE(qr_reserve_rows(qr, r + 1) == OK);
+    ASSERT_TRUE(qr->nrows_alloc >= r + 1);
+    ASSERT_TRUE(set_cell_plain(&qb, r, 0, "1") == YES);
+    qr->nrows = r + 1;
+  }
+  ASSERT_TRUE(qr->nrows == 100);
+  ASSERT_STREQ(qr_get_cell(qr, 99, 0), "1");
+  // reserved-but-unset cells stay SQL NULL
+  ASSERT_TRUE(qr_is_null(qr, 99, 1) == YES);
+
+  // Shrinking requests are a no-op.
+  uint32_t alloc = qr->nrows_alloc;
+  ASSERT_TRUE(qr_reserve_rows(qr, 1) == OK);
+  ASSERT_TRUE(qr->nrows_alloc == alloc);
+
+  ASSERT_TRUE(qr_reserve_rows(NULL, 1) == ERR);
+  qr_destroy(qr);
+}
+
 static void test_deep_copy_outlives_input_buffers(void) {
   McpId id = id_u32(1);
   QueryResult *qr = qr_create_ok(&id, 2, 1, 0, 0);
@@ -203,6 +236,28 @@ static void test_create_error_fmt(void) {
   qr_destroy(tool_qr);
 }
 
+static void test_create_error_inline_and_heap_msg(void) {
+  McpId id = id_u32(6);
+
+  // Short messages land in the in-place buffer: no heap string is allocated.
+  QueryResult *small = qr_create_tool_err(&id, "short message");
+  ASSERT_TRUE(small != NULL);
+  ASSERT_TRUE(small->err_msg == small->err_inline);
+  ASSERT_STREQ(small->err_msg, "short message");
+  qr_destroy(small);
+
+  // Messages past QR_ERR_MSG_INLINE spill to a right-sized heap string.
+  char big_buf[2 * QR_ERR_MSG_INLINE];
+  memset(big_buf, 'x', sizeof(big_buf) - 1);
+  big_buf[sizeof(big_buf) - 1] = '\0';
+  const char *big = big_buf;
+  QueryResult *large = qr_create_err(&id, QRERR_INTERNAL, "%s", big);
+  ASSERT_TRUE(large != NULL);
+  ASSERT_TRUE(large->err_msg != large->err_inline);
+  ASSERT_STREQ(large->err_msg, big);
+  qr_destroy(large);
+}
+
 static void test_create_msg(void) {
   McpId id = id_u32(9);
   QueryResult *qr = qr_create_msg(&id, "Hello");
@@ -229,6 +284,57 @@ static void test_create_msg(void) {
   qr_destroy(qr_null);
 }
 
+static void test_qr_clone(void) {
+  McpId id = id_u32(11);
+  QueryResult *src = qr_create_ok(&id, 2, 2, 1, 0);
+  ASSERT_TRUE(src != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, src, NULL) == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 0, "id", "int4") == OK);
+  ASSERT_TRUE(set_col_plain(&qb, 1, "note", "text") == OK);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 0, "1") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 0, 1, "hello") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 0, "2") == YES);
+  ASSERT_TRUE(set_cell_plain(&qb, 1, 1, NULL) == YES);
+  src->exec_ms = 7;
+  src->columnar = 1;
+  src->cols[1].value_type = QRCOL_V_TOKEN;
+
+  McpId clone_id = id_u32(42);
+  QueryResult *copy = qr_clone(src, &clone_id);
+  ASSERT_TRUE(copy != NULL);
+  ASSERT_TRUE(copy->id.kind == MCP_ID_INT && copy->id.u32 == 42);
+  ASSERT_TRUE(copy->status == QR_OK);
+  ASSERT_TRUE(copy->ncols == 2 && copy->nrows == 2);
+  ASSERT_TRUE(copy->result_truncated == 1);
+  ASSERT_TRUE(copy->exec_ms == 7);
+  ASSERT_TRUE(copy->columnar == 1);
+  ASSERT_STREQ(copy->cols[0].name, "id");
+  ASSERT_TRUE(copy->cols[1].value_type == QRCOL_V_TOKEN);
+  ASSERT_STREQ(qr_get_cell(copy, 0, 1), "hello");
+  ASSERT_TRUE(qr_is_null(copy, 1, 1) == YES);
+  // the clone owns its bytes and never borrows the source's spill
+  ASSERT_TRUE(copy->spilled_rows == 0 && copy->spill == NULL);
+  qr_destroy(src);
+  ASSERT_STREQ(qr_get_cell(copy, 1, 0), "2");
+  qr_destroy(copy);
+
+  // errors clone too, keeping status/code/message
+  McpId err_id = id_u32(13);
+  QueryResult *err = qr_create_err(&err_id, QRERR_INPARAM, "Bad input.");
+  ASSERT_TRUE(err != NULL);
+  QueryResult *err_copy = qr_clone(err, &clone_id);
+  ASSERT_TRUE(err_copy != NULL);
+  ASSERT_TRUE(err_copy->status == QR_ERROR);
+  ASSERT_TRUE(err_copy->err_code == QRERR_INPARAM);
+  ASSERT_STREQ(err_copy->err_msg, "Bad input.");
+  ASSERT_TRUE(err_copy->id.u32 == 42);
+  qr_destroy(err);
+  qr_destroy(err_copy);
+
+  ASSERT_TRUE(qr_clone(NULL, &clone_id) == NULL);
+}
+
 static void test_qb_init_input_validation(void) {
   McpId id = id_u32(11);
   QueryResult *qr = qr_create_ok(&id, 1, 1, 0, 0);
@@ -383,14 +489,10 @@ static void test_qb_tokenizes_sensitive_column_and_store_roundtrip(void) {
   ASSERT_TRUE(strncmp(tok, SENSITIVE_TOK_PREFIX, strlen(SENSITIVE_TOK_PREFIX)) ==
               0);
 
-  char tok_copy[SENSITIVE_TOK_BUFSZ] = {0};
-  size_t tok_len = strlen(tok);
-  ASSERT_TRUE(tok_len < sizeof(tok_copy));
-  memcpy(tok_copy, tok, tok_len + 1u);
+  ASSERT_TRUE(strlen(tok) == SENSITIVE_TOK_LEN);
 
   ParsedTokView v = {0};
-  ASSERT_TRUE(stok_parse_view_inplace(tok_copy, &v) == OK);
-  ASSERT_STREQ(v.connection_name, "pgmain");
+  ASSERT_TRUE(stok_parse_view(tok, &v) == OK);
   ASSERT_TRUE(v.generation == 42u);
 
   const SensitiveTok *st = stok_store_get(store, v.index);
@@ -523,15 +625,49 @@ static void test_qb_sensitive_col_missing_col_id_returns_err(void) {
   vq_out_clean(&out);
 }
 
+static void test_qb_set_row_batch_and_cap(void) {
+  QueryResult *qr = qr_create_ok(NULL, 3, 2, 0, 12);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+
+  QRCellSpan row0[3] = {
+      {"1", 1u}, {NULL, 0u}, {"alice", 5u}}; // 6 payload bytes
+  ASSERT_TRUE(qb_set_row(&qb, 0, row0, 3) == YES);
+  ASSERT_STREQ(qr_get_cell(qr, 0, 0), "1");
+  ASSERT_TRUE(qr_is_null(qr, 0, 1) == YES);
+  ASSERT_STREQ(qr_get_cell(qr, 0, 2), "alice");
+  ASSERT_TRUE(qr->used_query_bytes == 6u);
+
+  // A row that would push past max_query_bytes stores nothing.
+  QRCellSpan row1[3] = {{"2", 1u}, {"bobby", 5u}, {"x", 1u}};
+  ASSERT_TRUE(qb_set_row(&qb, 1, row1, 3) == NO);
+  ASSERT_TRUE(qr_is_null(qr, 1, 0) == YES);
+  ASSERT_TRUE(qr->used_query_bytes == 6u);
+
+  // Bad inputs: span count mismatch, out-of-range row, NULL with length.
+  ASSERT_TRUE(qb_set_row(&qb, 1, row1, 2) == ERR);
+  ASSERT_TRUE(qb_set_row(&qb, 2, row1, 3) == ERR);
+  QRCellSpan bad[3] = {{NULL, 1u}, {NULL, 0u}, {NULL, 0u}};
+  ASSERT_TRUE(qb_set_row(&qb, 1, bad, 3) == ERR);
+  ASSERT_TRUE(qb_set_row(NULL, 1, row1, 3) == ERR);
+
+  qr_destroy(qr);
+}
+
 int main(void) {
   test_create_and_basic_set_get();
+  test_qb_set_row_batch_and_cap();
   test_max_query_bytes_cap();
+  test_reserve_rows_grows_incrementally();
   test_deep_copy_outlives_input_buffers();
   test_bounds_and_bad_inputs();
   test_create_error();
   test_create_tool_error();
   test_create_error_fmt();
+  test_create_error_inline_and_heap_msg();
   test_create_msg();
+  test_qr_clone();
   test_qb_init_input_validation();
   test_qb_init_policy_and_reset();
   test_qr_set_id_replaces_previous();
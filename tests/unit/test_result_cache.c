@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "result_cache.h"
+#include "test.h"
+#include "utils.h"
+
+/* Blocks for roughly 'ms' milliseconds so short TTLs can lapse. */
+static void sleep_ms(long ms) {
+  struct timespec ts = {.tv_sec = ms / 1000,
+                        .tv_nsec = (ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+static void test_result_cache_hit_keys_on_conn_sql_shape(void) {
+  ResultCache *rc = result_cache_create(0);
+  ASSERT_TRUE(rc != NULL);
+
+  const char *json = "\"result\":{\"fake\":1}}";
+  const char *hit = NULL;
+  size_t hit_len = 0;
+
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              NO);
+  result_cache_put(rc, "db1", "SELECT 1", 0, 60000, json, strlen(json));
+
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              YES);
+  ASSERT_TRUE(hit_len == strlen(json));
+  ASSERT_TRUE(memcmp(hit, json, hit_len) == 0);
+
+  // Different connection, SQL text, or output shape must miss.
+  ASSERT_TRUE(result_cache_get(rc, "db2", "SELECT 1", 0, &hit, &hit_len) ==
+              NO);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 2", 0, &hit, &hit_len) ==
+              NO);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 1, &hit, &hit_len) ==
+              NO);
+
+  // Both shapes of the same query coexist in separate slots.
+  const char *columnar_json = "\"result\":{\"fake\":2}}";
+  result_cache_put(rc, "db1", "SELECT 1", 1, 60000, columnar_json,
+                   strlen(columnar_json));
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 1, &hit, &hit_len) ==
+              YES);
+  ASSERT_TRUE(memcmp(hit, columnar_json, hit_len) == 0);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              YES);
+  ASSERT_TRUE(memcmp(hit, json, hit_len) == 0);
+
+  result_cache_destroy(rc);
+}
+
+static void test_result_cache_ttl_expires(void) {
+  ResultCache *rc = result_cache_create(0);
+  ASSERT_TRUE(rc != NULL);
+
+  const char *json = "\"result\":{}}";
+  const char *hit = NULL;
+  size_t hit_len = 0;
+
+  // A zero TTL never retains anything.
+  result_cache_put(rc, "db1", "SELECT 1", 0, 0, json, strlen(json));
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              NO);
+
+  result_cache_put(rc, "db1", "SELECT 1", 0, 40, json, strlen(json));
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              YES);
+  sleep_ms(60);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              NO);
+
+  // Re-putting after expiry restarts the window in the same slot.
+  result_cache_put(rc, "db1", "SELECT 1", 0, 60000, json, strlen(json));
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT 1", 0, &hit, &hit_len) ==
+              YES);
+
+  result_cache_destroy(rc);
+}
+
+static void test_result_cache_evicts_lru_and_caps_entry_size(void) {
+  ResultCache *rc = result_cache_create(2);
+  ASSERT_TRUE(rc != NULL);
+
+  const char *json = "\"result\":{}}";
+  const char *hit = NULL;
+  size_t hit_len = 0;
+
+  result_cache_put(rc, "db1", "SELECT a", 0, 60000, json, strlen(json));
+  result_cache_put(rc, "db1", "SELECT b", 0, 60000, json, strlen(json));
+
+  // Touch "SELECT a" so "SELECT b" becomes the LRU victim.
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT a", 0, &hit, &hit_len) ==
+              YES);
+  result_cache_put(rc, "db1", "SELECT c", 0, 60000, json, strlen(json));
+
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT a", 0, &hit, &hit_len) ==
+              YES);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT b", 0, &hit, &hit_len) ==
+              NO);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT c", 0, &hit, &hit_len) ==
+              YES);
+
+  // Oversized payloads are never retained (and evict nothing).
+  size_t big_len = RESULT_CACHE_MAX_ENTRY_BYTES + 1u;
+  char *big = (char *)xmalloc(big_len);
+  memset(big, 'x', big_len);
+  result_cache_put(rc, "db1", "SELECT big", 0, 60000, big, big_len);
+  free(big);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT big", 0, &hit, &hit_len) ==
+              NO);
+  ASSERT_TRUE(result_cache_get(rc, "db1", "SELECT a", 0, &hit, &hit_len) ==
+              YES);
+
+  result_cache_destroy(rc);
+}
+
+int main(void) {
+  test_result_cache_hit_keys_on_conn_sql_shape();
+  test_result_cache_ttl_expires();
+  test_result_cache_evicts_lru_and_caps_entry_size();
+  fprintf(stderr, "OK: test_result_cache\n");
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "query_result.h"
+#include "result_spill.h"
+#include "test.h"
+
+/* Opens one throwaway spill directory under /tmp and returns its owned fd. */
+static int open_spill_dir(void) {
+  char *path = make_tmp_dir();
+  int flags = O_RDONLY;
+#ifdef O_DIRECTORY
+  flags |= O_DIRECTORY;
+#endif
+  int fd = open(path, flags);
+  ASSERT_TRUE(fd >= 0);
+  free(path);
+  return fd;
+}
+
+/* Builds one two-column source result whose metadata seeds the spill. */
+static QueryResult *make_src_qr(void) {
+  QueryResult *qr = qr_create_ok(NULL, 2, 0, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 0, "id", "int4", 23) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 1, "note", "text", 25) == OK);
+  return qr;
+}
+
+/* Commits one ("<n>", "note-<n>") row into 'rs'. */
+static AdbxTriStatus commit_numbered_row(ResultSpill *rs, uint32_t n) {
+  char idbuf[16];
+  char notebuf[32];
+  snprintf(idbuf, sizeof(idbuf), "%u", n);
+  snprintf(notebuf, sizeof(notebuf), "note-%u", n);
+  ASSERT_TRUE(rspill_cell(rs, idbuf, strlen(idbuf)) == OK);
+  ASSERT_TRUE(rspill_cell(rs, notebuf, strlen(notebuf)) == OK);
+  return rspill_row_commit(rs);
+}
+
+static void test_spill_roundtrip_and_paging(void) {
+  int dirfd = open_spill_dir();
+  ResultSpill *rs = rspill_create(dirfd, 0);
+  ASSERT_TRUE(rs != NULL);
+
+  QueryResult *src = make_src_qr();
+  ASSERT_TRUE(rspill_set_cols(rs, src) == OK);
+  // column metadata is copied once; a second call is a misuse
+  ASSERT_TRUE(rspill_set_cols(rs, src) == ERR);
+  qr_destroy(src);
+
+  for (uint32_t n = 0; n < 25; n++)
+    ASSERT_TRUE(commit_numbered_row(rs, n) == YES);
+  ASSERT_TRUE(rspill_nrows(rs) == 25);
+
+  // First page: 10 rows, more remain.
+  McpId id = {0};
+  mcp_id_init_u32(&id, 9);
+  QueryResult *page = rspill_fetch_page(rs, &id, 0, 10);
+  ASSERT_TRUE(page != NULL);
+  ASSERT_TRUE(page->nrows == 10);
+  ASSERT_TRUE(page->ncols == 2);
+  ASSERT_TRUE(page->result_truncated == 1);
+  ASSERT_TRUE(page->spilled_rows == 25);
+  ASSERT_TRUE(page->id.kind == MCP_ID_INT && page->id.u32 == 9);
+  const QRColumn *c = qr_get_col(page, 1);
+  ASSERT_STREQ(c->name, "note");
+  ASSERT_STREQ(c->type, "text");
+  ASSERT_TRUE(c->pg_oid == 25);
+  ASSERT_STREQ(qr_get_cell(page, 0, 0), "0");
+  ASSERT_STREQ(qr_get_cell(page, 9, 1), "note-9");
+  qr_destroy(page);
+
+  // Last partial page: rows 20..24, nothing truncated.
+  page = rspill_fetch_page(rs, NULL, 20, 10);
+  ASSERT_TRUE(page != NULL);
+  ASSERT_TRUE(page->nrows == 5);
+  ASSERT_TRUE(page->result_truncated == 0);
+  ASSERT_STREQ(qr_get_cell(page, 4, 0), "24");
+  ASSERT_STREQ(qr_get_cell(page, 4, 1), "note-24");
+  qr_destroy(page);
+
+  // Out-of-range start rows serve nothing.
+  ASSERT_TRUE(rspill_fetch_page(rs, NULL, 25, 10) == NULL);
+
+  rspill_destroy(rs);
+  close(dirfd);
+}
+
+static void test_spill_null_cells_survive(void) {
+  int dirfd = open_spill_dir();
+  ResultSpill *rs = rspill_create(dirfd, 0);
+  ASSERT_TRUE(rs != NULL);
+
+  QueryResult *src = make_src_qr();
+  ASSERT_TRUE(rspill_set_cols(rs, src) == OK);
+  qr_destroy(src);
+
+  ASSERT_TRUE(rspill_cell(rs, "1", 1) == OK);
+  ASSERT_TRUE(rspill_cell(rs, NULL, 0) == OK);
+  ASSERT_TRUE(rspill_row_commit(rs) == YES);
+  // empty string is a value, not SQL NULL
+  ASSERT_TRUE(rspill_cell(rs, NULL, 0) == OK);
+  ASSERT_TRUE(rspill_cell(rs, "", 0) == OK);
+  ASSERT_TRUE(rspill_row_commit(rs) == YES);
+
+  QueryResult *page = rspill_fetch_page(rs, NULL, 0, 0);
+  ASSERT_TRUE(page != NULL);
+  ASSERT_TRUE(page->nrows == 2);
+  ASSERT_STREQ(qr_get_cell(page, 0, 0), "1");
+  ASSERT_TRUE(qr_is_null(page, 0, 1) == YES);
+  ASSERT_TRUE(qr_is_null(page, 1, 0) == YES);
+  ASSERT_TRUE(qr_is_null(page, 1, 1) == NO);
+  ASSERT_STREQ(qr_get_cell(page, 1, 1), "");
+  qr_destroy(page);
+
+  rspill_destroy(rs);
+  close(dirfd);
+}
+
+static void test_spill_byte_cap_drops_row(void) {
+  int dirfd = open_spill_dir();
+  // Cap low enough that the second row overflows it.
+  ResultSpill *rs = rspill_create(dirfd, 12);
+  ASSERT_TRUE(rs != NULL);
+
+  QueryResult *src = make_src_qr();
+  ASSERT_TRUE(rspill_set_cols(rs, src) == OK);
+  qr_destroy(src);
+
+  ASSERT_TRUE(commit_numbered_row(rs, 0) == YES); // "0" + "note-0" = 7 bytes
+  ASSERT_TRUE(commit_numbered_row(rs, 1) == NO);  // would reach 14 > 12
+  ASSERT_TRUE(rspill_nrows(rs) == 1);
+
+  // The dropped row leaves no partial record behind.
+  QueryResult *page = rspill_fetch_page(rs, NULL, 0, 0);
+  ASSERT_TRUE(page != NULL);
+  ASSERT_TRUE(page->nrows == 1);
+  ASSERT_TRUE(page->spilled_rows == 1);
+  ASSERT_TRUE(page->result_truncated == 0);
+  qr_destroy(page);
+
+  rspill_destroy(rs);
+  close(dirfd);
+}
+
+static void test_spill_bad_inputs(void) {
+  ASSERT_TRUE(rspill_create(-1, 0) == NULL);
+  ASSERT_TRUE(rspill_set_cols(NULL, NULL) == ERR);
+  ASSERT_TRUE(rspill_cell(NULL, "x", 1) == ERR);
+  ASSERT_TRUE(rspill_row_commit(NULL) == ERR);
+  ASSERT_TRUE(rspill_nrows(NULL) == 0);
+  ASSERT_TRUE(rspill_fetch_page(NULL, NULL, 0, 0) == NULL);
+  rspill_destroy(NULL); // safe on NULL
+
+  int dirfd = open_spill_dir();
+  ResultSpill *rs = rspill_create(dirfd, 0);
+  ASSERT_TRUE(rs != NULL);
+
+  // cells before rspill_set_cols() are a misuse
+  ASSERT_TRUE(rspill_cell(rs, "x", 1) == ERR);
+
+  QueryResult *src = make_src_qr();
+  ASSERT_TRUE(rspill_set_cols(rs, src) == OK);
+  qr_destroy(src);
+
+  // committing a row with the wrong cell count fails and keeps the stage
+  ASSERT_TRUE(rspill_cell(rs, "1", 1) == OK);
+  ASSERT_TRUE(rspill_row_commit(rs) == ERR);
+  // a third cell for a two-column row is rejected
+  ASSERT_TRUE(rspill_cell(rs, "2", 1) == OK);
+  ASSERT_TRUE(rspill_cell(rs, "3", 1) == ERR);
+
+  rspill_destroy(rs);
+  close(dirfd);
+}
+
+int main(void) {
+  test_spill_roundtrip_and_paging();
+  test_spill_null_cells_survive();
+  test_spill_byte_cap_drops_row();
+  test_spill_bad_inputs();
+  fprintf(stderr, "OK: test_result_spill\n");
+  return 0;
+}
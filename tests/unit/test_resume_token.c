@@ -115,6 +115,9 @@ static void test_corrupted_file_is_deleted(void) {
   ASSERT_TRUE(restok_store(&store, tok) == OK);
   ASSERT_TRUE(store.token_path != NULL);
 
+  // Stores are deferred; the file must exist before poking it directly.
+  ASSERT_TRUE(restok_flush(&store) == OK);
+
   int fd = open(store.token_path, O_WRONLY | O_TRUNC, 0600);
   ASSERT_TRUE(fd >= 0);
   const uint8_t bad[7] = {1, 2, 3, 4, 5, 6, 7};
@@ -159,11 +162,71 @@ static void test_dir_policy_disables_resume(void) {
   free(tmpdir);
 }
 
+/* Verifies token I/O runs against the cached dirfd instead of re-walking the
+ * stored path: operations keep working after the directory is renamed. */
+static void test_dirfd_survives_dir_rename(void) {
+  char *tmpdir = make_tmpdir();
+  set_runtime_env(tmpdir);
+
+  ResumeTokenStore store = {0};
+  ASSERT_TRUE(restok_init(&store) == YES);
+  ASSERT_TRUE(store.enabled == YES);
+  ASSERT_TRUE(store.dir_fd >= 0);
+
+  const uint8_t in[ADBX_RESUME_TOKEN_LEN] = {
+      90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105,
+      106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+      120, 121};
+  ASSERT_TRUE(restok_store(&store, in) == OK);
+
+  char moved[512];
+  snprintf(moved, sizeof(moved), "%s/moved", tmpdir);
+  ASSERT_TRUE(rename(store.dir_path, moved) == 0);
+
+  uint8_t out[ADBX_RESUME_TOKEN_LEN] = {0};
+  ASSERT_TRUE(restok_load(&store, out) == YES);
+  ASSERT_TRUE(memcmp(in, out, ADBX_RESUME_TOKEN_LEN) == 0);
+  ASSERT_TRUE(restok_delete(&store) == OK);
+
+  ASSERT_TRUE(rename(moved, store.dir_path) == 0);
+  cleanup_runtime_dir(tmpdir, &store);
+  restok_clean(&store);
+  free(tmpdir);
+}
+
+/* Verifies deferred stores coalesce and the newest token wins the write. */
+static void test_deferred_store_last_token_wins(void) {
+  char *tmpdir = make_tmpdir();
+  set_runtime_env(tmpdir);
+
+  ResumeTokenStore store = {0};
+  ASSERT_TRUE(restok_init(&store) == YES);
+  ASSERT_TRUE(store.enabled == YES);
+
+  uint8_t tok[ADBX_RESUME_TOKEN_LEN] = {0};
+  for (uint8_t round = 1; round <= 5; round++) {
+    memset(tok, round, sizeof(tok));
+    ASSERT_TRUE(restok_store(&store, tok) == OK);
+  }
+  ASSERT_TRUE(restok_flush(&store) == OK);
+
+  uint8_t out[ADBX_RESUME_TOKEN_LEN] = {0};
+  ASSERT_TRUE(restok_load(&store, out) == YES);
+  ASSERT_TRUE(memcmp(tok, out, ADBX_RESUME_TOKEN_LEN) == 0);
+  ASSERT_TRUE(restok_delete(&store) == OK);
+
+  cleanup_runtime_dir(tmpdir, &store);
+  restok_clean(&store);
+  free(tmpdir);
+}
+
 int main(void) {
   test_init_and_load_missing();
   test_store_then_load_ok();
   test_corrupted_file_is_deleted();
   test_dir_policy_disables_resume();
+  test_dirfd_survives_dir_rename();
+  test_deferred_store_last_token_wins();
 
   fprintf(stderr, "OK: test_resume_token\n");
   return 0;
@@ -32,8 +32,71 @@ static void test_init_defaults_and_overrides(void) {
   ASSERT_TRUE(p.column_strategy == SAFETY_COLSTRAT_RANDOMIZED);
 }
 
+static void test_compile_flags(void) {
+  SafetyPolicy p;
+  ASSERT_TRUE(safety_policy_init(&p, NULL, NULL, NULL, NULL) == OK);
+
+  // Defaults: read-only, timeout, row cap, and payload cap are active.
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_READ_ONLY));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_STMT_TIMEOUT));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_MAX_ROWS));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_PAYLOAD_CAP));
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_SPILL));
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_RESULT_CACHE));
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_COST_CHECK));
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_SLOW_LOG));
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_COL_DETERMINISTIC));
+
+  // Mutations are reflected only after a recompile.
+  p.read_only = 0;
+  p.spill_max_bytes = 4096;
+  p.max_estimated_cost = 100;
+  p.column_strategy = SAFETY_COLSTRAT_DETERMINISTIC;
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_READ_ONLY));
+  ASSERT_TRUE(safety_policy_compile(&p) == OK);
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_READ_ONLY));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_SPILL));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_COST_CHECK));
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_COL_DETERMINISTIC));
+
+  ASSERT_TRUE(safety_policy_compile(NULL) == ERR);
+}
+
+static void test_priority_classes(void) {
+  SafetyPolicy p;
+  ASSERT_TRUE(safety_policy_init(&p, NULL, NULL, NULL, NULL) == OK);
+
+  // No heavy timeout configured: the class is clamped away; FAST quarters
+  // the default 5000ms timeout.
+  ASSERT_TRUE(!safety_policy_has(&p, SAFETY_F_HEAVY_PRIO));
+  ASSERT_TRUE(safety_policy_clamp_priority(&p, SAFETY_PRIO_HEAVY) ==
+              SAFETY_PRIO_NORMAL);
+  ASSERT_TRUE(safety_policy_clamp_priority(&p, SAFETY_PRIO_FAST) ==
+              SAFETY_PRIO_FAST);
+  ASSERT_TRUE(safety_policy_priority_timeout_ms(&p, SAFETY_PRIO_FAST) == 1250);
+  ASSERT_TRUE(safety_policy_priority_timeout_ms(&p, SAFETY_PRIO_NORMAL) ==
+              5000);
+
+  p.heavy_statement_timeout_ms = 60000;
+  ASSERT_TRUE(safety_policy_compile(&p) == OK);
+  ASSERT_TRUE(safety_policy_has(&p, SAFETY_F_HEAVY_PRIO));
+  ASSERT_TRUE(safety_policy_clamp_priority(&p, SAFETY_PRIO_HEAVY) ==
+              SAFETY_PRIO_HEAVY);
+  ASSERT_TRUE(safety_policy_priority_timeout_ms(&p, SAFETY_PRIO_HEAVY) ==
+              60000);
+
+  // A tiny base timeout still leaves FAST with a nonzero bound; an unlimited
+  // base stays unlimited.
+  p.statement_timeout_ms = 3;
+  ASSERT_TRUE(safety_policy_priority_timeout_ms(&p, SAFETY_PRIO_FAST) == 1);
+  p.statement_timeout_ms = 0;
+  ASSERT_TRUE(safety_policy_priority_timeout_ms(&p, SAFETY_PRIO_FAST) == 0);
+}
+
 int main(void) {
   test_init_defaults_and_overrides();
+  test_compile_flags();
+  test_priority_classes();
   fprintf(stderr, "OK: test_safety_policy\n");
   return 0;
 }
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "query_result.h"
+#include "schema_cache.h"
+#include "test.h"
+#include "utils.h"
+
+/* Blocks for roughly 'ms' milliseconds so short TTLs can lapse. */
+static void sleep_ms(long ms) {
+  struct timespec ts = {.tv_sec = ms / 1000,
+                        .tv_nsec = (ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/* Builds a catalog-shaped QueryResult from 'nrows' rows of four cells each
+ * (NULL cell pointers become SQL NULL). Caller owns the result. */
+static QueryResult *make_catalog_qr(const char *rows[][4], uint32_t nrows) {
+  QueryResult *qr = qr_create_ok(NULL, SCHEMA_SNAPSHOT_NCOLS, nrows, 0, 0);
+  ASSERT_TRUE(qr != NULL);
+
+  QueryResultBuilder qb = {0};
+  ASSERT_TRUE(qb_init(&qb, qr, NULL) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 0, "table_schema", "text", 0) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 1, "table_name", "text", 0) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 2, "column_name", "text", 0) == OK);
+  ASSERT_TRUE(qb_set_col(&qb, 3, "data_type", "text", 0) == OK);
+  for (uint32_t r = 0; r < nrows; r++) {
+    for (uint32_t c = 0; c < SCHEMA_SNAPSHOT_NCOLS; c++) {
+      const char *v = rows[r][c];
+      ASSERT_TRUE(qb_set_cell(&qb, r, c, v, v ? strlen(v) : 0) == YES);
+    }
+  }
+  return qr;
+}
+
+static void test_schema_cache_put_get_interns(void) {
+  SchemaCache *sc = schema_cache_create(60000);
+  ASSERT_TRUE(sc != NULL);
+
+  const SchemaSnapshot *snap = NULL;
+  int stale01 = 1;
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == NO);
+
+  const char *rows[][4] = {
+      {"public", "users", "id", "int4"},
+      {"public", "users", "email", "text"},
+      {"public", "orders", "id", "int4"},
+      {"public", "orders", "note", NULL}, // NULL cell interns as ""
+  };
+  QueryResult *qr = make_catalog_qr(rows, 4);
+  ASSERT_TRUE(schema_cache_put(sc, "db1", qr) == OK);
+  qr_destroy(qr);
+
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(snap != NULL && stale01 == 0);
+  ASSERT_TRUE(snap->nrows == 4);
+  ASSERT_STREQ(snap->schemas[0], "public");
+  ASSERT_STREQ(snap->tables[1], "users");
+  ASSERT_STREQ(snap->columns[2], "id");
+  ASSERT_STREQ(snap->types[0], "int4");
+  ASSERT_STREQ(snap->types[3], "");
+
+  // Repeated values share one interned copy: adjacent runs (schema/table)
+  // and recent distinct repeats (type names) alike.
+  ASSERT_TRUE(snap->schemas[0] == snap->schemas[3]);
+  ASSERT_TRUE(snap->tables[0] == snap->tables[1]);
+  ASSERT_TRUE(snap->types[0] == snap->types[2]);
+
+  // Unknown connections still miss.
+  ASSERT_TRUE(schema_cache_get(sc, "db2", &snap, &stale01) == NO);
+
+  schema_cache_destroy(sc);
+}
+
+static void test_schema_cache_stale_serves_and_marks_refresh(void) {
+  SchemaCache *sc = schema_cache_create(40);
+  ASSERT_TRUE(sc != NULL);
+
+  const char *rows[][4] = {{"public", "t", "c", "text"}};
+  QueryResult *qr = make_catalog_qr(rows, 1);
+  ASSERT_TRUE(schema_cache_put(sc, "db1", qr) == OK);
+
+  const SchemaSnapshot *snap = NULL;
+  int stale01 = 1;
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(stale01 == 0);
+
+  // Past the TTL the snapshot keeps serving but reports itself stale.
+  sleep_ms(60);
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(stale01 == 1);
+  ASSERT_TRUE(snap->nrows == 1);
+
+  // Only one caller wins the refresh slot within the holdoff window.
+  ASSERT_TRUE(schema_cache_mark_refresh(sc, "db1") == YES);
+  ASSERT_TRUE(schema_cache_mark_refresh(sc, "db1") == NO);
+  ASSERT_TRUE(schema_cache_mark_refresh(sc, "nope") == ERR);
+
+  // A landed re-fetch restarts the window and clears the mark.
+  ASSERT_TRUE(schema_cache_put(sc, "db1", qr) == OK);
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(stale01 == 0);
+  ASSERT_TRUE(schema_cache_mark_refresh(sc, "db1") == YES);
+
+  qr_destroy(qr);
+  schema_cache_destroy(sc);
+}
+
+static void test_schema_cache_rejects_and_disables(void) {
+  SchemaCache *sc = schema_cache_create(60000);
+  ASSERT_TRUE(sc != NULL);
+
+  // Malformed inputs: error results and wrong column counts never cache.
+  QueryResult *err = qr_create_tool_err(NULL, "boom");
+  ASSERT_TRUE(schema_cache_put(sc, "db1", err) == ERR);
+  qr_destroy(err);
+  QueryResult *narrow = qr_create_ok(NULL, 2, 0, 0, 0);
+  ASSERT_TRUE(schema_cache_put(sc, "db1", narrow) == ERR);
+  qr_destroy(narrow);
+
+  const char *rows[][4] = {{"public", "t", "c", "text"}};
+  QueryResult *qr = make_catalog_qr(rows, 1);
+
+  // An empty snapshot (no user tables) is a valid, servable answer.
+  QueryResult *empty = qr_create_ok(NULL, SCHEMA_SNAPSHOT_NCOLS, 0, 0, 0);
+  ASSERT_TRUE(schema_cache_put(sc, "db1", empty) == OK);
+  qr_destroy(empty);
+  const SchemaSnapshot *snap = NULL;
+  int stale01 = 1;
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(snap->nrows == 0);
+
+  // Replacing a snapshot swaps the served rows.
+  ASSERT_TRUE(schema_cache_put(sc, "db1", qr) == OK);
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == YES);
+  ASSERT_TRUE(snap->nrows == 1);
+
+  // Reset drops every entry (catalog reload).
+  schema_cache_reset(sc);
+  ASSERT_TRUE(schema_cache_get(sc, "db1", &snap, &stale01) == NO);
+
+  schema_cache_destroy(sc);
+
+  // TTL 0 disables the cache outright: puts drop, gets miss.
+  SchemaCache *off = schema_cache_create(0);
+  ASSERT_TRUE(off != NULL);
+  ASSERT_TRUE(schema_cache_put(off, "db1", qr) == OK);
+  ASSERT_TRUE(schema_cache_get(off, "db1", &snap, &stale01) == NO);
+  schema_cache_destroy(off);
+
+  qr_destroy(qr);
+}
+
+int main(void) {
+  test_schema_cache_put_get_interns();
+  test_schema_cache_stale_serves_and_marks_refresh();
+  test_schema_cache_rejects_and_disables();
+  fprintf(stderr, "OK: test_schema_cache\n");
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -393,6 +394,102 @@ static void test_backend_probe_contract(void) {
   free(tmp);
 }
 
+/* Verifies the factory store serves repeated gets from the session cache and
+ * drops it on mutating calls. The credentials file is removed after the first
+ * get: a later YES can only come from the in-memory cache, and after a
+ * mutation the store must fall back to the backend's (now empty) view.
+ */
+static void test_secret_store_session_cache(void) {
+  char *tmp = make_tmp_dir();
+  char *old_xdg = getenv("XDG_CONFIG_HOME");
+  int had_xdg = (old_xdg != NULL);
+  old_xdg = old_xdg ? dup_or_null(old_xdg) : NULL;
+  ASSERT_TRUE(setenv("XDG_CONFIG_HOME", tmp, 1) == 0);
+
+  char *err = NULL;
+  SecretStore *ss = secret_store_create(&err);
+  ASSERT_TRUE(ss != NULL);
+  ASSERT_TRUE(err == NULL);
+  ASSERT_TRUE(secret_store_set(ss, TEST_REF("MyPostgres"), "pw-cached") == OK);
+
+  StrBuf out;
+  sb_init(&out);
+  ASSERT_TRUE(secret_store_get(ss, TEST_REF("MyPostgres"), &out) == YES);
+  ASSERT_STREQ(out.data, "pw-cached");
+
+  char *cred_path = cred_path_for_tmp(tmp);
+  ASSERT_TRUE(cred_path != NULL);
+  ASSERT_TRUE(unlink(cred_path) == 0);
+
+  ASSERT_TRUE(secret_store_get(ss, TEST_REF("MyPostgres"), &out) == YES);
+  ASSERT_STREQ(out.data, "pw-cached");
+
+  // Any mutation invalidates the cache; the backend now sees no file.
+  ASSERT_TRUE(secret_store_set(ss, TEST_REF("OtherDb"), "pw-other") == OK);
+  ASSERT_TRUE(secret_store_get(ss, TEST_REF("MyPostgres"), &out) == NO);
+
+  free(cred_path);
+  sb_zero_clean(&out);
+  secret_store_destroy(ss);
+  restore_one_env_value("XDG_CONFIG_HOME", old_xdg, had_xdg);
+  free(old_xdg);
+  cleanup_tmp_tree(tmp);
+  free(tmp);
+}
+
+typedef struct {
+  SecretStore *ss;
+  int iters;
+} ConcurrentGetCtx;
+
+/* Worker for test_secret_store_concurrent_get: hammers get() on shared refs. */
+static void *concurrent_get_worker(void *arg) {
+  ConcurrentGetCtx *ctx = (ConcurrentGetCtx *)arg;
+  const char *names[] = {"MyPostgres", "OtherDb", "missing"};
+  StrBuf out;
+  sb_init(&out);
+  for (int i = 0; i < ctx->iters; i++) {
+    const char *name = names[(size_t)i % (sizeof(names) / sizeof(names[0]))];
+    AdbxTriStatus rc = secret_store_get(ctx->ss, TEST_REF(name), &out);
+    ASSERT_TRUE(rc == YES || rc == NO);
+    if (rc == YES)
+      ASSERT_TRUE(out.data != NULL && out.data[0] != '\0');
+  }
+  sb_zero_clean(&out);
+  return NULL;
+}
+
+/* Verifies concurrent reads on one store are safe, as the SecretStore
+ * contract promises and the credential-manager prefetch pool relies on. */
+static void test_secret_store_concurrent_get(void) {
+  char *tmp = make_tmp_dir();
+  char *old_xdg = getenv("XDG_CONFIG_HOME");
+  int had_xdg = (old_xdg != NULL);
+  old_xdg = old_xdg ? dup_or_null(old_xdg) : NULL;
+  ASSERT_TRUE(setenv("XDG_CONFIG_HOME", tmp, 1) == 0);
+
+  char *err = NULL;
+  SecretStore *ss = secret_store_create(&err);
+  ASSERT_TRUE(ss != NULL);
+  ASSERT_TRUE(secret_store_set(ss, TEST_REF("MyPostgres"), "pw-a") == OK);
+  ASSERT_TRUE(secret_store_set(ss, TEST_REF("OtherDb"), "pw-b") == OK);
+
+  ConcurrentGetCtx ctx = {.ss = ss, .iters = 200};
+  pthread_t tids[4];
+  for (size_t i = 0; i < 4; i++)
+    ASSERT_TRUE(pthread_create(&tids[i], NULL, concurrent_get_worker, &ctx) ==
+                0);
+  for (size_t i = 0; i < 4; i++)
+    ASSERT_TRUE(pthread_join(tids[i], NULL) == 0);
+
+  secret_store_destroy(ss);
+  free(err);
+  restore_one_env_value("XDG_CONFIG_HOME", old_xdg, had_xdg);
+  free(old_xdg);
+  cleanup_tmp_tree(tmp);
+  free(tmp);
+}
+
 int main(void) {
   test_file_backend_roundtrip();
   test_file_backend_rejects_bad_mode();
@@ -400,6 +497,8 @@ int main(void) {
   test_secret_store_factory_rejects_malformed_backend_choice();
   test_file_backend_refreshes_on_disk_change();
   test_file_backend_duplicate_ref_is_err();
+  test_secret_store_session_cache();
+  test_secret_store_concurrent_get();
 
   test_backend_probe_contract();
   fprintf(stderr, "OK: test_secret_store\n");
@@ -92,6 +92,34 @@ static void test_many_entries(void) {
   spool_destroy(sp);
 }
 
+static void test_layered_base_hits(void) {
+  StringPool *base = spool_create();
+  ASSERT_TRUE(base != NULL);
+  const char *base_ptr = spool_add(base, "users.email");
+  ASSERT_TRUE(base_ptr != NULL);
+
+  StringPool layered = {0};
+  ASSERT_TRUE(spool_init_layered(&layered, base) == OK);
+
+  // Base-resident content resolves to the base pointer without copying, and
+  // two pools layered on the same base agree on it.
+  ASSERT_TRUE(spool_add(&layered, "users.email") == base_ptr);
+  StringPool layered2 = {0};
+  ASSERT_TRUE(spool_init_layered(&layered2, base) == OK);
+  ASSERT_TRUE(spool_add(&layered2, "users.email") == base_ptr);
+
+  // New content lands in the layered pool and leaves the base untouched.
+  const char *own = spool_add(&layered, "users.phone");
+  ASSERT_TRUE(own != NULL);
+  ASSERT_TRUE(own != base_ptr);
+  ASSERT_TRUE(spool_add(&layered, "users.phone") == own);
+  ASSERT_TRUE(spool_add(base, "users.phone") != own);
+
+  spool_clean(&layered2);
+  spool_clean(&layered);
+  spool_destroy(base);
+}
+
 static void test_invalid_inputs(void) {
   ASSERT_TRUE(spool_init(NULL) == ERR);
   ASSERT_TRUE(spool_add(NULL, "x") == NULL);
@@ -112,6 +140,7 @@ int main(void) {
   test_empty_string();
   test_clean_and_reinit();
   test_many_entries();
+  test_layered_base_hits();
   test_invalid_inputs();
 
   fprintf(stderr, "OK: test_spool\n");
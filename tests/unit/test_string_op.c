@@ -166,6 +166,166 @@ static void test_sb_init_resets_fields(void) {
   ASSERT_TRUE(sb.cap == 0);
 }
 
+static void test_sb_small_inline_then_spill(void) {
+  StrBuf sb;
+  sb_init_small(&sb);
+  ASSERT_TRUE(sb.data == sb.small);
+  ASSERT_TRUE(sb.cap == STRBUF_INLINE_CAP);
+
+  // Short payloads stay inside the struct.
+  ASSERT_TRUE(sb_append_bytes(&sb, "short", 5) == OK);
+  ASSERT_TRUE(sb.data == sb.small);
+  ASSERT_TRUE(memcmp(sb.data, "short", 5) == 0);
+
+  // Growing past the inline capacity spills to heap and keeps the bytes.
+  char big[STRBUF_INLINE_CAP * 2];
+  memset(big, 'x', sizeof(big));
+  ASSERT_TRUE(sb_append_bytes(&sb, big, sizeof(big)) == OK);
+  ASSERT_TRUE(sb.data != sb.small);
+  ASSERT_TRUE(sb.len == 5 + sizeof(big));
+  ASSERT_TRUE(memcmp(sb.data, "short", 5) == 0);
+  ASSERT_TRUE(memcmp(sb.data + 5, big, sizeof(big)) == 0);
+
+  sb_clean(&sb);
+  ASSERT_TRUE(sb.data == NULL);
+}
+
+static void test_sb_small_zero_clean_scrubs_inline(void) {
+  StrBuf sb;
+  sb_init_small(&sb);
+  ASSERT_TRUE(sb_append_bytes(&sb, "hunter2", 7) == OK);
+  ASSERT_TRUE(sb.data == sb.small);
+
+  sb_zero_clean(&sb);
+  ASSERT_TRUE(sb.data == NULL);
+  for (size_t i = 0; i < STRBUF_INLINE_CAP; i++)
+    ASSERT_TRUE(sb.small[i] == '\0');
+
+  // A cleaned buffer behaves like a plain heap StrBuf again.
+  ASSERT_TRUE(sb_append_bytes(&sb, "x", 1) == OK);
+  ASSERT_TRUE(sb.data != sb.small);
+  sb_clean(&sb);
+}
+
+static void test_sb_small_to_cstr(void) {
+  StrBuf sb;
+  sb_init_small(&sb);
+  ASSERT_TRUE(sb_append_bytes(&sb, "abc", 3) == OK);
+  ASSERT_STREQ(sb_to_cstr(&sb), "abc");
+  ASSERT_TRUE(sb.data == sb.small);
+
+  // Filling the inline capacity exactly forces the NUL to spill.
+  char fill[STRBUF_INLINE_CAP];
+  memset(fill, 'y', sizeof(fill));
+  sb_reset(&sb);
+  ASSERT_TRUE(sb_append_bytes(&sb, fill, sizeof(fill)) == OK);
+  char *c = sb_to_cstr(&sb);
+  ASSERT_TRUE(sb.data != sb.small);
+  ASSERT_TRUE(c[STRBUF_INLINE_CAP] == '\0');
+  sb_clean(&sb);
+}
+
+static void test_span_to_i64(void) {
+  int64_t v = 0;
+
+  ASSERT_TRUE(str_span_to_i64("0", 1, &v) == OK && v == 0);
+  ASSERT_TRUE(str_span_to_i64("42", 2, &v) == OK && v == 42);
+  ASSERT_TRUE(str_span_to_i64("-7", 2, &v) == OK && v == -7);
+  ASSERT_TRUE(str_span_to_i64("+7", 2, &v) == OK && v == 7);
+
+  // Spans are length-bound: trailing bytes past 'n' are ignored.
+  ASSERT_TRUE(str_span_to_i64("123junk", 3, &v) == OK && v == 123);
+
+  // Exact int64 bounds round-trip; one past either end does not.
+  ASSERT_TRUE(str_span_to_i64("9223372036854775807", 19, &v) == OK);
+  ASSERT_TRUE(v == INT64_MAX);
+  ASSERT_TRUE(str_span_to_i64("-9223372036854775808", 20, &v) == OK);
+  ASSERT_TRUE(v == INT64_MIN);
+  ASSERT_TRUE(str_span_to_i64("9223372036854775808", 19, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64("-9223372036854775809", 20, &v) == ERR);
+
+  ASSERT_TRUE(str_span_to_i64("", 0, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64("-", 1, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64(" 1", 2, &v) == ERR); // no whitespace skipping
+  ASSERT_TRUE(str_span_to_i64("1x", 2, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64("1.5", 3, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64(NULL, 1, &v) == ERR);
+  ASSERT_TRUE(str_span_to_i64("1", 1, NULL) == ERR);
+}
+
+static void test_span_to_f64(void) {
+  double v = 0;
+
+  // Fast-path shapes: small mantissa, small decimal exponent.
+  ASSERT_TRUE(str_span_to_f64("0", 1, &v) == OK && v == 0.0);
+  ASSERT_TRUE(str_span_to_f64("1.5", 3, &v) == OK && v == 1.5);
+  ASSERT_TRUE(str_span_to_f64("-2.25", 5, &v) == OK && v == -2.25);
+  ASSERT_TRUE(str_span_to_f64(".5", 2, &v) == OK && v == 0.5);
+  ASSERT_TRUE(str_span_to_f64("3e2", 3, &v) == OK && v == 300.0);
+  ASSERT_TRUE(str_span_to_f64("25E-2", 5, &v) == OK && v == 0.25);
+  ASSERT_TRUE(str_span_to_f64("0.1", 3, &v) == OK && v == 0.1);
+
+  // Fallback shapes must still round like strtod.
+  ASSERT_TRUE(str_span_to_f64("2.2250738585072014e-308", 23, &v) == OK);
+  ASSERT_TRUE(v == 2.2250738585072014e-308);
+  ASSERT_TRUE(str_span_to_f64("1.7976931348623157e308", 22, &v) == OK);
+  ASSERT_TRUE(v == 1.7976931348623157e308);
+  ASSERT_TRUE(str_span_to_f64("123456789012345678901234.5", 26, &v) == OK);
+  ASSERT_TRUE(v == 123456789012345678901234.5);
+
+  // Out of double range is an error, not infinity.
+  ASSERT_TRUE(str_span_to_f64("1e400", 5, &v) == ERR);
+
+  ASSERT_TRUE(str_span_to_f64("", 0, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64(".", 1, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("1e", 2, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("1e+", 3, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("1.5x", 4, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64(" 1", 2, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("inf", 3, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("nan", 3, &v) == ERR);
+  ASSERT_TRUE(str_span_to_f64("0x10", 4, &v) == ERR);
+}
+
+/* Asserts strop_u64_to_dec/strop_i64_to_dec render 'v' exactly as printf
+ * would; the buffer is canaried past STROP_DEC_MAX to catch overruns. */
+static void assert_u64_dec(uint64_t v, const char *expect) {
+  char buf[STROP_DEC_MAX + 1];
+  memset(buf, '#', sizeof(buf));
+  size_t n = strop_u64_to_dec(buf, v);
+  ASSERT_TRUE(n == strlen(expect));
+  ASSERT_TRUE(memcmp(buf, expect, n) == 0);
+  ASSERT_TRUE(buf[STROP_DEC_MAX] == '#');
+}
+
+static void assert_i64_dec(int64_t v, const char *expect) {
+  char buf[STROP_DEC_MAX + 1];
+  memset(buf, '#', sizeof(buf));
+  size_t n = strop_i64_to_dec(buf, v);
+  ASSERT_TRUE(n == strlen(expect));
+  ASSERT_TRUE(memcmp(buf, expect, n) == 0);
+  ASSERT_TRUE(buf[STROP_DEC_MAX] == '#');
+}
+
+static void test_dec_rendering(void) {
+  // One case per digit-count parity around the pairs-table boundaries.
+  assert_u64_dec(0, "0");
+  assert_u64_dec(9, "9");
+  assert_u64_dec(10, "10");
+  assert_u64_dec(99, "99");
+  assert_u64_dec(100, "100");
+  assert_u64_dec(12345, "12345");
+  assert_u64_dec(1000000007u, "1000000007");
+  assert_u64_dec(UINT64_MAX, "18446744073709551615");
+
+  assert_i64_dec(0, "0");
+  assert_i64_dec(-1, "-1");
+  assert_i64_dec(-42, "-42");
+  assert_i64_dec(INT64_MAX, "9223372036854775807");
+  // INT64_MIN has no positive counterpart; the negation must not overflow.
+  assert_i64_dec(INT64_MIN, "-9223372036854775808");
+}
+
 int main(void) {
   test_dup_functions_basic();
   test_dup_pretty();
@@ -178,6 +338,12 @@ int main(void) {
   test_sb_to_cstr_null_inputs();
   test_sb_to_cstr_len_eq_cap_grow();
   test_sb_to_cstr_hard_limit_cannot_grow();
+  test_sb_small_inline_then_spill();
+  test_sb_small_zero_clean_scrubs_inline();
+  test_sb_small_to_cstr();
+  test_span_to_i64();
+  test_span_to_f64();
+  test_dec_rendering();
 
   fprintf(stderr, "OK: test_string_op\n");
   return 0;
@@ -0,0 +1,244 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "sensitive_tok.h"
+#include "test.h"
+#include "token_snapshot.h"
+
+/* Initializes a bounded arena used by token-store tests.
+ * It borrows 'arena' and mutates it in-place.
+ * Side effects: allocates first arena block.
+ * Error semantics: asserts on failure.
+ */
+static void init_test_arena(Arena *arena) {
+  uint32_t cap = 4u * 1024u * 1024u;
+  ASSERT_TRUE(arena_init(arena, NULL, &cap) == OK);
+}
+
+/* Creates one throwaway 0700 directory and returns an owned O_DIRECTORY fd. */
+static int make_snap_dir(char out_path[64]) {
+  snprintf(out_path, 64, "/tmp/adbx_toksnap_XXXXXX");
+  ASSERT_TRUE(mkdtemp(out_path) != NULL);
+  int fd = open(out_path, O_RDONLY | O_DIRECTORY);
+  ASSERT_TRUE(fd >= 0);
+  return fd;
+}
+
+static void remove_snap_dir(int fd, const char *path) {
+  (void)unlinkat(fd, TOKSNAP_FILENAME, 0);
+  close(fd);
+  (void)rmdir(path);
+}
+
+static const uint8_t TEST_TOKEN[RESUME_TOKEN_LEN] = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+    17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32};
+
+/* Mints the two fixture tokens (one SQL NULL) into 'store'. */
+static void mint_fixture_tokens(DbTokenStore *store, uint32_t generation) {
+  SensitiveTokIn in = {
+      .value = "alice@example.com",
+      .value_len = 17,
+      .col_ref = "public.users.email",
+      .col_ref_len = 18,
+      .pg_oid = 25,
+  };
+  char tok[SENSITIVE_TOK_BUFSZ] = {0};
+  ASSERT_TRUE(stok_store_create_token(store, generation, &in, tok) ==
+              (int)SENSITIVE_TOK_LEN);
+
+  SensitiveTokIn null_in = {
+      .value = NULL,
+      .value_len = 0,
+      .col_ref = "public.users.phone",
+      .col_ref_len = 18,
+      .pg_oid = 25,
+  };
+  ASSERT_TRUE(stok_store_create_token(store, generation, &null_in, tok) ==
+              (int)SENSITIVE_TOK_LEN);
+}
+
+/* Full persist/restore cycle: writer -> commit -> load (single use) ->
+ * replay into a fresh store with the original handle indices. */
+static void test_toksnap_roundtrip(void) {
+  char dir_path[64];
+  int dir_fd = make_snap_dir(dir_path);
+
+  Arena arena = {0};
+  init_test_arena(&arena);
+  ConnProfile cp = make_profile("pgmain", SAFETY_COLSTRAT_DETERMINISTIC);
+  DbTokenStore *store = stok_store_create(&cp, &arena);
+  ASSERT_TRUE(store != NULL);
+  mint_fixture_tokens(store, 3u);
+
+  TokSnapWriter w;
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_session(&w, TEST_TOKEN, 3u, 100, 200, 150, 1) ==
+              OK);
+  ASSERT_TRUE(toksnap_writer_store(&w, "pgmain", store) == OK);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+
+  TokSnap *snap = toksnap_load(dir_fd);
+  ASSERT_TRUE(snap != NULL);
+  ASSERT_TRUE(toksnap_n_sessions(snap) == 1);
+  const TokSnapSession *sess = toksnap_session_at(snap, 0);
+  ASSERT_TRUE(sess != NULL);
+  ASSERT_TRUE(memcmp(sess->resume_token, TEST_TOKEN, RESUME_TOKEN_LEN) == 0);
+  ASSERT_TRUE(sess->generation == 3u);
+  ASSERT_TRUE(sess->created_at == 100 && sess->last_active == 200 &&
+              sess->tokens_last_used == 150);
+  ASSERT_TRUE(sess->n_stores == 1);
+  ASSERT_TRUE(sess->stores[0].n_toks == 2);
+  ASSERT_TRUE(sess->stores[0].toks[1].value == NULL);
+
+  // Single use: the load consumed the file.
+  ASSERT_TRUE(toksnap_load(dir_fd) == NULL);
+
+  // Replay into a fresh store: same entries land on the same indices.
+  DbTokenStore *restored = stok_store_create(&cp, &arena);
+  ASSERT_TRUE(restored != NULL);
+  ASSERT_TRUE(toksnap_restore_store(sess, "pgmain", 3u, restored) == OK);
+  ASSERT_TRUE(stok_store_len(restored) == 2);
+  const SensitiveTok *t0 = stok_store_get(restored, 0);
+  ASSERT_TRUE(t0 != NULL && t0->value_len == 17 &&
+              memcmp(t0->value, "alice@example.com", 17) == 0);
+  const SensitiveTok *t1 = stok_store_get(restored, 1);
+  ASSERT_TRUE(t1 != NULL && t1->value == NULL && t1->value_len == 0);
+
+  // A connection the snapshot never saw restores to an empty store.
+  ConnProfile other = make_profile("other", SAFETY_COLSTRAT_DETERMINISTIC);
+  DbTokenStore *empty = stok_store_create(&other, &arena);
+  ASSERT_TRUE(empty != NULL);
+  ASSERT_TRUE(toksnap_restore_store(sess, "other", 3u, empty) == OK);
+  ASSERT_TRUE(stok_store_len(empty) == 0);
+
+  stok_store_destroy(empty);
+  stok_store_destroy(restored);
+  stok_store_destroy(store);
+  toksnap_destroy(snap);
+  arena_clean(&arena);
+  remove_snap_dir(dir_fd, dir_path);
+}
+
+/* A never-materialized store record re-emits unchanged, so lazy restore
+ * survives a second clean shutdown. */
+static void test_toksnap_store_rec_reemit(void) {
+  char dir_path[64];
+  int dir_fd = make_snap_dir(dir_path);
+
+  Arena arena = {0};
+  init_test_arena(&arena);
+  ConnProfile cp = make_profile("pgmain", SAFETY_COLSTRAT_DETERMINISTIC);
+  DbTokenStore *store = stok_store_create(&cp, &arena);
+  ASSERT_TRUE(store != NULL);
+  mint_fixture_tokens(store, 9u);
+
+  TokSnapWriter w;
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_session(&w, TEST_TOKEN, 9u, 1, 2, 3, 1) == OK);
+  ASSERT_TRUE(toksnap_writer_store(&w, "pgmain", store) == OK);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+
+  TokSnap *first = toksnap_load(dir_fd);
+  ASSERT_TRUE(first != NULL);
+  const TokSnapSession *sess = toksnap_session_at(first, 0);
+  ASSERT_TRUE(sess != NULL && sess->n_stores == 1);
+
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_session(&w, TEST_TOKEN, 9u, 1, 2, 3, 1) == OK);
+  ASSERT_TRUE(toksnap_writer_store_rec(&w, &sess->stores[0]) == OK);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+
+  TokSnap *second = toksnap_load(dir_fd);
+  ASSERT_TRUE(second != NULL);
+  const TokSnapSession *sess2 = toksnap_session_at(second, 0);
+  ASSERT_TRUE(sess2 != NULL && sess2->n_stores == 1);
+  ASSERT_TRUE(sess2->stores[0].n_toks == 2);
+  ASSERT_TRUE(strcmp(sess2->stores[0].connection_name, "pgmain") == 0);
+
+  stok_store_destroy(store);
+  toksnap_destroy(first);
+  toksnap_destroy(second);
+  arena_clean(&arena);
+  remove_snap_dir(dir_fd, dir_path);
+}
+
+/* Committing zero sessions removes any stale snapshot instead of writing. */
+static void test_toksnap_empty_commit_unlinks(void) {
+  char dir_path[64];
+  int dir_fd = make_snap_dir(dir_path);
+
+  Arena arena = {0};
+  init_test_arena(&arena);
+  ConnProfile cp = make_profile("pgmain", SAFETY_COLSTRAT_DETERMINISTIC);
+  DbTokenStore *store = stok_store_create(&cp, &arena);
+  ASSERT_TRUE(store != NULL);
+  mint_fixture_tokens(store, 1u);
+
+  TokSnapWriter w;
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_session(&w, TEST_TOKEN, 1u, 1, 2, 3, 1) == OK);
+  ASSERT_TRUE(toksnap_writer_store(&w, "pgmain", store) == OK);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+  ASSERT_TRUE(faccessat(dir_fd, TOKSNAP_FILENAME, F_OK, 0) != 0);
+  ASSERT_TRUE(toksnap_load(dir_fd) == NULL);
+
+  stok_store_destroy(store);
+  arena_clean(&arena);
+  remove_snap_dir(dir_fd, dir_path);
+}
+
+/* A corrupted body fails the hash check and loads as NULL (fail-soft). */
+static void test_toksnap_rejects_corruption(void) {
+  char dir_path[64];
+  int dir_fd = make_snap_dir(dir_path);
+
+  Arena arena = {0};
+  init_test_arena(&arena);
+  ConnProfile cp = make_profile("pgmain", SAFETY_COLSTRAT_DETERMINISTIC);
+  DbTokenStore *store = stok_store_create(&cp, &arena);
+  ASSERT_TRUE(store != NULL);
+  mint_fixture_tokens(store, 1u);
+
+  TokSnapWriter w;
+  toksnap_writer_init(&w);
+  ASSERT_TRUE(toksnap_writer_session(&w, TEST_TOKEN, 1u, 1, 2, 3, 1) == OK);
+  ASSERT_TRUE(toksnap_writer_store(&w, "pgmain", store) == OK);
+  ASSERT_TRUE(toksnap_writer_commit(&w, dir_fd) == OK);
+
+  // Flip one byte near the end of the file.
+  int fd = openat(dir_fd, TOKSNAP_FILENAME, O_RDWR);
+  ASSERT_TRUE(fd >= 0);
+  off_t size = lseek(fd, 0, SEEK_END);
+  ASSERT_TRUE(size > 4);
+  uint8_t byte = 0;
+  ASSERT_TRUE(pread(fd, &byte, 1, size - 3) == 1);
+  byte ^= 0xFFu;
+  ASSERT_TRUE(pwrite(fd, &byte, 1, size - 3) == 1);
+  close(fd);
+
+  ASSERT_TRUE(toksnap_load(dir_fd) == NULL);
+  // The bad file was still consumed.
+  ASSERT_TRUE(faccessat(dir_fd, TOKSNAP_FILENAME, F_OK, 0) != 0);
+
+  stok_store_destroy(store);
+  arena_clean(&arena);
+  remove_snap_dir(dir_fd, dir_path);
+}
+
+int main(void) {
+  test_toksnap_roundtrip();
+  test_toksnap_store_rec_reemit();
+  test_toksnap_empty_commit_unlinks();
+  test_toksnap_rejects_corruption();
+  fprintf(stderr, "OK: test_token_snapshot\n");
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bufio.h"
+#include "test.h"
+#include "uring_byte_channel.h"
+
+/* Reads exactly 'n' bytes from a plain fd (the peer side of the pair). */
+static void read_exact_fd(int fd, uint8_t *dst, size_t n) {
+  while (n > 0) {
+    ssize_t got = read(fd, dst, n);
+    ASSERT_TRUE(got > 0);
+    dst += (size_t)got;
+    n -= (size_t)got;
+  }
+}
+
+/* Queued writes reach the peer only after flush, in order, and reads pull
+ * peer bytes back through the same channel. */
+static void test_uring_channel_roundtrip(ByteChannel *ch, int peer) {
+  ASSERT_TRUE(bytech_write_some(ch, "hello ", 6) == 6);
+  ASSERT_TRUE(bytech_write_some(ch, "uring", 5) == 5);
+  ASSERT_TRUE(bytech_flush(ch) == OK);
+
+  uint8_t got[11];
+  read_exact_fd(peer, got, sizeof(got));
+  ASSERT_TRUE(memcmp(got, "hello uring", 11) == 0);
+
+  // Vector writes batch through the same staging path.
+  ByteChannelVec vecs[2] = {{.base = "ab", .len = 2}, {.base = "cd", .len = 2}};
+  ASSERT_TRUE(bytech_writev_some(ch, vecs, 2) == 4);
+  ASSERT_TRUE(bytech_flush(ch) == OK);
+  read_exact_fd(peer, got, 4);
+  ASSERT_TRUE(memcmp(got, "abcd", 4) == 0);
+
+  ASSERT_TRUE(write(peer, "pong", 4) == 4);
+  uint8_t rbuf[8] = {0};
+  ASSERT_TRUE(bytech_read_some(ch, rbuf, sizeof(rbuf)) == 4);
+  ASSERT_TRUE(memcmp(rbuf, "pong", 4) == 0);
+}
+
+/* A payload larger than the staging buffer takes the sync fallback and still
+ * arrives intact behind previously queued bytes. */
+static void test_uring_channel_oversized_write(ByteChannel *ch, int peer) {
+  static uint8_t big[96 * 1024];
+  for (size_t i = 0; i < sizeof(big); i++)
+    big[i] = (uint8_t)(i * 7u);
+
+  ASSERT_TRUE(bytech_write_some(ch, "pre", 3) == 3);
+  ASSERT_TRUE(bytech_write_some(ch, big, sizeof(big)) == (ssize_t)sizeof(big));
+  ASSERT_TRUE(bytech_flush(ch) == OK);
+
+  static uint8_t got[3 + sizeof(big)];
+  read_exact_fd(peer, got, sizeof(got));
+  ASSERT_TRUE(memcmp(got, "pre", 3) == 0);
+  ASSERT_TRUE(memcmp(got + 3, big, sizeof(big)) == 0);
+}
+
+/* EOF propagates as 0 once the peer closes. */
+static void test_uring_channel_eof(ByteChannel *ch, int peer) {
+  close(peer);
+  uint8_t rbuf[4];
+  ASSERT_TRUE(bytech_read_some(ch, rbuf, sizeof(rbuf)) == 0);
+}
+
+int main(void) {
+  int sp[2];
+  ASSERT_TRUE(socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+
+  // Writes past the socket buffer would block the sync fallback; size the
+  // peer's receive side generously for the oversized-write test.
+  int sz = 256 * 1024;
+  (void)setsockopt(sp[1], SOL_SOCKET, SO_RCVBUF, &sz, sizeof(sz));
+
+  ByteChannel *ch = uring_bytechannel_open_fd(sp[0]);
+  if (!ch) {
+    // Sandboxed/locked-down kernels refuse io_uring; the broker falls back
+    // to the fd channel there, so there is nothing further to test.
+    close(sp[0]);
+    close(sp[1]);
+    fprintf(stderr, "OK: test_uring_byte_channel (io_uring unavailable)\n");
+    return 0;
+  }
+
+  test_uring_channel_roundtrip(ch, sp[1]);
+  test_uring_channel_oversized_write(ch, sp[1]);
+  test_uring_channel_eof(ch, sp[1]);
+
+  bytech_destroy(ch); // owns sp[0]
+  fprintf(stderr, "OK: test_uring_byte_channel\n");
+  return 0;
+}